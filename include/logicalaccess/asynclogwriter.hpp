@@ -0,0 +1,145 @@
+/**
+ * \file asynclogwriter.hpp
+ * \brief Asynchronous log writer.
+ */
+
+#ifndef LOGICALACCESS_ASYNCLOGWRITER_HPP
+#define LOGICALACCESS_ASYNCLOGWRITER_HPP
+
+#include "logicalaccess/logicalaccess_api.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace logicalaccess
+{
+    /**
+     * \brief Background writer for log lines.
+     *
+     * Log lines are formatted on the calling thread (each Logs object owns
+     * its own buffer) and then pushed into a bounded multi-producer /
+     * single-consumer ring. A dedicated thread drains the ring, writes the
+     * lines in batches and flushes the output periodically, or immediately
+     * when a line of ERRORS severity (or worse) was written.
+     */
+    class LIBLOGICALACCESS_API AsyncLogWriter
+    {
+      public:
+        /**
+         * \brief What to do when the ring is full.
+         */
+        enum OverflowPolicy
+        {
+            OP_DROP = 0, /**< Discard the new line and count it as dropped. */
+            OP_BLOCK     /**< Wait, without spinning, until the writer thread frees a slot. */
+        };
+
+        static AsyncLogWriter &getInstance();
+
+        ~AsyncLogWriter();
+
+        /**
+         * \brief Start the writer thread.
+         * \param out The stream to write to. Must outlive the writer.
+         * \param capacity Number of slots of the ring, rounded up to a power of two.
+         * \param policy The overflow policy.
+         * \param flushInterval Maximum time, in milliseconds, a written line stays unflushed.
+         * \param duplicateToStderr Also write each line to stderr.
+         */
+        void start(std::ostream &out, size_t capacity, OverflowPolicy policy,
+                   unsigned int flushInterval, bool duplicateToStderr);
+
+        /**
+         * \brief Stop accepting lines, drain the queued ones, flush and stop the writer thread.
+         *
+         * Every line for which push() returned true is written.
+         */
+        void stop();
+
+        bool isRunning() const;
+
+        /**
+         * \brief Queue a line for writing.
+         * \param line The formatted log line.
+         * \param flush Request a flush as soon as the line is written.
+         * \return False if the line was dropped, because the ring was full or the writer is stopped.
+         */
+        bool push(std::string &&line, bool flush);
+
+        /**
+         * \brief Number of lines dropped because the ring was full.
+         */
+        uint64_t getDroppedCount() const;
+
+      private:
+        AsyncLogWriter();
+
+        AsyncLogWriter(const AsyncLogWriter &) = delete;
+        AsyncLogWriter &operator=(const AsyncLogWriter &) = delete;
+
+        struct Slot
+        {
+            std::atomic<size_t> sequence;
+            std::string line;
+            bool flush;
+        };
+
+        bool tryPush(std::string &line, bool flush);
+
+        /**
+         * \brief Check if the next slot to push is free.
+         */
+        bool hasFreeSlot() const;
+
+        /**
+         * \brief Pop every available line into batch.
+         * \return True if one of the lines requested a flush.
+         */
+        bool drain(std::string &batch, size_t &count);
+
+        void run();
+
+        std::unique_ptr<Slot[]> d_slots;
+        size_t d_mask;
+        std::atomic<size_t> d_enqueuePos;
+        size_t d_dequeuePos;
+
+        std::ostream *d_out;
+        OverflowPolicy d_policy;
+        unsigned int d_flushInterval;
+        bool d_duplicateToStderr;
+
+        /**
+         * \brief True while lines are accepted.
+         */
+        std::atomic<bool> d_running;
+
+        /**
+         * \brief Set by stop() once no producer can push anymore, the writer thread then drains and exits.
+         */
+        std::atomic<bool> d_closed;
+
+        /**
+         * \brief Number of push() calls in progress.
+         */
+        std::atomic<unsigned int> d_producers;
+
+        std::atomic<bool> d_wakeup;
+        std::atomic<uint64_t> d_dropped;
+        std::mutex d_mutex;
+        std::condition_variable d_cond;
+
+        /**
+         * \brief Signaled when the writer thread frees slots, for the OP_BLOCK producers.
+         */
+        std::condition_variable d_spaceCond;
+        std::thread d_thread;
+    };
+}
+
+#endif /* LOGICALACCESS_ASYNCLOGWRITER_HPP */
@@ -1,6 +1,7 @@
 #include "logicalaccess/key.hpp"
 #include <vector>
 #include <memory>
+#include <functional>
 
 #ifndef KEYDIVERSIFICATION_HPP__
 #define KEYDIVERSIFICATION_HPP__
@@ -14,9 +15,27 @@ namespace logicalaccess
     public:
         virtual void initDiversification(std::vector<unsigned char> d_identifier, int AID, std::shared_ptr<Key> key, unsigned char keyno, std::vector<unsigned char>& diversify) = 0;
         virtual std::vector<unsigned char> getDiversifiedKey(std::shared_ptr<Key> key, std::vector<unsigned char> diversify) = 0;
+
+        /**
+         * \brief Diversify a key for many diversification inputs, as getDiversifiedKey would for each of them.
+         * \param key The key to diversify.
+         * \param diversifyInputs The diversification inputs, as built by initDiversification.
+         * \return The diversified keys, in the inputs order.
+         */
+        virtual std::vector<std::vector<unsigned char> > diversifyBatch(std::shared_ptr<Key> key, const std::vector<std::vector<unsigned char> >& diversifyInputs);
+
         virtual std::string getType() = 0;
 
         static std::shared_ptr<KeyDiversification> getKeyDiversificationFromType(std::string kdiv);
+
+    protected:
+
+        /**
+         * \brief Split a batch in ranges processed in parallel, one per core.
+         * \param count The batch size.
+         * \param process Process the [begin, end) range. It is called from worker threads and must only share read-only state.
+         */
+        static void parallelForBatch(size_t count, const std::function<void(size_t, size_t)>& process);
     };
 }
 
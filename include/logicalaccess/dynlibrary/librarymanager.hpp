@@ -2,8 +2,15 @@
 #define LIBRARYMANAGER_HPP__
 
 #include <string>
+#include <atomic>
 #include <list>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include "logicalaccess/dynlibrary/idynlibrary.hpp"
 
@@ -30,11 +37,92 @@ namespace logicalaccess
             UNIFIED_TYPE = 2
         };
     private:
-        LibraryManager() {};
-        ~LibraryManager() {};
+        LibraryManager() : lazy_(false), warmUpStop_(false) {};
+        ~LibraryManager();
 
         static bool hasEnding(std::string const &fullString, std::string ending);
 
+        /**
+         * Immutable name to symbol index of the loaded libraries. Lookups
+         * read the current snapshot without locking, a new snapshot is
+         * published when a symbol is resolved for the first time or when
+         * plugins are rescanned.
+         */
+        struct SymbolIndex
+        {
+            /**
+             * Resolved symbols per library type. NULL caches a missing symbol.
+             */
+            std::unordered_map<std::string, void*> symbols[3];
+
+            /**
+             * Hook functions exported by any library, in library order.
+             */
+            std::unordered_map<std::string, std::vector<void*> > hooks;
+        };
+
+        /**
+         * A plug-in library file, as recorded in the plug-ins index file.
+         */
+        struct PluginInfo
+        {
+            std::string path;
+            uintmax_t size;
+            long long mtime;
+
+            /**
+             * False if the library has no entry point and is never loaded.
+             */
+            bool loadable;
+
+            std::vector<std::string> chips;
+            std::vector<std::string> readers;
+
+            /**
+             * Factories known to be exported by the library.
+             */
+            std::set<std::string> symbols;
+
+            /**
+             * Hook functions exported by the library.
+             */
+            std::set<std::string> hooks;
+        };
+
+        std::shared_ptr<const SymbolIndex> getIndex();
+
+        void* findSymbol(const std::string &fctname, LibraryType libraryType) const;
+
+        void buildIndex();
+
+        /**
+         * Resolve a symbol not in the index yet, loading the libraries providing it.
+         */
+        void* resolveSymbol(const std::string &fctname, LibraryType libraryType);
+
+        /**
+         * Get the hook functions exported by the libraries, loading them if needed.
+         */
+        std::vector<void*> getHook(const std::string &name);
+
+        /**
+         * Load a plug-in library if not loaded yet. Thread-safe, dlopen runs
+         * outside of the lock, which the caller must not hold.
+         */
+        IDynLibrary* loadLibrary(const std::string &filename);
+
+        /**
+         * Record what a loaded library exports in the plug-ins index.
+         */
+        void indexLibrary(IDynLibrary* lib, PluginInfo& info) const;
+
+        bool loadPluginIndex(const std::string &indexFile, std::map<std::string, PluginInfo>& plugins, std::set<std::string>* missing) const;
+
+        /**
+         * Write the plug-ins index file, unless it already has this content.
+         */
+        void savePluginIndex() const;
+
     public:
 		static LibraryManager *getInstance();
 
@@ -51,6 +139,20 @@ namespace logicalaccess
         std::shared_ptr<ReaderUnit> getReader(const std::string &readerName) const;
         std::shared_ptr<Chip> getCard(const std::string& cardtype);
         std::shared_ptr<Commands> getCommands(const std::string& extendedtype);
+
+        /**
+         * Get the chip factory for a card type. It is resolved once and
+         * then served from the symbol index, without dlsym.
+         *
+         * Returns NULL if no library provides the card type.
+         */
+        getcard getCardFactory(const std::string& cardtype);
+
+        /**
+         * Get the commands factory for an extended commands type, cached
+         * like getCardFactory().
+         */
+        getcommands getCommandsFactory(const std::string& extendedtype);
         static std::shared_ptr<DataTransport> getDataTransport(const std::string& transporttype);
         std::shared_ptr<KeyDiversification> getKeyDiversification(const std::string& keydivtype);
 
@@ -84,6 +186,26 @@ namespace logicalaccess
 
         void scanPlugins();
 
+        /**
+         * Load the indexed plug-ins not loaded yet on background threads and
+         * resolve their known factories. Does nothing unless plug-ins were
+         * lazily loaded from the plug-ins index file.
+         *
+         * threadCount: number of loading threads, 0 for the hardware concurrency.
+         */
+        void warmUp(unsigned int threadCount = 0);
+
+        /**
+         * Wait for the warm-up threads to complete.
+         */
+        void waitWarmUp();
+
+        /**
+         * Stop the warm-up threads once their current library is loaded, and
+         * wait for them. Called at exit if warmUp() was used.
+         */
+        void stopWarmUp();
+
     protected:
 
         std::vector<std::string> getAvailablePlugins(LibraryType libraryType);
@@ -92,6 +214,13 @@ namespace logicalaccess
     private:
         mutable std::recursive_mutex mutex_;
         std::map<std::string, IDynLibrary*> libLoaded;
+        std::shared_ptr<const SymbolIndex> index_;
+        std::map<std::string, PluginInfo> plugins_;
+        std::set<std::string> missing_[3];
+        bool lazy_;
+        std::vector<std::thread> warmUpThreads_;
+        std::atomic<bool> warmUpStop_;
+        std::mutex warmUpMutex_;
         static const std::string enumType[3];
     };
 }
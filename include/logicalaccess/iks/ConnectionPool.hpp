@@ -0,0 +1,69 @@
+#pragma once
+
+#include "logicalaccess/iks/PipelinedClient.hpp"
+#include <memory>
+#include <vector>
+
+namespace logicalaccess
+{
+namespace iks
+{
+/**
+ * A set of pipelined connections to the Islog Key Server, shared by
+ * multi-threaded callers.
+ *
+ * Each command goes to the connection with the fewest commands in flight, so
+ * that the server can process the commands of several connections in
+ * parallel.
+ */
+class LIBLOGICALACCESS_API ConnectionPool
+{
+  public:
+    /**
+     * Create a pool of `connections` clients with transports from `factory`.
+     */
+    ConnectionPool(PipelinedClient::TransportFactory factory, size_t connections = 4,
+                   size_t max_in_flight = 32);
+
+    /**
+     * Create a pool of `connections` clients to the server described by
+     * `config`.
+     */
+    explicit ConnectionPool(const IslogKeyServer::IKSConfig &config,
+                            size_t connections = 4, size_t max_in_flight = 32);
+
+    ConnectionPool(const ConnectionPool &) = delete;
+    ConnectionPool &operator=(const ConnectionPool &) = delete;
+
+    /**
+     * Returns a reference to a static pool connecting to the server
+     * registered with `IslogKeyServer::configureGlobalInstance()`.
+     */
+    static ConnectionPool &fromGlobalSettings();
+
+    /**
+     * Get the least loaded connection.
+     */
+    PipelinedClient &acquire();
+
+    /**
+     * Queue a command on the least loaded connection.
+     */
+    std::future<std::shared_ptr<BaseResponse>> submit(BaseCommand &cmd);
+
+    /**
+     * Send a command on the least loaded connection and wait for its
+     * response.
+     */
+    std::shared_ptr<BaseResponse> transact(BaseCommand &cmd);
+
+    /**
+     * Number of connections.
+     */
+    size_t size() const;
+
+  private:
+    std::vector<std::unique_ptr<PipelinedClient>> clients_;
+};
+}
+}
@@ -2,12 +2,17 @@
 
 #include "SSLTransport.hpp"
 #include "logicalaccess/iks/packet/Base.hpp"
+#include <functional>
+#include <memory>
 #include <string>
 
 namespace logicalaccess
 {
 namespace iks
 {
+class RandomPool;
+class ResultCache;
+
 /**
  * Main interface with the Islog Key Server.
  *
@@ -51,6 +56,11 @@ class LIBLOGICALACCESS_API IslogKeyServer
      */
     static IslogKeyServer &fromGlobalSettings();
 
+    /**
+     * Returns the settings registered by `configureGlobalInstance()`.
+     */
+    static const IKSConfig &getGlobalConfiguration();
+
     /**
      * Connect to the server locate at `ip`:`port`
      */
@@ -60,9 +70,35 @@ class LIBLOGICALACCESS_API IslogKeyServer
 
     /**
      * Ask Islog Key Server for random data.
+     *
+     * The data comes from the random pool when one is set.
      */
     std::vector<uint8_t> get_random(size_t sz);
 
+    /**
+     * Serve `get_random()` from a pool of `capacity` bytes, prefetched on a
+     * dedicated connection to the server.
+     */
+    void enable_random_pool(size_t capacity = 4096);
+
+    /**
+     * Set the pool serving `get_random()`, or nullptr to request each random
+     * from the server.
+     */
+    void set_random_pool(std::shared_ptr<RandomPool> pool);
+
+    std::shared_ptr<RandomPool> get_random_pool() const;
+
+    /**
+     * Set the cache of the AES and DES operation results, or nullptr to
+     * disable caching.
+     *
+     * Only the results of the keys allowed by the cache are cached.
+     */
+    void set_result_cache(std::shared_ptr<ResultCache> cache);
+
+    std::shared_ptr<ResultCache> get_result_cache() const;
+
     /**
      * Request an AES Encryption by the key server.
      */
@@ -116,22 +152,41 @@ class LIBLOGICALACCESS_API IslogKeyServer
 
     std::shared_ptr<BaseResponse> recv();
 
+    /**
+     * Build the response object of a received packet.
+     *
+     * `data` is the packet content after the header. Returns nullptr for an
+     * unknown opcode, throws if the status is not a success.
+     */
+    static std::shared_ptr<BaseResponse>
+    build_response(const ResponseHeader &header, const std::vector<uint8_t> &data);
+
   private:
     void setup_transport();
-    std::shared_ptr<BaseResponse> build_response(uint32_t size, uint16_t opcode,
-                                                 uint16_t status,
-                                                 const std::vector<uint8_t> &data);
 
     std::vector<uint8_t> des_crypto(const std::vector<uint8_t> &in,
                                     const std::string &key_name,
                                     const std::array<uint8_t, 8> &iv, bool use_ecb,
                                     bool decrypt);
 
+    /**
+     * Return the cached result of an AES or DES operation, or run `compute`
+     * when there is no cache.
+     */
+    std::vector<uint8_t> cached(const std::string &key_name, uint16_t opcode,
+                                uint8_t flags, const uint8_t *iv, size_t iv_size,
+                                const std::vector<uint8_t> &in,
+                                const std::function<std::vector<uint8_t>()> &compute);
+
 #ifdef ENABLE_SSLTRANSPORT
     boost::asio::ssl::context ssl_ctx_;
 #endif /* ENABLE_SSLTRANSPORT */
     std::unique_ptr<SSLTransport> transport_;
 
+    std::shared_ptr<RandomPool> random_pool_;
+
+    std::shared_ptr<ResultCache> result_cache_;
+
     /**
      * The registered pre-configuration is stored here.
      */
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "logicalaccess/iks/IslogKeyServer.hpp"
+#include "logicalaccess/iks/SSLTransport.hpp"
+#include "logicalaccess/iks/packet/Base.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace logicalaccess
+{
+namespace iks
+{
+/**
+ * A client keeping many commands in flight on one connection to the
+ * Islog Key Server.
+ *
+ * Commands are tagged with a request identifier and written as soon as they
+ * are submitted, without waiting for the previous responses. A single I/O
+ * thread owns the transport: it writes the queued commands and dispatches the
+ * received responses to their requests by identifier. Untagged responses are
+ * matched with the oldest request written and not yet answered.
+ *
+ * A command failing on a network error is not replayed, as some of them
+ * (DESFire authentication steps) are not idempotent: its future holds the
+ * exception and the connection is re-established for the next commands.
+ *
+ * This object is neither copyable nor movable. It is safe to submit commands
+ * from several threads.
+ */
+class LIBLOGICALACCESS_API PipelinedClient
+{
+  public:
+    /**
+     * Create a transport to the server, not yet connected.
+     */
+    using TransportFactory = std::function<std::unique_ptr<SSLTransport>()>;
+
+    /**
+     * Create a client connecting with transports from `factory`.
+     *
+     * At most `max_in_flight` commands are pending at once, `submit()`
+     * blocks beyond that.
+     */
+    explicit PipelinedClient(TransportFactory factory, size_t max_in_flight = 32);
+
+    /**
+     * Create a client connecting to the server described by `config`.
+     */
+    explicit PipelinedClient(const IslogKeyServer::IKSConfig &config,
+                             size_t max_in_flight = 32);
+
+    PipelinedClient(const PipelinedClient &) = delete;
+    PipelinedClient &operator=(const PipelinedClient &) = delete;
+
+    /**
+     * Fail the pending commands and stop the I/O thread.
+     */
+    ~PipelinedClient();
+
+    /**
+     * Queue a command and return the future of its response.
+     *
+     * A request identifier is assigned to `cmd`. The future throws if the
+     * server answers with a failure status or on network error.
+     */
+    std::future<std::shared_ptr<BaseResponse>> submit(BaseCommand &cmd);
+
+    /**
+     * Send a command and wait for its response.
+     */
+    std::shared_ptr<BaseResponse> transact(BaseCommand &cmd);
+
+    /**
+     * Number of commands queued or waiting for their response.
+     */
+    size_t in_flight() const;
+
+    /**
+     * Set the delay the I/O thread waits for responses before writing the
+     * newly queued commands. Defaults to 5 milliseconds.
+     */
+    void set_poll_timeout(long timeout);
+
+    /**
+     * Build a factory of SSL transports to the server described by `config`.
+     */
+    static TransportFactory ssl_transport_factory(const IslogKeyServer::IKSConfig &config);
+
+  private:
+    using Promise = std::promise<std::shared_ptr<BaseResponse>>;
+
+    /**
+     * The I/O thread loop.
+     */
+    void run();
+
+    /**
+     * Connect if needed and write the queued commands.
+     *
+     * Returns false on network error.
+     */
+    bool flush();
+
+    /**
+     * Dispatch the complete responses from the receive buffer.
+     */
+    void dispatch();
+
+    /**
+     * Fail all the commands in flight and drop the connection.
+     */
+    void fail_all(std::exception_ptr error);
+
+    TransportFactory factory_;
+
+    /**
+     * The connection, only used by the I/O thread.
+     */
+    std::unique_ptr<SSLTransport> transport_;
+
+    /**
+     * The bytes received and not yet dispatched.
+     */
+    std::vector<uint8_t> buffer_;
+
+    size_t max_in_flight_;
+
+    long poll_timeout_;
+
+    /**
+     * The serialized commands waiting to be written, with their request
+     * identifier.
+     */
+    std::deque<std::pair<uint32_t, std::vector<uint8_t>>> queue_;
+
+    /**
+     * The identifiers of the commands written and waiting for their response,
+     * in send order.
+     */
+    std::deque<uint32_t> sent_;
+
+    /**
+     * The commands queued or written, by request identifier.
+     */
+    std::map<uint32_t, Promise> pending_;
+
+    uint32_t next_request_id_;
+
+    bool stop_;
+
+    mutable std::mutex mutex_;
+
+    /**
+     * Signaled when commands are queued or the client stops.
+     */
+    std::condition_variable queued_;
+
+    /**
+     * Signaled when requests complete.
+     */
+    std::condition_variable completed_;
+
+    std::thread thread_;
+};
+}
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "logicalaccess/iks/PipelinedClient.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace logicalaccess
+{
+namespace iks
+{
+/**
+ * A client-side pool of random bytes generated by the Islog Key Server.
+ *
+ * The pool is filled in large blocks by a background thread, and refilled
+ * when it falls below half of its capacity. Requests served from the pool
+ * need no round trip to the server. When the pool does not hold enough bytes,
+ * the request is fetched directly from the server.
+ *
+ * Each byte is handed out once. It is safe to use this object from several
+ * threads.
+ */
+class LIBLOGICALACCESS_API RandomPool
+{
+  public:
+    /**
+     * Fetch `sz` random bytes from the server.
+     */
+    using Fetcher = std::function<std::vector<uint8_t>(size_t sz)>;
+
+    /**
+     * Create a pool of `capacity` bytes filled with `fetcher`.
+     *
+     * The first fill starts right away.
+     */
+    explicit RandomPool(Fetcher fetcher, size_t capacity = 4096);
+
+    RandomPool(const RandomPool &) = delete;
+    RandomPool &operator=(const RandomPool &) = delete;
+
+    /**
+     * Stop the refill thread.
+     */
+    ~RandomPool();
+
+    /**
+     * Retrieve `sz` random bytes.
+     */
+    std::vector<uint8_t> get(size_t sz);
+
+    /**
+     * Number of bytes ready in the pool.
+     */
+    size_t available() const;
+
+    /**
+     * Number of requests served from the pool.
+     */
+    uint64_t hits() const;
+
+    /**
+     * Number of requests fetched from the server because the pool was short.
+     */
+    uint64_t misses() const;
+
+    /**
+     * Build a fetcher sending GenRandom commands on `client`.
+     *
+     * Large requests are split in commands of at most `block_size` bytes,
+     * all in flight at once.
+     */
+    static Fetcher gen_random_fetcher(std::shared_ptr<PipelinedClient> client,
+                                      size_t block_size = 64);
+
+  private:
+    /**
+     * The refill thread loop.
+     */
+    void run();
+
+    Fetcher fetcher_;
+
+    size_t capacity_;
+
+    std::vector<uint8_t> buffer_;
+
+    uint64_t hits_;
+
+    uint64_t misses_;
+
+    bool refill_requested_;
+
+    bool stop_;
+
+    mutable std::mutex mutex_;
+
+    /**
+     * Signaled when the pool needs a refill or stops.
+     */
+    std::condition_variable refill_;
+
+    std::thread thread_;
+};
+}
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "logicalaccess/iks/packet/Base.hpp"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace logicalaccess
+{
+namespace iks
+{
+/**
+ * A bounded cache of the results of deterministic Islog Key Server
+ * operations.
+ *
+ * Results are indexed by key identity, diversification information and
+ * operation input. Only the keys explicitly allowed are cached: the results
+ * of the other keys are always computed by the server. Entries expire after a
+ * fixed time to live, and the least recently used entry is evicted when the
+ * cache is full.
+ *
+ * It is safe to use this object from several threads.
+ */
+class LIBLOGICALACCESS_API ResultCache
+{
+  public:
+    /**
+     * Compute a result on the server.
+     */
+    using Compute = std::function<std::vector<uint8_t>()>;
+
+    /**
+     * Create a cache of at most `capacity` results, each valid for `ttl`.
+     */
+    explicit ResultCache(size_t capacity = 1024,
+                         std::chrono::milliseconds ttl = std::chrono::minutes(5));
+
+    ResultCache(const ResultCache &) = delete;
+    ResultCache &operator=(const ResultCache &) = delete;
+
+    /**
+     * Allow the results of the key `key_identity` to be cached.
+     */
+    void allow(const std::string &key_identity);
+
+    /**
+     * Forbid the caching of the results of the key `key_identity`, and drop
+     * the results already cached.
+     */
+    void forbid(const std::string &key_identity);
+
+    bool is_allowed(const std::string &key_identity) const;
+
+    /**
+     * Return the cached result of an operation, or compute and cache it.
+     *
+     * `input` must identify the operation and all its parameters besides the
+     * key and the diversification. Exceptions from `compute` are propagated
+     * and nothing is cached.
+     */
+    std::vector<uint8_t> get(const std::string &key_identity, const KeyDivInfo &div_info,
+                             const std::vector<uint8_t> &input, const Compute &compute);
+
+    /**
+     * Drop all the cached results.
+     */
+    void clear();
+
+    /**
+     * Number of cached results.
+     */
+    size_t size() const;
+
+    /**
+     * Number of results served from the cache.
+     */
+    uint64_t hits() const;
+
+    /**
+     * Number of results of allowed keys computed by the server.
+     */
+    uint64_t misses() const;
+
+    /**
+     * Number of results dropped to make room for new ones.
+     */
+    uint64_t evictions() const;
+
+  private:
+    struct Entry
+    {
+        std::string key_identity;
+        std::string index;
+        std::vector<uint8_t> result;
+        std::chrono::steady_clock::time_point expiry;
+    };
+
+    void erase(std::list<Entry>::iterator it);
+
+    size_t capacity_;
+
+    std::chrono::milliseconds ttl_;
+
+    std::set<std::string> allowed_;
+
+    /**
+     * The entries, most recently used first.
+     */
+    std::list<Entry> entries_;
+
+    std::map<std::string, std::list<Entry>::iterator> index_;
+
+    uint64_t hits_;
+
+    uint64_t misses_;
+
+    uint64_t evictions_;
+
+    mutable std::mutex mutex_;
+};
+}
+}
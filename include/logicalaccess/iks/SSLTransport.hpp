@@ -113,6 +113,13 @@ class LIBLOGICALACCESS_API SSLTransport
      */
     virtual std::vector<uint8_t> receive(long int timeout);
 
+    /**
+     * \brief Wait for data to receive, without reading it.
+     * \param timeout Time waiting for data.
+     * \return True if receive() has data to return, false on timeout.
+     */
+    virtual bool waitReadable(long int timeout);
+
     /**
 * \brief Connect complete
      * \param error Read error
@@ -66,9 +66,21 @@ enum protocol_opcode
     SMSG_OP_DESFIRE_CHANGEKEY,
 };
 
+/**
+ * Opcode flag of the packets carrying a request identifier.
+ *
+ * A tagged command has a 4 bytes request identifier right after its opcode,
+ * and the server echoes it right after the response status. Untagged packets
+ * keep the original layout.
+ */
+#define IKS_OPCODE_FLAG_REQUEST_ID 0x8000
+
 class LIBLOGICALACCESS_API BaseCommand
 {
   public:
+    BaseCommand();
+    virtual ~BaseCommand() = default;
+
     virtual std::vector<uint8_t> serialize() const;
 
     /**
@@ -81,6 +93,14 @@ class LIBLOGICALACCESS_API BaseCommand
      */
     virtual size_t binary_size_impl() const = 0;
 
+    /**
+     * Identifier of the request, echoed in its response so that many
+     * commands can be in flight on one connection.
+     *
+     * 0 means an untagged command, answered in order.
+     */
+    uint32_t request_id_;
+
   protected:
     uint16_t opcode_;
 };
@@ -120,6 +140,44 @@ class LIBLOGICALACCESS_API KeyDivInfo
                             unsigned char keyno);
 };
 
+/**
+ * The fixed part of a response packet.
+ */
+class LIBLOGICALACCESS_API ResponseHeader
+{
+  public:
+    ResponseHeader();
+
+    /**
+     * Parse the header at the beginning of `data`.
+     *
+     * Returns false if more bytes are needed. Throws if the packet size is
+     * invalid.
+     */
+    bool parse(const uint8_t *data, size_t length);
+
+    /**
+     * Size of the full packet, header included.
+     */
+    uint32_t packet_size_;
+
+    /**
+     * The opcode, without the request identifier flag.
+     */
+    uint16_t opcode_;
+    uint16_t status_;
+
+    /**
+     * The request identifier, 0 for an untagged response.
+     */
+    uint32_t request_id_;
+
+    /**
+     * Size of the header, 8 bytes or 12 bytes for a tagged response.
+     */
+    size_t header_size_;
+};
+
 class LIBLOGICALACCESS_API BaseResponse
 {
   public:
@@ -128,6 +186,11 @@ class LIBLOGICALACCESS_API BaseResponse
 
     uint16_t opcode_;
     uint16_t status_;
+
+    /**
+     * Identifier of the request this response answers, 0 if untagged.
+     */
+    uint32_t request_id_;
 };
 }
 }
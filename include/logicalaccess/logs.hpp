@@ -29,6 +29,7 @@
 #include <sstream>
 #include <vector>
 #include <array>
+#include <atomic>
 #include <cstdint>
 
 namespace logicalaccess
@@ -94,10 +95,27 @@ namespace logicalaccess
         template <class T>
         Logs &operator<<(const T &arg)
         {
-            _stream << arg;
+            if (d_level != NONE)
+                _stream << arg;
             return (*this);
         }
 
+        /**
+         * Cheap check used by the LOG() and TRACE() macros before anything
+         * is evaluated. It may return true for a level that ends up being
+         * filtered, never the opposite.
+         */
+        static bool isEnabled(enum LogLevel level)
+        {
+            return ((levelMask.load(std::memory_order_relaxed) >> level) & 1) != 0;
+        }
+
+        /**
+         * Recompute the enabled levels mask from the current settings.
+         * Must be called after changing the log settings at runtime.
+         */
+        static void updateLevelMask();
+
         static std::ofstream logfile;
 
         /**
@@ -114,7 +132,22 @@ namespace logicalaccess
 
         enum LogLevel d_level;
         std::stringstream _stream;
-        static std::map<LogLevel, std::string> logLevelMsg;
+
+        /**
+         * One bit per LogLevel. All bits are set until the settings are loaded.
+         */
+        static std::atomic<uint32_t> levelMask;
+    };
+
+    /**
+     * Turns the LOG() stream expression into void so it can be used in
+     * the conditional operator.
+     */
+    struct LogVoidify
+    {
+        void operator&(const Logs &)
+        {
+        }
     };
 
     /**
@@ -149,7 +182,15 @@ namespace logicalaccess
 
 #ifdef LOGICALACCESS_LOGS
 
-#define LOG(x) logicalaccess::Logs(__FILE__, __FUNCTION__, __LINE__, x)
+/**
+ * Log something at the x level. Nothing after LOG(x) is evaluated when
+ * the level is disabled.
+ */
+#define LOG(x)                                                                 \
+    !logicalaccess::Logs::isEnabled(x)                                         \
+        ? (void)0                                                              \
+        : logicalaccess::LogVoidify() &                                        \
+              logicalaccess::Logs(__FILE__, __FUNCTION__, __LINE__, x)
 
 	LIBLOGICALACCESS_API void trace_print_helper(std::stringstream &ss, const char *param_names, int idx);
 
@@ -197,10 +238,16 @@ namespace logicalaccess
      * Log something at the TRACE level. This is a variadic macro that accepts all
      * parameters types and will output something like [param_name -> param_value]
      */
-#define TRACE(...)                                                 \
-  std::stringstream trace_stringstream;                            \
-  trace_print(trace_stringstream, #__VA_ARGS__, ##__VA_ARGS__);    \
-  LOG(TRACE) << trace_stringstream.str();
+#define TRACE(...)                                                   \
+  do                                                                 \
+  {                                                                  \
+    if (logicalaccess::Logs::isEnabled(logicalaccess::TRACE))        \
+    {                                                                \
+      std::stringstream trace_stringstream;                          \
+      trace_print(trace_stringstream, #__VA_ARGS__, ##__VA_ARGS__);  \
+      LOG(TRACE) << trace_stringstream.str();                        \
+    }                                                                \
+  } while (0)
 
 	LIBLOGICALACCESS_API void trace_print_helper(std::stringstream &ss, const char *param_names, int idx);
 
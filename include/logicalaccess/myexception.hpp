@@ -103,6 +103,17 @@ namespace logicalaccess
 
     };
 
+    /**
+     * Exception class to notify that a format parity doesn't match the data.
+     */
+    class ParityException : public LibLogicalAccessException
+    {
+    public:
+        ParityException(const std::string& message)
+                : LibLogicalAccessException(message)
+        {};
+    };
+
     /**
      * An exception related to operation against the Islog Key Server.
      */
@@ -10,17 +10,30 @@
 #include "logicalaccess/lla_fwd.hpp"
 #include "logicalaccess/readerproviders/readerprovider.hpp"
 
+#include <exception>
+#include <functional>
+#include <thread>
 #include <vector>
 
 namespace logicalaccess
 {
+    /**
+     * \brief Called when an asynchronous command completed, with the command result or the error.
+     */
+    typedef std::function<void(const std::vector<unsigned char>&, std::exception_ptr)> DataTransportCallback;
+
     /**
      * \brief A data transport base class. It provide an abstraction layer between the host and readers.
      */
-    class LIBLOGICALACCESS_API DataTransport : public XmlSerializable
+    class LIBLOGICALACCESS_API DataTransport : public XmlSerializable, public std::enable_shared_from_this < DataTransport >
     {
     public:
 
+        /**
+         * \brief Destructor. Wait for the pending command thread, if any.
+         */
+        virtual ~DataTransport();
+
         /**
          * \brief Get the reader unit.
          * \return The reader unit.
@@ -70,6 +83,21 @@ namespace logicalaccess
          */
         virtual std::vector<unsigned char> sendCommand(const std::vector<unsigned char>& command, long int timeout = -1);
 
+        /**
+         * \brief Send a command to the reader without blocking the caller.
+         *
+         * Only one command can be pending on a transport, and the callback must not issue blocking
+         * transport calls. The network transports call the callback from a reactor thread. The default
+         * implementation runs the blocking sendCommand on a command thread, which also calls the
+         * callback, so that a slow reader never holds a reactor thread. The command thread is joined
+         * by the next command or the transport destructor. The transport must be owned by a
+         * std::shared_ptr, which is kept until the callback returns.
+         * \param command The command buffer.
+         * \param timeout The command timeout.
+         * \param callback Called with the result of the command, or the error.
+         */
+        virtual void asyncSendCommand(const std::vector<unsigned char>& command, long int timeout, DataTransportCallback callback);
+
         /**
          * \brief Get the last command.
          * \return The last command.
@@ -102,6 +130,11 @@ namespace logicalaccess
          * \brief The last command.
          */
         std::vector<unsigned char> d_lastCommand;
+
+        /**
+         * \brief The thread of the last command sent by the default asyncSendCommand.
+         */
+        std::thread d_commandThread;
     };
 }
 
@@ -0,0 +1,203 @@
+/**
+ * \file framingbufferparser.hpp
+ * \brief Incremental framing engine for the reader circular buffers.
+ */
+
+#ifndef FRAMINGBUFFERPARSER_HPP
+#define FRAMINGBUFFERPARSER_HPP
+
+#include "logicalaccess/readerproviders/circularbufferparser.hpp"
+
+#include <functional>
+#include <vector>
+
+namespace logicalaccess
+{
+    /**
+     * \brief A frame located in a circular buffer, without copy.
+     *
+     * The frame may wrap around the end of the ring, it is then made of two contiguous parts. The span is
+     * valid until the circular buffer is modified.
+     */
+    class LIBLOGICALACCESS_API FrameSpan
+    {
+    public:
+
+        FrameSpan();
+
+        /**
+         * \brief Create a span over the first bytes of a circular buffer.
+         * \param circular_buffer The circular buffer.
+         * \param length The frame length.
+         */
+        FrameSpan(const boost::circular_buffer<unsigned char>& circular_buffer, size_t length);
+
+        size_t size() const { return d_firstLength + d_secondLength; };
+
+        bool empty() const { return size() == 0; };
+
+        unsigned char operator[](size_t index) const
+        {
+            return (index < d_firstLength) ? d_first[index] : d_second[index - d_firstLength];
+        };
+
+        /**
+         * \brief Copy a part of the frame.
+         * \param offset The offset of the first byte to copy.
+         * \param length The count of bytes to copy.
+         * \param out The destination, which must hold length bytes.
+         */
+        void copy(size_t offset, size_t length, unsigned char* out) const;
+
+        /**
+         * \brief Copy the frame to a vector.
+         * \return The frame data.
+         */
+        std::vector<unsigned char> toVector() const;
+
+    protected:
+
+        const unsigned char* d_first;
+
+        size_t d_firstLength;
+
+        const unsigned char* d_second;
+
+        size_t d_secondLength;
+    };
+
+    /**
+     * \brief A CircularBufferParser for the usual reader framings.
+     *
+     * A framing is made of an optional start of frame, bytes before it being dropped as noise, then either
+     * a length field or an end of frame byte, and optionally a trailer checked by a callback. The buffer is
+     * parsed incrementally: each byte is scanned once, whatever the number of calls needed to complete the
+     * frame.
+     */
+    class LIBLOGICALACCESS_API FramingBufferParser : public CircularBufferParser
+    {
+    public:
+
+        /**
+         * \brief The result of a parsing.
+         */
+        typedef enum
+        {
+            FS_INCOMPLETE = 0x00, /**< No complete frame buffered yet */
+            FS_VALID = 0x01, /**< A valid frame is at the beginning of the buffer */
+            FS_BAD_TRAILER = 0x02 /**< A complete frame is at the beginning of the buffer, but its trailer check failed */
+        } FrameStatus;
+
+        /**
+         * \brief Check the trailer (checksum, CRC...) of a complete frame.
+         */
+        typedef std::function<bool(const FrameSpan&)> TrailerChecker;
+
+        FramingBufferParser();
+
+        virtual ~FramingBufferParser() {};
+
+        /**
+         * \brief Set the start of frame. Bytes received before it are dropped.
+         * \param sof The start of frame bytes, empty for none.
+         */
+        void setStartOfFrame(const std::vector<unsigned char>& sof);
+
+        /**
+         * \brief Frame the data with a length field.
+         * \param offset The offset of the length field in the frame.
+         * \param size The length field size, 1 or 2 bytes.
+         * \param bigEndian True if the length field is big endian.
+         * \param adjustment Added to the length field value to get the whole frame length.
+         * \param headerLength The minimum frame length, which must include the length field.
+         */
+        void setLengthField(size_t offset, size_t size, bool bigEndian, int adjustment, size_t headerLength);
+
+        /**
+         * \brief Frame the data with an end of frame byte.
+         * \param eof The end of frame byte.
+         * \param minimumLength The minimum frame length, the end of frame byte being searched after it.
+         */
+        void setEndOfFrame(unsigned char eof, size_t minimumLength);
+
+        /**
+         * \brief Set the trailer check of the complete frames.
+         * \param checker The trailer checker, empty for none.
+         */
+        void setTrailerChecker(TrailerChecker checker);
+
+        /**
+         * \brief Check an XOR checksum trailer, computed on all the previous bytes of the frame.
+         * \param frame The frame.
+         * \return True if the checksum matches, false otherwise.
+         */
+        static bool checkXorTrailer(const FrameSpan& frame);
+
+        /**
+         * \brief Look for a complete frame at the beginning of the circular buffer, dropping the noise.
+         * \param circular_buffer The circular buffer.
+         * \param frame The frame found, when the status is not FS_INCOMPLETE.
+         * \return The parsing status.
+         */
+        FrameStatus parse(boost::circular_buffer<unsigned char>& circular_buffer, FrameSpan& frame);
+
+        /**
+         * \brief Remove a frame returned by parse() from the circular buffer.
+         * \param circular_buffer The circular buffer.
+         * \param frame The frame.
+         */
+        void consume(boost::circular_buffer<unsigned char>& circular_buffer, const FrameSpan& frame);
+
+        /**
+         * \brief Forget the parsing progress, when the circular buffer is cleared.
+         */
+        void reset();
+
+        /**
+         * \brief Get the next valid frame, dropping the frames with a bad trailer.
+         * \param circular_buffer The circular buffer.
+         * \return The frame, empty if none is complete yet.
+         */
+        virtual std::vector<unsigned char> getValidBuffer(boost::circular_buffer<unsigned char>& circular_buffer);
+
+    protected:
+
+        /**
+         * \brief Drop the bytes before the start of frame.
+         * \return True if the buffer starts with a complete start of frame.
+         */
+        bool synchronize(boost::circular_buffer<unsigned char>& circular_buffer);
+
+        /**
+         * \brief Drop the first byte, when it starts an invalid frame.
+         */
+        void resynchronize(boost::circular_buffer<unsigned char>& circular_buffer);
+
+        std::vector<unsigned char> d_sof;
+
+        bool d_useLength;
+
+        size_t d_lengthOffset;
+
+        size_t d_lengthSize;
+
+        bool d_lengthBigEndian;
+
+        int d_lengthAdjustment;
+
+        size_t d_headerLength;
+
+        unsigned char d_eof;
+
+        size_t d_minimumLength;
+
+        TrailerChecker d_trailerChecker;
+
+        /**
+         * \brief The count of bytes already scanned for the end of frame.
+         */
+        size_t d_scanned;
+    };
+}
+
+#endif /* FRAMINGBUFFERPARSER_HPP */
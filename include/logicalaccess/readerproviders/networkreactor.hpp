@@ -0,0 +1,127 @@
+/**
+ * \file networkreactor.hpp
+ * \brief Shared event loop for the network data transports.
+ */
+
+#ifndef LOGICALACCESS_NETWORKREACTOR_HPP
+#define LOGICALACCESS_NETWORKREACTOR_HPP
+
+#include "logicalaccess/logicalaccess_api.hpp"
+#include <boost/asio.hpp>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace logicalaccess
+{
+    /**
+     * \brief A multi-threaded asio event loop shared by all the TCP/UDP data transports.
+     *
+     * The transports register their sockets and timers on the reactor I/O service, so a couple of
+     * reactor threads drive the I/O of any number of network readers. Handlers of a given transport
+     * are serialized through its own strand.
+     */
+    class LIBLOGICALACCESS_API NetworkReactor
+    {
+    public:
+
+        /**
+         * \brief Get the reactor instance.
+         */
+        static NetworkReactor &getInstance();
+
+        /**
+         * \brief Destructor. Stop the reactor threads.
+         */
+        ~NetworkReactor();
+
+        /**
+         * \brief Get the shared I/O service. The reactor threads are started if needed.
+         * \return The I/O service.
+         */
+        boost::asio::io_service &getIOService();
+
+        /**
+         * \brief Set the number of reactor threads, applied on next start.
+         * \param threadCount The thread count. Default is 2.
+         */
+        void setThreadCount(unsigned int threadCount);
+
+        /**
+         * \brief Get the number of reactor threads.
+         * \return The thread count.
+         */
+        unsigned int getThreadCount() const;
+
+        /**
+         * \brief Start the reactor threads.
+         */
+        void start();
+
+        /**
+         * \brief Stop the reactor threads once the pending operations are completed.
+         */
+        void stop();
+
+    protected:
+
+        NetworkReactor();
+
+        NetworkReactor(const NetworkReactor &) = delete;
+        NetworkReactor &operator=(const NetworkReactor &) = delete;
+
+        /**
+         * \brief The reactor thread loop.
+         */
+        void run();
+
+        boost::asio::io_service d_ios;
+
+        std::unique_ptr<boost::asio::io_service::work> d_work;
+
+        std::vector<std::thread> d_threads;
+
+        unsigned int d_threadCount;
+
+        mutable std::mutex d_mutex;
+    };
+
+    /**
+     * \brief Count the asynchronous operations of a transport, so it can wait for their completion
+     * before being destroyed.
+     */
+    class LIBLOGICALACCESS_API PendingOperations
+    {
+    public:
+
+        PendingOperations();
+
+        /**
+         * \brief An operation started.
+         */
+        void begin();
+
+        /**
+         * \brief An operation completed, its handlers no longer use the transport.
+         */
+        void end();
+
+        /**
+         * \brief Wait until all the operations are completed.
+         */
+        void wait();
+
+    protected:
+
+        unsigned int d_count;
+
+        std::mutex d_mutex;
+
+        std::condition_variable d_cond;
+    };
+}
+
+#endif /* LOGICALACCESS_NETWORKREACTOR_HPP */
@@ -0,0 +1,244 @@
+/**
+ * \file readersessionengine.hpp
+ * \brief Concurrent card session engine over several reader units.
+ */
+
+#ifndef LOGICALACCESS_READERSESSIONENGINE_HPP
+#define LOGICALACCESS_READERSESSIONENGINE_HPP
+
+#include "logicalaccess/readerproviders/readerunit.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace logicalaccess
+{
+    /**
+     * \brief A job run on each detected card, the reader unit being connected to the chip.
+     */
+    typedef std::function<void(std::shared_ptr<ReaderUnit>, std::shared_ptr<Chip>)> CardSessionJob;
+
+    /**
+     * \brief A job run on a reader unit.
+     */
+    typedef std::function<void(std::shared_ptr<ReaderUnit>)> ReaderSessionJob;
+
+    /**
+     * \brief Called when a job failed, from the worker thread.
+     */
+    typedef std::function<void(std::shared_ptr<ReaderUnit>, const std::exception&)> ReaderSessionErrorHandler;
+
+    /**
+     * \brief Manage a pool of reader units and run card sessions on all of them at once.
+     *
+     * Each reader unit gets a detection thread running the blocking waitInsertion and
+     * waitRemoval polls. The detected cards sessions and the jobs posted by the caller are
+     * queued per reader unit and run on a shared pool of worker threads, so idle readers never
+     * hold a worker. Jobs of the same reader unit never run concurrently, nor during a poll, and
+     * run in the order they were queued, while different readers progress in parallel.
+     */
+    class LIBLOGICALACCESS_API ReaderSessionEngine
+    {
+    public:
+
+        /**
+         * \brief Constructor.
+         * \param workerCount The number of worker threads, 0 to use the hardware concurrency.
+         */
+        explicit ReaderSessionEngine(unsigned int workerCount = 0);
+
+        /**
+         * \brief Destructor. Stop the engine.
+         */
+        ~ReaderSessionEngine();
+
+        /**
+         * \brief Add a reader unit to the pool. Its detection starts immediately if the engine is running.
+         * \param readerUnit The reader unit.
+         */
+        void addReaderUnit(std::shared_ptr<ReaderUnit> readerUnit);
+
+        /**
+         * \brief Get the reader units of the pool.
+         * \return The reader units.
+         */
+        std::vector<std::shared_ptr<ReaderUnit> > getReaderUnits() const;
+
+        /**
+         * \brief Set the job run on each detected card.
+         * \param job The card job.
+         */
+        void setCardJob(CardSessionJob job);
+
+        /**
+         * \brief Set the handler called when a job throws.
+         * \param handler The error handler.
+         */
+        void setErrorHandler(ReaderSessionErrorHandler handler);
+
+        /**
+         * \brief Set the waitInsertion/waitRemoval timeout, which bounds the time stop() waits for detection threads.
+         *
+         * It also bounds the time a posted job waits for the current poll on its reader. The change applies from the next poll.
+         * \param pollInterval The timeout in milliseconds. Default is 500.
+         */
+        void setPollInterval(unsigned int pollInterval);
+
+        /**
+         * \brief Set if the engine waits for the card removal before detecting the next card on a reader.
+         * \param waitRemoval True to wait for the removal. Default is true.
+         */
+        void setWaitRemoval(bool waitRemoval);
+
+        /**
+         * \brief Start the worker threads and the cards detection.
+         */
+        void start();
+
+        /**
+         * \brief Stop the cards detection, run the already queued jobs and stop the worker threads.
+         */
+        void stop();
+
+        /**
+         * \brief Check if the engine is running.
+         * \return True if running, false otherwise.
+         */
+        bool isRunning() const;
+
+        /**
+         * \brief Queue a job on a reader unit, after the jobs already queued on it.
+         *
+         * The engine must be running: the jobs queued when stop() is called still run before it returns.
+         * \param readerUnit The reader unit, which must be in the pool.
+         * \param job The job.
+         */
+        void post(std::shared_ptr<ReaderUnit> readerUnit, ReaderSessionJob job);
+
+        /**
+         * \brief Get the number of card sessions completed without error.
+         * \return The transaction count.
+         */
+        uint64_t getTransactionCount() const;
+
+        /**
+         * \brief Get the number of failed jobs.
+         * \return The error count.
+         */
+        uint64_t getErrorCount() const;
+
+    protected:
+
+        ReaderSessionEngine(const ReaderSessionEngine&) = delete;
+        ReaderSessionEngine& operator=(const ReaderSessionEngine&) = delete;
+
+        /**
+         * \brief A reader unit of the pool, with its own jobs queue.
+         */
+        struct ReaderContext
+        {
+            std::shared_ptr<ReaderUnit> readerUnit;
+            std::deque<std::function<void()> > pending;
+            bool scheduled;
+            std::thread detector;
+
+            /**
+             * \brief Held during each reader unit call, the polls and the queued jobs.
+             */
+            std::mutex unitMutex;
+        };
+
+        /**
+         * \brief Find the context of a reader unit.
+         */
+        std::shared_ptr<ReaderContext> findContext(std::shared_ptr<ReaderUnit> readerUnit) const;
+
+        /**
+         * \brief Queue a task on a reader context, d_mutex being held.
+         * \return True if the context was idle and a worker must be notified.
+         */
+        bool schedule(std::shared_ptr<ReaderContext> context, std::function<void()> task);
+
+        /**
+         * \brief Queue a task on a reader context, scheduling the context if idle.
+         */
+        void enqueue(std::shared_ptr<ReaderContext> context, std::function<void()> task);
+
+        /**
+         * \brief Queue a task on a reader context and wait for it, rethrowing its error.
+         */
+        void runInQueue(std::shared_ptr<ReaderContext> context, std::function<void()> task);
+
+        /**
+         * \brief Run a card session on a connected reader.
+         */
+        void runCardSession(std::shared_ptr<ReaderContext> context);
+
+        /**
+         * \brief Report a failed job.
+         */
+        void reportError(std::shared_ptr<ReaderUnit> readerUnit, const std::exception& ex);
+
+        /**
+         * \brief Wait for a card insertion or removal on the detection thread, once the reader has no queued job.
+         * \return True if the card was inserted or removed, false on timeout or when stopping.
+         */
+        bool poll(std::shared_ptr<ReaderContext> context, bool insertion);
+
+        /**
+         * \brief The detection thread loop of a reader unit, polling and queuing the card sessions.
+         */
+        void detect(std::shared_ptr<ReaderContext> context);
+
+        /**
+         * \brief The worker thread loop.
+         */
+        void work();
+
+        unsigned int d_workerCount;
+
+        std::atomic<unsigned int> d_pollInterval;
+
+        std::atomic<bool> d_waitRemoval;
+
+        CardSessionJob d_cardJob;
+
+        ReaderSessionErrorHandler d_errorHandler;
+
+        std::vector<std::shared_ptr<ReaderContext> > d_readers;
+
+        /**
+         * \brief The reader contexts having pending jobs and not being run by a worker.
+         */
+        std::deque<std::shared_ptr<ReaderContext> > d_ready;
+
+        std::vector<std::thread> d_workers;
+
+        std::atomic<bool> d_running;
+
+        bool d_stopWorkers;
+
+        std::atomic<uint64_t> d_transactions;
+
+        std::atomic<uint64_t> d_errors;
+
+        mutable std::mutex d_mutex;
+
+        std::condition_variable d_cond;
+
+        /**
+         * \brief Signaled when a reader context has no more queued job, or on stop.
+         */
+        std::condition_variable d_idle;
+    };
+}
+
+#endif /* LOGICALACCESS_READERSESSIONENGINE_HPP */
@@ -8,6 +8,7 @@
 #ifndef SERIALPORT_HPP
 #define SERIALPORT_HPP
 
+#include <deque>
 #include <iostream>
 #include <string>
 #include <mutex>
@@ -22,6 +23,8 @@
 
 #include "logicalaccess/readerproviders/readerunit.hpp"
 #include "logicalaccess/readerproviders/circularbufferparser.hpp"
+#include "logicalaccess/readerproviders/networkreactor.hpp"
+#include "logicalaccess/readerproviders/serialportreactor.hpp"
 
 namespace logicalaccess
 {
@@ -32,7 +35,10 @@ namespace logicalaccess
      *
      * The serial port must open after construction. After it has been opened, a SerialPort should be configured using setConfiguration().
      *
-     * Then you can either read() or write() data, or simply wait for it using select().
+     * Then you can either read() or write() data, or simply wait for it using waitMoreData().
+     *
+     * All the serial ports are read by the SerialPortReactor thread. Received data is buffered in a
+     * growable ring buffer, and split into frames by the CircularBufferParser as soon as it arrives.
      */
     class LIBLOGICALACCESS_API SerialPort
     {
@@ -112,9 +118,9 @@ namespace logicalaccess
         }
 
         /**
-         * \brief Read some data from the serial port.
+         * \brief Read the next frame received on the serial port, or all the data received if there is no
+         * CircularBufferParser. Must be called while holding the internal mutex, see waitMoreData().
          * \param buf The buffer into which the new data must be stored.
-         * \param cnt The count of bytes to read. If cnt is 0, the call with return immediatly with a return value of 0.
          * \return The count of read bytes. buf.size() is also set, accordingly. Return value is 0 if no data is available.
          * \warning If buf contains data, it will be discarded, even if the call fails.
          *
@@ -148,11 +154,28 @@ namespace logicalaccess
         void setCharacterSize(unsigned int character_size);
         unsigned int getCharacterSize();
 
-        void setCircularBufferParser(CircularBufferParser* circular_buffer_parser) { m_circular_buffer_parser.reset(circular_buffer_parser); };
+        void setCircularBufferParser(CircularBufferParser* circular_buffer_parser)
+        {
+            std::unique_lock<std::mutex> ul(cond_var_mutex_);
+            m_circular_buffer_parser.reset(circular_buffer_parser);
+        };
         std::shared_ptr<CircularBufferParser> getCircularBufferParser() { return m_circular_buffer_parser; };
 
         boost::circular_buffer<unsigned char>& getCircularReadBuffer() { return m_circular_read_buffer; };
 
+        /**
+         * \brief Set the maximum size of the read ring buffer. The buffer grows on demand up to this size,
+         * the oldest data is then discarded.
+         * \param highWaterMark The maximum size in bytes. Default is 65536.
+         */
+        void setReadBufferHighWaterMark(size_t highWaterMark);
+
+        /**
+         * \brief Get the maximum size of the read ring buffer.
+         * \return The maximum size in bytes.
+         */
+        size_t getReadBufferHighWaterMark() const { return m_read_buffer_high_water_mark; };
+
         /**
          * Wait until more data are available, or until `until` is reach.
          *
@@ -189,8 +212,22 @@ namespace logicalaccess
         void dataConsumed();
 
     private:
+        friend class SerialPortReactor;
+
+        void start_read();
+
         void do_read(const boost::system::error_code& e, std::size_t bytes_transferred);
 
+        /**
+         * \brief Append received data to the ring buffer, growing it up to the high-water mark.
+         */
+        void buffer_data(const unsigned char* data, std::size_t length);
+
+        /**
+         * \brief Extract the complete frames from the ring buffer.
+         */
+        void extract_frames();
+
         void do_close(const boost::system::error_code& error);
 
         void do_write(const ByteVector &buf);
@@ -203,17 +240,35 @@ namespace logicalaccess
          */
         std::string m_dev;
 
-        boost::asio::io_service m_io;
+        /**
+         * \brief The shared serial port reactor I/O service.
+         */
+        boost::asio::io_service& m_io;
 
         boost::asio::serial_port m_serial_port;
 
         boost::circular_buffer<unsigned char> m_circular_read_buffer;
 
+        size_t m_read_buffer_high_water_mark;
+
+        /**
+         * \brief The frames extracted by the CircularBufferParser, not read yet.
+         */
+        std::deque<std::vector<unsigned char> > m_frames;
+
         std::vector<unsigned char> m_read_buffer;
 
         std::vector<unsigned char> m_write_buffer;
 
-        std::shared_ptr<std::thread> m_thread_reader;
+        /**
+         * \brief The data of the write in progress.
+         */
+        std::vector<unsigned char> m_writing_buffer;
+
+        /**
+         * \brief The reactor operations in progress, waited for on close.
+         */
+        PendingOperations m_pending;
 
         std::shared_ptr<CircularBufferParser> m_circular_buffer_parser;
 
@@ -0,0 +1,106 @@
+/**
+ * \file serialportreactor.hpp
+ * \brief Shared event loop for the serial ports.
+ */
+
+#ifndef LOGICALACCESS_SERIALPORTREACTOR_HPP
+#define LOGICALACCESS_SERIALPORTREACTOR_HPP
+
+#include "logicalaccess/logicalaccess_api.hpp"
+#include <boost/asio.hpp>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace logicalaccess
+{
+    class SerialPort;
+
+    /**
+     * \brief A single-threaded asio event loop multiplexing the I/O of all the serial ports.
+     *
+     * On Linux the I/O service waits on all the serial port descriptors with one epoll. All the serial
+     * port handlers run on the reactor thread, so they never run concurrently.
+     */
+    class LIBLOGICALACCESS_API SerialPortReactor
+    {
+    public:
+
+        /**
+         * \brief Get the reactor instance.
+         */
+        static SerialPortReactor &getInstance();
+
+        /**
+         * \brief Destructor. Stop the reactor thread.
+         */
+        ~SerialPortReactor();
+
+        /**
+         * \brief Get the shared I/O service. The reactor thread is started if needed.
+         * \return The I/O service.
+         */
+        boost::asio::io_service &getIOService();
+
+        /**
+         * \brief Stop the reactor thread. The open serial ports are closed, which completes their
+         * pending reads.
+         */
+        void stop();
+
+        /**
+         * \brief Run a handler on the reactor thread.
+         * \param handler The handler.
+         * \return False if the reactor is stopped and the handler is not run, true otherwise.
+         */
+        bool post(std::function<void()> handler);
+
+        /**
+         * \brief Register an open serial port, to close on stop.
+         * \param port The serial port.
+         */
+        void addPort(SerialPort *port);
+
+        /**
+         * \brief Unregister a serial port being closed.
+         * \param port The serial port.
+         */
+        void removePort(SerialPort *port);
+
+        /**
+         * \brief Check if the calling thread is the reactor thread.
+         * \return True if called from the reactor thread, false otherwise.
+         */
+        bool isReactorThread() const;
+
+    protected:
+
+        SerialPortReactor();
+
+        SerialPortReactor(const SerialPortReactor &) = delete;
+        SerialPortReactor &operator=(const SerialPortReactor &) = delete;
+
+        /**
+         * \brief The reactor thread loop.
+         */
+        void run();
+
+        boost::asio::io_service d_ios;
+
+        std::unique_ptr<boost::asio::io_service::work> d_work;
+
+        std::thread d_thread;
+
+        /**
+         * \brief The open serial ports.
+         */
+        std::set<SerialPort *> d_ports;
+
+        mutable std::mutex d_mutex;
+    };
+}
+
+#endif /* LOGICALACCESS_SERIALPORTREACTOR_HPP */
@@ -8,6 +8,7 @@
 #define LOGICALACCESS_TCPDATATRANSPORT_HPP
 
 #include "logicalaccess/readerproviders/datatransport.hpp"
+#include "logicalaccess/readerproviders/networkreactor.hpp"
 #include <boost/asio.hpp>
 #include <boost/asio/deadline_timer.hpp>
 
@@ -123,31 +124,67 @@ namespace logicalaccess
          */
         virtual std::vector<unsigned char> receive(long int timeout);
 
-		/**
-         * \brief Connect complete
-		 * \param error Read error
+        /**
+         * \brief Send a command to the reader without blocking the caller, using the network reactor.
+         * \param command The command buffer.
+         * \param timeout The command timeout.
+         * \param callback Called with the result of the command, or the error.
          */
-		void connect_complete(const boost::system::error_code& error);
+        virtual void asyncSendCommand(const std::vector<unsigned char>& command, long int timeout, DataTransportCallback callback);
 
-		/**
-         * \brief Read complete
-		 * \param error Read error
-		 * \param bytes_transferred Byte transfered
+    protected:
+
+        /**
+         * \brief Called when an asynchronous receive completed, with the data received or the error.
          */
-		void read_complete(const boost::system::error_code& error, size_t bytes_transferred);
+        typedef std::function<void(std::exception_ptr, const std::vector<unsigned char>&)> ReceiveHandler;
 
-		/**
-         * \brief Read timeout
-		 * \param error Read timeout or canceled
+        /**
+         * \brief Called when an asynchronous send completed, with the error if any.
          */
-	    void time_out(const boost::system::error_code& error);
+        typedef std::function<void(std::exception_ptr)> SendHandler;
 
-    protected:
+        /**
+         * \brief Connect to the transport layer asynchronously.
+         * \param timeout Time after the connect task will be canceled.
+         * \param handler Called on the strand once connected or on failure.
+         */
+        void asyncConnect(long int timeout, std::function<void(const boost::system::error_code&)> handler);
+
+        /**
+         * \brief Send a packet asynchronously. Must be called on the strand.
+         * \param data The packet.
+         * \param handler Called on the strand once the packet is sent, or on failure.
+         */
+        virtual void asyncSend(const std::vector<unsigned char>& data, SendHandler handler);
+
+        /**
+         * \brief Receive a packet asynchronously.
+         * \param timeout Time waiting for data.
+         * \param handler Called on the strand with the data received or the error.
+         */
+        virtual void asyncReceive(long int timeout, ReceiveHandler handler);
+
+        /**
+         * \brief Cancel the pending operations and wait for their handlers. Called on destruction.
+         */
+        void cancelOperations();
+
+        /**
+         * \brief Run a task on the strand and wait for its completion.
+         * \param task The task.
+         */
+        void runOnStrand(std::function<void()> task);
+
+        /**
+         * \brief The shared network reactor I/O service.
+         */
+        boost::asio::io_service& d_ios;
 
         /**
-         * \brief Provides core I/O functionality
+         * \brief Serialize the handlers of this transport.
          */
-        boost::asio::io_service d_ios;
+        boost::asio::io_service::strand d_strand;
 
         /**
          * \brief TCP Socket
@@ -159,15 +196,15 @@ namespace logicalaccess
          */
 		boost::asio::deadline_timer d_timer;
 
-		/**
-         * \brief Read error
+        /**
+         * \brief The receive buffer, reused by all the reads.
          */
-		bool d_read_error;
+        std::vector<unsigned char> d_recvBuffer;
 
-		/**
-         * \brief Byte Readed
+        /**
+         * \brief The asynchronous operations in progress.
          */
-		size_t d_bytes_transferred;
+        PendingOperations d_pending;
 
         /**
          * \brief The ip address
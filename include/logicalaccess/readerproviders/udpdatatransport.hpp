@@ -8,7 +8,9 @@
 #define LOGICALACCESS_UDPDATATRANSPORT_HPP
 
 #include "logicalaccess/readerproviders/datatransport.hpp"
+#include "logicalaccess/readerproviders/networkreactor.hpp"
 #include <boost/asio.hpp>
+#include <boost/asio/deadline_timer.hpp>
 
 namespace logicalaccess
 {
@@ -111,17 +113,52 @@ namespace logicalaccess
 
         virtual std::vector<unsigned char> receive(long int timeout);
 
+        /**
+         * \brief Send a command to the reader without blocking the caller, using the network reactor.
+         * \param command The command buffer.
+         * \param timeout The command timeout.
+         * \param callback Called with the result of the command, or the error.
+         */
+        virtual void asyncSendCommand(const std::vector<unsigned char>& command, long int timeout, DataTransportCallback callback);
+
     protected:
 
+        /**
+         * \brief Receive a datagram asynchronously.
+         * \param timeout Time waiting for data, 0 to wait forever.
+         * \param handler Called on the strand with the data received, empty on timeout.
+         */
+        void asyncReceive(long int timeout, std::function<void(const std::vector<unsigned char>&)> handler);
+
         /**
          * \brief Client socket use to communicate with the reader.
          */
         std::shared_ptr<boost::asio::ip::udp::socket> d_socket;
 
         /**
-         * \brief Provides core I/O functionality
+         * \brief The shared network reactor I/O service.
+         */
+        boost::asio::io_service& ios;
+
+        /**
+         * \brief Serialize the handlers of this transport.
+         */
+        boost::asio::io_service::strand d_strand;
+
+        /**
+         * \brief Receive timeout timer.
+         */
+        boost::asio::deadline_timer d_timer;
+
+        /**
+         * \brief The receive buffer, reused by all the reads.
+         */
+        std::vector<unsigned char> d_recvBuffer;
+
+        /**
+         * \brief The asynchronous operations in progress.
          */
-        boost::asio::io_service ios;
+        PendingOperations d_pending;
 
         /**
          * \brief The ip address
@@ -0,0 +1,123 @@
+/**
+ * \file formatbatchdecoder.hpp
+ * \brief Batch decoder of raw format payloads.
+ */
+
+#ifndef LOGICALACCESS_FORMATBATCHDECODER_HPP
+#define LOGICALACCESS_FORMATBATCHDECODER_HPP
+
+#include "logicalaccess/services/accesscontrol/formats/format.hpp"
+
+#include <string>
+#include <vector>
+
+namespace logicalaccess
+{
+    /**
+     * \brief Decoded credentials, one entry per payload in each array.
+     */
+    struct DecodedCredentials
+    {
+        std::vector<unsigned long long> facilityCodes; /**< \brief The facility codes, 0 if the format has none or on parity error. */
+        std::vector<unsigned long long> cardNumbers; /**< \brief The card numbers, 0 on parity error. */
+        std::vector<unsigned char> parityOk; /**< \brief 1 if the payload decoded without parity error, 0 otherwise. */
+    };
+
+    /**
+     * \brief Decode many fixed-length payloads with the same format.
+     *
+     * The format is cloned once per worker thread and its fields are looked up once,
+     * then each payload is decoded in place into the caller arrays.
+     */
+    class LIBLOGICALACCESS_API FormatBatchDecoder
+    {
+    public:
+
+        /**
+         * \brief Constructor.
+         * \param format The format of the payloads. It is not modified.
+         * \param facilityCodeField The name of the facility code field.
+         * \param cardNumberField The name of the card number field. Empty to use the format identifier field.
+         */
+        explicit FormatBatchDecoder(std::shared_ptr<Format> format,
+                                    const std::string& facilityCodeField = "FacilityCode",
+                                    const std::string& cardNumberField = "");
+
+        /**
+         * \brief Set the maximum number of worker threads.
+         * \param threadCount The thread count, 0 to use the hardware concurrency. Default is 1.
+         */
+        void setThreadCount(unsigned int threadCount);
+
+        /**
+         * \brief Get the maximum number of worker threads.
+         * \return The thread count, 0 for the hardware concurrency.
+         */
+        unsigned int getThreadCount() const;
+
+        /**
+         * \brief Set the minimum number of payloads given to a worker thread.
+         * \param chunkSize The minimum number of payloads per thread.
+         */
+        void setMinimumChunkSize(size_t chunkSize);
+
+        /**
+         * \brief Decode payloads into caller owned arrays.
+         * \param payloads The contiguous payloads.
+         * \param payloadLengthBytes The length of each payload in bytes.
+         * \param count The number of payloads.
+         * \param facilityCodes The facility codes, count entries. Can be NULL.
+         * \param cardNumbers The card numbers, count entries. Can be NULL.
+         * \param parityOk The parity flags, count entries. Can be NULL.
+         * \return The number of payloads decoded without parity error.
+         * \exception LibLogicalAccessException if a payload can't be decoded for another reason than its parity.
+         */
+        size_t decode(const void* payloads, size_t payloadLengthBytes, size_t count,
+                      unsigned long long* facilityCodes, unsigned long long* cardNumbers, unsigned char* parityOk) const;
+
+        /**
+         * \brief Decode payloads.
+         * \param payloads The contiguous payloads.
+         * \param payloadLengthBytes The length of each payload in bytes.
+         * \param count The number of payloads.
+         * \param credentials The decoded credentials, resized to count entries.
+         * \return The number of payloads decoded without parity error.
+         */
+        size_t decode(const void* payloads, size_t payloadLengthBytes, size_t count, DecodedCredentials& credentials) const;
+
+    protected:
+
+        /**
+         * \brief Decode a contiguous range of payloads with a private copy of the format.
+         */
+        size_t decodeRange(const unsigned char* payloads, size_t payloadLengthBytes, size_t first, size_t last,
+                           unsigned long long* facilityCodes, unsigned long long* cardNumbers, unsigned char* parityOk) const;
+
+        /**
+         * \brief The format.
+         */
+        std::shared_ptr<Format> d_format;
+
+        /**
+         * \brief The facility code field name.
+         */
+        std::string d_facilityCodeField;
+
+        /**
+         * \brief The card number field name.
+         */
+        std::string d_cardNumberField;
+
+        /**
+         * \brief The maximum number of worker threads.
+         */
+        unsigned int d_threadCount;
+
+        /**
+         * \brief The minimum number of payloads per thread.
+         */
+        size_t d_minimumChunkSize;
+    };
+}
+
+#endif /* LOGICALACCESS_FORMATBATCHDECODER_HPP */
@@ -123,6 +123,12 @@ namespace logicalaccess
          */
         virtual bool checkSkeleton(std::shared_ptr<Format> format) const;
 
+        /**
+         * \brief Create a copy of the format, configuration and values included.
+         * \return The new format instance.
+         */
+        virtual std::shared_ptr<Format> clone() const;
+
         /**
          * \brief The format need user configuration to be use.
          * \return True if it need, false otherwise.
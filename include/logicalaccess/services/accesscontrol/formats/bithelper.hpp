@@ -133,6 +133,45 @@ namespace logicalaccess
             unsigned int* writePosBits,
             unsigned char data,
             unsigned int readPosBits, unsigned int readLengthBits);
+
+        /**
+         * \brief Read up to 64 bits from "data" as a big endian number
+         * \param data Buffer to be readed
+         * \param dataLengthBytes Length of data in bytes
+         * \param readPosBits Offset of "data" you want to start to read (in bits)
+         * \param readLengthBits Length to read (in bits, 64 maximum)
+         * \return The bits read, right aligned
+         */
+        static unsigned long long readBits(const void* data, size_t dataLengthBytes,
+            unsigned int readPosBits, unsigned int readLengthBits);
+
+        /**
+         * \brief Write the "writeLengthBits" lower bits of "value" into "writtenData", like writeToBit does
+         * \param writtenData Buffer to be modified
+         * \param writtenDataLengthBytes Length of data (in bytes)
+         * \param writePosBits Offset in "writtenData" buffer you want to start to write (in bits)
+         * \param value The value to write
+         * \param writeLengthBits Length to write (in bits, 64 maximum)
+         */
+        static void writeBits(void* writtenData, size_t writtenDataLengthBytes,
+            unsigned int writePosBits,
+            unsigned long long value, unsigned int writeLengthBits);
+
+        /**
+         * \brief Count the bits set in "value"
+         * \param value The value
+         * \return The number of bits set
+         */
+        static unsigned int popCount(unsigned long long value);
+
+        /**
+         * \brief Count the bits set in "data" for the bits set in "mask"
+         * \param data Buffer to be readed
+         * \param mask The mask, at most as long as "data"
+         * \param maskLengthBytes Length of mask in bytes
+         * \return The number of bits set
+         */
+        static unsigned int popCount(const void* data, const void* mask, size_t maskLengthBytes);
     };
 }
 
@@ -140,6 +140,12 @@ namespace logicalaccess
          */
         virtual bool checkSkeleton(std::shared_ptr<DataField> field) const;
 
+        /**
+         * \brief Create a copy of the field.
+         * \return The new field instance.
+         */
+        virtual std::shared_ptr<DataField> clone() const;
+
         /**
          * \brief Serialize the current object to XML.
          * \param parentNode The parent node.
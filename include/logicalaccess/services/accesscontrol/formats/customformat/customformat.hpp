@@ -9,8 +9,10 @@
 
 #include "logicalaccess/services/accesscontrol/formats/format.hpp"
 #include "logicalaccess/services/accesscontrol/formats/customformat/datafield.hpp"
+#include "logicalaccess/services/accesscontrol/formats/customformat/formatlayout.hpp"
 
 #include <list>
+#include <memory>
 
 namespace logicalaccess
 {
@@ -108,6 +110,12 @@ namespace logicalaccess
          */
         virtual std::string getDefaultXmlNodeName() const;
 
+        /**
+         * \brief Create a copy of the format, configuration and values included.
+         * \return The new format instance.
+         */
+        virtual std::shared_ptr<Format> clone() const;
+
         /**
          * \brief Get the associated field for a specific position.
          * \param position The position.
@@ -122,10 +130,21 @@ namespace logicalaccess
          */
         void reorderFields();
 
+        /**
+         * \brief Get the compiled layout of the fields list, compiling it again if the fields changed.
+         * \return The fields layout.
+         */
+        std::shared_ptr<FormatLayout> getLayout() const;
+
         /**
          * \brief The custom format name.
          */
         std::string d_name;
+
+        /**
+         * \brief The last compiled fields layout, only accessed through std::atomic_load and std::atomic_store.
+         */
+        mutable std::shared_ptr<FormatLayout> d_layout;
     };
 }
 
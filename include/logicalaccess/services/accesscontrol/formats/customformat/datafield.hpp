@@ -65,6 +65,12 @@ namespace logicalaccess
          */
         std::string getName() const;
 
+        /**
+         * \brief Get the field layout revision, changed each time the field position, length or encoding is modified.
+         * \return The layout revision.
+         */
+        unsigned int getRevision() const;
+
         /**
          * \brief Get linear data.
          * \param data Where to put data
@@ -88,6 +94,12 @@ namespace logicalaccess
          */
         virtual bool checkSkeleton(std::shared_ptr<DataField> field) const = 0;
 
+        /**
+         * \brief Create a copy of the field.
+         * \return The new field instance.
+         */
+        virtual std::shared_ptr<DataField> clone() const = 0;
+
         /**
          * \brief Serialize the current object to XML.
          * \param parentNode The parent node.
@@ -116,6 +128,11 @@ namespace logicalaccess
          * \brief The field position in bits.
          */
         unsigned int d_position;
+
+        /**
+         * \brief The field layout revision.
+         */
+        unsigned int d_revision;
     };
 }
 
@@ -0,0 +1,102 @@
+/**
+ * \file formatlayout.hpp
+ * \brief Compiled bit layout of a custom format.
+ */
+
+#ifndef LOGICALACCESS_FORMATLAYOUT_HPP
+#define LOGICALACCESS_FORMATLAYOUT_HPP
+
+#include "logicalaccess/services/accesscontrol/formats/customformat/datafield.hpp"
+#include "logicalaccess/services/accesscontrol/formats/customformat/numberdatafield.hpp"
+#include "logicalaccess/services/accesscontrol/formats/customformat/paritydatafield.hpp"
+
+#include <list>
+#include <vector>
+
+namespace logicalaccess
+{
+    /**
+     * \brief The bit layout of a field list, computed once and reused for each encoding / decoding.
+     *
+     * Fields are sorted once. Binary number fields are read and written as whole words and parity
+     * fields are computed with a precomputed bit mask. Other fields use their own linear data methods.
+     */
+    class LIBLOGICALACCESS_API FormatLayout
+    {
+    public:
+
+        /**
+         * \brief Compile the layout of a field list.
+         * \param fields The field list.
+         */
+        explicit FormatLayout(const std::list<std::shared_ptr<DataField> >& fields);
+
+        /**
+         * \brief Check the layout still matches a field list.
+         * \param fields The field list.
+         * \return True if the fields and their configuration didn't change since compilation, false otherwise.
+         */
+        bool isUpToDate(const std::list<std::shared_ptr<DataField> >& fields) const;
+
+        /**
+         * \brief Get linear data from the fields values.
+         * \param data Where to put data
+         * \param dataLengthBytes Length in byte of data
+         */
+        void getLinearData(void* data, size_t dataLengthBytes) const;
+
+        /**
+         * \brief Set the fields values from linear data.
+         * \param data Where to get data
+         * \param dataLengthBytes Length of data in bytes
+         */
+        void setLinearData(const void* data, size_t dataLengthBytes) const;
+
+    protected:
+
+        /**
+         * \brief The way a field is encoded / decoded.
+         */
+        typedef enum {
+            LS_FIELD = 0x00, /**< Use the field linear data methods */
+            LS_NUMBER = 0x01, /**< Binary number field, read and written directly */
+            LS_PARITY = 0x02 /**< Parity field, computed with a mask */
+        } LayoutStepType;
+
+        /**
+         * \brief A compiled field.
+         */
+        struct LayoutStep
+        {
+            LayoutStepType type;
+            std::shared_ptr<DataField> field;
+            std::shared_ptr<NumberDataField> numberField;
+            unsigned int position;
+            unsigned int length;
+            ParityType parityType;
+            std::vector<unsigned char> parityMask;
+        };
+
+        /**
+         * \brief Compute the parity bit of a parity step.
+         */
+        static unsigned char computeParity(const LayoutStep& step, const void* data);
+
+        /**
+         * \brief The fields and their revision, in the format field list order.
+         */
+        std::vector<std::pair<const DataField*, unsigned int> > d_revisions;
+
+        /**
+         * \brief The encodings of the binary number fields, checked in place as they can be modified without changing the field revision.
+         */
+        std::vector<std::pair<const DataType*, const DataRepresentation*> > d_encodings;
+
+        /**
+         * \brief The compiled fields, sorted in processing order.
+         */
+        std::vector<LayoutStep> d_steps;
+    };
+}
+
+#endif /* LOGICALACCESS_FORMATLAYOUT_HPP */
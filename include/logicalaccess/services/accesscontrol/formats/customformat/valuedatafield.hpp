@@ -139,6 +139,13 @@ namespace logicalaccess
 
     protected:
 
+        /**
+         * \brief Give the field its own data representation and data type instances.
+         *
+         * Used after a copy so the clone does not share its encodings with the original field.
+         */
+        void detachEncodings();
+
         /**
          * \brief The Data Representation.
          */
@@ -117,6 +117,12 @@ namespace logicalaccess
          */
         static std::shared_ptr<Format> getByFormatType(FormatType type);
 
+        /**
+         * \brief Create a copy of the format, configuration and values included.
+         * \return The new format instance.
+         */
+        virtual std::shared_ptr<Format> clone() const;
+
         /**
          * \brief Get values field list.
          * \return The values field list.
@@ -148,6 +154,14 @@ namespace logicalaccess
          */
         static unsigned char calculateParity(const void* data, size_t dataLengthBytes, ParityType parityType, unsigned int* positions, size_t nbPositions);
 
+        /**
+         * \brief Check if numbers are stored as is with these encodings, so they can be read and written directly as bits.
+         * \param dataType The data type
+         * \param dataRepresentation The data representation
+         * \return True if the encodings don't transform the value, false otherwise.
+         */
+        static bool isPlainBinaryEncoding(const DataType* dataType, const DataRepresentation* dataRepresentation);
+
         /**
          * \brief Get the identifier.
          * \return The identifier.
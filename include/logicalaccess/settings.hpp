@@ -45,6 +45,28 @@ namespace logicalaccess
         bool ColorizeLog;
         bool ContextLog;
 
+        /**
+         * Write the logs from a background thread instead of the calling thread.
+         */
+        bool AsyncLog;
+
+        /**
+         * Number of pending lines the asynchronous log writer can hold.
+         */
+        long int AsyncLogQueueSize;
+
+        /**
+         * Block the caller instead of dropping the line when the asynchronous
+         * log queue is full.
+         */
+        bool AsyncLogBlockOnOverflow;
+
+        /**
+         * Maximum delay, in milliseconds, before asynchronous logs are flushed.
+         * Lines of ERRORS severity or worse are flushed immediately.
+         */
+        long int AsyncLogFlushInterval;
+
         /* Auto-Detection */
         bool IsAutoDetectEnabled;
         long int AutoDetectionTimeout;
@@ -57,6 +79,19 @@ namespace logicalaccess
         std::string DefaultReader;
         std::vector<std::string> PluginFolders;
 
+        /**
+         * Plug-ins index file, mapping the exported factories to their library
+         * so plug-ins are only loaded when first used. It is written by the
+         * first scan and rebuilt when the plug-in files change.
+         * Empty to load every plug-in at first scan.
+         */
+        std::string PluginIndexFile;
+
+        /**
+         * Preload the indexed plug-ins on background threads after the scan.
+         */
+        bool PluginWarmUp;
+
         /* Networking */
 
         /**
@@ -6,6 +6,7 @@
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 
 /**
  * Platform independent utils.
@@ -15,6 +16,22 @@ namespace logicalaccess
 {
 uint32_t lla_htonl(uint32_t in);
 uint16_t lla_htons(uint16_t in);
+uint32_t lla_ntohl(uint32_t in);
+uint16_t lla_ntohs(uint16_t in);
+
+/**
+ * Split [0, count) in contiguous ranges processed on worker threads, the
+ * calling thread waiting for them. The first range error is rethrown once
+ * all the ranges are done.
+ *
+ * `threadCount` is the maximum number of threads, 0 for the hardware
+ * concurrency. A range has at least `minimumRange` items: smaller batches
+ * run inline, on the calling thread.
+ *
+ * `process` is called with each [begin, end) range, from a worker thread.
+ */
+LIBLOGICALACCESS_API void parallelFor(size_t count, size_t threadCount, size_t minimumRange,
+                                      const std::function<void(size_t, size_t)> &process);
 
 /**
  * This class provide a simple to get the elapsed time since
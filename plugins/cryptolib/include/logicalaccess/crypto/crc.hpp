@@ -0,0 +1,105 @@
+/**
+ * \file crc.hpp
+ * \brief CRC functions used by the reader and card protocols.
+ */
+
+#ifndef CRC_HPP
+#define CRC_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace logicalaccess
+{
+    /**
+     * \brief Table driven CRC engine.
+     *
+     * The 16-bit and 32-bit CRCs are computed eight bytes at a time with slice-by-8 tables. On x86
+     * processors supporting carry-less multiplication, long CRC32 buffers are folded with PCLMULQDQ,
+     * the implementation being selected at runtime.
+     *
+     * The update functions work on the raw CRC register: the initial value and the final xor of each
+     * protocol are left to the caller.
+     */
+    class CRC
+    {
+    public:
+
+        /**
+         * \brief Update a reflected CRC16 with the 0x8408 polynomial (Kermit, ISO14443 CRC_A and CRC_B).
+         * \param crc The CRC register.
+         * \param data The data buffer.
+         * \param length The data length.
+         * \return The updated CRC register.
+         */
+        static uint16_t updateCRC16Reflected(uint16_t crc, const unsigned char* data, size_t length);
+
+        /**
+         * \brief Update a CRC16 with the 0x1021 polynomial, most significant bit first (CCITT).
+         * \param crc The CRC register.
+         * \param data The data buffer.
+         * \param length The data length.
+         * \return The updated CRC register.
+         */
+        static uint16_t updateCRC16CCITT(uint16_t crc, const unsigned char* data, size_t length);
+
+        /**
+         * \brief Update a reflected CRC32 with the 0xEDB88320 polynomial (IEEE 802.3).
+         * \param crc The CRC register.
+         * \param data The data buffer.
+         * \param length The data length.
+         * \return The updated CRC register.
+         */
+        static uint32_t updateCRC32(uint32_t crc, const unsigned char* data, size_t length);
+
+        /**
+         * \brief Update a reflected CRC32 with the slice-by-8 tables only.
+         * \param crc The CRC register.
+         * \param data The data buffer.
+         * \param length The data length.
+         * \return The updated CRC register.
+         */
+        static uint32_t updateCRC32Table(uint32_t crc, const unsigned char* data, size_t length);
+
+        /**
+         * \brief Check if the carry-less multiplication CRC32 is used on this processor.
+         * \return True if PCLMULQDQ is available, false otherwise.
+         */
+        static bool hasCarrylessMultiply();
+
+        /**
+         * \brief Compute the ISO14443-3 CRC_A.
+         * \param data The data buffer.
+         * \param length The data length.
+         * \return The CRC, transmitted least significant byte first.
+         */
+        static uint16_t crcA(const unsigned char* data, size_t length)
+        {
+            return updateCRC16Reflected(0x6363, data, length);
+        }
+
+        /**
+         * \brief Compute the ISO14443-3 CRC_B.
+         * \param data The data buffer.
+         * \param length The data length.
+         * \return The CRC, transmitted least significant byte first.
+         */
+        static uint16_t crcB(const unsigned char* data, size_t length)
+        {
+            return static_cast<uint16_t>(~updateCRC16Reflected(0xFFFF, data, length));
+        }
+
+        /**
+         * \brief Compute the Kermit CRC.
+         * \param data The data buffer.
+         * \param length The data length.
+         * \return The CRC, transmitted least significant byte first.
+         */
+        static uint16_t crcKermit(const unsigned char* data, size_t length)
+        {
+            return updateCRC16Reflected(0x0000, data, length);
+        }
+    };
+}
+
+#endif /* CRC_HPP */
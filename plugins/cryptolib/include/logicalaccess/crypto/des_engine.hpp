@@ -0,0 +1,145 @@
+/**
+ * \file des_engine.hpp
+ * \brief DES/3DES block engine with runtime selected implementations.
+ */
+
+#ifndef DES_ENGINE_HPP
+#define DES_ENGINE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace logicalaccess
+{
+    struct DESEngineSchedules;
+
+    /**
+     * \brief A DES or 3DES key with its key schedules, ready to cipher blocks.
+     *
+     * Two implementations are available:
+     * - the libtomcrypt tables, the reference, for short buffers;
+     * - a bitsliced DES for bulk buffers, processing 64 blocks at once, or 256 blocks with AVX2.
+     *
+     * The default implementation is selected from the buffer length and the processor features. An engine
+     * must not be used by several threads at once.
+     */
+    class DESEngine
+    {
+    public:
+
+        /**
+         * \brief The DES implementations.
+         */
+        typedef enum
+        {
+            DES_BACKEND_TABLE = 0x00, /**< libtomcrypt tables */
+            DES_BACKEND_BITSLICE = 0x01 /**< Bitsliced DES */
+        } Backend;
+
+        /**
+         * \brief Constructor.
+         * \param key The key, 8 bytes for DES, 16 bytes for 2K3DES or 24 bytes for 3K3DES.
+         * \param keyLength The key length.
+         */
+        DESEngine(const unsigned char* key, size_t keyLength);
+
+        /**
+         * \brief Constructor.
+         * \param key The key, 8 bytes for DES, 16 bytes for 2K3DES or 24 bytes for 3K3DES.
+         */
+        explicit DESEngine(const std::vector<unsigned char>& key);
+
+        /**
+         * \brief Destructor.
+         */
+        ~DESEngine();
+
+        DESEngine(const DESEngine&) = delete;
+        DESEngine& operator=(const DESEngine&) = delete;
+
+        /**
+         * \brief Get the key.
+         * \return The key data.
+         */
+        const std::vector<unsigned char>& getKey() const { return d_key; };
+
+        /**
+         * \brief Encrypt blocks in ECB mode.
+         * \param src The blocks.
+         * \param length The length, a multiple of 8.
+         * \param dest The destination, which must hold length bytes. It may be the source buffer.
+         */
+        void encrypt(const unsigned char* src, size_t length, unsigned char* dest);
+
+        /**
+         * \brief Decrypt blocks in ECB mode.
+         * \param src The blocks.
+         * \param length The length, a multiple of 8.
+         * \param dest The destination, which must hold length bytes. It may be the source buffer.
+         */
+        void decrypt(const unsigned char* src, size_t length, unsigned char* dest);
+
+        /**
+         * \brief Encrypt or decrypt blocks in ECB mode with a given implementation.
+         * \param backend The implementation.
+         * \param encrypt True to encrypt, false to decrypt.
+         * \param src The blocks.
+         * \param length The length, a multiple of 8.
+         * \param dest The destination, which must hold length bytes. It may be the source buffer.
+         */
+        void process(Backend backend, bool encrypt, const unsigned char* src, size_t length, unsigned char* dest);
+
+        /**
+         * \brief Encrypt blocks in CBC mode.
+         * \param src The blocks.
+         * \param length The length, a multiple of 8.
+         * \param iv The 8 bytes initialization vector, updated with the last ciphered block.
+         * \param dest The destination, which must hold length bytes. It may be the source buffer.
+         */
+        void encryptCBC(const unsigned char* src, size_t length, unsigned char* iv, unsigned char* dest);
+
+        /**
+         * \brief Decrypt blocks in CBC mode.
+         * \param src The blocks.
+         * \param length The length, a multiple of 8.
+         * \param iv The 8 bytes initialization vector, updated with the last ciphered block.
+         * \param dest The destination, which must hold length bytes. It may be the source buffer.
+         */
+        void decryptCBC(const unsigned char* src, size_t length, unsigned char* iv, unsigned char* dest);
+
+        /**
+         * \brief Get the implementation used by default for a count of blocks.
+         * \param blocks The count of blocks.
+         * \return The implementation.
+         */
+        static Backend selectBackend(size_t blocks);
+
+        /**
+         * \brief Get the count of blocks processed at once by the bitsliced implementation on this processor.
+         * \return 256 with AVX2, 64 otherwise.
+         */
+        static size_t getBitsliceBlocks();
+
+        /**
+         * \brief Get an engine for a key from the calling thread cache, to keep the key schedules of the recently used keys.
+         * \param key The key, 8 bytes for DES, 16 bytes for 2K3DES or 24 bytes for 3K3DES.
+         * \return The engine, only to be used by the calling thread.
+         */
+        static std::shared_ptr<DESEngine> getEngine(const std::vector<unsigned char>& key);
+
+    protected:
+
+        /**
+         * \brief The key.
+         */
+        std::vector<unsigned char> d_key;
+
+        /**
+         * \brief The libtomcrypt and bitsliced key schedules.
+         */
+        std::unique_ptr<DESEngineSchedules> d_schedules;
+    };
+}
+
+#endif /* DES_ENGINE_HPP */
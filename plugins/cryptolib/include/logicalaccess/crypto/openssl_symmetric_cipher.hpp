@@ -16,6 +16,7 @@ namespace logicalaccess
     namespace openssl
     {
         class OpenSSLSymmetricCipherContext;
+        class SymmetricCipherSession;
 
         /**
          * \brief A OpenSSL symmetric cipher base class.
@@ -131,6 +132,8 @@ namespace logicalaccess
              * \brief The encryption mode.
              */
             EncMode d_mode;
+
+            friend class SymmetricCipherSession;
         };
     }
 }
@@ -0,0 +1,163 @@
+/**
+ * \file symmetric_cipher_session.hpp
+ * \brief Symmetric cipher session class.
+ */
+
+#ifndef SYMMETRIC_CIPHER_SESSION_HPP
+#define SYMMETRIC_CIPHER_SESSION_HPP
+
+#include "logicalaccess/crypto/openssl_symmetric_cipher.hpp"
+#include "logicalaccess/crypto/symmetric_key.hpp"
+
+#include <vector>
+
+#include <openssl/evp.h>
+
+namespace logicalaccess
+{
+    namespace openssl
+    {
+        /**
+         * \brief A CBC cipher bound to a session key.
+         *
+         * The OpenSSL contexts are initialized once with the session key and the CMAC subkeys are derived
+         * once, so that each secure messaging operation only costs its block operations.
+         */
+        class SymmetricCipherSession
+        {
+        public:
+
+            /**
+             * \brief Constructor.
+             * \param cipher The cipher, giving the algorithm to use with the key.
+             * \param key The session key.
+             */
+            SymmetricCipherSession(const OpenSSLSymmetricCipher& cipher, const SymmetricKey& key);
+
+            /**
+             * \brief Destructor.
+             */
+            ~SymmetricCipherSession();
+
+            SymmetricCipherSession(const SymmetricCipherSession&) = delete;
+            SymmetricCipherSession& operator=(const SymmetricCipherSession&) = delete;
+
+            /**
+             * \brief Get the session key data.
+             * \return The key data.
+             */
+            const std::vector<unsigned char>& getKey() const { return d_key; };
+
+            /**
+             * \brief Get the block size.
+             * \return The block size.
+             */
+            size_t getBlockSize() const { return d_block_size; };
+
+            /**
+             * \brief Cipher a buffer in CBC mode, without padding.
+             * \param src The buffer to cipher, its size must be a multiple of the block size.
+             * \param iv The initialization vector.
+             * \param dest The ciphered buffer.
+             */
+            void cipher(const std::vector<unsigned char>& src, const std::vector<unsigned char>& iv, std::vector<unsigned char>& dest);
+
+            /**
+             * \brief Decipher a buffer in CBC mode, without padding.
+             * \param src The buffer to decipher, its size must be a multiple of the block size.
+             * \param iv The initialization vector.
+             * \param dest The deciphered buffer.
+             */
+            void decipher(const std::vector<unsigned char>& src, const std::vector<unsigned char>& iv, std::vector<unsigned char>& dest);
+
+            /**
+             * \brief Calculate the CMAC of a buffer, chained from an initialization vector.
+             * \param data The data buffer to calculate CMAC.
+             * \param iv The initialization vector.
+             * \param forceK2Use Use the K2 subkey even if the data is block aligned.
+             * \return The last ciphered block.
+             */
+            std::vector<unsigned char> cmac(const std::vector<unsigned char>& data, const std::vector<unsigned char>& iv, bool forceK2Use = false);
+
+            /**
+             * \brief Cipher independent blocks in ECB mode.
+             * \param src The blocks to cipher.
+             * \param length The source length, a multiple of the block size.
+             * \param dest The destination buffer, which must hold length bytes. It may be the source buffer.
+             */
+            void encryptBlocks(const unsigned char* src, size_t length, unsigned char* dest);
+
+            /**
+             * \brief Calculate the CMAC of many independent buffers.
+             *
+             * The buffers are chained in lockstep: the n-th block of every buffer is ciphered by the same ECB call,
+             * which lets the cipher implementation interleave them.
+             * \param data The data buffers.
+             * \param iv The initialization vector of each chain.
+             * \param paddingSize The padding size, a multiple of the block size.
+             * \param forceK2Use Use the K2 subkey even if the data is aligned on the padding size.
+             * \param macs The whole ciphered padded buffers, as returned by CMACCrypto::cmac.
+             */
+            void cmacBatch(const std::vector<std::vector<unsigned char> >& data, const std::vector<unsigned char>& iv, size_t paddingSize, bool forceK2Use, std::vector<std::vector<unsigned char> >& macs);
+
+        protected:
+
+            /**
+             * \brief Run a CBC operation on an initialized context.
+             * \param ctx The context.
+             * \param src The source buffer.
+             * \param length The source length, a multiple of the block size.
+             * \param iv The initialization vector.
+             * \param dest The destination buffer, which must hold length bytes.
+             */
+            void process(EVP_CIPHER_CTX* ctx, const unsigned char* src, size_t length, const std::vector<unsigned char>& iv, unsigned char* dest);
+
+            /**
+             * \brief The session key data.
+             */
+            std::vector<unsigned char> d_key;
+
+            /**
+             * \brief The block size.
+             */
+            size_t d_block_size;
+
+            /**
+             * \brief The encryption context, also used for the CMAC.
+             */
+            EVP_CIPHER_CTX* d_encrypt;
+
+            /**
+             * \brief The decryption context.
+             */
+            EVP_CIPHER_CTX* d_decrypt;
+
+            /**
+             * \brief The CBC cipher of the session.
+             */
+            const EVP_CIPHER* d_evpCipher;
+
+            /**
+             * \brief The ECB encryption context, created on first use.
+             */
+            EVP_CIPHER_CTX* d_ecb;
+
+            /**
+             * \brief The CMAC subkey K1.
+             */
+            std::vector<unsigned char> d_k1;
+
+            /**
+             * \brief The CMAC subkey K2.
+             */
+            std::vector<unsigned char> d_k2;
+
+            /**
+             * \brief Scratch buffer for the CMAC chaining.
+             */
+            std::vector<unsigned char> d_scratch;
+        };
+    }
+}
+
+#endif /* SYMMETRIC_CIPHER_SESSION_HPP */
@@ -0,0 +1,268 @@
+/**
+ * \file crc.cpp
+ * \brief CRC functions used by the reader and card protocols.
+ */
+
+#include "logicalaccess/crypto/crc.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LLA_CRC32_CLMUL
+#define LLA_CRC32_CLMUL_TARGET __attribute__((target("pclmul,sse4.1")))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define LLA_CRC32_CLMUL
+#define LLA_CRC32_CLMUL_TARGET
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace logicalaccess
+{
+    namespace
+    {
+        /**
+         * \brief Slice-by-8 tables: entry [k][n] is the CRC of the byte n followed by k null bytes.
+         */
+        template <typename T>
+        struct CRCTables
+        {
+            T table[8][256];
+        };
+
+        template <typename T>
+        CRCTables<T> makeReflectedTables(T polynomial)
+        {
+            CRCTables<T> tables;
+            for (unsigned int n = 0; n < 256; ++n)
+            {
+                T crc = static_cast<T>(n);
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    crc = static_cast<T>((crc & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1));
+                }
+                tables.table[0][n] = crc;
+            }
+            for (unsigned int n = 0; n < 256; ++n)
+            {
+                for (int k = 1; k < 8; ++k)
+                {
+                    T previous = tables.table[k - 1][n];
+                    tables.table[k][n] = static_cast<T>((previous >> 8) ^ tables.table[0][previous & 0xFF]);
+                }
+            }
+            return tables;
+        }
+
+        CRCTables<uint16_t> makeCCITTTables()
+        {
+            CRCTables<uint16_t> tables;
+            for (unsigned int n = 0; n < 256; ++n)
+            {
+                uint16_t crc = static_cast<uint16_t>(n << 8);
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    crc = static_cast<uint16_t>((crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1));
+                }
+                tables.table[0][n] = crc;
+            }
+            for (unsigned int n = 0; n < 256; ++n)
+            {
+                for (int k = 1; k < 8; ++k)
+                {
+                    uint16_t previous = tables.table[k - 1][n];
+                    tables.table[k][n] = static_cast<uint16_t>((previous << 8) ^ tables.table[0][previous >> 8]);
+                }
+            }
+            return tables;
+        }
+
+        const CRCTables<uint16_t>& reflected16Tables()
+        {
+            static const CRCTables<uint16_t> tables = makeReflectedTables<uint16_t>(0x8408);
+            return tables;
+        }
+
+        const CRCTables<uint16_t>& ccittTables()
+        {
+            static const CRCTables<uint16_t> tables = makeCCITTTables();
+            return tables;
+        }
+
+        const CRCTables<uint32_t>& reflected32Tables()
+        {
+            static const CRCTables<uint32_t> tables = makeReflectedTables<uint32_t>(0xEDB88320);
+            return tables;
+        }
+
+        inline uint32_t load32(const unsigned char* data)
+        {
+            return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8)
+                | (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+        }
+
+        /**
+         * \brief Slice-by-8 update of a reflected CRC up to 32 bits.
+         */
+        template <typename T>
+        T updateReflected(const CRCTables<T>& tables, T crc, const unsigned char* data, size_t length)
+        {
+            const T (&t)[8][256] = tables.table;
+            for (; length >= 8; length -= 8, data += 8)
+            {
+                uint32_t one = load32(data) ^ crc;
+                uint32_t two = load32(data + 4);
+                crc = static_cast<T>(t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^ t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24]
+                    ^ t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^ t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24]);
+            }
+            for (; length > 0; --length, ++data)
+            {
+                crc = static_cast<T>((crc >> 8) ^ t[0][(crc ^ *data) & 0xFF]);
+            }
+            return crc;
+        }
+
+#ifdef LLA_CRC32_CLMUL
+        bool detectCarrylessMultiply()
+        {
+#if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 1);
+            return (info[2] & (1 << 1)) != 0 && (info[2] & (1 << 19)) != 0;
+#else
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+#endif
+        }
+
+        /**
+         * \brief Fold 64 bytes blocks with carry-less multiplications, then Barrett reduce.
+         *
+         * From "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction" (Intel), with
+         * the bit-reflected constants of the 0x104C11DB7 polynomial. The length must be at least 64 and
+         * a multiple of 16.
+         */
+        LLA_CRC32_CLMUL_TARGET uint32_t updateCRC32Clmul(uint32_t crc, const unsigned char* data, size_t length)
+        {
+            const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596LL, 0x0154442bd4LL);
+            const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009eLL, 0x01751997d0LL);
+            const __m128i k5k0 = _mm_set_epi64x(0x0000000000LL, 0x0163cd6124LL);
+            const __m128i poly = _mm_set_epi64x(0x01f7011641LL, 0x01db710641LL);
+            const __m128i mask = _mm_setr_epi32(~0, 0, ~0, 0);
+
+            __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00));
+            __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10));
+            __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20));
+            __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30));
+            __m128i x5;
+            x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+            data += 64;
+            length -= 64;
+
+            // Four parallel folds of 64 bytes.
+            for (; length >= 64; data += 64, length -= 64)
+            {
+                __m128i x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+                __m128i x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+                __m128i x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+                x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+
+                x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+                x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+                x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+                x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+
+                x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00)));
+                x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10)));
+                x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20)));
+                x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30)));
+            }
+
+            // Fold the four lanes into 128 bits.
+            x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+            x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+            x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+            x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+            x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+            x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+            // Single folds of 16 bytes.
+            for (; length >= 16; data += 16, length -= 16)
+            {
+                x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+                x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+                x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data))), x5);
+            }
+
+            // Fold 128 bits to 64 bits.
+            x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+            x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+            x2 = _mm_srli_si128(x1, 4);
+            x1 = _mm_and_si128(x1, mask);
+            x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+            x1 = _mm_xor_si128(x1, x2);
+
+            // Barrett reduction to 32 bits.
+            x2 = _mm_and_si128(x1, mask);
+            x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+            x2 = _mm_and_si128(x2, mask);
+            x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+            x1 = _mm_xor_si128(x1, x2);
+
+            return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+        }
+#endif
+    }
+
+    uint16_t CRC::updateCRC16Reflected(uint16_t crc, const unsigned char* data, size_t length)
+    {
+        return updateReflected<uint16_t>(reflected16Tables(), crc, data, length);
+    }
+
+    uint16_t CRC::updateCRC16CCITT(uint16_t crc, const unsigned char* data, size_t length)
+    {
+        const uint16_t (&t)[8][256] = ccittTables().table;
+        for (; length >= 8; length -= 8, data += 8)
+        {
+            crc = static_cast<uint16_t>(t[7][data[0] ^ (crc >> 8)] ^ t[6][data[1] ^ (crc & 0xFF)] ^ t[5][data[2]] ^ t[4][data[3]]
+                ^ t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]]);
+        }
+        for (; length > 0; --length, ++data)
+        {
+            crc = static_cast<uint16_t>((crc << 8) ^ t[0][((crc >> 8) ^ *data) & 0xFF]);
+        }
+        return crc;
+    }
+
+    uint32_t CRC::updateCRC32Table(uint32_t crc, const unsigned char* data, size_t length)
+    {
+        return updateReflected<uint32_t>(reflected32Tables(), crc, data, length);
+    }
+
+    bool CRC::hasCarrylessMultiply()
+    {
+#ifdef LLA_CRC32_CLMUL
+        static const bool available = detectCarrylessMultiply();
+        return available;
+#else
+        return false;
+#endif
+    }
+
+    uint32_t CRC::updateCRC32(uint32_t crc, const unsigned char* data, size_t length)
+    {
+#ifdef LLA_CRC32_CLMUL
+        // Short buffers, as most card frames, are faster with the tables.
+        if (length >= 64 && hasCarrylessMultiply())
+        {
+            size_t folded = length & ~static_cast<size_t>(15);
+            crc = updateCRC32Clmul(crc, data, folded);
+            data += folded;
+            length -= folded;
+        }
+#endif
+        return updateCRC32Table(crc, data, length);
+    }
+}
@@ -9,6 +9,7 @@
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 #include "logicalaccess/crypto/tomcrypt.h"
+#include "logicalaccess/crypto/crc.hpp"
 
 /**
   @file des.c
@@ -1920,30 +1921,6 @@ int des3_keysize(int *keysize)
 
 #endif
 
-static bool				crc_tabkermit_init = false;
-static unsigned short	crc_tabkermit[256];
-
-static void init_crckermit_tab(void)
-{
-    int i, j;
-
-    for (i = 0; i < 256; i++)
-    {
-        unsigned short crc = 0, c = (unsigned short)i;;
-        for (j = 0; j < 8; j++)
-        {
-            if ((crc ^ c) & 0x0001) crc = (crc >> 1) ^ 0x8408;
-            else                      crc = crc >> 1;
-
-            c = c >> 1;
-        }
-
-        crc_tabkermit[i] = crc;
-    }
-
-    crc_tabkermit_init = true;
-}
-
 unsigned short UpdateCrc(unsigned char ch, unsigned short *lpwCrc)
 {
     ch = (ch ^ (unsigned char)((*lpwCrc) & 0x00FF));
@@ -1958,75 +1935,39 @@ void ComputeCrc(int CRCType, const unsigned char *Data, size_t Length, unsigned
     switch (CRCType)
     {
     case CRC_A:
-        wCrc = 0x6363; // ITU-V.41
+        wCrc = logicalaccess::CRC::crcA(Data, Length); // ITU-V.41
         break;
     case CRC_B:
-        wCrc = 0xFFFF; // ISO 3309
+        wCrc = logicalaccess::CRC::crcB(Data, Length); // ISO 3309
         break;
     default:
         return;
     }
 
-    do
-    {
-        unsigned char chBlock = *Data++;
-        UpdateCrc(chBlock, &wCrc);
-    } while (--Length);
-
-    if (CRCType == CRC_B)
-        wCrc = ~wCrc; // ISO 3309
-
     *TransmitFirst = (unsigned char)(wCrc & 0xFF);
     *TransmitSecond = (unsigned char)((wCrc >> 8) & 0xFF);
-
-    return;
 }
 
 void ComputeCrcCCITT(unsigned short crc_old, const unsigned char *Data, size_t Length, unsigned char *TransmitFirst, unsigned char *TransmitSecond)
 {
-    for (size_t i = 0; i < Length; ++i)
-    {
-        unsigned char datac = Data[i];
-        for (unsigned char cnt_bits = 8; cnt_bits; cnt_bits--)
-        {
-            unsigned char flag_xor = ((crc_old >> 8) & 0x80) ^ (datac & 0x80);
-            datac <<= 1;
-            crc_old <<= 1;
-            if (flag_xor) crc_old ^= 0x1021;
-        }
-    }
+    unsigned short wCrc = logicalaccess::CRC::updateCRC16CCITT(crc_old, Data, Length);
 
-    *TransmitFirst = (unsigned char)(crc_old & 0xFF);
-    *TransmitSecond = (unsigned char)((crc_old >> 8) & 0xFF);
+    *TransmitFirst = (unsigned char)(wCrc & 0xFF);
+    *TransmitSecond = (unsigned char)((wCrc >> 8) & 0xFF);
 }
 
 void ComputeCrcKermit(const unsigned char *Data, size_t Length, unsigned char *TransmitFirst, unsigned char *TransmitSecond)
 {
-    unsigned short wCrc = 0;
-
-    do
-    {
-        unsigned char chBlock = *Data++;
-        wCrc = UpdateCRCKermit(wCrc, chBlock);
-    } while (--Length);
+    unsigned short wCrc = logicalaccess::CRC::crcKermit(Data, Length);
 
     *TransmitFirst = (unsigned char)(wCrc & 0xFF);
     *TransmitSecond = (unsigned char)((wCrc >> 8) & 0xFF);
-
-    return;
 }
 
 unsigned short UpdateCRCKermit(unsigned short crc, char c)
 {
-    unsigned short tmp, short_c;
-    short_c = 0x00ff & (unsigned short)c;
-
-    if (!crc_tabkermit_init) init_crckermit_tab();
-
-    tmp = crc       ^ short_c;
-    crc = (crc >> 8) ^ crc_tabkermit[tmp & 0xff];
-
-    return crc;
+    unsigned char ch = static_cast<unsigned char>(c);
+    return logicalaccess::CRC::updateCRC16Reflected(crc, &ch, 1);
 }
 
 /* $Source$ */
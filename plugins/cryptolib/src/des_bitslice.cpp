@@ -0,0 +1,30 @@
+/**
+ * \file des_bitslice.cpp
+ * \brief Bitsliced DES kernel, 64-bit slices.
+ */
+
+#include "des_bitslice.hpp"
+
+namespace logicalaccess
+{
+    namespace desbitslice
+    {
+        void process64(const KeySchedule& schedule, const unsigned char* in, unsigned char* out)
+        {
+            uint64_t slices[64];
+            for (unsigned int i = 0; i < 64; ++i)
+            {
+                slices[i] = loadBlock(in + i * 8);
+            }
+            transpose64(slices);
+
+            desSlices<uint64_t>(slices, schedule);
+
+            transpose64(slices);
+            for (unsigned int i = 0; i < 64; ++i)
+            {
+                storeBlock(slices[i], out + i * 8);
+            }
+        }
+    }
+}
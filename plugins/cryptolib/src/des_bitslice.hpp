@@ -0,0 +1,847 @@
+/**
+ * \file des_bitslice.hpp
+ * \brief Bitsliced DES kernel, shared by the generic and the AVX2 translation units.
+ *
+ * A slice holds one bit position of many blocks, one block per bit of the slice word, so that the
+ * permutations are free and each S-box is evaluated on all the blocks with boolean operations. The
+ * S-box circuits are Shannon decompositions of the S-box tables, with the variable order giving the
+ * fewest operations.
+ */
+
+#ifndef DES_BITSLICE_HPP
+#define DES_BITSLICE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace logicalaccess
+{
+    namespace desbitslice
+    {
+        /**
+         * \brief The blocks processed by one call of the generic kernel.
+         */
+        const size_t GENERIC_BLOCKS = 64;
+
+        /**
+         * \brief The blocks processed by one call of the AVX2 kernel.
+         */
+        const size_t AVX2_BLOCKS = 256;
+
+        /**
+         * \brief The round key bits of a DES or 3DES operation, in processing order.
+         */
+        struct KeySchedule
+        {
+            /**
+             * \brief The 48 key bits (0 or 1) of each round of each DES stage.
+             */
+            unsigned char bits[3][16][48];
+
+            /**
+             * \brief The DES stages count, 1 for DES and 3 for 3DES.
+             */
+            unsigned int stages;
+        };
+
+        /**
+         * \brief Process GENERIC_BLOCKS blocks with 64-bit slices.
+         */
+        void process64(const KeySchedule& schedule, const unsigned char* in, unsigned char* out);
+
+        /**
+         * \brief Process AVX2_BLOCKS blocks with 256-bit slices. Only call it when hasAVX2Kernel() and the processor supports AVX2.
+         */
+        void process256(const KeySchedule& schedule, const unsigned char* in, unsigned char* out);
+
+        /**
+         * \brief Check if the AVX2 kernel was compiled in.
+         */
+        bool hasAVX2Kernel();
+
+        static const unsigned char IP[64] = {
+            58, 50, 42, 34, 26, 18, 10, 2, 60, 52, 44, 36, 28, 20, 12, 4,
+            62, 54, 46, 38, 30, 22, 14, 6, 64, 56, 48, 40, 32, 24, 16, 8,
+            57, 49, 41, 33, 25, 17, 9, 1, 59, 51, 43, 35, 27, 19, 11, 3,
+            61, 53, 45, 37, 29, 21, 13, 5, 63, 55, 47, 39, 31, 23, 15, 7
+        };
+
+        static inline uint64_t andnot(uint64_t a, uint64_t b)
+        {
+            return a & ~b;
+        }
+
+        /**
+         * \brief Transpose a 64x64 bit matrix, the most significant bit of row 0 being the element (0, 0).
+         */
+        static inline void transpose64(uint64_t* a)
+        {
+            uint64_t m = 0x00000000FFFFFFFFULL;
+            for (unsigned int j = 32; j != 0; j >>= 1, m ^= (m << j))
+            {
+                for (unsigned int k = 0; k < 64; k = (k + j + 1) & ~j)
+                {
+                    uint64_t t = (a[k] ^ (a[k + j] >> j)) & m;
+                    a[k] ^= t;
+                    a[k + j] ^= (t << j);
+                }
+            }
+        }
+
+        static inline uint64_t loadBlock(const unsigned char* in)
+        {
+            uint64_t v = 0;
+            for (unsigned int i = 0; i < 8; ++i)
+            {
+                v = (v << 8) | in[i];
+            }
+            return v;
+        }
+
+        static inline void storeBlock(uint64_t v, unsigned char* out)
+        {
+            for (int i = 7; i >= 0; --i)
+            {
+                out[i] = static_cast<unsigned char>(v);
+                v >>= 8;
+            }
+        }
+
+        /**
+         * \brief S-box 1, xored into its four output slices.
+         */
+        template <typename W>
+        inline void s1(W a1, W a2, W a3, W a4, W a5, W a6, W& out1, W& out2, W& out3, W& out4)
+        {
+            W x0 = ~a5;
+            W x1 = x0 ^ a2;
+            W x2 = x1 ^ a5;
+            W x3 = x1 ^ (x2 & a3);
+            W x4 = x1 ^ (a5 & a3);
+            W x5 = x3 ^ x4;
+            W x6 = x3 ^ (x5 & a4);
+            W x7 = ~x3;
+            W x8 = a2 ^ (x0 & a3);
+            W x9 = x7 ^ x8;
+            W x10 = x7 ^ (x9 & a4);
+            W x11 = x6 ^ x10;
+            W x12 = x6 ^ (x11 & a6);
+            W x13 = ~andnot(a2, x0);
+            W x15 = x13 ^ (x0 & a3);
+            W x16 = x8 ^ x15;
+            W x17 = x8 ^ (x16 & a4);
+            W x18 = ~x1;
+            W x19 = x16 ^ x18;
+            W x20 = x16 ^ (x19 & a3);
+            W x21 = ~x13;
+            W x22 = x1 ^ x21;
+            W x23 = x1 ^ (x22 & a3);
+            W x24 = x20 ^ x23;
+            W x25 = x20 ^ (x24 & a4);
+            W x26 = x17 ^ x25;
+            W x27 = x17 ^ (x26 & a6);
+            W x28 = x12 ^ x27;
+            W x29 = x12 ^ (x28 & a1);
+            W x30 = ~x8;
+            W x31 = x19 ^ (x0 & a3);
+            W x32 = x30 ^ x31;
+            W x33 = x30 ^ (x32 & a4);
+            W x34 = a5 ^ (x2 & a3);
+            W x35 = x13 ^ (x18 & a3);
+            W x36 = x34 ^ (x31 & a4);
+            W x37 = x33 ^ x36;
+            W x38 = x33 ^ (x37 & a6);
+            W x39 = x19 ^ (x32 & a3);
+            W x40 = ~x16;
+            W x41 = x1 ^ (x19 & a3);
+            W x42 = x39 ^ x41;
+            W x43 = x39 ^ (x42 & a4);
+            W x44 = x35 ^ a4;
+            W x45 = x43 ^ x44;
+            W x46 = x43 ^ (x45 & a6);
+            W x47 = x38 ^ x46;
+            W x48 = x38 ^ (x47 & a1);
+            W x50 = x39 ^ (x3 & a4);
+            W x51 = x32 ^ (x19 & a3);
+            W x52 = x51 ^ (x13 & a4);
+            W x53 = x50 ^ x52;
+            W x54 = x50 ^ (x53 & a6);
+            W x55 = x40 ^ (a5 & a3);
+            W x56 = x55 ^ (x19 & a4);
+            W x58 = x41 ^ (x15 & a4);
+            W x59 = x56 ^ x58;
+            W x60 = x56 ^ (x59 & a6);
+            W x61 = x54 ^ x60;
+            W x62 = x54 ^ (x61 & a1);
+            W x63 = x2 ^ (a5 & a3);
+            W x64 = x55 ^ (x13 & a4);
+            W x65 = ~x39;
+            W x67 = x65 ^ (x16 & a4);
+            W x68 = x64 ^ x67;
+            W x69 = x64 ^ (x68 & a6);
+            W x70 = ~x63;
+            W x71 = x7 ^ x70;
+            W x72 = x7 ^ (x71 & a4);
+            W x73 = x19 ^ a3;
+            W x75 = x73 ^ (x1 & a4);
+            W x76 = x72 ^ x75;
+            W x77 = x72 ^ (x76 & a6);
+            W x78 = x69 ^ x77;
+            W x79 = x69 ^ (x78 & a1);
+            out1 ^= x29;
+            out2 ^= x48;
+            out3 ^= x62;
+            out4 ^= x79;
+        }
+
+        /**
+         * \brief S-box 2, xored into its four output slices.
+         */
+        template <typename W>
+        inline void s2(W a1, W a2, W a3, W a4, W a5, W a6, W& out1, W& out2, W& out3, W& out4)
+        {
+            W x0 = ~a4;
+            W x1 = ~andnot(a2, x0);
+            W x2 = x0 & a2;
+            W x3 = x1 ^ x2;
+            W x4 = x1 ^ (x3 & a3);
+            W x5 = ~x1;
+            W x6 = x5 ^ a3;
+            W x7 = x4 ^ x6;
+            W x8 = x4 ^ (x7 & a1);
+            W x9 = x2 ^ a3;
+            W x10 = ~x6;
+            W x11 = x9 ^ (x3 & a1);
+            W x12 = x8 ^ x11;
+            W x13 = x8 ^ (x12 & a6);
+            W x14 = x0 ^ a2;
+            W x15 = a4 ^ (x3 & a3);
+            W x16 = x15 ^ x10;
+            W x17 = x15 ^ (x16 & a1);
+            W x18 = x14 ^ a3;
+            W x19 = x18 ^ (a3 & a1);
+            W x20 = x17 ^ x19;
+            W x21 = x17 ^ (x20 & a6);
+            W x22 = x13 ^ x21;
+            W x23 = x13 ^ (x22 & a5);
+            W x24 = andnot(x0, a2);
+            W x25 = x0 | a2;
+            W x26 = x24 ^ (a2 & a3);
+            W x27 = x26 ^ a1;
+            W x28 = ~x14;
+            W x31 = x27 ^ (x10 & a6);
+            W x32 = ~x26;
+            W x33 = x32 ^ x14;
+            W x34 = x32 ^ (x33 & a1);
+            W x35 = x3 ^ (x14 & a3);
+            W x36 = x35 ^ a1;
+            W x37 = x34 ^ x36;
+            W x38 = x34 ^ (x37 & a6);
+            W x39 = x31 ^ x38;
+            W x40 = x31 ^ (x39 & a5);
+            W x41 = x14 ^ (a4 & a3);
+            W x42 = ~x25;
+            W x43 = x42 ^ x14;
+            W x44 = x42 ^ (x43 & a3);
+            W x45 = x41 ^ x44;
+            W x46 = x41 ^ (x45 & a1);
+            W x47 = ~x24;
+            W x48 = x47 ^ (x1 & a3);
+            W x49 = x26 ^ x48;
+            W x50 = x26 ^ (x49 & a1);
+            W x51 = x46 ^ x50;
+            W x52 = x46 ^ (x51 & a6);
+            W x53 = ~x18;
+            W x54 = x43 ^ (x1 & a3);
+            W x55 = x53 ^ x54;
+            W x56 = x53 ^ (x55 & a1);
+            W x57 = a4 ^ (x14 & a3);
+            W x58 = ~x54;
+            W x59 = x57 ^ x58;
+            W x60 = x57 ^ (x59 & a1);
+            W x61 = x56 ^ x60;
+            W x62 = x56 ^ (x61 & a6);
+            W x63 = x52 ^ x62;
+            W x64 = x52 ^ (x63 & a5);
+            W x65 = x0 ^ a3;
+            W x66 = x65 ^ x28;
+            W x67 = x65 ^ (x66 & a1);
+            W x68 = x14 ^ x16;
+            W x69 = x14 ^ (x68 & a1);
+            W x70 = x67 ^ x69;
+            W x71 = x67 ^ (x70 & a6);
+            W x72 = x16 ^ a1;
+            W x74 = x66 ^ (x24 & a1);
+            W x75 = x72 ^ x74;
+            W x76 = x72 ^ (x75 & a6);
+            W x77 = x71 ^ x76;
+            W x78 = x71 ^ (x77 & a5);
+            out1 ^= x23;
+            out2 ^= x40;
+            out3 ^= x64;
+            out4 ^= x78;
+        }
+
+        /**
+         * \brief S-box 3, xored into its four output slices.
+         */
+        template <typename W>
+        inline void s3(W a1, W a2, W a3, W a4, W a5, W a6, W& out1, W& out2, W& out3, W& out4)
+        {
+            W x0 = ~a5;
+            W x1 = andnot(x0, a3);
+            W x2 = a5 ^ a3;
+            W x3 = x1 ^ x2;
+            W x4 = x1 ^ (x3 & a2);
+            W x5 = ~x2;
+            W x6 = x3 ^ x5;
+            W x7 = x3 ^ (x6 & a2);
+            W x8 = x4 ^ x7;
+            W x9 = x4 ^ (x8 & a4);
+            W x10 = x1 ^ a2;
+            W x11 = a5 ^ (a3 & a2);
+            W x12 = x10 ^ x11;
+            W x13 = x10 ^ (x12 & a4);
+            W x14 = x9 ^ x13;
+            W x15 = x9 ^ (x14 & a6);
+            W x16 = x0 | a3;
+            W x17 = x16 ^ x5;
+            W x18 = x16 ^ (x17 & a2);
+            W x19 = x18 ^ a4;
+            W x20 = x11 ^ a4;
+            W x21 = x19 ^ x20;
+            W x22 = x19 ^ (x21 & a6);
+            W x23 = x15 ^ x22;
+            W x24 = x15 ^ (x23 & a1);
+            W x25 = x17 ^ (x6 & a2);
+            W x27 = x6 ^ (x16 & a2);
+            W x28 = x25 ^ x27;
+            W x29 = x25 ^ (x28 & a4);
+            W x30 = ~x17;
+            W x31 = x30 ^ a2;
+            W x32 = ~x12;
+            W x33 = x31 ^ x32;
+            W x34 = x31 ^ (x33 & a4);
+            W x35 = x29 ^ x34;
+            W x36 = x29 ^ (x35 & a6);
+            W x37 = x31 ^ (a5 & a4);
+            W x38 = ~x31;
+            W x39 = x38 ^ x5;
+            W x40 = x38 ^ (x39 & a4);
+            W x41 = x37 ^ x40;
+            W x42 = x37 ^ (x41 & a6);
+            W x43 = x36 ^ x42;
+            W x44 = x36 ^ (x43 & a1);
+            W x45 = x16 ^ (x5 & a2);
+            W x46 = x45 ^ x2;
+            W x47 = x45 ^ (x46 & a4);
+            W x48 = x2 ^ a2;
+            W x49 = a3 ^ (a5 & a2);
+            W x50 = x48 ^ x49;
+            W x51 = x48 ^ (x50 & a4);
+            W x52 = x47 ^ x51;
+            W x53 = x47 ^ (x52 & a6);
+            W x54 = ~x46;
+            W x55 = x28 ^ x54;
+            W x56 = x28 ^ (x55 & a4);
+            W x57 = ~x3;
+            W x58 = x57 ^ a2;
+            W x59 = x2 ^ x58;
+            W x60 = x2 ^ (x59 & a4);
+            W x61 = x56 ^ x60;
+            W x62 = x56 ^ (x61 & a6);
+            W x63 = x53 ^ x62;
+            W x64 = x53 ^ (x63 & a1);
+            W x65 = x58 ^ (x0 & a4);
+            W x66 = x65 ^ a6;
+            W x67 = x5 ^ (x6 & a2);
+            W x68 = x67 ^ a4;
+            W x69 = x5 ^ (x3 & a2);
+            W x71 = x5 ^ (x30 & a2);
+            W x72 = x69 ^ x71;
+            W x73 = x69 ^ (x72 & a4);
+            W x74 = x68 ^ x73;
+            W x75 = x68 ^ (x74 & a6);
+            W x76 = x66 ^ x75;
+            W x77 = x66 ^ (x76 & a1);
+            out1 ^= x24;
+            out2 ^= x44;
+            out3 ^= x64;
+            out4 ^= x77;
+        }
+
+        /**
+         * \brief S-box 4, xored into its four output slices.
+         */
+        template <typename W>
+        inline void s4(W a1, W a2, W a3, W a4, W a5, W a6, W& out1, W& out2, W& out3, W& out4)
+        {
+            W x0 = ~a2;
+            W x1 = x0 & a5;
+            W x2 = x1 ^ a2;
+            W x3 = x1 ^ (x2 & a3);
+            W x4 = ~a5;
+            W x5 = x0 | a5;
+            W x6 = x4 ^ (x2 & a3);
+            W x7 = x3 ^ x6;
+            W x8 = x3 ^ (x7 & a4);
+            W x9 = x4 ^ x0;
+            W x10 = x4 ^ (x9 & a3);
+            W x11 = ~x9;
+            W x12 = x11 ^ a3;
+            W x13 = x10 ^ x12;
+            W x14 = x10 ^ (x13 & a4);
+            W x15 = x8 ^ x14;
+            W x16 = x8 ^ (x15 & a1);
+            W x17 = ~x13;
+            W x18 = x11 ^ (x4 & a3);
+            W x19 = x17 ^ x18;
+            W x20 = x17 ^ (x19 & a4);
+            W x21 = x9 ^ (x0 & a3);
+            W x22 = ~x7;
+            W x23 = x22 ^ (x0 & a3);
+            W x24 = x21 ^ (x2 & a4);
+            W x25 = x20 ^ x24;
+            W x26 = x20 ^ (x25 & a1);
+            W x27 = x16 ^ x26;
+            W x28 = x16 ^ (x27 & a6);
+            W x29 = ~x16;
+            W x30 = x26 ^ x29;
+            W x31 = x26 ^ (x30 & a6);
+            W x32 = x12 ^ x17;
+            W x33 = x12 ^ (x32 & a4);
+            W x34 = x7 ^ a5;
+            W x35 = x7 ^ (x34 & a3);
+            W x38 = x35 ^ (x5 & a4);
+            W x39 = x33 ^ x38;
+            W x40 = x33 ^ (x39 & a1);
+            W x42 = x23 ^ (x34 & a4);
+            W x43 = x0 ^ (a5 & a3);
+            W x44 = x43 ^ x32;
+            W x45 = x43 ^ (x44 & a4);
+            W x46 = x42 ^ x45;
+            W x47 = x42 ^ (x46 & a1);
+            W x48 = x40 ^ x47;
+            W x49 = x40 ^ (x48 & a6);
+            W x50 = ~x47;
+            W x51 = x50 ^ x40;
+            W x52 = x50 ^ (x51 & a6);
+            out1 ^= x28;
+            out2 ^= x31;
+            out3 ^= x49;
+            out4 ^= x52;
+        }
+
+        /**
+         * \brief S-box 5, xored into its four output slices.
+         */
+        template <typename W>
+        inline void s5(W a1, W a2, W a3, W a4, W a5, W a6, W& out1, W& out2, W& out3, W& out4)
+        {
+            W x0 = ~a1;
+            W x1 = x0 & a5;
+            W x2 = x1 ^ a2;
+            W x3 = a1 | a5;
+            W x4 = x3 ^ a2;
+            W x5 = x2 ^ (a1 & a3);
+            W x6 = a1 & a5;
+            W x7 = ~andnot(a2, x6);
+            W x8 = a1 ^ a5;
+            W x9 = x6 ^ (x3 & a2);
+            W x10 = x7 ^ x9;
+            W x11 = x7 ^ (x10 & a3);
+            W x12 = x5 ^ x11;
+            W x13 = x5 ^ (x12 & a6);
+            W x14 = ~x8;
+            W x15 = x0 | a5;
+            W x16 = x14 ^ (x1 & a2);
+            W x17 = x9 ^ x16;
+            W x18 = x9 ^ (x17 & a3);
+            W x19 = x8 ^ x15;
+            W x20 = x8 ^ (x19 & a2);
+            W x21 = ~x3;
+            W x22 = x14 ^ (x6 & a2);
+            W x23 = x20 ^ x22;
+            W x24 = x20 ^ (x23 & a3);
+            W x25 = x18 ^ x24;
+            W x26 = x18 ^ (x25 & a6);
+            W x27 = x13 ^ x26;
+            W x28 = x13 ^ (x27 & a4);
+            W x29 = ~a5;
+            W x30 = x14 ^ (a1 & a2);
+            W x31 = x8 ^ x30;
+            W x32 = x8 ^ (x31 & a3);
+            W x33 = x15 ^ (x0 & a2);
+            W x34 = x17 ^ x33;
+            W x35 = x17 ^ (x34 & a3);
+            W x36 = x32 ^ x35;
+            W x37 = x32 ^ (x36 & a6);
+            W x38 = ~x4;
+            W x39 = x8 ^ a2;
+            W x40 = x38 ^ x39;
+            W x41 = x38 ^ (x40 & a3);
+            W x42 = x41 ^ a6;
+            W x43 = x37 ^ x42;
+            W x44 = x37 ^ (x43 & a4);
+            W x45 = ~x20;
+            W x46 = x40 ^ (x15 & a2);
+            W x47 = x45 ^ x46;
+            W x48 = x45 ^ (x47 & a3);
+            W x49 = x46 ^ x34;
+            W x50 = x46 ^ (x49 & a3);
+            W x51 = x48 ^ x50;
+            W x52 = x48 ^ (x51 & a6);
+            W x53 = ~x46;
+            W x55 = x53 ^ (x23 & a3);
+            W x56 = x14 ^ (a5 & a2);
+            W x59 = x56 ^ (x49 & a3);
+            W x60 = x55 ^ x59;
+            W x61 = x55 ^ (x60 & a6);
+            W x62 = x52 ^ x61;
+            W x63 = x52 ^ (x62 & a4);
+            W x64 = x3 & a2;
+            W x65 = x64 ^ x14;
+            W x66 = x64 ^ (x65 & a3);
+            W x67 = x8 ^ (x29 & a2);
+            W x68 = x39 ^ x67;
+            W x69 = x39 ^ (x68 & a3);
+            W x70 = x66 ^ x69;
+            W x71 = x66 ^ (x70 & a6);
+            W x72 = x3 ^ (x29 & a2);
+            W x73 = x29 ^ (x40 & a2);
+            W x74 = x72 ^ x73;
+            W x75 = x72 ^ (x74 & a3);
+            W x76 = x6 ^ (x21 & a2);
+            W x77 = x15 ^ (x40 & a2);
+            W x78 = x76 ^ x77;
+            W x79 = x76 ^ (x78 & a3);
+            W x80 = x75 ^ x79;
+            W x81 = x75 ^ (x80 & a6);
+            W x82 = x71 ^ x81;
+            W x83 = x71 ^ (x82 & a4);
+            out1 ^= x28;
+            out2 ^= x44;
+            out3 ^= x63;
+            out4 ^= x83;
+        }
+
+        /**
+         * \brief S-box 6, xored into its four output slices.
+         */
+        template <typename W>
+        inline void s6(W a1, W a2, W a3, W a4, W a5, W a6, W& out1, W& out2, W& out3, W& out4)
+        {
+            W x0 = ~a5;
+            W x1 = x0 ^ a2;
+            W x2 = ~a2;
+            W x3 = x1 ^ (a5 & a6);
+            W x4 = x0 ^ a6;
+            W x5 = x3 ^ x4;
+            W x6 = x3 ^ (x5 & a3);
+            W x7 = x2 ^ a6;
+            W x8 = a5 ^ (x2 & a6);
+            W x9 = x7 ^ x8;
+            W x10 = x7 ^ (x9 & a3);
+            W x11 = x6 ^ x10;
+            W x12 = x6 ^ (x11 & a4);
+            W x13 = andnot(x0, a2);
+            W x14 = a5 ^ x13;
+            W x15 = a5 ^ (x14 & a6);
+            W x16 = x7 ^ x15;
+            W x17 = x7 ^ (x16 & a3);
+            W x18 = andnot(a5, a2);
+            W x19 = x1 ^ (x14 & a6);
+            W x20 = x0 | a6;
+            W x21 = x19 ^ x20;
+            W x22 = x19 ^ (x21 & a3);
+            W x23 = x17 ^ x22;
+            W x24 = x17 ^ (x23 & a4);
+            W x25 = x12 ^ x24;
+            W x26 = x12 ^ (x25 & a1);
+            W x27 = x1 ^ a6;
+            W x29 = x27 ^ (x0 & a3);
+            W x30 = ~x18;
+            W x31 = a5 ^ x30;
+            W x32 = a5 ^ (x31 & a6);
+            W x33 = x32 ^ a3;
+            W x34 = x29 ^ x33;
+            W x35 = x29 ^ (x34 & a4);
+            W x36 = ~x27;
+            W x37 = ~x31;
+            W x38 = ~x1;
+            W x39 = x37 ^ x38;
+            W x40 = x37 ^ (x39 & a6);
+            W x41 = x36 ^ x40;
+            W x42 = x36 ^ (x41 & a3);
+            W x43 = x31 ^ (x30 & a6);
+            W x44 = x43 ^ x1;
+            W x45 = x43 ^ (x44 & a3);
+            W x46 = x42 ^ x45;
+            W x47 = x42 ^ (x46 & a4);
+            W x48 = x35 ^ x47;
+            W x49 = x35 ^ (x48 & a1);
+            W x50 = x31 & a6;
+            W x52 = x50 ^ (x39 & a3);
+            W x55 = x43 ^ (x39 & a3);
+            W x56 = x52 ^ x55;
+            W x57 = x52 ^ (x56 & a4);
+            W x58 = x38 ^ (x37 & a6);
+            W x60 = x58 ^ (x43 & a3);
+            W x61 = x1 ^ (x43 & a3);
+            W x62 = x60 ^ x61;
+            W x63 = x60 ^ (x62 & a4);
+            W x64 = x57 ^ x63;
+            W x65 = x57 ^ (x64 & a1);
+            W x66 = a5 ^ (x2 & a3);
+            W x67 = x38 ^ (x18 & a6);
+            W x68 = a2 ^ (x14 & a6);
+            W x69 = x67 ^ x68;
+            W x70 = x67 ^ (x69 & a3);
+            W x71 = x66 ^ x70;
+            W x72 = x66 ^ (x71 & a4);
+            W x73 = ~x8;
+            W x74 = x73 ^ (x9 & a3);
+            W x75 = x7 ^ (x0 & a3);
+            W x76 = x74 ^ x75;
+            W x77 = x74 ^ (x76 & a4);
+            W x78 = x72 ^ x77;
+            W x79 = x72 ^ (x78 & a1);
+            out1 ^= x26;
+            out2 ^= x49;
+            out3 ^= x65;
+            out4 ^= x79;
+        }
+
+        /**
+         * \brief S-box 7, xored into its four output slices.
+         */
+        template <typename W>
+        inline void s7(W a1, W a2, W a3, W a4, W a5, W a6, W& out1, W& out2, W& out3, W& out4)
+        {
+            W x0 = a4 & a2;
+            W x1 = x0 ^ a5;
+            W x2 = ~a2;
+            W x3 = a4 ^ a2;
+            W x4 = x2 ^ x3;
+            W x5 = x2 ^ (x4 & a5);
+            W x6 = x1 ^ x5;
+            W x7 = x1 ^ (x6 & a3);
+            W x8 = a4 | a2;
+            W x9 = x3 ^ (x0 & a5);
+            W x10 = ~x3;
+            W x11 = andnot(a4, a2);
+            W x12 = x10 ^ x11;
+            W x13 = x10 ^ (x12 & a5);
+            W x14 = x9 ^ x13;
+            W x15 = x9 ^ (x14 & a3);
+            W x16 = x7 ^ x15;
+            W x17 = x7 ^ (x16 & a1);
+            W x18 = ~x1;
+            W x19 = x18 ^ a3;
+            W x20 = x3 ^ x12;
+            W x21 = x3 ^ (x20 & a5);
+            W x22 = x3 ^ (x8 & a5);
+            W x23 = x21 ^ x22;
+            W x24 = x21 ^ (x23 & a3);
+            W x25 = x19 ^ x24;
+            W x26 = x19 ^ (x25 & a1);
+            W x27 = x17 ^ x26;
+            W x28 = x17 ^ (x27 & a6);
+            W x29 = ~x8;
+            W x30 = x29 ^ a5;
+            W x32 = x30 ^ (a2 & a3);
+            W x33 = x32 ^ x7;
+            W x34 = x32 ^ (x33 & a1);
+            W x35 = x20 ^ a4;
+            W x36 = x20 ^ (x35 & a5);
+            W x37 = x29 ^ (x20 & a5);
+            W x38 = x36 ^ x37;
+            W x39 = x36 ^ (x38 & a3);
+            W x40 = x2 ^ a5;
+            W x43 = x40 ^ (x35 & a3);
+            W x44 = x39 ^ x43;
+            W x45 = x39 ^ (x44 & a1);
+            W x46 = x34 ^ x45;
+            W x47 = x34 ^ (x46 & a6);
+            W x48 = x21 ^ a3;
+            W x49 = x8 ^ (a4 & a5);
+            W x50 = x11 ^ (x10 & a5);
+            W x51 = x49 ^ x50;
+            W x52 = x49 ^ (x51 & a3);
+            W x53 = x48 ^ x52;
+            W x54 = x48 ^ (x53 & a1);
+            W x55 = ~x6;
+            W x56 = x3 ^ x55;
+            W x57 = x3 ^ (x56 & a3);
+            W x58 = x29 ^ (x0 & a5);
+            W x59 = x58 ^ a3;
+            W x60 = x57 ^ x59;
+            W x61 = x57 ^ (x60 & a1);
+            W x62 = x54 ^ x61;
+            W x63 = x54 ^ (x62 & a6);
+            W x64 = ~x5;
+            W x65 = x4 ^ a5;
+            W x66 = x64 ^ x65;
+            W x67 = x64 ^ (x66 & a3);
+            W x68 = x67 ^ a1;
+            W x69 = x12 ^ (x20 & a5);
+            W x71 = x69 ^ (x66 & a3);
+            W x72 = ~x13;
+            W x73 = x72 ^ a3;
+            W x74 = x71 ^ x73;
+            W x75 = x71 ^ (x74 & a1);
+            W x76 = x68 ^ x75;
+            W x77 = x68 ^ (x76 & a6);
+            out1 ^= x28;
+            out2 ^= x47;
+            out3 ^= x63;
+            out4 ^= x77;
+        }
+
+        /**
+         * \brief S-box 8, xored into its four output slices.
+         */
+        template <typename W>
+        inline void s8(W a1, W a2, W a3, W a4, W a5, W a6, W& out1, W& out2, W& out3, W& out4)
+        {
+            W x0 = ~a3;
+            W x1 = x0 | a4;
+            W x2 = x1 ^ a5;
+            W x3 = x0 ^ a4;
+            W x4 = x3 ^ (a4 & a5);
+            W x5 = x2 ^ x4;
+            W x6 = x2 ^ (x5 & a2);
+            W x7 = ~a4;
+            W x8 = a3 ^ (x3 & a5);
+            W x9 = ~x3;
+            W x10 = x9 ^ (a3 & a5);
+            W x11 = x8 ^ x10;
+            W x12 = x8 ^ (x11 & a2);
+            W x13 = x6 ^ x12;
+            W x14 = x6 ^ (x13 & a1);
+            W x15 = x9 ^ (x7 & a5);
+            W x16 = x3 ^ a5;
+            W x17 = x15 ^ x16;
+            W x18 = x15 ^ (x17 & a2);
+            W x19 = a4 ^ (x9 & a5);
+            W x20 = x0 ^ (a4 & a5);
+            W x21 = x19 ^ x20;
+            W x22 = x19 ^ (x21 & a2);
+            W x23 = x18 ^ x22;
+            W x24 = x18 ^ (x23 & a1);
+            W x25 = x14 ^ x24;
+            W x26 = x14 ^ (x25 & a6);
+            W x27 = x7 ^ (x0 & a5);
+            W x28 = a3 ^ (x9 & a5);
+            W x29 = x27 ^ x28;
+            W x30 = x27 ^ (x29 & a2);
+            W x31 = a3 ^ a5;
+            W x32 = x2 ^ x31;
+            W x33 = x2 ^ (x32 & a2);
+            W x34 = x30 ^ x33;
+            W x35 = x30 ^ (x34 & a1);
+            W x36 = ~x30;
+            W x37 = x10 ^ a2;
+            W x38 = x36 ^ x37;
+            W x39 = x36 ^ (x38 & a1);
+            W x40 = x35 ^ x39;
+            W x41 = x35 ^ (x40 & a6);
+            W x42 = x8 ^ a2;
+            W x43 = x9 ^ (x0 & a5);
+            W x44 = x3 ^ x43;
+            W x45 = x3 ^ (x44 & a2);
+            W x46 = x42 ^ x45;
+            W x47 = x42 ^ (x46 & a1);
+            W x48 = x0 & a4;
+            W x49 = a3 | a4;
+            W x50 = x48 ^ (a3 & a5);
+            W x51 = x8 ^ x50;
+            W x52 = x8 ^ (x51 & a2);
+            W x53 = x0 ^ (x7 & a5);
+            W x55 = x53 ^ (x49 & a2);
+            W x56 = x52 ^ x55;
+            W x57 = x52 ^ (x56 & a1);
+            W x58 = x47 ^ x57;
+            W x59 = x47 ^ (x58 & a6);
+            W x60 = ~x24;
+            W x61 = x1 ^ (x49 & a5);
+            W x64 = x61 ^ (x53 & a2);
+            W x65 = x1 & a5;
+            W x67 = x65 ^ (x32 & a2);
+            W x68 = x64 ^ x67;
+            W x69 = x64 ^ (x68 & a1);
+            W x70 = x60 ^ x69;
+            W x71 = x60 ^ (x70 & a6);
+            out1 ^= x26;
+            out2 ^= x41;
+            out3 ^= x59;
+            out4 ^= x71;
+        }
+
+        /**
+         * \brief One Feistel round: l ^= f(r, k).
+         * \param masks The null and all ones slices, selected by the round key bits.
+         */
+        template <typename W>
+        inline void desRound(const W* r, W* l, const unsigned char* k, const W* masks)
+        {
+            s1<W>(r[31] ^ masks[k[0]], r[0] ^ masks[k[1]], r[1] ^ masks[k[2]], r[2] ^ masks[k[3]], r[3] ^ masks[k[4]], r[4] ^ masks[k[5]],
+                l[8], l[16], l[22], l[30]);
+            s2<W>(r[3] ^ masks[k[6]], r[4] ^ masks[k[7]], r[5] ^ masks[k[8]], r[6] ^ masks[k[9]], r[7] ^ masks[k[10]], r[8] ^ masks[k[11]],
+                l[12], l[27], l[1], l[17]);
+            s3<W>(r[7] ^ masks[k[12]], r[8] ^ masks[k[13]], r[9] ^ masks[k[14]], r[10] ^ masks[k[15]], r[11] ^ masks[k[16]], r[12] ^ masks[k[17]],
+                l[23], l[15], l[29], l[5]);
+            s4<W>(r[11] ^ masks[k[18]], r[12] ^ masks[k[19]], r[13] ^ masks[k[20]], r[14] ^ masks[k[21]], r[15] ^ masks[k[22]], r[16] ^ masks[k[23]],
+                l[25], l[19], l[9], l[0]);
+            s5<W>(r[15] ^ masks[k[24]], r[16] ^ masks[k[25]], r[17] ^ masks[k[26]], r[18] ^ masks[k[27]], r[19] ^ masks[k[28]], r[20] ^ masks[k[29]],
+                l[7], l[13], l[24], l[2]);
+            s6<W>(r[19] ^ masks[k[30]], r[20] ^ masks[k[31]], r[21] ^ masks[k[32]], r[22] ^ masks[k[33]], r[23] ^ masks[k[34]], r[24] ^ masks[k[35]],
+                l[3], l[28], l[10], l[18]);
+            s7<W>(r[23] ^ masks[k[36]], r[24] ^ masks[k[37]], r[25] ^ masks[k[38]], r[26] ^ masks[k[39]], r[27] ^ masks[k[40]], r[28] ^ masks[k[41]],
+                l[31], l[11], l[21], l[6]);
+            s8<W>(r[27] ^ masks[k[42]], r[28] ^ masks[k[43]], r[29] ^ masks[k[44]], r[30] ^ masks[k[45]], r[31] ^ masks[k[46]], r[0] ^ masks[k[47]],
+                l[4], l[26], l[14], l[20]);
+        }
+
+        /**
+         * \brief Run the DES stages on the slices, indexed by DES bit position (bit 1 first).
+         */
+        template <typename W>
+        inline void desSlices(W* slices, const KeySchedule& schedule)
+        {
+            const W masks[2] = { W(), ~W() };
+
+            W lr[64];
+            for (unsigned int i = 0; i < 64; ++i)
+            {
+                lr[i] = slices[IP[i] - 1];
+            }
+
+            W* l = lr;
+            W* r = lr + 32;
+            for (unsigned int stage = 0; stage < schedule.stages; ++stage)
+            {
+                for (unsigned int round = 0; round < 16; ++round)
+                {
+                    desRound<W>(r, l, schedule.bits[stage][round], masks);
+                    W* t = l;
+                    l = r;
+                    r = t;
+                }
+
+                // The output is R16 L16, which is also the next stage input after FP then IP.
+                W* t = l;
+                l = r;
+                r = t;
+            }
+
+            // Final permutation, the inverse of IP.
+            for (unsigned int i = 0; i < 64; ++i)
+            {
+                slices[IP[i] - 1] = (i < 32) ? l[i] : r[i - 32];
+            }
+        }
+    }
+}
+
+#endif /* DES_BITSLICE_HPP */
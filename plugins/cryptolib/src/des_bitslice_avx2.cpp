@@ -0,0 +1,112 @@
+/**
+ * \file des_bitslice_avx2.cpp
+ * \brief Bitsliced DES kernel, 256-bit slices.
+ *
+ * This file is built with AVX2 code generation. It must not use library code which could be shared
+ * with the other translation units, the functions below are only called after a processor check.
+ */
+
+#include "des_bitslice.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+namespace logicalaccess
+{
+    namespace desbitslice
+    {
+        namespace
+        {
+            /**
+             * \brief A 256-bit slice.
+             */
+            struct W256
+            {
+                W256() : v(_mm256_setzero_si256()) {}
+                explicit W256(__m256i value) : v(value) {}
+
+                W256 operator~() const { return W256(_mm256_xor_si256(v, _mm256_set1_epi64x(-1))); }
+                W256 operator^(const W256& other) const { return W256(_mm256_xor_si256(v, other.v)); }
+                W256 operator&(const W256& other) const { return W256(_mm256_and_si256(v, other.v)); }
+                W256 operator|(const W256& other) const { return W256(_mm256_or_si256(v, other.v)); }
+                W256& operator^=(const W256& other) { v = _mm256_xor_si256(v, other.v); return *this; }
+
+                __m256i v;
+            };
+
+            inline W256 andnot(const W256& a, const W256& b)
+            {
+                return W256(_mm256_andnot_si256(b.v, a.v));
+            }
+        }
+
+        void process256(const KeySchedule& schedule, const unsigned char* in, unsigned char* out)
+        {
+            // Four 64x64 transpositions, one per 64-bit lane.
+            uint64_t lanes[4][64];
+            for (unsigned int lane = 0; lane < 4; ++lane)
+            {
+                for (unsigned int i = 0; i < 64; ++i)
+                {
+                    lanes[lane][i] = loadBlock(in + (lane * 64 + i) * 8);
+                }
+                transpose64(lanes[lane]);
+            }
+
+            W256 slices[64];
+            for (unsigned int i = 0; i < 64; ++i)
+            {
+                slices[i] = W256(_mm256_set_epi64x(static_cast<long long>(lanes[3][i]), static_cast<long long>(lanes[2][i]),
+                    static_cast<long long>(lanes[1][i]), static_cast<long long>(lanes[0][i])));
+            }
+
+            desSlices<W256>(slices, schedule);
+
+            for (unsigned int i = 0; i < 64; ++i)
+            {
+                uint64_t values[4];
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(values), slices[i].v);
+                for (unsigned int lane = 0; lane < 4; ++lane)
+                {
+                    lanes[lane][i] = values[lane];
+                }
+            }
+            for (unsigned int lane = 0; lane < 4; ++lane)
+            {
+                transpose64(lanes[lane]);
+                for (unsigned int i = 0; i < 64; ++i)
+                {
+                    storeBlock(lanes[lane][i], out + (lane * 64 + i) * 8);
+                }
+            }
+        }
+
+        bool hasAVX2Kernel()
+        {
+            return true;
+        }
+    }
+}
+
+#else
+
+namespace logicalaccess
+{
+    namespace desbitslice
+    {
+        void process256(const KeySchedule& schedule, const unsigned char* in, unsigned char* out)
+        {
+            for (size_t i = 0; i < AVX2_BLOCKS; i += GENERIC_BLOCKS)
+            {
+                process64(schedule, in + i * 8, out + i * 8);
+            }
+        }
+
+        bool hasAVX2Kernel()
+        {
+            return false;
+        }
+    }
+}
+
+#endif
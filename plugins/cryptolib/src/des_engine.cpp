@@ -0,0 +1,327 @@
+/**
+ * \file des_engine.cpp
+ * \brief DES/3DES block engine with runtime selected implementations.
+ */
+
+#include "logicalaccess/crypto/des_engine.hpp"
+#include "logicalaccess/crypto/tomcrypt.h"
+#include "logicalaccess/myexception.hpp"
+#include "logicalaccess/logs.hpp"
+#include "des_bitslice.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <openssl/crypto.h>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace logicalaccess
+{
+    /**
+     * \brief The key schedules of a DESEngine.
+     */
+    struct DESEngineSchedules
+    {
+        /**
+         * \brief The libtomcrypt key schedule.
+         */
+        symmetric_key tomcrypt;
+
+        /**
+         * \brief The bitsliced encryption rounds.
+         */
+        desbitslice::KeySchedule encrypt;
+
+        /**
+         * \brief The bitsliced decryption rounds.
+         */
+        desbitslice::KeySchedule decrypt;
+    };
+
+    namespace
+    {
+        const unsigned char PC1[56] = {
+            57, 49, 41, 33, 25, 17, 9, 1, 58, 50, 42, 34, 26, 18,
+            10, 2, 59, 51, 43, 35, 27, 19, 11, 3, 60, 52, 44, 36,
+            63, 55, 47, 39, 31, 23, 15, 7, 62, 54, 46, 38, 30, 22,
+            14, 6, 61, 53, 45, 37, 29, 21, 13, 5, 28, 20, 12, 4
+        };
+
+        const unsigned char PC2[48] = {
+            14, 17, 11, 24, 1, 5, 3, 28, 15, 6, 21, 10,
+            23, 19, 12, 4, 26, 8, 16, 7, 27, 20, 13, 2,
+            41, 52, 31, 37, 47, 55, 30, 40, 51, 45, 33, 48,
+            44, 49, 39, 56, 34, 53, 46, 42, 50, 36, 29, 32
+        };
+
+        const unsigned char SHIFTS[16] = { 1, 1, 2, 2, 2, 2, 2, 2, 1, 2, 2, 2, 2, 2, 2, 1 };
+
+        /**
+         * \brief Number of blocks from which the bitsliced implementation is faster than the single block ones.
+         */
+        const size_t BITSLICE_MIN_BLOCKS = desbitslice::GENERIC_BLOCKS;
+
+        /**
+         * \brief Number of keys kept by the per thread engine cache.
+         */
+        const size_t ENGINE_CACHE_SIZE = 4;
+
+        /**
+         * \brief Compute the 16 round keys of a DES key, one byte per bit.
+         */
+        void desRoundKeys(const unsigned char* key, unsigned char (&rounds)[16][48])
+        {
+            unsigned char cd[56];
+            for (unsigned int i = 0; i < 56; ++i)
+            {
+                unsigned int bit = PC1[i] - 1;
+                cd[i] = (key[bit / 8] >> (7 - bit % 8)) & 0x01;
+            }
+
+            for (unsigned int round = 0; round < 16; ++round)
+            {
+                for (unsigned int shift = 0; shift < SHIFTS[round]; ++shift)
+                {
+                    std::rotate(cd, cd + 1, cd + 28);
+                    std::rotate(cd + 28, cd + 29, cd + 56);
+                }
+                for (unsigned int i = 0; i < 48; ++i)
+                {
+                    rounds[round][i] = cd[PC2[i] - 1];
+                }
+            }
+        }
+
+        /**
+         * \brief Append a DES stage to a bitsliced schedule.
+         */
+        void appendStage(desbitslice::KeySchedule& schedule, const unsigned char (&rounds)[16][48], bool encrypt)
+        {
+            for (unsigned int round = 0; round < 16; ++round)
+            {
+                memcpy(schedule.bits[schedule.stages][round], rounds[encrypt ? round : 15 - round], 48);
+            }
+            ++schedule.stages;
+        }
+
+        bool detectAVX2()
+        {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") != 0;
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7)
+            {
+                return false;
+            }
+            __cpuid(info, 1);
+            // OSXSAVE and AVX, then the OS must save the YMM registers.
+            if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 0x06) != 0x06)
+            {
+                return false;
+            }
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+#else
+            return false;
+#endif
+        }
+
+        bool useAVX2Kernel()
+        {
+            static const bool available = desbitslice::hasAVX2Kernel() && detectAVX2();
+            return available;
+        }
+
+        void xorBlock(unsigned char* block, const unsigned char* value)
+        {
+            for (unsigned int i = 0; i < 8; ++i)
+            {
+                block[i] ^= value[i];
+            }
+        }
+    }
+
+    DESEngine::DESEngine(const unsigned char* key, size_t keyLength)
+        : d_schedules(new DESEngineSchedules())
+    {
+        EXCEPTION_ASSERT_WITH_LOG(key != NULL && (keyLength == 8 || keyLength == 16 || keyLength == 24), std::invalid_argument,
+            "The DES key must be 8, 16 or 24 bytes long.");
+
+        d_key.assign(key, key + keyLength);
+
+        int err = (keyLength == 8) ? des_setup(key, 8, 0, &d_schedules->tomcrypt) : des3_setup(key, static_cast<int>(keyLength), 0, &d_schedules->tomcrypt);
+        EXCEPTION_ASSERT_WITH_LOG(err == CRYPT_OK, std::invalid_argument, "Cannot set the DES key schedule.");
+
+        unsigned char k1[16][48], k2[16][48], k3[16][48];
+        desRoundKeys(key, k1);
+        d_schedules->encrypt.stages = 0;
+        d_schedules->decrypt.stages = 0;
+        if (keyLength == 8)
+        {
+            appendStage(d_schedules->encrypt, k1, true);
+            appendStage(d_schedules->decrypt, k1, false);
+        }
+        else
+        {
+            desRoundKeys(key + 8, k2);
+            if (keyLength == 24)
+            {
+                desRoundKeys(key + 16, k3);
+            }
+            else
+            {
+                memcpy(k3, k1, sizeof(k1));
+            }
+
+            // EDE: E(K3, D(K2, E(K1, block))).
+            appendStage(d_schedules->encrypt, k1, true);
+            appendStage(d_schedules->encrypt, k2, false);
+            appendStage(d_schedules->encrypt, k3, true);
+            appendStage(d_schedules->decrypt, k3, false);
+            appendStage(d_schedules->decrypt, k2, true);
+            appendStage(d_schedules->decrypt, k1, false);
+            OPENSSL_cleanse(k2, sizeof(k2));
+            OPENSSL_cleanse(k3, sizeof(k3));
+        }
+        OPENSSL_cleanse(k1, sizeof(k1));
+    }
+
+    DESEngine::DESEngine(const std::vector<unsigned char>& key)
+        : DESEngine(key.empty() ? NULL : &key[0], key.size())
+    {
+    }
+
+    DESEngine::~DESEngine()
+    {
+        OPENSSL_cleanse(d_schedules.get(), sizeof(DESEngineSchedules));
+        if (!d_key.empty())
+        {
+            OPENSSL_cleanse(&d_key[0], d_key.size());
+        }
+    }
+
+    void DESEngine::encrypt(const unsigned char* src, size_t length, unsigned char* dest)
+    {
+        process(selectBackend(length / 8), true, src, length, dest);
+    }
+
+    void DESEngine::decrypt(const unsigned char* src, size_t length, unsigned char* dest)
+    {
+        process(selectBackend(length / 8), false, src, length, dest);
+    }
+
+    void DESEngine::process(Backend backend, bool encrypt, const unsigned char* src, size_t length, unsigned char* dest)
+    {
+        EXCEPTION_ASSERT_WITH_LOG(length % 8 == 0, std::invalid_argument, "The data must be block aligned.");
+
+        if (backend == DES_BACKEND_BITSLICE)
+        {
+            const desbitslice::KeySchedule& schedule = encrypt ? d_schedules->encrypt : d_schedules->decrypt;
+            if (useAVX2Kernel())
+            {
+                for (; length >= desbitslice::AVX2_BLOCKS * 8; length -= desbitslice::AVX2_BLOCKS * 8)
+                {
+                    desbitslice::process256(schedule, src, dest);
+                    src += desbitslice::AVX2_BLOCKS * 8;
+                    dest += desbitslice::AVX2_BLOCKS * 8;
+                }
+            }
+            for (; length >= desbitslice::GENERIC_BLOCKS * 8; length -= desbitslice::GENERIC_BLOCKS * 8)
+            {
+                desbitslice::process64(schedule, src, dest);
+                src += desbitslice::GENERIC_BLOCKS * 8;
+                dest += desbitslice::GENERIC_BLOCKS * 8;
+            }
+        }
+
+        // The remaining blocks do not fill a slice, they go through the tables.
+        bool single = (d_key.size() == 8);
+        for (size_t i = 0; i < length; i += 8)
+        {
+            if (encrypt)
+            {
+                single ? des_ecb_encrypt(src + i, dest + i, &d_schedules->tomcrypt) : des3_ecb_encrypt(src + i, dest + i, &d_schedules->tomcrypt);
+            }
+            else
+            {
+                single ? des_ecb_decrypt(src + i, dest + i, &d_schedules->tomcrypt) : des3_ecb_decrypt(src + i, dest + i, &d_schedules->tomcrypt);
+            }
+        }
+    }
+
+    void DESEngine::encryptCBC(const unsigned char* src, size_t length, unsigned char* iv, unsigned char* dest)
+    {
+        EXCEPTION_ASSERT_WITH_LOG(length % 8 == 0, std::invalid_argument, "The data must be block aligned.");
+
+        // Each block depends on the previous one, only the single block implementations apply.
+        Backend backend = selectBackend(1);
+        unsigned char block[8];
+        for (size_t i = 0; i < length; i += 8)
+        {
+            memcpy(block, src + i, 8);
+            xorBlock(block, iv);
+            process(backend, true, block, 8, iv);
+            memcpy(dest + i, iv, 8);
+        }
+    }
+
+    void DESEngine::decryptCBC(const unsigned char* src, size_t length, unsigned char* iv, unsigned char* dest)
+    {
+        EXCEPTION_ASSERT_WITH_LOG(length % 8 == 0, std::invalid_argument, "The data must be block aligned.");
+        if (length == 0)
+        {
+            return;
+        }
+
+        // The blocks are deciphered independently, then xored with the previous ciphered blocks.
+        std::vector<unsigned char> ciphered(src, src + length);
+        decrypt(&ciphered[0], length, dest);
+        xorBlock(dest, iv);
+        for (size_t i = 8; i < length; i += 8)
+        {
+            xorBlock(dest + i, &ciphered[i - 8]);
+        }
+        memcpy(iv, &ciphered[length - 8], 8);
+    }
+
+    DESEngine::Backend DESEngine::selectBackend(size_t blocks)
+    {
+        if (blocks >= BITSLICE_MIN_BLOCKS)
+        {
+            return DES_BACKEND_BITSLICE;
+        }
+        return DES_BACKEND_TABLE;
+    }
+
+    size_t DESEngine::getBitsliceBlocks()
+    {
+        return useAVX2Kernel() ? desbitslice::AVX2_BLOCKS : desbitslice::GENERIC_BLOCKS;
+    }
+
+    std::shared_ptr<DESEngine> DESEngine::getEngine(const std::vector<unsigned char>& key)
+    {
+        static thread_local std::vector<std::shared_ptr<DESEngine> > engines;
+
+        for (size_t i = 0; i < engines.size(); ++i)
+        {
+            if (engines[i]->getKey() == key)
+            {
+                std::rotate(engines.begin(), engines.begin() + i, engines.begin() + i + 1);
+                return engines[0];
+            }
+        }
+
+        std::shared_ptr<DESEngine> engine = std::make_shared<DESEngine>(key);
+        if (engines.size() == ENGINE_CACHE_SIZE)
+        {
+            engines.pop_back();
+        }
+        engines.insert(engines.begin(), engine);
+        return engine;
+    }
+}
@@ -1,9 +1,7 @@
 #include "logicalaccess/crypto/des_helper.hpp"
 #include <cassert>
 #include <memory>
-#include <logicalaccess/crypto/des_cipher.hpp>
-#include <logicalaccess/crypto/des_symmetric_key.hpp>
-#include <logicalaccess/crypto/des_initialization_vector.hpp>
+#include <logicalaccess/crypto/des_engine.hpp>
 
 using namespace logicalaccess;
 
@@ -30,24 +28,20 @@ std::vector<uint8_t> DESHelper::DESRun(const std::vector<uint8_t> &data,
     assert(iv_data.size() % 8 == 0);
     assert(data.size() % 8 == 0);
 
-    auto cipher = std::make_shared<openssl::DESCipher>();
-    auto isokey = std::make_shared<openssl::DESSymmetricKey>(
-        openssl::DESSymmetricKey::createFromData(key));
+    // The key schedules are kept between calls with the same key.
+    std::shared_ptr<DESEngine> engine = DESEngine::getEngine(key);
 
-    std::shared_ptr<openssl::DESInitializationVector> iv;
+    std::vector<uint8_t> iv(8, 0x00);
+    if (iv_data.size() != 0)
+        iv.assign(iv_data.begin(), iv_data.begin() + 8);
 
-    if (iv_data.size() == 0)
-        iv = std::make_shared<openssl::DESInitializationVector>(
-            openssl::DESInitializationVector::createNull());
-    else
-        iv = std::make_shared<openssl::DESInitializationVector>(
-            openssl::DESInitializationVector::createFromData(iv_data));
-
-    std::vector<uint8_t> result;
+    std::vector<uint8_t> result(data.size());
+    if (data.empty())
+        return result;
     if (crypt)
-        cipher->cipher(data, result, *isokey.get(), *iv.get(), false);
+        engine->encryptCBC(&data[0], data.size(), &iv[0], &result[0]);
     else
-        cipher->decipher(data, result, *isokey.get(), *iv.get(), false);
+        engine->decryptCBC(&data[0], data.size(), &iv[0], &result[0]);
     return result;
 }
 
@@ -69,34 +69,37 @@ namespace logicalaccess
             int r = 0;
             int outlen = 0;
 
-            unsigned char* buf = new unsigned char[src.size() + context.blockSize()];
+            // Cipher directly at the end of the context data.
+            std::vector<unsigned char>& data = context.data();
+            size_t offset = data.size();
+            data.resize(offset + src.size() + context.blockSize());
 
             switch (context.method())
             {
             case M_ENCRYPT:
             {
-                r = EVP_EncryptUpdate(context.ctx(), buf, &outlen, &src[0], static_cast<int>(src.size()));
+                r = EVP_EncryptUpdate(context.ctx(), &data[offset], &outlen, &src[0], static_cast<int>(src.size()));
                 break;
             }
             case M_DECRYPT:
             {
-                r = EVP_DecryptUpdate(context.ctx(), buf, &outlen, &src[0], static_cast<int>(src.size()));
+                r = EVP_DecryptUpdate(context.ctx(), &data[offset], &outlen, &src[0], static_cast<int>(src.size()));
                 break;
             }
             default:
             {
+                data.resize(offset);
                 THROW_EXCEPTION_WITH_LOG(std::runtime_error, "Unhandled method");
             }
             }
 
             if (r != 1)
             {
-                delete[] buf;
+                data.resize(offset);
                 THROW_EXCEPTION_WITH_LOG(OpenSSLException, "");
             }
 
-            context.data().insert(context.data().end(), buf, buf + outlen);
-            delete[] buf;
+            data.resize(offset + outlen);
         }
 
         std::vector<unsigned char> OpenSSLSymmetricCipher::stop(OpenSSLSymmetricCipherContext& context)
@@ -104,18 +107,21 @@ namespace logicalaccess
             int r = 0;
             int outlen = 0;
 
-            unsigned char* buf = new unsigned char[context.blockSize()];
+            std::vector<unsigned char> data;
+            data.swap(context.data());
+            size_t offset = data.size();
+            data.resize(offset + context.blockSize());
 
             switch (context.method())
             {
             case M_ENCRYPT:
             {
-                r = EVP_EncryptFinal_ex(context.ctx(), buf, &outlen);
+                r = EVP_EncryptFinal_ex(context.ctx(), &data[offset], &outlen);
                 break;
             }
             case M_DECRYPT:
             {
-                r = EVP_DecryptFinal_ex(context.ctx(), buf, &outlen);
+                r = EVP_DecryptFinal_ex(context.ctx(), &data[offset], &outlen);
                 break;
             }
             default:
@@ -126,14 +132,10 @@ namespace logicalaccess
 
             if (r != 1)
             {
-                delete[] buf;
                 THROW_EXCEPTION_WITH_LOG(OpenSSLException, "OpenSSL Error.");
             }
 
-            context.data().insert(context.data().end(), buf, buf + outlen);
-            delete[] buf;
-
-            std::vector<unsigned char> data = context.data();
+            data.resize(offset + outlen);
 
             context.reset();
 
@@ -0,0 +1,239 @@
+/**
+ * \file symmetric_cipher_session.cpp
+ * \brief Symmetric cipher session class.
+ */
+
+#include "logicalaccess/crypto/symmetric_cipher_session.hpp"
+#include "logicalaccess/crypto/openssl.hpp"
+#include "logicalaccess/crypto/openssl_exception.hpp"
+#include "logicalaccess/crypto/cmac.hpp"
+#include "logicalaccess/myexception.hpp"
+#include "logicalaccess/logs.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace logicalaccess
+{
+    namespace openssl
+    {
+        namespace
+        {
+            const EVP_CIPHER* getECBCipher(const EVP_CIPHER* cbc)
+            {
+                switch (EVP_CIPHER_nid(cbc))
+                {
+                case NID_des_cbc:
+                    return EVP_des_ecb();
+                case NID_des_ede_cbc:
+                    return EVP_des_ede_ecb();
+                case NID_des_ede3_cbc:
+                    return EVP_des_ede3_ecb();
+                case NID_aes_128_cbc:
+                    return EVP_aes_128_ecb();
+                case NID_aes_192_cbc:
+                    return EVP_aes_192_ecb();
+                case NID_aes_256_cbc:
+                    return EVP_aes_256_ecb();
+                default:
+                    return NULL;
+                }
+            }
+        }
+
+        SymmetricCipherSession::SymmetricCipherSession(const OpenSSLSymmetricCipher& cipher, const SymmetricKey& key) :
+            d_key(key.data()), d_block_size(0), d_encrypt(NULL), d_decrypt(NULL), d_evpCipher(NULL), d_ecb(NULL)
+        {
+            OpenSSLInitializer::GetInstance();
+
+            EXCEPTION_ASSERT_WITH_LOG(cipher.mode() == OpenSSLSymmetricCipher::ENC_MODE_CBC, std::invalid_argument, "The session cipher must use the CBC mode.");
+            const EVP_CIPHER* evpCipher = cipher.getEVPCipher(key);
+            EXCEPTION_ASSERT_WITH_LOG(evpCipher, std::invalid_argument, "No cipher found that can use the supplied key");
+            d_evpCipher = evpCipher;
+
+            d_encrypt = EVP_CIPHER_CTX_new();
+            d_decrypt = EVP_CIPHER_CTX_new();
+            if (!d_encrypt || !d_decrypt
+                || EVP_EncryptInit_ex(d_encrypt, evpCipher, NULL, &d_key[0], NULL) != 1
+                || EVP_DecryptInit_ex(d_decrypt, evpCipher, NULL, &d_key[0], NULL) != 1)
+            {
+                EVP_CIPHER_CTX_free(d_encrypt);
+                EVP_CIPHER_CTX_free(d_decrypt);
+                THROW_EXCEPTION_WITH_LOG(OpenSSLException, "Cannot initialize the session cipher contexts.");
+            }
+            EVP_CIPHER_CTX_set_padding(d_encrypt, 0);
+            EVP_CIPHER_CTX_set_padding(d_decrypt, 0);
+            d_block_size = EVP_CIPHER_CTX_block_size(d_encrypt);
+
+            // CMAC subkeys, from the ciphered null block.
+            unsigned char Rb = (d_block_size == 8) ? 0x1b : 0x87;
+            std::vector<unsigned char> L(d_block_size, 0x00);
+            process(d_encrypt, &L[0], L.size(), std::vector<unsigned char>(d_block_size, 0x00), &L[0]);
+            d_k1 = CMACCrypto::shift_string(L, (L[0] & 0x80) ? Rb : 0x00);
+            d_k2 = CMACCrypto::shift_string(d_k1, (d_k1[0] & 0x80) ? Rb : 0x00);
+        }
+
+        SymmetricCipherSession::~SymmetricCipherSession()
+        {
+            EVP_CIPHER_CTX_free(d_encrypt);
+            EVP_CIPHER_CTX_free(d_decrypt);
+            EVP_CIPHER_CTX_free(d_ecb);
+        }
+
+        void SymmetricCipherSession::process(EVP_CIPHER_CTX* ctx, const unsigned char* src, size_t length, const std::vector<unsigned char>& iv, unsigned char* dest)
+        {
+            EXCEPTION_ASSERT_WITH_LOG(iv.size() == d_block_size, std::invalid_argument, "Wrong initialization vector size.");
+            EXCEPTION_ASSERT_WITH_LOG(length % d_block_size == 0, std::invalid_argument, "The data must be block aligned.");
+
+            // Only the IV is changed, the key schedule is kept.
+            int outlen = 0;
+            if (EVP_CipherInit_ex(ctx, NULL, NULL, NULL, &iv[0], -1) != 1
+                || (length > 0 && EVP_CipherUpdate(ctx, dest, &outlen, src, static_cast<int>(length)) != 1))
+            {
+                THROW_EXCEPTION_WITH_LOG(OpenSSLException, "Session cipher operation failed.");
+            }
+        }
+
+        void SymmetricCipherSession::cipher(const std::vector<unsigned char>& src, const std::vector<unsigned char>& iv, std::vector<unsigned char>& dest)
+        {
+            dest.resize(src.size());
+            if (!src.empty())
+            {
+                process(d_encrypt, &src[0], src.size(), iv, &dest[0]);
+            }
+        }
+
+        void SymmetricCipherSession::decipher(const std::vector<unsigned char>& src, const std::vector<unsigned char>& iv, std::vector<unsigned char>& dest)
+        {
+            dest.resize(src.size());
+            if (!src.empty())
+            {
+                process(d_decrypt, &src[0], src.size(), iv, &dest[0]);
+            }
+        }
+
+        std::vector<unsigned char> SymmetricCipherSession::cmac(const std::vector<unsigned char>& data, const std::vector<unsigned char>& iv, bool forceK2Use)
+        {
+            size_t pad = (d_block_size - (data.size() % d_block_size)) % d_block_size;
+            if (data.empty())
+            {
+                pad = d_block_size;
+            }
+
+            // Only the last block is padded and xored with the subkey.
+            size_t length = data.size() + pad;
+            d_scratch.resize(length);
+            if (!data.empty())
+            {
+                memcpy(&d_scratch[0], &data[0], data.size());
+            }
+            if (pad > 0)
+            {
+                d_scratch[data.size()] = 0x80;
+                std::fill(d_scratch.begin() + data.size() + 1, d_scratch.end(), 0x00);
+            }
+
+            const std::vector<unsigned char>& subkey = (pad == 0 && !forceK2Use) ? d_k1 : d_k2;
+            for (size_t i = 0; i < d_block_size; ++i)
+            {
+                d_scratch[length - d_block_size + i] ^= subkey[i];
+            }
+
+            process(d_encrypt, &d_scratch[0], length, iv, &d_scratch[0]);
+
+            return std::vector<unsigned char>(d_scratch.end() - d_block_size, d_scratch.end());
+        }
+
+        void SymmetricCipherSession::encryptBlocks(const unsigned char* src, size_t length, unsigned char* dest)
+        {
+            EXCEPTION_ASSERT_WITH_LOG(length % d_block_size == 0, std::invalid_argument, "The data must be block aligned.");
+
+            if (!d_ecb)
+            {
+                const EVP_CIPHER* ecb = getECBCipher(d_evpCipher);
+                EXCEPTION_ASSERT_WITH_LOG(ecb, std::invalid_argument, "No ECB mode for the session cipher.");
+
+                d_ecb = EVP_CIPHER_CTX_new();
+                if (!d_ecb || EVP_EncryptInit_ex(d_ecb, ecb, NULL, &d_key[0], NULL) != 1)
+                {
+                    EVP_CIPHER_CTX_free(d_ecb);
+                    d_ecb = NULL;
+                    THROW_EXCEPTION_WITH_LOG(OpenSSLException, "Cannot initialize the session ECB context.");
+                }
+                EVP_CIPHER_CTX_set_padding(d_ecb, 0);
+            }
+
+            int outlen = 0;
+            if (length > 0 && EVP_EncryptUpdate(d_ecb, dest, &outlen, src, static_cast<int>(length)) != 1)
+            {
+                THROW_EXCEPTION_WITH_LOG(OpenSSLException, "Session ECB operation failed.");
+            }
+        }
+
+        void SymmetricCipherSession::cmacBatch(const std::vector<std::vector<unsigned char> >& data, const std::vector<unsigned char>& iv, size_t paddingSize, bool forceK2Use, std::vector<std::vector<unsigned char> >& macs)
+        {
+            EXCEPTION_ASSERT_WITH_LOG(iv.size() == d_block_size, std::invalid_argument, "Wrong initialization vector size.");
+            EXCEPTION_ASSERT_WITH_LOG(paddingSize > 0 && paddingSize % d_block_size == 0, std::invalid_argument, "The padding size must be a multiple of the block size.");
+
+            // Pad each buffer and xor its last block with the subkey, the ciphering is then done in place.
+            macs.resize(data.size());
+            size_t maxLength = 0;
+            for (size_t i = 0; i < data.size(); ++i)
+            {
+                size_t pad = (paddingSize - (data[i].size() % paddingSize)) % paddingSize;
+                if (data[i].empty())
+                {
+                    pad = paddingSize;
+                }
+
+                std::vector<unsigned char>& padded = macs[i];
+                padded.assign(data[i].begin(), data[i].end());
+                if (pad > 0)
+                {
+                    padded.push_back(0x80);
+                    padded.resize(data[i].size() + pad, 0x00);
+                }
+
+                const std::vector<unsigned char>& subkey = (pad == 0 && !forceK2Use) ? d_k1 : d_k2;
+                for (size_t j = 0; j < d_block_size; ++j)
+                {
+                    padded[padded.size() - d_block_size + j] ^= subkey[j];
+                }
+                maxLength = std::max(maxLength, padded.size());
+            }
+
+            std::vector<unsigned char> chains(data.size() * d_block_size);
+            for (size_t i = 0; i < data.size(); ++i)
+            {
+                std::copy(iv.begin(), iv.end(), chains.begin() + i * d_block_size);
+            }
+
+            std::vector<unsigned char> blocks(data.size() * d_block_size);
+            std::vector<size_t> indexes(data.size());
+            for (size_t offset = 0; offset < maxLength; offset += d_block_size)
+            {
+                size_t count = 0;
+                for (size_t i = 0; i < macs.size(); ++i)
+                {
+                    if (offset < macs[i].size())
+                    {
+                        for (size_t j = 0; j < d_block_size; ++j)
+                        {
+                            blocks[count * d_block_size + j] = macs[i][offset + j] ^ chains[i * d_block_size + j];
+                        }
+                        indexes[count++] = i;
+                    }
+                }
+
+                encryptBlocks(&blocks[0], count * d_block_size, &blocks[0]);
+
+                for (size_t k = 0; k < count; ++k)
+                {
+                    size_t i = indexes[k];
+                    memcpy(&macs[i][offset], &blocks[k * d_block_size], d_block_size);
+                    memcpy(&chains[i * d_block_size], &blocks[k * d_block_size], d_block_size);
+                }
+            }
+        }
+    }
+}
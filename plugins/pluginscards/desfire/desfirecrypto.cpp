@@ -7,8 +7,9 @@
 #include "desfirecommands.hpp"
 #include "desfirecrypto.hpp"
 #include "desfireev1location.hpp"
-#include "logicalaccess/crypto/tomcrypt.h"
-#include <boost/crc.hpp>
+#include "logicalaccess/crypto/crc.hpp"
+#include "logicalaccess/crypto/des_engine.hpp"
+#include <cassert>
 #include <ctime>
 #include <cstdlib>
 
@@ -75,6 +76,48 @@ namespace logicalaccess
         }
     }
 
+    void DESFireCrypto::initSession()
+    {
+        d_session.reset();
+        d_sessionCipher.reset();
+
+        if (d_auth_method != CM_LEGACY && d_cipher && !d_sessionKey.empty())
+        {
+            std::shared_ptr<openssl::SymmetricKey> sessionkey;
+            if (std::dynamic_pointer_cast<openssl::AESCipher>(d_cipher))
+            {
+                sessionkey.reset(new openssl::AESSymmetricKey(openssl::AESSymmetricKey::createFromData(d_sessionKey)));
+            }
+            else
+            {
+                sessionkey.reset(new openssl::DESSymmetricKey(openssl::DESSymmetricKey::createFromData(d_sessionKey)));
+            }
+
+            d_session.reset(new openssl::SymmetricCipherSession(*d_cipher, *sessionkey));
+            d_sessionCipher = d_cipher;
+        }
+    }
+
+    std::shared_ptr<openssl::SymmetricCipherSession> DESFireCrypto::getSession(const std::vector<unsigned char>& key, std::shared_ptr<openssl::OpenSSLSymmetricCipher> cipher)
+    {
+        if (d_auth_method == CM_LEGACY || !cipher || cipher != d_cipher || key != d_sessionKey || d_lastIV.size() != d_block_size)
+        {
+            return std::shared_ptr<openssl::SymmetricCipherSession>();
+        }
+
+        // The session key or cipher may have been changed without a new session.
+        if (!d_session || d_sessionCipher != d_cipher || d_session->getKey() != d_sessionKey)
+        {
+            initSession();
+        }
+        if (d_session && d_session->getBlockSize() != d_block_size)
+        {
+            return std::shared_ptr<openssl::SymmetricCipherSession>();
+        }
+
+        return d_session;
+    }
+
     bool DESFireCrypto::verifyMAC(bool end, const std::vector<unsigned char>& data)
     {
         bool ret = false;
@@ -148,21 +191,13 @@ namespace logicalaccess
 
     short DESFireCrypto::desfire_crc16(const void* data, size_t dataLength)
     {
-        unsigned char first, second;
-
-        ComputeCrc(CRC_A, reinterpret_cast<const unsigned char*>(data), dataLength, &first, &second);
-
-        return ((second << 8) | first);
+        return CRC::crcA(reinterpret_cast<const unsigned char*>(data), dataLength);
     }
 
     uint32_t DESFireCrypto::desfire_crc32(const void* data, size_t dataLength)
     {
-		boost::crc_32_type result;
-		result.process_bytes(data, dataLength);
-		uint32_t crc = result.checksum();
-		crc ^= 0xffffffff;
-		crc = (-1 * (crc ^ 0xffffffff)) - 1;
-		return crc;
+        // IEEE 802.3 CRC32 without the final xor.
+        return CRC::updateCRC32(0xFFFFFFFF, reinterpret_cast<const unsigned char*>(data), dataLength);
     }
 
     /**
@@ -184,8 +219,7 @@ namespace logicalaccess
 
     std::vector<unsigned char> DESFireCrypto::desfire_CBC_send(const std::vector<unsigned char>& key, const std::vector<unsigned char>& iv, const std::vector<unsigned char>& data)
     {
-        symmetric_key skey;
-        unsigned char in[8], out[8], in2[8];
+        unsigned char in[8], out[8];
 
         unsigned int i = 0;
         unsigned int j = 0;
@@ -199,83 +233,49 @@ namespace logicalaccess
         }
 
         // Set encryption keys
+        std::shared_ptr<DESEngine> engine;
         if (is3des)
         {
             EXCEPTION_ASSERT_WITH_LOG(key.size() >= 16, LibLogicalAccessException, "DESFire send cbc encryption need a valid 3des key.");
-            des3_setup(&key[0], 16, 0, &skey);
+            engine = DESEngine::getEngine(std::vector<unsigned char>(key.begin(), key.begin() + 16));
         }
         else
         {
             EXCEPTION_ASSERT_WITH_LOG(key.size() >= 8, LibLogicalAccessException, "DESFire send cbc encryption need a valid key.");
-            des_setup(&key[0], 8, 0, &skey);
+            engine = DESEngine::getEngine(std::vector<unsigned char>(key.begin(), key.begin() + 8));
         }
 
         // clear buffers
-        memset(in, 0x00, 8);
         memset(out, 0x00, 8);
-        memset(in2, 0x00, 8);
+        if (iv.size() >= 8)
+        {
+            memcpy(out, &iv[0], 8);
+        }
 
-        // do for each 8 byte block of input
+        // do for each 8 byte block of input, each block is chained to the previous output
         for (i = 0; i < data.size() / 8; i++)
         {
             // copy 8 bytes from input buffer to in
             memcpy(in, &data[i * 8], 8);
 
-            if (i == 0)
-            {
-                if (iv.size() >= 8)
-                {
-                    for (j = 0; j < 8; j++)
-                    {
-                        in[j] ^= iv[j];
-                    }
-                }
-            }
-            else
+            for (j = 0; j < 8; j++)
             {
-                for (j = 0; j < 8; j++)
-                {
-                    in[j] ^= in2[j];
-                }
+                in[j] ^= out[j];
             }
 
             // encryption
-            if (is3des)
-            {
-                des3_ecb_decrypt(in, out, &skey);
-            }
-            else
-            {
-                des_ecb_decrypt(in, out, &skey);
-            }
-
-            memcpy(in2, out, 8);
+            engine->decrypt(in, 8, out);
 
             // copy decrypted block to output
             ret.insert(ret.end(), out, out + 8);
         }
 
-        if (is3des)
-        {
-            des3_done(&skey);
-        }
-        else
-        {
-            des_done(&skey);
-        }
-
         return ret;
     }
 
     std::vector<unsigned char> DESFireCrypto::desfire_CBC_receive(const std::vector<unsigned char>& key, const std::vector<unsigned char>& iv, const std::vector<unsigned char>& data)
     {
-        symmetric_key skey;
-        unsigned char in[8], out[8], in2[8];
-
-        unsigned int i = 0;
-        unsigned int j = 0;
-
-        std::vector<unsigned char> ret;
+        unsigned char chain[8];
 
         EXCEPTION_ASSERT_WITH_LOG(key.size() >= 8, LibLogicalAccessException, "DESFire encryption need a valid key.");
 
@@ -286,67 +286,28 @@ namespace logicalaccess
         }
 
         // Set encryption keys
+        std::shared_ptr<DESEngine> engine;
         if (is3des)
         {
             EXCEPTION_ASSERT_WITH_LOG(key.size() >= 16, LibLogicalAccessException, "DESFire encryption need a valid 3des key.");
-            des3_setup(&key[0], 16, 0, &skey);
+            engine = DESEngine::getEngine(std::vector<unsigned char>(key.begin(), key.begin() + 16));
         }
         else
         {
-            des_setup(&key[0], 8, 0, &skey);
+            engine = DESEngine::getEngine(std::vector<unsigned char>(key.begin(), key.begin() + 8));
         }
 
-        // clear buffers
-        memset(in, 0x00, 8);
-        memset(out, 0x00, 8);
-        memset(in2, 0x00, 8);
-
-        // do for each 8 byte block of input
-        for (i = 0; i < data.size() / 8; i++)
+        memset(chain, 0x00, 8);
+        if (iv.size() >= 8)
         {
-            // copy 8 bytes from input buffer to in
-            memcpy(in, &data[i * 8], 8);
-
-            if (is3des)
-            {
-                des3_ecb_decrypt(in, out, &skey);
-            }
-            else
-            {
-                des_ecb_decrypt(in, out, &skey);
-            }
-
-            if (i == 0)
-            {
-                if (iv.size() >= 8)
-                {
-                    for (j = 0; j < 8; j++)
-                    {
-                        out[j] ^= iv[j];
-                    }
-                }
-            }
-            else
-            {
-                for (j = 0; j < 8; j++)
-                {
-                    out[j] ^= in2[j];
-                }
-            }
-
-            memcpy(in2, &data[i * 8], 8);
-
-            // copy decrypted block to output
-            ret.insert(ret.end(), out, out + 8);
+            memcpy(chain, &iv[0], 8);
         }
 
-        if (is3des)
-        {
-            des3_done(&skey);
-        }
-        else
+        // The blocks are independent, long buffers are deciphered in bulk.
+        std::vector<unsigned char> ret(data.size() / 8 * 8);
+        if (!ret.empty())
         {
-            des_done(&skey);
+            engine->decryptCBC(&data[0], ret.size(), chain, &ret[0]);
         }
 
         return ret;
@@ -360,12 +321,7 @@ namespace logicalaccess
 
     std::vector<unsigned char> DESFireCrypto::sam_CBC_send(const std::vector<unsigned char>& key, const std::vector<unsigned char>& iv, const std::vector<unsigned char>& data)
     {
-        unsigned char in[8], out[8];
-        symmetric_key skey;
-        unsigned int i = 0;
-        unsigned int j = 0;
-
-        std::vector<unsigned char> ret;
+        unsigned char chain[8];
 
         EXCEPTION_ASSERT_WITH_LOG(key.size() >= 8, LibLogicalAccessException, "DESFire sam cbc encryption need a valid key.");
 
@@ -376,69 +332,44 @@ namespace logicalaccess
         }
 
         // Set encryption keys
+        std::shared_ptr<DESEngine> engine;
         if (is3des)
         {
             EXCEPTION_ASSERT_WITH_LOG(key.size() >= 16, LibLogicalAccessException, "DESFire sam cbc encryption need a valid key.");
-            des3_setup(&key[0], 16, 0, &skey);
+            engine = DESEngine::getEngine(std::vector<unsigned char>(key.begin(), key.begin() + 16));
         }
         else
         {
-            des_setup(&key[0], 8, 0, &skey);
+            engine = DESEngine::getEngine(std::vector<unsigned char>(key.begin(), key.begin() + 8));
         }
 
-        // clear buffers
-        memset(in, 0x00, 8);
-        memset(out, 0x00, 8);
-
-        // do for each 8 byte block of input
-        for (i = 0; i < data.size() / 8; i++)
+        memset(chain, 0x00, 8);
+        if (iv.size() >= 8)
         {
-            // copy 8 bytes from input buffer to in
-            memcpy(in, &data[i * 8], 8);
-
-            if (i == 0)
-            {
-                if (iv.size() >= 8)
-                {
-                    for (j = 0; j < 8; j++)
-                    {
-                        in[j] ^= iv[j];
-                    }
-                }
-            }
-            else
-            {
-                for (j = 0; j < 8; j++)
-                {
-                    in[j] = in[j] ^ out[j];
-                }
-            }
-
-            if (is3des)
-            {
-                des3_ecb_encrypt(in, out, &skey);
-            }
-            else
-            {
-                des_ecb_encrypt(in, out, &skey);
-            }
-
-            // copy encrypted block to output
-            ret.insert(ret.end(), out, out + 8);
+            memcpy(chain, &iv[0], 8);
         }
 
-        if (is3des)
+        std::vector<unsigned char> ret(data.size() / 8 * 8);
+        if (!ret.empty())
         {
-            des3_done(&skey);
-        }
-        else
-        {
-            des_done(&skey);
+            engine->encryptCBC(&data[0], ret.size(), chain, &ret[0]);
         }
 
         return ret;
     }
 
+    void DESFireCrypto::sam_ECB_send(const std::vector<unsigned char>& key, const unsigned char* data, size_t length, unsigned char* out)
+    {
+        EXCEPTION_ASSERT_WITH_LOG(key.size() >= 16, LibLogicalAccessException, "DESFire sam ecb encryption need a valid key.");
+        EXCEPTION_ASSERT_WITH_LOG(length % 8 == 0, LibLogicalAccessException, "DESFire sam ecb encryption need 8-byte blocks.");
+
+        // Same key handling than sam_CBC_send.
+        bool is3des = (memcmp(&key[0], &key[8], 8) != 0);
+        std::shared_ptr<DESEngine> engine = DESEngine::getEngine(std::vector<unsigned char>(key.begin(), key.begin() + (is3des ? 16 : 8)));
+
+        engine->encrypt(data, length, out);
+    }
+
     std::vector<unsigned char> DESFireCrypto::desfire_mac(const std::vector<unsigned char>& key, std::vector<unsigned char> data)
     {
         int pad = (8 - (data.size() % 8)) % 8;
@@ -632,6 +563,8 @@ namespace logicalaccess
         d_cipher.reset();
         d_currentKeyNo = 0;
         d_sessionKey.clear();
+        d_session.reset();
+        d_sessionCipher.reset();
     }
 
     std::vector<unsigned char> DESFireCrypto::changeKey_PICC(uint8_t keyno, std::vector<unsigned char> oldKeyDiversify, std::shared_ptr<DESFireKey> newkey, std::vector<unsigned char> newKeyDiversify, unsigned char keysetno)
@@ -907,7 +840,16 @@ namespace logicalaccess
 
     std::vector<unsigned char> DESFireCrypto::desfire_cmac(const std::vector<unsigned char>& key, std::shared_ptr<openssl::OpenSSLSymmetricCipher> cipherMAC, unsigned int block_size, const std::vector<unsigned char>& data)
     {
-        std::vector<unsigned char> ret = openssl::CMACCrypto::cmac(key, cipherMAC, block_size, data, d_lastIV, block_size);
+        std::vector<unsigned char> ret;
+        std::shared_ptr<openssl::SymmetricCipherSession> session = getSession(key, cipherMAC);
+        if (session)
+        {
+            ret = session->cmac(data, d_lastIV);
+        }
+        else
+        {
+            ret = openssl::CMACCrypto::cmac(key, cipherMAC, block_size, data, d_lastIV, block_size);
+        }
 
         if (cipherMAC == d_cipher)
         {
@@ -935,22 +877,30 @@ namespace logicalaccess
     std::vector<unsigned char> DESFireCrypto::desfire_iso_decrypt(const std::vector<unsigned char>& key, const std::vector<unsigned char>& data, std::shared_ptr<openssl::OpenSSLSymmetricCipher> cipher, unsigned int block_size, size_t datalen)
     {
         std::vector<unsigned char> decdata;
-        std::shared_ptr<openssl::SymmetricKey> isokey;
-        std::shared_ptr<openssl::InitializationVector> iv;
-
-        if (std::dynamic_pointer_cast<openssl::AESCipher>(cipher))
+        std::shared_ptr<openssl::SymmetricCipherSession> session = getSession(key, cipher);
+        if (session)
         {
-            isokey.reset(new openssl::AESSymmetricKey(openssl::AESSymmetricKey::createFromData(key)));
-            iv.reset(new openssl::AESInitializationVector(openssl::AESInitializationVector::createFromData(d_lastIV)));
+            session->decipher(data, d_lastIV, decdata);
         }
         else
         {
-            isokey.reset(new openssl::DESSymmetricKey(openssl::DESSymmetricKey::createFromData(key)));
-            iv.reset(new openssl::DESInitializationVector(openssl::DESInitializationVector::createFromData(d_lastIV)));
-        }
+            std::shared_ptr<openssl::SymmetricKey> isokey;
+            std::shared_ptr<openssl::InitializationVector> iv;
 
-        assert(cipher);
-        cipher->decipher(data, decdata, *isokey, *iv, false);
+            if (std::dynamic_pointer_cast<openssl::AESCipher>(cipher))
+            {
+                isokey.reset(new openssl::AESSymmetricKey(openssl::AESSymmetricKey::createFromData(key)));
+                iv.reset(new openssl::AESInitializationVector(openssl::AESInitializationVector::createFromData(d_lastIV)));
+            }
+            else
+            {
+                isokey.reset(new openssl::DESSymmetricKey(openssl::DESSymmetricKey::createFromData(key)));
+                iv.reset(new openssl::DESInitializationVector(openssl::DESInitializationVector::createFromData(d_lastIV)));
+            }
+
+            assert(cipher);
+            cipher->decipher(data, decdata, *isokey, *iv, false);
+        }
         if (cipher == d_cipher)
         {
             d_lastIV = std::vector<unsigned char>(data.end() - block_size, data.end());
@@ -1039,19 +989,27 @@ namespace logicalaccess
 
         if (decdata.size() > 0)
         {
-            std::shared_ptr<openssl::SymmetricKey> isokey;
-            std::shared_ptr<openssl::InitializationVector> iv;
-            if (std::dynamic_pointer_cast<openssl::AESCipher>(d_cipher))
+            std::shared_ptr<openssl::SymmetricCipherSession> session = getSession(d_sessionKey, d_cipher);
+            if (session)
             {
-                isokey.reset(new openssl::AESSymmetricKey(openssl::AESSymmetricKey::createFromData(d_sessionKey)));
-                iv.reset(new openssl::AESInitializationVector(openssl::AESInitializationVector::createFromData(d_lastIV)));
+                session->cipher(decdata, d_lastIV, encdata);
             }
             else
             {
-                isokey.reset(new openssl::DESSymmetricKey(openssl::DESSymmetricKey::createFromData(d_sessionKey)));
-                iv.reset(new openssl::DESInitializationVector(openssl::DESInitializationVector::createFromData(d_lastIV)));
+                std::shared_ptr<openssl::SymmetricKey> isokey;
+                std::shared_ptr<openssl::InitializationVector> iv;
+                if (std::dynamic_pointer_cast<openssl::AESCipher>(d_cipher))
+                {
+                    isokey.reset(new openssl::AESSymmetricKey(openssl::AESSymmetricKey::createFromData(d_sessionKey)));
+                    iv.reset(new openssl::AESInitializationVector(openssl::AESInitializationVector::createFromData(d_lastIV)));
+                }
+                else
+                {
+                    isokey.reset(new openssl::DESSymmetricKey(openssl::DESSymmetricKey::createFromData(d_sessionKey)));
+                    iv.reset(new openssl::DESInitializationVector(openssl::DESInitializationVector::createFromData(d_lastIV)));
+                }
+                d_cipher->cipher(decdata, encdata, *isokey, *iv, false);
             }
-            d_cipher->cipher(decdata, encdata, *isokey, *iv, false);
             d_lastIV = std::vector<unsigned char>(encdata.end() - d_block_size, encdata.end());
         }
 
@@ -1083,19 +1041,27 @@ namespace logicalaccess
             decdata.push_back(0x00);
         }
 
-        std::shared_ptr<openssl::SymmetricKey> isokey;
-        std::shared_ptr<openssl::InitializationVector> iv;
-        if (std::dynamic_pointer_cast<openssl::AESCipher>(cipher))
+        std::shared_ptr<openssl::SymmetricCipherSession> session = getSession(key, cipher);
+        if (session)
         {
-            isokey.reset(new openssl::AESSymmetricKey(openssl::AESSymmetricKey::createFromData(key)));
-            iv.reset(new openssl::AESInitializationVector(openssl::AESInitializationVector::createFromData(d_lastIV)));
+            session->cipher(decdata, d_lastIV, encdata);
         }
         else
         {
-            isokey.reset(new openssl::DESSymmetricKey(openssl::DESSymmetricKey::createFromData(key)));
-            iv.reset(new openssl::DESInitializationVector(openssl::DESInitializationVector::createFromData(d_lastIV)));
+            std::shared_ptr<openssl::SymmetricKey> isokey;
+            std::shared_ptr<openssl::InitializationVector> iv;
+            if (std::dynamic_pointer_cast<openssl::AESCipher>(cipher))
+            {
+                isokey.reset(new openssl::AESSymmetricKey(openssl::AESSymmetricKey::createFromData(key)));
+                iv.reset(new openssl::AESInitializationVector(openssl::AESInitializationVector::createFromData(d_lastIV)));
+            }
+            else
+            {
+                isokey.reset(new openssl::DESSymmetricKey(openssl::DESSymmetricKey::createFromData(key)));
+                iv.reset(new openssl::DESInitializationVector(openssl::DESInitializationVector::createFromData(d_lastIV)));
+            }
+            cipher->cipher(decdata, encdata, *isokey, *iv, false);
         }
-        cipher->cipher(decdata, encdata, *isokey, *iv, false);
         if (cipher == d_cipher)
         {
             d_lastIV = std::vector<unsigned char>(encdata.end() - block_size, encdata.end());
@@ -10,6 +10,7 @@
 #include "desfireaccessinfo.hpp"
 #include "logicalaccess/crypto/des_cipher.hpp"
 #include "logicalaccess/crypto/aes_cipher.hpp"
+#include "logicalaccess/crypto/symmetric_cipher_session.hpp"
 
 #include <string>
 #include <vector>
@@ -140,6 +141,15 @@ namespace logicalaccess
          */
         static std::vector<unsigned char> sam_CBC_send(const std::vector<unsigned char>& key, const std::vector<unsigned char>& iv, const std::vector<unsigned char>& data);
 
+        /**
+         * \brief Encrypt independent 8-byte blocks with the sam_CBC_send key, the key schedule being computed once.
+         * \param key The DES key to use
+         * \param data The blocks to encrypt
+         * \param length The data length, a multiple of 8
+         * \param out The encrypted blocks, which must hold length bytes
+         */
+        static void sam_ECB_send(const std::vector<unsigned char>& key, const unsigned char* data, size_t length, unsigned char* out);
+
         /**
          * \brief Return data with the DESFire MAC attached.
          * \param key The DES key to use, shall be the session key from the previous authentication
@@ -276,6 +286,14 @@ namespace logicalaccess
          */
         void initBuf();
 
+        /**
+         * \brief Create the secure messaging session from the current session key and cipher.
+         *
+         * Called once authenticated, so that the following MAC and cipher operations reuse the same cipher
+         * contexts and CMAC subkeys.
+         */
+        void initSession();
+
         /**
          * \brief Get key diversified.
          * \param key The DESFire key information
@@ -472,6 +490,24 @@ namespace logicalaccess
          * \brief The card identifier use for key diversification.
          */
         std::vector<unsigned char> d_identifier;
+
+        /**
+         * \brief Get the secure messaging session, if it matches the key and cipher.
+         * \param key The key.
+         * \param cipher The cipher.
+         * \return The session, null if the key and cipher are not the current session ones.
+         */
+        std::shared_ptr<openssl::SymmetricCipherSession> getSession(const std::vector<unsigned char>& key, std::shared_ptr<openssl::OpenSSLSymmetricCipher> cipher);
+
+        /**
+         * \brief The secure messaging session.
+         */
+        std::shared_ptr<openssl::SymmetricCipherSession> d_session;
+
+        /**
+         * \brief The cipher used to create the secure messaging session.
+         */
+        std::shared_ptr<openssl::OpenSSLSymmetricCipher> d_sessionCipher;
     };
 }
 
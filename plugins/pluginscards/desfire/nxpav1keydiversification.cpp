@@ -17,6 +17,7 @@
 #include "logicalaccess/crypto/aes_initialization_vector.hpp"
 #include "logicalaccess/crypto/des_symmetric_key.hpp"
 #include "logicalaccess/crypto/des_initialization_vector.hpp"
+#include "logicalaccess/crypto/symmetric_cipher_session.hpp"
 #include "logicalaccess/myexception.hpp"
 
 namespace logicalaccess
@@ -83,6 +84,70 @@ namespace logicalaccess
         return divKey;
     }
 
+    std::vector<std::vector<unsigned char> > NXPAV1KeyDiversification::diversifyBatch(std::shared_ptr<Key> key, const std::vector<std::vector<unsigned char> >& diversifyInputs)
+    {
+        std::shared_ptr<DESFireKey> desfirekey = std::dynamic_pointer_cast<DESFireKey>(key);
+        EXCEPTION_ASSERT_WITH_LOG(desfirekey, LibLogicalAccessException, "NXP Diversification needs a DESFire key");
+
+        bool aes = (desfirekey->getKeyType() == DESFireKeyType::DF_KEY_AES);
+        size_t block_size = aes ? 16 : 8;
+        std::vector<unsigned char> keycipher(key->getData(), key->getData() + key->getLength());
+        for (size_t i = 0; i < diversifyInputs.size(); ++i)
+        {
+            if (diversifyInputs[i].size() != block_size)
+            {
+                // Not built by initDiversification, only the generic path gives the same result.
+                return KeyDiversification::diversifyBatch(key, diversifyInputs);
+            }
+        }
+        LOG(LogLevel::INFOS) << "Using key diversification NXP AV1 for a batch of " << diversifyInputs.size() << " inputs";
+
+        std::shared_ptr<openssl::SymmetricKey> symkey;
+        std::shared_ptr<openssl::OpenSSLSymmetricCipher> cipher;
+        if (aes)
+        {
+            symkey.reset(new openssl::AESSymmetricKey(openssl::AESSymmetricKey::createFromData(keycipher)));
+            cipher.reset(new openssl::AESCipher());
+        }
+        else
+        {
+            symkey.reset(new openssl::DESSymmetricKey(openssl::DESSymmetricKey::createFromData(keycipher)));
+            cipher.reset(new openssl::DESCipher());
+        }
+
+        // One block inputs: the CBC encryption with a null IV is an ECB encryption.
+        std::vector<std::vector<unsigned char> > keys(diversifyInputs.size());
+        parallelForBatch(diversifyInputs.size(), [&](size_t begin, size_t end)
+        {
+            openssl::SymmetricCipherSession session(*cipher, *symkey);
+            std::vector<unsigned char> blocks((end - begin) * block_size);
+            for (size_t i = begin; i < end; ++i)
+            {
+                for (size_t x = 0; x < block_size; ++x)
+                    blocks[(i - begin) * block_size + x] = diversifyInputs[i][x] ^ keycipher[x];
+            }
+            session.encryptBlocks(&blocks[0], blocks.size(), &blocks[0]);
+
+            for (size_t i = begin; i < end; ++i)
+            {
+                keys[i].assign(blocks.begin() + (i - begin) * block_size, blocks.begin() + (i - begin + 1) * block_size);
+            }
+
+            if (!aes)
+            {
+                for (size_t i = 0; i < blocks.size(); ++i)
+                    blocks[i] ^= keycipher[8 + (i % 8)];
+                session.encryptBlocks(&blocks[0], blocks.size(), &blocks[0]);
+
+                for (size_t i = begin; i < end; ++i)
+                {
+                    keys[i].insert(keys[i].end(), blocks.begin() + (i - begin) * 8, blocks.begin() + (i - begin + 1) * 8);
+                }
+            }
+        });
+        return keys;
+    }
+
     void NXPAV1KeyDiversification::serialize(boost::property_tree::ptree& parentNode)
     {
         boost::property_tree::ptree node;
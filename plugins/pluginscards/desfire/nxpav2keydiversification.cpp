@@ -7,6 +7,8 @@
 #include "logicalaccess/crypto/aes_symmetric_key.hpp"
 #include "logicalaccess/crypto/aes_initialization_vector.hpp"
 #include "logicalaccess/crypto/cmac.hpp"
+#include "logicalaccess/crypto/des_symmetric_key.hpp"
+#include "logicalaccess/crypto/symmetric_cipher_session.hpp"
 #include "desfirecrypto.hpp"
 #include <vector>
 #include <boost/property_tree/ptree.hpp>
@@ -117,6 +119,89 @@ namespace logicalaccess
         return keydiv;
     }
 
+    std::vector<std::vector<unsigned char> > NXPAV2KeyDiversification::diversifyBatch(std::shared_ptr<Key> key, const std::vector<std::vector<unsigned char> >& diversifyInputs)
+    {
+        std::shared_ptr<DESFireKey> desfirekey = std::dynamic_pointer_cast<DESFireKey>(key);
+        EXCEPTION_ASSERT_WITH_LOG(desfirekey, LibLogicalAccessException, "NXP Diversification needs a DESFire key");
+        LOG(LogLevel::INFOS) << "Using key diversification NXP AV2 for a batch of " << diversifyInputs.size() << " inputs";
+
+        std::vector<unsigned char> keycipher(key->getData(), key->getData() + key->getLength());
+        std::shared_ptr<openssl::OpenSSLSymmetricCipher> cipher;
+        std::shared_ptr<openssl::SymmetricKey> symkey;
+        std::vector<unsigned char> constants;
+        size_t block_size = 0, padding_size = 0, keepOffset = 0;
+
+        // Same derivation constants and output slicing than getDiversifiedKey.
+        switch (desfirekey->getKeyType())
+        {
+        case DESFireKeyType::DF_KEY_AES:
+            cipher.reset(new openssl::AESCipher());
+            symkey.reset(new openssl::AESSymmetricKey(openssl::AESSymmetricKey::createFromData(keycipher)));
+            constants.push_back(0x01);
+            block_size = 16;
+            padding_size = 32;
+            break;
+        case DESFireKeyType::DF_KEY_DES:
+            cipher.reset(new openssl::DESCipher());
+            symkey.reset(new openssl::DESSymmetricKey(openssl::DESSymmetricKey::createFromData(keycipher)));
+            constants.push_back(0x21);
+            constants.push_back(0x22);
+            block_size = 8;
+            padding_size = 16;
+            keepOffset = 8;
+            break;
+        case DESFireKeyType::DF_KEY_3K3DES:
+            cipher.reset(new openssl::DESCipher());
+            symkey.reset(new openssl::DESSymmetricKey(openssl::DESSymmetricKey::createFromData(keycipher)));
+            constants.push_back(0x31);
+            constants.push_back(0x32);
+            constants.push_back(0x33);
+            block_size = 8;
+            padding_size = 16;
+            keepOffset = 8;
+            break;
+        default:
+            THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "NXP Diversification don't support this security");
+        }
+
+        std::vector<std::vector<unsigned char> > keys(diversifyInputs.size());
+        std::vector<unsigned char> emptyIV(block_size, 0x00);
+        parallelForBatch(diversifyInputs.size(), [&](size_t begin, size_t end)
+        {
+            openssl::SymmetricCipherSession session(*cipher, *symkey);
+            std::vector<std::vector<unsigned char> > data(end - begin), macs;
+            for (size_t i = begin; i < end; ++i)
+            {
+                data[i - begin].reserve(diversifyInputs[i].size() + 1);
+                data[i - begin].push_back(0x00);
+                data[i - begin].insert(data[i - begin].end(), diversifyInputs[i].begin(), diversifyInputs[i].end());
+            }
+
+            for (size_t c = 0; c < constants.size(); ++c)
+            {
+                for (size_t i = 0; i < data.size(); ++i)
+                {
+                    data[i][0] = constants[c];
+                }
+                session.cmacBatch(data, emptyIV, padding_size, d_forceK2Use, macs);
+
+                for (size_t i = 0; i < macs.size(); ++i)
+                {
+                    std::vector<unsigned char>& keydiv = keys[begin + i];
+                    if (keepOffset == 0)
+                    {
+                        keydiv.assign(macs[i].end() - 16, macs[i].end());
+                    }
+                    else
+                    {
+                        keydiv.insert(keydiv.end(), macs[i].begin() + keepOffset, macs[i].end());
+                    }
+                }
+            }
+        });
+        return keys;
+    }
+
     void NXPAV2KeyDiversification::serialize(boost::property_tree::ptree& parentNode)
     {
         boost::property_tree::ptree node;
@@ -15,6 +15,7 @@ namespace logicalaccess
     public:
         virtual void initDiversification(std::vector<unsigned char> identifier, int AID, std::shared_ptr<Key> key, unsigned char keyno, std::vector<unsigned char>& diversify);
         virtual std::vector<unsigned char> getDiversifiedKey(std::shared_ptr<Key> key, std::vector<unsigned char> diversify);
+        virtual std::vector<std::vector<unsigned char> > diversifyBatch(std::shared_ptr<Key> key, const std::vector<std::vector<unsigned char> >& diversifyInputs);
 
         NXPAV2KeyDiversification() : d_revertAID(false), d_forceK2Use(false) {};
         NXPAV2KeyDiversification(const std::vector<unsigned char>& divInput) : d_revertAID(false), d_divInput(divInput) {};
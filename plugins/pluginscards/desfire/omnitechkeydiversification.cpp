@@ -64,6 +64,49 @@ namespace logicalaccess
         return keydiv;
     }
 
+    std::vector<std::vector<unsigned char> > OmnitechKeyDiversification::diversifyBatch(std::shared_ptr<Key> key, const std::vector<std::vector<unsigned char> >& diversifyInputs)
+    {
+        LOG(LogLevel::INFOS) << "Using key diversification Omnitech for a batch of " << diversifyInputs.size() << " inputs";
+        std::shared_ptr<DESFireKey> desfirekey = std::dynamic_pointer_cast<DESFireKey>(key);
+        EXCEPTION_ASSERT_WITH_LOG(desfirekey, LibLogicalAccessException, "Omnitech Diversification needs a DESFire key");
+
+        std::vector<unsigned char> vkeydata;
+        if (desfirekey->isEmpty())
+        {
+            vkeydata.resize(desfirekey->getLength(), 0x00);
+        }
+        else
+        {
+            vkeydata.insert(vkeydata.end(), desfirekey->getData(), desfirekey->getData() + desfirekey->getLength());
+        }
+        unsigned char keyVersion = desfirekey->getKeyVersion();
+
+        std::vector<std::vector<unsigned char> > keys(diversifyInputs.size());
+        parallelForBatch(diversifyInputs.size(), [&](size_t begin, size_t end)
+        {
+            // Both halves of the diversification input are enciphered as independent blocks.
+            std::vector<unsigned char> blocks((end - begin) * 16);
+            for (size_t i = begin; i < end; ++i)
+            {
+                EXCEPTION_ASSERT_WITH_LOG(diversifyInputs[i].size() >= 16, LibLogicalAccessException, "Omnitech Diversification needs 16 bytes of diversification input.");
+                memcpy(&blocks[(i - begin) * 16], &diversifyInputs[i][0], 16);
+            }
+            DESFireCrypto::sam_ECB_send(vkeydata, &blocks[0], blocks.size(), &blocks[0]);
+
+            for (size_t i = begin; i < end; ++i)
+            {
+                unsigned char* r = &blocks[(i - begin) * 16];
+                for (unsigned char x = 0; x < 8; ++x)
+                {
+                    r[7 - x] = static_cast<unsigned char>((r[7 - x] & 0xFE) | ((keyVersion >> x) & 0x01));
+                    r[8 + x] = static_cast<unsigned char>(r[8 + x] & 0xFE);
+                }
+                keys[i].assign(r, r + 16);
+            }
+        });
+        return keys;
+    }
+
     void OmnitechKeyDiversification::serialize(boost::property_tree::ptree& parentNode)
     {
         boost::property_tree::ptree node;
@@ -58,6 +58,43 @@ namespace logicalaccess
         return keydiv;
     }
 
+    std::vector<std::vector<unsigned char> > SagemKeyDiversification::diversifyBatch(std::shared_ptr<Key> key, const std::vector<std::vector<unsigned char> >& diversifyInputs)
+    {
+        LOG(LogLevel::INFOS) << "Using key diversification Sagem for a batch of " << diversifyInputs.size() << " inputs";
+        std::shared_ptr<DESFireKey> desfirekey = std::dynamic_pointer_cast<DESFireKey>(key);
+        EXCEPTION_ASSERT_WITH_LOG(desfirekey, LibLogicalAccessException, "Sagem Diversification needs a DESFire key");
+
+        std::vector<unsigned char> vkeydata;
+        if (desfirekey->isEmpty())
+        {
+            vkeydata.resize(desfirekey->getLength(), 0x00);
+        }
+        else
+        {
+            vkeydata.insert(vkeydata.end(), desfirekey->getData(), desfirekey->getData() + desfirekey->getLength());
+        }
+
+        std::vector<std::vector<unsigned char> > keys(diversifyInputs.size());
+        parallelForBatch(diversifyInputs.size(), [&](size_t begin, size_t end)
+        {
+            // Both halves of the diversification input are enciphered as independent blocks.
+            std::vector<unsigned char> blocks((end - begin) * 16);
+            for (size_t i = begin; i < end; ++i)
+            {
+                EXCEPTION_ASSERT_WITH_LOG(diversifyInputs[i].size() >= 16, LibLogicalAccessException, "Sagem Diversification needs 16 bytes of diversification input.");
+                memcpy(&blocks[(i - begin) * 16], &diversifyInputs[i][0], 16);
+            }
+            DESFireCrypto::sam_ECB_send(vkeydata, &blocks[0], blocks.size(), &blocks[0]);
+
+            for (size_t i = begin; i < end; ++i)
+            {
+                unsigned char* r = &blocks[(i - begin) * 16];
+                keys[i].assign(r, r + 16);
+            }
+        });
+        return keys;
+    }
+
     void SagemKeyDiversification::serialize(boost::property_tree::ptree& parentNode)
     {
         boost::property_tree::ptree node;
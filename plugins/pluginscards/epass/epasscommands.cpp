@@ -1,5 +1,6 @@
 #include "epasscommands.hpp"
 #include "epassreadercardadapter.hpp"
+#include <algorithm>
 #include <cassert>
 #include <iomanip>
 #include <logicalaccess/bufferhelper.hpp>
@@ -8,7 +9,13 @@
 
 using namespace logicalaccess;
 
+/**
+ * The smallest Read Binary length tried after failures.
+ */
+static const size_t MIN_READ_SIZE = 32;
+
 EPassCommand::EPassCommand()
+    : read_size_(0)
 {
 }
 
@@ -29,6 +36,15 @@ static ByteVector get_challenge(std::shared_ptr<ISO7816ReaderCardAdapter> rca)
 bool EPassCommand::authenticate(const std::string &mrz)
 {
     LLA_LOG_CTX("EPassIdentityService::authenticate");
+    if (crypto_ && crypto_->secureMode() && mrz == mrz_)
+    {
+        LOG(INFOS) << "Reusing the secure messaging session.";
+        return true;
+    }
+    // The cached files were read with another MRZ.
+    if (mrz != mrz_)
+        clearFileCache();
+
     // We perform a classic ISO7816 authenticate. However, there are some caveats.
     //     + Some epassport chip returns an error when we try to authenticate while
     //       we are already authenticated.
@@ -56,7 +72,10 @@ bool EPassCommand::authenticate(const std::string &mrz)
             // drop status bytes.
             EXCEPTION_ASSERT_WITH_LOG(tmp.size() == 40, LibLogicalAccessException,
                                       "Unexpected response length");
-            return crypto_->step2(tmp);
+            if (!crypto_->step2(tmp))
+                return false;
+            mrz_ = mrz;
+            return true;
         }
         catch (const CardException &e)
         {
@@ -69,12 +88,27 @@ bool EPassCommand::authenticate(const std::string &mrz)
     throw std::runtime_error("The impossible happened.");
 }
 
-EPassEFCOM EPassCommand::readEFCOM()
+void EPassCommand::resetSession()
 {
-    ByteVector ef_com_raw;
-    selectEF({0x01, 0x1E});
+    crypto_.reset();
+    cryptoChanged();
+    current_app_.clear();
+}
+
+void EPassCommand::restoreSession()
+{
+    auto mrz = mrz_;
+    auto ef  = current_ef_;
+
+    resetSession();
+    selectIssuerApplication();
+    authenticate(mrz);
+    selectEF(ef);
+}
 
-    auto data = readEF(1, 1);
+EPassEFCOM EPassCommand::readEFCOM()
+{
+    auto data = readFile({0x01, 0x1E}, 1, 1);
     EXCEPTION_ASSERT_WITH_LOG(data.size() >= 10, LibLogicalAccessException,
                               "EF.COM data seems too short");
     EXCEPTION_ASSERT_WITH_LOG(data[0] == 0x60, LibLogicalAccessException,
@@ -106,6 +140,7 @@ bool EPassCommand::selectEF(const ByteVector &file_id)
         std::dynamic_pointer_cast<ISO7816ReaderCardAdapter>(getReaderCardAdapter());
     assert(rca);
     auto ret = rca->sendAPDUCommand(0x00, 0xA4, 0x02, 0x0C, (int)(file_id.size()), file_id);
+    current_ef_ = file_id;
     return true;
 }
 
@@ -131,7 +166,7 @@ void EPassCommand::cryptoChanged()
         epass_rca->setEPassCrypto(crypto_);
 }
 
-ByteVector EPassCommand::readBinary(uint16_t offset, uint8_t length)
+ByteVector EPassCommand::readBinary(uint16_t offset, size_t length)
 {
     uint8_t p1 = 0;
     uint8_t p2 = 0;
@@ -140,26 +175,20 @@ ByteVector EPassCommand::readBinary(uint16_t offset, uint8_t length)
 
     std::shared_ptr<ISO7816ReaderCardAdapter> rca =
         std::dynamic_pointer_cast<ISO7816ReaderCardAdapter>(getReaderCardAdapter());
-    if (length)
-        return rca->sendAPDUCommand(0x00, 0xB0, p1, p2, length);
-    else
-        return rca->sendAPDUCommand(0x00, 0xB0, p1, p2);
+    return rca->sendExtendedAPDUCommand(0x00, 0xB0, p1, p2, {}, length);
 }
 
 EPassDG1 EPassCommand::readDG1()
 {
-    selectEF({0x01, 0x01});
-    auto raw = readEF(1, 1);
+    auto raw = readFile({0x01, 0x01}, 1, 1);
     return EPassUtils::parse_dg1(raw);
 }
 
 EPassDG2 EPassCommand::readDG2()
 {
     LLA_LOG_CTX("EPassCommand::readDG2");
-    selectEF({0x01, 0x02});
-
     // File tag is 2 bytes and size is 2 bytes too.
-    auto dg2_raw = readEF(2, 2);
+    auto dg2_raw = readFile({0x01, 0x02}, 2, 2);
 
     auto dg2 = EPassUtils::parse_dg2(dg2_raw);
     return dg2;
@@ -167,35 +196,89 @@ EPassDG2 EPassCommand::readDG2()
 
 ByteVector EPassCommand::readEF(uint8_t size_bytes, uint8_t size_offset)
 {
-    ByteVector ef_raw;
     uint8_t initial_read_len = static_cast<uint8_t>(size_bytes + size_offset);
 
-    auto data = readBinary(0, initial_read_len);
-    EXCEPTION_ASSERT_WITH_LOG(data.size() == initial_read_len,
+    auto ef_raw = readBinary(0, initial_read_len);
+    EXCEPTION_ASSERT_WITH_LOG(ef_raw.size() == initial_read_len,
                               LibLogicalAccessException, "Wrong data size.");
-    ef_raw.insert(ef_raw.end(), data.begin(), data.end());
 
     // compute the length of the file, based on the number of bytes representing the
     // size
     // and the initial offset of those bytes.
-    uint16_t length = 0;
+    size_t length = 0;
     for (int i = 0; i < size_bytes; ++i)
-        length |= data[size_offset + i] << (size_bytes - i - 1) * 8;
+        length |= ef_raw[size_offset + i] << (size_bytes - i - 1) * 8;
+
+    size_t end = initial_read_len + length;
+    EXCEPTION_ASSERT_WITH_LOG(end <= 0x8000, LibLogicalAccessException,
+                              "Files larger than 32KB are not supported.");
+    while (ef_raw.size() < end)
+    {
+        try
+        {
+            readChunks(ef_raw, end);
+        }
+        catch (const LibLogicalAccessException &e)
+        {
+            // Some chips or readers fail on large responses. A failure also ends
+            // the secure messaging session, so a new one is opened before reading
+            // the rest in smaller chunks.
+            size_t read_size = getReadSize();
+            if (mrz_.empty() || read_size <= MIN_READ_SIZE)
+                throw;
+
+            read_size_ = std::max(read_size / 2, MIN_READ_SIZE);
+            LOG(WARNINGS) << "Reading " << read_size << " bytes failed (" << e.what()
+                          << "). Retrying with " << read_size_ << " bytes.";
+            restoreSession();
+        }
+    }
+    return ef_raw;
+}
 
-    uint16_t offset = initial_read_len;
-    while (length)
+void EPassCommand::readChunks(ByteVector &ef_raw, size_t end)
+{
+    size_t read_size = getReadSize();
+    while (ef_raw.size() < end)
     {
-        // somehow reading more will cause invalid checksum.
-        // todo: investigate.
-        uint8_t to_read = static_cast<uint8_t>(length > 100 ? 100 : length);
-        data            = readBinary(offset, to_read);
+        size_t to_read = std::min(end - ef_raw.size(), read_size);
+        auto data      = readBinary(static_cast<uint16_t>(ef_raw.size()), to_read);
         EXCEPTION_ASSERT_WITH_LOG(data.size() == to_read, LibLogicalAccessException,
                                   "Wrong data size");
         ef_raw.insert(ef_raw.end(), data.begin(), data.end());
-        offset += (uint8_t)(data.size());
-        length -= (uint8_t)(data.size());
     }
-    return ef_raw;
+}
+
+size_t EPassCommand::getReadSize()
+{
+    // The largest chunks whose protected response fits in a response APDU.
+    std::shared_ptr<ISO7816ReaderCardAdapter> rca =
+        std::dynamic_pointer_cast<ISO7816ReaderCardAdapter>(getReaderCardAdapter());
+    size_t max_read = rca ? rca->getMaxResponseDataLength() : 256;
+    if (crypto_ && crypto_->secureMode())
+        max_read = EPassUtils::max_plain_response_length(max_read);
+
+    return read_size_ ? std::min(read_size_, max_read) : max_read;
+}
+
+ByteVector EPassCommand::readFile(const ByteVector &file_id, uint8_t size_bytes,
+                                  uint8_t size_offset)
+{
+    auto it = files_.find(file_id);
+    if (it != files_.end())
+        return it->second;
+
+    selectEF(file_id);
+    auto content = readEF(size_bytes, size_offset);
+    // Only what the MRZ gave access to is kept.
+    if (crypto_ && crypto_->secureMode())
+        files_[file_id] = content;
+    return content;
+}
+
+void EPassCommand::clearFileCache()
+{
+    files_.clear();
 }
 
 void EPassCommand::readSOD()
@@ -205,19 +288,16 @@ void EPassCommand::readSOD()
     auto hash_1 = compute_hash({1, 1});
     auto hash_2 = compute_hash({1, 2});
 
-    selectEF({0x01, 0x1D});
-    auto tmp = readEF(2, 2);
+    auto tmp = readFile({0x01, 0x1D}, 2, 2);
 }
 
 ByteVector EPassCommand::compute_hash(const ByteVector &file_id)
 {
-    selectEF(file_id);
-
     ByteVector content;
     if (file_id == ByteVector{1, 1})
-        content = readEF(1, 1);
+        content = readFile(file_id, 1, 1);
     else if (file_id == ByteVector{1, 2})
-        content = readEF(2, 2);
+        content = readFile(file_id, 2, 2);
 
     // Hash algorithm can vary.
     return openssl::SHA1Hash(content);
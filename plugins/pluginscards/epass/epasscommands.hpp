@@ -3,6 +3,7 @@
 #include "epasscrypto.hpp"
 #include "utils.hpp"
 #include <logicalaccess/cards/commands.hpp>
+#include <map>
 
 namespace logicalaccess
 {
@@ -19,12 +20,25 @@ class LIBLOGICALACCESS_API EPassCommand : public Commands
     bool selectEF(const ByteVector &file_id);
 
     bool selectIssuerApplication();
+
+    /**
+     * Perform Basic Access Control.
+     *
+     * The secure messaging session is kept for the lifetime of the chip: if
+     * it is already open with the same MRZ, nothing is sent to the chip.
+     */
     bool authenticate(const std::string &mrz);
 
+    /**
+     * Close the secure messaging session. The next command is sent in
+     * plain and the next authenticate() performs a full BAC.
+     */
+    void resetSession();
+
     /**
      * Read Binary of the currently selected file.
      */
-    ByteVector readBinary(uint16_t offset, uint8_t length);
+    ByteVector readBinary(uint16_t offset, size_t length);
 
     /**
      * Retrieve the content of the EF.COM file.
@@ -44,6 +58,26 @@ class LIBLOGICALACCESS_API EPassCommand : public Commands
      */
     ByteVector readEF(uint8_t size_bytes, uint8_t size_offset);
 
+    /**
+     * Select and fully read a file, or return its content from the cache.
+     *
+     * The content of the files read in secure messaging is kept until the
+     * chip is authenticated with another MRZ.
+     */
+    ByteVector readFile(const ByteVector &file_id, uint8_t size_bytes,
+                        uint8_t size_offset);
+
+    /**
+     * Drop the cached file contents.
+     */
+    void clearFileCache();
+
+    /**
+     * The number of bytes read per Read Binary command. It starts at the largest
+     * size the card and reader allow, and decreases when a read fails.
+     */
+    size_t getReadSize();
+
     /**
      * Extract information from Data Group 1.
      *
@@ -69,6 +103,38 @@ class LIBLOGICALACCESS_API EPassCommand : public Commands
   private:
     ByteVector compute_hash(const ByteVector &file_id);
 
+    /**
+     * Read the current file from `ef_raw.size()` to `end`, in chunks of
+     * getReadSize() bytes.
+     */
+    void readChunks(ByteVector &ef_raw, size_t end);
+
+    /**
+     * Open a new secure messaging session after a failure, and select
+     * the current file again.
+     */
+    void restoreSession();
+
+    /**
+     * The MRZ of the open secure messaging session.
+     */
+    std::string mrz_;
+
+    /**
+     * The identifier of the currently selected file.
+     */
+    ByteVector current_ef_;
+
+    /**
+     * The content of the files already read, by file identifier.
+     */
+    std::map<ByteVector, ByteVector> files_;
+
+    /**
+     * The largest Read Binary length that succeeded, 0 if not known yet.
+     */
+    size_t read_size_;
+
     /**
      * The identifier of the currently selected application.
      *
@@ -1,4 +1,5 @@
 #include "utils.hpp"
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <ctime>
@@ -112,27 +113,60 @@ std::vector<uint8_t> EPassUtils::adjust_key_parity(const std::vector<uint8_t> &k
 }
 
 /**
- * Check whether the APDU contains an LE byte.
+ * Split an APDU into its command data and its Le field, the APDU being in short
+ * or extended form.
  */
-static bool apdu_has_le(const ByteVector &apdu)
+static void split_apdu(const ByteVector &apdu, ByteVector &data, ByteVector &le)
 {
     assert(apdu.size() >= 4);
-    if (apdu.size() == 4)
-        return false;
-    auto body_size = std::distance(apdu.begin() + 4, apdu.end());
-    return body_size != apdu[4] + 1;
+    ByteVector body(apdu.begin() + 4, apdu.end());
+    if (body.empty())
+        return;
+
+    if (body.size() == 1)
+    {
+        le = body;
+        return;
+    }
+
+    size_t lc_size = 1;
+    size_t le_size = 1;
+    size_t lc      = body[0];
+    if (body[0] == 0 && body.size() >= 3)
+    {
+        // Extended form. Without data, the Le field takes the place of Lc.
+        if (body.size() == 3)
+        {
+            le = ByteVector(body.begin() + 1, body.end());
+            return;
+        }
+        lc_size = 3;
+        le_size = 2;
+        lc      = static_cast<size_t>((body[1] << 8) | body[2]);
+    }
+
+    EXCEPTION_ASSERT_WITH_LOG(body.size() == lc_size + lc ||
+                                  body.size() == lc_size + lc + le_size,
+                              LibLogicalAccessException, "Invalid APDU length.");
+    data = ByteVector(body.begin() + lc_size, body.begin() + lc_size + lc);
+    le   = ByteVector(body.begin() + lc_size + lc, body.end());
 }
 
 /**
- * Check whether the APDU has any data.
+ * Append a BER-TLV length.
  */
-static bool apdu_has_data(const ByteVector &apdu)
+static void append_ber_length(ByteVector &out, size_t len)
 {
-    assert(apdu.size() >= 4);
-    if (apdu.size() == 4)
-        return false;
-    auto body_size = std::distance(apdu.begin() + 4, apdu.end());
-    return body_size >= apdu[4] + 1; // Maybe we also have an LE byte.
+    if (len >= 0x100)
+    {
+        out.push_back(0x82);
+        out.push_back(static_cast<uint8_t>(len >> 8));
+    }
+    else if (len >= 0x80)
+    {
+        out.push_back(0x81);
+    }
+    out.push_back(static_cast<uint8_t>(len));
 }
 
 ByteVector EPassUtils::encrypt_apdu(const ByteVector &apdu, const ByteVector &ks_enc,
@@ -147,27 +181,25 @@ ByteVector EPassUtils::encrypt_apdu(const ByteVector &apdu, const ByteVector &ks
                             apdu.begin() + 4);
     ByteVector cmd_header = pad(cmd_header_nopad);
 
-    ByteVector do_97;
     ByteVector original_data;
-    if (apdu_has_le(apdu))
-    {
-        if (apdu_has_data(apdu))
-        {
-            original_data = ByteVector(apdu.begin() + 4, apdu.end() - 1);
-        }
-        do_97 = {0x97, 0x01, *(apdu.end() - 1)};
-    }
-    else if (apdu_has_data(apdu))
+    ByteVector le;
+    split_apdu(apdu, original_data, le);
+
+    ByteVector do_97;
+    if (le.size())
     {
-        original_data = ByteVector(apdu.begin() + 5, apdu.end());
+        do_97 = {0x97, static_cast<uint8_t>(le.size())};
+        do_97.insert(do_97.end(), le.begin(), le.end());
     }
-    ByteVector encrypted_data =
-        DESHelper::DESEncrypt(pad(original_data), ks_enc, {});
 
     ByteVector do_87;
-    if (apdu_has_data(apdu)) // LC -- do we have any data?
+    if (original_data.size()) // LC -- do we have any data?
     {
-        do_87 = {0x87, static_cast<uint8_t>(encrypted_data.size() + 1), 0x01};
+        ByteVector encrypted_data =
+            DESHelper::DESEncrypt(pad(original_data), ks_enc, {});
+        do_87 = {0x87};
+        append_ber_length(do_87, encrypted_data.size() + 1);
+        do_87.push_back(0x01);
         do_87.insert(do_87.end(), encrypted_data.begin(), encrypted_data.end());
     }
 
@@ -181,14 +213,24 @@ ByteVector EPassUtils::encrypt_apdu(const ByteVector &apdu, const ByteVector &ks
     ByteVector do_8E = {0x8E, 0x08};
     do_8E.insert(do_8E.end(), CC.begin(), CC.end());
 
+    // The protected APDU is extended if its data or the expected response are.
+    size_t lc     = do_87.size() + do_97.size() + do_8E.size();
+    bool extended = lc > 0xFF || le.size() > 1;
+
     ByteVector result;
     result.insert(result.end(), cmd_header_nopad.begin(), cmd_header_nopad.end());
-    result.push_back(
-        static_cast<uint8_t>(do_87.size() + do_97.size() + do_8E.size())); // LC
+    if (extended)
+    {
+        result.push_back(0);
+        result.push_back(static_cast<uint8_t>(lc >> 8));
+    }
+    result.push_back(static_cast<uint8_t>(lc)); // LC
     result.insert(result.end(), do_87.begin(), do_87.end());
     result.insert(result.end(), do_97.begin(), do_97.end());
     result.insert(result.end(), do_8E.begin(), do_8E.end());
     result.push_back(0);
+    if (extended)
+        result.push_back(0);
 
     return result;
 }
@@ -266,65 +308,92 @@ ByteVector EPassUtils::compute_mac(const ByteVector &in, const ByteVector &k_mac
     return y;
 }
 
-static bool rapdu_has_data(const ByteVector &rapdu)
-{
-    EXCEPTION_ASSERT_WITH_LOG(rapdu.size() >= 3, LibLogicalAccessException,
-                              "RAPDU is too short.");
-    return rapdu[0] == 0x87;
-}
-
 ByteVector EPassUtils::decrypt_rapdu(const ByteVector &rapdu,
                                      const ByteVector &ks_enc,
                                      const ByteVector &ks_mac, const ByteVector &ssc)
 {
-    ByteVector do_87;
-    ByteVector do_99;
-    ByteVector do_8E;
-
-    auto cpy = ByteVector(rapdu.begin(), rapdu.end() - 2);
-    auto itr = cpy.begin();
-    if (rapdu_has_data(cpy))
+    // The data objects are used in place, without the status word: DO87 is
+    // [0, do_99), DO99 is [do_99, do_99 + 4) and DO8E follows.
+    EXCEPTION_ASSERT_WITH_LOG(rapdu.size() >= 2, LibLogicalAccessException,
+                              "RAPDU is too short");
+    size_t size         = rapdu.size() - 2;
+    size_t do_87_header = 0;
+    size_t do_99        = 0;
+    if (size >= 3 && rapdu[0] == 0x87)
     {
-        do_87.insert(do_87.end(), itr, itr + 3);
-        itr += 3;
-        do_87.insert(do_87.end(), itr, itr + cpy[1] - 1);
-        itr += cpy[1] - 1;
+        // The length is BER encoded: 1 byte, or 0x81/0x82 followed by 1 or 2 bytes.
+        size_t len   = rapdu[1];
+        do_87_header = 2;
+        if (len == 0x81 || len == 0x82)
+        {
+            do_87_header += len & 0x03;
+            EXCEPTION_ASSERT_WITH_LOG(size >= do_87_header, LibLogicalAccessException,
+                                      "RAPDU is too short");
+            len = rapdu[2];
+            if (do_87_header == 4)
+                len = (len << 8) | rapdu[3];
+        }
+        EXCEPTION_ASSERT_WITH_LOG(len >= 1 && size >= do_87_header + len,
+                                  LibLogicalAccessException, "RAPDU is too short");
+        do_99 = do_87_header + len;
     }
-    EXCEPTION_ASSERT_WITH_LOG(std::distance(itr, cpy.end()) >= 4,
-                              LibLogicalAccessException, "RAPDU is too short");
-    do_99.insert(do_99.end(), itr, itr + 4);
-    itr += 4;
-    EXCEPTION_ASSERT_WITH_LOG(std::distance(itr, cpy.end()) >= 10,
-                              LibLogicalAccessException, "RAPDU is too short");
-    do_8E.insert(do_8E.end(), itr, itr + 10);
-    itr += 10;
-
-    ByteVector K;
-    auto incremented_ssc = increment_ssc(ssc);
-    K.insert(K.end(), incremented_ssc.begin(), incremented_ssc.end());
-    K.insert(K.end(), do_87.begin(), do_87.end());
-    K.insert(K.end(), do_99.begin(), do_99.end());
-
-    bool rep = false;
-    ByteVector CC;
-    if (rep)
-        CC = compute_mac(pad(K), ks_mac, ssc);
     else
-        CC = compute_mac(pad(K), ks_mac);
-    EXCEPTION_ASSERT_WITH_LOG(CC == ByteVector(do_8E.begin() + 2, do_8E.end()),
+    {
+        EXCEPTION_ASSERT_WITH_LOG(size >= 3, LibLogicalAccessException,
+                                  "RAPDU is too short.");
+    }
+    EXCEPTION_ASSERT_WITH_LOG(size >= do_99 + 4, LibLogicalAccessException,
+                              "RAPDU is too short");
+    size_t do_8E = do_99 + 4;
+    EXCEPTION_ASSERT_WITH_LOG(size >= do_8E + 10, LibLogicalAccessException,
+                              "RAPDU is too short");
+
+    ByteVector K = increment_ssc(ssc);
+    K.reserve(K.size() + do_8E + 8);
+    K.insert(K.end(), rapdu.begin(), rapdu.begin() + do_8E);
+
+    ByteVector CC = compute_mac(pad(K), ks_mac);
+    EXCEPTION_ASSERT_WITH_LOG(std::equal(CC.begin(), CC.end(), rapdu.begin() + do_8E + 2),
                               LibLogicalAccessException, "Checksum doesn't match");
 
     ByteVector decrypted_data;
-    if (do_87.size())
+    if (do_99)
     {
+        // Skip the padding indicator.
         decrypted_data = DESHelper::DESDecrypt(
-            ByteVector(do_87.begin() + 3, do_87.end()), ks_enc, {});
-        decrypted_data = unpad(decrypted_data);
+            ByteVector(rapdu.begin() + do_87_header + 1, rapdu.begin() + do_99), ks_enc,
+            {});
+        // Remove the padding in place.
+        while (!decrypted_data.empty())
+        {
+            bool found = (decrypted_data.back() == 0x80);
+            decrypted_data.pop_back();
+            if (found)
+                break;
+        }
     }
-    decrypted_data.insert(decrypted_data.end(), do_99.begin() + 2, do_99.end());
+    decrypted_data.insert(decrypted_data.end(), rapdu.begin() + do_99 + 2,
+                          rapdu.begin() + do_8E);
     return decrypted_data;
 }
 
+size_t EPassUtils::max_plain_response_length(size_t max_response_length)
+{
+    // DO87 tag, BER length, padding indicator and padded data, then DO99 (4 bytes)
+    // and DO8E (10 bytes).
+    size_t plain = 0;
+    while (true)
+    {
+        size_t next   = plain + 1;
+        size_t padded = (next / 8 + 1) * 8;
+        size_t lenlen = (padded + 1 >= 0x100) ? 3 : ((padded + 1 >= 0x80) ? 2 : 1);
+        if (1 + lenlen + 1 + padded + 4 + 10 > max_response_length)
+            break;
+        plain = next;
+    }
+    return plain;
+}
+
 EPassEFCOM EPassUtils::parse_ef_com(const ByteVector &raw)
 {
     EPassEFCOM efcom;
@@ -123,6 +123,12 @@ class EPassUtils
                                     const ByteVector &ks_enc,
                                     const ByteVector &ks_mac, const ByteVector &ssc);
 
+    /**
+     * Largest number of plain bytes a secure messaging response can carry
+     * when the response is limited to `max_response_length` bytes of data.
+     */
+    static size_t max_plain_response_length(size_t max_response_length);
+
     /**
      * Perform MAC computation on the block `in`.
      *
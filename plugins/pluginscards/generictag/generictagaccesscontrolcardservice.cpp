@@ -35,8 +35,7 @@ namespace logicalaccess
         {
             try
             {
-                formatret = Format::getByFormatType(format->getType());
-                formatret->unSerialize(format->serialize(), "");
+                formatret = format->clone();
                 unsigned int dataLengthBits = static_cast<unsigned int>(getChip()->getChipIdentifier().size()) * 8;
 
                 if (dataLengthBits > 0)
@@ -46,7 +46,7 @@ namespace logicalaccess
 
         if (getCommands())
         {
-            ISO15693Commands::SystemInformation sysinfo = getISO15693Commands()->getSystemInformation();
+            ISO15693Commands::SystemInformation sysinfo = getSystemInformation();
             if (sysinfo.hasVICCMemorySize)
             {
                 char tmpName[255];
@@ -75,6 +75,24 @@ namespace logicalaccess
         return rootNode;
     }
 
+    ISO15693Commands::SystemInformation ISO15693Chip::getSystemInformation()
+    {
+        // Another card may answer with the same chip object, e.g. after a UID change.
+        if (d_systemInformationIdentifier.empty() || d_systemInformationIdentifier != getChipIdentifier())
+        {
+            // Not cached when the chip identifier is unknown.
+            d_systemInformation = getISO15693Commands()->getSystemInformation();
+            d_systemInformationIdentifier = getChipIdentifier();
+        }
+
+        return d_systemInformation;
+    }
+
+    void ISO15693Chip::clearSystemInformationCache()
+    {
+        d_systemInformationIdentifier.clear();
+    }
+
     std::shared_ptr<CardService> ISO15693Chip::getService(CardServiceType serviceType)
     {
         std::shared_ptr<CardService> service;
@@ -71,7 +71,28 @@ namespace logicalaccess
          */
         std::shared_ptr<ISO15693Commands> getISO15693Commands() { return std::dynamic_pointer_cast<ISO15693Commands>(getCommands()); };
 
+        /**
+         * \brief Get the system information, read from the chip on first use.
+         * \return The system information.
+         */
+        ISO15693Commands::SystemInformation getSystemInformation();
+
+        /**
+         * \brief Drop the cached system information.
+         */
+        void clearSystemInformationCache();
+
     protected:
+
+        /**
+         * \brief The cached system information.
+         */
+        ISO15693Commands::SystemInformation d_systemInformation;
+
+        /**
+         * \brief The chip identifier the system information was cached for, empty if not cached.
+         */
+        std::vector<unsigned char> d_systemInformationIdentifier;
     };
 }
 
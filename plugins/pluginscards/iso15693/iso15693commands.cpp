@@ -0,0 +1,50 @@
+/**
+ * \file iso15693commands.cpp
+ * \author Maxime C. <maxime-dev@islog.com>
+ * \brief ISO15693 commands.
+ */
+
+#include <logicalaccess/logs.hpp>
+#include "iso15693commands.hpp"
+#include "logicalaccess/myexception.hpp"
+
+namespace logicalaccess
+{
+    std::vector<unsigned char> ISO15693Commands::readMultipleBlocks(size_t block, size_t nbBlocks, size_t blockSize)
+    {
+        std::vector<unsigned char> ret;
+        ret.reserve(nbBlocks * blockSize);
+
+        // One Read Single Block per block when the reader has no multiple blocks command.
+        for (size_t i = 0; i < nbBlocks; ++i)
+        {
+            std::vector<unsigned char> data = readBlock(block + i, blockSize);
+            ret.insert(ret.end(), data.begin(), data.end());
+        }
+
+        return ret;
+    }
+
+    void ISO15693Commands::writeMultipleBlocks(size_t block, size_t nbBlocks, const std::vector<unsigned char>& data)
+    {
+        EXCEPTION_ASSERT_WITH_LOG(nbBlocks > 0 && data.size() % nbBlocks == 0, std::invalid_argument, "The data length must be a multiple of the number of blocks.");
+
+        size_t blockSize = data.size() / nbBlocks;
+        std::vector<unsigned char> tmp(blockSize);
+        for (size_t i = 0; i < nbBlocks; ++i)
+        {
+            std::copy(data.begin() + i * blockSize, data.begin() + (i + 1) * blockSize, tmp.begin());
+            writeBlock(block + i, tmp);
+        }
+    }
+
+    size_t ISO15693Commands::getMaxReadMultipleBlocks(size_t /*blockSize*/) const
+    {
+        return 1;
+    }
+
+    size_t ISO15693Commands::getMaxWriteMultipleBlocks(size_t /*blockSize*/) const
+    {
+        return 1;
+    }
+}
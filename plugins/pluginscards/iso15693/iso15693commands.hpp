@@ -55,6 +55,39 @@ namespace logicalaccess
         virtual ISO15693Commands::SystemInformation getSystemInformation() = 0;
 
         virtual unsigned char getSecurityStatus(size_t block) = 0;
+
+        /**
+         * \brief Read several blocks with a single command (Read Multiple Blocks, 0x23).
+         * \param block The first block number.
+         * \param nbBlocks The number of blocks, at most getMaxReadMultipleBlocks().
+         * \param blockSize The block size in bytes.
+         * \return The data of the blocks.
+         */
+        virtual std::vector<unsigned char> readMultipleBlocks(size_t block, size_t nbBlocks, size_t blockSize);
+
+        /**
+         * \brief Write several blocks with a single command (Write Multiple Blocks, 0x24).
+         * \param block The first block number.
+         * \param nbBlocks The number of blocks, at most getMaxWriteMultipleBlocks().
+         * \param data The data to write, nbBlocks blocks long.
+         */
+        virtual void writeMultipleBlocks(size_t block, size_t nbBlocks, const std::vector<unsigned char>& data);
+
+        /**
+         * \brief Get the maximum number of blocks for a single Read Multiple Blocks command.
+         * \param blockSize The block size in bytes.
+         * \return The number of blocks, 1 if the reader has no multiple blocks command.
+         */
+        virtual size_t getMaxReadMultipleBlocks(size_t blockSize) const;
+
+        /**
+         * \brief Get the maximum number of blocks for a single Write Multiple Blocks command.
+         *
+         * Write Multiple Blocks is optional and many tags, ICODE SLIX included, only support Write Single Block.
+         * \param blockSize The block size in bytes.
+         * \return The number of blocks, 1 if the command isn't known to be supported.
+         */
+        virtual size_t getMaxWriteMultipleBlocks(size_t blockSize) const;
     };
 }
 
@@ -8,6 +8,9 @@
 #include "iso15693storagecardservice.hpp"
 #include "iso15693location.hpp"
 #include "logicalaccess/cards/locationnode.hpp"
+#include "logicalaccess/myexception.hpp"
+
+#include <algorithm>
 
 namespace logicalaccess
 {
@@ -22,7 +25,7 @@ namespace logicalaccess
 
     void ISO15693StorageCardService::erase(std::shared_ptr<Location> location, std::shared_ptr<AccessInfo> aiToUse)
     {
-        ISO15693Commands::SystemInformation sysinfo = getISO15693Chip()->getISO15693Commands()->getSystemInformation();
+        ISO15693Commands::SystemInformation sysinfo = getISO15693Chip()->getSystemInformation();
 
         if (sysinfo.hasVICCMemorySize)
         {
@@ -41,7 +44,40 @@ namespace logicalaccess
 
         EXCEPTION_ASSERT_WITH_LOG(icLocation, std::invalid_argument, "location must be a ISO15693Location.");
 
-        getISO15693Chip()->getISO15693Commands()->writeBlock(icLocation->block, data);
+        std::shared_ptr<ISO15693Commands> cmd = getISO15693Chip()->getISO15693Commands();
+        ISO15693Commands::SystemInformation sysinfo = getISO15693Chip()->getSystemInformation();
+        size_t blockSize = static_cast<size_t>(sysinfo.blockSize);
+        if (!sysinfo.hasVICCMemorySize || data.size() <= blockSize)
+        {
+            cmd->writeBlock(icLocation->block, data);
+            return;
+        }
+
+        size_t nbBlocks = (data.size() + blockSize - 1) / blockSize;
+        EXCEPTION_ASSERT_WITH_LOG(icLocation->block >= 0 && icLocation->block + nbBlocks <= static_cast<size_t>(sysinfo.nbBlocks), std::invalid_argument, "The data doesn't fit in the chip memory.");
+
+        std::vector<unsigned char> blocks(data);
+        if (blocks.size() % blockSize)
+        {
+            // Keep the end of the last block as it is on the chip.
+            std::vector<unsigned char> last = cmd->readBlock(icLocation->block + nbBlocks - 1, blockSize);
+            EXCEPTION_ASSERT_WITH_LOG(last.size() >= blockSize, LibLogicalAccessException, "Bad block data length.");
+            blocks.insert(blocks.end(), last.begin() + blocks.size() % blockSize, last.begin() + blockSize);
+        }
+
+        size_t batch = std::max<size_t>(1, std::min<size_t>(cmd->getMaxWriteMultipleBlocks(blockSize), 256));
+        for (size_t i = 0; i < nbBlocks; i += batch)
+        {
+            size_t count = std::min(batch, nbBlocks - i);
+            if (count == 1)
+            {
+                cmd->writeBlock(icLocation->block + i, std::vector<unsigned char>(blocks.begin() + i * blockSize, blocks.begin() + (i + 1) * blockSize));
+            }
+            else
+            {
+                cmd->writeMultipleBlocks(icLocation->block + i, count, std::vector<unsigned char>(blocks.begin() + i * blockSize, blocks.begin() + (i + count) * blockSize));
+            }
+        }
     }
 
     std::vector<unsigned char> ISO15693StorageCardService::readData(std::shared_ptr<Location> location, std::shared_ptr<AccessInfo>, size_t length, CardBehavior)
@@ -52,7 +88,43 @@ namespace logicalaccess
 
         EXCEPTION_ASSERT_WITH_LOG(icLocation, std::invalid_argument, "location must be a ISO15693Location.");
 
-        return getISO15693Chip()->getISO15693Commands()->readBlock(icLocation->block);
+        std::shared_ptr<ISO15693Commands> cmd = getISO15693Chip()->getISO15693Commands();
+        if (length == 0)
+        {
+            return cmd->readBlock(icLocation->block);
+        }
+
+        std::vector<unsigned char> ret;
+        ret.reserve(length);
+        ISO15693Commands::SystemInformation sysinfo = getISO15693Chip()->getSystemInformation();
+        if (!sysinfo.hasVICCMemorySize)
+        {
+            // Unknown block size, one block at a time.
+            for (size_t block = icLocation->block; ret.size() < length; ++block)
+            {
+                std::vector<unsigned char> data = cmd->readBlock(block);
+                EXCEPTION_ASSERT_WITH_LOG(data.size() > 0, LibLogicalAccessException, "Bad block data length.");
+                ret.insert(ret.end(), data.begin(), data.end());
+            }
+        }
+        else
+        {
+            size_t blockSize = static_cast<size_t>(sysinfo.blockSize);
+            size_t nbBlocks = (length + blockSize - 1) / blockSize;
+            EXCEPTION_ASSERT_WITH_LOG(icLocation->block >= 0 && icLocation->block + nbBlocks <= static_cast<size_t>(sysinfo.nbBlocks), std::invalid_argument, "The length doesn't fit in the chip memory.");
+
+            size_t batch = std::max<size_t>(1, std::min<size_t>(cmd->getMaxReadMultipleBlocks(blockSize), 256));
+            for (size_t i = 0; i < nbBlocks; i += batch)
+            {
+                size_t count = std::min(batch, nbBlocks - i);
+                std::vector<unsigned char> data = (count == 1) ? cmd->readBlock(icLocation->block + i, blockSize) : cmd->readMultipleBlocks(icLocation->block + i, count, blockSize);
+                EXCEPTION_ASSERT_WITH_LOG(data.size() >= count * blockSize, LibLogicalAccessException, "Bad block data length.");
+                ret.insert(ret.end(), data.begin(), data.begin() + count * blockSize);
+            }
+        }
+
+        ret.resize(length);
+        return ret;
     }
 
     unsigned int ISO15693StorageCardService::readDataHeader(std::shared_ptr<Location>, std::shared_ptr<AccessInfo>, void*, size_t)
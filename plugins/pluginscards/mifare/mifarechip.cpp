@@ -34,6 +34,42 @@ namespace logicalaccess
         return d_nbSectors;
     }
 
+    std::vector<unsigned char> MifareChip::getCachedMAD(bool mad2) const
+    {
+        // Another card may answer with the same chip object, e.g. after a UID change.
+        if (d_madCacheIdentifier != getChipIdentifier())
+        {
+            return std::vector<unsigned char>();
+        }
+
+        return mad2 ? d_mad2Cache : d_madCache;
+    }
+
+    void MifareChip::setCachedMAD(bool mad2, const std::vector<unsigned char>& madbuf)
+    {
+        if (d_madCacheIdentifier != getChipIdentifier())
+        {
+            clearMADCache();
+            d_madCacheIdentifier = getChipIdentifier();
+        }
+
+        if (mad2)
+        {
+            d_mad2Cache = madbuf;
+        }
+        else
+        {
+            d_madCache = madbuf;
+        }
+    }
+
+    void MifareChip::clearMADCache()
+    {
+        d_madCache.clear();
+        d_mad2Cache.clear();
+        d_madCacheIdentifier.clear();
+    }
+
     void MifareChip::addSectorNode(std::shared_ptr<LocationNode> rootNode, int sector)
     {
         char tmpName[255];
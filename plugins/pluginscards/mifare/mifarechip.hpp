@@ -92,6 +92,25 @@ namespace logicalaccess
          */
         std::shared_ptr<MifareCommands> getMifareCommands() { return std::dynamic_pointer_cast<MifareCommands>(getCommands()); };
 
+        /**
+         * \brief Get the MAD cached for this chip.
+         * \param mad2 Get the MAD2 (sector 16) instead of the MAD (sector 0).
+         * \return The MAD data blocks, or an empty buffer if not cached or if the chip identifier changed.
+         */
+        std::vector<unsigned char> getCachedMAD(bool mad2) const;
+
+        /**
+         * \brief Cache the MAD for this chip.
+         * \param mad2 Cache the MAD2 (sector 16) instead of the MAD (sector 0).
+         * \param madbuf The MAD data blocks, or an empty buffer to drop the cached MAD.
+         */
+        void setCachedMAD(bool mad2, const std::vector<unsigned char>& madbuf);
+
+        /**
+         * \brief Drop the cached MAD and MAD2.
+         */
+        void clearMADCache();
+
     protected:
 
         /**
@@ -105,6 +124,21 @@ namespace logicalaccess
          * \brief The number of sectors in the Mifare card.
          */
         unsigned int d_nbSectors;
+
+        /**
+         * \brief The cached MAD data blocks, empty if not read yet.
+         */
+        std::vector<unsigned char> d_madCache;
+
+        /**
+         * \brief The cached MAD2 data blocks, empty if not read yet.
+         */
+        std::vector<unsigned char> d_mad2Cache;
+
+        /**
+         * \brief The chip identifier the MAD was cached for.
+         */
+        std::vector<unsigned char> d_madCacheIdentifier;
     };
 }
 
@@ -12,11 +12,107 @@
 #include "mifarelocation.hpp"
 #include "logicalaccess/myexception.hpp"
 
+#include <algorithm>
+
 #define PREFIX_PATTERN 0xE3
 #define POLYNOM_PATTERN 0x1D
 
 namespace logicalaccess
 {
+    namespace
+    {
+        /**
+         * \brief The reader key slots used by a card dump. The least recently used slot is loaded again.
+         * Some readers keep key A and key B slots apart, so a slot is known to hold a key for a key type.
+         */
+        class DumpKeySlots
+        {
+        public:
+
+            DumpKeySlots(MifareCommands& cmd, const std::vector<std::shared_ptr<MifareKey>>& keys, unsigned char nbSlots, MifareCommands::CardDump& dump)
+                : d_cmd(cmd), d_keys(keys), d_slots(std::max<unsigned char>(nbSlots, 1), Slot(-1, KT_KEY_A)), d_lastUse(d_slots.size(), 0), d_clock(0), d_dump(dump)
+            {
+            }
+
+            bool isLoaded(int key, MifareKeyType keytype) const
+            {
+                return std::find(d_slots.begin(), d_slots.end(), Slot(key, keytype)) != d_slots.end();
+            }
+
+            /**
+             * \brief Authenticate a sector with a key of the dictionary, loading it in a slot if needed.
+             */
+            bool authenticate(int sector, int key, MifareKeyType keytype)
+            {
+                size_t slot = std::find(d_slots.begin(), d_slots.end(), Slot(key, keytype)) - d_slots.begin();
+                if (slot == d_slots.size())
+                {
+                    slot = std::min_element(d_lastUse.begin(), d_lastUse.end()) - d_lastUse.begin();
+                    d_slots[slot] = Slot(-1, KT_KEY_A);
+                    ++d_dump.keyLoads;
+                    if (!d_cmd.loadKey(static_cast<unsigned char>(slot), keytype, d_keys[key], true))
+                    {
+                        return false;
+                    }
+                    d_slots[slot] = Slot(key, keytype);
+                }
+                d_lastUse[slot] = ++d_clock;
+
+                ++d_dump.authentications;
+                try
+                {
+                    d_cmd.authenticate(MifareCommands::getSectorStartBlock(sector), static_cast<unsigned char>(slot), keytype);
+                }
+                catch (std::exception&)
+                {
+                    return false;
+                }
+                return true;
+            }
+
+            /**
+             * \brief Find the key of a sector: the previous sector key first, then the loaded keys, then the others.
+             */
+            int findKey(int sector, MifareKeyType keytype, int previous)
+            {
+                std::vector<int> order;
+                if (previous >= 0)
+                {
+                    order.push_back(previous);
+                }
+                for (int pass = 0; pass < 2; ++pass)
+                {
+                    for (int key = 0; key < static_cast<int>(d_keys.size()); ++key)
+                    {
+                        if (key != previous && isLoaded(key, keytype) == (pass == 0))
+                        {
+                            order.push_back(key);
+                        }
+                    }
+                }
+
+                for (std::vector<int>::const_iterator it = order.begin(); it != order.end(); ++it)
+                {
+                    if (d_keys[*it] && authenticate(sector, *it, keytype))
+                    {
+                        return *it;
+                    }
+                }
+                return -1;
+            }
+
+        private:
+
+            typedef std::pair<int, MifareKeyType> Slot;
+
+            MifareCommands& d_cmd;
+            const std::vector<std::shared_ptr<MifareKey>>& d_keys;
+            std::vector<Slot> d_slots;
+            std::vector<unsigned int> d_lastUse;
+            unsigned int d_clock;
+            MifareCommands::CardDump& d_dump;
+        };
+    }
     void MifareCommands::authenticate(std::shared_ptr<Location> location, std::shared_ptr<AccessInfo> ai, bool write)
     {
         EXCEPTION_ASSERT_WITH_LOG(location, std::invalid_argument, "location cannot be null.");
@@ -42,7 +138,7 @@ namespace logicalaccess
         MifareAccessInfo::SectorAccessBits sab;
 		sab.setTransportConfiguration();
 
-		std::vector<unsigned char> madbuf = readSector(0, 1, madKeyA, std::shared_ptr<MifareKey>(), sab);
+		std::vector<unsigned char> madbuf = readMAD(false, madKeyA, std::shared_ptr<MifareKey>(), sab);
 		if (!madbuf.size())
         {
             THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "Can't read the MAD.");
@@ -58,7 +154,7 @@ namespace logicalaccess
 
         if ((sector == static_cast<unsigned int>(-1)) && getChip()->getCardType() == "Mifare4K")
         {
-			madbuf = readSector(16, 0, madKeyA, std::shared_ptr<MifareKey>(), sab);
+			madbuf = readMAD(true, madKeyA, std::shared_ptr<MifareKey>(), sab);
 			if (!madbuf.size())
             {
                 THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "Can't read the MAD2.");
@@ -100,7 +196,7 @@ namespace logicalaccess
                 THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "Can't make reference to the MAD itself.");
             }
 
-			std::vector<unsigned char> madbuf = readSector(0, 1, madKeyA, madKeyB, sab);
+			std::vector<unsigned char> madbuf = readMAD(false, madKeyA, madKeyB, sab);
 			if (!madbuf.size())
             {
                 THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "Can't read the MAD.");
@@ -120,6 +216,7 @@ namespace logicalaccess
             madbuf[0] = calculateMADCrc(&madbuf[0], madbuf.size());
 
             writeSector(0, 1, madbuf, madKeyA, madKeyB, sab);
+            cacheMAD(false, madbuf);
         }
         else
         {
@@ -128,7 +225,7 @@ namespace logicalaccess
                 THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "Can't make reference to the MAD2 itself.");
             }
 
-			std::vector<unsigned char> madbuf = readSector(16, 0, madKeyA, madKeyB, sab);
+			std::vector<unsigned char> madbuf = readMAD(true, madKeyA, madKeyB, sab);
 			if (!madbuf.size())
             {
                 THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "Can't read the MAD2.");
@@ -140,6 +237,40 @@ namespace logicalaccess
             madbuf[0] = calculateMADCrc(&madbuf[0], madbuf.size());
 
 			writeSector(16, 0, madbuf, madKeyA, madKeyB, sab);
+            cacheMAD(true, madbuf);
+        }
+    }
+
+    std::vector<unsigned char> MifareCommands::readMAD(bool mad2, std::shared_ptr<MifareKey> madKeyA, std::shared_ptr<MifareKey> madKeyB,
+                                                       const MifareAccessInfo::SectorAccessBits& sab)
+    {
+        std::shared_ptr<MifareChip> chip = getMifareChip();
+        std::vector<unsigned char> madbuf;
+        if (chip)
+        {
+            madbuf = chip->getCachedMAD(mad2);
+            if (madbuf.size())
+            {
+                return madbuf;
+            }
+        }
+
+        madbuf = mad2 ? readSector(16, 0, madKeyA, madKeyB, sab) : readSector(0, 1, madKeyA, madKeyB, sab);
+
+        // A corrupted MAD is read again on next use.
+        if (madbuf.size() && calculateMADCrc(&madbuf[0], madbuf.size()) == madbuf[0])
+        {
+            cacheMAD(mad2, madbuf);
+        }
+        return madbuf;
+    }
+
+    void MifareCommands::cacheMAD(bool mad2, const std::vector<unsigned char>& madbuf)
+    {
+        std::shared_ptr<MifareChip> chip = getMifareChip();
+        if (chip)
+        {
+            chip->setCachedMAD(mad2, madbuf);
         }
     }
 
@@ -170,7 +301,7 @@ namespace logicalaccess
     {
         unsigned int sector = static_cast<unsigned int>(-1);
 
-        for (unsigned int i = 1; i < madbuflen && (sector == static_cast<unsigned int>(-1)); ++i)
+        for (unsigned int i = 1; (i * 2 + 1) < madbuflen && (sector == static_cast<unsigned int>(-1)); ++i)
         {
             long paid = 0;
             paid = madbuf[(i * 2)] | (madbuf[i * 2 + 1] << 8);
@@ -295,6 +426,12 @@ namespace logicalaccess
     {
         size_t retlen = 0;
 
+        // The data written over the MAD is not checked, it is read again on next use.
+        if (sector == 0 || sector == 16)
+        {
+            cacheMAD(sector == 16, std::vector<unsigned char>());
+        }
+
 		MifareKeyType keytype, pkeytype = KT_KEY_A;
         for (int i = start_block; i < getNbBlocks(sector); i++)
         {
@@ -394,6 +531,157 @@ namespace logicalaccess
         }
     }
 
+    MifareCommands::CardDump MifareCommands::dumpCard(const std::vector<std::shared_ptr<MifareKey>>& keys, int nbSectors)
+    {
+        if (nbSectors == 0)
+        {
+            std::shared_ptr<MifareChip> chip = getMifareChip();
+            nbSectors = chip ? static_cast<int>(chip->getNbSectors()) : 16;
+        }
+        EXCEPTION_ASSERT_WITH_LOG(nbSectors > 0 && nbSectors <= 40, std::invalid_argument, "Bad number of sectors.");
+
+        CardDump dump;
+        dump.image.resize((getSectorStartBlock(nbSectors - 1) + getNbBlocks(nbSectors - 1) + 1) * 16, 0x00);
+        dump.blocksRead.resize(dump.image.size() / 16, false);
+        dump.keyA.resize(nbSectors, -1);
+        dump.keyB.resize(nbSectors, -1);
+        dump.authentications = 0;
+        dump.keyLoads = 0;
+
+        DumpKeySlots slots(*this, keys, getNbKeySlots(), dump);
+        size_t maxReadBlocks = std::max<unsigned char>(getMaxReadBlocks(), 1);
+        int previousA = -1, previousB = -1;
+
+        for (int sector = 0; sector < nbSectors; ++sector)
+        {
+            int firstBlock = getSectorStartBlock(sector);
+            int nbBlocks = getNbBlocks(sector);
+            int trailer = firstBlock + nbBlocks;
+
+            // Read consecutive blocks with the current authentication, authenticating again after a failure.
+            auto readBlocks = [&](const std::vector<int>& blocks, MifareKeyType keytype, int key)
+            {
+                size_t i = 0;
+                while (i < blocks.size())
+                {
+                    size_t count = 1;
+                    while (i + count < blocks.size() && count < maxReadBlocks && blocks[i + count] == blocks[i] + static_cast<int>(count))
+                    {
+                        ++count;
+                    }
+
+                    try
+                    {
+                        std::vector<unsigned char> data = readBinary(static_cast<unsigned char>(blocks[i]), count * 16);
+                        EXCEPTION_ASSERT_WITH_LOG(data.size() >= count * 16, LibLogicalAccessException, "Bad block data length.");
+                        std::copy(data.begin(), data.begin() + count * 16, dump.image.begin() + blocks[i] * 16);
+                        for (size_t j = 0; j < count; ++j)
+                        {
+                            dump.blocksRead[blocks[i] + j] = true;
+                        }
+                    }
+                    catch (std::exception&)
+                    {
+                        if (!slots.authenticate(sector, key, keytype))
+                        {
+                            return;
+                        }
+                    }
+                    i += count;
+                }
+            };
+
+            MifareAccessInfo::SectorAccessBits sab;
+            bool hasSab = false;
+
+            dump.keyA[sector] = slots.findKey(sector, KT_KEY_A, previousA);
+            if (dump.keyA[sector] >= 0)
+            {
+                previousA = dump.keyA[sector];
+                readBlocks(std::vector<int>(1, trailer), KT_KEY_A, dump.keyA[sector]);
+                hasSab = dump.blocksRead[trailer] && sab.fromArray(&dump.image[trailer * 16 + MIFARE_KEY_SIZE], 3);
+            }
+
+            // Without access bits, all the blocks are tried with key A, then with key B.
+            std::vector<int> blocksA, blocksB;
+            for (int i = 0; i < nbBlocks; ++i)
+            {
+                bool never = false;
+                MifareKeyType keytype = KT_KEY_A;
+                if (hasSab)
+                {
+                    int virtualblock = (sector >= 32) ? std::min(i / 5, 2) : i;
+                    const MifareAccessInfo::DataBlockAccessBits& bits = sab.d_data_blocks_access_bits[virtualblock];
+                    never = (bits.c1 && bits.c2 && bits.c3);
+                    keytype = getKeyType(sab, sector, i, false);
+                }
+
+                if (!never)
+                {
+                    if (keytype == KT_KEY_A && dump.keyA[sector] >= 0)
+                    {
+                        blocksA.push_back(firstBlock + i);
+                    }
+                    else
+                    {
+                        blocksB.push_back(firstBlock + i);
+                    }
+                }
+            }
+
+            if (!blocksA.empty())
+            {
+                readBlocks(blocksA, KT_KEY_A, dump.keyA[sector]);
+                if (!hasSab)
+                {
+                    for (std::vector<int>::const_iterator it = blocksA.begin(); it != blocksA.end(); ++it)
+                    {
+                        if (!dump.blocksRead[*it])
+                        {
+                            blocksB.push_back(*it);
+                        }
+                    }
+                }
+            }
+
+            if (!blocksB.empty() || !dump.blocksRead[trailer])
+            {
+                dump.keyB[sector] = slots.findKey(sector, KT_KEY_B, previousB);
+                if (dump.keyB[sector] >= 0)
+                {
+                    previousB = dump.keyB[sector];
+                    if (!dump.blocksRead[trailer])
+                    {
+                        blocksB.push_back(trailer);
+                    }
+                    readBlocks(blocksB, KT_KEY_B, dump.keyB[sector]);
+                }
+            }
+
+            // The keys are never read back, the dump holds the ones found.
+            if (dump.keyA[sector] >= 0)
+            {
+                std::copy(keys[dump.keyA[sector]]->getData(), keys[dump.keyA[sector]]->getData() + MIFARE_KEY_SIZE, dump.image.begin() + trailer * 16);
+            }
+            if (dump.keyB[sector] >= 0)
+            {
+                std::copy(keys[dump.keyB[sector]]->getData(), keys[dump.keyB[sector]]->getData() + MIFARE_KEY_SIZE, dump.image.begin() + trailer * 16 + 10);
+            }
+        }
+
+        return dump;
+    }
+
+    unsigned char MifareCommands::getNbKeySlots() const
+    {
+        return 1;
+    }
+
+    unsigned char MifareCommands::getMaxReadBlocks() const
+    {
+        return 1;
+    }
+
     unsigned char MifareCommands::getNbBlocks(int sector)
     {
         return ((sector >= 32) ? 15 : 3);
@@ -22,6 +22,19 @@ namespace logicalaccess
     {
     public:
 
+        /**
+         * \brief A whole card dump.
+         */
+        struct CardDump
+        {
+            std::vector<unsigned char> image; /**< \brief The card image, 16 bytes per block with the sector trailers. Blocks not read are left to 0x00. */
+            std::vector<bool> blocksRead; /**< \brief For each block, true if it was read. */
+            std::vector<int> keyA; /**< \brief For each sector, the index of the key A in the dictionary, or -1 if not found. */
+            std::vector<int> keyB; /**< \brief For each sector, the index of the key B in the dictionary, or -1 if not found or not needed. */
+            unsigned int authentications; /**< \brief The number of authentications, failed ones included. */
+            unsigned int keyLoads; /**< \brief The number of keys loaded in the reader. */
+        };
+
         virtual std::vector<unsigned char> readSector(int sector, int start_block,
 													  std::shared_ptr<MifareKey> keyA,
 													  std::shared_ptr<MifareKey> keyB,
@@ -54,6 +67,18 @@ namespace logicalaccess
 								  std::shared_ptr<MifareKey> newkeyA = std::shared_ptr<MifareKey>(),
 								  std::shared_ptr<MifareKey> newkeyB = std::shared_ptr<MifareKey>()) final;
 
+        /**
+         * \brief Dump the whole card, looking for the sector keys in a dictionary.
+         *
+         * Each sector is authenticated once with key A, and once more with key B only
+         * if its access bits require it. The key that opened the previous sector and
+         * the keys already loaded in the reader slots are tried first.
+         * \param keys The key dictionary.
+         * \param nbSectors The number of sectors, or 0 for the chip number of sectors.
+         * \return The card dump.
+         */
+        CardDump dumpCard(const std::vector<std::shared_ptr<MifareKey>>& keys, int nbSectors = 0);
+
         /**
          * \brief Get the sector referenced by the AID from the MAD.
          * \param aid The application ID.
@@ -209,8 +234,38 @@ namespace logicalaccess
          */
         static unsigned char getSectorStartBlock(int sector);
 
+        /**
+         * \brief Get the number of volatile key slots dumpCard() can use in the reader.
+         * \return The number of key slots, numbered from 0.
+         */
+        virtual unsigned char getNbKeySlots() const;
+
+        /**
+         * \brief Get the maximum number of blocks a single readBinary() can return, in the same sector.
+         * \return The number of blocks.
+         */
+        virtual unsigned char getMaxReadBlocks() const;
+
     protected:
 
+        /**
+         * \brief Read the MAD, from the chip cache when it is already known.
+         * \param mad2 Read the MAD2 (sector 16) instead of the MAD (sector 0).
+         * \param madKeyA The MAD key A for read access.
+         * \param madKeyB The MAD key B.
+         * \param sab The MAD sector access bits.
+         * \return The MAD data blocks.
+         */
+        std::vector<unsigned char> readMAD(bool mad2, std::shared_ptr<MifareKey> madKeyA, std::shared_ptr<MifareKey> madKeyB,
+                                           const MifareAccessInfo::SectorAccessBits& sab);
+
+        /**
+         * \brief Update the MAD cached by the chip.
+         * \param mad2 Update the MAD2 (sector 16) instead of the MAD (sector 0).
+         * \param madbuf The MAD data blocks, or an empty buffer to drop the cached MAD.
+         */
+        void cacheMAD(bool mad2, const std::vector<unsigned char>& madbuf);
+
         std::shared_ptr<MifareChip> getMifareChip() const;
     };
 }
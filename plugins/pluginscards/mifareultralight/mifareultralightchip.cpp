@@ -56,6 +56,20 @@ namespace logicalaccess
 		return d_nbblocks;
 	}
 
+	bool MifareUltralightChip::hasFastRead()
+	{
+		// Mifare Ultralight, Mifare Ultralight C and NTAG203 have no FAST_READ.
+		switch (getNbBlocks())
+		{
+		case 32:
+		case 44:
+		case 126:
+		case 222:
+			return true;
+		}
+		return false;
+	}
+
     void MifareUltralightChip::checkRootLocationNodeName(std::shared_ptr<LocationNode> rootNode)
     {
         unsigned short nbblocks = getNbBlocks(true);
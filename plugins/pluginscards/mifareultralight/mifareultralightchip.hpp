@@ -67,6 +67,12 @@ namespace logicalaccess
 		 */
 		virtual unsigned short getNbBlocks(bool checkOnCard = false);
 
+		/**
+		 * \brief Get if the chip supports the FAST_READ command.
+		 * \return True for the NTAG21x found by getNbBlocks(true), false otherwise.
+		 */
+		virtual bool hasFastRead();
+
 		/**
 		* \brief Create default access informations.
 		* \return Default access informations. Always null.
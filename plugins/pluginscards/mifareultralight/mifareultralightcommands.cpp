@@ -7,6 +7,9 @@
 #include <logicalaccess/logs.hpp>
 #include "mifareultralightcommands.hpp"
 #include "mifareultralightchip.hpp"
+#include "logicalaccess/myexception.hpp"
+
+#include <algorithm>
 
 namespace logicalaccess
 {
@@ -15,26 +18,50 @@ namespace logicalaccess
         return std::dynamic_pointer_cast<MifareUltralightChip>(getChip());
     }
 
-    std::vector<unsigned char> MifareUltralightCommands::readPages(int start_page, int stop_page)
+    bool MifareUltralightCommands::useFastRead()
     {
-		std::vector<unsigned char> ret;
+        if (getFastReadMaxPages() <= 0)
+        {
+            return false;
+        }
 
+        std::shared_ptr<MifareUltralightChip> chip = getMifareUltralightChip();
+        return (chip && chip->hasFastRead());
+    }
+
+    std::vector<unsigned char> MifareUltralightCommands::readPages(int start_page, int stop_page)
+    {
         if (start_page > stop_page)
         {
             THROW_EXCEPTION_WITH_LOG(std::invalid_argument, "Start page can't be greater than stop page.");
         }
 
-        for (int i = start_page; i <= stop_page; ++i)
+        size_t length = static_cast<size_t>(stop_page - start_page + 1) * 4;
+        std::vector<unsigned char> ret;
+        ret.reserve(length + 12);
+
+        int fastReadPages = (stop_page > start_page && useFastRead()) ? getFastReadMaxPages() : 0;
+        int page = start_page;
+        while (page <= stop_page)
         {
-            std::vector<unsigned char> data = readPage(i);
-            // Some commands implementation returns more than one block (eg. PC/SC)
-            if (data.size() > 4)
+            std::vector<unsigned char> data;
+            if (fastReadPages > 0)
+            {
+                data = fastRead(page, std::min(stop_page, page + fastReadPages - 1));
+            }
+            else
             {
-                i += static_cast<int>((data.size() + 3) / 4) - 1;
+                // The native READ returns 4 pages, but some readers only return the requested one.
+                data = readPage(page);
             }
-			ret.insert(ret.end(), data.begin(), data.end());
+            EXCEPTION_ASSERT_WITH_LOG(data.size() >= 4, LibLogicalAccessException, "Bad page data length.");
+
+            page += static_cast<int>((data.size() + 3) / 4);
+            ret.insert(ret.end(), data.begin(), data.end());
         }
 
+        // The last READ can go past the stop page, and wraps around at the end of the memory.
+        ret.resize(length);
         return ret;
     }
 
@@ -44,16 +71,22 @@ namespace logicalaccess
         {
             THROW_EXCEPTION_WITH_LOG(std::invalid_argument, "Start page can't be greater than stop page.");
         }
+        EXCEPTION_ASSERT_WITH_LOG(buf.size() >= static_cast<size_t>(stop_page - start_page + 1) * 4, std::invalid_argument, "The buffer is too short for the pages.");
 
-        size_t offset = 0;
-        for (int i = start_page; i <= stop_page; ++i)
+        std::vector<unsigned char> page(4);
+        std::vector<unsigned char>::const_iterator it = buf.begin();
+        for (int i = start_page; i <= stop_page; ++i, it += 4)
         {
-			std::vector<unsigned char> tmp(buf.begin() + offset, buf.begin() + offset + 4);
-			writePage(i, tmp);
-            offset += 4;
+            std::copy(it, it + 4, page.begin());
+            writePage(i, page);
         }
     }
 
+    std::vector<unsigned char> MifareUltralightCommands::fastRead(int /*start_page*/, int /*stop_page*/)
+    {
+        THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "FAST_READ is not supported by the reader.");
+    }
+
     void MifareUltralightCommands::lockPage(int page)
     {
         std::vector<unsigned char> lockbits(4, 0x00);
@@ -67,8 +67,28 @@ namespace logicalaccess
          */
         virtual void writePage(int page, const std::vector<unsigned char>& buf) = 0;
 
+        /**
+         * \brief Read a range of pages with a single FAST_READ command (NTAG21x).
+         * \param start_page The start page number.
+         * \param stop_page The stop page number, at most getFastReadMaxPages() - 1 pages after start_page.
+         * \return The data of the pages.
+         */
+        virtual std::vector<unsigned char> fastRead(int start_page, int stop_page);
+
+        /**
+         * \brief Get the maximum number of pages the reader can return for a FAST_READ command.
+         * \return The number of pages, or 0 if the reader cannot send FAST_READ to the card.
+         */
+        virtual int getFastReadMaxPages() const { return 0; }
+
     protected:
 
+        /**
+         * \brief Get if readPages() can use FAST_READ, for both the reader and the chip.
+         * \return True if FAST_READ can be used, false otherwise.
+         */
+        bool useFastRead();
+
         std::shared_ptr<MifareUltralightChip> getMifareUltralightChip();
     };
 }
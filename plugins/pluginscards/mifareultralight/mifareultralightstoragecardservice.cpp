@@ -98,6 +98,7 @@ namespace logicalaccess
 
             if (behaviorFlags & CB_AUTOSWITCHAREA)
             {
+                // Bulk read, with FAST_READ when the reader and the chip allow it.
                 dataPages = getMifareUltralightChip()->getMifareUltralightCommands()->readPages(mLocation->page, mLocation->page + nbPages - 1);
             }
             else
@@ -105,11 +106,8 @@ namespace logicalaccess
                 dataPages = getMifareUltralightChip()->getMifareUltralightCommands()->readPage(mLocation->page);
             }
 
-            // Some commands implementation returns more than one block (eg. PC/SC)
-            if (dataPages.size() > 4)
-            {
-                nbPages += static_cast<int>((dataPages.size() + 3) / 4) - 1;
-            }
+            // Without CB_AUTOSWITCHAREA, only the pages returned by a single READ are available.
+            EXCEPTION_ASSERT_WITH_LOG(dataPages.size() >= totaldatalen, std::invalid_argument, "The data length is too large for a single page read.");
 
 			ret.insert(ret.end(), dataPages.begin() + mLocation->byte, dataPages.begin() + mLocation->byte + length);
         }
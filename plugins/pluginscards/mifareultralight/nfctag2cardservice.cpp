@@ -49,8 +49,17 @@ namespace logicalaccess
 		{
 			if (CC[2] > 0)
 			{
-				// Read all available data from data blocks
-				std::vector<unsigned char> data = mfucmd->readPages(4, 4 + (CC[2] * 2) - 1);
+				// Read all available data from data blocks, starting with the pages
+				// the native READ returned after the capability container.
+				int stop_page = 4 + (CC[2] * 2) - 1;
+				std::vector<unsigned char> data(CC.begin() + 4, CC.end() - (CC.size() % 4));
+				int next_page = 4 + static_cast<int>(data.size() / 4);
+				if (next_page <= stop_page)
+				{
+					std::vector<unsigned char> next = mfucmd->readPages(next_page, stop_page);
+					data.insert(data.end(), next.begin(), next.end());
+				}
+				data.resize(static_cast<size_t>(stop_page - 3) * 4);
                 ndef = NdefMessage::TLVToNdefMessage(data);
 			}
 		}
@@ -34,8 +34,7 @@ namespace logicalaccess
         if (format)
         {
             std::shared_ptr<ProxLocation> pLocation;
-            formatret = Format::getByFormatType(format->getType());
-            formatret->unSerialize(format->serialize(), "");
+            formatret = format->clone();
             unsigned int dataLengthBits = formatret->getDataLength();
             unsigned int atrLengthBits = static_cast<unsigned int>(getChip()->getChipIdentifier().size() * 8);
             if (dataLengthBits == 0)
@@ -34,8 +34,7 @@ namespace logicalaccess
         std::shared_ptr<Format> formatret;
         if (format)
         {
-            formatret = Format::getByFormatType(format->getType());
-            formatret->unSerialize(format->serialize(), "");
+            formatret = format->clone();
         }
         else
         {
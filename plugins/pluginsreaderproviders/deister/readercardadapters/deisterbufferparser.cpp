@@ -8,23 +8,9 @@
 
 namespace logicalaccess
 {
-    std::vector<unsigned char> DeisterBufferParser::getValidBuffer(boost::circular_buffer<unsigned char>& circular_buffer)
+    DeisterBufferParser::DeisterBufferParser()
     {
-        std::vector<unsigned char> result;
-        const unsigned char STOP = 0xFE;
-
-        if (circular_buffer.size() >= 10)
-        {
-            for (size_t i = 7; i < circular_buffer.size(); ++i)
-            {
-                if (circular_buffer[i] == STOP)
-                {
-                    result.assign(circular_buffer.begin(), circular_buffer.begin() + i + 1);
-                    circular_buffer.erase(circular_buffer.begin(), circular_buffer.begin() + i + 1);
-                    break;
-                }
-            }
-        }
-        return result;
+        // The STOP byte cannot be part of the 7 bytes header.
+        setEndOfFrame(0xFE, 8);
     }
-}
\ No newline at end of file
+}
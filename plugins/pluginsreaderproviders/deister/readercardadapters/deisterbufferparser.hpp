@@ -7,21 +7,19 @@
 #ifndef DEISTERBUFFERPARSER_HPP
 #define DEISTERBUFFERPARSER_HPP
 
-#include "logicalaccess/readerproviders/circularbufferparser.hpp"
+#include "logicalaccess/readerproviders/framingbufferparser.hpp"
 
 #include <string>
 #include <vector>
 
 namespace logicalaccess
 {
-    class LIBLOGICALACCESS_API DeisterBufferParser : public CircularBufferParser
+    class LIBLOGICALACCESS_API DeisterBufferParser : public FramingBufferParser
     {
     public:
-        DeisterBufferParser() {};
+        DeisterBufferParser();
 
         virtual ~DeisterBufferParser() {};
-
-        virtual std::vector<unsigned char> getValidBuffer(boost::circular_buffer<unsigned char>& circular_buffer);
     };
 }
 
@@ -1439,6 +1439,9 @@ namespace logicalaccess
 
     void DESFireEV1ISO7816Commands::onAuthenticated()
     {
+        // Secure messaging contexts are set up once per session.
+        getDESFireChip()->getCrypto()->initSession();
+
         // If we don't have the read UID, we retrieve it
         if (!getDESFireChip()->hasRealUID())
         {
@@ -5,7 +5,9 @@
  */
 
 #include "../commands/iso7816iso7816commands.hpp"
+#include "logicalaccess/myexception.hpp"
 
+#include <algorithm>
 #include <cstring>
 
 namespace logicalaccess
@@ -37,13 +39,31 @@ namespace logicalaccess
 
     std::vector<unsigned char> ISO7816ISO7816Commands::readBinary(size_t length, size_t offset, short efid)
     {
-        std::vector<unsigned char> result;
+        std::shared_ptr<ISO7816ReaderCardAdapter> adapter = getISO7816ReaderCardAdapter();
+        size_t maxChunk = adapter->getMaxResponseDataLength();
+        std::vector<unsigned char> data;
         unsigned char p1, p2;
 
-        setP1P2(offset, efid, p1, p2);
-        result = getISO7816ReaderCardAdapter()->sendAPDUCommand(0x00, 0xB0, p1, p2, static_cast<unsigned char>(length));
+        // A length of 0 reads up to 256 bytes (Le = 00) in a single command.
+        do
+        {
+            size_t chunk = (length == 0) ? 256 : std::min(length - data.size(), maxChunk);
 
-        return std::vector<unsigned char>(result.begin(), result.end() - 2);
+            // The file selected by its short identifier becomes the current file.
+            setP1P2(offset + data.size(), data.empty() ? efid : 0, p1, p2);
+            std::vector<unsigned char> result = adapter->sendExtendedAPDUCommand(0x00, 0xB0, p1, p2, std::vector<unsigned char>(), chunk);
+            EXCEPTION_ASSERT_WITH_LOG(result.size() >= 2, LibLogicalAccessException, "Read binary response is too short.");
+
+            data.insert(data.end(), result.begin(), result.end() - 2);
+
+            // End of file reached.
+            if (result.size() - 2 < chunk)
+            {
+                break;
+            }
+        } while (data.size() < length);
+
+        return data;
     }
 
     void ISO7816ISO7816Commands::writeBinary(const std::vector<unsigned char>& data, size_t offset, short efid)
@@ -70,6 +90,22 @@ namespace logicalaccess
         getISO7816ReaderCardAdapter()->sendAPDUCommand(0x00, 0x0E, p1, p2);
     }
 
+    bool ISO7816ISO7816Commands::readExtendedLengthInfo(size_t& maxCommandDataLength, size_t& maxResponseDataLength)
+    {
+        std::vector<unsigned char> efatr;
+        try
+        {
+            efatr = readBinary(0, 0, 0x01);
+        }
+        catch (std::exception& ex)
+        {
+            LOG(LogLevel::INFOS) << "No EF.ATR/INFO on the card: " << ex.what();
+            return false;
+        }
+
+        return ISO7816ReaderCardAdapter::parseExtendedLengthInfo(efatr, maxCommandDataLength, maxResponseDataLength);
+    }
+
     std::vector<unsigned char> ISO7816ISO7816Commands::getData(size_t length, unsigned short dataObject)
     {
         std::vector<unsigned char> result;
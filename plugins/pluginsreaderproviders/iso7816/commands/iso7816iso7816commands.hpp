@@ -73,6 +73,14 @@ namespace logicalaccess
          */
         virtual void eraseBinary(size_t offset, short efid = 0);
 
+        /**
+         * \brief Read the extended length information from EF.ATR/INFO (short EF identifier 1).
+         * \param maxCommandDataLength Set to the maximum command data length supported by the card.
+         * \param maxResponseDataLength Set to the maximum response data length supported by the card.
+         * \return True if the card has the information, false otherwise.
+         */
+        virtual bool readExtendedLengthInfo(size_t& maxCommandDataLength, size_t& maxResponseDataLength);
+
         /**
          * \brief Get data.
          * \param data The buffer that will contains data.
@@ -5,11 +5,18 @@
  */
 
 #include "iso7816readercardadapter.hpp"
+#include "logicalaccess/myexception.hpp"
 
+#include <algorithm>
 #include <cstring>
 
 namespace logicalaccess
 {
+    ISO7816ReaderCardAdapter::ISO7816ReaderCardAdapter()
+        : d_maxCommandDataLength(255), d_maxResponseDataLength(256)
+    {
+    }
+
     void ISO7816ReaderCardAdapter::sendAPDUCommand(const std::vector<unsigned char>& command, unsigned char* result, size_t* resultlen)
     {
         std::vector<unsigned char> res = sendCommand(command);
@@ -98,4 +105,195 @@ namespace logicalaccess
 
         return sendCommand(command);
     }
+
+    std::vector<unsigned char> ISO7816ReaderCardAdapter::sendExtendedAPDUCommand(unsigned char cla, unsigned char ins, unsigned char p1, unsigned char p2, const std::vector<unsigned char>& data, size_t le)
+    {
+        EXCEPTION_ASSERT_WITH_LOG(data.size() <= d_maxCommandDataLength && le <= d_maxResponseDataLength, LibLogicalAccessException,
+            "The APDU is too long for the card or the reader.");
+
+        return sendCommand(buildAPDUCommand(cla, ins, p1, p2, data, le));
+    }
+
+    std::vector<unsigned char> ISO7816ReaderCardAdapter::buildAPDUCommand(unsigned char cla, unsigned char ins, unsigned char p1, unsigned char p2, const std::vector<unsigned char>& data, size_t le)
+    {
+        EXCEPTION_ASSERT_WITH_LOG(data.size() <= 65535 && le <= 65536, std::invalid_argument, "Invalid APDU data length.");
+
+        std::vector<unsigned char> command;
+        command.push_back(cla);
+        command.push_back(ins);
+        command.push_back(p1);
+        command.push_back(p2);
+
+        // Lc and Le are both short or both extended. 256 and 65536 are encoded as 0.
+        bool extended = data.size() > 255 || le > 256;
+        if (data.size() > 0)
+        {
+            if (extended)
+            {
+                command.push_back(0x00);
+                command.push_back(static_cast<unsigned char>(data.size() >> 8));
+            }
+            command.push_back(static_cast<unsigned char>(data.size()));
+            command.insert(command.end(), data.begin(), data.end());
+        }
+        if (le > 0)
+        {
+            if (extended)
+            {
+                if (data.size() == 0)
+                {
+                    command.push_back(0x00);
+                }
+                command.push_back(static_cast<unsigned char>(le >> 8));
+            }
+            command.push_back(static_cast<unsigned char>(le));
+        }
+
+        return command;
+    }
+
+    void ISO7816ReaderCardAdapter::setMaxDataLengths(size_t maxCommandDataLength, size_t maxResponseDataLength)
+    {
+        d_maxCommandDataLength = std::min<size_t>(maxCommandDataLength, 65535);
+        d_maxResponseDataLength = std::min<size_t>(maxResponseDataLength, 65536);
+    }
+
+    bool ISO7816ReaderCardAdapter::isExtendedLengthSupported(const std::vector<unsigned char>& atr)
+    {
+        if (atr.size() < 2)
+        {
+            return false;
+        }
+
+        // Skip the interface bytes: T0 and each TDi tell which of TAi+1, TBi+1, TCi+1, TDi+1 follow.
+        size_t pos = 2;
+        unsigned char y = atr[1] >> 4;
+        while (true)
+        {
+            pos += ((y & 0x01) ? 1 : 0) + ((y & 0x02) ? 1 : 0) + ((y & 0x04) ? 1 : 0);
+            if (!(y & 0x08) || pos >= atr.size())
+            {
+                break;
+            }
+            y = atr[pos++] >> 4;
+        }
+
+        size_t nbHistoricalBytes = atr[1] & 0x0f;
+        if (nbHistoricalBytes == 0 || pos + nbHistoricalBytes > atr.size())
+        {
+            return false;
+        }
+
+        // Compact-TLV historical bytes, followed by 3 status bytes with the 0x00 category indicator.
+        size_t end = pos + nbHistoricalBytes;
+        if (atr[pos] == 0x00 && nbHistoricalBytes >= 4)
+        {
+            end -= 3;
+        }
+        else if (atr[pos] != 0x80)
+        {
+            return false;
+        }
+
+        for (size_t i = pos + 1; i < end; )
+        {
+            unsigned char tag = atr[i] >> 4;
+            size_t len = atr[i] & 0x0f;
+            ++i;
+            if (i + len > end)
+            {
+                break;
+            }
+
+            // Card capabilities, third software function table.
+            if (tag == 0x07 && len >= 3)
+            {
+                return (atr[i + 2] & 0x40) != 0;
+            }
+            i += len;
+        }
+
+        return false;
+    }
+
+    /**
+     * \brief Read a BER-TLV header.
+     * \return False if the TLV does not fit in the buffer.
+     */
+    static bool readBERTLV(const std::vector<unsigned char>& buf, size_t& pos, unsigned int& tag, size_t& len)
+    {
+        if (pos >= buf.size())
+        {
+            return false;
+        }
+
+        tag = buf[pos++];
+        if ((tag & 0x1f) == 0x1f)
+        {
+            do
+            {
+                if (pos >= buf.size())
+                {
+                    return false;
+                }
+                tag = (tag << 8) | buf[pos];
+            } while (buf[pos++] & 0x80);
+        }
+
+        if (pos >= buf.size())
+        {
+            return false;
+        }
+        len = buf[pos++];
+        if (len & 0x80)
+        {
+            size_t nbBytes = len & 0x7f;
+            if (nbBytes > 3 || pos + nbBytes > buf.size())
+            {
+                return false;
+            }
+            len = 0;
+            for (size_t i = 0; i < nbBytes; ++i)
+            {
+                len = (len << 8) | buf[pos++];
+            }
+        }
+
+        return pos + len <= buf.size();
+    }
+
+    bool ISO7816ReaderCardAdapter::parseExtendedLengthInfo(const std::vector<unsigned char>& efatr, size_t& maxCommandDataLength, size_t& maxResponseDataLength)
+    {
+        size_t pos = 0, len;
+        unsigned int tag;
+        while (readBERTLV(efatr, pos, tag, len))
+        {
+            if (tag == 0x7f66)
+            {
+                // Two integers: the maximum number of bytes in a command, then in a response.
+                std::vector<unsigned char> info(efatr.begin() + pos, efatr.begin() + pos + len);
+                size_t lengths[2] = { 0, 0 };
+                size_t ipos = 0, ilen;
+                unsigned int itag;
+                for (int i = 0; i < 2; ++i)
+                {
+                    if (!readBERTLV(info, ipos, itag, ilen) || itag != 0x02 || ilen > 3)
+                    {
+                        return false;
+                    }
+                    for (size_t j = 0; j < ilen; ++j)
+                    {
+                        lengths[i] = (lengths[i] << 8) | info[ipos++];
+                    }
+                }
+
+                maxCommandDataLength = lengths[0];
+                maxResponseDataLength = lengths[1];
+                return true;
+            }
+            pos += len;
+        }
+
+        return false;
+    }
 }
\ No newline at end of file
@@ -23,6 +23,11 @@ namespace logicalaccess
     {
     public:
 
+        /**
+         * \brief Constructor. Only short APDUs are allowed until the lengths are set.
+         */
+        ISO7816ReaderCardAdapter();
+
         /**
         * \brief Send an APDU command to the reader.
         */
@@ -58,7 +63,66 @@ namespace logicalaccess
          */
         virtual std::vector<unsigned char> sendAPDUCommand(unsigned char cla, unsigned char ins, unsigned char p1, unsigned char p2);
 
+        /**
+         * \brief Send an APDU command to the reader, with extended Lc/Le fields when needed.
+         * \param data The command data, Lc is omitted if empty.
+         * \param le The expected response data length (Ne, up to 65536), Le is omitted if 0.
+         * \return The response.
+         */
+        virtual std::vector<unsigned char> sendExtendedAPDUCommand(unsigned char cla, unsigned char ins, unsigned char p1, unsigned char p2, const std::vector<unsigned char>& data, size_t le);
+
+        /**
+         * \brief Build an APDU command, in short form if Nc <= 255 and Ne <= 256, in extended form otherwise.
+         * \param data The command data, Lc is omitted if empty.
+         * \param le The expected response data length (Ne, up to 65536), Le is omitted if 0.
+         * \return The APDU command.
+         */
+        static std::vector<unsigned char> buildAPDUCommand(unsigned char cla, unsigned char ins, unsigned char p1, unsigned char p2, const std::vector<unsigned char>& data, size_t le);
+
+        /**
+         * \brief Set the largest data lengths supported by both the card and the reader.
+         * \param maxCommandDataLength The maximum command data length (Nc).
+         * \param maxResponseDataLength The maximum response data length (Ne).
+         */
+        void setMaxDataLengths(size_t maxCommandDataLength, size_t maxResponseDataLength);
+
+        /**
+         * \brief Get the maximum command data length (Nc), 255 without extended length support.
+         */
+        size_t getMaxCommandDataLength() const { return d_maxCommandDataLength; };
+
+        /**
+         * \brief Get the maximum response data length (Ne), 256 without extended length support.
+         */
+        size_t getMaxResponseDataLength() const { return d_maxResponseDataLength; };
+
+        /**
+         * \brief Check the extended Lc/Le support in the card capabilities of the ATR historical bytes.
+         * \param atr The ATR.
+         * \return True if the card supports extended Lc/Le fields.
+         */
+        static bool isExtendedLengthSupported(const std::vector<unsigned char>& atr);
+
+        /**
+         * \brief Read the extended length information of EF.ATR/INFO.
+         * \param efatr The EF.ATR/INFO content.
+         * \param maxCommandDataLength Set to the maximum command data length.
+         * \param maxResponseDataLength Set to the maximum response data length.
+         * \return True if the extended length information was found.
+         */
+        static bool parseExtendedLengthInfo(const std::vector<unsigned char>& efatr, size_t& maxCommandDataLength, size_t& maxResponseDataLength);
+
     protected:
+
+        /**
+         * \brief The maximum command data length (Nc).
+         */
+        size_t d_maxCommandDataLength;
+
+        /**
+         * \brief The maximum response data length (Ne).
+         */
+        size_t d_maxResponseDataLength;
     };
 }
 
@@ -5,7 +5,7 @@
  */
 
 #include "osdpchannel.hpp"
-#include "logicalaccess/crypto/tomcrypt.h"
+#include "logicalaccess/crypto/crc.hpp"
 #include "logicalaccess/bufferhelper.hpp"
 #include <openssl/rand.h>
 #include "logicalaccess/logs.hpp"
@@ -33,9 +33,8 @@ namespace logicalaccess
 		index += 2;
 		if ((result[index] & 0x04) >> 2) //isCRC
 		{
-			unsigned char first = 0, last = 0;
-			ComputeCrcCCITT(0x1D0F, &result[0], packetLength - 2, &first, &last);
-			EXCEPTION_ASSERT_WITH_LOG(result[packetLength - 2] == first && result[packetLength - 1] == last, std::invalid_argument, "Invalid SOM Received.");
+			uint16_t crc = CRC::updateCRC16CCITT(0x1D0F, &result[0], packetLength - 2);
+			EXCEPTION_ASSERT_WITH_LOG(result[packetLength - 2] == (crc & 0xff) && result[packetLength - 1] == (crc >> 8), std::invalid_argument, "Invalid SOM Received.");
 		}
 
 		setSequenceNumber(result[index] & 0x03);
@@ -117,10 +116,9 @@ namespace logicalaccess
 			cmd[2] = static_cast<unsigned char>(packetLength & 0x00ff);
 			cmd[3] = static_cast<unsigned char>(packetLength >> 8);
 		}
-		unsigned char first = 0, last = 0;
-		ComputeCrcCCITT(0x1D0F, &cmd[0], cmd.size(), &first, &last);
-		cmd.push_back(first);
-		cmd.push_back(last);
+		uint16_t crc = CRC::updateCRC16CCITT(0x1D0F, &cmd[0], cmd.size());
+		cmd.push_back(static_cast<unsigned char>(crc & 0xff));
+		cmd.push_back(static_cast<unsigned char>(crc >> 8));
 
 
 		return cmd;
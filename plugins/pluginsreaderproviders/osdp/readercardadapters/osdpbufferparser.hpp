@@ -7,21 +7,19 @@
 #ifndef OSDPBUFFERPARSER_HPP
 #define OSDPBUFFERPARSER_HPP
 
-#include "logicalaccess/readerproviders/circularbufferparser.hpp"
+#include "logicalaccess/readerproviders/framingbufferparser.hpp"
 
 #include <string>
 #include <vector>
 
 namespace logicalaccess
 {
-    class LIBLOGICALACCESS_API OSDPBufferParser : public CircularBufferParser
+    class LIBLOGICALACCESS_API OSDPBufferParser : public FramingBufferParser
     {
     public:
-        OSDPBufferParser() {};
+        OSDPBufferParser();
 
         virtual ~OSDPBufferParser() {};
-
-        virtual std::vector<unsigned char> getValidBuffer(boost::circular_buffer<unsigned char>& circular_buffer);
     };
 }
 
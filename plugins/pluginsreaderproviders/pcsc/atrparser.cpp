@@ -2,48 +2,73 @@
 #include "logicalaccess/bufferhelper.hpp"
 #include "logicalaccess/logs.hpp"
 #include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
 #include <logicalaccess/myexception.hpp>
 
 namespace logicalaccess
 {
+namespace
+{
+/**
+ * A built-in ATR entry. The table is constant-initialized, it is only parsed
+ * into the lookup table on first use.
+ */
+struct HardcodedATR
+{
+    const char *atr;
+    const char *card_type;
+    bool any_reader;
+    PCSCReaderUnitType reader_type;
+};
+
+const HardcodedATR hardcoded_atrs[] = {
+    {"3B8F8001804F0CA0000003064000000000000028", "Prox", false, PCSC_RUT_OMNIKEY_XX27},
+    {"3B878001C1052F2F0035C730", "MifarePlusS", true, PCSC_RUT_DEFAULT},
+    {"3B878001C1052F2F01BCD6A9", "MifarePlusX", true, PCSC_RUT_DEFAULT},
+    {"3B8F8001804F0CA000000306030036000000005D", "MifarePlus_SL1_2K", true, PCSC_RUT_DEFAULT},
+    {"3B8F8001804F0CA000000306030037000000005C", "MifarePlus_SL1_4K", true, PCSC_RUT_DEFAULT},
+    // {"3B8F8001804F0CA0000003060300020000000069", "MifarePlus_SL1_4K", true, PCSC_RUT_DEFAULT},
+    {"3B8F8001804F0CA000000306030001000000006A", "MifarePlus_SL1_2K", false, PCSC_RUT_ACS_ACR_1222L},
+    {"3B8F8001804F0CA00000030603FFA00000000034", "MifarePlus_SL1_4K", false, PCSC_RUT_SPRINGCARD},
+    {"3B878001C1052F2F0035C730", "MifarePlus_SL3_2K", true, PCSC_RUT_DEFAULT},
+    {"3BF59100FF918171FE400041080000000D", "Mifare1K", true, PCSC_RUT_DEFAULT},
+    {"3BF59100FF918171FE400041180000001D", "Mifare4K", true, PCSC_RUT_DEFAULT},
+    {"3BF59100FF918171FE400041880000008D", "Mifare1K", true, PCSC_RUT_DEFAULT},
+    {"3B09410411DD822F000088", "Mifare1K", true, PCSC_RUT_DEFAULT},
+    {"3B8F8001804F0CA000000306030000000000006B", "Mifare1K", false, PCSC_RUT_ID3_CL1356},
+    {"3B8180018080", "DESFire", true, PCSC_RUT_DEFAULT},
+    {"3B86800106757781028000", "DESFire", true, PCSC_RUT_DEFAULT},
+    {"3BF79100FF918171FE40004120001177818040", "DESFire", true, PCSC_RUT_DEFAULT},
+    {"3BF59100FF918171FE400041000000000005", "MifareUltralight", true, PCSC_RUT_DEFAULT},
+    {"3B8C80010443FD", "FeliCa", true, PCSC_RUT_DEFAULT},
+    {"3B8F80010031B86404B0ECC1739401808290000E", "CPS3", true, PCSC_RUT_DEFAULT},
+    {"3B8F8001804F0CA0000003060B00120000000071", "TagIt", true, PCSC_RUT_DEFAULT},
+    {"3B8F8001804F0CA00000030603F004000000009F", "Topaz", true, PCSC_RUT_DEFAULT},
+    {"3BDF18FF81F1FE43003F03834D494641524520506C75732053414D3B", "SAM_AV2", true, PCSC_RUT_DEFAULT},
+    {"3BDF18FF81F1FE43001F034D494641524520506C75732053414D98", "SAM_AV2", true, PCSC_RUT_DEFAULT},
+
+    // SEOS or Electronic Passport / Spanish passport (2012)
+    {"3B80800101", "SEOS", true, PCSC_RUT_DEFAULT}
+};
+
+bool atr_less(const std::vector<uint8_t> &atr, const uint8_t *other, size_t otherlen)
+{
+    int cmp = memcmp(atr.data(), other, std::min(atr.size(), otherlen));
+    return cmp < 0 || (cmp == 0 && atr.size() < otherlen);
+}
+}
+
+std::shared_ptr<const ATRParser::ATRTable> ATRParser::atr_table_;
+
+std::mutex ATRParser::atr_table_mutex_;
+
 ATRParser::ATRParser(const std::vector<uint8_t> &atr)
     : atr_(atr)
 {
-    // Populated the hardcoded atr table
-    register_hardcoded_atr("3B8F8001804F0CA0000003064000000000000028", "Prox",
-                           PCSC_RUT_OMNIKEY_XX27);
-    register_hardcoded_atr("3B878001C1052F2F0035C730", "MifarePlusS");
-    register_hardcoded_atr("3B878001C1052F2F01BCD6A9", "MifarePlusX");
-    register_hardcoded_atr("3B8F8001804F0CA000000306030036000000005D",
-                           "MifarePlus_SL1_2K");
-    register_hardcoded_atr("3B8F8001804F0CA000000306030037000000005C",
-                           "MifarePlus_SL1_4K");
-    // register_hardcoded_atr("3B8F8001804F0CA0000003060300020000000069",
-    //"MifarePlus_SL1_4K");
-    register_hardcoded_atr("3B8F8001804F0CA000000306030001000000006A",
-                           "MifarePlus_SL1_2K", PCSC_RUT_ACS_ACR_1222L);
-    register_hardcoded_atr("3B8F8001804F0CA00000030603FFA00000000034",
-                           "MifarePlus_SL1_4K", PCSC_RUT_SPRINGCARD);
-    register_hardcoded_atr("3B878001C1052F2F0035C730", "MifarePlus_SL3_2K");
-	register_hardcoded_atr("3BF59100FF918171FE400041080000000D", "Mifare1K");
-	register_hardcoded_atr("3BF59100FF918171FE400041180000001D", "Mifare4K");
-	register_hardcoded_atr("3BF59100FF918171FE400041880000008D", "Mifare1K");
-	register_hardcoded_atr("3B09410411DD822F000088", "Mifare1K");
-    register_hardcoded_atr("3B8F8001804F0CA000000306030000000000006B", "Mifare1K",
-                           PCSC_RUT_ID3_CL1356);
-	register_hardcoded_atr("3B8180018080", "DESFire");
-	register_hardcoded_atr("3B86800106757781028000", "DESFire");
-	register_hardcoded_atr("3BF79100FF918171FE40004120001177818040", "DESFire");
-	register_hardcoded_atr("3BF59100FF918171FE4000410x0000000005", "MifareUltralight");
-	register_hardcoded_atr("3B8C80010443FD", "FeliCa");
-	register_hardcoded_atr("3B8F80010031B86404B0ECC1739401808290000E", "CPS3");
-	register_hardcoded_atr("3B8F8001804F0CA0000003060B00120000000071", "TagIt");
-	register_hardcoded_atr("3B8F8001804F0CA00000030603F004000000009F", "Topaz");
-	register_hardcoded_atr("3BDF18FF81F1FE43003F03834D494641524520506C75732053414D3B", "SAM_AV2");
-	register_hardcoded_atr("3BDF18FF81F1FE43001F034D494641524520506C75732053414D98", "SAM_AV2");
-	
-	// SEOS or Electronic Passport / Spanish passport (2012)
-	register_hardcoded_atr("3B80800101", "SEOS");
 }
 
 ///
@@ -162,48 +187,166 @@ std::string ATRParser::atr_x_to_type(uint8_t code) const
 /// Hardcoded ATR related code
 ///
 
-void ATRParser::register_hardcoded_atr(const std::string &atr,
-                                       const std::string &card_type)
+std::shared_ptr<const ATRParser::ATRTable> ATRParser::get_atr_table()
+{
+    std::shared_ptr<const ATRTable> table = std::atomic_load(&atr_table_);
+    if (!table)
+    {
+        std::lock_guard<std::mutex> lock(atr_table_mutex_);
+        table = std::atomic_load(&atr_table_);
+        if (!table)
+        {
+            std::shared_ptr<ATRTable> builtin = std::make_shared<ATRTable>();
+            for (const auto &entry : hardcoded_atrs)
+            {
+                register_atr(*builtin, BufferHelper::fromHexString(entry.atr),
+                             entry.card_type, entry.any_reader, entry.reader_type);
+            }
+            table = builtin;
+            std::atomic_store(&atr_table_, table);
+        }
+    }
+    return table;
+}
+
+void ATRParser::register_atr(ATRTable &table, const std::vector<uint8_t> &atr,
+                             const std::string &card_type, bool any_reader,
+                             PCSCReaderUnitType reader_type)
+{
+    auto it = std::lower_bound(table.begin(), table.end(), atr,
+                               [](const ATRInfo &info, const std::vector<uint8_t> &key) {
+                                   return atr_less(info.atr, key.data(), key.size());
+                               });
+    if (it == table.end() || it->atr != atr)
+    {
+        ATRInfo atr_info;
+        atr_info.atr = atr;
+        it           = table.insert(it, atr_info);
+    }
+
+    // The last registration for the same ATR and reader wins.
+    if (any_reader)
+    {
+        it->card_type = card_type;
+        return;
+    }
+    for (auto &reader_card_type : it->reader_card_types)
+    {
+        if (reader_card_type.first == reader_type)
+        {
+            reader_card_type.second = card_type;
+            return;
+        }
+    }
+    it->reader_card_types.push_back(std::make_pair(reader_type, card_type));
+}
+
+void ATRParser::register_runtime_atr(const std::string &atr,
+                                     const std::string &card_type, bool any_reader,
+                                     PCSCReaderUnitType reader_type)
 {
-    ATRParser::ATRInfo atr_info;
-    atr_info.card_type = card_type;
+    std::vector<uint8_t> atr_bytes = BufferHelper::fromHexString(atr);
+    EXCEPTION_ASSERT_WITH_LOG(atr_bytes.size() >= 2, LibLogicalAccessException,
+                              "The ATR length must be at least 2 bytes long (TS + T0).");
+    EXCEPTION_ASSERT_WITH_LOG(!card_type.empty(), LibLogicalAccessException,
+                              "The card type must be specified.");
+
+    // Build the built-in table first, it takes the same lock.
+    get_atr_table();
+    std::lock_guard<std::mutex> lock(atr_table_mutex_);
+    // Readers keep using the published table while the copy is updated.
+    std::shared_ptr<ATRTable> table =
+        std::make_shared<ATRTable>(*std::atomic_load(&atr_table_));
+    register_atr(*table, atr_bytes, card_type, any_reader, reader_type);
+    std::atomic_store(&atr_table_, std::shared_ptr<const ATRTable>(table));
+}
 
-    hardcoded_atr_to_type_[BufferHelper::fromHexString(atr)] = atr_info;
+void ATRParser::registerATR(const std::string &atr, const std::string &card_type)
+{
+    register_runtime_atr(atr, card_type, true, PCSC_RUT_DEFAULT);
 }
 
-void ATRParser::register_hardcoded_atr(const std::string &atr,
-                                       const std::string &card_type,
-                                       PCSCReaderUnitType reader_type)
+void ATRParser::registerATR(const std::string &atr, const std::string &card_type,
+                            PCSCReaderUnitType reader_type)
 {
-    ATRParser::ATRInfo atr_info;
-    atr_info.card_type = card_type;
-    atr_info.reader_type.push_back(reader_type);
+    register_runtime_atr(atr, card_type, false, reader_type);
+}
 
-    hardcoded_atr_to_type_[BufferHelper::fromHexString(atr)] = atr_info;
+size_t ATRParser::loadATRDatabase(const std::string &path)
+{
+    std::ifstream file(path);
+    EXCEPTION_ASSERT_WITH_LOG(file.is_open(), LibLogicalAccessException,
+                              "Cannot open the ATR database file " + path + ".");
+
+    get_atr_table();
+    std::lock_guard<std::mutex> lock(atr_table_mutex_);
+    std::shared_ptr<ATRTable> table =
+        std::make_shared<ATRTable>(*std::atomic_load(&atr_table_));
+
+    size_t count = 0;
+    size_t line_number = 0;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        ++line_number;
+        std::istringstream fields(line);
+        std::string atr, card_type, reader_type;
+        if (!(fields >> atr) || atr[0] == '#')
+            continue;
+
+        fields >> card_type >> reader_type;
+        std::vector<uint8_t> atr_bytes = BufferHelper::fromHexString(atr);
+        char *reader_type_end          = nullptr;
+        unsigned long reader_type_value =
+            std::strtoul(reader_type.c_str(), &reader_type_end, 0);
+        if (card_type.empty() || atr_bytes.size() < 2 || atr.size() % 2 != 0 ||
+            !std::all_of(atr.begin(), atr.end(), ::isxdigit) ||
+            *reader_type_end != '\0')
+        {
+            LOG(WARNINGS) << "Ignoring invalid ATR database entry at " << path << ":"
+                          << line_number << ".";
+            continue;
+        }
+
+        if (reader_type.empty())
+        {
+            register_atr(*table, atr_bytes, card_type, true, PCSC_RUT_DEFAULT);
+        }
+        else
+        {
+            register_atr(*table, atr_bytes, card_type, false,
+                         static_cast<PCSCReaderUnitType>(reader_type_value));
+        }
+        ++count;
+    }
+
+    std::atomic_store(&atr_table_, std::shared_ptr<const ATRTable>(table));
+    LOG(INFOS) << count << " ATR entries loaded from " << path << ".";
+    return count;
 }
 
 std::string ATRParser::check_hardcoded(bool ignore_reader_type,
                                        const PCSCReaderUnitType &reader_type) const
 {
-    for (const auto &atr_info : hardcoded_atr_to_type_)
+    std::shared_ptr<const ATRTable> table = get_atr_table();
+    auto it = std::lower_bound(table->begin(), table->end(), atr_,
+                               [](const ATRInfo &info, const std::vector<uint8_t> &key) {
+                                   return atr_less(info.atr, key.data(), key.size());
+                               });
+    if (it == table->end() || it->atr != atr_)
+        return "UNKNOWN";
+
+    // When ignoring the reader type, we only want the entry that target all readers.
+    if (!ignore_reader_type)
     {
-        if (atr_info.first == atr_)
+        for (const auto &reader_card_type : it->reader_card_types)
         {
-            const auto &readers = atr_info.second.reader_type;
-
-            // We only want entry that target all readers (meaning readers.empty() ==
-            // true)
-            if (ignore_reader_type && readers.empty())
-                return atr_info.second.card_type;
-            // Try to match the reader type.
-            if (readers.empty() ||
-                std::find(readers.begin(), readers.end(), reader_type) !=
-                    readers.end())
-            {
-                return atr_info.second.card_type;
-            }
+            if (reader_card_type.first == reader_type)
+                return reader_card_type.second;
         }
     }
+    if (!it->card_type.empty())
+        return it->card_type;
     return "UNKNOWN";
 }
 
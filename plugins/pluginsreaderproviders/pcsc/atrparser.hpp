@@ -5,8 +5,10 @@
 #include "pcscreaderunitconfiguration.hpp"
 #include <cstddef>
 #include <cstdint>
-#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace logicalaccess
@@ -47,6 +49,30 @@ class LIBLOGICALACCESS_API ATRParser
      */
     static std::string guessCardType(const std::string &atr_str);
 
+    /**
+     * Register an ATR acceptable for any reader, in addition to the built-in
+     * table. It replaces a previous entry for the same ATR.
+     */
+    static void registerATR(const std::string &atr, const std::string &card_type);
+
+    /**
+     * Register an ATR for a unique type of PCSC Reader, in addition to the
+     * built-in table.
+     */
+    static void registerATR(const std::string &atr, const std::string &card_type,
+                            PCSCReaderUnitType reader_type);
+
+    /**
+     * Load ATR entries from a database file.
+     *
+     * Each line holds an hexadecimal ATR, the card type and optionally
+     * the PCSCReaderUnitType value the entry is restricted to. Empty
+     * lines and lines starting with '#' are ignored.
+     *
+     * Returns the number of registered entries.
+     */
+    static size_t loadATRDatabase(const std::string &path);
+
   private:
     std::string parse(bool ignore_reader_type,
                       const PCSCReaderUnitType &reader_type) const;
@@ -61,37 +87,50 @@ class LIBLOGICALACCESS_API ATRParser
      */
     std::string atr_x_to_type(uint8_t code) const;
 
-    /**
-     * Register an hardcoded ATR.
-     *
-     * The ATR will be register for a unique type of PCSC Reader.
-     */
-    void register_hardcoded_atr(const std::string &atr, const std::string &card_type,
-                                PCSCReaderUnitType reader_type);
-
-    /**
-     * Register an harcoded ATR acceptable for any reader.
-     */
-    void register_hardcoded_atr(const std::string &atr,
-                                const std::string &card_type);
-
     struct ATRInfo
     {
+        std::vector<uint8_t> atr;
+
+        /**
+         * The card type for any reader, empty if there is none.
+         */
         std::string card_type;
+
         /**
-         * If the reader is empty, works for all type
-         * of reader.
+         * The card types refined for specific reader types.
          */
-        std::vector<PCSCReaderUnitType> reader_type;
+        std::vector<std::pair<PCSCReaderUnitType, std::string>> reader_card_types;
     };
 
-    std::vector<uint8_t> atr_;
+    /**
+     * ATR entries sorted by ATR bytes.
+     */
+    typedef std::vector<ATRInfo> ATRTable;
 
     /**
-     * A map mapping ATR hexadecimal representation to the type of
-     * card they represent.
+     * Get the current ATR table. The built-in table is parsed on first use,
+     * the returned table is never modified afterwards.
      */
-    std::map<std::vector<uint8_t>, ATRInfo> hardcoded_atr_to_type_;
+    static std::shared_ptr<const ATRTable> get_atr_table();
+
+    /**
+     * Add or replace an entry in a table being built.
+     */
+    static void register_atr(ATRTable &table, const std::vector<uint8_t> &atr,
+                             const std::string &card_type, bool any_reader,
+                             PCSCReaderUnitType reader_type);
+
+    /**
+     * Copy the current table, register an entry and publish the new table.
+     */
+    static void register_runtime_atr(const std::string &atr, const std::string &card_type,
+                                     bool any_reader, PCSCReaderUnitType reader_type);
+
+    static std::shared_ptr<const ATRTable> atr_table_;
+
+    static std::mutex atr_table_mutex_;
+
+    std::vector<uint8_t> atr_;
 };
 }
 
@@ -16,7 +16,7 @@
 namespace logicalaccess
 {
     ISO15693PCSCCommands::ISO15693PCSCCommands()
-        : ISO15693Commands()
+        : ISO15693Commands(), d_writeMultipleBlocksSupported(false)
     {
     }
 
@@ -53,6 +53,40 @@ namespace logicalaccess
         getPCSCReaderCardAdapter()->sendAPDUCommand(0xff, 0xd6, p1, p2, static_cast<unsigned char>(data.size()), data);
     }
 
+    std::vector<unsigned char> ISO15693PCSCCommands::readMultipleBlocks(size_t block, size_t nbBlocks, size_t blockSize)
+    {
+        EXCEPTION_ASSERT_WITH_LOG(nbBlocks > 0 && nbBlocks <= getMaxReadMultipleBlocks(blockSize), std::invalid_argument, "Bad number of blocks.");
+
+        std::vector<unsigned char> result;
+        unsigned char p1 = (block & 0xffff) >> 8;
+        unsigned char p2 = static_cast<unsigned char>(block & 0xff);
+
+        result = getPCSCReaderCardAdapter()->sendAPDUCommand(0xff, 0xb0, p1, p2, static_cast<unsigned char>(nbBlocks * blockSize));
+        EXCEPTION_ASSERT_WITH_LOG(result.size() >= nbBlocks * blockSize + 2, LibLogicalAccessException, "Bad response length for the blocks.");
+
+        return std::vector<unsigned char>(result.begin(), result.begin() + nbBlocks * blockSize);
+    }
+
+    void ISO15693PCSCCommands::writeMultipleBlocks(size_t block, size_t nbBlocks, const std::vector<unsigned char>& data)
+    {
+        EXCEPTION_ASSERT_WITH_LOG(nbBlocks > 0 && data.size() % nbBlocks == 0, std::invalid_argument, "The data length must be a multiple of the number of blocks.");
+        EXCEPTION_ASSERT_WITH_LOG(nbBlocks <= getMaxWriteMultipleBlocks(data.size() / nbBlocks), std::invalid_argument, "Bad number of blocks.");
+
+        writeBlock(block, data);
+    }
+
+    size_t ISO15693PCSCCommands::getMaxReadMultipleBlocks(size_t blockSize) const
+    {
+        // Le is at most 256 bytes in a short APDU, kept to 255 as the READ BINARY Le byte is set from the length.
+        return (blockSize > 0 && blockSize <= 255) ? 255 / blockSize : 1;
+    }
+
+    size_t ISO15693PCSCCommands::getMaxWriteMultipleBlocks(size_t blockSize) const
+    {
+        // Lc is at most 255 bytes in a short APDU.
+        return (d_writeMultipleBlocksSupported && blockSize > 0 && blockSize <= 255) ? 255 / blockSize : 1;
+    }
+
     void ISO15693PCSCCommands::lockBlock(size_t block)
     {
         std::vector<unsigned char> command;
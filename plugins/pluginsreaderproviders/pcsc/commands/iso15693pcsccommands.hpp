@@ -43,11 +43,61 @@ namespace logicalaccess
         virtual ISO15693PCSCCommands::SystemInformation getSystemInformation();
         virtual unsigned char getSecurityStatus(size_t block);
 
+        /**
+         * \brief Read several blocks with a single READ BINARY, that the reader maps to Read Multiple Blocks.
+         * \param block The first block number.
+         * \param nbBlocks The number of blocks, at most getMaxReadMultipleBlocks().
+         * \param blockSize The block size in bytes.
+         * \return The data of the blocks.
+         */
+        virtual std::vector<unsigned char> readMultipleBlocks(size_t block, size_t nbBlocks, size_t blockSize);
+
+        /**
+         * \brief Write several blocks with a single UPDATE BINARY, that the reader maps to Write Multiple Blocks.
+         * \param block The first block number.
+         * \param nbBlocks The number of blocks, at most getMaxWriteMultipleBlocks().
+         * \param data The data to write, nbBlocks blocks long.
+         */
+        virtual void writeMultipleBlocks(size_t block, size_t nbBlocks, const std::vector<unsigned char>& data);
+
+        /**
+         * \brief Get the maximum number of blocks for a single Read Multiple Blocks command.
+         * \param blockSize The block size in bytes.
+         * \return The number of blocks fitting in a short APDU.
+         */
+        virtual size_t getMaxReadMultipleBlocks(size_t blockSize) const;
+
+        /**
+         * \brief Get the maximum number of blocks for a single Write Multiple Blocks command.
+         * \param blockSize The block size in bytes.
+         * \return The number of blocks fitting in a short APDU if the tag supports Write Multiple Blocks, 1 otherwise.
+         */
+        virtual size_t getMaxWriteMultipleBlocks(size_t blockSize) const;
+
+        /**
+         * \brief Set if the tag supports Write Multiple Blocks (0x24). Default is false, ICODE SLIX for one doesn't.
+         * \param supported True if supported, false otherwise.
+         */
+        void setWriteMultipleBlocksSupported(bool supported) { d_writeMultipleBlocksSupported = supported; }
+
+        /**
+         * \brief Get if the tag supports Write Multiple Blocks (0x24).
+         * \return True if supported, false otherwise.
+         */
+        bool getWriteMultipleBlocksSupported() const { return d_writeMultipleBlocksSupported; }
+
         /**
          * \brief Get the PC/SC reader/card adapter.
          * \return The PC/SC reader/card adapter.
          */
         virtual std::shared_ptr<PCSCReaderCardAdapter> getPCSCReaderCardAdapter() { return std::dynamic_pointer_cast<PCSCReaderCardAdapter>(getReaderCardAdapter()); };
+
+    protected:
+
+        /**
+         * \brief True if the tag supports Write Multiple Blocks.
+         */
+        bool d_writeMultipleBlocksSupported;
     };
 }
 
@@ -33,3 +33,9 @@ void logicalaccess::MifareACR1222LCommands::decrement(uint8_t blockno, uint32_t
 
     getPCSCReaderCardAdapter()->sendAPDUCommand(0xFF, 0xD7, 0x00, blockno, 0x05, buf);
 }
+
+unsigned char logicalaccess::MifareACR1222LCommands::getNbKeySlots() const
+{
+    // Volatile key locations 00h and 01h.
+    return 2;
+}
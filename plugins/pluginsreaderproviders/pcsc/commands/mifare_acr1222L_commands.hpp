@@ -20,6 +20,8 @@ namespace logicalaccess
         virtual void increment(uint8_t blockno, uint32_t value) override;
 
         virtual void decrement(uint8_t blockno, uint32_t value) override;
+
+        virtual unsigned char getNbKeySlots() const override;
     };
 
 }
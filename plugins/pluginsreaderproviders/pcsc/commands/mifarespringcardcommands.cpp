@@ -33,7 +33,7 @@ bool MifareSpringCardCommands::loadKey(unsigned char keyno,
     std::vector<unsigned char> result,
 		vector_key((unsigned char *)key->getData(), (unsigned char *)key->getData() + key->getLength());
 
-    unsigned char keyindex = 0x00;
+    unsigned char keyindex = 0x00 + keyno;
     if (keytype == KT_KEY_B)
     {
         keyindex = 0x10 + keyno;
@@ -82,6 +82,18 @@ void MifareSpringCardCommands::authenticate(unsigned char blockno,
         command);
 }
 
+unsigned char MifareSpringCardCommands::getNbKeySlots() const
+{
+    // Key A and key B have their own volatile locations, 00h-03h and 10h-13h.
+    return 4;
+}
+
+unsigned char MifareSpringCardCommands::getMaxReadBlocks() const
+{
+    // READ BINARY returns up to 240 bytes, when the blocks are in the same sector.
+    return 15;
+}
+
 void MifareSpringCardCommands::restore(unsigned char blockno)
 {
     std::vector<unsigned char> buf;
@@ -55,6 +55,18 @@ namespace logicalaccess
          */
         void authenticate(unsigned char blockno, unsigned char keyno, MifareKeyType keytype);
 
+        /**
+         * \brief Get the number of volatile key slots, for each key type.
+         * \return The number of key slots.
+         */
+        virtual unsigned char getNbKeySlots() const override;
+
+        /**
+         * \brief Get the maximum number of blocks a single readBinary() can return, in the same sector.
+         * \return The number of blocks.
+         */
+        virtual unsigned char getMaxReadBlocks() const override;
+
 		/**
 		* \brief Store block value to volatile memory.
 		* \param blockno The block number.
@@ -0,0 +1,32 @@
+/**
+ * \file mifareultralightacsacrcommands.cpp
+ * \author Maxime C. <maxime-dev@islog.com>
+ * \brief Mifare Ultralight - ACS ACR.
+ */
+
+#include "../commands/mifareultralightacsacrcommands.hpp"
+
+#include "../pcscreaderprovider.hpp"
+
+namespace logicalaccess
+{
+    MifareUltralightACSACRCommands::MifareUltralightACSACRCommands()
+        : MifareUltralightPCSCCommands()
+    {
+    }
+
+    MifareUltralightACSACRCommands::~MifareUltralightACSACRCommands()
+    {
+    }
+
+    int MifareUltralightACSACRCommands::getFastReadMaxPages() const
+    {
+        // Direct transmit answers are limited to a short APDU response.
+        return 60;
+    }
+
+    std::vector<unsigned char> MifareUltralightACSACRCommands::sendGenericCommand(const std::vector<unsigned char>& data)
+    {
+        return getPCSCReaderCardAdapter()->sendAPDUCommand(0xFF, 0x00, 0x00, 0x00, static_cast<unsigned char>(data.size()), data);
+    }
+}
\ No newline at end of file
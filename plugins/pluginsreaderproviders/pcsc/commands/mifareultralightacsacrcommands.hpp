@@ -0,0 +1,43 @@
+/**
+ * \file mifareultralightacsacrcommands.hpp
+ * \author Maxime C. <maxime-dev@islog.com>
+ * \brief Mifare Ultralight - ACS ACR.
+ */
+
+#ifndef LOGICALACCESS_MIFAREULTRALIGHTACSACRCOMMANDS_HPP
+#define LOGICALACCESS_MIFAREULTRALIGHTACSACRCOMMANDS_HPP
+
+#include "mifareultralightpcsccommands.hpp"
+
+namespace logicalaccess
+{
+    /**
+     * \brief The Mifare Ultralight commands class for ACS ACR reader, with the reader passthrough.
+     */
+    class LIBLOGICALACCESS_API MifareUltralightACSACRCommands : public virtual MifareUltralightPCSCCommands
+    {
+    public:
+
+        /**
+         * \brief Constructor.
+         */
+        MifareUltralightACSACRCommands();
+
+        /**
+         * \brief Destructor.
+         */
+        virtual ~MifareUltralightACSACRCommands();
+
+        /**
+         * \brief Get the maximum number of pages the reader can return for a FAST_READ command.
+         * \return The number of pages.
+         */
+        virtual int getFastReadMaxPages() const;
+
+    protected:
+
+        virtual std::vector<unsigned char> sendGenericCommand(const std::vector<unsigned char>& data);
+    };
+}
+
+#endif /* LOGICALACCESS_MIFAREULTRALIGHTACSACRCOMMANDS_HPP */
\ No newline at end of file
@@ -18,16 +18,11 @@
 namespace logicalaccess
 {
     MifareUltralightCACSACRCommands::MifareUltralightCACSACRCommands()
-        : MifareUltralightCPCSCCommands()
+        : MifareUltralightCPCSCCommands(), MifareUltralightACSACRCommands()
     {
     }
 
     MifareUltralightCACSACRCommands::~MifareUltralightCACSACRCommands()
     {
     }
-
-    std::vector<unsigned char> MifareUltralightCACSACRCommands::sendGenericCommand(const std::vector<unsigned char>& data)
-    {
-        return getPCSCReaderCardAdapter()->sendAPDUCommand(0xFF, 0x00, 0x00, 0x00, static_cast<unsigned char>(data.size()), data);
-    }
 }
\ No newline at end of file
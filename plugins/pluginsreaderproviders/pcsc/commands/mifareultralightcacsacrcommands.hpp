@@ -8,13 +8,14 @@
 #define LOGICALACCESS_MIFAREULTRALIGHTCACSACRCOMMANDS_HPP
 
 #include "mifareultralightcpcsccommands.hpp"
+#include "mifareultralightacsacrcommands.hpp"
 
 namespace logicalaccess
 {
     /**
      * \brief The Mifare Ultralight C commands class for ACS ACR reader.
      */
-    class LIBLOGICALACCESS_API MifareUltralightCACSACRCommands : public MifareUltralightCPCSCCommands
+    class LIBLOGICALACCESS_API MifareUltralightCACSACRCommands : public MifareUltralightCPCSCCommands, public MifareUltralightACSACRCommands
     {
     public:
 
@@ -27,10 +28,6 @@ namespace logicalaccess
          * \brief Destructor.
          */
         virtual ~MifareUltralightCACSACRCommands();
-
-    protected:
-
-        virtual std::vector<unsigned char> sendGenericCommand(const std::vector<unsigned char>& data);
     };
 }
 
@@ -8,13 +8,14 @@
 #define LOGICALACCESS_MIFAREULTRALIGHTCOMNIKEYXX21COMMANDS_HPP
 
 #include "mifareultralightcpcsccommands.hpp"
+#include "mifareultralightomnikeyxx21commands.hpp"
 
 namespace logicalaccess
 {
     /**
      * \brief The Mifare Ultralight C commands class for Omnikey xx21 reader.
      */
-    class LIBLOGICALACCESS_API MifareUltralightCOmnikeyXX21Commands : public MifareUltralightCPCSCCommands
+    class LIBLOGICALACCESS_API MifareUltralightCOmnikeyXX21Commands : public MifareUltralightCPCSCCommands, public MifareUltralightOmnikeyXX21Commands
     {
     public:
 
@@ -27,14 +28,6 @@ namespace logicalaccess
          * \brief Destructor.
          */
         virtual ~MifareUltralightCOmnikeyXX21Commands();
-
-    protected:
-
-		virtual void startGenericSession();
-
-		virtual void stopGenericSession();
-
-        virtual std::vector<unsigned char> sendGenericCommand(const std::vector<unsigned char>& data);
     };
 }
 
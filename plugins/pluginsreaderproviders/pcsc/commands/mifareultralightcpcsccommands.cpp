@@ -34,19 +34,6 @@ namespace logicalaccess
     {
     }
 
-	void MifareUltralightCPCSCCommands::startGenericSession()
-	{
-	}
-
-	void MifareUltralightCPCSCCommands::stopGenericSession()
-	{
-	}
-
-    std::vector<unsigned char> MifareUltralightCPCSCCommands::sendGenericCommand(const std::vector<unsigned char>& data)
-    {
-        THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "Not implemented function call.");
-    }
-
     std::vector<unsigned char> MifareUltralightCPCSCCommands::authenticate_PICC1()
     {
         std::vector<unsigned char> data;
@@ -15,7 +15,7 @@ namespace logicalaccess
     /**
      * \brief The Mifare Ultralight C commands class for PCSC reader.
      */
-    class LIBLOGICALACCESS_API MifareUltralightCPCSCCommands : public MifareUltralightPCSCCommands, public MifareUltralightCCommands
+    class LIBLOGICALACCESS_API MifareUltralightCPCSCCommands : public virtual MifareUltralightPCSCCommands, public MifareUltralightCCommands
     {
     public:
 
@@ -37,12 +37,6 @@ namespace logicalaccess
 
     protected:
 
-		virtual void startGenericSession();
-
-		virtual void stopGenericSession();
-
-        virtual std::vector<unsigned char> sendGenericCommand(const std::vector<unsigned char>& data);
-
         virtual std::vector<unsigned char> authenticate_PICC1();
 
         virtual std::vector<unsigned char> authenticate_PICC2(const std::vector<unsigned char>& encRndAB);
@@ -0,0 +1,47 @@
+/**
+ * \file mifareultralightomnikeyxx21commands.hpp
+ * \author Maxime C. <maxime-dev@islog.com>
+ * \brief Mifare Ultralight - Omnikey xx21.
+ */
+
+#ifndef LOGICALACCESS_MIFAREULTRALIGHTOMNIKEYXX21COMMANDS_HPP
+#define LOGICALACCESS_MIFAREULTRALIGHTOMNIKEYXX21COMMANDS_HPP
+
+#include "mifareultralightpcsccommands.hpp"
+
+namespace logicalaccess
+{
+    /**
+     * \brief The Mifare Ultralight commands class for Omnikey xx21 reader, with the reader passthrough.
+     */
+    class LIBLOGICALACCESS_API MifareUltralightOmnikeyXX21Commands : public virtual MifareUltralightPCSCCommands
+    {
+    public:
+
+        /**
+         * \brief Constructor.
+         */
+        MifareUltralightOmnikeyXX21Commands();
+
+        /**
+         * \brief Destructor.
+         */
+        virtual ~MifareUltralightOmnikeyXX21Commands();
+
+        /**
+         * \brief Get the maximum number of pages the reader can return for a FAST_READ command.
+         * \return The number of pages.
+         */
+        virtual int getFastReadMaxPages() const;
+
+    protected:
+
+		virtual void startGenericSession();
+
+		virtual void stopGenericSession();
+
+        virtual std::vector<unsigned char> sendGenericCommand(const std::vector<unsigned char>& data);
+    };
+}
+
+#endif /* LOGICALACCESS_MIFAREULTRALIGHTOMNIKEYXX21COMMANDS_HPP */
\ No newline at end of file
@@ -15,6 +15,7 @@
 #include "logicalaccess/cards/computermemorykeystorage.hpp"
 #include "logicalaccess/cards/readermemorykeystorage.hpp"
 #include "logicalaccess/cards/samkeystorage.hpp"
+#include "logicalaccess/myexception.hpp"
 
 namespace logicalaccess
 {
@@ -43,4 +44,45 @@ namespace logicalaccess
 
         getPCSCReaderCardAdapter()->sendAPDUCommand(0xFF, 0xD6, 0x00, static_cast<unsigned char>(page), static_cast<unsigned char>(buf.size()), buf);
     }
+
+    std::vector<unsigned char> MifareUltralightPCSCCommands::fastRead(int start_page, int stop_page)
+    {
+        EXCEPTION_ASSERT_WITH_LOG(start_page <= stop_page && stop_page - start_page < getFastReadMaxPages(), std::invalid_argument, "Bad page range for FAST_READ.");
+
+        std::vector<unsigned char> command;
+        command.push_back(0x3A);
+        command.push_back(static_cast<unsigned char>(start_page));
+        command.push_back(static_cast<unsigned char>(stop_page));
+
+        std::vector<unsigned char> result;
+        startGenericSession();
+        try
+        {
+            result = sendGenericCommand(command);
+        }
+        catch (std::exception&)
+        {
+            stopGenericSession();
+            throw;
+        }
+        stopGenericSession();
+
+        size_t length = static_cast<size_t>(stop_page - start_page + 1) * 4;
+        EXCEPTION_ASSERT_WITH_LOG(result.size() >= length + 2, CardException, "FAST_READ failed. The PICC returned a bad buffer.");
+
+        return std::vector<unsigned char>(result.begin(), result.begin() + length);
+    }
+
+    void MifareUltralightPCSCCommands::startGenericSession()
+    {
+    }
+
+    void MifareUltralightPCSCCommands::stopGenericSession()
+    {
+    }
+
+    std::vector<unsigned char> MifareUltralightPCSCCommands::sendGenericCommand(const std::vector<unsigned char>& /*data*/)
+    {
+        THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "Not implemented function call.");
+    }
 }
\ No newline at end of file
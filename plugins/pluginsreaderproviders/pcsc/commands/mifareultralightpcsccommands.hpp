@@ -57,7 +57,32 @@ namespace logicalaccess
          */
         virtual void writePage(int page, const std::vector<unsigned char>& buf);
 
+        /**
+         * \brief Read a range of pages with a single FAST_READ command, through the reader passthrough.
+         * \param start_page The start page number.
+         * \param stop_page The stop page number, at most getFastReadMaxPages() - 1 pages after start_page.
+         * \return The data of the pages.
+         */
+        virtual std::vector<unsigned char> fastRead(int start_page, int stop_page);
+
     protected:
+
+        /**
+         * \brief Start a passthrough session, if the reader requires one.
+         */
+        virtual void startGenericSession();
+
+        /**
+         * \brief Stop the passthrough session.
+         */
+        virtual void stopGenericSession();
+
+        /**
+         * \brief Send a raw command to the chip through the reader passthrough.
+         * \param data The chip command.
+         * \return The chip answer, followed by the status word.
+         */
+        virtual std::vector<unsigned char> sendGenericCommand(const std::vector<unsigned char>& data);
     };
 }
 
@@ -0,0 +1,47 @@
+/**
+ * \file mifareultralightspringcardcommands.hpp
+ * \author Maxime C. <maxime-dev@islog.com>
+ * \brief Mifare Ultralight - SpringCard.
+ */
+
+#ifndef LOGICALACCESS_MIFAREULTRALIGHTSPRINGCARDCOMMANDS_HPP
+#define LOGICALACCESS_MIFAREULTRALIGHTSPRINGCARDCOMMANDS_HPP
+
+#include "mifareultralightpcsccommands.hpp"
+
+namespace logicalaccess
+{
+    /**
+     * \brief The Mifare Ultralight commands class for SpringCard reader, with the reader passthrough.
+     */
+    class LIBLOGICALACCESS_API MifareUltralightSpringCardCommands : public virtual MifareUltralightPCSCCommands
+    {
+    public:
+
+        /**
+         * \brief Constructor.
+         */
+        MifareUltralightSpringCardCommands();
+
+        /**
+         * \brief Destructor.
+         */
+        virtual ~MifareUltralightSpringCardCommands();
+
+        /**
+         * \brief Get the maximum number of pages the reader can return for a FAST_READ command.
+         * \return The number of pages.
+         */
+        virtual int getFastReadMaxPages() const;
+
+    protected:
+
+		virtual void startGenericSession();
+
+		virtual void stopGenericSession();
+
+        virtual std::vector<unsigned char> sendGenericCommand(const std::vector<unsigned char>& data);
+    };
+}
+
+#endif /* LOGICALACCESS_MIFAREULTRALIGHTSPRINGCARDCOMMANDS_HPP */
\ No newline at end of file
@@ -15,6 +15,8 @@
 #include <boost/property_tree/ptree.hpp>
 #include "logicalaccess/myexception.hpp"
 
+#include <algorithm>
+
 namespace logicalaccess
 {
     PCSCDataTransport::PCSCDataTransport()
@@ -51,8 +53,12 @@ namespace logicalaccess
                 "is null. We cannot send.");
         if (data.size() > 0)
         {
-            unsigned char returnedData[255];
-            ULONG ulNoOfDataReceived = sizeof(returnedData);
+            // A short response is up to 256 bytes and the status word, an extended one is bounded by the reader.
+            if (d_receiveBuffer.empty())
+            {
+                d_receiveBuffer.resize(std::max<size_t>(258, getPCSCReaderUnit()->getMaxAPDULength() + 2));
+            }
+            ULONG ulNoOfDataReceived = static_cast<ULONG>(d_receiveBuffer.size());
             LPCSCARD_IO_REQUEST ior = NULL;
             switch (getPCSCReaderUnit()->getActiveProtocol())
             {
@@ -71,10 +77,10 @@ namespace logicalaccess
 
             LOG(LogLevel::COMS) << "APDU command: " << BufferHelper::getHex(data);
 
-            unsigned int errorFlag = SCardTransmit(getPCSCReaderUnit()->getHandle(), ior, &data[0], static_cast<DWORD>(data.size()), NULL, returnedData, &ulNoOfDataReceived);
+            unsigned int errorFlag = SCardTransmit(getPCSCReaderUnit()->getHandle(), ior, &data[0], static_cast<DWORD>(data.size()), NULL, &d_receiveBuffer[0], &ulNoOfDataReceived);
 
             CheckCardError(errorFlag);
-            d_response = std::vector<unsigned char>(returnedData, returnedData + ulNoOfDataReceived);
+            d_response = std::vector<unsigned char>(d_receiveBuffer.begin(), d_receiveBuffer.begin() + ulNoOfDataReceived);
         }
     }
 
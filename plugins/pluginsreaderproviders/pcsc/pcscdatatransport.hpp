@@ -100,6 +100,11 @@ namespace logicalaccess
         bool d_isConnected;
 
         std::vector<unsigned char> d_response;
+
+        /**
+         * \brief The receive buffer, sized from the reader maximum APDU length on first use.
+         */
+        std::vector<unsigned char> d_receiveBuffer;
     };
 }
 
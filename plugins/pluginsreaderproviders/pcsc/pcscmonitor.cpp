@@ -0,0 +1,489 @@
+/**
+ * \file pcscmonitor.cpp
+ * \brief PC/SC readers and cards monitor.
+ */
+
+#include "pcscmonitor.hpp"
+#include "logicalaccess/logs.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace logicalaccess
+{
+    /**
+     * \brief The pseudo reader name used by PC/SC to notify readers hotplug.
+     */
+    static const char* PNP_NOTIFICATION_READER = "\\\\?PnP?\\Notification";
+
+    /**
+     * \brief Readers list refresh interval when hotplug isn't notified, in milliseconds.
+     *
+     * It also bounds every status change wait: a stop() cancel sent just before the call starts is lost,
+     * and the loop must still get to check d_running.
+     */
+    static const DWORD POLL_INTERVAL = 1000;
+
+    PCSCMonitor::PCSCMonitor()
+        : d_scc(0), d_running(false), d_ready(false), d_pnp(false), d_nextSubscriberId(1)
+    {
+    }
+
+    PCSCMonitor::~PCSCMonitor()
+    {
+        stop();
+    }
+
+    void PCSCMonitor::start()
+    {
+        std::unique_lock<std::mutex> lock(d_mutex);
+        if (!d_running)
+        {
+            if (d_thread.joinable())
+            {
+                d_thread.join();
+            }
+            d_ready = false;
+            d_running = true;
+            d_thread = std::thread(&PCSCMonitor::run, this);
+        }
+
+        // The first scan doesn't wait for any event, it only takes a round-trip to the service.
+        d_readyCond.wait_for(lock, std::chrono::seconds(5), [this]() { return d_ready || !d_running; });
+    }
+
+    void PCSCMonitor::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(d_mutex);
+            if (!d_running.exchange(false))
+            {
+                return;
+            }
+            if (d_scc != 0)
+            {
+                scardCancel(d_scc);
+            }
+        }
+        d_readyCond.notify_all();
+
+        if (d_thread.joinable())
+        {
+            d_thread.join();
+        }
+    }
+
+    bool PCSCMonitor::isRunning() const
+    {
+        return d_running;
+    }
+
+    bool PCSCMonitor::hasPnPNotification() const
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        return d_pnp;
+    }
+
+    unsigned int PCSCMonitor::subscribe(PCSCMonitorCallback callback)
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        unsigned int id = d_nextSubscriberId++;
+        d_subscribers[id] = callback;
+        return id;
+    }
+
+    void PCSCMonitor::unsubscribe(unsigned int id)
+    {
+        std::lock_guard<std::recursive_mutex> dispatchLock(d_dispatchMutex);
+        std::lock_guard<std::mutex> lock(d_mutex);
+        d_subscribers.erase(id);
+    }
+
+    std::vector<PCSCMonitorReaderState> PCSCMonitor::getReaderStates() const
+    {
+        std::vector<PCSCMonitorReaderState> states;
+        std::lock_guard<std::mutex> lock(d_mutex);
+        for (std::vector<MonitoredReader>::const_iterator it = d_readers.cbegin(); it != d_readers.cend(); ++it)
+        {
+            PCSCMonitorReaderState state;
+            state.readerName = it->name;
+            state.cardPresent = (it->currentState & SCARD_STATE_PRESENT) != 0;
+            if (state.cardPresent)
+            {
+                state.atr = it->atr;
+            }
+            states.push_back(state);
+        }
+        return states;
+    }
+
+    void PCSCMonitor::publish(const std::vector<PCSCMonitorEvent>& events)
+    {
+        if (events.empty())
+        {
+            return;
+        }
+
+        std::lock_guard<std::recursive_mutex> dispatchLock(d_dispatchMutex);
+        std::map<unsigned int, PCSCMonitorCallback> subscribers;
+        {
+            std::lock_guard<std::mutex> lock(d_mutex);
+            subscribers = d_subscribers;
+        }
+
+        for (std::vector<PCSCMonitorEvent>::const_iterator e = events.cbegin(); e != events.cend(); ++e)
+        {
+            for (std::map<unsigned int, PCSCMonitorCallback>::const_iterator s = subscribers.cbegin(); s != subscribers.cend(); ++s)
+            {
+                try
+                {
+                    s->second(*e);
+                }
+                catch (std::exception& ex)
+                {
+                    LOG(LogLevel::ERRORS) << "PC/SC monitor subscriber failed: " << ex.what();
+                }
+            }
+        }
+    }
+
+    void PCSCMonitor::sleep(unsigned int milliseconds)
+    {
+        std::unique_lock<std::mutex> lock(d_mutex);
+        d_readyCond.wait_for(lock, std::chrono::milliseconds(milliseconds), [this]() { return !d_running; });
+    }
+
+    bool PCSCMonitor::establishContext()
+    {
+        SCARDCONTEXT scc = 0;
+        LONG r = scardEstablishContext(&scc);
+        if (r != SCARD_S_SUCCESS)
+        {
+            LOG(LogLevel::ERRORS) << "PC/SC monitor can't establish the context (" << r << ").";
+            return false;
+        }
+
+        // Probe the PnP pseudo reader once, it is not supported by every PC/SC service.
+        SCARD_READERSTATE pnp;
+        memset(&pnp, 0x00, sizeof(pnp));
+        pnp.szReader = PNP_NOTIFICATION_READER;
+        pnp.dwCurrentState = SCARD_STATE_UNAWARE;
+        r = scardGetStatusChange(scc, 0, &pnp, 1);
+
+        std::lock_guard<std::mutex> lock(d_mutex);
+        d_scc = scc;
+        d_pnp = (r == SCARD_S_SUCCESS || r == SCARD_E_TIMEOUT) && (pnp.dwEventState & SCARD_STATE_UNKNOWN) == 0;
+        return true;
+    }
+
+    void PCSCMonitor::releaseContext()
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        if (d_scc != 0)
+        {
+            scardReleaseContext(d_scc);
+            d_scc = 0;
+        }
+    }
+
+    LONG PCSCMonitor::scardEstablishContext(SCARDCONTEXT* scc)
+    {
+        return SCardEstablishContext(SCARD_SCOPE_USER, NULL, NULL, scc);
+    }
+
+    LONG PCSCMonitor::scardReleaseContext(SCARDCONTEXT scc)
+    {
+        return SCardReleaseContext(scc);
+    }
+
+    LONG PCSCMonitor::scardCancel(SCARDCONTEXT scc)
+    {
+        return SCardCancel(scc);
+    }
+
+    LONG PCSCMonitor::scardListReaders(SCARDCONTEXT scc, char* readers, DWORD* readersLength)
+    {
+        return SCardListReaders(scc, NULL, readers, readersLength);
+    }
+
+    LONG PCSCMonitor::scardGetStatusChange(SCARDCONTEXT scc, DWORD timeout, SCARD_READERSTATE* states, DWORD count)
+    {
+        return SCardGetStatusChange(scc, timeout, states, count);
+    }
+
+    void PCSCMonitor::refreshReaders(std::vector<PCSCMonitorEvent>& events)
+    {
+        std::vector<std::string> names;
+        DWORD rdlen = 0;
+        if (SCARD_S_SUCCESS == scardListReaders(d_scc, (char*)NULL, &rdlen) && rdlen > 0)
+        {
+            std::vector<char> rdnames(rdlen, '\0');
+            if (SCARD_S_SUCCESS == scardListReaders(d_scc, &rdnames[0], &rdlen))
+            {
+                for (const char* rdname = &rdnames[0]; rdname[0] != '\0'; rdname += strlen(rdname) + 1)
+                {
+                    names.push_back(std::string(rdname));
+                }
+            }
+        }
+
+        std::vector<MonitoredReader> readers;
+        for (std::vector<MonitoredReader>::const_iterator it = d_readers.cbegin(); it != d_readers.cend(); ++it)
+        {
+            if (std::find(names.begin(), names.end(), it->name) != names.end())
+            {
+                readers.push_back(*it);
+            }
+            else
+            {
+                PCSCMonitorEvent event;
+                event.error = 0;
+                event.readerName = it->name;
+                if ((it->currentState & SCARD_STATE_PRESENT) != 0)
+                {
+                    event.type = PCSCMonitorEvent::PME_CARD_REMOVED;
+                    events.push_back(event);
+                }
+                event.type = PCSCMonitorEvent::PME_READER_REMOVED;
+                events.push_back(event);
+            }
+        }
+
+        for (std::vector<std::string>::const_iterator name = names.cbegin(); name != names.cend(); ++name)
+        {
+            bool known = false;
+            for (std::vector<MonitoredReader>::const_iterator it = readers.cbegin(); !known && it != readers.cend(); ++it)
+            {
+                known = (it->name == *name);
+            }
+
+            if (!known)
+            {
+                MonitoredReader reader;
+                reader.name = *name;
+                reader.currentState = SCARD_STATE_UNAWARE;
+                readers.push_back(reader);
+
+                PCSCMonitorEvent event;
+                event.type = PCSCMonitorEvent::PME_READER_ADDED;
+                event.error = 0;
+                event.readerName = *name;
+                events.push_back(event);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(d_mutex);
+        d_readers.swap(readers);
+    }
+
+    void PCSCMonitor::run()
+    {
+        std::vector<PCSCMonitorEvent> events;
+        std::vector<SCARD_READERSTATE> states;
+        DWORD pnpState = SCARD_STATE_UNAWARE;
+        bool needRefresh = true;
+
+        while (d_running)
+        {
+            if (d_scc == 0)
+            {
+                if (!establishContext())
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(d_mutex);
+                        d_ready = true;
+                    }
+                    d_readyCond.notify_all();
+                    sleep(POLL_INTERVAL);
+                    continue;
+                }
+                pnpState = SCARD_STATE_UNAWARE;
+                needRefresh = true;
+            }
+
+            if (needRefresh)
+            {
+                refreshReaders(events);
+                needRefresh = false;
+
+                // A removed reader doesn't wake the next call up, don't hold its events until another change.
+                publish(events);
+                events.clear();
+            }
+
+            // Only this thread modifies d_readers, it can be read without lock here.
+            states.resize(d_readers.size());
+            for (size_t i = 0; i < d_readers.size(); ++i)
+            {
+                memset(&states[i], 0x00, sizeof(SCARD_READERSTATE));
+                states[i].szReader = d_readers[i].name.c_str();
+                states[i].dwCurrentState = d_readers[i].currentState;
+            }
+            if (d_pnp)
+            {
+                SCARD_READERSTATE pnp;
+                memset(&pnp, 0x00, sizeof(pnp));
+                pnp.szReader = PNP_NOTIFICATION_READER;
+                pnp.dwCurrentState = pnpState;
+                states.push_back(pnp);
+            }
+
+            LONG r = SCARD_E_TIMEOUT;
+            if (!states.empty())
+            {
+                // Don't block on the first scan, subscribers and start() wait for it.
+                bool firstScan = false;
+                for (size_t i = 0; !firstScan && i < d_readers.size(); ++i)
+                {
+                    firstScan = (d_readers[i].currentState == SCARD_STATE_UNAWARE);
+                }
+                r = scardGetStatusChange(d_scc, firstScan ? 0 : POLL_INTERVAL, &states[0], static_cast<DWORD>(states.size()));
+            }
+            else
+            {
+                sleep(POLL_INTERVAL);
+            }
+
+            if (r == SCARD_S_SUCCESS)
+            {
+                std::lock_guard<std::mutex> lock(d_mutex);
+                for (size_t i = 0; i < d_readers.size(); ++i)
+                {
+                    MonitoredReader& reader = d_readers[i];
+                    DWORD eventState = states[i].dwEventState;
+                    if ((eventState & SCARD_STATE_CHANGED) == 0)
+                    {
+                        continue;
+                    }
+                    if ((eventState & (SCARD_STATE_UNKNOWN | SCARD_STATE_IGNORE)) != 0)
+                    {
+                        needRefresh = true;
+                    }
+
+                    bool wasPresent = (reader.currentState & SCARD_STATE_PRESENT) != 0;
+                    bool present = (eventState & SCARD_STATE_PRESENT) != 0;
+                    // PC/SC lite counts card events in the upper bits, a quick swap keeps the present bit set.
+                    bool swapped = wasPresent && present && reader.currentState != SCARD_STATE_UNAWARE &&
+                        (eventState >> 16) != (reader.currentState >> 16);
+
+                    PCSCMonitorEvent event;
+                    event.error = 0;
+                    event.readerName = reader.name;
+                    if (wasPresent && (!present || swapped))
+                    {
+                        event.type = PCSCMonitorEvent::PME_CARD_REMOVED;
+                        events.push_back(event);
+                    }
+                    if (present && (!wasPresent || swapped))
+                    {
+                        event.type = PCSCMonitorEvent::PME_CARD_INSERTED;
+                        event.atr.assign(states[i].rgbAtr, states[i].rgbAtr + std::min<DWORD>(states[i].cbAtr, sizeof(states[i].rgbAtr)));
+                        events.push_back(event);
+                    }
+
+                    reader.currentState = eventState;
+                    if (present)
+                    {
+                        reader.atr.assign(states[i].rgbAtr, states[i].rgbAtr + std::min<DWORD>(states[i].cbAtr, sizeof(states[i].rgbAtr)));
+                    }
+                    else
+                    {
+                        reader.atr.clear();
+                    }
+                }
+
+                if (d_pnp && (states.back().dwEventState & SCARD_STATE_CHANGED) != 0)
+                {
+                    if (pnpState != SCARD_STATE_UNAWARE)
+                    {
+                        needRefresh = true;
+                    }
+                    pnpState = states.back().dwEventState;
+                }
+            }
+            else if (r == SCARD_E_TIMEOUT)
+            {
+                needRefresh = !d_pnp;
+            }
+            else if (r == SCARD_E_CANCELLED)
+            {
+                // Stop requested.
+            }
+            else if (r == SCARD_E_UNKNOWN_READER || r == SCARD_E_NO_READERS_AVAILABLE)
+            {
+                needRefresh = true;
+                sleep(100);
+            }
+            else
+            {
+                LOG(LogLevel::ERRORS) << "PC/SC monitor cannot get status change: " << r << ".";
+                PCSCMonitorEvent event;
+                event.type = PCSCMonitorEvent::PME_ERROR;
+                event.error = static_cast<unsigned int>(r);
+                events.push_back(event);
+
+                // The service may have been restarted, start over with a new context.
+                releaseContext();
+                sleep(POLL_INTERVAL);
+            }
+
+            publish(events);
+            events.clear();
+
+            // Ready once the first scan events are published, so start() callers only get new ones.
+            {
+                std::lock_guard<std::mutex> lock(d_mutex);
+                if (!d_ready)
+                {
+                    d_ready = true;
+                    for (size_t i = 0; d_ready && i < d_readers.size(); ++i)
+                    {
+                        d_ready = (d_readers[i].currentState != SCARD_STATE_UNAWARE);
+                    }
+                    if (r != SCARD_S_SUCCESS && r != SCARD_E_TIMEOUT)
+                    {
+                        d_ready = true;
+                    }
+                }
+            }
+            d_readyCond.notify_all();
+        }
+
+        releaseContext();
+    }
+
+    PCSCMonitorQueue::PCSCMonitorQueue(std::shared_ptr<PCSCMonitor> monitor)
+        : d_monitor(monitor)
+    {
+        d_id = d_monitor->subscribe([this](const PCSCMonitorEvent& event)
+        {
+            {
+                std::lock_guard<std::mutex> lock(d_mutex);
+                d_events.push_back(event);
+            }
+            d_cond.notify_one();
+        });
+    }
+
+    PCSCMonitorQueue::~PCSCMonitorQueue()
+    {
+        d_monitor->unsubscribe(d_id);
+    }
+
+    bool PCSCMonitorQueue::pop(PCSCMonitorEvent& event, unsigned int maxwait)
+    {
+        std::unique_lock<std::mutex> lock(d_mutex);
+        if (maxwait == 0)
+        {
+            d_cond.wait(lock, [this]() { return !d_events.empty(); });
+        }
+        else if (!d_cond.wait_for(lock, std::chrono::milliseconds(maxwait), [this]() { return !d_events.empty(); }))
+        {
+            return false;
+        }
+
+        event = d_events.front();
+        d_events.pop_front();
+        return true;
+    }
+}
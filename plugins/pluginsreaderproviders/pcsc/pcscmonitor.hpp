@@ -0,0 +1,267 @@
+/**
+ * \file pcscmonitor.hpp
+ * \brief PC/SC readers and cards monitor.
+ */
+
+#ifndef LOGICALACCESS_PCSCMONITOR_HPP
+#define LOGICALACCESS_PCSCMONITOR_HPP
+
+#include "pcscreaderunitconfiguration.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace logicalaccess
+{
+    /**
+     * \brief A reader or card event seen by the monitor.
+     */
+    struct PCSCMonitorEvent
+    {
+        /**
+         * \brief The event type.
+         */
+        typedef enum {
+            PME_READER_ADDED = 0x00, /**< A reader was plugged */
+            PME_READER_REMOVED = 0x01, /**< A reader was unplugged */
+            PME_CARD_INSERTED = 0x02, /**< A card was inserted, the ATR is set */
+            PME_CARD_REMOVED = 0x03, /**< A card was removed */
+            PME_ERROR = 0x04 /**< SCardGetStatusChange failed, the error code is set */
+        } EventType;
+
+        EventType type; /**< \brief The event type. */
+        std::string readerName; /**< \brief The reader name. */
+        std::vector<uint8_t> atr; /**< \brief The card ATR on insertion. */
+        unsigned int error; /**< \brief The PC/SC error code on error. */
+    };
+
+    /**
+     * \brief The last known state of a reader.
+     */
+    struct PCSCMonitorReaderState
+    {
+        std::string readerName; /**< \brief The reader name. */
+        bool cardPresent; /**< \brief True if a card is in the field. */
+        std::vector<uint8_t> atr; /**< \brief The card ATR if a card is present. */
+    };
+
+    /**
+     * \brief Subscriber callback. Called from the monitor thread, it must not block.
+     */
+    typedef std::function<void(const PCSCMonitorEvent&)> PCSCMonitorCallback;
+
+    /**
+     * \brief Long-lived PC/SC monitor.
+     *
+     * A single thread keeps one SCardGetStatusChange call pending over all the readers and
+     * the PnP notification pseudo reader, on its own context. Readers state is kept between
+     * calls so pcscd only wakes it up on real changes, which are dispatched to subscribers.
+     *
+     * The PC/SC calls go through protected virtual methods, so the loop can be driven
+     * without a PC/SC service. A subclass overriding them must call stop() in its destructor.
+     */
+    class LIBLOGICALACCESS_API PCSCMonitor
+    {
+    public:
+
+        /**
+         * \brief Constructor. The monitor thread is started by start().
+         */
+        PCSCMonitor();
+
+        /**
+         * \brief Destructor. Stop the monitor thread.
+         */
+        virtual ~PCSCMonitor();
+
+        /**
+         * \brief Start the monitor thread if not running, and wait for the first readers scan.
+         */
+        void start();
+
+        /**
+         * \brief Stop the monitor thread.
+         */
+        void stop();
+
+        /**
+         * \brief Check if the monitor thread is running.
+         * \return True if running, false otherwise.
+         */
+        bool isRunning() const;
+
+        /**
+         * \brief Check if readers hotplug is notified by the PC/SC service.
+         * \return True if hotplug is notified, false otherwise.
+         */
+        bool hasPnPNotification() const;
+
+        /**
+         * \brief Subscribe to the monitor events.
+         * \param callback The callback.
+         * \return The subscription identifier.
+         */
+        unsigned int subscribe(PCSCMonitorCallback callback);
+
+        /**
+         * \brief Unsubscribe from the monitor events. The callback is not running anymore when it returns,
+         * unless called from the callback itself.
+         * \param id The subscription identifier.
+         */
+        void unsubscribe(unsigned int id);
+
+        /**
+         * \brief Get the last known state of all readers.
+         * \return The readers state.
+         */
+        std::vector<PCSCMonitorReaderState> getReaderStates() const;
+
+    protected:
+
+        struct MonitoredReader
+        {
+            std::string name;
+            DWORD currentState;
+            std::vector<uint8_t> atr;
+        };
+
+        /**
+         * \brief The monitor thread loop.
+         */
+        void run();
+
+        /**
+         * \brief Update the monitored readers from the system reader list.
+         */
+        void refreshReaders(std::vector<PCSCMonitorEvent>& events);
+
+        /**
+         * \brief Dispatch events to subscribers.
+         */
+        void publish(const std::vector<PCSCMonitorEvent>& events);
+
+        /**
+         * \brief Sleep in the monitor thread, waking up on stop.
+         */
+        void sleep(unsigned int milliseconds);
+
+        /**
+         * \brief Establish the monitor context.
+         */
+        bool establishContext();
+
+        /**
+         * \brief Release the monitor context.
+         */
+        void releaseContext();
+
+        /**
+         * \brief Call SCardEstablishContext.
+         */
+        virtual LONG scardEstablishContext(SCARDCONTEXT* scc);
+
+        /**
+         * \brief Call SCardReleaseContext.
+         */
+        virtual LONG scardReleaseContext(SCARDCONTEXT scc);
+
+        /**
+         * \brief Call SCardCancel. Called from stop(), on another thread than the monitor one.
+         */
+        virtual LONG scardCancel(SCARDCONTEXT scc);
+
+        /**
+         * \brief Call SCardListReaders on all groups.
+         */
+        virtual LONG scardListReaders(SCARDCONTEXT scc, char* readers, DWORD* readersLength);
+
+        /**
+         * \brief Call SCardGetStatusChange.
+         */
+        virtual LONG scardGetStatusChange(SCARDCONTEXT scc, DWORD timeout, SCARD_READERSTATE* states, DWORD count);
+
+        SCARDCONTEXT d_scc;
+
+        std::thread d_thread;
+
+        std::atomic<bool> d_running;
+
+        bool d_ready;
+
+        bool d_pnp;
+
+        std::vector<MonitoredReader> d_readers;
+
+        std::map<unsigned int, PCSCMonitorCallback> d_subscribers;
+
+        unsigned int d_nextSubscriberId;
+
+        /**
+         * \brief Protect readers state, subscribers and readiness.
+         */
+        mutable std::mutex d_mutex;
+
+        /**
+         * \brief Serialize callbacks dispatch with unsubscribe.
+         */
+        std::recursive_mutex d_dispatchMutex;
+
+        /**
+         * \brief Signal readiness and stop requests.
+         */
+        std::condition_variable d_readyCond;
+    };
+
+    /**
+     * \brief A subscription storing monitor events in a queue, for blocking waits.
+     */
+    class LIBLOGICALACCESS_API PCSCMonitorQueue
+    {
+    public:
+
+        /**
+         * \brief Constructor. Subscribe to the monitor.
+         * \param monitor The monitor.
+         */
+        explicit PCSCMonitorQueue(std::shared_ptr<PCSCMonitor> monitor);
+
+        /**
+         * \brief Destructor. Unsubscribe from the monitor.
+         */
+        ~PCSCMonitorQueue();
+
+        /**
+         * \brief Pop the next event.
+         * \param event The event.
+         * \param maxwait The maximum time to wait in milliseconds, 0 to wait forever.
+         * \return True if an event was popped, false on timeout.
+         */
+        bool pop(PCSCMonitorEvent& event, unsigned int maxwait);
+
+    protected:
+
+        PCSCMonitorQueue(const PCSCMonitorQueue&) = delete;
+        PCSCMonitorQueue& operator=(const PCSCMonitorQueue&) = delete;
+
+        std::shared_ptr<PCSCMonitor> d_monitor;
+
+        unsigned int d_id;
+
+        std::deque<PCSCMonitorEvent> d_events;
+
+        std::mutex d_mutex;
+
+        std::condition_variable d_cond;
+    };
+}
+
+#endif /* LOGICALACCESS_PCSCMONITOR_HPP */
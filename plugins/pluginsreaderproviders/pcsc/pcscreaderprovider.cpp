@@ -41,6 +41,15 @@ namespace logicalaccess
 
     void PCSCReaderProvider::release()
     {
+        {
+            std::lock_guard<std::mutex> lock(d_monitorMutex);
+            if (d_monitor)
+            {
+                d_monitor->stop();
+                d_monitor.reset();
+            }
+        }
+
         if (d_scc != 0)
         {
             SCardReleaseContext(d_scc);
@@ -49,6 +58,17 @@ namespace logicalaccess
         }
     }
 
+    std::shared_ptr<PCSCMonitor> PCSCReaderProvider::getMonitor()
+    {
+        std::lock_guard<std::mutex> lock(d_monitorMutex);
+        if (!d_monitor)
+        {
+            d_monitor.reset(new PCSCMonitor());
+        }
+        d_monitor->start();
+        return d_monitor;
+    }
+
     std::shared_ptr<PCSCReaderProvider> PCSCReaderProvider::createInstance()
     {
         std::shared_ptr<PCSCReaderProvider> ret(new PCSCReaderProvider());
@@ -9,6 +9,7 @@
 
 #include "../iso7816/iso7816readerprovider.hpp"
 #include "pcscreaderunit.hpp"
+#include "pcscmonitor.hpp"
 
 #include <string>
 #include <vector>
@@ -97,6 +98,12 @@ namespace logicalaccess
          */
         SCARDCONTEXT getContext() { return d_scc; };
 
+        /**
+         * \brief Get the readers and cards monitor, started on first use and shared by all reader units.
+         * \return The monitor.
+         */
+        std::shared_ptr<PCSCMonitor> getMonitor();
+
     protected:
 
 #ifdef _MSC_VER
@@ -109,6 +116,16 @@ namespace logicalaccess
          */
         ReaderList d_system_readers;
 
+        /**
+         * \brief The readers and cards monitor.
+         */
+        std::shared_ptr<PCSCMonitor> d_monitor;
+
+        /**
+         * \brief Protect the monitor creation.
+         */
+        std::mutex d_monitorMutex;
+
 #ifdef _MSC_VER
 #pragma warning(pop)
 #endif
@@ -26,6 +26,9 @@
 #include "iso7816/commands/twiciso7816commands.hpp"
 #include "commands/mifareultralightpcsccommands.hpp"
 #include "commands/mifareultralightcpcsccommands.hpp"
+#include "commands/mifareultralightacsacrcommands.hpp"
+#include "commands/mifareultralightomnikeyxx21commands.hpp"
+#include "commands/mifareultralightspringcardcommands.hpp"
 #include "commands/mifareultralightcomnikeyxx21commands.hpp"
 #include "commands/mifareultralightcomnikeyxx22commands.hpp"
 #include "commands/mifareultralightcacsacrcommands.hpp"
@@ -98,6 +101,7 @@
 #include "atrparser.hpp"
 #include "commands/id3resultchecker.hpp"
 
+#include <algorithm>
 #include <cstring>
 
 #ifdef UNIX
@@ -106,6 +110,10 @@
 #include <reader.h>
 #endif
 
+#ifndef SCARD_ATTR_MAXINPUT
+#define SCARD_ATTR_MAXINPUT SCARD_ATTR_VALUE(SCARD_CLASS_VENDOR_DEFINED, 0xA007)
+#endif
+
 namespace logicalaccess
 {
     PCSCReaderUnit::PCSCReaderUnit(const std::string& name)
@@ -269,55 +277,82 @@ namespace logicalaccess
         teardown_pcsc_connection();
 
 
-        SPtrStringVector readers_names;
-        ReaderStateVector readers;
-        std::tie(readers_names, readers) = prepare_poll_parameters();
+        if (!getName().empty() && Settings::getInstance()->SeeWaitInsertionLog)
+        {
+            LOG(LogLevel::INFOS) << "Use specific reader: " << getName() << ".";
+        }
+
+        // Subscribe before looking at the current state so no insertion can be missed in between.
+        std::shared_ptr<PCSCMonitor> monitor = getPCSCReaderProvider()->getMonitor();
+        PCSCMonitorQueue events(monitor);
         ElapsedTimeCounter time_counter;
-        do
+
+        bool readerFound = false;
+        std::vector<PCSCMonitorReaderState> states = monitor->getReaderStates();
+        for (std::vector<PCSCMonitorReaderState>::const_iterator it = states.cbegin(); it != states.cend(); ++it)
         {
-            LONG r = SCardGetStatusChange(getPCSCReaderProvider()->getContext(),
-                                     ((maxwait == 0) ? INFINITE : maxwait - time_counter.elapsed()),
-                                     &readers[0], readers.size());
-            if (SCARD_S_SUCCESS == r)
+            if (getName().empty() || getName() == it->readerName)
             {
-                for (size_t i = 0; i < readers.size(); ++i)
+                readerFound = true;
+                if (it->cardPresent)
                 {
-                    if ((SCARD_STATE_CHANGED & readers[i].dwEventState) != 0)
-                    {
-                        readers[i].dwCurrentState = readers[i].dwEventState;
-                        if ((SCARD_STATE_PRESENT & readers[i].dwEventState) != 0)
-                        {
-                            // The current reader detected a card. Great, let's use it.
-
-                            std::string connectedReader;
-                            std::string cardType;
-                            atr_ = std::vector<uint8_t>(readers[i].rgbAtr,
-                                                        readers[i].rgbAtr + readers[i].cbAtr);
-
-                            // Create the proxy now, so the ATR parser operate on the correct
-                            // reader type. -- This help with some reader-specific ATR.
-                            connectedReader = std::string(readers[i].szReader);
-                            waitInsertion_create_proxy(connectedReader);
-                            cardType = ATRParser::guessCardType(atr_, getPCSCType());
-                            LOG(INFOS) << "Guessed card type from atr: " << cardType;
-                            return process_insertion(cardType, maxwait, time_counter);
-                        }
-                    }
+                    return waitInsertion_process_atr(it->readerName, it->atr, maxwait, time_counter);
+                }
+            }
+        }
+        EXCEPTION_ASSERT_WITH_LOG(readerFound || monitor->hasPnPNotification(), CardException, EXCEPTION_MSG_NOREADER);
+
+        PCSCMonitorEvent event;
+        while (true)
+        {
+            unsigned int timeout = 0;
+            if (maxwait != 0)
+            {
+                // Read once: a pop() timeout of 0 waits forever.
+                size_t elapsed = time_counter.elapsed();
+                if (elapsed >= maxwait)
+                {
+                    break;
                 }
+                timeout = static_cast<unsigned int>(maxwait - elapsed);
             }
-            else if (r != SCARD_E_TIMEOUT)
+            if (!events.pop(event, timeout))
+            {
+                break;
+            }
+
+            if (event.type == PCSCMonitorEvent::PME_ERROR)
             {
                 if (Settings::getInstance()->SeeWaitInsertionLog)
                 {
-                    LOG(LogLevel::ERRORS) << "Cannot get status change: " << r << ".";
+                    LOG(LogLevel::ERRORS) << "Cannot get status change: " << event.error << ".";
                 }
-                PCSCDataTransport::CheckCardError(static_cast<unsigned int>(r));
+                PCSCDataTransport::CheckCardError(event.error);
                 break;
             }
-        } while (maxwait == 0 || time_counter.elapsed() < maxwait);
+
+            if (event.type == PCSCMonitorEvent::PME_CARD_INSERTED && (getName().empty() || getName() == event.readerName))
+            {
+                return waitInsertion_process_atr(event.readerName, event.atr, maxwait, time_counter);
+            }
+        }
         return false;
     }
 
+    bool PCSCReaderUnit::waitInsertion_process_atr(const std::string& reader_name, const std::vector<uint8_t>& atr,
+                                                   unsigned int maxwait, const ElapsedTimeCounter& time_counter)
+    {
+        // The current reader detected a card. Great, let's use it.
+        atr_ = atr;
+
+        // Create the proxy now, so the ATR parser operate on the correct
+        // reader type. -- This help with some reader-specific ATR.
+        waitInsertion_create_proxy(reader_name);
+        std::string cardType = ATRParser::guessCardType(atr_, getPCSCType());
+        LOG(INFOS) << "Guessed card type from atr: " << cardType;
+        return process_insertion(cardType, maxwait, time_counter);
+    }
+
     bool PCSCReaderUnit::waitRemoval(unsigned int maxwait)
     {
         if (d_proxyReaderUnit)
@@ -347,125 +382,69 @@ namespace logicalaccess
             LOG(LogLevel::INFOS) << "Waiting card removal...";
         }
 
-        std::string reader = getConnectedName();
-
-        int readers_count = static_cast<int>(getReaderProvider()->getReaderList().size());
-
-        if (reader != "")
-        {
-            readers_count = 1;
-        }
+        std::string connectedName = getConnectedName();
+        std::string reader;
 
-        if (readers_count == 0)
-        {
-            THROW_EXCEPTION_WITH_LOG(CardException, EXCEPTION_MSG_NOREADER);
-        }
-
-        char** readers_names = new char*[readers_count];
-
-        for (int i = 0; i < readers_count; ++i)
-        {
-            readers_names[i] = NULL;
-        }
-
-        SCARD_READERSTATE* readers = new SCARD_READERSTATE[readers_count];
-
-        memset(readers, 0x00, sizeof(SCARD_READERSTATE) * readers_count);
+        // Subscribe before looking at the current state so no removal can be missed in between.
+        std::shared_ptr<PCSCMonitor> monitor = getPCSCReaderProvider()->getMonitor();
+        PCSCMonitorQueue events(monitor);
+        ElapsedTimeCounter time_counter;
 
-        if (reader != "")
-        {
-            readers_names[0] = strdup(reader.c_str());
-            readers[0].dwCurrentState = SCARD_STATE_UNAWARE;
-            readers[0].dwEventState = SCARD_STATE_UNAWARE;
-            readers[0].szReader = reinterpret_cast<const char*>(readers_names[0]);
-        }
-        else
+        bool readerFound = false;
+        std::vector<PCSCMonitorReaderState> states = monitor->getReaderStates();
+        for (std::vector<PCSCMonitorReaderState>::const_iterator it = states.cbegin(); reader.empty() && it != states.cend(); ++it)
         {
-            for (int i = 0; i < readers_count; ++i)
+            if (connectedName.empty() || connectedName == it->readerName)
             {
-                readers_names[i] = strdup(getReaderProvider()->getReaderList().at(i)->getName().c_str());
-                readers[i].dwCurrentState = SCARD_STATE_UNAWARE;
-                readers[i].dwEventState = SCARD_STATE_UNAWARE;
-                readers[i].szReader = reinterpret_cast<const char*>(readers_names[i]);
+                readerFound = true;
+                if (!it->cardPresent)
+                {
+                    reader = it->readerName;
+                }
             }
         }
 
-        reader.clear();
-
-        LONG r = SCardGetStatusChange(getPCSCReaderProvider()->getContext(), ((maxwait == 0) ? INFINITE : maxwait), readers, readers_count);
+        if (!readerFound)
+        {
+            // An unplugged reader has no card anymore.
+            EXCEPTION_ASSERT_WITH_LOG(!connectedName.empty(), CardException, EXCEPTION_MSG_NOREADER);
+            reader = connectedName;
+        }
 
-        if (SCARD_S_SUCCESS == r)
+        PCSCMonitorEvent event;
+        while (reader.empty())
         {
-            for (int i = 0; i < readers_count; ++i)
+            unsigned int timeout = 0;
+            if (maxwait != 0)
             {
-                if ((SCARD_STATE_PRESENT & readers[i].dwEventState) == 0)
+                // Read once: a pop() timeout of 0 waits forever.
+                size_t elapsed = time_counter.elapsed();
+                if (elapsed >= maxwait)
                 {
-                    reader = std::string(reinterpret_cast<const char*>(readers[i].szReader), strlen(reinterpret_cast<const char*>(readers[i].szReader)));
                     break;
                 }
+                timeout = static_cast<unsigned int>(maxwait - elapsed);
+            }
+            if (!events.pop(event, timeout))
+            {
+                break;
             }
 
-            if (reader == "")
+            if (event.type == PCSCMonitorEvent::PME_ERROR)
             {
-                for (int i = 0; i < readers_count; ++i)
+                if (Settings::getInstance()->SeeWaitRemovalLog)
                 {
-                    readers[i].dwCurrentState = readers[i].dwEventState;
+                    LOG(LogLevel::ERRORS) << "Cannot get status change: " << event.error << ".";
                 }
-
-                bool loop;
-                ElapsedTimeCounter time_counter;
-                do
-                {
-                    loop = false;
-                    r = SCardGetStatusChange(getPCSCReaderProvider()->getContext(), ((maxwait == 0) ? INFINITE : maxwait), readers, readers_count);
-
-                    if (SCARD_S_SUCCESS == r)
-                    {
-                        if ((maxwait == 0) || time_counter.elapsed() < maxwait)
-                        {
-                            loop = true;
-                        }
-                        for (int i = 0; i < readers_count; ++i)
-                        {
-                            if ((SCARD_STATE_PRESENT & readers[i].dwEventState) == 0)
-                            {
-                                loop = false;
-
-                                reader = std::string(reinterpret_cast<const char*>(readers[i].szReader), strlen(reinterpret_cast<const char*>(readers[i].szReader)));
-                                break;
-                            }
-                        }
-                    }
-                    else
-                    {
-                        if (r != SCARD_E_TIMEOUT)
-                        {
-                            if (Settings::getInstance()->SeeWaitRemovalLog)
-                            {
-                                LOG(LogLevel::ERRORS) << "Cannot get status change: " << r << ".";
-                            }
-                            PCSCDataTransport::CheckCardError(r);
-                        }
-                    }
-                } while (loop);
+                PCSCDataTransport::CheckCardError(event.error);
             }
-        }
-
-        for (int i = 0; i < readers_count; ++i)
-        {
-            if (readers_names[i])
+            else if ((event.type == PCSCMonitorEvent::PME_CARD_REMOVED || event.type == PCSCMonitorEvent::PME_READER_REMOVED) &&
+                     (connectedName.empty() || connectedName == event.readerName))
             {
-                free(readers_names[i]);
-                readers_names[i] = NULL;
+                reader = event.readerName;
             }
         }
 
-        delete[] readers;
-        readers = NULL;
-
-        delete[] readers_names;
-        readers_names = NULL;
-
         if (!reader.empty())
         {
             if (d_name == "")
@@ -511,6 +490,7 @@ namespace logicalaccess
                 detect_mifareplus_security_level(d_insertedChip);
 
             d_insertedChip = adjustChip(d_insertedChip);
+            configure_extended_length(d_insertedChip);
             if (d_proxyReaderUnit)
             {
                 d_proxyReaderUnit->setSingleChip(d_insertedChip);
@@ -757,7 +737,23 @@ namespace logicalaccess
             }
 			else if (type == CHIP_MIFAREULTRALIGHT)
             {
-                commands.reset(new MifareUltralightPCSCCommands());
+                // The reader passthrough allows FAST_READ on NTAG21x.
+                if (getPCSCType() == PCSC_RUT_ACS_ACR || getPCSCType() == PCSC_RUT_ACS_ACR_1222L)
+                {
+                    commands.reset(new MifareUltralightACSACRCommands());
+                }
+                else if (getPCSCType() == PCSC_RUT_SPRINGCARD)
+                {
+                    commands.reset(new MifareUltralightSpringCardCommands());
+                }
+                else if (getPCSCType() == PCSC_RUT_OMNIKEY_XX21)
+                {
+                    commands.reset(new MifareUltralightOmnikeyXX21Commands());
+                }
+                else
+                {
+                    commands.reset(new MifareUltralightPCSCCommands());
+                }
             }
 			else if (type == CHIP_MIFAREULTRALIGHTC)
             {
@@ -939,6 +935,53 @@ namespace logicalaccess
         return serialno;
     }
 
+    size_t PCSCReaderUnit::getMaxAPDULength()
+    {
+        if (d_proxyReaderUnit)
+        {
+            return d_proxyReaderUnit->getMaxAPDULength();
+        }
+
+        uint32_t maxinput = 0;
+        DWORD maxinputlen = sizeof(maxinput);
+        if (SCARD_S_SUCCESS != SCardGetAttrib(getHandle(), SCARD_ATTR_MAXINPUT, (LPBYTE)&maxinput, &maxinputlen) || maxinputlen != sizeof(maxinput))
+        {
+            return 0;
+        }
+
+        return maxinput;
+    }
+
+    void PCSCReaderUnit::configure_extended_length(std::shared_ptr<Chip> c)
+    {
+        // Short APDU: 255 bytes of command data, 256 bytes of response data.
+        size_t maxNc = 255, maxNe = 256;
+
+        // Extended APDU header: CLA INS P1 P2, 3-byte Lc and 2-byte Le.
+        size_t maxinput = getMaxAPDULength();
+        if (maxinput > 261 && ISO7816ReaderCardAdapter::isExtendedLengthSupported(atr_))
+        {
+            maxNc = std::min<size_t>(maxinput - 9, 65535);
+            maxNe = std::min<size_t>(maxinput - 2, 65536);
+        }
+        LOG(LogLevel::INFOS) << "Reader max input {" << maxinput << "}, APDU data lengths {" << maxNc << "/" << maxNe << "}";
+
+        std::shared_ptr<ISO7816ReaderCardAdapter> rca = std::dynamic_pointer_cast<ISO7816ReaderCardAdapter>(getDefaultReaderCardAdapter());
+        if (rca)
+        {
+            rca->setMaxDataLengths(maxNc, maxNe);
+        }
+
+        if (c && c->getCommands())
+        {
+            rca = std::dynamic_pointer_cast<ISO7816ReaderCardAdapter>(c->getCommands()->getReaderCardAdapter());
+            if (rca)
+            {
+                rca->setMaxDataLengths(maxNc, maxNe);
+            }
+        }
+    }
+
     std::shared_ptr<PCSCReaderProvider> PCSCReaderUnit::getPCSCReaderProvider() const
     {
         if (d_proxyReaderUnit)
@@ -1288,52 +1331,6 @@ namespace logicalaccess
         return std::make_shared<PCSCCardProbe>(this);
     }
 
-    std::tuple<PCSCReaderUnit::SPtrStringVector, PCSCReaderUnit::ReaderStateVector>
-    PCSCReaderUnit::prepare_poll_parameters()
-    {
-        size_t readers_count = 0;
-        if (!getName().empty())
-        {
-            // use dedicated reader
-            if (Settings::getInstance()->SeeWaitInsertionLog)
-            {
-                LOG(LogLevel::INFOS) << "Use specific reader: " << getName() << ".";
-            }
-            readers_count = 1;
-        }
-        else
-        {
-            readers_count = getReaderProvider()->getReaderList().size();
-        }
-
-        EXCEPTION_ASSERT_WITH_LOG(readers_count > 0, CardException,
-                                  EXCEPTION_MSG_NOREADER);
-
-        SPtrStringVector readers_names(readers_count);
-        ReaderStateVector readers(readers_count);
-        std::memset(&readers[0], 0, readers.size() * sizeof(SCARD_READERSTATE));
-
-        if (!getName().empty())
-        {
-            readers_names[0] = std::make_shared<std::string>(getName());
-            readers[0].dwCurrentState = SCARD_STATE_UNAWARE;
-            readers[0].dwEventState = SCARD_STATE_UNAWARE;
-            readers[0].szReader = readers_names[0]->c_str();
-        }
-        else
-        {
-            for (size_t i = 0; i < readers_count; ++i)
-            {
-                readers_names[i] = std::make_shared<std::string>(getReaderProvider()
-                                                                     ->getReaderList().at(i)->getName());
-                readers[i].dwCurrentState = SCARD_STATE_UNAWARE;
-                readers[i].dwEventState = SCARD_STATE_UNAWARE;
-                readers[i].szReader = readers_names[i]->c_str();
-            }
-        }
-        return std::make_tuple(readers_names, readers);
-    }
-
     void PCSCReaderUnit::waitInsertion_create_proxy(
         const std::string &reader_name)
     {
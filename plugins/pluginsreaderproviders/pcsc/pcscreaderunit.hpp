@@ -178,6 +178,12 @@ namespace logicalaccess
          */
         virtual std::string getReaderSerialNumber();
 
+        /**
+         * \brief Get the maximum APDU length the reader can exchange with the card (SCARD_ATTR_MAXINPUT).
+         * \return The maximum APDU length, or 0 if the reader does not report it.
+         */
+        virtual size_t getMaxAPDULength();
+
         /**
          * \brief Get the card ATR.
          * \param atr The array that will contains the ATR data.
@@ -312,6 +318,12 @@ namespace logicalaccess
          */
         void detect_mifareplus_security_level(std::shared_ptr<Chip> c);
 
+        /**
+         * Set the APDU data lengths of the default adapter and of the chip
+         * adapter, extended if both the card (ATR) and the reader support it.
+         */
+        void configure_extended_length(std::shared_ptr<Chip> c);
+
         /**
          * \brief The reader unit name.
          */
@@ -349,15 +361,12 @@ namespace logicalaccess
         virtual void setSAMReaderUnit(std::shared_ptr<ISO7816ReaderUnit> t);
 
       protected:
-        // Internal helper for waitInsertion
-        using SPtrStringVector = std::vector<std::shared_ptr<std::string>>;
-        using ReaderStateVector = std::vector<SCARD_READERSTATE>;
-
         /**
-         * Prepare the parameters for the call to SCardGetStatusChange
-         * invoked by waitInsertion()
+         * Create the proxy, guess the card type from the ATR and process
+         * the insertion detected during waitInsertion.
          */
-        std::tuple<SPtrStringVector, ReaderStateVector> prepare_poll_parameters();
+        bool waitInsertion_process_atr(const std::string &reader_name, const std::vector<uint8_t> &atr,
+                                       unsigned int maxwait, const ElapsedTimeCounter &time_counter);
 
         /**
          * Create the proxy reader based on which reader detected a card
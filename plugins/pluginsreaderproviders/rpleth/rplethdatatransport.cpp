@@ -22,23 +22,41 @@
 namespace logicalaccess
 {
     RplethDataTransport::RplethDataTransport()
-        : TcpDataTransport()
+        : TcpDataTransport(), d_buffer(8192)
     {
+        d_framing.setLengthField(3, 1, true, 5, 5);
+        d_framing.setTrailerChecker(&FramingBufferParser::checkXorTrailer);
     }
 
     RplethDataTransport::~RplethDataTransport()
     {
+        // The answer handlers use the buffer.
+        cancelOperations();
     }
 
     void RplethDataTransport::send(const std::vector<unsigned char>& data)
+    {
+        TcpDataTransport::send(buildFrame(data));
+        d_buffer.clear();
+        d_framing.reset();
+    }
+
+    void RplethDataTransport::asyncSend(const std::vector<unsigned char>& data, SendHandler handler)
+    {
+        d_buffer.clear();
+        d_framing.reset();
+        TcpDataTransport::asyncSend(buildFrame(data), handler);
+    }
+
+    std::vector<unsigned char> RplethDataTransport::buildFrame(const std::vector<unsigned char>& data)
     {
         std::vector<unsigned char> cmd;
         cmd.push_back(static_cast<unsigned char>(Device::HID));
         cmd.push_back(static_cast<unsigned char>(HidCommand::COM));
         cmd.push_back(static_cast<unsigned char>(data.size()));
         cmd.insert(cmd.end(), data.begin(), data.end());
-
-        sendll(cmd);
+        cmd.push_back(calcChecksum(cmd));
+        return cmd;
     }
 
     void RplethDataTransport::sendll(const std::vector<unsigned char>& data)
@@ -48,6 +66,7 @@ namespace logicalaccess
         cmd.push_back(calcChecksum(cmd));
         TcpDataTransport::send(cmd);
         d_buffer.clear();
+        d_framing.reset();
     }
 
     unsigned char RplethDataTransport::calcChecksum(const std::vector<unsigned char>& data)
@@ -76,62 +95,112 @@ namespace logicalaccess
 
     std::vector<unsigned char> RplethDataTransport::receive(long int timeout)
     {
-        std::vector<unsigned char> ret, buf;
+        std::vector<unsigned char> ret;
         if (timeout == -1)
             timeout = Settings::getInstance()->DataTransportTimeout;
 		std::chrono::steady_clock::time_point const clock_timeout = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
 
 		do
         {
-            buf.clear();
-            if (d_buffer.size() < 5 || (d_buffer.size() >= 4 && d_buffer.size() < (unsigned int)(4 + d_buffer[3] + 1)))
-                buf = TcpDataTransport::receive(timeout);
+            // Only read when no complete answer is buffered yet.
+            if (!extractAnswer(ret))
+            {
+                appendBuffer(TcpDataTransport::receive(timeout));
+                if (!extractAnswer(ret))
+                    continue;
+            }
+            break; //We have a correct answer
+		} while (std::chrono::steady_clock::now() < clock_timeout);
+        return ret;
+    }
+
+    void RplethDataTransport::asyncReceive(long int timeout, ReceiveHandler handler)
+    {
+        if (timeout == -1)
+            timeout = Settings::getInstance()->DataTransportTimeout;
 
-            if (d_buffer.size() < 8192)
+        asyncReceiveAnswer(std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout), handler);
+    }
+
+    void RplethDataTransport::asyncReceiveAnswer(std::chrono::steady_clock::time_point deadline, ReceiveHandler handler)
+    {
+        std::vector<unsigned char> ret;
+        try
+        {
+            if (extractAnswer(ret))
             {
-                d_buffer.insert(d_buffer.end(), buf.begin(), buf.end());
-                buf.clear();
+                handler(std::exception_ptr(), ret);
+                return;
             }
-			else
-			{
-				d_buffer.clear();
-				buf.clear();
-			}
+        }
+        catch (...)
+        {
+            handler(std::current_exception(), ret);
+            return;
+        }
+
+        long int remaining = static_cast<long int>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count());
+        if (remaining <= 0)
+        {
+            handler(std::exception_ptr(), ret);
+            return;
+        }
 
-            if (d_buffer.size() >= 4)
+        TcpDataTransport::asyncReceive(remaining, [this, deadline, handler](std::exception_ptr error, const std::vector<unsigned char>& buf)
+        {
+            if (error)
             {
-                unsigned int exceptedlen = 4 + d_buffer[3] + 1;
-                if (d_buffer.size() >= exceptedlen)
-                {
-                    buf.clear();
-                    buf.insert(buf.begin(), d_buffer.begin(), d_buffer.begin() + exceptedlen);
-                    d_buffer.erase(d_buffer.begin(), d_buffer.begin() + exceptedlen);
-
-                    EXCEPTION_ASSERT_WITH_LOG(buf[0] != 0x01, std::invalid_argument, "The supplied answer buffer get the state : Command failure");
-                    EXCEPTION_ASSERT_WITH_LOG(buf[0] != 0x02, std::invalid_argument, "The supplied answer buffer get the state : Bad checksum in command");
-                    EXCEPTION_ASSERT_WITH_LOG(buf[0] != 0x03, LibLogicalAccessException, "The supplied answer buffer get the state : Timeout");
-                    EXCEPTION_ASSERT_WITH_LOG(buf[0] != 0x04, std::invalid_argument, "The supplied answer buffer get the state : Bad size of command");
-                    EXCEPTION_ASSERT_WITH_LOG(buf[0] != 0x05, std::invalid_argument, "The supplied answer buffer get the state : Bad device in command");
-                    EXCEPTION_ASSERT_WITH_LOG(buf[0] == 0x00, std::invalid_argument, "The supplied answer buffer is corrupted");
-
-                    std::vector<unsigned char> bufnoc = std::vector<unsigned char>(buf.begin(), buf.end() - 1);
-                    unsigned char checksum_receive = buf[buf.size() - 1];
-                    EXCEPTION_ASSERT_WITH_LOG(calcChecksum(bufnoc) == checksum_receive, std::invalid_argument, "The supplied answer buffer get the state : Bad checksum in answer");
-
-                    ret.insert(ret.begin(), bufnoc.begin() + 4, bufnoc.end());
-
-                    if (ret.size() != 0 && buf[1] == Device::HID && buf[2] == HidCommand::BADGE)
-                    {
-                        //save the badge
-                        if (d_badges.size() <= 10)
-                            d_badges.push_back(ret);
-                    }
-
-                    break; //We have a correct answer
-                }
+                handler(error, std::vector<unsigned char>());
+                return;
             }
-		} while (ret.size() == 0 && std::chrono::steady_clock::now() < clock_timeout);
-        return ret;
+            appendBuffer(buf);
+            asyncReceiveAnswer(deadline, handler);
+        });
+    }
+
+    void RplethDataTransport::appendBuffer(const std::vector<unsigned char>& data)
+    {
+        if (d_buffer.reserve() < data.size())
+        {
+            LOG(LogLevel::WARNINGS) << "Answer buffer full, dropping " << d_buffer.size() << " bytes.";
+            d_buffer.clear();
+            d_framing.reset();
+        }
+        d_buffer.insert(d_buffer.end(), data.begin(), data.end());
+    }
+
+    bool RplethDataTransport::extractAnswer(std::vector<unsigned char>& answer)
+    {
+        FrameSpan frame;
+        FramingBufferParser::FrameStatus status = d_framing.parse(d_buffer, frame);
+        if (status == FramingBufferParser::FS_INCOMPLETE)
+        {
+            return false;
+        }
+
+        unsigned char state = frame[0], device = frame[1], command = frame[2];
+        answer.resize(frame.size() - 5);
+        if (!answer.empty())
+        {
+            frame.copy(4, answer.size(), &answer[0]);
+        }
+        d_framing.consume(d_buffer, frame);
+
+        EXCEPTION_ASSERT_WITH_LOG(state != 0x01, std::invalid_argument, "The supplied answer buffer get the state : Command failure");
+        EXCEPTION_ASSERT_WITH_LOG(state != 0x02, std::invalid_argument, "The supplied answer buffer get the state : Bad checksum in command");
+        EXCEPTION_ASSERT_WITH_LOG(state != 0x03, LibLogicalAccessException, "The supplied answer buffer get the state : Timeout");
+        EXCEPTION_ASSERT_WITH_LOG(state != 0x04, std::invalid_argument, "The supplied answer buffer get the state : Bad size of command");
+        EXCEPTION_ASSERT_WITH_LOG(state != 0x05, std::invalid_argument, "The supplied answer buffer get the state : Bad device in command");
+        EXCEPTION_ASSERT_WITH_LOG(state == 0x00, std::invalid_argument, "The supplied answer buffer is corrupted");
+        EXCEPTION_ASSERT_WITH_LOG(status == FramingBufferParser::FS_VALID, std::invalid_argument, "The supplied answer buffer get the state : Bad checksum in answer");
+
+        if (answer.size() != 0 && device == Device::HID && command == HidCommand::BADGE)
+        {
+            //save the badge
+            if (d_badges.size() <= 10)
+                d_badges.push_back(answer);
+        }
+        return true;
     }
 
     std::string RplethDataTransport::getDefaultXmlNodeName() const
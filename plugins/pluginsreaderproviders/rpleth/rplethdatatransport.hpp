@@ -8,7 +8,9 @@
 #define LOGICALACCESS_RPLETHDATATRANSPORT_HPP
 
 #include "logicalaccess/readerproviders/tcpdatatransport.hpp"
+#include "logicalaccess/readerproviders/framingbufferparser.hpp"
 #include <boost/asio.hpp>
+#include <chrono>
 #include <list>
 
 namespace logicalaccess
@@ -73,7 +75,7 @@ namespace logicalaccess
          * \brief Get the buffer.
          * \return The buffer.
          */
-        const std::vector<unsigned char>& getBuffer() const { return d_buffer; };
+        const boost::circular_buffer<unsigned char>& getBuffer() const { return d_buffer; };
 
         /**
          * \brief Get the badges list.
@@ -99,10 +101,56 @@ namespace logicalaccess
          */
         static unsigned char calcChecksum(const std::vector<unsigned char>& data);
 
+        /**
+         * \brief Build the HID command frame, with its checksum.
+         * \param data The command data.
+         * \return The frame.
+         */
+        static std::vector<unsigned char> buildFrame(const std::vector<unsigned char>& data);
+
+        /**
+         * \brief Send a command asynchronously, in its HID command frame.
+         * \param data The command data.
+         * \param handler Called on the strand once the frame is sent, or on failure.
+         */
+        virtual void asyncSend(const std::vector<unsigned char>& data, SendHandler handler);
+
+        /**
+         * \brief Receive an answer asynchronously, reading until a complete answer is buffered.
+         * \param timeout Time waiting for the answer.
+         * \param handler Called on the strand with the answer or the error.
+         */
+        virtual void asyncReceive(long int timeout, ReceiveHandler handler);
+
+        /**
+         * \brief Complete an asynchronous answer reception.
+         * \param deadline The answer deadline.
+         * \param handler The handler of the reception.
+         */
+        void asyncReceiveAnswer(std::chrono::steady_clock::time_point deadline, ReceiveHandler handler);
+
+        /**
+         * \brief Append received data to the buffer.
+         * \param data The data received.
+         */
+        void appendBuffer(const std::vector<unsigned char>& data);
+
+        /**
+         * \brief Extract the next answer from the buffer.
+         * \param answer The answer data.
+         * \return True if a complete answer was buffered, false otherwise.
+         */
+        bool extractAnswer(std::vector<unsigned char>& answer);
+
         /**
          * \brief d_buffer from last commands response.
          */
-        std::vector<unsigned char> d_buffer;
+        boost::circular_buffer<unsigned char> d_buffer;
+
+        /**
+         * \brief The answers framing: status, device, command, data length, data and XOR checksum.
+         */
+        FramingBufferParser d_framing;
 
         /**
          * \brief Badges received from the latest commands response.
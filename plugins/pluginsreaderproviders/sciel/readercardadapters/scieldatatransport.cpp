@@ -14,9 +14,10 @@ namespace logicalaccess
     {
         std::vector<unsigned char> ret;
 
+        // The frames are extracted by the serial port when received.
         d_port->getSerialPort()->lockedExecute([&](){
-            if (d_port->getSerialPort()->getCircularBufferParser())
-                ret = d_port->getSerialPort()->getCircularBufferParser()->getValidBuffer(d_port->getSerialPort()->getCircularReadBuffer());
+            if (d_port->getSerialPort()->getCircularBufferParser() && d_port->getSerialPort()->isOpen())
+                d_port->getSerialPort()->read(ret);
         });
         LOG(LogLevel::COMS) << "checkValideBufferAvailable: " << BufferHelper::getHex(ret);
         return ret;
@@ -7,21 +7,19 @@
 #ifndef STIDSTRBUFFERPARSER_HPP
 #define STIDSTRBUFFERPARSER_HPP
 
-#include "logicalaccess/readerproviders/circularbufferparser.hpp"
+#include "logicalaccess/readerproviders/framingbufferparser.hpp"
 
 #include <string>
 #include <vector>
 
 namespace logicalaccess
 {
-    class LIBLOGICALACCESS_API STidSTRBufferParser : public CircularBufferParser
+    class LIBLOGICALACCESS_API STidSTRBufferParser : public FramingBufferParser
     {
     public:
-        STidSTRBufferParser() {};
+        STidSTRBufferParser();
 
         virtual ~STidSTRBufferParser() {};
-
-        virtual std::vector<unsigned char> getValidBuffer(boost::circular_buffer<unsigned char>& circular_buffer);
     };
 }
 
@@ -0,0 +1,262 @@
+/**
+ * \file asynclogwriter.cpp
+ * \brief Asynchronous log writer.
+ */
+
+#include "logicalaccess/asynclogwriter.hpp"
+#include <chrono>
+#include <iostream>
+
+namespace logicalaccess
+{
+    AsyncLogWriter &AsyncLogWriter::getInstance()
+    {
+        static AsyncLogWriter instance;
+        return instance;
+    }
+
+    AsyncLogWriter::AsyncLogWriter()
+        : d_mask(0)
+        , d_enqueuePos(0)
+        , d_dequeuePos(0)
+        , d_out(nullptr)
+        , d_policy(OP_DROP)
+        , d_flushInterval(1000)
+        , d_duplicateToStderr(false)
+        , d_running(false)
+        , d_closed(true)
+        , d_producers(0)
+        , d_wakeup(false)
+        , d_dropped(0)
+    {
+    }
+
+    AsyncLogWriter::~AsyncLogWriter()
+    {
+        stop();
+    }
+
+    void AsyncLogWriter::start(std::ostream &out, size_t capacity, OverflowPolicy policy,
+                               unsigned int flushInterval, bool duplicateToStderr)
+    {
+        if (d_running)
+            return;
+
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+
+        d_slots.reset(new Slot[size]);
+        for (size_t i = 0; i < size; ++i)
+        {
+            d_slots[i].sequence.store(i, std::memory_order_relaxed);
+            d_slots[i].flush = false;
+        }
+        d_mask = size - 1;
+        d_enqueuePos.store(0, std::memory_order_relaxed);
+        d_dequeuePos = 0;
+
+        d_out               = &out;
+        d_policy            = policy;
+        d_flushInterval     = flushInterval > 0 ? flushInterval : 1;
+        d_duplicateToStderr = duplicateToStderr;
+        d_wakeup            = false;
+
+        d_closed  = false;
+        d_running = true;
+        d_thread  = std::thread(&AsyncLogWriter::run, this);
+    }
+
+    void AsyncLogWriter::stop()
+    {
+        if (!d_running.exchange(false))
+            return;
+
+        // Release the blocked producers, then let the pushes in progress complete.
+        {
+            std::lock_guard<std::mutex> lock(d_mutex);
+        }
+        d_spaceCond.notify_all();
+        while (d_producers > 0)
+            std::this_thread::yield();
+
+        // No line can be queued anymore, the final drain gets them all.
+        {
+            std::lock_guard<std::mutex> lock(d_mutex);
+            d_closed = true;
+            d_wakeup = true;
+        }
+        d_cond.notify_one();
+        if (d_thread.joinable())
+            d_thread.join();
+    }
+
+    bool AsyncLogWriter::isRunning() const
+    {
+        return d_running;
+    }
+
+    uint64_t AsyncLogWriter::getDroppedCount() const
+    {
+        return d_dropped;
+    }
+
+    bool AsyncLogWriter::push(std::string &&line, bool flush)
+    {
+        // stop() waits for the producers counted here before the final drain.
+        ++d_producers;
+        if (!d_running)
+        {
+            --d_producers;
+            ++d_dropped;
+            return false;
+        }
+
+        while (!tryPush(line, flush))
+        {
+            if (d_policy == OP_DROP || !d_running)
+            {
+                --d_producers;
+                ++d_dropped;
+                return false;
+            }
+
+            // Wake the writer each time before sleeping, the slots freed by its last drain may be taken already.
+            std::unique_lock<std::mutex> lock(d_mutex);
+            if (d_running && !hasFreeSlot())
+            {
+                d_wakeup = true;
+                d_cond.notify_one();
+                d_spaceCond.wait(lock);
+            }
+        }
+        --d_producers;
+
+        if (flush)
+        {
+            d_wakeup = true;
+            d_cond.notify_one();
+        }
+        return true;
+    }
+
+    bool AsyncLogWriter::hasFreeSlot() const
+    {
+        size_t pos = d_enqueuePos.load(std::memory_order_relaxed);
+        size_t seq = d_slots[pos & d_mask].sequence.load(std::memory_order_acquire);
+        return static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos) >= 0;
+    }
+
+    bool AsyncLogWriter::tryPush(std::string &line, bool flush)
+    {
+        size_t pos = d_enqueuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Slot &slot = d_slots[pos & d_mask];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (d_enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                                       std::memory_order_relaxed))
+                {
+                    slot.line.swap(line);
+                    slot.flush = flush;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                // Ring is full.
+                return false;
+            }
+            else
+            {
+                pos = d_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool AsyncLogWriter::drain(std::string &batch, size_t &count)
+    {
+        bool flush = false;
+        count      = 0;
+        for (;;)
+        {
+            Slot &slot = d_slots[d_dequeuePos & d_mask];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            if (seq != d_dequeuePos + 1)
+                break;
+
+            batch += slot.line;
+            slot.line.clear();
+            flush = flush || slot.flush;
+            slot.sequence.store(d_dequeuePos + d_mask + 1, std::memory_order_release);
+            ++d_dequeuePos;
+            ++count;
+        }
+        return flush;
+    }
+
+    void AsyncLogWriter::run()
+    {
+        std::string batch;
+        auto lastFlush = std::chrono::steady_clock::now();
+        bool dirty     = false;
+
+        for (;;)
+        {
+            bool running = !d_closed;
+            size_t count = 0;
+            batch.clear();
+            bool flush = drain(batch, count);
+
+            if (count > 0 && d_policy == OP_BLOCK)
+            {
+                // Slots were freed, wake the producers waiting for one.
+                {
+                    std::lock_guard<std::mutex> lock(d_mutex);
+                }
+                d_spaceCond.notify_all();
+            }
+
+            if (count > 0)
+            {
+                *d_out << batch;
+                if (d_duplicateToStderr)
+                    std::cerr << batch;
+                dirty = true;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (dirty && (flush || !running ||
+                          now - lastFlush >= std::chrono::milliseconds(d_flushInterval)))
+            {
+                d_out->flush();
+                dirty     = false;
+                lastFlush = now;
+            }
+
+            if (!running)
+            {
+                // Closed once no producer can push anymore, this drain was the last one.
+                d_out->flush();
+                break;
+            }
+
+            if (count == 0 && d_enqueuePos.load() != d_dequeuePos)
+            {
+                // A producer claimed the next slot but did not publish its line yet.
+                std::this_thread::yield();
+            }
+            else if (count == 0)
+            {
+                std::unique_lock<std::mutex> lock(d_mutex);
+                d_cond.wait_for(lock, std::chrono::milliseconds(d_flushInterval),
+                                [this]() { return d_wakeup.load(); });
+                d_wakeup = false;
+            }
+        }
+    }
+}
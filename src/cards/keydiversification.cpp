@@ -8,6 +8,7 @@
 #include "logicalaccess/myexception.hpp"
 #include "logicalaccess/cards/keydiversification.hpp"
 #include "logicalaccess/dynlibrary/librarymanager.hpp"
+#include "logicalaccess/utils.hpp"
 
 namespace logicalaccess
 {
@@ -21,4 +22,22 @@ namespace logicalaccess
         }
         return ret;
     }
-}
\ No newline at end of file
+
+    std::vector<std::vector<unsigned char> > KeyDiversification::diversifyBatch(std::shared_ptr<Key> key, const std::vector<std::vector<unsigned char> >& diversifyInputs)
+    {
+        // Diversification plugins are not required to be thread safe, the generic batch is sequential.
+        std::vector<std::vector<unsigned char> > keys;
+        keys.reserve(diversifyInputs.size());
+        for (std::vector<std::vector<unsigned char> >::const_iterator it = diversifyInputs.begin(); it != diversifyInputs.end(); ++it)
+        {
+            keys.push_back(getDiversifiedKey(key, *it));
+        }
+        return keys;
+    }
+
+    void KeyDiversification::parallelForBatch(size_t count, const std::function<void(size_t, size_t)>& process)
+    {
+        // Below this size per thread, the thread start costs more than the diversification.
+        parallelFor(count, 0, 64, process);
+    }
+}
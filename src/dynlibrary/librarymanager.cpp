@@ -1,6 +1,15 @@
 #include "logicalaccess/dynlibrary/librarymanager.hpp"
 #include <boost/filesystem.hpp>
+#include <boost/foreach.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/xml_parser.hpp>
 #include <logicalaccess/logs.hpp>
+#include <logicalaccess/myexception.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
 
 // TODO: Data transport should also be through plug-in
 #include "logicalaccess/readerproviders/serialportdatatransport.hpp"
@@ -29,19 +38,34 @@ namespace logicalaccess
         return &instance;
 	}
 
-    void* LibraryManager::getFctFromName(const std::string &fctname, LibraryType libraryType)
+    LibraryManager::~LibraryManager()
     {
-        std::lock_guard<std::recursive_mutex> lg(mutex_);
-        void *fct;
-        boost::filesystem::directory_iterator end_iter;
-        std::string extension = EXTENSION_LIB;
+        // The warm-up threads were stopped by the exit handler registered in warmUp().
+    }
 
-        if (libLoaded.empty())
+    std::shared_ptr<const LibraryManager::SymbolIndex> LibraryManager::getIndex()
+    {
+        std::shared_ptr<const SymbolIndex> index = std::atomic_load(&index_);
+        if (!index)
         {
-            scanPlugins();
+            std::lock_guard<std::recursive_mutex> lg(mutex_);
+            index = std::atomic_load(&index_);
+            if (!index)
+            {
+                scanPlugins();
+                index = std::atomic_load(&index_);
+            }
         }
 
-        for (std::map<std::string, IDynLibrary*>::iterator it = libLoaded.begin(); it != libLoaded.end(); ++it)
+        return index;
+    }
+
+    void* LibraryManager::findSymbol(const std::string &fctname, LibraryType libraryType) const
+    {
+        void *fct;
+        std::string extension = EXTENSION_LIB;
+
+        for (std::map<std::string, IDynLibrary*>::const_iterator it = libLoaded.begin(); it != libLoaded.end(); ++it)
         {
             try
             {
@@ -55,9 +79,441 @@ namespace logicalaccess
         return NULL;
     }
 
-    std::shared_ptr<ReaderProvider> LibraryManager::getReaderProvider(const std::string& readertype)
+    void LibraryManager::buildIndex()
+    {
+        std::lock_guard<std::recursive_mutex> lg(mutex_);
+        std::shared_ptr<SymbolIndex> index(new SymbolIndex());
+        if (lazy_)
+        {
+            // Nothing is loaded yet, symbols and hooks are resolved on first use.
+            std::atomic_store(&index_, std::shared_ptr<const SymbolIndex>(index));
+            return;
+        }
+
+        static const char* hooks[] = { "getReaderUnit", "getCardService", "getReaderService" };
+
+        for (std::map<std::string, IDynLibrary*>::iterator it = libLoaded.begin(); it != libLoaded.end(); ++it)
+        {
+            if ((*it).second == NULL)
+                continue;
+
+            try
+            {
+                for (size_t i = 0; i < sizeof(hooks) / sizeof(hooks[0]); ++i)
+                {
+                    if ((*it).second->hasSymbol(hooks[i]))
+                        index->hooks[hooks[i]].push_back((*it).second->getSymbol(hooks[i]));
+                }
+            }
+            catch (...) {}
+        }
+
+        // Index the chips and readers advertised by the plugins up front, the
+        // other factories are added on their first lookup.
+        std::vector<std::string> chips, readers;
+        for (std::map<std::string, IDynLibrary*>::iterator it = libLoaded.begin(); it != libLoaded.end(); ++it)
+        {
+            try
+            {
+                void* fct;
+                if ((*it).second != NULL && (fct = (*it).second->getSymbol("getChipInfoAt")) != NULL)
+                {
+                    getobjectinfoat objectinfoptr;
+                    *(void**)(&objectinfoptr) = fct;
+                    getAvailablePlugins(chips, objectinfoptr);
+                }
+                if ((*it).second != NULL && (fct = (*it).second->getSymbol("getReaderInfoAt")) != NULL)
+                {
+                    getobjectinfoat objectinfoptr;
+                    *(void**)(&objectinfoptr) = fct;
+                    getAvailablePlugins(readers, objectinfoptr);
+                }
+            }
+            catch (...) {}
+        }
+        for (std::vector<std::string>::const_iterator it = chips.cbegin(); it != chips.cend(); ++it)
+        {
+            std::string fctname = "get" + *it + "Chip";
+            index->symbols[LibraryManager::CARDS_TYPE].insert(std::make_pair(fctname, findSymbol(fctname, LibraryManager::CARDS_TYPE)));
+        }
+        for (std::vector<std::string>::const_iterator it = readers.cbegin(); it != readers.cend(); ++it)
+        {
+            std::string fctname = "get" + *it + "Reader";
+            index->symbols[LibraryManager::READERS_TYPE].insert(std::make_pair(fctname, findSymbol(fctname, LibraryManager::READERS_TYPE)));
+        }
+
+        std::atomic_store(&index_, std::shared_ptr<const SymbolIndex>(index));
+    }
+
+    void* LibraryManager::getFctFromName(const std::string &fctname, LibraryType libraryType)
+    {
+        std::shared_ptr<const SymbolIndex> index = getIndex();
+        std::unordered_map<std::string, void*>::const_iterator it = index->symbols[libraryType].find(fctname);
+        if (it != index->symbols[libraryType].end())
+        {
+            return it->second;
+        }
+
+        // Libraries are loaded without the lock, so a plug-in initializer may use the manager.
+        void* fct = resolveSymbol(fctname, libraryType);
+
+        std::lock_guard<std::recursive_mutex> lg(mutex_);
+        // Another thread may have resolved it meanwhile.
+        index = std::atomic_load(&index_);
+        it = index->symbols[libraryType].find(fctname);
+        if (it != index->symbols[libraryType].end())
+        {
+            return it->second;
+        }
+
+        std::shared_ptr<SymbolIndex> newIndex(new SymbolIndex(*index));
+        newIndex->symbols[libraryType][fctname] = fct;
+        std::atomic_store(&index_, std::shared_ptr<const SymbolIndex>(newIndex));
+
+        return fct;
+    }
+
+    void* LibraryManager::resolveSymbol(const std::string &fctname, LibraryType libraryType)
+    {
+        std::string ending = enumType[libraryType] + EXTENSION_LIB;
+        std::vector<std::string> libraries;
+        {
+            std::lock_guard<std::recursive_mutex> lg(mutex_);
+            for (std::map<std::string, PluginInfo>::const_iterator it = plugins_.begin(); lazy_ && it != plugins_.end(); ++it)
+            {
+                if (it->second.loadable && hasEnding(it->first, ending) && it->second.symbols.count(fctname) > 0)
+                    libraries.push_back(it->first);
+            }
+        }
+
+        for (std::vector<std::string>::const_iterator it = libraries.cbegin(); it != libraries.cend(); ++it)
+        {
+            try
+            {
+                void* fct = loadLibrary(*it)->getSymbol(fctname.c_str());
+                if (fct != NULL)
+                    return fct;
+            }
+            catch (const std::exception &e)
+            {
+                LOG(LogLevel::ERRORS) << "Cannot resolve " << fctname << " from " << *it << ": " << e.what();
+            }
+        }
+
+        libraries.clear();
+        {
+            std::lock_guard<std::recursive_mutex> lg(mutex_);
+            if (missing_[libraryType].count(fctname) > 0)
+            {
+                return NULL;
+            }
+
+            for (std::map<std::string, PluginInfo>::const_iterator it = plugins_.begin(); lazy_ && it != plugins_.end(); ++it)
+            {
+                if (it->second.loadable && hasEnding(it->first, ending))
+                    libraries.push_back(it->first);
+            }
+        }
+
+        // Not indexed yet: look into every library of this type and remember the answer.
+        if (!libraries.empty())
+        {
+            LOG(LogLevel::PLUGINS) << "Symbol " << fctname << " is not indexed, loading all " << enumType[libraryType] << " libraries.";
+        }
+        for (std::vector<std::string>::const_iterator it = libraries.cbegin(); it != libraries.cend(); ++it)
+        {
+            try
+            {
+                loadLibrary(*it);
+            }
+            catch (const std::exception &e)
+            {
+                LOG(LogLevel::ERRORS) << "Something bad happened when loading " << *it << ": " << e.what();
+            }
+        }
+
+        std::lock_guard<std::recursive_mutex> lg(mutex_);
+        bool changed = false;
+        void* fct = findSymbol(fctname, libraryType);
+        if (fct != NULL)
+        {
+            for (std::map<std::string, IDynLibrary*>::iterator it = libLoaded.begin(); it != libLoaded.end(); ++it)
+            {
+                try
+                {
+                    if ((*it).second != NULL && hasEnding((*it).first, ending) && (*it).second->getSymbol(fctname.c_str()) == fct)
+                    {
+                        std::map<std::string, PluginInfo>::iterator plugin = plugins_.find((*it).first);
+                        if (plugin != plugins_.end())
+                            changed = plugin->second.symbols.insert(fctname).second;
+                        break;
+                    }
+                }
+                catch (...) {}
+            }
+        }
+        else
+        {
+            changed = missing_[libraryType].insert(fctname).second;
+        }
+        if (changed)
+        {
+            savePluginIndex();
+        }
+
+        return fct;
+    }
+
+    std::vector<void*> LibraryManager::getHook(const std::string &name)
+    {
+        std::shared_ptr<const SymbolIndex> index = getIndex();
+        std::unordered_map<std::string, std::vector<void*> >::const_iterator it = index->hooks.find(name);
+        if (it != index->hooks.end())
+        {
+            return it->second;
+        }
+
+        std::vector<std::string> libraries;
+        {
+            std::lock_guard<std::recursive_mutex> lg(mutex_);
+            for (std::map<std::string, PluginInfo>::const_iterator plugin = plugins_.begin(); lazy_ && plugin != plugins_.end(); ++plugin)
+            {
+                if (plugin->second.loadable && plugin->second.hooks.count(name) > 0)
+                    libraries.push_back(plugin->first);
+            }
+        }
+        for (std::vector<std::string>::const_iterator lib = libraries.cbegin(); lib != libraries.cend(); ++lib)
+        {
+            try
+            {
+                loadLibrary(*lib);
+            }
+            catch (const std::exception &e)
+            {
+                LOG(LogLevel::ERRORS) << "Something bad happened when loading " << *lib << ": " << e.what();
+            }
+        }
+
+        std::lock_guard<std::recursive_mutex> lg(mutex_);
+        index = std::atomic_load(&index_);
+        it = index->hooks.find(name);
+        if (it != index->hooks.end())
+        {
+            return it->second;
+        }
+
+        std::vector<void*> fcts;
+        for (std::map<std::string, IDynLibrary*>::iterator lib = libLoaded.begin(); lib != libLoaded.end(); ++lib)
+        {
+            try
+            {
+                if ((*lib).second != NULL && (*lib).second->hasSymbol(name.c_str()))
+                    fcts.push_back((*lib).second->getSymbol(name.c_str()));
+            }
+            catch (...) {}
+        }
+
+        std::shared_ptr<SymbolIndex> newIndex(new SymbolIndex(*index));
+        newIndex->hooks[name] = fcts;
+        std::atomic_store(&index_, std::shared_ptr<const SymbolIndex>(newIndex));
+
+        return fcts;
+    }
+
+    IDynLibrary* LibraryManager::loadLibrary(const std::string &filename)
     {
+        std::string path;
+        {
+            std::lock_guard<std::recursive_mutex> lg(mutex_);
+            std::map<std::string, IDynLibrary*>::iterator it = libLoaded.find(filename);
+            if (it != libLoaded.end() && (*it).second != NULL)
+            {
+                return (*it).second;
+            }
+
+            std::map<std::string, PluginInfo>::const_iterator plugin = plugins_.find(filename);
+            EXCEPTION_ASSERT_WITH_LOG(plugin != plugins_.end(), LibLogicalAccessException, "Unknown plug-in library " + filename + ".");
+            path = plugin->second.path;
+        }
+
+        LOG(LogLevel::PLUGINS) << "Loading library " << path << "...";
+        IDynLibrary* lib = newDynLibrary(path);
+
         std::lock_guard<std::recursive_mutex> lg(mutex_);
+        std::map<std::string, IDynLibrary*>::iterator it = libLoaded.find(filename);
+        if (it != libLoaded.end() && (*it).second != NULL)
+        {
+            // Loaded by another thread meanwhile.
+            delete lib;
+            return (*it).second;
+        }
+        libLoaded[filename] = lib;
+        return lib;
+    }
+
+    void LibraryManager::indexLibrary(IDynLibrary* lib, PluginInfo& info) const
+    {
+        static const char* hooks[] = { "getReaderUnit", "getCardService", "getReaderService" };
+        void* fct;
+
+        info.chips.clear();
+        info.readers.clear();
+        info.symbols.clear();
+        info.hooks.clear();
+        try
+        {
+            if ((fct = lib->getSymbol("getChipInfoAt")) != NULL)
+            {
+                getobjectinfoat objectinfoptr;
+                *(void**)(&objectinfoptr) = fct;
+                getAvailablePlugins(info.chips, objectinfoptr);
+            }
+            if ((fct = lib->getSymbol("getReaderInfoAt")) != NULL)
+            {
+                getobjectinfoat objectinfoptr;
+                *(void**)(&objectinfoptr) = fct;
+                getAvailablePlugins(info.readers, objectinfoptr);
+            }
+        }
+        catch (...) {}
+
+        for (std::vector<std::string>::const_iterator it = info.chips.cbegin(); it != info.chips.cend(); ++it)
+        {
+            if (lib->hasSymbol(("get" + *it + "Chip").c_str()))
+                info.symbols.insert("get" + *it + "Chip");
+        }
+        for (std::vector<std::string>::const_iterator it = info.readers.cbegin(); it != info.readers.cend(); ++it)
+        {
+            if (lib->hasSymbol(("get" + *it + "Reader").c_str()))
+                info.symbols.insert("get" + *it + "Reader");
+        }
+        for (size_t i = 0; i < sizeof(hooks) / sizeof(hooks[0]); ++i)
+        {
+            if (lib->hasSymbol(hooks[i]))
+                info.hooks.insert(hooks[i]);
+        }
+    }
+
+    bool LibraryManager::loadPluginIndex(const std::string &indexFile, std::map<std::string, PluginInfo>& plugins, std::set<std::string>* missing) const
+    {
+        using boost::property_tree::ptree;
+        ptree pt;
+
+        try
+        {
+            if (!boost::filesystem::exists(indexFile))
+                return false;
+
+            read_xml(indexFile, pt);
+            if (pt.get<int>("pluginindex.version", 0) != 1)
+                return false;
+
+            BOOST_FOREACH(ptree::value_type const& v, pt.get_child("pluginindex"))
+            {
+                if (v.first == "library")
+                {
+                    PluginInfo info;
+                    info.path = v.second.get<std::string>("path");
+                    info.size = v.second.get<uintmax_t>("size");
+                    info.mtime = v.second.get<long long>("mtime");
+                    info.loadable = v.second.get<bool>("loadable");
+                    BOOST_FOREACH(ptree::value_type const& e, v.second)
+                    {
+                        if (e.first == "chip")
+                            info.chips.push_back(e.second.get_value<std::string>());
+                        else if (e.first == "reader")
+                            info.readers.push_back(e.second.get_value<std::string>());
+                        else if (e.first == "symbol")
+                            info.symbols.insert(e.second.get_value<std::string>());
+                        else if (e.first == "hook")
+                            info.hooks.insert(e.second.get_value<std::string>());
+                    }
+                    plugins[v.second.get<std::string>("name")] = info;
+                }
+                else if (v.first == "missing")
+                {
+                    for (int type = READERS_TYPE; type <= UNIFIED_TYPE; ++type)
+                    {
+                        if (v.second.get<std::string>("<xmlattr>.type", "") == enumType[type])
+                            missing[type].insert(v.second.get_value<std::string>());
+                    }
+                }
+            }
+        }
+        catch (const std::exception &e)
+        {
+            LOG(LogLevel::WARNINGS) << "Cannot read plug-ins index " << indexFile << ": " << e.what();
+            return false;
+        }
+
+        return true;
+    }
+
+    void LibraryManager::savePluginIndex() const
+    {
+        using boost::property_tree::ptree;
+        std::string indexFile = Settings::getInstance()->PluginIndexFile;
+        if (indexFile.empty())
+            return;
+
+        ptree pt;
+        pt.put("pluginindex.version", 1);
+        for (std::map<std::string, PluginInfo>::const_iterator it = plugins_.begin(); it != plugins_.end(); ++it)
+        {
+            ptree& lib = pt.add("pluginindex.library", "");
+            lib.put("name", it->first);
+            lib.put("path", it->second.path);
+            lib.put("size", it->second.size);
+            lib.put("mtime", it->second.mtime);
+            lib.put("loadable", it->second.loadable);
+            for (std::vector<std::string>::const_iterator e = it->second.chips.cbegin(); e != it->second.chips.cend(); ++e)
+                lib.add("chip", *e);
+            for (std::vector<std::string>::const_iterator e = it->second.readers.cbegin(); e != it->second.readers.cend(); ++e)
+                lib.add("reader", *e);
+            for (std::set<std::string>::const_iterator e = it->second.symbols.cbegin(); e != it->second.symbols.cend(); ++e)
+                lib.add("symbol", *e);
+            for (std::set<std::string>::const_iterator e = it->second.hooks.cbegin(); e != it->second.hooks.cend(); ++e)
+                lib.add("hook", *e);
+        }
+        for (int type = READERS_TYPE; type <= UNIFIED_TYPE; ++type)
+        {
+            for (std::set<std::string>::const_iterator e = missing_[type].cbegin(); e != missing_[type].cend(); ++e)
+            {
+                ptree& missing = pt.add("pluginindex.missing", *e);
+                missing.put("<xmlattr>.type", enumType[type]);
+            }
+        }
+
+        try
+        {
+            std::ostringstream content;
+            write_xml(content, pt);
+            std::ifstream current(indexFile.c_str(), std::ios::binary);
+            std::ostringstream currentContent;
+            currentContent << current.rdbuf();
+            if (current.is_open() && currentContent.str() == content.str())
+            {
+                return;
+            }
+            current.close();
+
+            // Write then rename, so a concurrent process never reads a partial index.
+            std::string tmpFile = indexFile + ".tmp";
+            {
+                std::ofstream tmp(tmpFile.c_str(), std::ios::binary | std::ios::trunc);
+                tmp << content.str();
+                EXCEPTION_ASSERT_WITH_LOG(tmp.good(), LibLogicalAccessException, "Cannot write " + tmpFile + ".");
+            }
+            boost::filesystem::rename(tmpFile, indexFile);
+        }
+        catch (const std::exception &e)
+        {
+            LOG(LogLevel::WARNINGS) << "Cannot write plug-ins index " << indexFile << ": " << e.what();
+        }
+    }
+
+    std::shared_ptr<ReaderProvider> LibraryManager::getReaderProvider(const std::string& readertype)
+    {
         std::shared_ptr<ReaderProvider> ret;
         std::string fctname = "get" + readertype + "Reader";
 
@@ -72,15 +528,18 @@ namespace logicalaccess
         return ret;
     }
 
+    getcard LibraryManager::getCardFactory(const std::string& cardtype)
+    {
+        getcard getcardfct;
+        *(void**)(&getcardfct) = getFctFromName("get" + cardtype + "Chip", LibraryManager::CARDS_TYPE);
+        return getcardfct;
+    }
+
     std::shared_ptr<Chip> LibraryManager::getCard(const std::string& cardtype)
     {
-        std::lock_guard<std::recursive_mutex> lg(mutex_);
         std::shared_ptr<Chip> ret;
-        std::string fctname = "get" + cardtype + "Chip";
-
-        getcard getcardfct;
-        *(void**)(&getcardfct) = getFctFromName(fctname, LibraryManager::CARDS_TYPE);
 
+        getcard getcardfct = getCardFactory(cardtype);
         if (getcardfct)
         {
             getcardfct(&ret);
@@ -91,7 +550,6 @@ namespace logicalaccess
 
     std::shared_ptr<KeyDiversification> LibraryManager::getKeyDiversification(const std::string& keydivtype)
     {
-        std::lock_guard<std::recursive_mutex> lg(mutex_);
         std::shared_ptr<KeyDiversification> ret;
         std::string fctname = "get" + keydivtype + "Diversification";
 
@@ -106,14 +564,18 @@ namespace logicalaccess
         return ret;
     }
 
+    getcommands LibraryManager::getCommandsFactory(const std::string& extendedtype)
+    {
+        getcommands getcommandsfct;
+        *(void**)(&getcommandsfct) = getFctFromName("get" + extendedtype + "Commands", LibraryManager::READERS_TYPE);
+        return getcommandsfct;
+    }
+
     std::shared_ptr<Commands> LibraryManager::getCommands(const std::string& extendedtype)
     {
-        std::lock_guard<std::recursive_mutex> lg(mutex_);
         std::shared_ptr<Commands> ret;
-        std::string fctname = "get" + extendedtype + "Commands";
 
-        getcommands getcommandsfct;
-        *(void**)(&getcommandsfct) = getFctFromName(fctname, LibraryManager::READERS_TYPE);
+        getcommands getcommandsfct = getCommandsFactory(extendedtype);
         if (getcommandsfct)
         {
             getcommandsfct(&ret);
@@ -182,9 +644,19 @@ namespace logicalaccess
             fctname = "getReaderInfoAt";
         }
 
-        if (libLoaded.empty())
+        getIndex();
+
+        if (lazy_)
         {
-            scanPlugins();
+            // Listed from the index, without loading the libraries.
+            for (std::map<std::string, PluginInfo>::const_iterator it = plugins_.begin(); it != plugins_.end(); ++it)
+            {
+                if (libraryType == LibraryManager::CARDS_TYPE)
+                    plugins.insert(plugins.end(), it->second.chips.begin(), it->second.chips.end());
+                else if (libraryType == LibraryManager::READERS_TYPE)
+                    plugins.insert(plugins.end(), it->second.readers.begin(), it->second.readers.end());
+            }
+            return plugins;
         }
 
         for (std::map<std::string, IDynLibrary*>::iterator it = libLoaded.begin(); it != libLoaded.end(); ++it)
@@ -221,24 +693,18 @@ namespace logicalaccess
 
     std::shared_ptr<ReaderUnit> LibraryManager::getReader(const std::string &readerName) const
     {
-        std::lock_guard<std::recursive_mutex> lg(mutex_);
         // The idea here is simply to loop over all shared library
         // and opportunistically call the `getReaderUnit()` function if it exists, hoping
         // that some module will be able to fulfil our request.
         std::shared_ptr<ReaderUnit> readerUnit;
-        for (auto &&itr : libLoaded)
+        for (auto &&fct : const_cast<LibraryManager*>(this)->getHook("getReaderUnit"))
         {
-            IDynLibrary *lib = itr.second;
-
-            if (lib->hasSymbol("getReaderUnit"))
-            {
-				int(*fptr)(const std::string &, std::shared_ptr<ReaderUnit> &) = nullptr;
-                fptr = reinterpret_cast<decltype(fptr)>(lib->getSymbol("getReaderUnit"));
-                assert(fptr);
-                fptr(readerName, readerUnit);
-                if (readerUnit)
-                    break;
-            }
+            int(*fptr)(const std::string &, std::shared_ptr<ReaderUnit> &) = nullptr;
+            fptr = reinterpret_cast<decltype(fptr)>(fct);
+            assert(fptr);
+            fptr(readerName, readerUnit);
+            if (readerUnit)
+                break;
         }
         return readerUnit;
     }
@@ -251,6 +717,7 @@ namespace logicalaccess
         std::string extension = EXTENSION_LIB;
         Settings* setting = Settings::getInstance();
         std::string fctname = "getLibraryName";
+        std::map<std::string, PluginInfo> plugins;
 
         LOG(LogLevel::PLUGINS) << "Will scan " << setting->PluginFolders.size() << " folders.";
         for (std::vector<std::string>::iterator it = setting->PluginFolders.begin(); it != setting->PluginFolders.end(); ++it)
@@ -270,24 +737,18 @@ namespace logicalaccess
                             || hasEnding(dir_iter->path().filename().string(), enumType[LibraryManager::READERS_TYPE] + extension)
                             || hasEnding(dir_iter->path().filename().string(), enumType[LibraryManager::UNIFIED_TYPE] + extension)))
                         {
-                            if (libLoaded.find(dir_iter->path().filename().string()) == libLoaded.end())
+                            if (plugins.find(dir_iter->path().filename().string()) == plugins.end())
                             {
-                                IDynLibrary* lib = newDynLibrary(dir_iter->path().string());
-                                fct = lib->getSymbol(fctname.c_str());
-                                if (fct != NULL)
-                                {
-                                    LOG(LogLevel::PLUGINS) << "Library " << dir_iter->path().filename().string() << " loaded.";
-                                    libLoaded[dir_iter->path().filename().string()] = lib;
-                                }
-                                else
-                                {
-                                    LOG(LogLevel::PLUGINS) << "Cannot found library entry point in " << dir_iter->path().filename().string() << ". Skipped.";
-                                    delete lib;
-                                }
+                                PluginInfo info;
+                                info.path = dir_iter->path().string();
+                                info.size = boost::filesystem::file_size(dir_iter->path());
+                                info.mtime = static_cast<long long>(boost::filesystem::last_write_time(dir_iter->path()));
+                                info.loadable = true;
+                                plugins[dir_iter->path().filename().string()] = info;
                             }
                             else
                             {
-                                LOG(LogLevel::PLUGINS) << "Library " << dir_iter->path().filename().string() << " already loaded. Skipped.";
+                                LOG(LogLevel::PLUGINS) << "Library " << dir_iter->path().filename().string() << " already found. Skipped.";
                             }
                         }
                         else
@@ -307,47 +768,190 @@ namespace logicalaccess
                 LOG(LogLevel::WARNINGS) << "Cannot found plug-in folder " << (*it);
             }
         }
+
+        if (!setting->PluginIndexFile.empty())
+        {
+            std::map<std::string, PluginInfo> indexed;
+            std::set<std::string> missing[3];
+            bool upToDate = loadPluginIndex(setting->PluginIndexFile, indexed, missing) && indexed.size() == plugins.size();
+            for (std::map<std::string, PluginInfo>::const_iterator it = plugins.begin(); upToDate && it != plugins.end(); ++it)
+            {
+                std::map<std::string, PluginInfo>::const_iterator i = indexed.find(it->first);
+                upToDate = (i != indexed.end() && i->second.path == it->second.path && i->second.size == it->second.size && i->second.mtime == it->second.mtime);
+            }
+
+            if (upToDate)
+            {
+                LOG(LogLevel::PLUGINS) << "Plug-ins index " << setting->PluginIndexFile << " is up to date, libraries will be loaded on first use.";
+                plugins_ = indexed;
+                for (int type = READERS_TYPE; type <= UNIFIED_TYPE; ++type)
+                    missing_[type] = missing[type];
+                lazy_ = true;
+                buildIndex();
+                if (setting->PluginWarmUp)
+                {
+                    warmUp();
+                }
+                return;
+            }
+        }
+
+        for (std::map<std::string, PluginInfo>::iterator it = plugins.begin(); it != plugins.end(); ++it)
+        {
+            try
+            {
+                if (libLoaded.find(it->first) == libLoaded.end())
+                {
+                    IDynLibrary* lib = newDynLibrary(it->second.path);
+                    fct = lib->getSymbol(fctname.c_str());
+                    if (fct != NULL)
+                    {
+                        LOG(LogLevel::PLUGINS) << "Library " << it->first << " loaded.";
+                        libLoaded[it->first] = lib;
+                    }
+                    else
+                    {
+                        LOG(LogLevel::PLUGINS) << "Cannot found library entry point in " << it->first << ". Skipped.";
+                        it->second.loadable = false;
+                        delete lib;
+                    }
+                }
+                else
+                {
+                    LOG(LogLevel::PLUGINS) << "Library " << it->first << " already loaded. Skipped.";
+                }
+            }
+            catch (const std::exception &e)
+            {
+                it->second.loadable = false;
+                LOG(LogLevel::ERRORS) << "Something bad happened when handling " << it->first << ": " << e.what();
+            }
+
+            std::map<std::string, IDynLibrary*>::iterator lib = libLoaded.find(it->first);
+            if (lib != libLoaded.end() && (*lib).second != NULL)
+            {
+                indexLibrary((*lib).second, it->second);
+            }
+        }
+
+        plugins_ = plugins;
+        for (int type = READERS_TYPE; type <= UNIFIED_TYPE; ++type)
+            missing_[type].clear();
+        lazy_ = false;
+        savePluginIndex();
+
+        // Publish a fresh index, previously resolved and missing symbols may have changed.
+        buildIndex();
+    }
+
+    void LibraryManager::warmUp(unsigned int threadCount)
+    {
+        std::shared_ptr<std::vector<std::pair<std::string, std::vector<std::string> > > > libraries(new std::vector<std::pair<std::string, std::vector<std::string> > >());
+        {
+            std::lock_guard<std::recursive_mutex> lg(mutex_);
+            if (!lazy_)
+                return;
+
+            for (std::map<std::string, PluginInfo>::const_iterator it = plugins_.begin(); it != plugins_.end(); ++it)
+            {
+                std::map<std::string, IDynLibrary*>::const_iterator lib = libLoaded.find(it->first);
+                if (it->second.loadable && (lib == libLoaded.end() || (*lib).second == NULL))
+                {
+                    libraries->push_back(std::make_pair(it->first, std::vector<std::string>(it->second.symbols.begin(), it->second.symbols.end())));
+                }
+            }
+        }
+        if (libraries->empty())
+            return;
+
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        threadCount = std::min(threadCount, static_cast<unsigned int>(libraries->size()));
+
+        // Stop the threads at exit, before the singleton and the statics they use are destroyed.
+        static std::once_flag exitHandler;
+        std::call_once(exitHandler, []() { std::atexit([]() { LibraryManager::getInstance()->stopWarmUp(); }); });
+
+        LOG(LogLevel::PLUGINS) << "Warming up " << libraries->size() << " libraries on " << threadCount << " threads.";
+        std::shared_ptr<std::atomic<size_t> > next(new std::atomic<size_t>(0));
+        std::lock_guard<std::mutex> wl(warmUpMutex_);
+        for (unsigned int t = 0; t < threadCount; ++t)
+        {
+            warmUpThreads_.push_back(std::thread([this, libraries, next]()
+            {
+                for (size_t i = (*next)++; i < libraries->size() && !warmUpStop_; i = (*next)++)
+                {
+                    const std::string& filename = (*libraries)[i].first;
+                    try
+                    {
+                        loadLibrary(filename);
+
+                        // Resolve the known factories too, so the first lookups hit the index.
+                        for (int type = READERS_TYPE; type <= CARDS_TYPE; ++type)
+                        {
+                            if (!hasEnding(filename, enumType[type] + EXTENSION_LIB))
+                                continue;
+                            for (std::vector<std::string>::const_iterator s = (*libraries)[i].second.cbegin(); s != (*libraries)[i].second.cend(); ++s)
+                                getFctFromName(*s, static_cast<LibraryType>(type));
+                        }
+                    }
+                    catch (const std::exception &e)
+                    {
+                        LOG(LogLevel::ERRORS) << "Something bad happened when loading " << filename << ": " << e.what();
+                    }
+                }
+            }));
+        }
+    }
+
+    void LibraryManager::waitWarmUp()
+    {
+        std::vector<std::thread> threads;
+        {
+            std::lock_guard<std::mutex> wl(warmUpMutex_);
+            threads.swap(warmUpThreads_);
+        }
+        for (std::vector<std::thread>::iterator it = threads.begin(); it != threads.end(); ++it)
+        {
+            if (it->joinable())
+                it->join();
+        }
+    }
+
+    void LibraryManager::stopWarmUp()
+    {
+        warmUpStop_ = true;
+        waitWarmUp();
+        warmUpStop_ = false;
     }
 
 std::shared_ptr<CardService> LibraryManager::getCardService(std::shared_ptr<Chip> chip,
                                                             CardServiceType type)
 {
-    std::lock_guard<std::recursive_mutex> lg(mutex_);
     std::shared_ptr<CardService> srv;
-    for (auto &&itr : libLoaded)
+    for (auto &&fct : getHook("getCardService"))
     {
-        IDynLibrary *lib = itr.second;
-
-        if (lib->hasSymbol("getCardService"))
-        {
-            int (*fptr)(std::shared_ptr<Chip>, std::shared_ptr<CardService> &, CardServiceType) = nullptr;
-            fptr = reinterpret_cast<decltype(fptr)>(lib->getSymbol("getCardService"));
-            assert(fptr);
-            fptr(chip, srv, type);
-            if (srv)
-                break;
-        }
+        int (*fptr)(std::shared_ptr<Chip>, std::shared_ptr<CardService> &, CardServiceType) = nullptr;
+        fptr = reinterpret_cast<decltype(fptr)>(fct);
+        assert(fptr);
+        fptr(chip, srv, type);
+        if (srv)
+            break;
     }
     return srv;
 }
 
 ReaderServicePtr LibraryManager::getReaderService(ReaderUnitPtr reader, ReaderServiceType type)
 {
-    std::lock_guard<std::recursive_mutex> lg(mutex_);
     ReaderServicePtr srv;
-    for (auto &&itr : libLoaded)
+    for (auto &&fct : getHook("getReaderService"))
     {
-        IDynLibrary *lib = itr.second;
-
-        if (lib->hasSymbol("getReaderService"))
-        {
-            int (*fptr)(ReaderUnitPtr, ReaderServicePtr &, ReaderServiceType) = nullptr;
-            fptr = reinterpret_cast<decltype(fptr)>(lib->getSymbol("getReaderService"));
-            assert(fptr);
-            fptr(reader, srv, type);
-            if (srv)
-                break;
-        }
+        int (*fptr)(ReaderUnitPtr, ReaderServicePtr &, ReaderServiceType) = nullptr;
+        fptr = reinterpret_cast<decltype(fptr)>(fct);
+        assert(fptr);
+        fptr(reader, srv, type);
+        if (srv)
+            break;
     }
     return srv;
 }
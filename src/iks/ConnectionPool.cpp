@@ -0,0 +1,59 @@
+#include "logicalaccess/iks/ConnectionPool.hpp"
+
+using namespace logicalaccess;
+using namespace logicalaccess::iks;
+
+ConnectionPool::ConnectionPool(PipelinedClient::TransportFactory factory,
+                               size_t connections, size_t max_in_flight)
+{
+    // The connections are established on their first command.
+    for (size_t i = 0; i < (connections ? connections : 1); ++i)
+    {
+        clients_.push_back(std::unique_ptr<PipelinedClient>(
+            new PipelinedClient(factory, max_in_flight)));
+    }
+}
+
+ConnectionPool::ConnectionPool(const IslogKeyServer::IKSConfig &config,
+                               size_t connections, size_t max_in_flight)
+    : ConnectionPool(PipelinedClient::ssl_transport_factory(config), connections,
+                     max_in_flight)
+{
+}
+
+ConnectionPool &ConnectionPool::fromGlobalSettings()
+{
+    static ConnectionPool pool(IslogKeyServer::getGlobalConfiguration());
+    return pool;
+}
+
+PipelinedClient &ConnectionPool::acquire()
+{
+    PipelinedClient *best = clients_[0].get();
+    size_t best_load      = best->in_flight();
+    for (size_t i = 1; i < clients_.size() && best_load > 0; ++i)
+    {
+        size_t load = clients_[i]->in_flight();
+        if (load < best_load)
+        {
+            best      = clients_[i].get();
+            best_load = load;
+        }
+    }
+    return *best;
+}
+
+std::future<std::shared_ptr<BaseResponse>> ConnectionPool::submit(BaseCommand &cmd)
+{
+    return acquire().submit(cmd);
+}
+
+std::shared_ptr<BaseResponse> ConnectionPool::transact(BaseCommand &cmd)
+{
+    return acquire().transact(cmd);
+}
+
+size_t ConnectionPool::size() const
+{
+    return clients_.size();
+}
@@ -1,5 +1,8 @@
 #include "logicalaccess/iks/IslogKeyServer.hpp"
 #include <boost/asio.hpp>
+#include <logicalaccess/iks/PipelinedClient.hpp>
+#include <logicalaccess/iks/RandomPool.hpp>
+#include <logicalaccess/iks/ResultCache.hpp>
 #include <logicalaccess/iks/packet/AesEncrypt.hpp>
 #include <logicalaccess/iks/packet/DesEncrypt.hpp>
 #include <logicalaccess/iks/packet/DesfireAuth.hpp>
@@ -47,6 +50,9 @@ IslogKeyServer::IslogKeyServer(const std::string &ip, uint16_t port,
 
 std::vector<uint8_t> IslogKeyServer::get_random(size_t sz)
 {
+    if (random_pool_)
+        return random_pool_->get(sz);
+
   assert(sz <= std::numeric_limits<uint16_t>::max());
     GenRandomCommand cmd;
     cmd.nb_bytes_ = static_cast<uint16_t>(sz);
@@ -57,24 +63,53 @@ std::vector<uint8_t> IslogKeyServer::get_random(size_t sz)
     return ret->bytes_;
 }
 
+void IslogKeyServer::enable_random_pool(size_t capacity)
+{
+    auto client = std::make_shared<PipelinedClient>(config_);
+    set_random_pool(
+        std::make_shared<RandomPool>(RandomPool::gen_random_fetcher(client), capacity));
+}
+
+void IslogKeyServer::set_random_pool(std::shared_ptr<RandomPool> pool)
+{
+    random_pool_ = pool;
+}
+
+std::shared_ptr<RandomPool> IslogKeyServer::get_random_pool() const
+{
+    return random_pool_;
+}
+
+void IslogKeyServer::set_result_cache(std::shared_ptr<ResultCache> cache)
+{
+    result_cache_ = cache;
+}
+
+std::shared_ptr<ResultCache> IslogKeyServer::get_result_cache() const
+{
+    return result_cache_;
+}
+
 std::vector<uint8_t> IslogKeyServer::aes_encrypt(const std::vector<uint8_t> &in,
                                                  const std::string &key_name,
                                                  const std::array<uint8_t, 16> &iv)
 {
-    AesEncryptCommand cmd;
-    cmd.key_name_ = key_name;
-    cmd.iv_       = iv;
-    cmd.payload_  = in;
-
-    auto ret = std::dynamic_pointer_cast<AesEncryptResponse>(transact(cmd));
-    assert(ret && ret->opcode_ == SMSG_OP_AES_ENCRYPT);
-    if (ret->status_ != SMSG_STATUS_SUCCESS)
-    {
-        THROW_EXCEPTION_WITH_LOG(IKSException,
-                                 "AESEncrypt failed: " + strstatus(ret->status_));
-    }
-    LOG(INFOS) << "Encrypted: " << ret->bytes_;
-    return ret->bytes_;
+    return cached(key_name, SMSG_OP_AES_ENCRYPT, 0, iv.data(), iv.size(), in, [&]() {
+        AesEncryptCommand cmd;
+        cmd.key_name_ = key_name;
+        cmd.iv_       = iv;
+        cmd.payload_  = in;
+
+        auto ret = std::dynamic_pointer_cast<AesEncryptResponse>(transact(cmd));
+        assert(ret && ret->opcode_ == SMSG_OP_AES_ENCRYPT);
+        if (ret->status_ != SMSG_STATUS_SUCCESS)
+        {
+            THROW_EXCEPTION_WITH_LOG(IKSException,
+                                     "AESEncrypt failed: " + strstatus(ret->status_));
+        }
+        LOG(INFOS) << "Encrypted: " << ret->bytes_;
+        return ret->bytes_;
+    });
 }
 
 std::vector<uint8_t> IslogKeyServer::aes_decrypt(const std::vector<uint8_t> &in,
@@ -94,21 +129,23 @@ std::vector<uint8_t> IslogKeyServer::aes_decrypt(const std::vector<uint8_t> &in,
                                                  const std::string &key_name,
                                                  const std::array<uint8_t, 16> &iv)
 {
-    AesEncryptCommand cmd;
-    cmd.decrypt_  = true;
-    cmd.key_name_ = key_name;
-    cmd.iv_       = iv;
-    cmd.payload_  = in;
-
-    auto ret = std::dynamic_pointer_cast<AesEncryptResponse>(transact(cmd));
-    assert(ret && ret->opcode_ == SMSG_OP_AES_ENCRYPT);
-    if (ret->status_ != SMSG_STATUS_SUCCESS)
-    {
-        THROW_EXCEPTION_WITH_LOG(IKSException,
-                                 "AESDecrypt failed: " + strstatus(ret->status_));
-    }
-    LOG(INFOS) << "Decrypted: " << ret->bytes_;
-    return ret->bytes_;
+    return cached(key_name, SMSG_OP_AES_ENCRYPT, 1, iv.data(), iv.size(), in, [&]() {
+        AesEncryptCommand cmd;
+        cmd.decrypt_  = true;
+        cmd.key_name_ = key_name;
+        cmd.iv_       = iv;
+        cmd.payload_  = in;
+
+        auto ret = std::dynamic_pointer_cast<AesEncryptResponse>(transact(cmd));
+        assert(ret && ret->opcode_ == SMSG_OP_AES_ENCRYPT);
+        if (ret->status_ != SMSG_STATUS_SUCCESS)
+        {
+            THROW_EXCEPTION_WITH_LOG(IKSException,
+                                     "AESDecrypt failed: " + strstatus(ret->status_));
+        }
+        LOG(INFOS) << "Decrypted: " << ret->bytes_;
+        return ret->bytes_;
+    });
 }
 
 std::vector<uint8_t>
@@ -148,22 +185,44 @@ std::vector<uint8_t> IslogKeyServer::des_crypto(const std::vector<uint8_t> &in,
                                                 const std::array<uint8_t, 8> &iv,
                                                 bool use_ecb, bool decrypt)
 {
-    DesEncryptCommand cmd;
-    cmd.key_name_ = key_name;
-    cmd.iv_       = iv;
-    cmd.payload_  = in;
-    cmd.flags_ =
-        use_ecb ? COMMAND_DES_ENCRYPT_FLAG_ECB : COMMAND_DES_ENCRYPT_FLAG_CBC;
-    cmd.decrypt_ = decrypt;
-
-    auto ret = std::dynamic_pointer_cast<DesEncryptResponse>(transact(cmd));
-    assert(ret && ret->opcode_ == SMSG_OP_DES_ENCRYPT);
-    if (ret->status_ != SMSG_STATUS_SUCCESS)
-    {
-        THROW_EXCEPTION_WITH_LOG(IKSException,
-                                 "DESCrypto failed: " + strstatus(ret->status_));
-    }
-    return ret->bytes_;
+    uint8_t flags = static_cast<uint8_t>((use_ecb ? 2 : 0) | (decrypt ? 1 : 0));
+    return cached(key_name, SMSG_OP_DES_ENCRYPT, flags, iv.data(), iv.size(), in, [&]() {
+        DesEncryptCommand cmd;
+        cmd.key_name_ = key_name;
+        cmd.iv_       = iv;
+        cmd.payload_  = in;
+        cmd.flags_ =
+            use_ecb ? COMMAND_DES_ENCRYPT_FLAG_ECB : COMMAND_DES_ENCRYPT_FLAG_CBC;
+        cmd.decrypt_ = decrypt;
+
+        auto ret = std::dynamic_pointer_cast<DesEncryptResponse>(transact(cmd));
+        assert(ret && ret->opcode_ == SMSG_OP_DES_ENCRYPT);
+        if (ret->status_ != SMSG_STATUS_SUCCESS)
+        {
+            THROW_EXCEPTION_WITH_LOG(IKSException,
+                                     "DESCrypto failed: " + strstatus(ret->status_));
+        }
+        return ret->bytes_;
+    });
+}
+
+std::vector<uint8_t>
+IslogKeyServer::cached(const std::string &key_name, uint16_t opcode, uint8_t flags,
+                       const uint8_t *iv, size_t iv_size, const std::vector<uint8_t> &in,
+                       const std::function<std::vector<uint8_t>()> &compute)
+{
+    if (!result_cache_)
+        return compute();
+
+    // The operation, its flags and the IV make the result depend on more
+    // than the input data.
+    std::vector<uint8_t> input;
+    input.push_back(static_cast<uint8_t>(opcode >> 8));
+    input.push_back(static_cast<uint8_t>(opcode));
+    input.push_back(flags);
+    input.insert(input.end(), iv, iv + iv_size);
+    input.insert(input.end(), in.begin(), in.end());
+    return result_cache_->get(key_name, KeyDivInfo(), input, compute);
 }
 
 void IslogKeyServer::setup_transport()
@@ -211,14 +270,8 @@ void IslogKeyServer::send_command(const BaseCommand &cmd)
 
 std::shared_ptr<BaseResponse> IslogKeyServer::recv()
 {
-    uint32_t packet_size;
-    uint16_t opcode;
-    uint16_t status;
-
-    bool has_size   = false;
-    bool has_opcode = false;
-    bool has_status = false;
-    size_t needle   = 0;
+    ResponseHeader header;
+    bool has_header = false;
     std::vector<uint8_t> buffer;
     // 3 attempts of 1sec
     for (int i = 0; i < 3; ++i)
@@ -234,54 +287,29 @@ std::shared_ptr<BaseResponse> IslogKeyServer::recv()
             continue;
         }
 
-        // size
-        if (!has_size && buffer.size() - needle >= sizeof(packet_size))
-        {
-            memcpy(&packet_size, &buffer[needle], sizeof(packet_size));
-            packet_size = ntohl(packet_size);
-            needle += sizeof(packet_size);
-            has_size = true;
-        }
-
-        // opcode
-        if (!has_opcode && buffer.size() - needle >= sizeof(opcode))
-        {
-            memcpy(&opcode, &buffer[needle], sizeof(opcode));
-            opcode = ntohs(opcode);
-            needle += sizeof(opcode);
-            has_opcode = true;
-        }
+        if (!has_header)
+            has_header = header.parse(buffer.data(), buffer.size());
 
-        // status code
-        if (!has_status && buffer.size() - needle >= sizeof(status))
+        if (has_header && buffer.size() >= header.packet_size_)
         {
-            memcpy(&status, &buffer[needle], sizeof(status));
-            status = ntohs(status);
-            needle += sizeof(status);
-            has_status = true;
-        }
-
-        if (has_size && has_opcode && has_status &&
-            buffer.size() - needle >= packet_size - 8) // total size of header
-        {
-            LOG(INFOS) << "Size: " << packet_size << ". Op: " << opcode
-                       << ". St: " << status << ". Bufsize: " << buffer.size()
-                       << ". Needle: " << needle;
+            LOG(INFOS) << "Size: " << header.packet_size_ << ". Op: " << header.opcode_
+                       << ". St: " << header.status_ << ". Bufsize: " << buffer.size();
 
             return build_response(
-                packet_size, opcode, status,
-                std::vector<uint8_t>(buffer.begin() + needle, buffer.end()));
+                header, std::vector<uint8_t>(buffer.begin() + header.header_size_,
+                                             buffer.begin() + header.packet_size_));
         }
     }
     return nullptr;
 }
 
 std::shared_ptr<BaseResponse>
-IslogKeyServer::build_response(uint32_t size, uint16_t opcode, uint16_t status,
+IslogKeyServer::build_response(const ResponseHeader &header,
                                const std::vector<uint8_t> &data)
 {
     std::shared_ptr<BaseResponse> resp;
-    switch (opcode)
+    uint16_t status = header.status_;
+    switch (header.opcode_)
     {
     case SMSG_OP_GENRANDOM:
         resp = std::make_shared<GenRandomResponse>(status, data);
@@ -303,9 +331,11 @@ IslogKeyServer::build_response(uint32_t size, uint16_t opcode, uint16_t status,
         resp = std::make_shared<DesfireChangeKeyResponse>(status, data);
         break;
     default:
-        LOG(WARNINGS) << "Unkown opcode " << opcode << " from server.";
+        LOG(WARNINGS) << "Unkown opcode " << header.opcode_ << " from server.";
     }
 
+    if (resp)
+        resp->request_id_ = header.request_id_;
     return resp;
 }
 
@@ -320,6 +350,11 @@ void IslogKeyServer::configureGlobalInstance(const std::string &ip, uint16_t por
         IKSConfig(ip, port, client_cert, client_key, root_ca);
 }
 
+const IslogKeyServer::IKSConfig &IslogKeyServer::getGlobalConfiguration()
+{
+    return pre_configuration_;
+}
+
 IslogKeyServer::IKSConfig::IKSConfig(const std::string &ip, uint16_t port,
                                      const std::string &client_cert,
                                      const std::string &client_key,
@@ -0,0 +1,284 @@
+#include "logicalaccess/iks/PipelinedClient.hpp"
+#include <logicalaccess/logs.hpp>
+#include <logicalaccess/myexception.hpp>
+#include <algorithm>
+#include <chrono>
+
+using namespace logicalaccess;
+using namespace logicalaccess::iks;
+
+/**
+ * Time without any byte received after which the requests in flight fail, in
+ * milliseconds. The same as the 3 attempts of IslogKeyServer::recv().
+ */
+static const long RESPONSE_TIMEOUT = 9000;
+
+PipelinedClient::PipelinedClient(TransportFactory factory, size_t max_in_flight)
+    : factory_(factory)
+    , max_in_flight_(max_in_flight ? max_in_flight : 1)
+    , poll_timeout_(5)
+    , next_request_id_(1)
+    , stop_(false)
+{
+    thread_ = std::thread(&PipelinedClient::run, this);
+}
+
+PipelinedClient::PipelinedClient(const IslogKeyServer::IKSConfig &config,
+                                 size_t max_in_flight)
+    : PipelinedClient(ssl_transport_factory(config), max_in_flight)
+{
+}
+
+PipelinedClient::~PipelinedClient()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    queued_.notify_all();
+    thread_.join();
+
+    fail_all(std::make_exception_ptr(
+        IKSException("The Islog Key Server client was destroyed.")));
+}
+
+std::future<std::shared_ptr<BaseResponse>> PipelinedClient::submit(BaseCommand &cmd)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    completed_.wait(lock, [this]() { return pending_.size() < max_in_flight_; });
+
+    // Skip 0 and the identifiers still in flight after a wrap around.
+    do
+    {
+        cmd.request_id_ = next_request_id_++;
+    } while (cmd.request_id_ == 0 || pending_.count(cmd.request_id_));
+
+    std::future<std::shared_ptr<BaseResponse>> result =
+        pending_[cmd.request_id_].get_future();
+    queue_.push_back(std::make_pair(cmd.request_id_, cmd.serialize()));
+    lock.unlock();
+
+    queued_.notify_one();
+    return result;
+}
+
+std::shared_ptr<BaseResponse> PipelinedClient::transact(BaseCommand &cmd)
+{
+    return submit(cmd).get();
+}
+
+size_t PipelinedClient::in_flight() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_.size();
+}
+
+void PipelinedClient::set_poll_timeout(long timeout)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    poll_timeout_ = timeout;
+}
+
+void PipelinedClient::run()
+{
+    auto last_activity = std::chrono::steady_clock::now();
+    while (true)
+    {
+        long timeout;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (pending_.empty())
+            {
+                queued_.wait(lock, [this]() { return stop_ || !pending_.empty(); });
+                last_activity = std::chrono::steady_clock::now();
+            }
+            if (stop_)
+                break;
+            timeout = poll_timeout_;
+        }
+
+        if (!flush())
+            continue;
+
+        // The transport cannot be woken up, so the wait for responses is kept
+        // short to write the commands queued meanwhile. It reads nothing: a
+        // timeout neither logs nor interrupts a record.
+        if (!transport_->waitReadable(timeout))
+        {
+            if (!transport_->isConnected() ||
+                std::chrono::steady_clock::now() - last_activity >
+                    std::chrono::milliseconds(RESPONSE_TIMEOUT))
+            {
+                LOG(ERRORS) << "No response in IKS pipelined client.";
+                fail_all(std::make_exception_ptr(
+                    IKSException("No response from the Islog Key Server.")));
+            }
+            continue;
+        }
+
+        try
+        {
+            // The rest of a record may still be on its way.
+            auto data = transport_->receive(RESPONSE_TIMEOUT);
+            buffer_.insert(buffer_.end(), data.begin(), data.end());
+            last_activity = std::chrono::steady_clock::now();
+        }
+        catch (LibLogicalAccessException &)
+        {
+            // The connection was lost.
+            LOG(ERRORS) << "Network error in IKS pipelined client.";
+            fail_all(std::make_exception_ptr(
+                IKSException("No response from the Islog Key Server.")));
+            continue;
+        }
+
+        try
+        {
+            dispatch();
+        }
+        catch (std::exception &)
+        {
+            // The stream is out of sync.
+            fail_all(std::current_exception());
+        }
+    }
+
+    if (transport_)
+        transport_->disconnect();
+}
+
+bool PipelinedClient::flush()
+{
+    std::vector<uint8_t> data;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto &cmd : queue_)
+        {
+            data.insert(data.end(), cmd.second.begin(), cmd.second.end());
+            sent_.push_back(cmd.first);
+        }
+        queue_.clear();
+    }
+
+    try
+    {
+        if (!transport_ || !transport_->isConnected())
+        {
+            transport_ = factory_();
+            buffer_.clear();
+            if (!transport_ || !transport_->connect(2500))
+            {
+                THROW_EXCEPTION_WITH_LOG(IKSException,
+                                         "Failed to connect to Islog Key Server.");
+            }
+        }
+
+        // All the queued commands in one write, if any.
+        if (!data.empty())
+            transport_->send(data);
+    }
+    catch (std::exception &)
+    {
+        fail_all(std::current_exception());
+        return false;
+    }
+    return true;
+}
+
+void PipelinedClient::dispatch()
+{
+    size_t needle = 0;
+    ResponseHeader header;
+    while (header.parse(buffer_.data() + needle, buffer_.size() - needle) &&
+           buffer_.size() - needle >= header.packet_size_)
+    {
+        std::vector<uint8_t> data(buffer_.begin() + needle + header.header_size_,
+                                  buffer_.begin() + needle + header.packet_size_);
+        needle += header.packet_size_;
+
+        Promise promise;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto sent = header.request_id_
+                            ? std::find(sent_.begin(), sent_.end(), header.request_id_)
+                            : sent_.begin();
+            auto it = sent != sent_.end() ? pending_.find(*sent) : pending_.end();
+            if (it == pending_.end())
+            {
+                LOG(WARNINGS) << "Unexpected IKS response for request "
+                              << header.request_id_ << ".";
+                continue;
+            }
+            promise = std::move(it->second);
+            pending_.erase(it);
+            sent_.erase(sent);
+        }
+        completed_.notify_all();
+
+        try
+        {
+            auto resp = IslogKeyServer::build_response(header, data);
+            if (!resp)
+            {
+                THROW_EXCEPTION_WITH_LOG(IKSException, "Unknown response opcode.");
+            }
+            promise.set_value(resp);
+        }
+        catch (std::exception &)
+        {
+            promise.set_exception(std::current_exception());
+        }
+    }
+    buffer_.erase(buffer_.begin(), buffer_.begin() + needle);
+}
+
+void PipelinedClient::fail_all(std::exception_ptr error)
+{
+    std::map<uint32_t, Promise> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending.swap(pending_);
+        queue_.clear();
+        sent_.clear();
+    }
+    completed_.notify_all();
+
+    for (auto &request : pending)
+        request.second.set_exception(error);
+
+    if (transport_)
+    {
+        transport_->disconnect();
+        transport_ = nullptr;
+    }
+    buffer_.clear();
+}
+
+PipelinedClient::TransportFactory
+PipelinedClient::ssl_transport_factory(const IslogKeyServer::IKSConfig &config)
+{
+#ifdef ENABLE_SSLTRANSPORT
+    auto ctx = std::make_shared<boost::asio::ssl::context>(
+        boost::asio::ssl::context::tlsv12_client);
+    ctx->use_certificate_file(config.client_cert,
+                              boost::asio::ssl::context_base::file_format::pem);
+    ctx->use_private_key_file(config.client_key,
+                              boost::asio::ssl::context_base::file_format::pem);
+    ctx->load_verify_file(config.root_ca);
+    ctx->set_verify_mode(boost::asio::ssl::verify_peer);
+
+    return [ctx, config]() {
+        std::unique_ptr<SSLTransport> transport(new SSLTransport(*ctx));
+        transport->setIpAddress(config.ip);
+        transport->setPort(config.port);
+        return transport;
+    };
+#else
+    return [config]() {
+        std::unique_ptr<SSLTransport> transport(new SSLTransport());
+        transport->setIpAddress(config.ip);
+        transport->setPort(config.port);
+        return transport;
+    };
+#endif /* ENABLE_SSLTRANSPORT */
+}
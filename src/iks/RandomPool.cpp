@@ -0,0 +1,139 @@
+#include "logicalaccess/iks/RandomPool.hpp"
+#include <logicalaccess/iks/packet/GenRandom.hpp>
+#include <logicalaccess/logs.hpp>
+#include <logicalaccess/myexception.hpp>
+#include <algorithm>
+#include <limits>
+
+using namespace logicalaccess;
+using namespace logicalaccess::iks;
+
+RandomPool::RandomPool(Fetcher fetcher, size_t capacity)
+    : fetcher_(fetcher)
+    , capacity_(capacity ? capacity : 1)
+    , hits_(0)
+    , misses_(0)
+    , refill_requested_(true)
+    , stop_(false)
+{
+    buffer_.reserve(capacity_);
+    thread_ = std::thread(&RandomPool::run, this);
+}
+
+RandomPool::~RandomPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    refill_.notify_one();
+    thread_.join();
+}
+
+std::vector<uint8_t> RandomPool::get(size_t sz)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (buffer_.size() >= sz)
+        {
+            ++hits_;
+            // Bytes are taken from the end, so that the rest does not move.
+            std::vector<uint8_t> ret(buffer_.end() - sz, buffer_.end());
+            buffer_.resize(buffer_.size() - sz);
+            if (buffer_.size() < capacity_ / 2 && !refill_requested_)
+            {
+                refill_requested_ = true;
+                refill_.notify_one();
+            }
+            return ret;
+        }
+
+        ++misses_;
+        if (!refill_requested_)
+        {
+            refill_requested_ = true;
+            refill_.notify_one();
+        }
+    }
+
+    // Do not wait for the refill, which may be much larger than the request.
+    return fetcher_(sz);
+}
+
+size_t RandomPool::available() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return buffer_.size();
+}
+
+uint64_t RandomPool::hits() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
+
+uint64_t RandomPool::misses() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+}
+
+void RandomPool::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        refill_.wait(lock, [this]() { return stop_ || refill_requested_; });
+        if (stop_)
+            break;
+
+        size_t missing = capacity_ - buffer_.size();
+        lock.unlock();
+
+        std::vector<uint8_t> data;
+        try
+        {
+            data = fetcher_(missing);
+        }
+        catch (std::exception &e)
+        {
+            // The next request will try again.
+            LOG(ERRORS) << "Cannot refill the IKS random pool: " << e.what();
+        }
+
+        lock.lock();
+        refill_requested_ = false;
+        size_t count = std::min(data.size(), capacity_ - buffer_.size());
+        buffer_.insert(buffer_.end(), data.begin(), data.begin() + count);
+    }
+}
+
+RandomPool::Fetcher RandomPool::gen_random_fetcher(std::shared_ptr<PipelinedClient> client,
+                                                   size_t block_size)
+{
+    block_size = std::min<size_t>(block_size ? block_size : 1,
+                                  std::numeric_limits<uint16_t>::max());
+
+    return [client, block_size](size_t sz) {
+        std::vector<std::future<std::shared_ptr<BaseResponse>>> responses;
+        for (size_t offset = 0; offset < sz; offset += block_size)
+        {
+            GenRandomCommand cmd;
+            cmd.nb_bytes_ = static_cast<uint16_t>(std::min(block_size, sz - offset));
+            responses.push_back(client->submit(cmd));
+        }
+
+        std::vector<uint8_t> ret;
+        ret.reserve(sz);
+        for (auto &response : responses)
+        {
+            auto resp = std::dynamic_pointer_cast<GenRandomResponse>(response.get());
+            EXCEPTION_ASSERT_WITH_LOG(resp, IKSException,
+                                      "Cannot retrieve proper response from server.");
+            ret.insert(ret.end(), resp->bytes_.begin(), resp->bytes_.end());
+        }
+        EXCEPTION_ASSERT_WITH_LOG(ret.size() == sz, IKSException,
+                                  "Unexpected number of random bytes from server.");
+        return ret;
+    };
+}
@@ -0,0 +1,133 @@
+#include "logicalaccess/iks/ResultCache.hpp"
+
+using namespace logicalaccess;
+using namespace logicalaccess::iks;
+
+ResultCache::ResultCache(size_t capacity, std::chrono::milliseconds ttl)
+    : capacity_(capacity ? capacity : 1)
+    , ttl_(ttl)
+    , hits_(0)
+    , misses_(0)
+    , evictions_(0)
+{
+}
+
+void ResultCache::allow(const std::string &key_identity)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    allowed_.insert(key_identity);
+}
+
+void ResultCache::forbid(const std::string &key_identity)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    allowed_.erase(key_identity);
+    for (auto it = entries_.begin(); it != entries_.end();)
+    {
+        auto next = std::next(it);
+        if (it->key_identity == key_identity)
+            erase(it);
+        it = next;
+    }
+}
+
+bool ResultCache::is_allowed(const std::string &key_identity) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allowed_.count(key_identity) != 0;
+}
+
+std::vector<uint8_t> ResultCache::get(const std::string &key_identity,
+                                      const KeyDivInfo &div_info,
+                                      const std::vector<uint8_t> &input,
+                                      const Compute &compute)
+{
+    // The key identity is a string, so it ends at the first null byte.
+    std::string index(key_identity);
+    index.push_back('\0');
+    auto div = div_info.serialize();
+    index.append(div.begin(), div.end());
+    index.append(input.begin(), input.end());
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!allowed_.count(key_identity))
+        {
+            // Not counted: the key is not meant to be cached.
+            lock.unlock();
+            return compute();
+        }
+
+        auto it = index_.find(index);
+        if (it != index_.end())
+        {
+            if (std::chrono::steady_clock::now() < it->second->expiry)
+            {
+                ++hits_;
+                entries_.splice(entries_.begin(), entries_, it->second);
+                return entries_.front().result;
+            }
+            erase(it->second);
+        }
+        ++misses_;
+    }
+
+    // Concurrent misses on the same entry both go to the server, the last
+    // one is kept.
+    auto result = compute();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!allowed_.count(key_identity))
+        return result;
+
+    auto it = index_.find(index);
+    if (it != index_.end())
+        erase(it->second);
+    while (entries_.size() >= capacity_)
+    {
+        erase(std::prev(entries_.end()));
+        ++evictions_;
+    }
+
+    entries_.push_front(
+        Entry{key_identity, index, result, std::chrono::steady_clock::now() + ttl_});
+    index_[index] = entries_.begin();
+    return result;
+}
+
+void ResultCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    index_.clear();
+}
+
+size_t ResultCache::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+uint64_t ResultCache::hits() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
+
+uint64_t ResultCache::misses() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+}
+
+uint64_t ResultCache::evictions() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return evictions_;
+}
+
+void ResultCache::erase(std::list<Entry>::iterator it)
+{
+    index_.erase(it->index);
+    entries_.erase(it);
+}
@@ -201,6 +201,34 @@ std::vector<uint8_t> SSLTransport::receive(long int timeout)
     return recv;
 }
 
+bool SSLTransport::waitReadable(long int timeout)
+{
+#ifndef ENABLE_SSLTRANSPORT
+    return false;
+#else
+    // Bytes already decrypted by a previous read are not on the socket anymore.
+    if (SSL_pending(d_socket.native_handle()) > 0)
+        return true;
+
+    // Canceling a wait, unlike a read, never leaves a record partly consumed.
+    d_ios.reset();
+    d_read_error = true;
+    d_socket.lowest_layer().async_wait(
+        boost::asio::ip::tcp::socket::wait_read,
+        [this](const boost::system::error_code &error) {
+            d_read_error = bool(error);
+            d_timer.cancel();
+        });
+
+    d_timer.expires_from_now(boost::posix_time::milliseconds(timeout));
+    d_timer.async_wait(boost::bind(&SSLTransport::time_out, this,
+                                   boost::asio::placeholders::error));
+
+    d_ios.run();
+    return !d_read_error;
+#endif /* ENABLE_SSLTRANSPORT */
+}
+
 void SSLTransport::serialize(boost::property_tree::ptree &parentNode)
 {
     boost::property_tree::ptree node;
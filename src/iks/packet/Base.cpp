@@ -1,6 +1,7 @@
 #include "logicalaccess/iks/packet/Base.hpp"
 
 #include "logicalaccess/key.hpp"
+#include <algorithm>
 #include <assert.h>
 #include <cstring>
 #include <logicalaccess/cards/keydiversification.hpp>
@@ -11,28 +12,89 @@
 using namespace logicalaccess;
 using namespace logicalaccess::iks;
 
+BaseCommand::BaseCommand()
+    : request_id_(0)
+    , opcode_(0)
+{
+}
+
 std::vector<uint8_t> BaseCommand::serialize() const
 {
     uint32_t full_size;
     uint16_t op;
 
-    std::vector<uint8_t> ret(6);
+    std::vector<uint8_t> ret(request_id_ ? 10 : 6);
     full_size = logicalaccess::lla_htonl(static_cast<uint32_t>(binary_size()));
-    op        = logicalaccess::lla_htons(opcode_);
+    op        = logicalaccess::lla_htons(
+        static_cast<uint16_t>(request_id_ ? (opcode_ | IKS_OPCODE_FLAG_REQUEST_ID) : opcode_));
 
     memcpy(&ret[0], &full_size, sizeof(full_size));
     memcpy(&ret[sizeof(full_size)], &op, sizeof(op));
+    if (request_id_)
+    {
+        uint32_t id = logicalaccess::lla_htonl(request_id_);
+        memcpy(&ret[sizeof(full_size) + sizeof(op)], &id, sizeof(id));
+    }
     return ret;
 }
 
 size_t BaseCommand::binary_size() const
 {
-    return binary_size_impl() + sizeof(uint32_t) + sizeof(opcode_);
+    return binary_size_impl() + sizeof(uint32_t) + sizeof(opcode_) +
+           (request_id_ ? sizeof(request_id_) : 0);
+}
+
+ResponseHeader::ResponseHeader()
+    : packet_size_(0)
+    , opcode_(0)
+    , status_(0)
+    , request_id_(0)
+    , header_size_(0)
+{
+}
+
+bool ResponseHeader::parse(const uint8_t *data, size_t length)
+{
+    uint32_t size;
+    uint16_t op;
+    uint16_t st;
+
+    if (length < sizeof(size) + sizeof(op) + sizeof(st))
+        return false;
+
+    memcpy(&size, data, sizeof(size));
+    memcpy(&op, data + sizeof(size), sizeof(op));
+    memcpy(&st, data + sizeof(size) + sizeof(op), sizeof(st));
+    op = logicalaccess::lla_ntohs(op);
+
+    size_t header_size = sizeof(size) + sizeof(op) + sizeof(st);
+    uint32_t id        = 0;
+    if (op & IKS_OPCODE_FLAG_REQUEST_ID)
+    {
+        if (length < header_size + sizeof(id))
+            return false;
+        memcpy(&id, data + header_size, sizeof(id));
+        id = logicalaccess::lla_ntohl(id);
+        header_size += sizeof(id);
+    }
+
+    packet_size_ = logicalaccess::lla_ntohl(size);
+    opcode_      = static_cast<uint16_t>(op & ~IKS_OPCODE_FLAG_REQUEST_ID);
+    status_      = logicalaccess::lla_ntohs(st);
+    request_id_  = id;
+    header_size_ = header_size;
+
+    if (packet_size_ < header_size_)
+    {
+        THROW_EXCEPTION_WITH_LOG(IKSException, "Invalid response size.");
+    }
+    return true;
 }
 
 BaseResponse::BaseResponse(uint16_t opcode, uint16_t status)
     : opcode_(opcode)
     , status_(status)
+    , request_id_(0)
 {
     if (status_ != SMSG_STATUS_SUCCESS)
     {
@@ -78,12 +140,11 @@ std::vector<uint8_t> KeyDivInfo::serialize() const
     std::vector<uint8_t> ret(binary_size());
     assert(div_input_.size() <= 64);
 
-    uint8_t div_info_size = static_cast<uint8_t>(div_input_.size());
-    div_input_.resize(64);
-
+    // The input is zero padded in the packet only, so that serializing
+    // twice gives the same bytes.
     ret[0] = flag_;
-    ret[1] = div_info_size;
-    memcpy(&ret[2], &div_input_[0], 64);
+    ret[1] = static_cast<uint8_t>(div_input_.size());
+    std::copy(div_input_.begin(), div_input_.end(), ret.begin() + 2);
     return ret;
 }
 
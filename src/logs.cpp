@@ -7,6 +7,7 @@
 #include "logicalaccess/logs.hpp"
 #include "logicalaccess/settings.hpp"
 #include "logicalaccess/colorize.hpp"
+#include "logicalaccess/asynclogwriter.hpp"
 #include <boost/date_time.hpp>
 
 #ifdef WIN32
@@ -24,55 +25,82 @@ namespace logicalaccess
 {
     bool Logs::logToStderr = false;
     std::ofstream Logs::logfile;
-    std::map<LogLevel, std::string> Logs::logLevelMsg;
+    std::atomic<uint32_t> Logs::levelMask(0xFFFFFFFF);
+
+    static const char *getLogLevelMsg(LogLevel level)
+    {
+        switch (level)
+        {
+        case TRACE: return "TRACE";
+        case INFOS: return "INFO";
+        case WARNINGS: return "WARNING";
+        case NOTICES: return "NOTICE";
+        case ERRORS: return "ERROR";
+        case EMERGENSYS: return "EMERGENSY";
+        case CRITICALS: return "CRITICAL";
+        case ALERTS: return "ALERT";
+        case DEBUGS: return "DEBUG";
+        case COMS: return "COM";
+        case PLUGINS: return "PLUGIN";
+        case PLUGINS_ERROR: return "PLUGIN_ERROR";
+        default: return "";
+        }
+    }
+
+    void Logs::updateLevelMask()
+    {
+        Settings *settings = Settings::getInstance();
+        uint32_t mask = 0;
+
+        if (settings->IsLogEnabled && logfile.is_open())
+        {
+            for (int level = TRACE; level <= PLUGINS_ERROR; ++level)
+                mask |= (1u << level);
+            if (!settings->SeeCommunicationLog)
+                mask &= ~(1u << COMS);
+            if (!settings->SeePluginLog)
+                mask &= ~((1u << PLUGINS) | (1u << PLUGINS_ERROR));
+        }
+        levelMask.store(mask, std::memory_order_relaxed);
+    }
 
     Logs::Logs(const char *file, const char *func, int line,
                enum LogLevel level)
         : d_level(level)
     {
-        if (!Settings::getInstance()->IsLogEnabled ||
-            (d_level == LogLevel::COMS &&
-             !Settings::getInstance()->SeeCommunicationLog) ||
+        Settings *settings = Settings::getInstance();
+        if (!settings->IsLogEnabled ||
+            (d_level == LogLevel::COMS && !settings->SeeCommunicationLog) ||
             ((d_level == LogLevel::PLUGINS ||
               d_level == LogLevel::PLUGINS_ERROR) &&
-             !Settings::getInstance()->SeePluginLog))
+             !settings->SeePluginLog))
             d_level = NONE;
 
-        if (logLevelMsg.empty())
-        {
-            logLevelMsg[INFOS]      = "INFO";
-            logLevelMsg[WARNINGS]   = "WARNING";
-            logLevelMsg[NOTICES]    = "NOTICE";
-            logLevelMsg[ERRORS]     = "ERROR";
-            logLevelMsg[EMERGENSYS] = "EMERGENSY";
-            logLevelMsg[CRITICALS]  = "CRITICAL";
-            logLevelMsg[ALERTS]     = "ALERT";
-            logLevelMsg[DEBUGS]     = "DEBUG";
-            logLevelMsg[COMS]       = "COM";
-            logLevelMsg[PLUGINS]    = "PLUGIN";
-        }
-
         if (logfile && d_level != NONE)
         {
             boost::posix_time::ptime now =
                 boost::posix_time::microsec_clock::local_time();
-            if (Settings::getInstance()->ColorizeLog)
+            if (settings->ColorizeLog)
             {
                 _stream << Colorize::underline(
                                boost::posix_time::to_simple_string(now))
-                        << " - " << Colorize::red(logLevelMsg[d_level])
+                        << " - " << Colorize::red(getLogLevelMsg(d_level))
                         << ": \t{" << line << "}\t{" << Colorize::green(func)
                         << "}\t{" << file << "}:" << std::endl;
             }
             else
             {
                 _stream << boost::posix_time::to_simple_string(now) << " - "
-                        << logLevelMsg[d_level] << ": \t{" << line << "}\t{"
+                        << getLogLevelMsg(d_level) << ": \t{" << line << "}\t{"
                         << func << "}\t{" << file << "}:" << std::endl;
             }
-            if (Settings::getInstance()->ContextLog)
+            if (settings->ContextLog)
                 _stream << pretty_context_infos();
         }
+        else
+        {
+            d_level = NONE;
+        }
     }
 
     std::string Logs::pretty_context_infos()
@@ -108,6 +136,16 @@ namespace logicalaccess
         if (logfile && d_level != NONE)
         {
             _stream << std::endl;
+            AsyncLogWriter &writer = AsyncLogWriter::getInstance();
+            if (writer.isRunning())
+            {
+                bool severe = (d_level == ERRORS || d_level == EMERGENSYS ||
+                               d_level == CRITICALS || d_level == ALERTS ||
+                               d_level == PLUGINS_ERROR);
+                writer.push(_stream.str(), severe);
+                return;
+            }
+
             logfile << _stream.rdbuf();
             logfile.flush();
 
@@ -154,11 +192,13 @@ namespace logicalaccess
     {
         old_ = Settings::getInstance()->IsLogEnabled;
         Settings::getInstance()->IsLogEnabled = false;
+        Logs::updateLevelMask();
     }
 
     LogDisabler::~LogDisabler()
     {
         Settings::getInstance()->IsLogEnabled = old_;
+        Logs::updateLevelMask();
     }
     
     std::string get_nth_param_name(const char *param_names, int idx)
@@ -9,8 +9,30 @@
 #include "logicalaccess/logs.hpp"
 #include "logicalaccess/settings.hpp"
 
+#include <thread>
+
 namespace logicalaccess
 {
+    /**
+     * \brief Join a command thread, or detach it when called from the thread itself, which is then
+     * returning from the callback.
+     */
+    static void joinCommandThread(std::thread& thread)
+    {
+        if (!thread.joinable())
+            return;
+
+        if (thread.get_id() == std::this_thread::get_id())
+            thread.detach();
+        else
+            thread.join();
+    }
+
+    DataTransport::~DataTransport()
+    {
+        joinCommandThread(d_commandThread);
+    }
+
     std::vector<unsigned char> DataTransport::sendCommand(const std::vector<unsigned char>& command, long int timeout)
     {
         if (timeout == -1)
@@ -35,4 +57,26 @@ namespace logicalaccess
         LOG(LogLevel::COMS) << "Response received successfully ! Response: " << BufferHelper::getHex(res) << " size {" << res.size() << "}";
         return res;
     }
-}
\ No newline at end of file
+
+    void DataTransport::asyncSendCommand(const std::vector<unsigned char>& command, long int timeout, DataTransportCallback callback)
+    {
+        // The previous command is completed, only its thread may not be finished yet.
+        joinCommandThread(d_commandThread);
+
+        std::shared_ptr<DataTransport> self = shared_from_this();
+        d_commandThread = std::thread([self, command, timeout, callback]()
+        {
+            std::vector<unsigned char> res;
+            std::exception_ptr error;
+            try
+            {
+                res = self->sendCommand(command, timeout);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+            callback(res, error);
+        });
+    }
+}
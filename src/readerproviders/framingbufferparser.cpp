@@ -0,0 +1,247 @@
+/**
+ * \file framingbufferparser.cpp
+ * \brief Incremental framing engine for the reader circular buffers.
+ */
+
+#include "logicalaccess/readerproviders/framingbufferparser.hpp"
+#include "logicalaccess/logs.hpp"
+#include "logicalaccess/bufferhelper.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace logicalaccess
+{
+    FrameSpan::FrameSpan()
+        : d_first(nullptr), d_firstLength(0), d_second(nullptr), d_secondLength(0)
+    {
+    }
+
+    FrameSpan::FrameSpan(const boost::circular_buffer<unsigned char>& circular_buffer, size_t length)
+    {
+        boost::circular_buffer<unsigned char>::const_array_range one = circular_buffer.array_one();
+        boost::circular_buffer<unsigned char>::const_array_range two = circular_buffer.array_two();
+
+        d_first = one.first;
+        d_firstLength = std::min(length, one.second);
+        d_second = two.first;
+        d_secondLength = std::min(length - d_firstLength, two.second);
+    }
+
+    void FrameSpan::copy(size_t offset, size_t length, unsigned char* out) const
+    {
+        if (offset < d_firstLength)
+        {
+            size_t firstCount = std::min(length, d_firstLength - offset);
+            memcpy(out, d_first + offset, firstCount);
+            out += firstCount;
+            length -= firstCount;
+            offset = 0;
+        }
+        else
+        {
+            offset -= d_firstLength;
+        }
+
+        if (length > 0)
+        {
+            memcpy(out, d_second + offset, length);
+        }
+    }
+
+    std::vector<unsigned char> FrameSpan::toVector() const
+    {
+        std::vector<unsigned char> result(size());
+        if (!result.empty())
+        {
+            copy(0, result.size(), &result[0]);
+        }
+        return result;
+    }
+
+    FramingBufferParser::FramingBufferParser()
+        : d_useLength(false), d_lengthOffset(0), d_lengthSize(1), d_lengthBigEndian(true), d_lengthAdjustment(0),
+        d_headerLength(1), d_eof(0x00), d_minimumLength(1), d_scanned(0)
+    {
+    }
+
+    void FramingBufferParser::setStartOfFrame(const std::vector<unsigned char>& sof)
+    {
+        d_sof = sof;
+        reset();
+    }
+
+    void FramingBufferParser::setLengthField(size_t offset, size_t size, bool bigEndian, int adjustment, size_t headerLength)
+    {
+        d_useLength = true;
+        d_lengthOffset = offset;
+        d_lengthSize = (size == 2) ? 2 : 1;
+        d_lengthBigEndian = bigEndian;
+        d_lengthAdjustment = adjustment;
+        d_headerLength = std::max(headerLength, offset + d_lengthSize);
+        reset();
+    }
+
+    void FramingBufferParser::setEndOfFrame(unsigned char eof, size_t minimumLength)
+    {
+        d_useLength = false;
+        d_eof = eof;
+        d_minimumLength = std::max<size_t>(minimumLength, 1);
+        reset();
+    }
+
+    void FramingBufferParser::setTrailerChecker(TrailerChecker checker)
+    {
+        d_trailerChecker = checker;
+    }
+
+    bool FramingBufferParser::checkXorTrailer(const FrameSpan& frame)
+    {
+        if (frame.empty())
+        {
+            return false;
+        }
+
+        unsigned char checksum = 0x00;
+        for (size_t i = 0; i < frame.size() - 1; ++i)
+        {
+            checksum ^= frame[i];
+        }
+        return checksum == frame[frame.size() - 1];
+    }
+
+    void FramingBufferParser::reset()
+    {
+        d_scanned = 0;
+    }
+
+    bool FramingBufferParser::synchronize(boost::circular_buffer<unsigned char>& circular_buffer)
+    {
+        if (d_sof.empty())
+        {
+            return true;
+        }
+
+        // Only the first byte of a start of frame can be safely dropped on mismatch.
+        size_t removeCount = 0;
+        while (removeCount < circular_buffer.size())
+        {
+            size_t i = 0;
+            while (i < d_sof.size() && removeCount + i < circular_buffer.size() && circular_buffer[removeCount + i] == d_sof[i])
+            {
+                ++i;
+            }
+            if (i == d_sof.size() || removeCount + i == circular_buffer.size())
+            {
+                break;
+            }
+            ++removeCount;
+        }
+
+        if (removeCount != 0)
+        {
+            LOG(LogLevel::DEBUGS) << "Remove noise length: " << removeCount;
+            circular_buffer.erase_begin(removeCount);
+            reset();
+        }
+        return circular_buffer.size() >= d_sof.size();
+    }
+
+    void FramingBufferParser::resynchronize(boost::circular_buffer<unsigned char>& circular_buffer)
+    {
+        circular_buffer.erase_begin(1);
+        reset();
+    }
+
+    FramingBufferParser::FrameStatus FramingBufferParser::parse(boost::circular_buffer<unsigned char>& circular_buffer, FrameSpan& frame)
+    {
+        // The ring was cleared or consumed by someone else.
+        if (d_scanned > circular_buffer.size())
+        {
+            reset();
+        }
+
+        while (synchronize(circular_buffer))
+        {
+            size_t frameLength = 0;
+            if (d_useLength)
+            {
+                if (circular_buffer.size() < d_headerLength)
+                {
+                    return FS_INCOMPLETE;
+                }
+
+                size_t length;
+                if (d_lengthSize == 2)
+                {
+                    unsigned char first = circular_buffer[d_lengthOffset], second = circular_buffer[d_lengthOffset + 1];
+                    length = d_lengthBigEndian ? ((first << 8) | second) : ((second << 8) | first);
+                }
+                else
+                {
+                    length = circular_buffer[d_lengthOffset];
+                }
+
+                long total = static_cast<long>(length) + d_lengthAdjustment;
+                if (total < static_cast<long>(d_headerLength))
+                {
+                    // Cannot be a frame, it would never complete.
+                    LOG(LogLevel::DEBUGS) << "Invalid frame length " << total << ", resynchronizing.";
+                    resynchronize(circular_buffer);
+                    continue;
+                }
+                if (static_cast<size_t>(total) > circular_buffer.size())
+                {
+                    return FS_INCOMPLETE;
+                }
+                frameLength = static_cast<size_t>(total);
+            }
+            else
+            {
+                size_t i = std::max(d_scanned, d_minimumLength - 1);
+                for (; i < circular_buffer.size() && circular_buffer[i] != d_eof; ++i);
+                if (i >= circular_buffer.size())
+                {
+                    d_scanned = std::max(d_scanned, circular_buffer.size());
+                    return FS_INCOMPLETE;
+                }
+                frameLength = i + 1;
+            }
+
+            frame = FrameSpan(circular_buffer, frameLength);
+            if (d_trailerChecker && !d_trailerChecker(frame))
+            {
+                return FS_BAD_TRAILER;
+            }
+            return FS_VALID;
+        }
+        return FS_INCOMPLETE;
+    }
+
+    void FramingBufferParser::consume(boost::circular_buffer<unsigned char>& circular_buffer, const FrameSpan& frame)
+    {
+        circular_buffer.erase_begin(std::min(frame.size(), circular_buffer.size()));
+        reset();
+    }
+
+    std::vector<unsigned char> FramingBufferParser::getValidBuffer(boost::circular_buffer<unsigned char>& circular_buffer)
+    {
+        std::vector<unsigned char> result;
+        FrameSpan frame;
+        FrameStatus status;
+
+        while ((status = parse(circular_buffer, frame)) == FS_BAD_TRAILER)
+        {
+            LOG(LogLevel::WARNINGS) << "Frame dropped, bad trailer: " << BufferHelper::getHex(frame.toVector());
+            consume(circular_buffer, frame);
+        }
+
+        if (status == FS_VALID)
+        {
+            // The only copy, the frame leaves the ring.
+            result = frame.toVector();
+            consume(circular_buffer, frame);
+        }
+        return result;
+    }
+}
@@ -0,0 +1,120 @@
+/**
+ * \file networkreactor.cpp
+ * \brief Shared event loop for the network data transports.
+ */
+
+#include "logicalaccess/readerproviders/networkreactor.hpp"
+#include "logicalaccess/logs.hpp"
+
+#include <algorithm>
+
+namespace logicalaccess
+{
+    NetworkReactor &NetworkReactor::getInstance()
+    {
+        static NetworkReactor instance;
+        return instance;
+    }
+
+    NetworkReactor::NetworkReactor()
+        : d_threadCount(2)
+    {
+    }
+
+    NetworkReactor::~NetworkReactor()
+    {
+        stop();
+    }
+
+    boost::asio::io_service &NetworkReactor::getIOService()
+    {
+        start();
+        return d_ios;
+    }
+
+    void NetworkReactor::setThreadCount(unsigned int threadCount)
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        d_threadCount = std::max(1u, threadCount);
+    }
+
+    unsigned int NetworkReactor::getThreadCount() const
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        return d_threadCount;
+    }
+
+    void NetworkReactor::start()
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        if (d_work)
+        {
+            return;
+        }
+
+        d_ios.reset();
+        d_work.reset(new boost::asio::io_service::work(d_ios));
+        for (unsigned int i = 0; i < d_threadCount; ++i)
+        {
+            d_threads.push_back(std::thread(&NetworkReactor::run, this));
+        }
+        LOG(LogLevel::INFOS) << "Network reactor started with " << d_threadCount << " threads.";
+    }
+
+    void NetworkReactor::stop()
+    {
+        std::vector<std::thread> threads;
+        {
+            std::lock_guard<std::mutex> lock(d_mutex);
+            // Without work, the threads leave once the pending operations are completed.
+            d_work.reset();
+            threads.swap(d_threads);
+        }
+        for (std::vector<std::thread>::iterator it = threads.begin(); it != threads.end(); ++it)
+        {
+            it->join();
+        }
+    }
+
+    void NetworkReactor::run()
+    {
+        while (true)
+        {
+            try
+            {
+                d_ios.run();
+                break;
+            }
+            catch (std::exception &ex)
+            {
+                LOG(LogLevel::ERRORS) << "Network reactor handler failed: " << ex.what();
+            }
+        }
+    }
+
+    PendingOperations::PendingOperations()
+        : d_count(0)
+    {
+    }
+
+    void PendingOperations::begin()
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        ++d_count;
+    }
+
+    void PendingOperations::end()
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        if (--d_count == 0)
+        {
+            d_cond.notify_all();
+        }
+    }
+
+    void PendingOperations::wait()
+    {
+        std::unique_lock<std::mutex> lock(d_mutex);
+        d_cond.wait(lock, [this]() { return d_count == 0; });
+    }
+}
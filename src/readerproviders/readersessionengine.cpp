@@ -0,0 +1,380 @@
+/**
+ * \file readersessionengine.cpp
+ * \brief Concurrent card session engine over several reader units.
+ */
+
+#include "logicalaccess/readerproviders/readersessionengine.hpp"
+#include "logicalaccess/cards/chip.hpp"
+#include "logicalaccess/myexception.hpp"
+#include "logicalaccess/logs.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+
+namespace logicalaccess
+{
+    ReaderSessionEngine::ReaderSessionEngine(unsigned int workerCount)
+        : d_workerCount(workerCount), d_pollInterval(500), d_waitRemoval(true), d_running(false), d_stopWorkers(false),
+        d_transactions(0), d_errors(0)
+    {
+    }
+
+    ReaderSessionEngine::~ReaderSessionEngine()
+    {
+        stop();
+    }
+
+    void ReaderSessionEngine::addReaderUnit(std::shared_ptr<ReaderUnit> readerUnit)
+    {
+        EXCEPTION_ASSERT_WITH_LOG(readerUnit, std::invalid_argument, "A reader unit must be specified.");
+
+        std::lock_guard<std::mutex> lock(d_mutex);
+        EXCEPTION_ASSERT_WITH_LOG(!findContext(readerUnit), std::invalid_argument, "The reader unit is already in the pool.");
+
+        std::shared_ptr<ReaderContext> context(new ReaderContext());
+        context->readerUnit = readerUnit;
+        context->scheduled = false;
+        if (d_running)
+        {
+            context->detector = std::thread(&ReaderSessionEngine::detect, this, context);
+        }
+        d_readers.push_back(context);
+    }
+
+    std::vector<std::shared_ptr<ReaderUnit> > ReaderSessionEngine::getReaderUnits() const
+    {
+        std::vector<std::shared_ptr<ReaderUnit> > readerUnits;
+        std::lock_guard<std::mutex> lock(d_mutex);
+        for (std::vector<std::shared_ptr<ReaderContext> >::const_iterator it = d_readers.cbegin(); it != d_readers.cend(); ++it)
+        {
+            readerUnits.push_back((*it)->readerUnit);
+        }
+        return readerUnits;
+    }
+
+    void ReaderSessionEngine::setCardJob(CardSessionJob job)
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        d_cardJob = job;
+    }
+
+    void ReaderSessionEngine::setErrorHandler(ReaderSessionErrorHandler handler)
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        d_errorHandler = handler;
+    }
+
+    void ReaderSessionEngine::setPollInterval(unsigned int pollInterval)
+    {
+        d_pollInterval = (pollInterval > 0) ? pollInterval : 1;
+    }
+
+    void ReaderSessionEngine::setWaitRemoval(bool waitRemoval)
+    {
+        d_waitRemoval = waitRemoval;
+    }
+
+    void ReaderSessionEngine::start()
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        if (d_running)
+        {
+            return;
+        }
+
+        d_running = true;
+        d_stopWorkers = false;
+        unsigned int workerCount = (d_workerCount > 0) ? d_workerCount : std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int i = 0; i < workerCount; ++i)
+        {
+            d_workers.push_back(std::thread(&ReaderSessionEngine::work, this));
+        }
+        for (std::vector<std::shared_ptr<ReaderContext> >::iterator it = d_readers.begin(); it != d_readers.end(); ++it)
+        {
+            (*it)->detector = std::thread(&ReaderSessionEngine::detect, this, *it);
+        }
+    }
+
+    void ReaderSessionEngine::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(d_mutex);
+            if (!d_running.exchange(false))
+            {
+                return;
+            }
+        }
+        d_idle.notify_all();
+
+        // Detection threads wait for their running session, workers must still be up.
+        std::vector<std::shared_ptr<ReaderContext> > readers;
+        {
+            std::lock_guard<std::mutex> lock(d_mutex);
+            readers = d_readers;
+        }
+        for (std::vector<std::shared_ptr<ReaderContext> >::iterator it = readers.begin(); it != readers.end(); ++it)
+        {
+            if ((*it)->detector.joinable())
+            {
+                (*it)->detector.join();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(d_mutex);
+            d_stopWorkers = true;
+        }
+        d_cond.notify_all();
+        for (std::vector<std::thread>::iterator it = d_workers.begin(); it != d_workers.end(); ++it)
+        {
+            it->join();
+        }
+        d_workers.clear();
+    }
+
+    bool ReaderSessionEngine::isRunning() const
+    {
+        return d_running;
+    }
+
+    void ReaderSessionEngine::post(std::shared_ptr<ReaderUnit> readerUnit, ReaderSessionJob job)
+    {
+        bool notify;
+        {
+            // Checked under the lock stop() takes before stopping the workers, so an accepted job always runs.
+            std::lock_guard<std::mutex> lock(d_mutex);
+            std::shared_ptr<ReaderContext> context = findContext(readerUnit);
+            EXCEPTION_ASSERT_WITH_LOG(context, std::invalid_argument, "The reader unit is not in the pool.");
+            EXCEPTION_ASSERT_WITH_LOG(d_running, LibLogicalAccessException, "The reader session engine is not running.");
+
+            notify = schedule(context, [readerUnit, job]() { job(readerUnit); });
+        }
+        if (notify)
+        {
+            d_cond.notify_one();
+        }
+    }
+
+    uint64_t ReaderSessionEngine::getTransactionCount() const
+    {
+        return d_transactions;
+    }
+
+    uint64_t ReaderSessionEngine::getErrorCount() const
+    {
+        return d_errors;
+    }
+
+    std::shared_ptr<ReaderSessionEngine::ReaderContext> ReaderSessionEngine::findContext(std::shared_ptr<ReaderUnit> readerUnit) const
+    {
+        for (std::vector<std::shared_ptr<ReaderContext> >::const_iterator it = d_readers.cbegin(); it != d_readers.cend(); ++it)
+        {
+            if ((*it)->readerUnit == readerUnit)
+            {
+                return *it;
+            }
+        }
+        return std::shared_ptr<ReaderContext>();
+    }
+
+    bool ReaderSessionEngine::schedule(std::shared_ptr<ReaderContext> context, std::function<void()> task)
+    {
+        context->pending.push_back(task);
+        if (context->scheduled)
+        {
+            // A worker is running this reader, it picks the task when done.
+            return false;
+        }
+        context->scheduled = true;
+        d_ready.push_back(context);
+        return true;
+    }
+
+    void ReaderSessionEngine::enqueue(std::shared_ptr<ReaderContext> context, std::function<void()> task)
+    {
+        bool notify;
+        {
+            std::lock_guard<std::mutex> lock(d_mutex);
+            notify = schedule(context, task);
+        }
+        if (notify)
+        {
+            d_cond.notify_one();
+        }
+    }
+
+    void ReaderSessionEngine::runCardSession(std::shared_ptr<ReaderContext> context)
+    {
+        std::shared_ptr<ReaderUnit> readerUnit = context->readerUnit;
+        CardSessionJob job;
+        {
+            std::lock_guard<std::mutex> lock(d_mutex);
+            job = d_cardJob;
+        }
+
+        if (!readerUnit->connect())
+        {
+            THROW_EXCEPTION_WITH_LOG(CardException, "Cannot connect to the card.");
+        }
+
+        try
+        {
+            std::shared_ptr<Chip> chip = readerUnit->getSingleChip();
+            if (job)
+            {
+                job(readerUnit, chip);
+            }
+        }
+        catch (...)
+        {
+            readerUnit->disconnect();
+            throw;
+        }
+        readerUnit->disconnect();
+        ++d_transactions;
+    }
+
+    void ReaderSessionEngine::reportError(std::shared_ptr<ReaderUnit> readerUnit, const std::exception& ex)
+    {
+        ++d_errors;
+        LOG(LogLevel::ERRORS) << "Reader session job failed on " << readerUnit->getName() << ": " << ex.what();
+
+        ReaderSessionErrorHandler handler;
+        {
+            std::lock_guard<std::mutex> lock(d_mutex);
+            handler = d_errorHandler;
+        }
+        if (handler)
+        {
+            handler(readerUnit, ex);
+        }
+    }
+
+    void ReaderSessionEngine::runInQueue(std::shared_ptr<ReaderContext> context, std::function<void()> task)
+    {
+        std::shared_ptr<std::promise<void> > done(new std::promise<void>());
+        std::future<void> result = done->get_future();
+        enqueue(context, [task, done]()
+        {
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                done->set_exception(std::current_exception());
+                return;
+            }
+            done->set_value();
+        });
+        result.get();
+    }
+
+    bool ReaderSessionEngine::poll(std::shared_ptr<ReaderContext> context, bool insertion)
+    {
+        {
+            // The queued jobs of the reader go first.
+            std::unique_lock<std::mutex> lock(d_mutex);
+            d_idle.wait(lock, [this, context]() { return !context->scheduled || !d_running; });
+        }
+        if (!d_running)
+        {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> unitLock(context->unitMutex);
+        return insertion ? context->readerUnit->waitInsertion(d_pollInterval) : context->readerUnit->waitRemoval(d_pollInterval);
+    }
+
+    void ReaderSessionEngine::detect(std::shared_ptr<ReaderContext> context)
+    {
+        // The blocking polls run here and never hold a worker, only the card sessions are queued.
+        std::shared_ptr<ReaderUnit> readerUnit = context->readerUnit;
+        while (d_running)
+        {
+            try
+            {
+                if (!poll(context, true))
+                {
+                    continue;
+                }
+
+                try
+                {
+                    runInQueue(context, [this, context]() { runCardSession(context); });
+                }
+                catch (std::exception& ex)
+                {
+                    reportError(readerUnit, ex);
+                }
+                catch (...)
+                {
+                    reportError(readerUnit, LibLogicalAccessException("Unknown error."));
+                }
+
+                bool removed = !d_waitRemoval;
+                while (!removed && d_running)
+                {
+                    removed = poll(context, false);
+                }
+            }
+            catch (std::exception& ex)
+            {
+                reportError(readerUnit, ex);
+                std::this_thread::sleep_for(std::chrono::milliseconds(d_pollInterval));
+            }
+            catch (...)
+            {
+                reportError(readerUnit, LibLogicalAccessException("Unknown error."));
+                std::this_thread::sleep_for(std::chrono::milliseconds(d_pollInterval));
+            }
+        }
+    }
+
+    void ReaderSessionEngine::work()
+    {
+        std::unique_lock<std::mutex> lock(d_mutex);
+        while (true)
+        {
+            d_cond.wait(lock, [this]() { return !d_ready.empty() || d_stopWorkers; });
+            if (d_ready.empty())
+            {
+                break;
+            }
+
+            std::shared_ptr<ReaderContext> context = d_ready.front();
+            d_ready.pop_front();
+            std::function<void()> task = context->pending.front();
+            context->pending.pop_front();
+
+            lock.unlock();
+            try
+            {
+                std::lock_guard<std::mutex> unitLock(context->unitMutex);
+                task();
+            }
+            catch (std::exception& ex)
+            {
+                reportError(context->readerUnit, ex);
+            }
+            catch (...)
+            {
+                reportError(context->readerUnit, LibLogicalAccessException("Unknown error."));
+            }
+            lock.lock();
+
+            // Let the other readers run before the next job of this one.
+            if (!context->pending.empty())
+            {
+                d_ready.push_back(context);
+                d_cond.notify_one();
+            }
+            else
+            {
+                context->scheduled = false;
+                d_idle.notify_all();
+            }
+        }
+    }
+}
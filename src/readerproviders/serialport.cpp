@@ -14,6 +14,8 @@
 #include <boost/bind/bind.hpp>
 #include "logicalaccess/logs.hpp"
 
+#include <algorithm>
+
 namespace logicalaccess
 {
     SerialPort::SerialPort() :
@@ -22,14 +24,14 @@ namespace logicalaccess
 #else
         m_dev("COM1"),
 #endif
-        m_serial_port(m_io), m_circular_read_buffer(256), m_read_buffer(128),
-        data_flag_(false)
+        m_io(SerialPortReactor::getInstance().getIOService()), m_serial_port(m_io), m_circular_read_buffer(256),
+        m_read_buffer_high_water_mark(65536), m_read_buffer(4096), data_flag_(false)
     {
     }
 
     SerialPort::SerialPort(const std::string& dev)
-        : m_dev(dev), m_serial_port(m_io), m_circular_read_buffer(256), m_read_buffer(128),
-          data_flag_(false)
+        : m_dev(dev), m_io(SerialPortReactor::getInstance().getIOService()), m_serial_port(m_io), m_circular_read_buffer(256),
+          m_read_buffer_high_water_mark(65536), m_read_buffer(4096), data_flag_(false)
     {
     }
 
@@ -40,46 +42,72 @@ namespace logicalaccess
         if (m_serial_port.is_open())
             return;
 
+        // Starts the reactor thread again if it was stopped.
+        SerialPortReactor::getInstance().getIOService();
         m_serial_port.open(m_dev);
 
         if (!m_serial_port.is_open())
             THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "Can't find the serial port.");
 
-        if (!m_thread_reader)
-        {
-            data_flag_ = false;
-
-            m_serial_port.async_read_some(boost::asio::buffer(m_read_buffer),
-                boost::bind(&SerialPort::do_read, this, boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
-            m_thread_reader.reset(new std::thread(boost::bind(&boost::asio::io_service::run, &m_io)));
-        }
+        data_flag_ = false;
+        SerialPortReactor::getInstance().addPort(this);
+        start_read();
     }
 
     void SerialPort::reopen()
     {
-        m_serial_port.close();
-        m_serial_port.open(m_dev);
+        close();
+        open();
     }
 
     void SerialPort::close()
     {
-        m_io.post(boost::bind(&SerialPort::do_close, this, boost::system::error_code()));
-        if (m_thread_reader)
-            m_thread_reader->join();
+        SerialPortReactor &reactor = SerialPortReactor::getInstance();
+        reactor.removePort(this);
+        if (reactor.isReactorThread())
+        {
+            do_close(boost::system::error_code());
+        }
+        else
+        {
+            // The read loop stops once the port is closed.
+            m_pending.begin();
+            std::function<void()> handler = [this]()
+            {
+                do_close(boost::system::error_code());
+                m_pending.end();
+            };
+            // A stopped reactor already closed the port, or has no thread left to run the handler.
+            if (!reactor.post(handler))
+                handler();
+            m_pending.wait();
+        }
 
-        m_io.reset();
-        m_thread_reader.reset();
+        std::unique_lock<std::mutex> ul(cond_var_mutex_);
         m_circular_read_buffer.clear();
-        m_read_buffer.clear();
-        m_read_buffer.resize(128);
+        m_frames.clear();
         m_write_buffer.clear();
+        m_writing_buffer.clear();
+        data_flag_ = false;
     }
 
     void SerialPort::do_close(const boost::system::error_code& error)
     {
         if (m_serial_port.is_open())
         {
-            m_serial_port.close();
+            boost::system::error_code ignored;
+            m_serial_port.close(ignored);
+        }
+    }
+
+    void SerialPort::setReadBufferHighWaterMark(size_t highWaterMark)
+    {
+        std::unique_lock<std::mutex> ul(cond_var_mutex_);
+        m_read_buffer_high_water_mark = std::max<size_t>(highWaterMark, 1);
+        if (m_circular_read_buffer.capacity() > m_read_buffer_high_water_mark)
+        {
+            // Keep the latest data.
+            m_circular_read_buffer.rset_capacity(m_read_buffer_high_water_mark);
         }
     }
 
@@ -148,75 +176,153 @@ namespace logicalaccess
 
         if (m_circular_buffer_parser)
         {
-            buf = m_circular_buffer_parser->getValidBuffer(m_circular_read_buffer);
+            // Data received before the parser was set.
+            extract_frames();
+            if (m_frames.empty())
+            {
+                buf.clear();
+            }
+            else
+            {
+                buf.swap(m_frames.front());
+                m_frames.pop_front();
+            }
+            data_flag_ = !m_frames.empty();
         }
         else
         {
             buf.assign(m_circular_read_buffer.begin(), m_circular_read_buffer.end());
             m_circular_read_buffer.clear();
+            data_flag_ = false;
             LOG(LogLevel::COMS) << "Use data read: " << BufferHelper::getHex(buf) << " Size: " << buf.size();
         }
 
         return buf.size();
     }
 
+    void SerialPort::start_read()
+    {
+        m_pending.begin();
+        m_serial_port.async_read_some(boost::asio::buffer(m_read_buffer), boost::bind(&SerialPort::do_read,
+            this, boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+    }
+
     void SerialPort::do_read(const boost::system::error_code& error, const std::size_t bytes_transferred)
     {
         if (error == boost::asio::error::operation_aborted)
         {
             LOG(DEBUGS) << "Read aborted: " << error.message();
+            m_pending.end();
             return;
         }
-        if (error == boost::asio::error::eof)
+        if (error)
         {
-            LOG(DEBUGS) << "Read errored (EOF)";
+            LOG(DEBUGS) << "Read errored: " << error.message();
             do_close(error);
+            m_pending.end();
             return;
         }
 
-        cond_var_mutex_.lock();
-        if (m_circular_read_buffer.reserve() < bytes_transferred)
-        {
-            LOG(LogLevel::WARNINGS) << "Buffer Overflow, Size: " << m_circular_read_buffer.size()
-                << " reserve: " << m_circular_read_buffer.reserve()
-                << " bytes transferred: " << bytes_transferred;
-            m_circular_read_buffer.clear();
-        }
-        m_circular_read_buffer.insert(m_circular_read_buffer.end(), m_read_buffer.begin(), m_read_buffer.begin() + bytes_transferred);
-
         LOG(LogLevel::INFOS) << "Data read: "
             << BufferHelper::getHex(std::vector<unsigned char>(m_read_buffer.begin(), m_read_buffer.begin() + bytes_transferred))
             << " Size: " << bytes_transferred;
 
-        data_flag_ = true;
-        cond_var_mutex_.unlock();
-        cond_var_.notify_all();
+        bool available;
+        {
+            std::unique_lock<std::mutex> ul(cond_var_mutex_);
+            buffer_data(&m_read_buffer[0], bytes_transferred);
+            if (m_circular_buffer_parser)
+            {
+                extract_frames();
+                available = !m_frames.empty();
+            }
+            else
+            {
+                available = !m_circular_read_buffer.empty();
+            }
+            if (available)
+            {
+                data_flag_ = true;
+            }
+        }
+        if (available)
+        {
+            cond_var_.notify_all();
+        }
 
         // start the next read
         m_serial_port.async_read_some(boost::asio::buffer(m_read_buffer), boost::bind(&SerialPort::do_read,
             this, boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
     }
 
+    void SerialPort::buffer_data(const unsigned char* data, std::size_t length)
+    {
+        if (m_circular_read_buffer.reserve() < length && m_circular_read_buffer.capacity() < m_read_buffer_high_water_mark)
+        {
+            size_t capacity = std::max(m_circular_read_buffer.capacity() * 2, m_circular_read_buffer.size() + length);
+            m_circular_read_buffer.set_capacity(std::min(capacity, m_read_buffer_high_water_mark));
+        }
+        if (m_circular_read_buffer.reserve() < length)
+        {
+            LOG(LogLevel::WARNINGS) << "Buffer Overflow, Size: " << m_circular_read_buffer.size()
+                << " high-water mark: " << m_read_buffer_high_water_mark
+                << " bytes transferred: " << length << ". Discarding the oldest data.";
+        }
+        // A full ring buffer overwrites the oldest data.
+        m_circular_read_buffer.insert(m_circular_read_buffer.end(), data, data + length);
+    }
+
+    void SerialPort::extract_frames()
+    {
+        while (m_circular_buffer_parser && !m_circular_read_buffer.empty())
+        {
+            size_t size = m_circular_read_buffer.size();
+            std::vector<unsigned char> frame = m_circular_buffer_parser->getValidBuffer(m_circular_read_buffer);
+            if (!frame.empty())
+            {
+                m_frames.push_back(frame);
+            }
+            else if (m_circular_read_buffer.size() == size)
+            {
+                // The frame is not complete yet.
+                break;
+            }
+        }
+    }
+
     size_t SerialPort::write(const std::vector<unsigned char>& buf)
     {
         EXCEPTION_ASSERT(isOpen(), LibLogicalAccessException, "Cannot write on a closed device");
 
-        m_io.post(boost::bind(&SerialPort::do_write, this, buf));
+        m_pending.begin();
+        std::function<void()> handler = [this, buf]()
+        {
+            do_write(buf);
+            m_pending.end();
+        };
+        // A stopped reactor closed the port: the write is dropped.
+        if (!SerialPortReactor::getInstance().post(handler))
+            handler();
         return buf.size();
     }
 
     void SerialPort::do_write(const ByteVector& buf)
     {
-        bool running = !m_write_buffer.empty();
+        if (!m_serial_port.is_open())
+            return;
+
         m_write_buffer.insert(m_write_buffer.end(), buf.begin(), buf.end());
-        if (!running)
+        if (m_writing_buffer.empty())
             write_start();
     }
 
     void SerialPort::write_start()
     {
+        // The data being written must not move while queuing more.
+        m_writing_buffer.swap(m_write_buffer);
+        m_pending.begin();
         boost::asio::async_write(m_serial_port,
-            boost::asio::buffer(m_write_buffer),
+            boost::asio::buffer(m_writing_buffer),
             boost::bind(&SerialPort::write_complete,
             this, boost::asio::placeholders::error,
             boost::asio::placeholders::bytes_transferred));
@@ -224,14 +330,18 @@ namespace logicalaccess
 
     void SerialPort::write_complete(const boost::system::error_code& error, const std::size_t bytes_transferred)
     {
+        m_writing_buffer.clear();
         if (!error)
         { // write completed, so send next write data
-            m_write_buffer.erase(m_write_buffer.begin(), m_write_buffer.begin() + bytes_transferred);
             if (!m_write_buffer.empty())
                 write_start();
         }
         else
+        {
+            m_write_buffer.clear();
             do_close(error);
+        }
+        m_pending.end();
     }
 
     bool SerialPort::isOpen()
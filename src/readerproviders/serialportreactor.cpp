@@ -0,0 +1,113 @@
+/**
+ * \file serialportreactor.cpp
+ * \brief Shared event loop for the serial ports.
+ */
+
+#include "logicalaccess/readerproviders/serialportreactor.hpp"
+#include "logicalaccess/readerproviders/serialport.hpp"
+#include "logicalaccess/logs.hpp"
+
+namespace logicalaccess
+{
+    SerialPortReactor &SerialPortReactor::getInstance()
+    {
+        static SerialPortReactor instance;
+        return instance;
+    }
+
+    SerialPortReactor::SerialPortReactor()
+    {
+    }
+
+    SerialPortReactor::~SerialPortReactor()
+    {
+        stop();
+    }
+
+    boost::asio::io_service &SerialPortReactor::getIOService()
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        if (!d_work)
+        {
+            if (d_thread.joinable())
+            {
+                d_thread.join();
+            }
+            d_ios.reset();
+            d_work.reset(new boost::asio::io_service::work(d_ios));
+            d_thread = std::thread(&SerialPortReactor::run, this);
+            LOG(LogLevel::INFOS) << "Serial port reactor started.";
+        }
+        return d_ios;
+    }
+
+    void SerialPortReactor::stop()
+    {
+        std::thread thread;
+        {
+            std::lock_guard<std::mutex> lock(d_mutex);
+            if (!d_work)
+                return;
+
+            // Without work, the thread leaves once the pending operations are completed. The reads of
+            // the open ports never complete by themselves, closing the ports aborts them.
+            std::set<SerialPort *> ports;
+            ports.swap(d_ports);
+            d_ios.post([ports]()
+            {
+                for (SerialPort *port : ports)
+                    port->do_close(boost::system::error_code());
+            });
+            d_work.reset();
+            thread.swap(d_thread);
+        }
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+
+    bool SerialPortReactor::post(std::function<void()> handler)
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        if (!d_work)
+            return false;
+
+        d_ios.post(handler);
+        return true;
+    }
+
+    void SerialPortReactor::addPort(SerialPort *port)
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        d_ports.insert(port);
+    }
+
+    void SerialPortReactor::removePort(SerialPort *port)
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        d_ports.erase(port);
+    }
+
+    bool SerialPortReactor::isReactorThread() const
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        return d_thread.get_id() == std::this_thread::get_id();
+    }
+
+    void SerialPortReactor::run()
+    {
+        while (true)
+        {
+            try
+            {
+                d_ios.run();
+                break;
+            }
+            catch (std::exception &ex)
+            {
+                LOG(LogLevel::ERRORS) << "Serial port reactor handler failed: " << ex.what();
+            }
+        }
+    }
+}
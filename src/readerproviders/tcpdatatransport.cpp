@@ -16,14 +16,18 @@
 #include <boost/property_tree/ptree.hpp>
 #include "logicalaccess/settings.hpp"
 
+#include <future>
+
 namespace logicalaccess
 {
-	TcpDataTransport::TcpDataTransport() : d_socket(d_ios), d_timer(d_ios), d_read_error(true), d_bytes_transferred(0), d_ipAddress("127.0.0.1"), d_port(9559)
+	TcpDataTransport::TcpDataTransport() : d_ios(NetworkReactor::getInstance().getIOService()), d_strand(d_ios), d_socket(d_ios), d_timer(d_ios),
+        d_recvBuffer(256), d_ipAddress("127.0.0.1"), d_port(9559)
     {
     }
 
     TcpDataTransport::~TcpDataTransport()
     {
+        cancelOperations();
     }
 
     std::string TcpDataTransport::getIpAddress() const
@@ -53,40 +57,77 @@ namespace logicalaccess
 
     bool TcpDataTransport::connect(long int timeout)
     {
-		if (d_socket.is_open())
-            d_socket.close();
+        std::shared_ptr<std::promise<boost::system::error_code> > connected(new std::promise<boost::system::error_code>());
+        std::future<boost::system::error_code> result = connected->get_future();
+        asyncConnect(timeout, [connected](const boost::system::error_code& error) { connected->set_value(error); });
 
-        try
+        boost::system::error_code error = result.get();
+        if (error)
+        {
+            LOG(LogLevel::ERRORS) << "Cannot establish connection on " << getIpAddress() << ":" << getPort() << " : " << error.message();
+            disconnect();
+        }
+        else
         {
-			d_ios.reset();
-			d_timer.expires_from_now(boost::posix_time::milliseconds(timeout));
-			d_timer.async_wait(boost::bind(&TcpDataTransport::time_out,
-                                this, boost::asio::placeholders::error));
+            LOG(LogLevel::INFOS) << "Connected to " << getIpAddress() << " on port " << getPort() << ".";
+        }
 
-			boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address::from_string(getIpAddress()), getPort());
-			d_socket.async_connect(endpoint, boost::bind(&TcpDataTransport::connect_complete,
-                                this, boost::asio::placeholders::error));
+		return isConnected();
+    }
 
-			d_ios.run();
+    void TcpDataTransport::asyncConnect(long int timeout, std::function<void(const boost::system::error_code&)> handler)
+    {
+        d_pending.begin();
+        d_strand.dispatch([this, timeout, handler]()
+        {
+            boost::system::error_code error;
+            if (d_socket.is_open())
+                d_socket.close(error);
 
-			if (d_read_error)
-				d_socket.close();
+            boost::asio::ip::address address = boost::asio::ip::address::from_string(getIpAddress(), error);
+            if (error)
+            {
+                handler(error);
+                d_pending.end();
+                return;
+            }
 
-            LOG(LogLevel::INFOS) << "Connected to " << getIpAddress() << " on port " << getPort() << ".";
-        }
-        catch (boost::system::system_error& ex)
-        {
-            LOG(LogLevel::ERRORS) << "Cannot establish connection on " << getIpAddress() << ":" << getPort() << " : " << ex.what();
-			disconnect();
-        }
+            std::shared_ptr<bool> done(new bool(false));
+            d_pending.begin();
+            d_timer.expires_from_now(boost::posix_time::milliseconds(timeout));
+            d_timer.async_wait(d_strand.wrap([this, done](const boost::system::error_code& error)
+            {
+                if (!error && !*done)
+                {
+                    boost::system::error_code ignored;
+                    d_socket.close(ignored);
+                }
+                d_pending.end();
+            }));
 
-		return bool(d_socket.is_open());
+            d_pending.begin();
+            d_socket.async_connect(boost::asio::ip::tcp::endpoint(address, getPort()), d_strand.wrap([this, done, handler](const boost::system::error_code& error)
+            {
+                *done = true;
+                boost::system::error_code ignored;
+                d_timer.cancel(ignored);
+                if (error)
+                    d_socket.close(ignored);
+                handler(error);
+                d_pending.end();
+            }));
+            d_pending.end();
+        });
     }
 
     void TcpDataTransport::disconnect()
     {
 		LOG(LogLevel::INFOS) << getIpAddress() << ":" << getPort() << "Disconnected.";
-        d_socket.close();
+        runOnStrand([this]()
+        {
+            boost::system::error_code ignored;
+            d_socket.close(ignored);
+        });
     }
 
     bool TcpDataTransport::isConnected()
@@ -118,55 +159,181 @@ namespace logicalaccess
         }
     }
 
-	void TcpDataTransport::connect_complete(const boost::system::error_code& error)
-	{
-		d_read_error = (error != 0);
-        d_timer.cancel();
+    std::vector<unsigned char> TcpDataTransport::receive(long int timeout)
+    {
+        std::shared_ptr<std::promise<std::vector<unsigned char> > > received(new std::promise<std::vector<unsigned char> >());
+        std::future<std::vector<unsigned char> > result = received->get_future();
+        TcpDataTransport::asyncReceive(timeout, [received](std::exception_ptr error, const std::vector<unsigned char>& data)
+        {
+            if (error)
+                received->set_exception(error);
+            else
+                received->set_value(data);
+        });
+
+        return result.get();
     }
 
-    void TcpDataTransport::read_complete(const boost::system::error_code& error, size_t bytes_transferred)
-	{
-        d_read_error = (error || bytes_transferred == 0);
-		d_bytes_transferred = bytes_transferred;
-        d_timer.cancel();
+    void TcpDataTransport::asyncReceive(long int timeout, ReceiveHandler handler)
+    {
+        d_pending.begin();
+        d_strand.dispatch([this, timeout, handler]()
+        {
+            std::shared_ptr<bool> done(new bool(false));
+            d_pending.begin();
+            d_timer.expires_from_now(boost::posix_time::milliseconds(timeout));
+            d_timer.async_wait(d_strand.wrap([this, done](const boost::system::error_code& error)
+            {
+                if (!error && !*done)
+                {
+                    boost::system::error_code ignored;
+                    d_socket.cancel(ignored);
+                }
+                d_pending.end();
+            }));
+
+            d_pending.begin();
+            d_socket.async_receive(boost::asio::buffer(d_recvBuffer), d_strand.wrap([this, done, timeout, handler](const boost::system::error_code& error, size_t bytes_transferred)
+            {
+                *done = true;
+                boost::system::error_code ignored;
+                d_timer.cancel(ignored);
+
+                if (error || bytes_transferred == 0)
+                {
+                    char buf[64];
+                    sprintf(buf, "Socket receive timeout (> %ld milliseconds).", timeout);
+                    LOG(LogLevel::ERRORS) << buf;
+                    handler(std::make_exception_ptr(LibLogicalAccessException(buf)), std::vector<unsigned char>());
+                }
+                else
+                {
+                    std::vector<unsigned char> recv(d_recvBuffer.begin(), d_recvBuffer.begin() + bytes_transferred);
+                    LOG(LogLevel::COMS) << "TCP Data read: " << BufferHelper::getHex(recv);
+                    handler(std::exception_ptr(), recv);
+                }
+                d_pending.end();
+            }));
+            d_pending.end();
+        });
     }
- 
-    void TcpDataTransport::time_out(const boost::system::error_code& error)
-	{
-        if (error) 
+
+    void TcpDataTransport::asyncSend(const std::vector<unsigned char>& data, SendHandler handler)
+    {
+        if (data.size() == 0)
+        {
+            handler(std::exception_ptr());
             return;
-        d_socket.cancel();
+        }
+
+        LOG(LogLevel::COMS) << "TCP Send Data: " << BufferHelper::getHex(data);
+        std::shared_ptr<std::vector<unsigned char> > buffer(new std::vector<unsigned char>(data));
+        d_pending.begin();
+        boost::asio::async_write(d_socket, boost::asio::buffer(*buffer), d_strand.wrap([this, buffer, handler](const boost::system::error_code& error, size_t)
+        {
+            if (error)
+            {
+                LOG(LogLevel::ERRORS) << "Cannot send on " << getIpAddress() << ":" << getPort() << " : " << error.message();
+                boost::system::error_code ignored;
+                d_socket.close(ignored);
+                handler(std::make_exception_ptr(boost::system::system_error(error)));
+            }
+            else
+            {
+                handler(std::exception_ptr());
+            }
+            d_pending.end();
+        }));
     }
 
-    std::vector<unsigned char> TcpDataTransport::receive(long int timeout)
+    void TcpDataTransport::asyncSendCommand(const std::vector<unsigned char>& command, long int timeout, DataTransportCallback callback)
+    {
+        if (timeout == -1)
+            timeout = Settings::getInstance()->DataTransportTimeout;
+
+        LOG(LogLevel::COMS) << "Sending asynchronous command " << BufferHelper::getHex(command) << " command size {" << command.size() << "} timeout {" << timeout << "}...";
+
+        d_lastCommand = command;
+        d_lastResult.clear();
+
+        ReceiveHandler complete = [this, callback](std::exception_ptr error, const std::vector<unsigned char>& res)
+        {
+            if (!error)
+            {
+                d_lastResult = res;
+                LOG(LogLevel::COMS) << "Response received successfully ! Response: " << BufferHelper::getHex(res) << " size {" << res.size() << "}";
+            }
+            callback(res, error);
+        };
+        std::function<void()> transmit = [this, command, timeout, complete]()
+        {
+            asyncSend(command, [this, timeout, complete](std::exception_ptr error)
+            {
+                if (error)
+                {
+                    complete(error, std::vector<unsigned char>());
+                    return;
+                }
+                asyncReceive(timeout, complete);
+            });
+        };
+
+        // Unlike sendCommand, an opened connection is reused.
+        if (command.size() == 0 || isConnected())
+        {
+            d_pending.begin();
+            d_strand.dispatch([this, transmit]()
+            {
+                transmit();
+                d_pending.end();
+            });
+        }
+        else
+        {
+            asyncConnect(timeout, [this, transmit, complete](const boost::system::error_code& error)
+            {
+                if (error)
+                {
+                    LOG(LogLevel::ERRORS) << "Cannot establish connection on " << getIpAddress() << ":" << getPort() << " : " << error.message();
+                    complete(std::make_exception_ptr(LibLogicalAccessException("Cannot establish connection on " + getIpAddress() + ".")), std::vector<unsigned char>());
+                }
+                else
+                {
+                    transmit();
+                }
+            });
+        }
+    }
+
+    void TcpDataTransport::cancelOperations()
     {
-		std::vector<unsigned char> recv(256);
-		d_ios.reset();
-		d_bytes_transferred = 0;
- 
-		d_ios.reset();
-		d_socket.async_receive(boost::asio::buffer(recv),
-                boost::bind(&TcpDataTransport::read_complete,
-                        this,
-                        boost::asio::placeholders::error,
-                        boost::asio::placeholders::bytes_transferred));
- 
-        d_timer.expires_from_now(boost::posix_time::milliseconds(timeout));
-        d_timer.async_wait(boost::bind(&TcpDataTransport::time_out,
-                                this, boost::asio::placeholders::error));
- 
-		d_ios.run();
-
-		recv.resize(d_bytes_transferred);
-		if (d_read_error || recv.size() == 0)
-		{
-            char buf[64];
-            sprintf(buf, "Socket receive timeout (> %ld milliseconds).", timeout);
-            THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, buf);
+        runOnStrand([this]()
+        {
+            boost::system::error_code ignored;
+            d_socket.cancel(ignored);
+            d_timer.cancel(ignored);
+        });
+        d_pending.wait();
+    }
+
+    void TcpDataTransport::runOnStrand(std::function<void()> task)
+    {
+        if (d_strand.running_in_this_thread())
+        {
+            task();
+            return;
         }
 
-        LOG(LogLevel::COMS) << "TCP Data read: " << BufferHelper::getHex(recv);
-		return recv;
+        std::shared_ptr<std::promise<void> > done(new std::promise<void>());
+        std::future<void> result = done->get_future();
+        d_pending.begin();
+        d_strand.dispatch([this, task, done]()
+        {
+            task();
+            done->set_value();
+            d_pending.end();
+        });
+        result.wait();
     }
 
     void TcpDataTransport::serialize(boost::property_tree::ptree& parentNode)
@@ -6,21 +6,36 @@
 
 #include "logicalaccess/readerproviders/udpdatatransport.hpp"
 #include "logicalaccess/cards/readercardadapter.hpp"
+#include "logicalaccess/bufferhelper.hpp"
+#include "logicalaccess/logs.hpp"
+#include "logicalaccess/myexception.hpp"
+#include "logicalaccess/settings.hpp"
 
 #include <boost/foreach.hpp>
 #include <boost/optional.hpp>
 #include <boost/array.hpp>
 #include <boost/property_tree/ptree.hpp>
-#include <thread>
+#include <future>
 
 namespace logicalaccess
 {
-    UdpDataTransport::UdpDataTransport() : d_ipAddress("127.0.0.1"), d_port(9559)
+    UdpDataTransport::UdpDataTransport() : ios(NetworkReactor::getInstance().getIOService()), d_strand(ios), d_timer(ios), d_recvBuffer(128),
+        d_ipAddress("127.0.0.1"), d_port(9559)
     {
     }
 
     UdpDataTransport::~UdpDataTransport()
     {
+        d_pending.begin();
+        d_strand.dispatch([this]()
+        {
+            boost::system::error_code ignored;
+            d_timer.cancel(ignored);
+            if (d_socket)
+                d_socket->cancel(ignored);
+            d_pending.end();
+        });
+        d_pending.wait();
     }
 
     std::string UdpDataTransport::getIpAddress() const
@@ -70,10 +85,18 @@ namespace logicalaccess
 
     void UdpDataTransport::disconnect()
     {
-        if (d_socket)
+        std::shared_ptr<boost::asio::ip::udp::socket> socket = d_socket;
+        d_socket.reset();
+        if (socket)
         {
-            d_socket->close();
-            d_socket.reset();
+            // A pending receive may still use the socket.
+            d_pending.begin();
+            d_strand.dispatch([this, socket]()
+            {
+                boost::system::error_code ignored;
+                socket->close(ignored);
+                d_pending.end();
+            });
         }
     }
 
@@ -98,29 +121,141 @@ namespace logicalaccess
 
     std::vector<unsigned char> UdpDataTransport::receive(long int timeout)
     {
-        std::vector<unsigned char> res;
+        std::shared_ptr<std::promise<std::vector<unsigned char> > > received(new std::promise<std::vector<unsigned char> >());
+        std::future<std::vector<unsigned char> > result = received->get_future();
+        asyncReceive(timeout, [received](const std::vector<unsigned char>& data) { received->set_value(data); });
+
+        return result.get();
+    }
+
+    void UdpDataTransport::asyncReceive(long int timeout, std::function<void(const std::vector<unsigned char>&)> handler)
+    {
         std::shared_ptr<boost::asio::ip::udp::socket> socket = getSocket();
+        EXCEPTION_ASSERT_WITH_LOG(socket, LibLogicalAccessException, "The UDP transport is not connected.");
 
-        long int currentWait = 0;
-        size_t lenav = socket->available();
-        while (lenav == 0 && (timeout == 0 || currentWait < timeout))
+        d_pending.begin();
+        d_strand.dispatch([this, socket, timeout, handler]()
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(250));
-            currentWait += 250;
+            std::shared_ptr<bool> done(new bool(false));
+            if (timeout > 0)
+            {
+                d_pending.begin();
+                d_timer.expires_from_now(boost::posix_time::milliseconds(timeout));
+                d_timer.async_wait(d_strand.wrap([this, socket, done](const boost::system::error_code& error)
+                {
+                    if (!error && !*done)
+                    {
+                        boost::system::error_code ignored;
+                        socket->cancel(ignored);
+                    }
+                    d_pending.end();
+                }));
+            }
+
+            d_pending.begin();
+            socket->async_receive(boost::asio::buffer(d_recvBuffer), d_strand.wrap([this, socket, done, handler](const boost::system::error_code& error, size_t bytes_transferred)
+            {
+                *done = true;
+                boost::system::error_code ignored;
+                d_timer.cancel(ignored);
+
+                std::vector<unsigned char> res;
+                if (!error)
+                {
+                    res.assign(d_recvBuffer.begin(), d_recvBuffer.begin() + bytes_transferred);
+                }
+                handler(res);
+                d_pending.end();
+            }));
+            d_pending.end();
+        });
+    }
+
+    void UdpDataTransport::asyncSendCommand(const std::vector<unsigned char>& command, long int timeout, DataTransportCallback callback)
+    {
+        if (timeout == -1)
+            timeout = Settings::getInstance()->DataTransportTimeout;
+
+        LOG(LogLevel::COMS) << "Sending asynchronous command " << BufferHelper::getHex(command) << " command size {" << command.size() << "} timeout {" << timeout << "}...";
 
-            lenav = socket->available();
+        d_lastCommand = command;
+        d_lastResult.clear();
+
+        std::function<void(std::exception_ptr)> fail = [callback](std::exception_ptr error)
+        {
+            callback(std::vector<unsigned char>(), error);
+        };
+        std::function<void(std::shared_ptr<boost::asio::ip::udp::socket>)> transmit = [this, command, timeout, callback, fail](std::shared_ptr<boost::asio::ip::udp::socket> socket)
+        {
+            std::function<void()> receive = [this, timeout, callback]()
+            {
+                asyncReceive(timeout, [this, callback](const std::vector<unsigned char>& res)
+                {
+                    d_lastResult = res;
+                    LOG(LogLevel::COMS) << "Response received successfully ! Response: " << BufferHelper::getHex(res) << " size {" << res.size() << "}";
+                    callback(res, std::exception_ptr());
+                });
+            };
+            if (command.size() == 0)
+            {
+                receive();
+                return;
+            }
+
+            std::shared_ptr<std::vector<unsigned char> > buffer(new std::vector<unsigned char>(command));
+            d_pending.begin();
+            socket->async_send(boost::asio::buffer(*buffer), d_strand.wrap([this, buffer, receive, fail](const boost::system::error_code& error, size_t)
+            {
+                if (error)
+                    fail(std::make_exception_ptr(boost::system::system_error(error)));
+                else
+                    receive();
+                d_pending.end();
+            }));
+        };
+
+        std::shared_ptr<boost::asio::ip::udp::socket> socket = getSocket();
+        if (socket)
+        {
+            d_pending.begin();
+            d_strand.dispatch([this, socket, transmit]()
+            {
+                transmit(socket);
+                d_pending.end();
+            });
+            return;
         }
 
-        if (lenav > 0)
+        boost::system::error_code error;
+        boost::asio::ip::address address = boost::asio::ip::address::from_string(getIpAddress(), error);
+        if (error)
         {
-            boost::array<char, 128> recv_buf;
-            boost::asio::ip::udp::endpoint sender_endpoint;
-            // TODO: Need to set up a timeout here !
-            size_t len = socket->receive_from(boost::asio::buffer(recv_buf), sender_endpoint);
-            res = std::vector<unsigned char>(recv_buf.begin(), recv_buf.begin() + len);
+            ios.post([fail, error]() { fail(std::make_exception_ptr(boost::system::system_error(error))); });
+            return;
         }
 
-        return res;
+        // The socket is only kept once connected, as the blocking connect() does.
+        socket.reset(new boost::asio::ip::udp::socket(ios));
+        d_pending.begin();
+        d_strand.dispatch([this, socket, address, transmit, fail]()
+        {
+            d_pending.begin();
+            socket->async_connect(boost::asio::ip::udp::endpoint(address, getPort()), d_strand.wrap([this, socket, transmit, fail](const boost::system::error_code& error)
+            {
+                if (error)
+                {
+                    LOG(LogLevel::ERRORS) << "Cannot connect to " << getIpAddress() << ":" << getPort() << " : " << error.message();
+                    fail(std::make_exception_ptr(LibLogicalAccessException("Cannot establish connection on " + getIpAddress() + ".")));
+                }
+                else
+                {
+                    d_socket = socket;
+                    transmit(socket);
+                }
+                d_pending.end();
+            }));
+            d_pending.end();
+        });
     }
 
     void UdpDataTransport::serialize(boost::property_tree::ptree& parentNode)
@@ -34,8 +34,7 @@ namespace logicalaccess
         EXCEPTION_ASSERT_WITH_LOG(location, std::invalid_argument, "location parameter can't be null.");
 
         // By default duplicate the format. Other kind of implementation should override this current method.
-        std::shared_ptr<Format> formatret = Format::getByFormatType(format->getType());
-        formatret->unSerialize(format->serialize(), "");
+        std::shared_ptr<Format> formatret = format->clone();
 
         std::shared_ptr<StorageCardService> storage = std::dynamic_pointer_cast<StorageCardService>(d_chip->getService(CST_STORAGE));
         if (storage)
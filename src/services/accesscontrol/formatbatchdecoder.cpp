@@ -0,0 +1,134 @@
+/**
+ * \file formatbatchdecoder.cpp
+ * \brief Batch decoder of raw format payloads.
+ */
+
+#include "logicalaccess/services/accesscontrol/formatbatchdecoder.hpp"
+#include "logicalaccess/services/accesscontrol/formats/customformat/numberdatafield.hpp"
+#include "logicalaccess/myexception.hpp"
+#include "logicalaccess/utils.hpp"
+
+#include <atomic>
+
+namespace logicalaccess
+{
+    FormatBatchDecoder::FormatBatchDecoder(std::shared_ptr<Format> format, const std::string& facilityCodeField, const std::string& cardNumberField)
+        : d_format(format), d_facilityCodeField(facilityCodeField), d_cardNumberField(cardNumberField), d_threadCount(1), d_minimumChunkSize(4096)
+    {
+        EXCEPTION_ASSERT_WITH_LOG(d_format, std::invalid_argument, "A format must be specified.");
+    }
+
+    void FormatBatchDecoder::setThreadCount(unsigned int threadCount)
+    {
+        d_threadCount = threadCount;
+    }
+
+    unsigned int FormatBatchDecoder::getThreadCount() const
+    {
+        return d_threadCount;
+    }
+
+    void FormatBatchDecoder::setMinimumChunkSize(size_t chunkSize)
+    {
+        d_minimumChunkSize = (chunkSize > 0) ? chunkSize : 1;
+    }
+
+    size_t FormatBatchDecoder::decode(const void* payloads, size_t payloadLengthBytes, size_t count, DecodedCredentials& credentials) const
+    {
+        credentials.facilityCodes.resize(count);
+        credentials.cardNumbers.resize(count);
+        credentials.parityOk.resize(count);
+
+        if (count == 0)
+        {
+            return 0;
+        }
+
+        return decode(payloads, payloadLengthBytes, count, &credentials.facilityCodes[0], &credentials.cardNumbers[0], &credentials.parityOk[0]);
+    }
+
+    size_t FormatBatchDecoder::decode(const void* payloads, size_t payloadLengthBytes, size_t count,
+                                      unsigned long long* facilityCodes, unsigned long long* cardNumbers, unsigned char* parityOk) const
+    {
+        if (count == 0)
+        {
+            return 0;
+        }
+
+        EXCEPTION_ASSERT_WITH_LOG(payloads != NULL, std::invalid_argument, "Payloads must be specified.");
+        EXCEPTION_ASSERT_WITH_LOG(payloadLengthBytes * 8 >= d_format->getDataLength(), std::invalid_argument, "The payload length is too short for the format.");
+
+        // Each range is decoded with its own copy of the format.
+        const unsigned char* data = reinterpret_cast<const unsigned char*>(payloads);
+        std::atomic<size_t> decoded(0);
+        parallelFor(count, d_threadCount, d_minimumChunkSize, [&](size_t first, size_t last)
+        {
+            decoded += decodeRange(data, payloadLengthBytes, first, last, facilityCodes, cardNumbers, parityOk);
+        });
+
+        return decoded;
+    }
+
+    size_t FormatBatchDecoder::decodeRange(const unsigned char* payloads, size_t payloadLengthBytes, size_t first, size_t last,
+                                           unsigned long long* facilityCodes, unsigned long long* cardNumbers, unsigned char* parityOk) const
+    {
+        std::shared_ptr<Format> format = d_format->clone();
+        std::shared_ptr<NumberDataField> facilityCodeField = std::dynamic_pointer_cast<NumberDataField>(format->getFieldFromName(d_facilityCodeField));
+        std::shared_ptr<NumberDataField> cardNumberField;
+        if (d_cardNumberField.empty())
+        {
+            std::list<std::shared_ptr<DataField> > fields = format->getFieldList();
+            for (std::list<std::shared_ptr<DataField> >::const_iterator i = fields.cbegin(); !cardNumberField && i != fields.cend(); ++i)
+            {
+                std::shared_ptr<NumberDataField> field = std::dynamic_pointer_cast<NumberDataField>(*i);
+                if (field && field->getIsIdentifier())
+                {
+                    cardNumberField = field;
+                }
+            }
+            if (!cardNumberField)
+            {
+                cardNumberField = std::dynamic_pointer_cast<NumberDataField>(format->getFieldFromName("Uid"));
+            }
+        }
+        else
+        {
+            cardNumberField = std::dynamic_pointer_cast<NumberDataField>(format->getFieldFromName(d_cardNumberField));
+        }
+
+        size_t ret = 0;
+        for (size_t i = first; i < last; ++i)
+        {
+            bool ok = true;
+            try
+            {
+                format->setLinearData(payloads + i * payloadLengthBytes, payloadLengthBytes);
+            }
+            catch (ParityException&)
+            {
+                // A custom format can stop at a parity field before its numbers are decoded,
+                // the fields would still hold the previous payload values.
+                ok = false;
+            }
+
+            if (facilityCodes != NULL)
+            {
+                facilityCodes[i] = (ok && facilityCodeField) ? static_cast<unsigned long long>(facilityCodeField->getValue()) : 0;
+            }
+            if (cardNumbers != NULL)
+            {
+                cardNumbers[i] = (ok && cardNumberField) ? static_cast<unsigned long long>(cardNumberField->getValue()) : 0;
+            }
+            if (parityOk != NULL)
+            {
+                parityOk[i] = ok ? 1 : 0;
+            }
+            if (ok)
+            {
+                ++ret;
+            }
+        }
+
+        return ret;
+    }
+}
@@ -196,6 +196,17 @@ namespace logicalaccess
         return ret;
     }
 
+    std::shared_ptr<Format> ASCIIFormat::clone() const
+    {
+        std::shared_ptr<ASCIIFormat> ret = std::dynamic_pointer_cast<ASCIIFormat>(StaticFormat::clone());
+        if (ret)
+        {
+            ret->d_asciiValue = d_asciiValue;
+        }
+
+        return ret;
+    }
+
     bool ASCIIFormat::needUserConfigurationToBeUse() const
     {
         return true;
@@ -222,4 +222,117 @@ namespace logicalaccess
 
         (*writePosBits) += readLengthBits;
     }
-}
\ No newline at end of file
+
+    unsigned long long BitHelper::readBits(const void* data, size_t dataLengthBytes, unsigned int readPosBits, unsigned int readLengthBits)
+    {
+        if (readLengthBits == 0 || readLengthBits > 64 || ((readPosBits + readLengthBits + 7) / 8) > dataLengthBytes)
+        {
+            THROW_EXCEPTION_WITH_LOG(std::invalid_argument, "The bits to read are out of range.");
+        }
+
+        const unsigned char* datas = reinterpret_cast<const unsigned char*>(data) + readPosBits / 8;
+        unsigned int offset = readPosBits % 8;
+        unsigned int nbBytes = (offset + readLengthBits + 7) / 8;
+        unsigned long long ret = 0;
+
+        if (nbBytes <= 8)
+        {
+            // The whole field fits in one word: assemble it big endian then shift it in place.
+            for (unsigned int i = 0; i < nbBytes; ++i)
+            {
+                ret = (ret << 8) | datas[i];
+            }
+            ret >>= (nbBytes * 8) - offset - readLengthBits;
+        }
+        else
+        {
+            // Unaligned 64 bits field spanning 9 bytes.
+            ret = datas[0] & (0xff >> offset);
+            for (unsigned int i = 1; i < 8; ++i)
+            {
+                ret = (ret << 8) | datas[i];
+            }
+            unsigned int lastBits = offset + readLengthBits - 64;
+            ret = (ret << lastBits) | (datas[8] >> (8 - lastBits));
+        }
+
+        if (readLengthBits < 64)
+        {
+            ret &= (1ULL << readLengthBits) - 1;
+        }
+
+        return ret;
+    }
+
+    void BitHelper::writeBits(void* writtenData, size_t writtenDataLengthBytes, unsigned int writePosBits, unsigned long long value, unsigned int writeLengthBits)
+    {
+        if (writeLengthBits == 0 || writeLengthBits > 64 || ((writePosBits + writeLengthBits + 7) / 8) > writtenDataLengthBytes)
+        {
+            THROW_EXCEPTION_WITH_LOG(std::invalid_argument, "The result array is too short.");
+        }
+
+        if (writeLengthBits < 64)
+        {
+            value &= (1ULL << writeLengthBits) - 1;
+        }
+
+        unsigned char* datas = reinterpret_cast<unsigned char*>(writtenData) + writePosBits / 8;
+        unsigned int offset = writePosBits % 8;
+        unsigned int nbBytes = (offset + writeLengthBits + 7) / 8;
+
+        if (nbBytes <= 8)
+        {
+            value <<= (nbBytes * 8) - offset - writeLengthBits;
+            for (int i = static_cast<int>(nbBytes) - 1; i >= 0; --i)
+            {
+                datas[i] |= static_cast<unsigned char>(value & 0xff);
+                value >>= 8;
+            }
+        }
+        else
+        {
+            unsigned int lastBits = offset + writeLengthBits - 64;
+            datas[8] |= static_cast<unsigned char>((value << (8 - lastBits)) & 0xff);
+            value >>= lastBits;
+            for (int i = 7; i >= 0; --i)
+            {
+                datas[i] |= static_cast<unsigned char>(value & 0xff);
+                value >>= 8;
+            }
+        }
+    }
+
+    unsigned int BitHelper::popCount(unsigned long long value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned int>(__builtin_popcountll(value));
+#else
+        value = value - ((value >> 1) & 0x5555555555555555ULL);
+        value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+        value = (value + (value >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+        return static_cast<unsigned int>((value * 0x0101010101010101ULL) >> 56);
+#endif
+    }
+
+    unsigned int BitHelper::popCount(const void* data, const void* mask, size_t maskLengthBytes)
+    {
+        const unsigned char* datas = reinterpret_cast<const unsigned char*>(data);
+        const unsigned char* masks = reinterpret_cast<const unsigned char*>(mask);
+        unsigned int ret = 0;
+        size_t i = 0;
+
+        for (; i + 8 <= maskLengthBytes; i += 8)
+        {
+            unsigned long long d, m;
+            memcpy(&d, datas + i, sizeof(d));
+            memcpy(&m, masks + i, sizeof(m));
+            ret += popCount(d & m);
+        }
+        for (; i < maskLengthBytes; ++i)
+        {
+            ret += popCount(static_cast<unsigned long long>(datas[i] & masks[i]));
+        }
+
+        return ret;
+    }
+}
@@ -192,4 +192,11 @@ namespace logicalaccess
     {
         return "BinaryDataField";
     }
+
+    std::shared_ptr<DataField> BinaryDataField::clone() const
+    {
+        std::shared_ptr<BinaryDataField> field(new BinaryDataField(*this));
+        field->detachEncodings();
+        return field;
+    }
 }
@@ -56,29 +56,27 @@ namespace logicalaccess
         return d_name;
     }
 
-    void CustomFormat::getLinearData(void* data, size_t dataLengthBytes) const
+    std::shared_ptr<FormatLayout> CustomFormat::getLayout() const
     {
-        unsigned int pos = 0;
-        std::list<std::shared_ptr<DataField> > sortedFieldList = d_fieldList;
-        sortedFieldList.sort(FieldSortPredicate);
-        memset(data, 0x00, dataLengthBytes);
-        for (std::list<std::shared_ptr<DataField> >::const_iterator i = sortedFieldList.begin(); i != sortedFieldList.end(); ++i)
+        // Formats are shared between reading threads: swap the layout atomically.
+        std::shared_ptr<FormatLayout> layout = std::atomic_load(&d_layout);
+        if (!layout || !layout->isUpToDate(d_fieldList))
         {
-            pos = (*i)->getPosition();
-            (*i)->getLinearData(data, dataLengthBytes, &pos);
+            layout = std::make_shared<FormatLayout>(d_fieldList);
+            std::atomic_store(&d_layout, layout);
         }
+
+        return layout;
+    }
+
+    void CustomFormat::getLinearData(void* data, size_t dataLengthBytes) const
+    {
+        getLayout()->getLinearData(data, dataLengthBytes);
     }
 
     void CustomFormat::setLinearData(const void* data, size_t dataLengthBytes)
     {
-        unsigned int pos = 0;
-        std::list<std::shared_ptr<DataField> > sortedFieldList = d_fieldList;
-        sortedFieldList.sort(FieldSortPredicate);
-        for (std::list<std::shared_ptr<DataField> >::iterator i = sortedFieldList.begin(); i != sortedFieldList.end(); ++i)
-        {
-            pos = (*i)->getPosition();
-            (*i)->setLinearData(data, dataLengthBytes, &pos);
-        }
+        getLayout()->setLinearData(data, dataLengthBytes);
     }
 
     void CustomFormat::serialize(boost::property_tree::ptree& parentNode)
@@ -159,6 +157,18 @@ namespace logicalaccess
         return ret;
     }
 
+    std::shared_ptr<Format> CustomFormat::clone() const
+    {
+        std::shared_ptr<CustomFormat> ret(new CustomFormat());
+        ret->d_name = d_name;
+        for (std::list<std::shared_ptr<DataField> >::const_iterator i = d_fieldList.cbegin(); i != d_fieldList.cend(); ++i)
+        {
+            ret->d_fieldList.push_back((*i)->clone());
+        }
+
+        return ret;
+    }
+
     FormatType CustomFormat::getType() const
     {
         return FT_CUSTOM;
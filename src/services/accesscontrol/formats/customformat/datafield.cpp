@@ -16,6 +16,7 @@ namespace logicalaccess
     {
         d_length = 0x00;
         d_position = 0;
+        d_revision = 0;
     }
 
     DataField::~DataField()
@@ -30,6 +31,7 @@ namespace logicalaccess
     void DataField::setPosition(unsigned int position)
     {
         d_position = position;
+        ++d_revision;
     }
 
     unsigned int DataField::getPosition() const
@@ -47,6 +49,11 @@ namespace logicalaccess
         return d_name;
     }
 
+    unsigned int DataField::getRevision() const
+    {
+        return d_revision;
+    }
+
     void DataField::serialize(boost::property_tree::ptree& node)
     {
         node.put("Name", d_name);
@@ -57,5 +64,6 @@ namespace logicalaccess
     {
         d_name = node.get_child("Name").get_value<std::string>();
         d_position = node.get_child("Position").get_value<unsigned int>();
+        ++d_revision;
     }
 }
\ No newline at end of file
@@ -0,0 +1,170 @@
+/**
+ * \file formatlayout.cpp
+ * \brief Compiled bit layout of a custom format.
+ */
+
+#include "logicalaccess/services/accesscontrol/formats/customformat/formatlayout.hpp"
+#include "logicalaccess/services/accesscontrol/formats/format.hpp"
+#include "logicalaccess/services/accesscontrol/formats/bithelper.hpp"
+
+#include <cstring>
+
+namespace logicalaccess
+{
+    FormatLayout::FormatLayout(const std::list<std::shared_ptr<DataField> >& fields)
+    {
+        for (std::list<std::shared_ptr<DataField> >::const_iterator i = fields.cbegin(); i != fields.cend(); ++i)
+        {
+            d_revisions.push_back(std::make_pair(i->get(), (*i)->getRevision()));
+        }
+
+        std::list<std::shared_ptr<DataField> > sortedFieldList = fields;
+        sortedFieldList.sort(FieldSortPredicate);
+        for (std::list<std::shared_ptr<DataField> >::const_iterator i = sortedFieldList.cbegin(); i != sortedFieldList.cend(); ++i)
+        {
+            LayoutStep step;
+            step.type = LS_FIELD;
+            step.field = *i;
+            step.position = (*i)->getPosition();
+            step.length = (*i)->getDataLength();
+            step.parityType = PT_NONE;
+
+            std::shared_ptr<NumberDataField> numberField = std::dynamic_pointer_cast<NumberDataField>(*i);
+            std::shared_ptr<ParityDataField> parityField = std::dynamic_pointer_cast<ParityDataField>(*i);
+            if (numberField)
+            {
+                std::shared_ptr<DataType> dataType = numberField->getDataType();
+                std::shared_ptr<DataRepresentation> dataRepresentation = numberField->getDataRepresentation();
+                if (step.length > 0 && step.length <= 64 && Format::isPlainBinaryEncoding(dataType.get(), dataRepresentation.get()))
+                {
+                    step.type = LS_NUMBER;
+                    step.numberField = numberField;
+                    d_encodings.push_back(std::make_pair(dataType.get(), dataRepresentation.get()));
+                }
+            }
+            else if (parityField)
+            {
+                std::vector<unsigned int> positions = parityField->getBitsUsePositions();
+                std::vector<unsigned char> mask;
+                bool duplicate = false;
+                for (std::vector<unsigned int>::const_iterator p = positions.cbegin(); !duplicate && p != positions.cend(); ++p)
+                {
+                    if (mask.size() <= (*p / 8))
+                    {
+                        mask.resize((*p / 8) + 1, 0x00);
+                    }
+                    unsigned char bit = (unsigned char)(0x80 >> (*p % 8));
+                    // A bit used twice cancels itself, keep the field own computation for this unusual case.
+                    duplicate = (mask[*p / 8] & bit) != 0;
+                    mask[*p / 8] |= bit;
+                }
+
+                if (!duplicate)
+                {
+                    step.type = LS_PARITY;
+                    step.parityType = parityField->getParityType();
+                    step.parityMask = mask;
+                }
+            }
+
+            d_steps.push_back(step);
+        }
+    }
+
+    bool FormatLayout::isUpToDate(const std::list<std::shared_ptr<DataField> >& fields) const
+    {
+        if (fields.size() != d_revisions.size())
+        {
+            return false;
+        }
+
+        std::vector<std::pair<const DataField*, unsigned int> >::const_iterator r = d_revisions.cbegin();
+        for (std::list<std::shared_ptr<DataField> >::const_iterator i = fields.cbegin(); i != fields.cend(); ++i, ++r)
+        {
+            if (i->get() != r->first || (*i)->getRevision() != r->second)
+            {
+                return false;
+            }
+        }
+
+        for (std::vector<std::pair<const DataType*, const DataRepresentation*> >::const_iterator e = d_encodings.cbegin(); e != d_encodings.cend(); ++e)
+        {
+            if (!Format::isPlainBinaryEncoding(e->first, e->second))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    unsigned char FormatLayout::computeParity(const LayoutStep& step, const void* data)
+    {
+        unsigned char parity = 0x00;
+        if (!step.parityMask.empty())
+        {
+            parity = (unsigned char)(BitHelper::popCount(data, &step.parityMask[0], step.parityMask.size()) & 0x01);
+        }
+
+        switch (step.parityType)
+        {
+        case PT_EVEN:
+            break;
+
+        case PT_ODD:
+            parity = (unsigned char)((~parity) & 0x01);
+            break;
+
+        case PT_NONE:
+            parity = 0x00;
+            break;
+        }
+
+        return parity;
+    }
+
+    void FormatLayout::getLinearData(void* data, size_t dataLengthBytes) const
+    {
+        memset(data, 0x00, dataLengthBytes);
+        for (std::vector<LayoutStep>::const_iterator i = d_steps.cbegin(); i != d_steps.cend(); ++i)
+        {
+            unsigned int pos = i->position;
+            bool inRange = ((i->position + i->length + 7) / 8) <= dataLengthBytes;
+            if (i->type == LS_NUMBER && inRange)
+            {
+                BitHelper::writeBits(data, dataLengthBytes, i->position, static_cast<unsigned long long>(i->numberField->getValue()), i->length);
+            }
+            else if (i->type == LS_PARITY && inRange && i->parityMask.size() <= dataLengthBytes)
+            {
+                BitHelper::writeBits(data, dataLengthBytes, i->position, computeParity(*i, data), 1);
+            }
+            else
+            {
+                // Out of range fields fail from here with the field own error.
+                i->field->getLinearData(data, dataLengthBytes, &pos);
+            }
+        }
+    }
+
+    void FormatLayout::setLinearData(const void* data, size_t dataLengthBytes) const
+    {
+        for (std::vector<LayoutStep>::const_iterator i = d_steps.cbegin(); i != d_steps.cend(); ++i)
+        {
+            unsigned int pos = i->position;
+            bool inRange = ((i->position + i->length + 7) / 8) <= dataLengthBytes;
+            if (i->type == LS_NUMBER && inRange)
+            {
+                i->numberField->setValue(static_cast<long long>(BitHelper::readBits(data, dataLengthBytes, i->position, i->length)));
+            }
+            else if (i->type == LS_PARITY && inRange && i->parityMask.size() <= dataLengthBytes &&
+                computeParity(*i, data) == BitHelper::readBits(data, dataLengthBytes, i->position, 1))
+            {
+                // Parity checked.
+            }
+            else
+            {
+                i->field->setLinearData(data, dataLengthBytes, &pos);
+            }
+        }
+    }
+}
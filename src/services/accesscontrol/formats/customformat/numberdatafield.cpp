@@ -89,4 +89,11 @@ namespace logicalaccess
     {
         return "NumberDataField";
     }
+
+    std::shared_ptr<DataField> NumberDataField::clone() const
+    {
+        std::shared_ptr<NumberDataField> field(new NumberDataField(*this));
+        field->detachEncodings();
+        return field;
+    }
 }
\ No newline at end of file
@@ -50,6 +50,7 @@ namespace logicalaccess
     void ParityDataField::setParityType(ParityType type)
     {
         d_parityType = type;
+        ++d_revision;
     }
 
     ParityType ParityDataField::getParityType() const
@@ -60,6 +61,7 @@ namespace logicalaccess
     void ParityDataField::setBitsUsePositions(std::vector<unsigned int> positions)
     {
         d_bitsUsePositions = positions;
+        ++d_revision;
     }
 
     std::vector<unsigned int> ParityDataField::getBitsUsePositions() const
@@ -104,7 +106,7 @@ namespace logicalaccess
 
         if (parity != currentParity)
         {
-            THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "The parity " + getName() + " doesn't match.");
+            THROW_EXCEPTION_WITH_LOG(ParityException, "The parity " + getName() + " doesn't match.");
         }
     }
 
@@ -174,10 +176,17 @@ namespace logicalaccess
             unsigned int bit = v.second.get_value<unsigned int>();
             d_bitsUsePositions.push_back(bit);
         }
+        ++d_revision;
     }
 
     std::string ParityDataField::getDefaultXmlNodeName() const
     {
         return "ParityDataField";
     }
+
+    std::shared_ptr<DataField> ParityDataField::clone() const
+    {
+        std::shared_ptr<ParityDataField> field(new ParityDataField(*this));
+        return field;
+    }
 }
\ No newline at end of file
@@ -169,4 +169,11 @@ namespace logicalaccess
     {
         return "StringDataField";
     }
+
+    std::shared_ptr<DataField> StringDataField::clone() const
+    {
+        std::shared_ptr<StringDataField> field(new StringDataField(*this));
+        field->detachEncodings();
+        return field;
+    }
 }
@@ -32,6 +32,7 @@ namespace logicalaccess
     void ValueDataField::setDataLength(unsigned int length)
     {
         d_length = length;
+        ++d_revision;
     }
 
     std::shared_ptr<DataRepresentation> ValueDataField::getDataRepresentation() const
@@ -42,6 +43,7 @@ namespace logicalaccess
     void ValueDataField::setDataRepresentation(std::shared_ptr<DataRepresentation>& encoding)
     {
         d_dataRepresentation = encoding;
+        ++d_revision;
     }
 
     std::shared_ptr<DataType> ValueDataField::getDataType() const
@@ -52,6 +54,7 @@ namespace logicalaccess
     void ValueDataField::setDataType(std::shared_ptr<DataType>& encoding)
     {
         d_dataType = encoding;
+        ++d_revision;
     }
 
     void ValueDataField::setIsFixedField(bool isFixed)
@@ -74,6 +77,24 @@ namespace logicalaccess
         return d_isIdentifier;
     }
 
+    void ValueDataField::detachEncodings()
+    {
+        std::shared_ptr<DataRepresentation> dataRepresentation(DataRepresentation::getByEncodingType(d_dataRepresentation->getType()));
+        std::shared_ptr<DataType> dataType(DataType::getByEncodingType(d_dataType->getType()));
+        if (dataRepresentation)
+        {
+            d_dataRepresentation = dataRepresentation;
+        }
+        if (dataType)
+        {
+            dataType->setLeftParityType(d_dataType->getLeftParityType());
+            dataType->setRightParityType(d_dataType->getRightParityType());
+            dataType->setBitDataRepresentationType(d_dataType->getBitDataRepresentationType());
+            d_dataType = dataType;
+        }
+        ++d_revision;
+    }
+
     void ValueDataField::convertNumericData(void* data, size_t dataLengthBytes, unsigned int* pos, unsigned long long field, unsigned int fieldlen) const
     {
         unsigned int convertedDataTypeLengthBits = d_dataType->convert(field, fieldlen, NULL, 0);
@@ -203,5 +224,6 @@ namespace logicalaccess
         d_dataRepresentation.reset(DataRepresentation::getByEncodingType(static_cast<EncodingType>(node.get_child("DataRepresentation").get_value<unsigned int>())));
         d_dataType.reset(DataType::getByEncodingType(static_cast<EncodingType>(node.get_child("DataType").get_value<unsigned int>())));
         d_length = node.get_child("Length").get_value<unsigned int>();
+        ++d_revision;
     }
 }
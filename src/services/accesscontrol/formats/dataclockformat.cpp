@@ -122,28 +122,28 @@ namespace logicalaccess
             unsigned char parity = getRightParity1(data, dataLengthBytes);
             if ((unsigned char)((unsigned char)(reinterpret_cast<const unsigned char*>(data)[pos / 8] << (pos % 8)) >> 7) != parity)
             {
-                THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "Right parity 1 format error.");
+                THROW_EXCEPTION_WITH_LOG(ParityException, "Right parity 1 format error.");
             }
 
             pos = 33;
             parity = getRightParity2(data, dataLengthBytes);
             if ((unsigned char)((unsigned char)(reinterpret_cast<const unsigned char*>(data)[pos / 8] << (pos % 8)) >> 7) != parity)
             {
-                THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "Right parity 2 format error.");
+                THROW_EXCEPTION_WITH_LOG(ParityException, "Right parity 2 format error.");
             }
 
             pos = 34;
             parity = getRightParity3(data, dataLengthBytes);
             if ((unsigned char)((unsigned char)(reinterpret_cast<const unsigned char*>(data)[pos / 8] << (pos % 8)) >> 7) != parity)
             {
-                THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "Right parity 3 format error.");
+                THROW_EXCEPTION_WITH_LOG(ParityException, "Right parity 3 format error.");
             }
 
             pos = 35;
             parity = getRightParity4(data, dataLengthBytes);
             if ((unsigned char)((unsigned char)(reinterpret_cast<const unsigned char*>(data)[pos / 8] << (pos % 8)) >> 7) != parity)
             {
-                THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "Right parity 4 format error.");
+                THROW_EXCEPTION_WITH_LOG(ParityException, "Right parity 4 format error.");
             }
         }
     }
@@ -102,6 +102,16 @@ namespace logicalaccess
         return parity;
     }
 
+    bool Format::isPlainBinaryEncoding(const DataType* dataType, const DataRepresentation* dataRepresentation)
+    {
+        return (dataType != NULL && dataRepresentation != NULL &&
+            dataType->getType() == ET_BINARY &&
+            dataType->getLeftParityType() == PT_NONE &&
+            dataType->getRightParityType() == PT_NONE &&
+            dataType->getBitDataRepresentationType() == ET_BIGENDIAN &&
+            dataRepresentation->getType() == ET_BIGENDIAN);
+    }
+
     std::shared_ptr<Format> Format::getByFormatType(FormatType type)
     {
         std::shared_ptr<Format> ret;
@@ -166,6 +176,18 @@ namespace logicalaccess
         return ret;
     }
 
+    std::shared_ptr<Format> Format::clone() const
+    {
+        // Generic copy through the XML serialization. Formats should override it with a direct copy.
+        std::shared_ptr<Format> ret = getByFormatType(getType());
+        if (ret)
+        {
+            ret->unSerialize(const_cast<Format*>(this)->serialize(), "");
+        }
+
+        return ret;
+    }
+
     std::vector<unsigned char> Format::getIdentifier()
     {
         std::vector<unsigned char> ret;
@@ -185,7 +185,7 @@ namespace logicalaccess
             unsigned char parity = getRightParity(data, dataLengthBytes);
             if ((unsigned char)((unsigned char)(reinterpret_cast<const unsigned char*>(data)[pos / 8] << (pos % 8)) >> 7) != parity)
             {
-                THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "Right parity format error.");
+                THROW_EXCEPTION_WITH_LOG(ParityException, "Right parity format error.");
             }
         }
     }
@@ -186,7 +186,7 @@ namespace logicalaccess
                 {
                     char buftmp[64];
                     sprintf(buftmp, "Right parity %u format error.", i);
-                    THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, buftmp);
+                    THROW_EXCEPTION_WITH_LOG(ParityException, buftmp);
                 }
             }
         }
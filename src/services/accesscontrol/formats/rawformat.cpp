@@ -126,6 +126,17 @@ namespace logicalaccess
         return ret;
     }
 
+    std::shared_ptr<Format> RawFormat::clone() const
+    {
+        std::shared_ptr<RawFormat> ret = std::dynamic_pointer_cast<RawFormat>(StaticFormat::clone());
+        if (ret)
+        {
+            ret->d_rawData = d_rawData;
+        }
+
+        return ret;
+    }
+
     unsigned int RawFormat::getFieldLength(const string& field) const
     {
         unsigned int length = 0;
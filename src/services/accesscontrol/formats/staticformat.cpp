@@ -4,6 +4,7 @@
  * \brief Static Format Base.
  */
 
+#include <algorithm>
 #include <cstring>
 #include "logicalaccess/services/accesscontrol/formats/staticformat.hpp"
 #include "logicalaccess/services/accesscontrol/formats/bithelper.hpp"
@@ -51,11 +52,14 @@ namespace logicalaccess
 
     unsigned char StaticFormat::calculateParity(const void* data, size_t dataLengthBytes, ParityType parityType, size_t start, size_t parityLengthBits)
     {
-        unsigned char parity = 0x00;
-        for (size_t i = start; i < (start + parityLengthBits) && i < (dataLengthBytes * 8); i++)
+        unsigned int count = 0;
+        size_t end = std::min(start + parityLengthBits, dataLengthBytes * 8);
+        for (size_t i = start; i < end; i += 64)
         {
-            parity = (unsigned char)((parity & 0x01) ^ ((unsigned char)(reinterpret_cast<const char*>(data)[i / 8] >> (7 - (i % 8))) & 0x01));
+            unsigned int length = static_cast<unsigned int>(std::min<size_t>(end - i, 64));
+            count += BitHelper::popCount(BitHelper::readBits(data, (i + length + 7) / 8, static_cast<unsigned int>(i), length));
         }
+        unsigned char parity = (unsigned char)(count & 0x01);
 
         switch (parityType)
         {
@@ -104,8 +108,51 @@ namespace logicalaccess
         return false;
     }
 
+    std::shared_ptr<Format> StaticFormat::clone() const
+    {
+        std::shared_ptr<StaticFormat> ret = std::dynamic_pointer_cast<StaticFormat>(getByFormatType(getType()));
+        if (!ret)
+        {
+            return Format::clone();
+        }
+
+        size_t formatLength = getFormatLinearData(NULL, 0);
+        if (formatLength > 0)
+        {
+            std::vector<unsigned char> formatBuf(formatLength, 0x00);
+            getFormatLinearData(&formatBuf[0], formatBuf.size());
+            size_t indexByte = 0;
+            ret->setFormatLinearData(&formatBuf[0], &indexByte);
+        }
+
+        // Static format fields are only value holders sharing the format encodings.
+        ret->d_fieldList.clear();
+        for (std::list<std::shared_ptr<DataField> >::const_iterator i = d_fieldList.cbegin(); i != d_fieldList.cend(); ++i)
+        {
+            std::shared_ptr<DataField> field = (*i)->clone();
+            std::shared_ptr<ValueDataField> vfield = std::dynamic_pointer_cast<ValueDataField>(field);
+            if (vfield)
+            {
+                vfield->setDataRepresentation(ret->d_dataRepresentation);
+                vfield->setDataType(ret->d_dataType);
+            }
+            ret->d_fieldList.push_back(field);
+        }
+        ret->d_uid = d_uid;
+
+        return ret;
+    }
+
     void StaticFormat::convertField(void* data, size_t dataLengthBytes, unsigned int* pos, unsigned long long field, unsigned int fieldlen) const
     {
+        if (fieldlen > 0 && fieldlen <= 64 && ((*pos + fieldlen + 7) / 8) <= dataLengthBytes &&
+            isPlainBinaryEncoding(d_dataType.get(), d_dataRepresentation.get()))
+        {
+            BitHelper::writeBits(data, dataLengthBytes, *pos, field, fieldlen);
+            (*pos) += fieldlen;
+            return;
+        }
+
         unsigned int convertedDataTypeLengthBits = d_dataType->convert(field, fieldlen, NULL, 0);
         if (convertedDataTypeLengthBits > 0)
         {
@@ -136,6 +183,14 @@ namespace logicalaccess
 
     unsigned long long StaticFormat::revertField(const void* data, size_t dataLengthBytes, unsigned int* pos, unsigned int fieldlen) const
     {
+        if (fieldlen > 0 && fieldlen <= 64 && (*pos + fieldlen) <= getDataLength() && ((*pos + fieldlen + 7) / 8) <= dataLengthBytes &&
+            isPlainBinaryEncoding(d_dataType.get(), d_dataRepresentation.get()))
+        {
+            unsigned long long value = BitHelper::readBits(data, dataLengthBytes, *pos, fieldlen);
+            (*pos) += fieldlen;
+            return value;
+        }
+
         unsigned long long ret = 0;
 
         unsigned int extractedSizeBits = d_dataType->convert(0, d_dataRepresentation->convertLength(fieldlen), NULL, 0);
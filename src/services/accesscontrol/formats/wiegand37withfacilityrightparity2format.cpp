@@ -113,21 +113,21 @@ namespace logicalaccess
             unsigned char parity = getLeftParity(data, dataLengthBytes);
             if ((unsigned char)((unsigned char)(reinterpret_cast<const unsigned char*>(data)[pos / 8] << (pos % 8)) >> 7) != parity)
             {
-                THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "Left parity format error.");
+                THROW_EXCEPTION_WITH_LOG(ParityException, "Left parity format error.");
             }
 
             pos = 35;
             parity = getRightParity1(data, dataLengthBytes);
             if ((unsigned char)((unsigned char)(reinterpret_cast<const unsigned char*>(data)[pos / 8] << (pos % 8)) >> 7) != parity)
             {
-                THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "Right parity 1 format error.");
+                THROW_EXCEPTION_WITH_LOG(ParityException, "Right parity 1 format error.");
             }
 
             pos = 36;
             parity = getRightParity2(data, dataLengthBytes);
             if ((unsigned char)((unsigned char)(reinterpret_cast<const unsigned char*>(data)[pos / 8] << (pos % 8)) >> 7) != parity)
             {
-                THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "Right parity 1 format error.");
+                THROW_EXCEPTION_WITH_LOG(ParityException, "Right parity 1 format error.");
             }
         }
     }
@@ -57,16 +57,17 @@ namespace logicalaccess
         getLinearDataWithoutParity(data, dataLengthBytes);
         unsigned int pos = 0;
 
+        // The parity bits are outside of the ranges they cover, so they can be computed on the buffer being built.
         if (d_leftParityType != PT_NONE)
         {
-            BitHelper::writeToBit(data, dataLengthBytes, &pos, getLeftParity(), 7, 1);
+            BitHelper::writeToBit(data, dataLengthBytes, &pos, calculateParity(data, dataLengthBytes, d_leftParityType, 1, d_leftParityLength), 7, 1);
         }
 
         pos = getDataLength() - 1;
 
         if (d_rightParityType != PT_NONE)
         {
-            BitHelper::writeToBit(data, dataLengthBytes, &pos, getRightParity(), 7, 1);
+            BitHelper::writeToBit(data, dataLengthBytes, &pos, calculateParity(data, dataLengthBytes, d_rightParityType, getDataLength() - d_rightParityLength - 1, d_rightParityLength), 7, 1);
         }
     }
 
@@ -83,10 +84,10 @@ namespace logicalaccess
         int par;
         if (d_leftParityType != PT_NONE)
         {
-            par = getLeftParity();
+            par = calculateParity(data, dataLengthBytes, d_leftParityType, 1, d_leftParityLength);
             if ((unsigned char)(reinterpret_cast<const unsigned char*>(data)[pos / 8] >> 7) != par)
             {
-                THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "Left parity format error.");
+                THROW_EXCEPTION_WITH_LOG(ParityException, "Left parity format error.");
             }
         }
 
@@ -94,10 +95,10 @@ namespace logicalaccess
 
         if (d_rightParityType != PT_NONE)
         {
-            par = getRightParity();
+            par = calculateParity(data, dataLengthBytes, d_rightParityType, getDataLength() - d_rightParityLength - 1, d_rightParityLength);
             if ((unsigned char)((unsigned char)(reinterpret_cast<const unsigned char*>(data)[pos / 8] << (pos % 8)) >> 7) != par)
             {
-                THROW_EXCEPTION_WITH_LOG(LibLogicalAccessException, "Left parity format error.");
+                THROW_EXCEPTION_WITH_LOG(ParityException, "Left parity format error.");
             }
         }
     }
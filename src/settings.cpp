@@ -9,6 +9,7 @@
 #endif
 #include "logicalaccess/settings.hpp"
 #include "logicalaccess/logs.hpp"
+#include "logicalaccess/asynclogwriter.hpp"
 
 #include <boost/foreach.hpp>
 #include <boost/filesystem.hpp>
@@ -58,17 +59,30 @@ namespace logicalaccess
                 Logs::logToStderr = LogToStderr;
                 Logs::logfile.open(LogFileName, std::ios::out | std::ios::app);
 #endif
+                if (AsyncLog && Logs::logfile)
+                {
+                    AsyncLogWriter::getInstance().start(Logs::logfile, AsyncLogQueueSize,
+                        AsyncLogBlockOnOverflow ? AsyncLogWriter::OP_BLOCK : AsyncLogWriter::OP_DROP,
+                        AsyncLogFlushInterval, LogToStderr);
+                }
             }
         }
         catch (...) { reset(); }
+
+        Logs::updateLevelMask();
     }
 
     void Settings::Uninitialize()
     {
+        AsyncLogWriter::getInstance().stop();
         if (Logs::logfile)
         {
             Logs::logfile.close();
         }
+        if (instance != NULL)
+        {
+            Logs::updateLevelMask();
+        }
     }
 
     Settings* Settings::getInstance()
@@ -126,6 +140,10 @@ namespace logicalaccess
             SeePluginLog = pt.get("config.log.seeplugin", false);
             ColorizeLog = pt.get("config.log.colorize", false);
             ContextLog = pt.get("config.log.context", false);
+            AsyncLog = pt.get("config.log.async.enabled", false);
+            AsyncLogQueueSize = pt.get<long int>("config.log.async.queuesize", 8192);
+            AsyncLogBlockOnOverflow = (pt.get<std::string>("config.log.async.overflow", "drop") == "block");
+            AsyncLogFlushInterval = pt.get<long int>("config.log.async.flushinterval", 1000);
 
             IsAutoDetectEnabled = pt.get("config.autodetect.enabled", false);
             AutoDetectionTimeout = pt.get<long int>("config.autodetect.timeout", 400);
@@ -137,6 +155,15 @@ namespace logicalaccess
 
             DataTransportTimeout = pt.get<int>("config.dataTransportTimeout", 3000);
 
+            PluginIndexFile = pt.get<std::string>("config.PluginIndex.file", "");
+            const std::string currentName = "$current";
+            size_t current_pos = PluginIndexFile.find(currentName);
+            if (current_pos != std::string::npos)
+            {
+                PluginIndexFile.replace(current_pos, currentName.length(), getDllPath());
+            }
+            PluginWarmUp = pt.get("config.PluginIndex.warmup", false);
+
             PluginFolders.clear();
             BOOST_FOREACH(ptree::value_type const& v, pt.get_child("config.PluginFolders"))
             {
@@ -182,6 +209,10 @@ namespace logicalaccess
             pt.put("config.log.seeplugin", SeePluginLog);
             pt.put("config.log.colorize", ColorizeLog);
             pt.put("config.log.context", ContextLog);
+            pt.put("config.log.async.enabled", AsyncLog);
+            pt.put("config.log.async.queuesize", AsyncLogQueueSize);
+            pt.put("config.log.async.overflow", AsyncLogBlockOnOverflow ? "block" : "drop");
+            pt.put("config.log.async.flushinterval", AsyncLogFlushInterval);
 
             pt.put("config.autodetect.enabled", IsAutoDetectEnabled);
             pt.put("config.autodetect.timeout", AutoDetectionTimeout);
@@ -193,6 +224,9 @@ namespace logicalaccess
 
             pt.put("config.dataTransportTimeout", DataTransportTimeout);
 
+            pt.put("config.PluginIndex.file", PluginIndexFile);
+            pt.put("config.PluginIndex.warmup", PluginWarmUp);
+
             // Write the property tree to the XML file.
             write_xml((getDllPath() + "/liblogicalaccess.config"), pt);
         }
@@ -210,6 +244,10 @@ namespace logicalaccess
         SeePluginLog = false;
         ColorizeLog = false;
         ContextLog = false;
+        AsyncLog = false;
+        AsyncLogQueueSize = 8192;
+        AsyncLogBlockOnOverflow = false;
+        AsyncLogFlushInterval = 1000;
 
         IsAutoDetectEnabled = false;
         AutoDetectionTimeout = 400;
@@ -219,6 +257,8 @@ namespace logicalaccess
         DefaultReader = "PCSC";
         PluginFolders.clear();
         PluginFolders.push_back(getDllPath());
+        PluginIndexFile = "";
+        PluginWarmUp = false;
 
         DataTransportTimeout = 3000;
     }
@@ -2,6 +2,10 @@
 #include <boost/asio.hpp>
 #include <logicalaccess/logs.hpp>
 #include <logicalaccess/myexception.hpp>
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <vector>
 
 using namespace std::chrono;
 
@@ -17,6 +21,58 @@ uint16_t lla_htons(uint16_t in)
     return htons(in);
 }
 
+uint32_t lla_ntohl(uint32_t in)
+{
+    return ntohl(in);
+}
+
+uint16_t lla_ntohs(uint16_t in)
+{
+    return ntohs(in);
+}
+
+void parallelFor(size_t count, size_t threadCount, size_t minimumRange,
+                 const std::function<void(size_t, size_t)> &process)
+{
+    if (threadCount == 0)
+        threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    minimumRange = std::max<size_t>(minimumRange, 1);
+    threadCount  = std::min(threadCount, std::max<size_t>(count / minimumRange, 1));
+    if (threadCount <= 1)
+    {
+        if (count > 0)
+            process(0, count);
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(threadCount);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t)
+    {
+        // Ranges of count / threadCount items, give or take one.
+        size_t begin = t * count / threadCount;
+        size_t end   = (t + 1) * count / threadCount;
+        threads.push_back(std::thread([&process, &errors, t, begin, end]() {
+            try
+            {
+                process(begin, end);
+            }
+            catch (...)
+            {
+                errors[t] = std::current_exception();
+            }
+        }));
+    }
+
+    for (auto &thread : threads)
+        thread.join();
+    for (const auto &error : errors)
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
+
 ElapsedTimeCounter::ElapsedTimeCounter()
 {
     creation_ = steady_clock::now();
@@ -0,0 +1,41 @@
+/**
+ * A minimal cards plug-in library, loaded by the plug-ins index tests.
+ */
+
+#include <cstdio>
+#include <memory>
+
+#define PLUGINOBJECT_MAXLEN 64
+
+namespace logicalaccess
+{
+    class Chip;
+}
+
+extern "C"
+{
+    char *getLibraryName()
+    {
+        return (char *)"IndexTest";
+    }
+
+    void getIndexTestChip(std::shared_ptr<logicalaccess::Chip>* chip)
+    {
+        if (chip != NULL)
+        {
+            chip->reset();
+        }
+    }
+
+    bool getChipInfoAt(unsigned int index, char* chipname, size_t chipnamelen, void** getterfct)
+    {
+        if (index != 0 || chipname == NULL || chipnamelen != PLUGINOBJECT_MAXLEN || getterfct == NULL)
+        {
+            return false;
+        }
+
+        *getterfct = (void*)&getIndexTestChip;
+        snprintf(chipname, chipnamelen, "IndexTest");
+        return true;
+    }
+}
@@ -0,0 +1,265 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/asynclogwriter.hpp>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+using namespace logicalaccess;
+
+/**
+ * A string buffer whose first write blocks until the gate is opened, to hold the writer thread.
+ */
+class GateBuffer : public std::stringbuf
+{
+  public:
+    GateBuffer()
+        : gate_(open_.get_future().share())
+        , blocking_(false)
+        , syncs_(0)
+    {
+    }
+
+    void close()
+    {
+        blocking_ = true;
+    }
+
+    void open()
+    {
+        open_.set_value();
+    }
+
+    /**
+     * Wait for the writer thread to be held by the gate.
+     */
+    void waitEntered()
+    {
+        entered_.get_future().wait();
+    }
+
+    std::future<void> nextSync()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        synced_.reset(new std::promise<void>());
+        return synced_->get_future();
+    }
+
+    unsigned int getSyncCount() const
+    {
+        return syncs_;
+    }
+
+  protected:
+    std::streamsize xsputn(const char *s, std::streamsize n) override
+    {
+        hold();
+        return std::stringbuf::xsputn(s, n);
+    }
+
+    int_type overflow(int_type c) override
+    {
+        hold();
+        return std::stringbuf::overflow(c);
+    }
+
+    int sync() override
+    {
+        ++syncs_;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (synced_)
+        {
+            synced_->set_value();
+            synced_.reset();
+        }
+        return std::stringbuf::sync();
+    }
+
+  private:
+    void hold()
+    {
+        if (blocking_.exchange(false))
+        {
+            entered_.set_value();
+            gate_.wait();
+        }
+    }
+
+    std::promise<void> open_;
+    std::shared_future<void> gate_;
+    std::promise<void> entered_;
+    std::atomic<bool> blocking_;
+    std::atomic<unsigned int> syncs_;
+    std::mutex mutex_;
+    std::unique_ptr<std::promise<void>> synced_;
+};
+
+static std::string line(unsigned int producer, unsigned int index)
+{
+    return std::to_string(producer) + ":" + std::to_string(index) + "\n";
+}
+
+TEST(test_async_log_writer, ring_wraparound)
+{
+    std::ostringstream out;
+    AsyncLogWriter &writer = AsyncLogWriter::getInstance();
+    uint64_t dropped       = writer.getDroppedCount();
+    writer.start(out, 4, AsyncLogWriter::OP_BLOCK, 1000, false);
+
+    // Many times the ring capacity, in order.
+    std::string expected;
+    for (unsigned int i = 0; i < 1000; ++i)
+    {
+        ASSERT_TRUE(writer.push(line(0, i), false));
+        expected += line(0, i);
+    }
+    writer.stop();
+
+    ASSERT_EQ(expected, out.str());
+    ASSERT_EQ(dropped, writer.getDroppedCount());
+}
+
+TEST(test_async_log_writer, drop_when_full)
+{
+    GateBuffer buffer;
+    std::ostream out(&buffer);
+    AsyncLogWriter &writer = AsyncLogWriter::getInstance();
+    uint64_t dropped       = writer.getDroppedCount();
+    writer.start(out, 4, AsyncLogWriter::OP_DROP, 1000, false);
+
+    // The writer thread is held on the first line, the ring then fills up.
+    buffer.close();
+    ASSERT_TRUE(writer.push("first\n", true));
+    buffer.waitEntered();
+    for (unsigned int i = 0; i < 4; ++i)
+        ASSERT_TRUE(writer.push(line(0, i), false));
+    ASSERT_FALSE(writer.push("dropped\n", false));
+    ASSERT_FALSE(writer.push("dropped\n", false));
+    ASSERT_EQ(dropped + 2, writer.getDroppedCount());
+
+    buffer.open();
+    writer.stop();
+    ASSERT_EQ("first\n" + line(0, 0) + line(0, 1) + line(0, 2) + line(0, 3), buffer.str());
+}
+
+TEST(test_async_log_writer, block_when_full)
+{
+    GateBuffer buffer;
+    std::ostream out(&buffer);
+    AsyncLogWriter &writer = AsyncLogWriter::getInstance();
+    uint64_t dropped       = writer.getDroppedCount();
+    writer.start(out, 4, AsyncLogWriter::OP_BLOCK, 1000, false);
+
+    buffer.close();
+    ASSERT_TRUE(writer.push("first\n", true));
+    buffer.waitEntered();
+    for (unsigned int i = 0; i < 4; ++i)
+        ASSERT_TRUE(writer.push(line(0, i), false));
+
+    // The ring is full and the writer is held: the producer waits.
+    std::future<bool> blocked = std::async(std::launch::async, [&writer]() { return writer.push("last\n", false); });
+    ASSERT_EQ(std::future_status::timeout, blocked.wait_for(std::chrono::milliseconds(50)));
+
+    buffer.open();
+    ASSERT_TRUE(blocked.get());
+    writer.stop();
+    ASSERT_EQ("first\n" + line(0, 0) + line(0, 1) + line(0, 2) + line(0, 3) + "last\n", buffer.str());
+    ASSERT_EQ(dropped, writer.getDroppedCount());
+}
+
+TEST(test_async_log_writer, blocking_producers)
+{
+    const unsigned int producers = 4;
+    const unsigned int lines     = 2000;
+    std::ostringstream out;
+    AsyncLogWriter &writer = AsyncLogWriter::getInstance();
+    uint64_t dropped       = writer.getDroppedCount();
+    writer.start(out, 8, AsyncLogWriter::OP_BLOCK, 1000, false);
+
+    std::vector<std::thread> threads;
+    for (unsigned int p = 0; p < producers; ++p)
+    {
+        threads.push_back(std::thread([&writer, p]() {
+            for (unsigned int i = 0; i < lines; ++i)
+                writer.push(line(p, i), false);
+        }));
+    }
+    for (auto &thread : threads)
+        thread.join();
+    writer.stop();
+    ASSERT_EQ(dropped, writer.getDroppedCount());
+
+    // Every line is written once, each producer lines in order.
+    std::vector<unsigned int> next(producers, 0);
+    std::istringstream in(out.str());
+    unsigned int p, i;
+    char separator;
+    while (in >> p >> separator >> i)
+    {
+        ASSERT_LT(p, producers);
+        ASSERT_EQ(next[p], i);
+        ++next[p];
+    }
+    ASSERT_EQ(std::vector<unsigned int>(producers, lines), next);
+}
+
+TEST(test_async_log_writer, stop_writes_accepted_lines)
+{
+    const unsigned int producers = 4;
+    std::ostringstream out;
+    AsyncLogWriter &writer = AsyncLogWriter::getInstance();
+    writer.start(out, 16, AsyncLogWriter::OP_BLOCK, 1000, false);
+
+    // Producers push until the writer is stopped under them.
+    std::atomic<unsigned int> accepted(0);
+    std::atomic<bool> started(false);
+    std::vector<std::thread> threads;
+    for (unsigned int p = 0; p < producers; ++p)
+    {
+        threads.push_back(std::thread([&, p]() {
+            for (unsigned int i = 0; writer.push(line(p, i), false); ++i)
+            {
+                ++accepted;
+                started = true;
+            }
+        }));
+    }
+    while (!started)
+        std::this_thread::yield();
+    writer.stop();
+    for (auto &thread : threads)
+        thread.join();
+
+    ASSERT_FALSE(writer.isRunning());
+    std::string written = out.str();
+    ASSERT_EQ(accepted, static_cast<unsigned int>(std::count(written.begin(), written.end(), '\n')));
+
+    uint64_t dropped = writer.getDroppedCount();
+    ASSERT_FALSE(writer.push("after stop\n", false));
+    ASSERT_EQ(dropped + 1, writer.getDroppedCount());
+    ASSERT_EQ(written, out.str());
+}
+
+TEST(test_async_log_writer, flush)
+{
+    GateBuffer buffer;
+    std::ostream out(&buffer);
+    AsyncLogWriter &writer = AsyncLogWriter::getInstance();
+    writer.start(out, 16, AsyncLogWriter::OP_DROP, 3600000, false);
+
+    // A line requesting a flush is flushed without waiting for the interval.
+    std::future<void> synced = buffer.nextSync();
+    ASSERT_TRUE(writer.push("error\n", true));
+    ASSERT_EQ(std::future_status::ready, synced.wait_for(std::chrono::seconds(10)));
+    ASSERT_EQ("error\n", buffer.str());
+
+    // The other lines are flushed by stop().
+    ASSERT_TRUE(writer.push("info\n", false));
+    unsigned int syncs = buffer.getSyncCount();
+    writer.stop();
+    ASSERT_GT(buffer.getSyncCount(), syncs);
+    ASSERT_EQ("error\ninfo\n", buffer.str());
+}
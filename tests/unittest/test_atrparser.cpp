@@ -1,6 +1,9 @@
 #include "logicalaccess/lla_fwd.hpp"
 #include "pluginsreaderproviders/pcsc/atrparser.hpp"
 #include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 
 using namespace logicalaccess;
@@ -43,3 +46,60 @@ TEST(test_atr_parser, test_hardcoded)
               ATRParser::guessCardType("3B8F8001804F0CA000000306030001000000006A",
                                        PCSC_RUT_ACS_ACR_1222L));
 }
+
+TEST(test_atr_parser, test_runtime_registration)
+{
+    ASSERT_EQ("GENERIC_T_CL", ATRParser::guessCardType("3B8A800100112233445566778899AA"));
+    ATRParser::registerATR("3B8A800100112233445566778899AA", "DESFireEV1");
+    ATRParser::registerATR("3B8A800100112233445566778899AA", "DESFireEV2",
+                           PCSC_RUT_OMNIKEY_XX21);
+    ASSERT_EQ("DESFireEV1", ATRParser::guessCardType("3B8A800100112233445566778899AA"));
+    ASSERT_EQ("DESFireEV2", ATRParser::guessCardType("3B8A800100112233445566778899AA",
+                                                     PCSC_RUT_OMNIKEY_XX21));
+
+    const std::string path = "test_atrparser.db";
+    {
+        std::ofstream db(path);
+        db << "# ATR card_type [reader_type]\n"
+           << "\n"
+           << "3B8A8001FFEEDDCCBBAA9988776655 MifarePlus_SL3_4K\n"
+           << "3B8A8001FFEEDDCCBBAA9988776655 SAM_AV2 0x0006\n"
+           << "3B8F8001804F0CA0000003064000000000000028 HIDiClass2KS\n"
+           << "NOTANATR Mifare1K\n";
+    }
+    ASSERT_EQ(3u, ATRParser::loadATRDatabase(path));
+    std::remove(path.c_str());
+
+    ASSERT_EQ("MifarePlus_SL3_4K",
+              ATRParser::guessCardType("3B8A8001FFEEDDCCBBAA9988776655"));
+    ASSERT_EQ("SAM_AV2", ATRParser::guessCardType("3B8A8001FFEEDDCCBBAA9988776655",
+                                                  static_cast<PCSCReaderUnitType>(6)));
+    // User entries take precedence over the built-in ones, reader specific entries first.
+    ASSERT_EQ("HIDiClass2KS",
+              ATRParser::guessCardType("3B8F8001804F0CA0000003064000000000000028"));
+    ASSERT_EQ("Prox",
+              ATRParser::guessCardType("3B8F8001804F0CA0000003064000000000000028",
+                                       PCSC_RUT_OMNIKEY_XX27));
+}
+
+#ifdef LLA_BENCHMARK
+TEST(benchmark_atr_parser, lookup)
+{
+    const ByteVector known = {0xFF, 0x3B, 0xDF, 0x18, 0xFF, 0x81, 0xF1, 0xFE, 0x43, 0x00, 0x1F, 0x03, 0x4D,
+                              0x49, 0x46, 0x41, 0x52, 0x45, 0x20, 0x50, 0x6C, 0x75, 0x73, 0x20, 0x53,
+                              0x41, 0x4D, 0x98};
+    const int iterations = 100000;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        ASSERT_EQ("SAM_AV2", ATRParser::guessCardType(
+                                 const_cast<uint8_t *>(known.data()) + 1, known.size() - 1,
+                                 PCSC_RUT_DEFAULT));
+    }
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Hardcoded ATR lookup: " << static_cast<long>(seconds * 1e9 / iterations)
+              << " ns/lookup" << std::endl;
+}
+#endif
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/crypto/crc.hpp>
+#include <logicalaccess/crypto/tomcrypt.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace logicalaccess;
+
+// Bitwise implementations, as they were in des.cpp, used as references.
+static uint16_t bitwiseCRC16Reflected(uint16_t crc, const unsigned char *data, size_t length)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        unsigned char ch = static_cast<unsigned char>(data[i] ^ (crc & 0x00FF));
+        ch  = static_cast<unsigned char>(ch ^ (ch << 4));
+        crc = static_cast<uint16_t>((crc >> 8) ^ (ch << 8) ^ (ch << 3) ^ (ch >> 4));
+    }
+    return crc;
+}
+
+static uint16_t bitwiseCRC16CCITT(uint16_t crc, const unsigned char *data, size_t length)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        unsigned char datac = data[i];
+        for (unsigned char cnt_bits = 8; cnt_bits; cnt_bits--)
+        {
+            unsigned char flag_xor = ((crc >> 8) & 0x80) ^ (datac & 0x80);
+            datac <<= 1;
+            crc = static_cast<uint16_t>(crc << 1);
+            if (flag_xor)
+                crc ^= 0x1021;
+        }
+    }
+    return crc;
+}
+
+static uint32_t bitwiseCRC32(uint32_t crc, const unsigned char *data, size_t length)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc & 1) ? ((crc >> 1) ^ 0xEDB88320) : (crc >> 1);
+    }
+    return crc;
+}
+
+static std::vector<unsigned char> pattern(size_t size)
+{
+    std::vector<unsigned char> data(size);
+    uint32_t seed = 0x12345678;
+    for (size_t i = 0; i < size; ++i)
+    {
+        seed    = seed * 1103515245 + 12345;
+        data[i] = static_cast<unsigned char>(seed >> 16);
+    }
+    return data;
+}
+
+TEST(test_crc, check_values)
+{
+    const std::string check = "123456789";
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(check.data());
+
+    ASSERT_EQ(0x2189, CRC::crcKermit(data, check.size()));
+    ASSERT_EQ(0xBF05, CRC::crcA(data, check.size()));
+    ASSERT_EQ(0x906E, CRC::crcB(data, check.size()));
+    ASSERT_EQ(0x29B1, CRC::updateCRC16CCITT(0xFFFF, data, check.size()));
+    ASSERT_EQ(0xE5CC, CRC::updateCRC16CCITT(0x1D0F, data, check.size()));
+    ASSERT_EQ(0xCBF43926, ~CRC::updateCRC32(0xFFFFFFFF, data, check.size()));
+
+    // ISO14443-3 annex B example.
+    const unsigned char frame[] = {0x00, 0x00};
+    ASSERT_EQ(0x1EA0, CRC::crcA(frame, sizeof(frame)));
+}
+
+TEST(test_crc, match_bitwise)
+{
+    std::vector<unsigned char> data = pattern(1100);
+
+    // All the lengths and alignments around the slices and the folding blocks.
+    for (size_t offset = 0; offset < 9; ++offset)
+    {
+        for (size_t length = 0; offset + length <= data.size(); length += (length < 200) ? 1 : 37)
+        {
+            const unsigned char *p = &data[offset];
+            ASSERT_EQ(bitwiseCRC16Reflected(0x6363, p, length), CRC::updateCRC16Reflected(0x6363, p, length));
+            ASSERT_EQ(bitwiseCRC16CCITT(0x1D0F, p, length), CRC::updateCRC16CCITT(0x1D0F, p, length));
+            ASSERT_EQ(bitwiseCRC32(0xFFFFFFFF, p, length), CRC::updateCRC32Table(0xFFFFFFFF, p, length));
+            ASSERT_EQ(bitwiseCRC32(0x5A5A5A5A, p, length), CRC::updateCRC32(0x5A5A5A5A, p, length));
+        }
+    }
+}
+
+TEST(test_crc, legacy_functions)
+{
+    std::vector<unsigned char> data = pattern(77);
+    unsigned char first, second;
+
+    ComputeCrc(CRC_A, &data[0], data.size(), &first, &second);
+    uint16_t crc = bitwiseCRC16Reflected(0x6363, &data[0], data.size());
+    ASSERT_EQ(crc & 0xff, first);
+    ASSERT_EQ(crc >> 8, second);
+
+    ComputeCrc(CRC_B, &data[0], data.size(), &first, &second);
+    crc = static_cast<uint16_t>(~bitwiseCRC16Reflected(0xFFFF, &data[0], data.size()));
+    ASSERT_EQ(crc & 0xff, first);
+    ASSERT_EQ(crc >> 8, second);
+
+    ComputeCrcKermit(&data[0], data.size(), &first, &second);
+    crc = bitwiseCRC16Reflected(0x0000, &data[0], data.size());
+    ASSERT_EQ(crc & 0xff, first);
+    ASSERT_EQ(crc >> 8, second);
+
+    ComputeCrcCCITT(0xFFFF, &data[0], data.size(), &first, &second);
+    crc = bitwiseCRC16CCITT(0xFFFF, &data[0], data.size());
+    ASSERT_EQ(crc & 0xff, first);
+    ASSERT_EQ(crc >> 8, second);
+
+    unsigned short kermit = 0;
+    for (size_t i = 0; i < data.size(); ++i)
+        kermit = UpdateCRCKermit(kermit, static_cast<char>(data[i]));
+    ASSERT_EQ(bitwiseCRC16Reflected(0x0000, &data[0], data.size()), kermit);
+}
+
+#ifdef LLA_BENCHMARK
+template <typename F>
+static double measure(F f, unsigned int iterations)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < iterations; ++i)
+        f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+TEST(benchmark_crc, throughput)
+{
+    const unsigned int iterations = 200;
+    std::vector<unsigned char> frame = pattern(4096);
+    const unsigned char *p = &frame[0];
+    volatile uint32_t sink = 0;
+
+    double ccittBitwise = measure([&]() { sink = sink + bitwiseCRC16CCITT(0x1D0F, p, frame.size()); }, iterations);
+    double ccittTable = measure([&]() { sink = sink + CRC::updateCRC16CCITT(0x1D0F, p, frame.size()); }, iterations);
+    double crcABitwise = measure([&]() { sink = sink + bitwiseCRC16Reflected(0x6363, p, frame.size()); }, iterations);
+    double crcATable = measure([&]() { sink = sink + CRC::crcA(p, frame.size()); }, iterations);
+    double crc32Bitwise = measure([&]() { sink = sink + bitwiseCRC32(0xFFFFFFFF, p, frame.size()); }, iterations);
+    double crc32Table = measure([&]() { sink = sink + CRC::updateCRC32Table(0xFFFFFFFF, p, frame.size()); }, iterations);
+    double crc32 = measure([&]() { sink = sink + CRC::updateCRC32(0xFFFFFFFF, p, frame.size()); }, iterations);
+
+    double megabytes = iterations * frame.size() / 1e6;
+    std::cout << "CRC16 CCITT: " << megabytes / ccittBitwise << " MB/s bitwise, " << megabytes / ccittTable << " MB/s slice-by-8" << std::endl;
+    std::cout << "CRC_A: " << megabytes / crcABitwise << " MB/s bytewise, " << megabytes / crcATable << " MB/s slice-by-8" << std::endl;
+    std::cout << "CRC32: " << megabytes / crc32Bitwise << " MB/s bitwise, " << megabytes / crc32Table << " MB/s slice-by-8, "
+              << megabytes / crc32 << " MB/s dispatched (PCLMULQDQ " << (CRC::hasCarrylessMultiply() ? "on" : "off") << ")" << std::endl;
+}
+#endif
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/crypto/des_engine.hpp>
+#include <logicalaccess/crypto/tomcrypt.h>
+#include <chrono>
+#include <vector>
+
+using namespace logicalaccess;
+
+static std::vector<unsigned char> pattern(size_t size, uint32_t seed)
+{
+    std::vector<unsigned char> data(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        seed    = seed * 1103515245 + 12345;
+        data[i] = static_cast<unsigned char>(seed >> 16);
+    }
+    return data;
+}
+
+// libtomcrypt, block by block, as the reference.
+static std::vector<unsigned char> reference(const std::vector<unsigned char> &key, const std::vector<unsigned char> &data, bool encrypt)
+{
+    symmetric_key skey;
+    std::vector<unsigned char> out(data.size());
+    if (key.size() == 8)
+        des_setup(&key[0], 8, 0, &skey);
+    else
+        des3_setup(&key[0], static_cast<int>(key.size()), 0, &skey);
+    for (size_t i = 0; i < data.size(); i += 8)
+    {
+        if (key.size() == 8)
+            encrypt ? des_ecb_encrypt(&data[i], &out[i], &skey) : des_ecb_decrypt(&data[i], &out[i], &skey);
+        else
+            encrypt ? des3_ecb_encrypt(&data[i], &out[i], &skey) : des3_ecb_decrypt(&data[i], &out[i], &skey);
+    }
+    return out;
+}
+
+TEST(test_des_engine, known_answer)
+{
+    const std::vector<unsigned char> key = {0x13, 0x34, 0x57, 0x79, 0x9B, 0xBC, 0xDF, 0xF1};
+    const std::vector<unsigned char> plain = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+    const std::vector<unsigned char> expected = {0x85, 0xE8, 0x13, 0x54, 0x0F, 0x0A, 0xB4, 0x05};
+
+    DESEngine engine(key);
+    DESEngine::Backend backends[] = {DESEngine::DES_BACKEND_TABLE, DESEngine::DES_BACKEND_BITSLICE};
+    for (DESEngine::Backend backend : backends)
+    {
+        // The bitsliced implementation needs full slices, the block is repeated.
+        std::vector<unsigned char> data, out(64 * 8);
+        for (int i = 0; i < 64; ++i)
+            data.insert(data.end(), plain.begin(), plain.end());
+        engine.process(backend, true, &data[0], data.size(), &out[0]);
+        for (size_t i = 0; i < out.size(); i += 8)
+            ASSERT_EQ(expected, std::vector<unsigned char>(out.begin() + i, out.begin() + i + 8)) << "backend " << backend;
+
+        engine.process(backend, false, &out[0], out.size(), &out[0]);
+        ASSERT_EQ(data, out) << "backend " << backend;
+    }
+}
+
+TEST(test_des_engine, match_tomcrypt)
+{
+    size_t keySizes[] = {8, 16, 24};
+    size_t blockCounts[] = {0, 1, 7, 63, 64, 65, 255, 256, 257, 600};
+    DESEngine::Backend backends[] = {DESEngine::DES_BACKEND_TABLE, DESEngine::DES_BACKEND_BITSLICE};
+
+    for (size_t keySize : keySizes)
+    {
+        std::vector<unsigned char> key = pattern(keySize, static_cast<uint32_t>(keySize));
+        DESEngine engine(key);
+        for (size_t blocks : blockCounts)
+        {
+            std::vector<unsigned char> data = pattern(blocks * 8, static_cast<uint32_t>(blocks));
+            std::vector<unsigned char> encrypted = reference(key, data, true);
+            std::vector<unsigned char> decrypted = reference(key, data, false);
+
+            for (DESEngine::Backend backend : backends)
+            {
+                std::vector<unsigned char> out(data.size());
+                engine.process(backend, true, data.data(), data.size(), out.data());
+                ASSERT_EQ(encrypted, out) << keySize << " bytes key, " << blocks << " blocks, backend " << backend;
+                engine.process(backend, false, data.data(), data.size(), out.data());
+                ASSERT_EQ(decrypted, out) << keySize << " bytes key, " << blocks << " blocks, backend " << backend;
+            }
+
+            std::vector<unsigned char> out = data;
+            engine.encrypt(out.data(), out.size(), out.data());
+            ASSERT_EQ(encrypted, out);
+            out = data;
+            engine.decrypt(out.data(), out.size(), out.data());
+            ASSERT_EQ(decrypted, out);
+        }
+    }
+
+    ASSERT_THROW(DESEngine(std::vector<unsigned char>(12)), std::invalid_argument);
+}
+
+TEST(test_des_engine, cbc)
+{
+    std::vector<unsigned char> key = pattern(16, 0x1234);
+    std::vector<unsigned char> data = pattern(300 * 8, 0x5678);
+    std::vector<unsigned char> iv = pattern(8, 0x9ABC);
+
+    // CBC from the ECB reference.
+    std::vector<unsigned char> expected(data.size());
+    std::vector<unsigned char> chain = iv;
+    for (size_t i = 0; i < data.size(); i += 8)
+    {
+        std::vector<unsigned char> block(data.begin() + i, data.begin() + i + 8);
+        for (size_t j = 0; j < 8; ++j)
+            block[j] ^= chain[j];
+        chain = reference(key, block, true);
+        std::copy(chain.begin(), chain.end(), expected.begin() + i);
+    }
+
+    std::shared_ptr<DESEngine> engine = DESEngine::getEngine(key);
+    ASSERT_EQ(engine, DESEngine::getEngine(key));
+
+    std::vector<unsigned char> out(data.size());
+    std::vector<unsigned char> civ = iv;
+    engine->encryptCBC(data.data(), data.size(), civ.data(), out.data());
+    ASSERT_EQ(expected, out);
+    ASSERT_EQ(std::vector<unsigned char>(expected.end() - 8, expected.end()), civ);
+
+    civ = iv;
+    engine->decryptCBC(out.data(), out.size(), civ.data(), out.data());
+    ASSERT_EQ(data, out);
+    ASSERT_EQ(std::vector<unsigned char>(expected.end() - 8, expected.end()), civ);
+}
+
+#ifdef LLA_BENCHMARK
+TEST(benchmark_des_engine, ecb)
+{
+    const size_t blocks = 4096;
+    const unsigned int iterations = 20;
+    std::vector<unsigned char> key = pattern(16, 0x42);
+    std::vector<unsigned char> data = pattern(blocks * 8, 0x43);
+    DESEngine engine(key);
+
+    const char *names[] = {"tables", "bitsliced"};
+    double seconds[2];
+    for (int backend = 0; backend < 2; ++backend)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned int i = 0; i < iterations; ++i)
+            engine.process(static_cast<DESEngine::Backend>(backend), true, data.data(), data.size(), data.data());
+        seconds[backend] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    double megabytes = iterations * data.size() / 1e6;
+    std::cout << "2K3DES ECB:";
+    for (int backend = 0; backend < 2; ++backend)
+        std::cout << " " << megabytes / seconds[backend] << " MB/s " << names[backend] << (backend < 1 ? "," : "");
+    std::cout << " (" << DESEngine::getBitsliceBlocks() << " blocks per slice)" << std::endl;
+}
+#endif
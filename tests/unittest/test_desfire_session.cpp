@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/crypto/cmac.hpp>
+#include <logicalaccess/crypto/symmetric_cipher_session.hpp>
+#include <logicalaccess/crypto/aes_symmetric_key.hpp>
+#include <logicalaccess/crypto/aes_initialization_vector.hpp>
+#include <logicalaccess/crypto/des_symmetric_key.hpp>
+#include <logicalaccess/readerproviders/datatransport.hpp>
+#include <pluginscards/desfire/desfireev1chip.hpp>
+#include <pluginsreaderproviders/iso7816/commands/desfireev1iso7816commands.hpp>
+#include <pluginsreaderproviders/iso7816/readercardadapters/iso7816readercardadapter.hpp>
+#include <chrono>
+
+using namespace logicalaccess;
+
+static std::vector<unsigned char> pattern(size_t size, unsigned char seed)
+{
+    std::vector<unsigned char> data(size);
+    for (size_t i = 0; i < size; ++i)
+        data[i] = static_cast<unsigned char>(seed + i * 7);
+    return data;
+}
+
+TEST(test_desfire_session, session_matches_cmac_crypto)
+{
+    std::vector<unsigned char> aeskey = pattern(16, 0x10), deskey = pattern(24, 0x20);
+    openssl::AESCipher aes;
+    openssl::DESCipher des;
+    openssl::SymmetricCipherSession aesSession(aes, openssl::AESSymmetricKey::createFromData(aeskey));
+    openssl::SymmetricCipherSession desSession(des, openssl::DESSymmetricKey::createFromData(deskey));
+
+    for (size_t length = 0; length < 40; ++length)
+    {
+        std::vector<unsigned char> data = pattern(length, static_cast<unsigned char>(length));
+
+        std::vector<unsigned char> expected = openssl::CMACCrypto::cmac(aeskey, std::make_shared<openssl::AESCipher>(), 16, data, pattern(16, 0x01), 16);
+        ASSERT_EQ(std::vector<unsigned char>(expected.end() - 16, expected.end()), aesSession.cmac(data, pattern(16, 0x01)));
+
+        expected = openssl::CMACCrypto::cmac(deskey, std::make_shared<openssl::DESCipher>(), 8, data, pattern(8, 0x02), 8);
+        ASSERT_EQ(std::vector<unsigned char>(expected.end() - 8, expected.end()), desSession.cmac(data, pattern(8, 0x02)));
+    }
+
+    std::vector<unsigned char> plain = pattern(64, 0x33), ciphered, expected, deciphered;
+    aes.cipher(plain, expected, openssl::AESSymmetricKey::createFromData(aeskey), openssl::AESInitializationVector::createFromData(pattern(16, 0x05)), false);
+    aesSession.cipher(plain, pattern(16, 0x05), ciphered);
+    ASSERT_EQ(expected, ciphered);
+    aesSession.decipher(ciphered, pattern(16, 0x05), deciphered);
+    ASSERT_EQ(plain, deciphered);
+}
+
+/**
+ * A DESFire EV1 card answering ReadData in MAC communication mode.
+ */
+class DESFireMACTransport : public DataTransport
+{
+  public:
+    explicit DESFireMACTransport(std::shared_ptr<DESFireCrypto> card)
+        : exchanges(0)
+        , card_(card)
+    {
+    }
+
+    std::string getTransportType() const override
+    {
+        return "DESFireMAC";
+    }
+    bool connect() override
+    {
+        return true;
+    }
+    void disconnect() override
+    {
+    }
+    bool isConnected() override
+    {
+        return true;
+    }
+    std::string getName() const override
+    {
+        return "DESFireMAC";
+    }
+    void serialize(boost::property_tree::ptree &) override
+    {
+    }
+    void unSerialize(boost::property_tree::ptree &) override
+    {
+    }
+    std::string getDefaultXmlNodeName() const override
+    {
+        return "DESFireMACTransport";
+    }
+
+    std::vector<unsigned char> sendCommand(const std::vector<unsigned char> &command, long int) override
+    {
+        // Wrapped native command: 90 INS 00 00 Lc data 00
+        std::vector<unsigned char> native(1, command[1]);
+        native.insert(native.end(), command.begin() + 5, command.end() - 1);
+        EXPECT_EQ(DF_INS_READ_DATA, native[0]);
+        card_->desfire_cmac(native);
+        ++exchanges;
+
+        size_t offset = native[2] | (native[3] << 8) | (native[4] << 16);
+        size_t length = native[5] | (native[6] << 8) | (native[7] << 16);
+        std::vector<unsigned char> response = pattern(length, static_cast<unsigned char>(offset));
+        std::vector<unsigned char> macbuf = response;
+        macbuf.push_back(0x00);
+        std::vector<unsigned char> mac = card_->desfire_cmac(macbuf);
+        response.insert(response.end(), mac.begin(), mac.end());
+        response.push_back(0x91);
+        response.push_back(0x00);
+        return response;
+    }
+
+    unsigned int exchanges;
+
+  protected:
+    void send(const std::vector<unsigned char> &) override
+    {
+    }
+    std::vector<unsigned char> receive(long int) override
+    {
+        return std::vector<unsigned char>();
+    }
+
+    std::shared_ptr<DESFireCrypto> card_;
+};
+
+static void authenticateAES(std::shared_ptr<DESFireCrypto> crypto, const std::vector<unsigned char> &sessionKey)
+{
+    crypto->d_auth_method = CM_ISO;
+    crypto->d_sessionKey  = sessionKey;
+    crypto->d_cipher.reset(new openssl::AESCipher());
+    crypto->d_block_size = 16;
+    crypto->d_mac_size   = 8;
+    crypto->d_lastIV.assign(16, 0x00);
+}
+
+/**
+ * A DESFire EV1 chip reading a MAC protected file from the card, both sides sharing an AES session.
+ */
+struct MACReadSession
+{
+    explicit MACReadSession(unsigned int fileSize)
+        : card(new DESFireCrypto())
+        , chip(std::make_shared<DESFireEV1Chip>())
+        , commands(std::make_shared<DESFireEV1ISO7816Commands>())
+        , transport(std::make_shared<DESFireMACTransport>(card))
+        , sessionKey(pattern(16, 0x77))
+    {
+        auto adapter = std::make_shared<ISO7816ReaderCardAdapter>();
+        adapter->setDataTransport(transport);
+        commands->setReaderCardAdapter(adapter);
+        commands->setChip(chip);
+        chip->setCommands(commands);
+
+        authenticateAES(card, sessionKey);
+        authenticateAES(chip->getCrypto(), sessionKey);
+        chip->getCrypto()->initSession();
+
+        for (unsigned int offset = 0; offset < fileSize; offset += 248)
+        {
+            std::vector<unsigned char> chunk = pattern(std::min(248u, fileSize - offset), static_cast<unsigned char>(offset));
+            expected.insert(expected.end(), chunk.begin(), chunk.end());
+        }
+    }
+
+    std::shared_ptr<DESFireCrypto> card;
+    std::shared_ptr<DESFireEV1Chip> chip;
+    std::shared_ptr<DESFireEV1ISO7816Commands> commands;
+    std::shared_ptr<DESFireMACTransport> transport;
+    std::vector<unsigned char> sessionKey;
+    std::vector<unsigned char> expected;
+};
+
+TEST(test_desfire_session, read_data_mac)
+{
+    const unsigned int fileSize = 2048;
+    MACReadSession session(fileSize);
+
+    // The MAC chaining stays in step with the card across reads, 248 bytes per frame.
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        ASSERT_EQ(session.expected, session.commands->readData(0x01, 0, fileSize, CM_MAC));
+    }
+    ASSERT_EQ(3 * ((fileSize + 247) / 248), session.transport->exchanges);
+}
+
+#ifdef LLA_BENCHMARK
+TEST(benchmark_desfire_session, read_data_mac)
+{
+    const unsigned int iterations = 200;
+    const unsigned int fileSize   = 2048;
+    MACReadSession readSession(fileSize);
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        readSession.commands->readData(0x01, 0, fileSize, CM_MAC);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Per frame CMAC, with and without the session.
+    std::vector<unsigned char> frame = pattern(249, 0x00), iv(16, 0x00);
+    auto cipher                      = std::make_shared<openssl::AESCipher>();
+    auto cmacStart                   = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < iterations * 10; ++i)
+    {
+        std::vector<unsigned char> mac = openssl::CMACCrypto::cmac(readSession.sessionKey, cipher, 16, frame, iv, 16);
+        iv.assign(mac.end() - 16, mac.end());
+    }
+    double cmacSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - cmacStart).count();
+
+    openssl::SymmetricCipherSession session(*cipher, openssl::AESSymmetricKey::createFromData(readSession.sessionKey));
+    auto sessionStart = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < iterations * 10; ++i)
+    {
+        iv = session.cmac(frame, iv);
+    }
+    double sessionSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - sessionStart).count();
+
+    std::cout << iterations << " MAC protected readData of " << fileSize << " bytes: " << seconds * 1000 << " ms" << std::endl;
+    std::cout << iterations * 10 << " frame CMACs: " << cmacSeconds * 1000 << " ms without session, "
+              << sessionSeconds * 1000 << " ms with session" << std::endl;
+}
+#endif
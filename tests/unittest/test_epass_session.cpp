@@ -0,0 +1,443 @@
+#include "logicalaccess/lla_fwd.hpp"
+#include <gtest/gtest.h>
+#include <logicalaccess/crypto/des_helper.hpp>
+#include <logicalaccess/myexception.hpp>
+#include <logicalaccess/readerproviders/datatransport.hpp>
+#include <pluginscards/epass/epasscommands.hpp>
+#include <pluginscards/epass/epassreadercardadapter.hpp>
+#include <pluginscards/epass/utils.hpp>
+#include <chrono>
+#include <map>
+#include <thread>
+
+using namespace logicalaccess;
+
+static const std::string MRZ = "L898902C<3UTO6908061F9406236ZE184226B<<<<<14";
+static const ByteVector DG1 = {0x01, 0x01};
+static const ByteVector DG2 = {0x01, 0x02};
+static const ByteVector SOD = {0x01, 0x1D};
+
+/**
+ * An ePassport answering BAC, Select and Read Binary, in plain or in secure
+ * messaging, with an RF latency per exchange.
+ */
+class PassportTransport : public DataTransport
+{
+  public:
+    explicit PassportTransport(unsigned int latency = 0)
+        : max_read(65536)
+        , exchanges(0)
+        , authentications(0)
+        , failures(0)
+        , latency_(latency)
+        , sm_(false)
+    {
+        auto seed = EPassUtils::seed_from_mrz(MRZ);
+        k_enc_    = EPassUtils::compute_enc_key(seed);
+        k_mac_    = EPassUtils::compute_mac_key(seed);
+    }
+
+    void addFile(const ByteVector &file_id, uint8_t tag, size_t size)
+    {
+        // Tag, then a 0x82 length on 2 bytes.
+        ByteVector content = {tag, 0x82, static_cast<uint8_t>(size >> 8),
+                              static_cast<uint8_t>(size)};
+        for (size_t i = 0; i < size; ++i)
+            content.push_back(static_cast<uint8_t>(i * 7 + tag));
+        files[file_id] = content;
+    }
+
+    std::string getTransportType() const override
+    {
+        return "Passport";
+    }
+    bool connect() override
+    {
+        return true;
+    }
+    void disconnect() override
+    {
+    }
+    bool isConnected() override
+    {
+        return true;
+    }
+    std::string getName() const override
+    {
+        return "Passport";
+    }
+    void serialize(boost::property_tree::ptree &) override
+    {
+    }
+    void unSerialize(boost::property_tree::ptree &) override
+    {
+    }
+    std::string getDefaultXmlNodeName() const override
+    {
+        return "PassportTransport";
+    }
+
+    std::vector<unsigned char> sendCommand(const std::vector<unsigned char> &command, long int) override
+    {
+        ++exchanges;
+        if (latency_)
+            std::this_thread::sleep_for(std::chrono::microseconds(latency_));
+
+        if (command[0] == 0x0C)
+            return protectedCommand(command);
+
+        // Any plain command ends the secure messaging session.
+        sm_ = false;
+        ByteVector data;
+        if (command.size() > 5)
+            data = ByteVector(command.begin() + 5, command.begin() + 5 + command[4]);
+
+        if (command[1] == 0xA4)
+        {
+            if (command[2] == 0x02)
+                selected_ = data;
+            return {0x90, 0x00};
+        }
+        if (command[1] == 0x84)
+        {
+            rnd_icc_     = {0x46, 0x08, 0xF9, 0x19, 0x88, 0x70, 0x22, 0x12};
+            ByteVector r = rnd_icc_;
+            r.push_back(0x90);
+            r.push_back(0x00);
+            return r;
+        }
+        if (command[1] == 0x82)
+            return mutualAuthenticate(data);
+        return {0x6D, 0x00};
+    }
+
+    std::map<ByteVector, ByteVector> files;
+    size_t max_read;
+    int exchanges;
+    int authentications;
+    int failures;
+
+  protected:
+    void send(const std::vector<unsigned char> &) override
+    {
+    }
+    std::vector<unsigned char> receive(long int) override
+    {
+        return std::vector<unsigned char>();
+    }
+
+  private:
+    ByteVector mutualAuthenticate(const ByteVector &data)
+    {
+        EXPECT_EQ(40u, data.size());
+        ByteVector E_ifd(data.begin(), data.begin() + 32);
+        if (EPassUtils::compute_mac(EPassUtils::pad(E_ifd), k_mac_) !=
+            ByteVector(data.begin() + 32, data.end()))
+            return {0x63, 0x00};
+
+        auto S = DESHelper::DESDecrypt(E_ifd, k_enc_, {});
+        ByteVector rnd_ifd(S.begin(), S.begin() + 8);
+        ByteVector k_ifd(S.begin() + 16, S.end());
+        ByteVector k_icc(16, 0x5A);
+
+        ByteVector R = rnd_icc_;
+        R.insert(R.end(), rnd_ifd.begin(), rnd_ifd.end());
+        R.insert(R.end(), k_icc.begin(), k_icc.end());
+        auto E_icc = DESHelper::DESEncrypt(R, k_enc_, {});
+        auto M_icc = EPassUtils::compute_mac(EPassUtils::pad(E_icc), k_mac_);
+
+        ByteVector k_seed;
+        for (int i = 0; i < 16; ++i)
+            k_seed.push_back(k_icc[i] ^ k_ifd[i]);
+        ks_enc_ = EPassUtils::compute_enc_key(k_seed);
+        ks_mac_ = EPassUtils::compute_mac_key(k_seed);
+        ssc_    = ByteVector(rnd_icc_.begin() + 4, rnd_icc_.end());
+        ssc_.insert(ssc_.end(), rnd_ifd.begin() + 4, rnd_ifd.end());
+        sm_ = true;
+        ++authentications;
+
+        ByteVector r = E_icc;
+        r.insert(r.end(), M_icc.begin(), M_icc.end());
+        r.push_back(0x90);
+        r.push_back(0x00);
+        return r;
+    }
+
+    ByteVector fail()
+    {
+        ++failures;
+        sm_ = false;
+        return {0x69, 0x88};
+    }
+
+    static size_t readLength(const ByteVector &buf, size_t &pos)
+    {
+        size_t len = buf[pos++];
+        if (len == 0x81)
+            len = buf[pos++];
+        else if (len == 0x82)
+        {
+            len = (buf[pos] << 8) | buf[pos + 1];
+            pos += 2;
+        }
+        return len;
+    }
+
+    ByteVector protectedCommand(const ByteVector &command)
+    {
+        if (!sm_)
+            return fail();
+
+        size_t pos = 4;
+        if (command[pos] == 0x00)
+            pos += 3;
+        else
+            pos += 1;
+
+        ByteVector do_87, do_97, data;
+        size_t mac_pos = 0;
+        while (pos < command.size() && command[pos] != 0x8E)
+        {
+            size_t start = pos;
+            uint8_t tag  = command[pos++];
+            size_t len   = readLength(command, pos);
+            ByteVector obj(command.begin() + start, command.begin() + pos + len);
+            if (tag == 0x87)
+            {
+                do_87 = obj;
+                data  = EPassUtils::unpad(DESHelper::DESDecrypt(
+                    ByteVector(command.begin() + pos + 1, command.begin() + pos + len), ks_enc_, {}));
+            }
+            else if (tag == 0x97)
+                do_97 = obj;
+            pos += len;
+        }
+        mac_pos = pos;
+
+        // Check the command MAC.
+        ssc_         = EPassUtils::increment_ssc(ssc_);
+        ByteVector M = ssc_;
+        auto header  = EPassUtils::pad(ByteVector(command.begin(), command.begin() + 4));
+        M.insert(M.end(), header.begin(), header.end());
+        M.insert(M.end(), do_87.begin(), do_87.end());
+        M.insert(M.end(), do_97.begin(), do_97.end());
+        if (mac_pos + 10 > command.size() ||
+            EPassUtils::compute_mac(EPassUtils::pad(M), ks_mac_) !=
+                ByteVector(command.begin() + mac_pos + 2, command.begin() + mac_pos + 10))
+            return fail();
+
+        ByteVector response;
+        if (command[1] == 0xA4)
+        {
+            selected_ = data;
+        }
+        else if (command[1] == 0xB0)
+        {
+            size_t offset = (command[2] << 8) | command[3];
+            size_t le     = do_97[2];
+            if (do_97[1] == 2)
+                le = (le << 8) | do_97[3];
+            if (le == 0)
+                le = (do_97[1] == 2) ? 65536 : 256;
+            if (le > max_read)
+                return fail();
+
+            const ByteVector &file = files.at(selected_);
+            response.assign(file.begin() + std::min(offset, file.size()),
+                            file.begin() + std::min(offset + le, file.size()));
+        }
+
+        ssc_ = EPassUtils::increment_ssc(ssc_);
+        ByteVector r;
+        if (response.size())
+        {
+            auto encrypted = DESHelper::DESEncrypt(EPassUtils::pad(response), ks_enc_, {});
+            size_t len     = encrypted.size() + 1;
+            r.push_back(0x87);
+            if (len >= 0x100)
+            {
+                r.push_back(0x82);
+                r.push_back(static_cast<uint8_t>(len >> 8));
+            }
+            else if (len >= 0x80)
+                r.push_back(0x81);
+            r.push_back(static_cast<uint8_t>(len));
+            r.push_back(0x01);
+            r.insert(r.end(), encrypted.begin(), encrypted.end());
+        }
+        r.insert(r.end(), {0x99, 0x02, 0x90, 0x00});
+        ByteVector K = ssc_;
+        K.insert(K.end(), r.begin(), r.end());
+        auto CC = EPassUtils::compute_mac(EPassUtils::pad(K), ks_mac_);
+        r.push_back(0x8E);
+        r.push_back(0x08);
+        r.insert(r.end(), CC.begin(), CC.end());
+        r.push_back(0x90);
+        r.push_back(0x00);
+        return r;
+    }
+
+    unsigned int latency_;
+    ByteVector k_enc_, k_mac_, ks_enc_, ks_mac_, ssc_, rnd_icc_, selected_;
+    bool sm_;
+};
+
+static std::shared_ptr<EPassCommand> insertPassport(std::shared_ptr<PassportTransport> transport)
+{
+    auto adapter  = std::make_shared<EPassReaderCardAdapter>();
+    auto commands = std::make_shared<EPassCommand>();
+    adapter->setDataTransport(transport);
+    commands->setReaderCardAdapter(adapter);
+    return commands;
+}
+
+static void openSession(std::shared_ptr<EPassCommand> commands)
+{
+    commands->selectIssuerApplication();
+    ASSERT_TRUE(commands->authenticate(MRZ));
+}
+
+TEST(test_epass_session, session_reuse)
+{
+    auto transport = std::make_shared<PassportTransport>();
+    transport->addFile(DG1, 0x61, 90);
+    transport->addFile(DG2, 0x75, 3000);
+    auto commands = insertPassport(transport);
+
+    openSession(commands);
+    ASSERT_EQ(transport->files[DG1], commands->readFile(DG1, 2, 2));
+
+    // The second service call keeps the session: no RF exchange before the read.
+    int before = transport->exchanges;
+    openSession(commands);
+    ASSERT_EQ(before, transport->exchanges);
+    ASSERT_EQ(transport->files[DG2], commands->readFile(DG2, 2, 2));
+    ASSERT_EQ(1, transport->authentications);
+    ASSERT_EQ(0, transport->failures);
+
+    // A reset session is opened again with a full BAC.
+    commands->resetSession();
+    openSession(commands);
+    ASSERT_EQ(2, transport->authentications);
+}
+
+TEST(test_epass_session, file_cache)
+{
+    auto transport = std::make_shared<PassportTransport>();
+    transport->addFile(DG2, 0x75, 3000);
+    auto commands = insertPassport(transport);
+
+    openSession(commands);
+    auto dg2   = commands->readFile(DG2, 2, 2);
+    int before = transport->exchanges;
+    ASSERT_EQ(dg2, commands->readFile(DG2, 2, 2));
+    ASSERT_EQ(before, transport->exchanges);
+
+    // Another MRZ does not get the cached content.
+    ASSERT_THROW(commands->authenticate("L898902D<3UTO6908061F9406236ZE184226B<<<<<14"),
+                 LibLogicalAccessException);
+    commands->resetSession();
+    openSession(commands);
+    before = transport->exchanges;
+    ASSERT_EQ(dg2, commands->readFile(DG2, 2, 2));
+    ASSERT_LT(before, transport->exchanges);
+}
+
+TEST(test_epass_session, chunk_size)
+{
+    auto transport = std::make_shared<PassportTransport>();
+    transport->addFile(DG2, 0x75, 5000);
+    auto commands = insertPassport(transport);
+    openSession(commands);
+    commands->selectEF(DG2);
+
+    // Short APDUs: 231 plain bytes fit in a 256 bytes protected response.
+    ASSERT_EQ(231u, commands->getReadSize());
+    int before = transport->exchanges;
+    ASSERT_EQ(transport->files[DG2], commands->readEF(2, 2));
+    ASSERT_EQ(1 + (5000 + 230) / 231, transport->exchanges - before);
+
+    // Extended APDUs: the whole file after the header.
+    std::dynamic_pointer_cast<ISO7816ReaderCardAdapter>(commands->getReaderCardAdapter())
+        ->setMaxDataLengths(65535, 65536);
+    before = transport->exchanges;
+    ASSERT_EQ(transport->files[DG2], commands->readEF(2, 2));
+    ASSERT_EQ(2, transport->exchanges - before);
+    ASSERT_EQ(0, transport->failures);
+}
+
+TEST(test_epass_session, adaptive_read_size)
+{
+    auto transport      = std::make_shared<PassportTransport>();
+    transport->max_read = 1000;
+    transport->addFile(DG2, 0x75, 20000);
+    transport->addFile(SOD, 0x77, 4000);
+    auto commands = insertPassport(transport);
+    std::dynamic_pointer_cast<ISO7816ReaderCardAdapter>(commands->getReaderCardAdapter())
+        ->setMaxDataLengths(65535, 65536);
+    openSession(commands);
+
+    // Each failure ends the session: it is opened again with smaller chunks.
+    ASSERT_EQ(transport->files[DG2], commands->readFile(DG2, 2, 2));
+    ASSERT_GE(1000u, commands->getReadSize());
+    ASSERT_LT(500u, commands->getReadSize());
+    ASSERT_LT(1, transport->authentications);
+
+    // The size that verified is kept for the next files.
+    int failures        = transport->failures;
+    int authentications = transport->authentications;
+    ASSERT_EQ(transport->files[SOD], commands->readFile(SOD, 2, 2));
+    ASSERT_EQ(failures, transport->failures);
+    ASSERT_EQ(authentications, transport->authentications);
+}
+
+TEST(test_epass_session, cached_reads)
+{
+    auto transport = std::make_shared<PassportTransport>();
+    transport->addFile(DG1, 0x61, 90);
+    transport->addFile(DG2, 0x75, 20000);
+    auto commands = insertPassport(transport);
+
+    openSession(commands);
+    commands->readFile(DG1, 2, 2);
+    openSession(commands);
+    commands->readFile(DG2, 2, 2);
+    int exchanges = transport->exchanges;
+    // Application selection and BAC, then for each file its selection, the header and the chunks.
+    ASSERT_EQ(3 + (2 + 1) + (2 + (20000 + 230) / 231), exchanges);
+
+    // The next service calls use the session and the cache.
+    openSession(commands);
+    ASSERT_EQ(transport->files[DG1], commands->readFile(DG1, 2, 2));
+    ASSERT_EQ(transport->files[DG2], commands->readFile(DG2, 2, 2));
+    ASSERT_EQ(exchanges, transport->exchanges);
+    ASSERT_EQ(1, transport->authentications);
+}
+
+#ifdef LLA_BENCHMARK
+TEST(benchmark_epass_session, read)
+{
+    // 20KB portrait, 1ms per RF exchange.
+    auto transport = std::make_shared<PassportTransport>(1000);
+    transport->addFile(DG1, 0x61, 90);
+    transport->addFile(DG2, 0x75, 20000);
+    auto commands = insertPassport(transport);
+
+    auto start = std::chrono::steady_clock::now();
+    openSession(commands);
+    commands->readFile(DG1, 2, 2);
+    openSession(commands);
+    commands->readFile(DG2, 2, 2);
+    double first = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    int exchanges = transport->exchanges;
+
+    start = std::chrono::steady_clock::now();
+    openSession(commands);
+    commands->readFile(DG1, 2, 2);
+    commands->readFile(DG2, 2, 2);
+    double second = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "DG1 and 20KB DG2: " << exchanges << " exchanges, " << first * 1000
+              << " ms; cached: " << second * 1000 << " ms, " << transport->exchanges - exchanges << " exchanges" << std::endl;
+}
+#endif
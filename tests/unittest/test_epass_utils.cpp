@@ -3,6 +3,7 @@
 #include <gtest/gtest.h>
 #include <iostream>
 #include <logicalaccess/bufferhelper.hpp>
+#include <logicalaccess/crypto/des_helper.hpp>
 #include <logicalaccess/logs.hpp>
 #include <pluginscards/epass/epasscrypto.hpp>
 
@@ -220,4 +221,69 @@ TEST(test_epass_utils, test_parse_dg1)
     ASSERT_EQ("<<<<<<<<<<<<<<", dg1.optional_data_);
     ASSERT_EQ("<", dg1.checksum_optional_data_);
     ASSERT_EQ("2", dg1.checksum_);
-}
\ No newline at end of file
+}
+TEST(test_epass_utils, test_secure_messaging_long_response)
+{
+    auto ks_enc = BufferHelper::fromHexString("979EC13B1CBFE9DCD01AB0FED307EAE5");
+    auto ks_mac = BufferHelper::fromHexString("F1CB1F1FB5ADF208806B89DC579DC1F8");
+    auto ssc    = BufferHelper::fromHexString("887022120C06C22B");
+
+    // 200 bytes of data need a 2-byte BER length in DO87.
+    ByteVector plain(200);
+    for (size_t i = 0; i < plain.size(); ++i)
+        plain[i] = static_cast<uint8_t>(i);
+    auto encrypted = DESHelper::DESEncrypt(EPassUtils::pad(plain), ks_enc, {});
+
+    ByteVector do_87 = {0x87, 0x81, static_cast<uint8_t>(encrypted.size() + 1), 0x01};
+    do_87.insert(do_87.end(), encrypted.begin(), encrypted.end());
+    ByteVector do_99 = {0x99, 0x02, 0x90, 0x00};
+
+    ByteVector K = EPassUtils::increment_ssc(ssc);
+    K.insert(K.end(), do_87.begin(), do_87.end());
+    K.insert(K.end(), do_99.begin(), do_99.end());
+    auto CC = EPassUtils::compute_mac(EPassUtils::pad(K), ks_mac);
+
+    ByteVector rapdu(do_87);
+    rapdu.insert(rapdu.end(), do_99.begin(), do_99.end());
+    rapdu.push_back(0x8E);
+    rapdu.push_back(0x08);
+    rapdu.insert(rapdu.end(), CC.begin(), CC.end());
+    rapdu.push_back(0x90);
+    rapdu.push_back(0x00);
+
+    auto expected = plain;
+    expected.push_back(0x90);
+    expected.push_back(0x00);
+    ASSERT_EQ(expected, EPassUtils::decrypt_rapdu(rapdu, ks_enc, ks_mac, ssc));
+}
+
+TEST(test_epass_utils, test_secure_messaging_extended)
+{
+    auto ks_enc = BufferHelper::fromHexString("979EC13B1CBFE9DCD01AB0FED307EAE5");
+    auto ks_mac = BufferHelper::fromHexString("F1CB1F1FB5ADF208806B89DC579DC1F8");
+    auto ssc    = BufferHelper::fromHexString("887022120C06C228");
+
+    // An extended Le gives a 2-byte DO97, and an extended protected APDU.
+    auto encrypted_apdu = EPassUtils::encrypt_apdu(
+        BufferHelper::fromHexString("00B00000000200"), ks_enc, ks_mac, ssc);
+    ASSERT_EQ(23u, encrypted_apdu.size());
+    ASSERT_EQ(BufferHelper::fromHexString("0CB0000000000E970202008E08"),
+              ByteVector(encrypted_apdu.begin(), encrypted_apdu.begin() + 13));
+    ASSERT_EQ(BufferHelper::fromHexString("0000"),
+              ByteVector(encrypted_apdu.end() - 2, encrypted_apdu.end()));
+
+    // A short Le keeps the short form.
+    encrypted_apdu = EPassUtils::encrypt_apdu(BufferHelper::fromHexString("00B0000004"),
+                                              ks_enc, ks_mac, ssc);
+    ASSERT_EQ(BufferHelper::fromHexString("0CB000000D9701048E08ED6705417E96BA5500"),
+              encrypted_apdu);
+}
+
+TEST(test_epass_utils, test_max_plain_response_length)
+{
+    // 231 bytes are padded to 232, and take 236 bytes in DO87: 250 with DO99 and DO8E.
+    ASSERT_EQ(231u, EPassUtils::max_plain_response_length(256));
+    ASSERT_EQ(0u, EPassUtils::max_plain_response_length(20));
+    ASSERT_EQ(7u, EPassUtils::max_plain_response_length(25));
+    ASSERT_LT(65000u, EPassUtils::max_plain_response_length(65536));
+}
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/services/accesscontrol/formatbatchdecoder.hpp>
+#include <logicalaccess/services/accesscontrol/formats/wiegand26format.hpp>
+#include <logicalaccess/services/accesscontrol/formats/corporate1000format.hpp>
+#include <logicalaccess/services/accesscontrol/formats/customformat/customformat.hpp>
+#include <logicalaccess/services/accesscontrol/formats/customformat/numberdatafield.hpp>
+#include <logicalaccess/services/accesscontrol/formats/customformat/paritydatafield.hpp>
+#include <logicalaccess/myexception.hpp>
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+using namespace logicalaccess;
+
+static std::vector<unsigned char> create_payloads(size_t count, std::vector<unsigned char> &expectedOk,
+                                                  std::vector<unsigned long long> &expectedFc,
+                                                  std::vector<unsigned long long> &expectedUid)
+{
+    std::mt19937 rng(26);
+    std::vector<unsigned char> payloads(count * 4, 0x00);
+    expectedOk.resize(count);
+    expectedFc.resize(count);
+    expectedUid.resize(count);
+
+    Wiegand26Format format;
+    for (size_t i = 0; i < count; ++i)
+    {
+        expectedFc[i] = rng() & 0xff;
+        expectedUid[i] = rng() & 0xffff;
+        format.setFacilityCode(static_cast<unsigned char>(expectedFc[i]));
+        format.setUid(expectedUid[i]);
+        format.getLinearData(&payloads[i * 4], 4);
+
+        expectedOk[i] = (i % 97) != 0;
+        if (!expectedOk[i])
+        {
+            // Flip the left parity bit. The numbers are not reported.
+            payloads[i * 4] ^= 0x80;
+            expectedFc[i] = 0;
+            expectedUid[i] = 0;
+        }
+    }
+
+    return payloads;
+}
+
+TEST(test_format_batch, wiegand26)
+{
+    const size_t count = 20000;
+    std::vector<unsigned char> expectedOk;
+    std::vector<unsigned long long> expectedFc, expectedUid;
+    std::vector<unsigned char> payloads = create_payloads(count, expectedOk, expectedFc, expectedUid);
+    size_t expectedValid = std::count(expectedOk.begin(), expectedOk.end(), 1);
+
+    for (unsigned int threads : {1u, 4u, 0u})
+    {
+        FormatBatchDecoder decoder(std::make_shared<Wiegand26Format>());
+        decoder.setThreadCount(threads);
+        decoder.setMinimumChunkSize(1000);
+
+        DecodedCredentials credentials;
+        ASSERT_EQ(expectedValid, decoder.decode(&payloads[0], 4, count, credentials));
+        ASSERT_EQ(expectedOk, credentials.parityOk);
+        ASSERT_EQ(expectedFc, credentials.facilityCodes);
+        ASSERT_EQ(expectedUid, credentials.cardNumbers);
+    }
+}
+
+TEST(test_format_batch, custom_field_names)
+{
+    Corporate1000Format format;
+    format.setCompanyCode(0x123);
+    format.setUid(0x54321);
+    std::vector<unsigned char> payload(5, 0x00);
+    format.getLinearData(&payload[0], payload.size());
+
+    FormatBatchDecoder decoder(std::make_shared<Corporate1000Format>(), "CompanyCode");
+    unsigned long long companyCode = 0, uid = 0;
+    unsigned char ok = 0;
+    ASSERT_EQ(1u, decoder.decode(&payload[0], payload.size(), 1, &companyCode, &uid, &ok));
+    ASSERT_EQ(1, ok);
+    ASSERT_EQ(0x123u, companyCode);
+    ASSERT_EQ(0x54321u, uid);
+
+    ASSERT_THROW(decoder.decode(&payload[0], 2, 1, &companyCode, &uid, &ok), std::invalid_argument);
+}
+
+/**
+ * A Wiegand 26 format rejecting the payloads starting with 0xFF as malformed.
+ */
+class MalformedWiegand26Format : public Wiegand26Format
+{
+  public:
+    void setLinearData(const void *data, size_t dataLengthBytes) override
+    {
+        if (reinterpret_cast<const unsigned char *>(data)[0] == 0xFF)
+            throw LibLogicalAccessException("Malformed payload.");
+        Wiegand26Format::setLinearData(data, dataLengthBytes);
+    }
+
+    std::shared_ptr<Format> clone() const override
+    {
+        return std::make_shared<MalformedWiegand26Format>();
+    }
+};
+
+TEST(test_format_batch, custom_format_parity_first)
+{
+    // The parity field is decoded before the numbers.
+    std::shared_ptr<CustomFormat> format(new CustomFormat());
+    std::shared_ptr<ParityDataField> parity(new ParityDataField());
+    parity->setName("Parity");
+    parity->setPosition(0);
+    parity->setParityType(PT_EVEN);
+    std::vector<unsigned int> positions;
+    for (unsigned int i = 1; i < 25; ++i)
+        positions.push_back(i);
+    parity->setBitsUsePositions(positions);
+    std::shared_ptr<NumberDataField> fc(new NumberDataField());
+    fc->setName("FacilityCode");
+    fc->setPosition(1);
+    fc->setDataLength(8);
+    std::shared_ptr<NumberDataField> uid(new NumberDataField());
+    uid->setName("Uid");
+    uid->setIsIdentifier(true);
+    uid->setPosition(9);
+    uid->setDataLength(16);
+    std::list<std::shared_ptr<DataField>> fields = {parity, fc, uid};
+    format->setFieldList(fields);
+
+    std::vector<unsigned char> payloads(8, 0x00);
+    fc->setValue(0x12);
+    uid->setValue(0x3456);
+    format->getLinearData(&payloads[0], 4);
+    fc->setValue(0x21);
+    uid->setValue(0x6543);
+    format->getLinearData(&payloads[4], 4);
+    payloads[4] ^= 0x80;
+
+    FormatBatchDecoder decoder(format);
+    DecodedCredentials credentials;
+    ASSERT_EQ(1u, decoder.decode(&payloads[0], 4, 2, credentials));
+    ASSERT_EQ(std::vector<unsigned char>({1, 0}), credentials.parityOk);
+    ASSERT_EQ(std::vector<unsigned long long>({0x12, 0}), credentials.facilityCodes);
+    ASSERT_EQ(std::vector<unsigned long long>({0x3456, 0}), credentials.cardNumbers);
+}
+
+TEST(test_format_batch, malformed_payload)
+{
+    std::vector<unsigned char> payloads(8, 0x00);
+    Wiegand26Format format;
+    format.getLinearData(&payloads[0], 4);
+    payloads[4] = 0xFF;
+
+    // Only the parity errors are reported per payload.
+    FormatBatchDecoder decoder(std::make_shared<MalformedWiegand26Format>());
+    DecodedCredentials credentials;
+    ASSERT_THROW(decoder.decode(&payloads[0], 4, 2, credentials), LibLogicalAccessException);
+    ASSERT_EQ(1u, decoder.decode(&payloads[0], 4, 1, credentials));
+}
+
+#ifdef LLA_BENCHMARK
+TEST(benchmark_format_batch, decode)
+{
+    const size_t count = 200000;
+    std::vector<unsigned char> expectedOk;
+    std::vector<unsigned long long> expectedFc, expectedUid;
+    std::vector<unsigned char> payloads = create_payloads(count, expectedOk, expectedFc, expectedUid);
+
+    FormatBatchDecoder decoder(std::make_shared<Wiegand26Format>());
+    decoder.setThreadCount(0);
+    DecodedCredentials credentials;
+    auto start = std::chrono::steady_clock::now();
+    decoder.decode(&payloads[0], 4, count, credentials);
+    double batchSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // One format object per payload, as done before the batch API.
+    const size_t singleCount = count / 10;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < singleCount; ++i)
+    {
+        std::shared_ptr<Wiegand26Format> format(new Wiegand26Format());
+        try
+        {
+            format->setLinearData(&payloads[i * 4], 4);
+            credentials.facilityCodes[i] = format->getFacilityCode();
+            credentials.cardNumbers[i] = format->getUid();
+        }
+        catch (LibLogicalAccessException&)
+        {
+        }
+    }
+    double singleSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Batch: " << static_cast<long>(count / batchSeconds) << " decodes/s, "
+              << "one format per payload: " << static_cast<long>(singleCount / singleSeconds) << " decodes/s"
+              << std::endl;
+}
+#endif
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/services/accesscontrol/formats/wiegand26format.hpp>
+#include <logicalaccess/services/accesscontrol/formats/corporate1000format.hpp>
+#include <logicalaccess/services/accesscontrol/formats/customformat/customformat.hpp>
+#include <logicalaccess/services/accesscontrol/formats/customformat/numberdatafield.hpp>
+#include <logicalaccess/services/accesscontrol/formats/customformat/paritydatafield.hpp>
+#include <chrono>
+
+using namespace logicalaccess;
+
+static std::shared_ptr<CustomFormat> create_custom_format()
+{
+    std::shared_ptr<CustomFormat> format(new CustomFormat());
+    std::list<std::shared_ptr<DataField>> fields;
+
+    std::shared_ptr<NumberDataField> fc(new NumberDataField());
+    fc->setName("FacilityCode");
+    fc->setPosition(1);
+    fc->setDataLength(8);
+    fields.push_back(fc);
+
+    std::shared_ptr<NumberDataField> uid(new NumberDataField());
+    uid->setName("Uid");
+    uid->setIsIdentifier(true);
+    uid->setPosition(9);
+    uid->setDataLength(16);
+    fields.push_back(uid);
+
+    std::shared_ptr<ParityDataField> parity(new ParityDataField());
+    parity->setName("Parity");
+    parity->setPosition(0);
+    parity->setParityType(PT_EVEN);
+    std::vector<unsigned int> positions;
+    for (unsigned int i = 1; i < 13; ++i)
+        positions.push_back(i);
+    parity->setBitsUsePositions(positions);
+    fields.push_back(parity);
+
+    format->setName("Custom26");
+    format->setFieldList(fields);
+    return format;
+}
+
+static std::string to_xml(std::shared_ptr<Format> format)
+{
+    return format->serialize();
+}
+
+static std::shared_ptr<Format> xml_copy(std::shared_ptr<Format> format)
+{
+    std::shared_ptr<Format> ret = Format::getByFormatType(format->getType());
+    ret->unSerialize(format->serialize(), "");
+    return ret;
+}
+
+TEST(test_format_clone, wiegand26)
+{
+    std::shared_ptr<Wiegand26Format> format(new Wiegand26Format());
+    format->setFacilityCode(42);
+    format->setUid(1234);
+
+    std::shared_ptr<Wiegand26Format> copy = std::dynamic_pointer_cast<Wiegand26Format>(format->clone());
+    ASSERT_TRUE(copy);
+    ASSERT_EQ(42, copy->getFacilityCode());
+    ASSERT_EQ(1234u, copy->getUid());
+    ASSERT_TRUE(format->checkSkeleton(copy));
+    ASSERT_EQ(to_xml(format), to_xml(copy));
+
+    // The clone must not share its fields with the original.
+    copy->setUid(4321);
+    ASSERT_EQ(1234u, format->getUid());
+}
+
+TEST(test_format_clone, corporate1000)
+{
+    std::shared_ptr<Corporate1000Format> format(new Corporate1000Format());
+    format->setCompanyCode(0x123);
+    format->setUid(0x54321);
+
+    std::shared_ptr<Format> copy = format->clone();
+    ASSERT_EQ(to_xml(format), to_xml(copy));
+    ASSERT_EQ(to_xml(format), to_xml(xml_copy(format)));
+}
+
+TEST(test_format_clone, custom)
+{
+    std::shared_ptr<CustomFormat> format = create_custom_format();
+    std::shared_ptr<Format> copy = format->clone();
+
+    ASSERT_EQ(to_xml(format), to_xml(copy));
+    ASSERT_TRUE(format->checkSkeleton(copy));
+
+    std::vector<unsigned char> linear(4, 0x00);
+    std::dynamic_pointer_cast<NumberDataField>(format->getFieldFromName("Uid"))->setValue(0xBEEF);
+    format->getLinearData(&linear[0], linear.size());
+    copy->setLinearData(&linear[0], linear.size());
+    ASSERT_EQ(0xBEEF, std::dynamic_pointer_cast<NumberDataField>(copy->getFieldFromName("Uid"))->getValue());
+    ASSERT_NE(format->getFieldFromName("Uid"), copy->getFieldFromName("Uid"));
+}
+
+#ifdef LLA_BENCHMARK
+static void decode_benchmark(const std::string &name, std::shared_ptr<Format> format)
+{
+    const int iterations = 100000;
+    std::vector<unsigned char> linear((format->getDataLength() + 7) / 8, 0x00);
+    format->getLinearData(&linear[0], linear.size());
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        std::shared_ptr<Format> copy = format->clone();
+        copy->setLinearData(&linear[0], linear.size());
+    }
+    double cloneSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const int xmlIterations = iterations / 10;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < xmlIterations; ++i)
+    {
+        std::shared_ptr<Format> copy = xml_copy(format);
+        copy->setLinearData(&linear[0], linear.size());
+    }
+    double xmlSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << name << ": clone() " << static_cast<long>(iterations / cloneSeconds)
+              << " decodes/s, XML round-trip " << static_cast<long>(xmlIterations / xmlSeconds)
+              << " decodes/s" << std::endl;
+}
+
+TEST(benchmark_format_clone, decode)
+{
+    std::shared_ptr<Wiegand26Format> wiegand26(new Wiegand26Format());
+    wiegand26->setFacilityCode(42);
+    wiegand26->setUid(1234);
+    decode_benchmark("Wiegand26", wiegand26);
+
+    std::shared_ptr<Corporate1000Format> corporate1000(new Corporate1000Format());
+    corporate1000->setCompanyCode(0x123);
+    corporate1000->setUid(0x54321);
+    decode_benchmark("Corporate1000", corporate1000);
+
+    decode_benchmark("CustomFormat", create_custom_format());
+}
+#endif
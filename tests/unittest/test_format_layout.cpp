@@ -0,0 +1,292 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/myexception.hpp>
+#include <logicalaccess/services/accesscontrol/formats/bithelper.hpp>
+#include <logicalaccess/services/accesscontrol/formats/wiegand26format.hpp>
+#include <logicalaccess/services/accesscontrol/formats/corporate1000format.hpp>
+#include <logicalaccess/services/accesscontrol/formats/customformat/customformat.hpp>
+#include <logicalaccess/services/accesscontrol/formats/customformat/numberdatafield.hpp>
+#include <logicalaccess/services/accesscontrol/formats/customformat/paritydatafield.hpp>
+#include <logicalaccess/services/accesscontrol/encodings/bcdnibbledatatype.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <thread>
+
+using namespace logicalaccess;
+
+static unsigned char get_bit(const std::vector<unsigned char> &data, unsigned int pos)
+{
+    return (data[pos / 8] >> (7 - (pos % 8))) & 0x01;
+}
+
+static std::shared_ptr<CustomFormat> create_custom_format()
+{
+    std::shared_ptr<CustomFormat> format(new CustomFormat());
+    std::list<std::shared_ptr<DataField>> fields;
+
+    std::shared_ptr<NumberDataField> fc(new NumberDataField());
+    fc->setName("FacilityCode");
+    fc->setPosition(1);
+    fc->setDataLength(12);
+    fields.push_back(fc);
+
+    std::shared_ptr<NumberDataField> uid(new NumberDataField());
+    uid->setName("Uid");
+    uid->setIsIdentifier(true);
+    uid->setPosition(13);
+    uid->setDataLength(64);
+    fields.push_back(uid);
+
+    std::shared_ptr<ParityDataField> left(new ParityDataField());
+    left->setName("LeftParity");
+    left->setPosition(0);
+    left->setParityType(PT_EVEN);
+    std::shared_ptr<ParityDataField> right(new ParityDataField());
+    right->setName("RightParity");
+    right->setPosition(77);
+    right->setParityType(PT_ODD);
+    std::vector<unsigned int> leftPositions, rightPositions;
+    for (unsigned int i = 1; i < 77; ++i)
+        (i < 39 ? leftPositions : rightPositions).push_back(i);
+    left->setBitsUsePositions(leftPositions);
+    right->setBitsUsePositions(rightPositions);
+    fields.push_back(right);
+    fields.push_back(left);
+
+    format->setName("Custom78");
+    format->setFieldList(fields);
+    return format;
+}
+
+/**
+ * Encode with each field own linear data method, as CustomFormat did before
+ * the layout was compiled.
+ */
+static void field_by_field_encode(std::shared_ptr<CustomFormat> format, std::vector<unsigned char> &data)
+{
+    std::list<std::shared_ptr<DataField>> fields = format->getFieldList();
+    std::fill(data.begin(), data.end(), 0x00);
+    for (auto &field : fields)
+    {
+        unsigned int pos = field->getPosition();
+        field->getLinearData(&data[0], data.size(), &pos);
+    }
+}
+
+static void field_by_field_decode(std::shared_ptr<CustomFormat> format, const std::vector<unsigned char> &data)
+{
+    std::list<std::shared_ptr<DataField>> fields = format->getFieldList();
+    for (auto &field : fields)
+    {
+        unsigned int pos = field->getPosition();
+        field->setLinearData(&data[0], data.size(), &pos);
+    }
+}
+
+TEST(test_format_layout, bithelper_read_write)
+{
+    std::mt19937_64 rng(42);
+    for (int n = 0; n < 10000; ++n)
+    {
+        std::vector<unsigned char> data(16, 0x00);
+        unsigned int length = 1 + rng() % 64;
+        unsigned int pos = rng() % (data.size() * 8 - length + 1);
+        unsigned long long value = rng();
+        unsigned long long masked = length == 64 ? value : value & ((1ULL << length) - 1);
+
+        BitHelper::writeBits(&data[0], data.size(), pos, value, length);
+        for (unsigned int i = 0; i < data.size() * 8; ++i)
+        {
+            unsigned char expected = (i >= pos && i < pos + length) ? (masked >> (pos + length - 1 - i)) & 0x01 : 0;
+            ASSERT_EQ(expected, get_bit(data, i)) << "pos " << pos << " length " << length;
+        }
+        ASSERT_EQ(masked, BitHelper::readBits(&data[0], (pos + length + 7) / 8, pos, length));
+    }
+
+    unsigned char small[2] = {0, 0};
+    ASSERT_THROW(BitHelper::writeBits(small, sizeof(small), 10, 0x7f, 7), std::invalid_argument);
+    ASSERT_THROW(BitHelper::readBits(small, sizeof(small), 10, 7), std::invalid_argument);
+}
+
+TEST(test_format_layout, static_parity)
+{
+    std::mt19937_64 rng(7);
+    std::vector<unsigned char> data(24);
+    for (int n = 0; n < 10000; ++n)
+    {
+        for (auto &c : data)
+            c = static_cast<unsigned char>(rng());
+        size_t start = rng() % (data.size() * 8);
+        size_t length = rng() % (data.size() * 8);
+
+        unsigned char parity = 0;
+        for (size_t i = start; i < start + length && i < data.size() * 8; ++i)
+            parity ^= get_bit(data, static_cast<unsigned int>(i));
+
+        ASSERT_EQ(parity, StaticFormat::calculateParity(&data[0], data.size(), PT_EVEN, start, length));
+        ASSERT_EQ(parity ^ 1, StaticFormat::calculateParity(&data[0], data.size(), PT_ODD, start, length));
+        ASSERT_EQ(0, StaticFormat::calculateParity(&data[0], data.size(), PT_NONE, start, length));
+    }
+}
+
+TEST(test_format_layout, wiegand26)
+{
+    Wiegand26Format format;
+    format.setFacilityCode(0xA5);
+    format.setUid(0x1234);
+
+    std::vector<unsigned char> data(4, 0x00);
+    format.getLinearData(&data[0], data.size());
+
+    // P | FC (8) | UID (16) | P
+    unsigned long long expected = (0xA5ULL << 17) | (0x1234ULL << 1);
+    unsigned char left = 0, right = 1;
+    for (unsigned int i = 1; i <= 12; ++i)
+        left ^= (expected >> (25 - i)) & 0x01;
+    for (unsigned int i = 13; i <= 24; ++i)
+        right ^= (expected >> (25 - i)) & 0x01;
+    expected |= (static_cast<unsigned long long>(left) << 25) | right;
+    ASSERT_EQ(expected, BitHelper::readBits(&data[0], data.size(), 0, 26));
+
+    Wiegand26Format decoded;
+    decoded.setLinearData(&data[0], data.size());
+    ASSERT_EQ(0xA5, decoded.getFacilityCode());
+    ASSERT_EQ(0x1234u, decoded.getUid());
+
+    data[1] ^= 0x10;
+    ASSERT_THROW(decoded.setLinearData(&data[0], data.size()), LibLogicalAccessException);
+}
+
+TEST(test_format_layout, custom_matches_field_by_field)
+{
+    std::shared_ptr<CustomFormat> format = create_custom_format();
+    std::shared_ptr<CustomFormat> reference = create_custom_format();
+    std::mt19937_64 rng(1);
+    std::vector<unsigned char> data(10), expected(10);
+
+    for (int n = 0; n < 1000; ++n)
+    {
+        long long fc = static_cast<long long>(rng() & 0xfff), uid = static_cast<long long>(rng());
+        std::dynamic_pointer_cast<NumberDataField>(format->getFieldFromName("FacilityCode"))->setValue(fc);
+        std::dynamic_pointer_cast<NumberDataField>(format->getFieldFromName("Uid"))->setValue(uid);
+        std::dynamic_pointer_cast<NumberDataField>(reference->getFieldFromName("FacilityCode"))->setValue(fc);
+        std::dynamic_pointer_cast<NumberDataField>(reference->getFieldFromName("Uid"))->setValue(uid);
+
+        format->getLinearData(&data[0], data.size());
+        field_by_field_encode(reference, expected);
+        ASSERT_EQ(expected, data);
+
+        std::shared_ptr<CustomFormat> decoded = create_custom_format();
+        decoded->setLinearData(&data[0], data.size());
+        ASSERT_EQ(fc, std::dynamic_pointer_cast<NumberDataField>(decoded->getFieldFromName("FacilityCode"))->getValue());
+        ASSERT_EQ(uid, std::dynamic_pointer_cast<NumberDataField>(decoded->getFieldFromName("Uid"))->getValue());
+
+        std::shared_ptr<CustomFormat> fieldByField = create_custom_format();
+        field_by_field_decode(fieldByField, data);
+        ASSERT_EQ(fc, std::dynamic_pointer_cast<NumberDataField>(fieldByField->getFieldFromName("FacilityCode"))->getValue());
+        ASSERT_EQ(uid, std::dynamic_pointer_cast<NumberDataField>(fieldByField->getFieldFromName("Uid"))->getValue());
+    }
+
+    data[5] ^= 0x01;
+    ASSERT_THROW(format->setLinearData(&data[0], data.size()), LibLogicalAccessException);
+    ASSERT_THROW(format->getLinearData(&data[0], 4), LibLogicalAccessException);
+}
+
+TEST(test_format_layout, custom_follows_field_changes)
+{
+    std::shared_ptr<CustomFormat> format = create_custom_format();
+    std::shared_ptr<CustomFormat> reference = create_custom_format();
+    std::vector<unsigned char> data(10), expected(10);
+    format->getLinearData(&data[0], data.size());
+
+    for (auto f : {format, reference})
+    {
+        std::dynamic_pointer_cast<NumberDataField>(f->getFieldFromName("Uid"))->setValue(0x0123456789ABCDEFLL);
+        std::shared_ptr<NumberDataField> fc = std::dynamic_pointer_cast<NumberDataField>(f->getFieldFromName("FacilityCode"));
+        fc->setValue(0x5);
+        fc->setDataLength(8);
+        std::shared_ptr<DataType> dataType(new BCDNibbleDataType());
+        fc->setDataType(dataType);
+    }
+
+    format->getLinearData(&data[0], data.size());
+    field_by_field_encode(reference, expected);
+    ASSERT_EQ(expected, data);
+}
+
+TEST(test_format_layout, custom_shared_between_threads)
+{
+    std::shared_ptr<CustomFormat> reference = create_custom_format();
+    std::dynamic_pointer_cast<NumberDataField>(reference->getFieldFromName("Uid"))->setValue(0x0123456789ABCDEFLL);
+    std::vector<unsigned char> expected(10);
+    field_by_field_encode(reference, expected);
+
+    std::atomic<unsigned int> mismatches(0);
+    for (int n = 0; n < 200; ++n)
+    {
+        // The threads race to compile the layout of a new format.
+        std::shared_ptr<CustomFormat> format = create_custom_format();
+        std::dynamic_pointer_cast<NumberDataField>(format->getFieldFromName("Uid"))->setValue(0x0123456789ABCDEFLL);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&]() {
+                std::vector<unsigned char> data(10);
+                format->getLinearData(&data[0], data.size());
+                if (data != expected)
+                    ++mismatches;
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+    }
+    ASSERT_EQ(0u, mismatches);
+}
+
+#ifdef LLA_BENCHMARK
+static void decode_benchmark(const std::string &name, std::shared_ptr<Format> format,
+                             std::function<void(const std::vector<unsigned char> &)> baseline)
+{
+    const int iterations = 200000;
+    std::vector<unsigned char> linear((format->getDataLength() + 7) / 8, 0x00);
+    format->getLinearData(&linear[0], linear.size());
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        format->setLinearData(&linear[0], linear.size());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << name << ": " << static_cast<long>(iterations / seconds) << " decodes/s";
+    if (baseline)
+    {
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i)
+        {
+            baseline(linear);
+        }
+        double baselineSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << ", field by field " << static_cast<long>(iterations / baselineSeconds) << " decodes/s";
+    }
+    std::cout << std::endl;
+}
+
+TEST(benchmark_format_layout, decode)
+{
+    std::shared_ptr<Wiegand26Format> wiegand26(new Wiegand26Format());
+    wiegand26->setFacilityCode(42);
+    wiegand26->setUid(1234);
+    decode_benchmark("Wiegand26", wiegand26, nullptr);
+
+    std::shared_ptr<Corporate1000Format> corporate1000(new Corporate1000Format());
+    corporate1000->setCompanyCode(0x123);
+    corporate1000->setUid(0x54321);
+    decode_benchmark("Corporate1000", corporate1000, nullptr);
+
+    std::shared_ptr<CustomFormat> reference = create_custom_format();
+    decode_benchmark("CustomFormat", create_custom_format(),
+                     [reference](const std::vector<unsigned char> &data) { field_by_field_decode(reference, data); });
+}
+#endif
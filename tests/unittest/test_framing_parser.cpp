@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/readerproviders/framingbufferparser.hpp>
+#include <chrono>
+
+using namespace logicalaccess;
+
+static void push(boost::circular_buffer<unsigned char> &buffer, const std::vector<unsigned char> &data)
+{
+    buffer.insert(buffer.end(), data.begin(), data.end());
+}
+
+TEST(test_framing_parser, length_prefixed_with_noise)
+{
+    // OSDP like framing: SOF, address, little endian length of the whole packet.
+    FramingBufferParser parser;
+    parser.setStartOfFrame({0x53});
+    parser.setLengthField(2, 2, false, 0, 6);
+
+    boost::circular_buffer<unsigned char> buffer(64);
+    push(buffer, {0x00, 0xFF, 0x53, 0x01, 0x08});
+    ASSERT_TRUE(parser.getValidBuffer(buffer).empty());
+    ASSERT_EQ(3u, buffer.size());
+
+    push(buffer, {0x00, 0x01, 0x02, 0x03, 0x04, 0x53});
+    ASSERT_EQ(std::vector<unsigned char>({0x53, 0x01, 0x08, 0x00, 0x01, 0x02, 0x03, 0x04}), parser.getValidBuffer(buffer));
+    ASSERT_EQ(1u, buffer.size());
+
+    // A length shorter than the header is noise, not a stuck frame.
+    buffer.clear();
+    push(buffer, {0x53, 0x01, 0x00, 0x00, 0x10, 0x20, 0x53, 0x02, 0x06, 0x00, 0x11, 0x22});
+    ASSERT_EQ(std::vector<unsigned char>({0x53, 0x02, 0x06, 0x00, 0x11, 0x22}), parser.getValidBuffer(buffer));
+    ASSERT_TRUE(buffer.empty());
+}
+
+TEST(test_framing_parser, end_of_frame_incremental)
+{
+    FramingBufferParser parser;
+    parser.setEndOfFrame(0xFE, 4);
+
+    boost::circular_buffer<unsigned char> buffer(64);
+    // A STOP byte inside the minimum length does not end the frame.
+    std::vector<unsigned char> frame = {0x01, 0xFE, 0x03, 0x04, 0x05, 0xFE};
+    for (size_t i = 0; i < frame.size() - 1; ++i)
+    {
+        buffer.push_back(frame[i]);
+        ASSERT_TRUE(parser.getValidBuffer(buffer).empty());
+    }
+    buffer.push_back(frame.back());
+    ASSERT_EQ(frame, parser.getValidBuffer(buffer));
+    ASSERT_TRUE(buffer.empty());
+}
+
+TEST(test_framing_parser, wrapped_frame_span_and_checksum)
+{
+    // Rpleth like framing: status, device, command, data length, data, XOR checksum.
+    FramingBufferParser parser;
+    parser.setLengthField(3, 1, true, 5, 5);
+    parser.setTrailerChecker(&FramingBufferParser::checkXorTrailer);
+
+    boost::circular_buffer<unsigned char> buffer(8);
+    push(buffer, {0xAA, 0xAA, 0xAA, 0xAA, 0xAA});
+    buffer.erase_begin(5);
+    // The frame wraps around the end of the ring.
+    push(buffer, {0x00, 0x01, 0x02, 0x02, 0x10, 0x20, 0x31});
+
+    FrameSpan span;
+    ASSERT_EQ(FramingBufferParser::FS_VALID, parser.parse(buffer, span));
+    ASSERT_EQ(7u, span.size());
+    ASSERT_EQ(0x02, span[3]);
+    unsigned char data[2];
+    span.copy(4, 2, data);
+    ASSERT_EQ(0x10, data[0]);
+    ASSERT_EQ(0x20, data[1]);
+    parser.consume(buffer, span);
+    ASSERT_TRUE(buffer.empty());
+
+    push(buffer, {0x00, 0x01, 0x02, 0x01, 0x10, 0x00, 0x00, 0x01});
+    ASSERT_EQ(FramingBufferParser::FS_BAD_TRAILER, parser.parse(buffer, span));
+    // Frames with a bad trailer are dropped.
+    ASSERT_TRUE(parser.getValidBuffer(buffer).empty());
+    ASSERT_EQ(2u, buffer.size());
+}
+
+/**
+ * Feed the frames byte by byte, parsing on each received byte as the serial port reads do.
+ * \return The number of frames parsed.
+ */
+static size_t parse_byte_by_byte(size_t frameLength, size_t frameCount)
+{
+    FramingBufferParser parser;
+    parser.setEndOfFrame(0xFE, 8);
+
+    std::vector<unsigned char> frame(frameLength, 0x42);
+    frame.back() = 0xFE;
+
+    boost::circular_buffer<unsigned char> buffer(frameLength * 2);
+    size_t frames = 0;
+    for (size_t i = 0; i < frameCount; ++i)
+    {
+        for (unsigned char b : frame)
+        {
+            buffer.push_back(b);
+            std::vector<unsigned char> parsed = parser.getValidBuffer(buffer);
+            if (!parsed.empty())
+            {
+                EXPECT_EQ(frame, parsed);
+                ++frames;
+            }
+        }
+    }
+    return frames;
+}
+
+TEST(test_framing_parser, byte_by_byte)
+{
+    ASSERT_EQ(20u, parse_byte_by_byte(1024, 20));
+}
+
+#ifdef LLA_BENCHMARK
+TEST(benchmark_framing_parser, byte_by_byte)
+{
+    const size_t frameLength = 1024;
+    const size_t frameCount  = 200;
+
+    auto start = std::chrono::steady_clock::now();
+    size_t frames = parse_byte_by_byte(frameLength, frameCount);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << frames << " frames of " << frameLength << " bytes parsed byte by byte in " << seconds * 1000 << " ms" << std::endl;
+}
+#endif
@@ -0,0 +1,261 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/iks/RandomPool.hpp>
+#include <logicalaccess/iks/ResultCache.hpp>
+#include <logicalaccess/myexception.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace logicalaccess;
+using namespace logicalaccess::iks;
+
+/**
+ * Fetch counting bytes after a latency, and record the calls.
+ */
+class CountingFetcher
+{
+  public:
+    explicit CountingFetcher(unsigned int latency)
+        : latency_(latency)
+        , calls_(0)
+        , next_(0)
+    {
+    }
+
+    RandomPool::Fetcher fetcher()
+    {
+        return [this](size_t sz) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(latency_));
+            ++calls_;
+            std::vector<uint8_t> ret(sz);
+            for (auto &b : ret)
+                b = static_cast<uint8_t>(next_++);
+            return ret;
+        };
+    }
+
+    unsigned int latency_;
+    std::atomic<int> calls_;
+    std::atomic<unsigned int> next_;
+};
+
+static void wait_available(RandomPool &pool, size_t sz)
+{
+    for (int i = 0; i < 200 && pool.available() < sz; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+}
+
+TEST(test_iks_cache, random_pool_prefetch)
+{
+    CountingFetcher source(0);
+    RandomPool pool(source.fetcher(), 256);
+    wait_available(pool, 256);
+    ASSERT_EQ(256u, pool.available());
+    ASSERT_EQ(1, source.calls_.load());
+
+    // 32 requests of 4 bytes take half of the pool with no fetch.
+    std::vector<uint8_t> all;
+    for (int i = 0; i < 32; ++i)
+    {
+        auto bytes = pool.get(4);
+        ASSERT_EQ(4u, bytes.size());
+        all.insert(all.end(), bytes.begin(), bytes.end());
+    }
+    ASSERT_EQ(32u, pool.hits());
+    ASSERT_EQ(0u, pool.misses());
+
+    // Each byte is handed out once.
+    std::sort(all.begin(), all.end());
+    ASSERT_EQ(all.end(), std::adjacent_find(all.begin(), all.end()));
+
+    // Falling to half of the capacity triggers a refill.
+    pool.get(1);
+    wait_available(pool, 256);
+    ASSERT_EQ(256u, pool.available());
+    ASSERT_EQ(2, source.calls_.load());
+}
+
+TEST(test_iks_cache, random_pool_miss)
+{
+    CountingFetcher source(0);
+    RandomPool pool(source.fetcher(), 16);
+    wait_available(pool, 16);
+
+    // Larger than the pool: fetched directly, the pool is left untouched.
+    auto bytes = pool.get(64);
+    ASSERT_EQ(64u, bytes.size());
+    ASSERT_EQ(0u, pool.hits());
+    ASSERT_EQ(1u, pool.misses());
+    ASSERT_EQ(16u, pool.available());
+}
+
+TEST(test_iks_cache, random_pool_fetch_failure)
+{
+    std::atomic<bool> fail(true);
+    RandomPool pool(
+        [&fail](size_t sz) {
+            if (fail)
+                throw IKSException("No server.");
+            return std::vector<uint8_t>(sz, 0x42);
+        },
+        32);
+
+    // The failed refill leaves the pool empty, and the direct fetch throws.
+    ASSERT_THROW(pool.get(8), IKSException);
+    ASSERT_EQ(1u, pool.misses());
+
+    // The next request triggers a new refill.
+    fail = false;
+    ASSERT_EQ(std::vector<uint8_t>(8, 0x42), pool.get(8));
+    wait_available(pool, 32);
+    ASSERT_EQ(32u, pool.available());
+}
+
+TEST(test_iks_cache, random_pool_hits)
+{
+    // Once prefetched, small requests never wait for a fetch.
+    CountingFetcher source(5);
+    RandomPool pool(source.fetcher(), 4096);
+    wait_available(pool, 4096);
+
+    for (int i = 0; i < 200; ++i)
+        ASSERT_EQ(16u, pool.get(16).size());
+    ASSERT_EQ(200u, pool.hits());
+    ASSERT_EQ(0u, pool.misses());
+}
+
+#ifdef LLA_BENCHMARK
+TEST(benchmark_iks_cache, random_pool_latency)
+{
+    CountingFetcher source(5);
+    RandomPool pool(source.fetcher(), 4096);
+    wait_available(pool, 4096);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 200; ++i)
+        pool.get(16);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    std::cout << "200 random requests served in " << elapsed.count() << " ms with a 5 ms fetch latency, "
+              << pool.hits() << " hits, " << source.calls_.load() << " fetches." << std::endl;
+}
+#endif
+
+TEST(test_iks_cache, result_cache_policy)
+{
+    ResultCache cache(8);
+    int computed = 0;
+    auto compute = [&computed]() {
+        ++computed;
+        return std::vector<uint8_t>{0x01, 0x02};
+    };
+    std::vector<uint8_t> input{0xAA};
+
+    // Keys not allowed are always computed, and not counted.
+    cache.get("secret", KeyDivInfo(), input, compute);
+    cache.get("secret", KeyDivInfo(), input, compute);
+    ASSERT_EQ(2, computed);
+    ASSERT_EQ(0u, cache.size());
+    ASSERT_EQ(0u, cache.hits() + cache.misses());
+
+    cache.allow("public");
+    ASSERT_EQ(compute(), cache.get("public", KeyDivInfo(), input, compute));
+    ASSERT_EQ(compute(), cache.get("public", KeyDivInfo(), input, compute));
+    ASSERT_EQ(5, computed);
+    ASSERT_EQ(1u, cache.hits());
+    ASSERT_EQ(1u, cache.misses());
+
+    cache.forbid("public");
+    ASSERT_EQ(0u, cache.size());
+    cache.get("public", KeyDivInfo(), input, compute);
+    ASSERT_EQ(6, computed);
+}
+
+TEST(test_iks_cache, result_cache_index)
+{
+    ResultCache cache(8);
+    cache.allow("key");
+    int computed = 0;
+    auto compute = [&computed]() {
+        ++computed;
+        return std::vector<uint8_t>(1, static_cast<uint8_t>(computed));
+    };
+
+    KeyDivInfo div1;
+    div1.flag_      = KEYDIV_ALGO_NXP_AV2;
+    div1.div_input_ = {0x01, 0x02, 0x03};
+    KeyDivInfo div2 = div1;
+    div2.div_input_ = {0x01, 0x02, 0x04};
+
+    // The diversification and the input are part of the index.
+    auto r1 = cache.get("key", div1, {0x00}, compute);
+    auto r2 = cache.get("key", div2, {0x00}, compute);
+    auto r3 = cache.get("key", div1, {0x01}, compute);
+    auto r4 = cache.get("key", KeyDivInfo(), {0x00}, compute);
+    ASSERT_EQ(4, computed);
+    ASSERT_NE(r1, r2);
+    ASSERT_NE(r1, r3);
+
+    ASSERT_EQ(r1, cache.get("key", div1, {0x00}, compute));
+    ASSERT_EQ(r2, cache.get("key", div2, {0x00}, compute));
+    ASSERT_EQ(r4, cache.get("key", KeyDivInfo(), {0x00}, compute));
+    ASSERT_EQ(4, computed);
+    ASSERT_EQ(3u, cache.hits());
+}
+
+TEST(test_iks_cache, result_cache_eviction)
+{
+    ResultCache cache(3);
+    cache.allow("key");
+    auto compute = []() { return std::vector<uint8_t>{0x00}; };
+
+    cache.get("key", KeyDivInfo(), {0x01}, compute);
+    cache.get("key", KeyDivInfo(), {0x02}, compute);
+    cache.get("key", KeyDivInfo(), {0x03}, compute);
+    // Use 1, so that 2 is the least recently used.
+    cache.get("key", KeyDivInfo(), {0x01}, compute);
+    cache.get("key", KeyDivInfo(), {0x04}, compute);
+    ASSERT_EQ(3u, cache.size());
+    ASSERT_EQ(1u, cache.evictions());
+
+    cache.get("key", KeyDivInfo(), {0x01}, compute);
+    ASSERT_EQ(2u, cache.hits());
+    cache.get("key", KeyDivInfo(), {0x02}, compute);
+    ASSERT_EQ(2u, cache.hits());
+    ASSERT_EQ(5u, cache.misses());
+}
+
+TEST(test_iks_cache, result_cache_ttl)
+{
+    ResultCache cache(8, std::chrono::milliseconds(20));
+    cache.allow("key");
+    int computed = 0;
+    auto compute = [&computed]() {
+        ++computed;
+        return std::vector<uint8_t>{0x00};
+    };
+
+    cache.get("key", KeyDivInfo(), {0x01}, compute);
+    cache.get("key", KeyDivInfo(), {0x01}, compute);
+    ASSERT_EQ(1, computed);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    cache.get("key", KeyDivInfo(), {0x01}, compute);
+    ASSERT_EQ(2, computed);
+    ASSERT_EQ(1u, cache.hits());
+    ASSERT_EQ(2u, cache.misses());
+}
+
+TEST(test_iks_cache, result_cache_failure)
+{
+    ResultCache cache(8);
+    cache.allow("key");
+    auto fail = []() -> std::vector<uint8_t> {
+        throw IKSException("Server failure.");
+    };
+
+    ASSERT_THROW(cache.get("key", KeyDivInfo(), {0x01}, fail), IKSException);
+    ASSERT_EQ(0u, cache.size());
+}
@@ -0,0 +1,646 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/iks/ConnectionPool.hpp>
+#include <logicalaccess/iks/PipelinedClient.hpp>
+#include <logicalaccess/iks/packet/AesEncrypt.hpp>
+#include <logicalaccess/iks/packet/GenRandom.hpp>
+#include <logicalaccess/myexception.hpp>
+#include <logicalaccess/utils.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <thread>
+
+using namespace logicalaccess;
+using namespace logicalaccess::iks;
+
+/**
+ * A local Islog Key Server answering after an injected latency.
+ *
+ * AES commands are answered with their payload xored with 0x5A, after a longer
+ * latency for the "slow" key so that tagged responses come out of order.
+ * Random requests above 64 bytes fail with SMSG_STATUS_TOO_MANY_BYTES.
+ * Once untagged, the responses have no request identifier, as with older servers.
+ */
+class MockIKSServer
+{
+  public:
+    explicit MockIKSServer(unsigned int latency)
+        : acceptor_(ios_, boost::asio::ip::tcp::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), 0))
+        , latency_(latency)
+        , held_(false)
+        , untagged_(false)
+        , received_(0)
+        , connections_(0)
+    {
+        accept();
+        thread_ = std::thread([this]() { ios_.run(); });
+    }
+
+    ~MockIKSServer()
+    {
+        ios_.stop();
+        thread_.join();
+    }
+
+    int getPort() const
+    {
+        return acceptor_.local_endpoint().port();
+    }
+
+    /**
+     * Close the client connections.
+     */
+    void dropConnections()
+    {
+        std::promise<void> done;
+        ios_.post([this, &done]() {
+            for (auto &socket : sockets_)
+            {
+                boost::system::error_code ignored;
+                socket->close(ignored);
+            }
+            sockets_.clear();
+            done.set_value();
+        });
+        done.get_future().wait();
+    }
+
+    /**
+     * Keep the responses until release(), the commands stay in flight.
+     */
+    void hold()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        held_ = true;
+    }
+
+    void release()
+    {
+        ios_.post([this]() {
+            std::vector<std::function<void()>> responses;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                held_ = false;
+                responses.swap(heldResponses_);
+            }
+            for (auto &respond : responses)
+                respond();
+        });
+    }
+
+    void setUntagged(bool untagged)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        untagged_ = untagged;
+    }
+
+    /**
+     * Wait until the server received a number of commands.
+     */
+    bool waitReceived(unsigned int count)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cond_.wait_for(lock, std::chrono::seconds(10), [this, count]() { return received_ >= count; });
+    }
+
+    unsigned int getReceivedCount()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return received_;
+    }
+
+    unsigned int getConnectionCount()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return connections_;
+    }
+
+  private:
+    typedef std::shared_ptr<boost::asio::ip::tcp::socket> Socket;
+
+    void accept()
+    {
+        Socket socket(new boost::asio::ip::tcp::socket(ios_));
+        acceptor_.async_accept(*socket, [this, socket](const boost::system::error_code &error) {
+            if (!error)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    ++connections_;
+                }
+                sockets_.push_back(socket);
+                read(socket, std::make_shared<std::vector<uint8_t>>());
+            }
+            accept();
+        });
+    }
+
+    void read(Socket socket, std::shared_ptr<std::vector<uint8_t>> pending)
+    {
+        std::shared_ptr<std::vector<uint8_t>> buffer(new std::vector<uint8_t>(512));
+        socket->async_receive(boost::asio::buffer(*buffer), [this, socket, buffer, pending](const boost::system::error_code &error, size_t length) {
+            if (error)
+                return;
+            pending->insert(pending->end(), buffer->begin(), buffer->begin() + length);
+            while (pending->size() >= 6)
+            {
+                uint32_t size;
+                memcpy(&size, &(*pending)[0], 4);
+                size = lla_ntohl(size);
+                if (pending->size() < size)
+                    break;
+                std::vector<uint8_t> command(pending->begin(), pending->begin() + size);
+                pending->erase(pending->begin(), pending->begin() + size);
+                answer(socket, command);
+            }
+            read(socket, pending);
+        });
+    }
+
+    void answer(Socket socket, const std::vector<uint8_t> &command)
+    {
+        uint16_t opcode;
+        memcpy(&opcode, &command[4], 2);
+        opcode = lla_ntohs(opcode);
+
+        size_t needle = 6;
+        uint32_t id   = 0;
+        if (opcode & IKS_OPCODE_FLAG_REQUEST_ID)
+        {
+            memcpy(&id, &command[needle], 4);
+            id = lla_ntohl(id);
+            needle += 4;
+        }
+
+        uint16_t status = SMSG_STATUS_SUCCESS;
+        std::vector<uint8_t> data;
+        unsigned int latency = latency_;
+        switch (opcode & ~IKS_OPCODE_FLAG_REQUEST_ID)
+        {
+        case CMSG_OP_AES_ENCRYPT:
+        {
+            std::string key(reinterpret_cast<const char *>(&command[needle + 1]));
+            needle += 1 + key.size() + 1;
+            uint16_t size;
+            memcpy(&size, &command[needle], 2);
+            size = lla_ntohs(size);
+            data.assign(command.begin() + needle + 2, command.begin() + needle + 2 + size);
+            for (auto &b : data)
+                b ^= 0x5A;
+            if (key == "slow")
+                latency *= 4;
+            break;
+        }
+        case CMSG_OP_GENRANDOM:
+        {
+            uint16_t count;
+            memcpy(&count, &command[needle], 2);
+            count = lla_ntohs(count);
+            if (count > 64)
+                status = SMSG_STATUS_TOO_MANY_BYTES;
+            else
+                data.assign(count, 0x42);
+            break;
+        }
+        default:
+            status = SMSG_STATUS_FAILURE;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (untagged_)
+                id = 0;
+        }
+
+        std::vector<uint8_t> response(8 + (id ? 4 : 0));
+        uint32_t size = lla_htonl(static_cast<uint32_t>(response.size() + data.size()));
+        uint16_t op   = lla_htons(static_cast<uint16_t>((opcode + 1) & ~IKS_OPCODE_FLAG_REQUEST_ID) | (id ? IKS_OPCODE_FLAG_REQUEST_ID : 0));
+        uint16_t st   = lla_htons(status);
+        uint32_t nid  = lla_htonl(id);
+        memcpy(&response[0], &size, 4);
+        memcpy(&response[4], &op, 2);
+        memcpy(&response[6], &st, 2);
+        if (id)
+            memcpy(&response[8], &nid, 4);
+        response.insert(response.end(), data.begin(), data.end());
+
+        std::function<void()> respond = [this, socket, response, latency]() {
+            // Without latency, in order: timers expiring at the same time may fire in any order.
+            if (latency == 0)
+            {
+                boost::system::error_code ignored;
+                boost::asio::write(*socket, boost::asio::buffer(response), ignored);
+                return;
+            }
+            std::shared_ptr<boost::asio::deadline_timer> timer(new boost::asio::deadline_timer(ios_));
+            timer->expires_from_now(boost::posix_time::milliseconds(latency));
+            timer->async_wait([socket, response, timer](const boost::system::error_code &) {
+                boost::system::error_code ignored;
+                boost::asio::write(*socket, boost::asio::buffer(response), ignored);
+            });
+        };
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++received_;
+            cond_.notify_all();
+            if (held_)
+            {
+                heldResponses_.push_back(respond);
+                return;
+            }
+        }
+        respond();
+    }
+
+    boost::asio::io_service ios_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    std::vector<Socket> sockets_;
+    unsigned int latency_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool held_;
+    bool untagged_;
+    std::vector<std::function<void()>> heldResponses_;
+    unsigned int received_;
+    unsigned int connections_;
+    std::thread thread_;
+};
+
+#ifdef ENABLE_SSLTRANSPORT
+static boost::asio::ssl::context &unusedContext()
+{
+    static boost::asio::ssl::context ctx(boost::asio::ssl::context::tlsv12_client);
+    return ctx;
+}
+#endif
+
+/**
+ * A plain TCP transport to the mock server, counting its writes.
+ */
+class PlainTransport : public SSLTransport
+{
+  public:
+    explicit PlainTransport(std::shared_ptr<std::atomic<unsigned int>> writes)
+        :
+#ifdef ENABLE_SSLTRANSPORT
+        SSLTransport(unusedContext()),
+#endif
+        socket_(ios_)
+        , writes_(writes)
+    {
+    }
+
+    bool connect(long int) override
+    {
+        boost::system::error_code error;
+        socket_.connect(boost::asio::ip::tcp::endpoint(boost::asio::ip::address::from_string(getIpAddress()), getPort()), error);
+        return !error;
+    }
+
+    void disconnect() override
+    {
+        boost::system::error_code ignored;
+        socket_.close(ignored);
+    }
+
+    bool isConnected() override
+    {
+        return socket_.is_open();
+    }
+
+    void send(const std::vector<unsigned char> &data) override
+    {
+        if (writes_)
+            ++*writes_;
+        boost::asio::write(socket_, boost::asio::buffer(data));
+    }
+
+    bool waitReadable(long int timeout) override
+    {
+        boost::system::error_code error = boost::asio::error::would_block;
+        socket_.async_wait(boost::asio::ip::tcp::socket::wait_read, [&](const boost::system::error_code &e) { error = e; });
+        ios_.restart();
+        ios_.run_for(std::chrono::milliseconds(timeout));
+        if (error == boost::asio::error::would_block)
+        {
+            socket_.cancel();
+            ios_.restart();
+            ios_.run();
+        }
+        if (error && error != boost::asio::error::operation_aborted)
+            disconnect();
+        return !error;
+    }
+
+    std::vector<uint8_t> receive(long int timeout) override
+    {
+        std::vector<uint8_t> buffer(512);
+        boost::system::error_code error = boost::asio::error::would_block;
+        size_t length = 0;
+        socket_.async_receive(boost::asio::buffer(buffer), [&](const boost::system::error_code &e, size_t l) {
+            error  = e;
+            length = l;
+        });
+        ios_.restart();
+        ios_.run_for(std::chrono::milliseconds(timeout));
+        if (error == boost::asio::error::would_block)
+        {
+            socket_.cancel();
+            ios_.restart();
+            ios_.run();
+        }
+        if (error || length == 0)
+        {
+            if (error != boost::asio::error::operation_aborted)
+                disconnect();
+            throw LibLogicalAccessException("Socket receive timeout.");
+        }
+        buffer.resize(length);
+        return buffer;
+    }
+
+  private:
+    boost::asio::io_context ios_;
+    boost::asio::ip::tcp::socket socket_;
+    std::shared_ptr<std::atomic<unsigned int>> writes_;
+};
+
+static PipelinedClient::TransportFactory plainFactory(int port, std::shared_ptr<std::atomic<unsigned int>> writes = nullptr)
+{
+    return [port, writes]() {
+        std::unique_ptr<SSLTransport> transport(new PlainTransport(writes));
+        transport->setIpAddress("127.0.0.1");
+        transport->setPort(port);
+        return transport;
+    };
+}
+
+static std::shared_ptr<AesEncryptResponse> aes(PipelinedClient &client, const std::string &key, uint8_t value)
+{
+    AesEncryptCommand cmd;
+    cmd.key_name_ = key;
+    cmd.payload_  = std::vector<uint8_t>(16, value);
+    cmd.iv_       = std::array<uint8_t, 16>{ {0} };
+    return std::dynamic_pointer_cast<AesEncryptResponse>(client.transact(cmd));
+}
+
+TEST(test_iks_pipeline, packet_request_id)
+{
+    GenRandomCommand cmd;
+    cmd.nb_bytes_ = 16;
+    // Untagged commands keep the original layout.
+    ASSERT_EQ(std::vector<uint8_t>({0x00, 0x00, 0x00, 0x08, 0x00, 0x02, 0x00, 0x10}), cmd.serialize());
+
+    cmd.request_id_ = 0x01020304;
+    ASSERT_EQ(std::vector<uint8_t>({0x00, 0x00, 0x00, 0x0C, 0x80, 0x02, 0x01, 0x02, 0x03, 0x04, 0x00, 0x10}), cmd.serialize());
+    ASSERT_EQ(12u, cmd.binary_size());
+
+    ResponseHeader header;
+    std::vector<uint8_t> tagged = {0x00, 0x00, 0x00, 0x0E, 0x80, 0x03, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0xAA, 0xBB};
+    ASSERT_FALSE(header.parse(tagged.data(), 10));
+    ASSERT_TRUE(header.parse(tagged.data(), tagged.size()));
+    ASSERT_EQ(14u, header.packet_size_);
+    ASSERT_EQ(SMSG_OP_GENRANDOM, header.opcode_);
+    ASSERT_EQ(0x01020304u, header.request_id_);
+    ASSERT_EQ(12u, header.header_size_);
+
+    std::vector<uint8_t> untagged = {0x00, 0x00, 0x00, 0x08, 0x00, 0x03, 0x00, 0x01};
+    ASSERT_TRUE(header.parse(untagged.data(), untagged.size()));
+    ASSERT_EQ(0u, header.request_id_);
+    ASSERT_EQ(SMSG_STATUS_FAILURE, header.status_);
+    ASSERT_EQ(8u, header.header_size_);
+
+    untagged[3] = 0x04;
+    ASSERT_THROW(header.parse(untagged.data(), untagged.size()), IKSException);
+}
+
+TEST(test_iks_pipeline, out_of_order_responses)
+{
+    MockIKSServer server(5);
+    PipelinedClient client(plainFactory(server.getPort()), 64);
+
+    std::vector<std::unique_ptr<AesEncryptCommand>> commands;
+    std::vector<std::future<std::shared_ptr<BaseResponse>>> futures;
+    for (int i = 0; i < 200; ++i)
+    {
+        commands.emplace_back(new AesEncryptCommand());
+        commands.back()->key_name_ = (i % 3 == 0) ? "slow" : "fast";
+        commands.back()->payload_  = std::vector<uint8_t>(16, static_cast<uint8_t>(i));
+        commands.back()->iv_       = std::array<uint8_t, 16>{ {0} };
+        futures.push_back(client.submit(*commands.back()));
+    }
+
+    for (int i = 0; i < 200; ++i)
+    {
+        auto resp = std::dynamic_pointer_cast<AesEncryptResponse>(futures[i].get());
+        ASSERT_TRUE(resp != nullptr);
+        ASSERT_EQ(commands[i]->request_id_, resp->request_id_);
+        ASSERT_EQ(std::vector<uint8_t>(16, static_cast<uint8_t>(i ^ 0x5A)), resp->bytes_);
+    }
+    ASSERT_EQ(0u, client.in_flight());
+}
+
+TEST(test_iks_pipeline, failures)
+{
+    MockIKSServer server(2);
+    PipelinedClient client(plainFactory(server.getPort()));
+
+    // A failed status only fails its own request.
+    GenRandomCommand tooMany;
+    tooMany.nb_bytes_ = 100;
+    auto failed = client.submit(tooMany);
+    ASSERT_EQ(std::vector<uint8_t>(16, 0x07 ^ 0x5A), aes(client, "fast", 0x07)->bytes_);
+    ASSERT_THROW(failed.get(), IKSException);
+
+    // The connection is established again after a network error.
+    server.dropConnections();
+    AesEncryptCommand cmd;
+    cmd.key_name_ = "fast";
+    cmd.payload_  = std::vector<uint8_t>(16, 0x01);
+    cmd.iv_       = std::array<uint8_t, 16>{ {0} };
+    try
+    {
+        client.transact(cmd);
+    }
+    catch (IKSException &)
+    {
+        // The command may have been written on the dropped connection.
+    }
+    ASSERT_EQ(std::vector<uint8_t>(16, 0x08 ^ 0x5A), aes(client, "fast", 0x08)->bytes_);
+
+    // No server.
+    PipelinedClient unreachable(plainFactory(1));
+    ASSERT_THROW(aes(unreachable, "fast", 0x00), IKSException);
+}
+
+TEST(test_iks_pipeline, commands_in_flight)
+{
+    const int count = 64;
+    MockIKSServer server(0);
+    PipelinedClient client(plainFactory(server.getPort()), count);
+
+    // The server holds its responses: every command is sent before the first one completes.
+    server.hold();
+    std::vector<AesEncryptCommand> commands(count);
+    std::vector<std::future<std::shared_ptr<BaseResponse>>> futures;
+    for (int i = 0; i < count; ++i)
+    {
+        commands[i].key_name_ = "fast";
+        commands[i].payload_  = std::vector<uint8_t>(16, static_cast<uint8_t>(i));
+        commands[i].iv_       = std::array<uint8_t, 16>{ {0} };
+        futures.push_back(client.submit(commands[i]));
+    }
+    ASSERT_TRUE(server.waitReceived(count));
+    ASSERT_EQ(static_cast<size_t>(count), client.in_flight());
+
+    server.release();
+    for (int i = 0; i < count; ++i)
+    {
+        auto resp = std::dynamic_pointer_cast<AesEncryptResponse>(futures[i].get());
+        ASSERT_EQ(std::vector<uint8_t>(16, static_cast<uint8_t>(i ^ 0x5A)), resp->bytes_);
+    }
+    ASSERT_EQ(1u, server.getConnectionCount());
+}
+
+TEST(test_iks_pipeline, untagged_responses)
+{
+    const int count = 16;
+    MockIKSServer server(0);
+    server.setUntagged(true);
+    PipelinedClient client(plainFactory(server.getPort()), count);
+
+    // The responses come in send order, each one completes the oldest command written.
+    server.hold();
+    std::vector<AesEncryptCommand> commands(count);
+    std::vector<std::future<std::shared_ptr<BaseResponse>>> futures;
+    for (int i = 0; i < count; ++i)
+    {
+        commands[i].key_name_ = "fast";
+        commands[i].payload_  = std::vector<uint8_t>(16, static_cast<uint8_t>(i));
+        commands[i].iv_       = std::array<uint8_t, 16>{ {0} };
+        futures.push_back(client.submit(commands[i]));
+    }
+    ASSERT_TRUE(server.waitReceived(count));
+
+    server.release();
+    for (int i = 0; i < count; ++i)
+    {
+        auto resp = std::dynamic_pointer_cast<AesEncryptResponse>(futures[i].get());
+        ASSERT_EQ(std::vector<uint8_t>(16, static_cast<uint8_t>(i ^ 0x5A)), resp->bytes_);
+    }
+    ASSERT_EQ(0u, client.in_flight());
+}
+
+TEST(test_iks_pipeline, no_empty_writes)
+{
+    MockIKSServer server(0);
+    std::shared_ptr<std::atomic<unsigned int>> writes(new std::atomic<unsigned int>(0));
+    PipelinedClient client(plainFactory(server.getPort(), writes));
+    client.set_poll_timeout(1);
+
+    // The client polls for the held response without writing again.
+    server.hold();
+    AesEncryptCommand cmd;
+    cmd.key_name_ = "fast";
+    cmd.payload_  = std::vector<uint8_t>(16, 0x01);
+    cmd.iv_       = std::array<uint8_t, 16>{ {0} };
+    auto future = client.submit(cmd);
+    ASSERT_TRUE(server.waitReceived(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    server.release();
+    ASSERT_EQ(std::vector<uint8_t>(16, 0x01 ^ 0x5A),
+              std::dynamic_pointer_cast<AesEncryptResponse>(future.get())->bytes_);
+    ASSERT_EQ(1u, *writes);
+}
+
+TEST(test_iks_pipeline, pool_connections)
+{
+    const int threadCount = 8;
+    const int count       = 10;
+    MockIKSServer server(1);
+    ConnectionPool pool(plainFactory(server.getPort()), 4);
+
+    // Blocking callers on more threads than connections.
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.push_back(std::thread([&pool, t]() {
+            for (int i = 0; i < count; ++i)
+            {
+                uint8_t value = static_cast<uint8_t>(t * count + i);
+                AesEncryptCommand cmd;
+                cmd.key_name_ = "fast";
+                cmd.payload_  = std::vector<uint8_t>(16, value);
+                cmd.iv_       = std::array<uint8_t, 16>{ {0} };
+                auto resp = std::dynamic_pointer_cast<AesEncryptResponse>(pool.transact(cmd));
+                EXPECT_EQ(std::vector<uint8_t>(16, value ^ 0x5A), resp->bytes_);
+            }
+        }));
+    }
+    for (auto &t : threads)
+        t.join();
+
+    ASSERT_EQ(static_cast<unsigned int>(threadCount * count), server.getReceivedCount());
+    ASSERT_EQ(4u, pool.size());
+    ASSERT_LE(server.getConnectionCount(), pool.size());
+}
+
+#ifdef LLA_BENCHMARK
+TEST(benchmark_iks_pipeline, throughput)
+{
+    const unsigned int latency = 5;
+    const int count            = 200;
+    MockIKSServer server(latency);
+
+    // One command at a time, as IslogKeyServer::transact.
+    PipelinedClient serial(plainFactory(server.getPort()));
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count / 4; ++i)
+        aes(serial, "fast", static_cast<uint8_t>(i));
+    double serialRate = count / 4 / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // All the commands in flight on one connection.
+    PipelinedClient pipelined(plainFactory(server.getPort()), count);
+    std::vector<AesEncryptCommand> commands(count);
+    std::vector<std::future<std::shared_ptr<BaseResponse>>> futures;
+    start = std::chrono::steady_clock::now();
+    for (auto &cmd : commands)
+    {
+        cmd.key_name_ = "fast";
+        cmd.payload_  = std::vector<uint8_t>(16, 0x11);
+        cmd.iv_       = std::array<uint8_t, 16>{ {0} };
+        futures.push_back(pipelined.submit(cmd));
+    }
+    for (auto &f : futures)
+        f.get();
+    double pipelinedRate = count / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Blocking callers on several threads, sharing a pool.
+    ConnectionPool pool(plainFactory(server.getPort()), 4);
+    std::vector<std::thread> threads;
+    start = std::chrono::steady_clock::now();
+    for (int t = 0; t < 8; ++t)
+    {
+        threads.push_back(std::thread([&pool, count]() {
+            for (int i = 0; i < count / 8; ++i)
+            {
+                AesEncryptCommand cmd;
+                cmd.key_name_ = "fast";
+                cmd.payload_  = std::vector<uint8_t>(16, 0x22);
+                cmd.iv_       = std::array<uint8_t, 16>{ {0} };
+                auto resp = std::dynamic_pointer_cast<AesEncryptResponse>(pool.transact(cmd));
+                EXPECT_EQ(std::vector<uint8_t>(16, 0x22 ^ 0x5A), resp->bytes_);
+            }
+        }));
+    }
+    for (auto &t : threads)
+        t.join();
+    double poolRate = count / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "IKS commands with " << latency << " ms latency: " << serialRate << "/s serial, "
+              << pipelinedRate << "/s pipelined, " << poolRate << "/s from 8 threads on a pool of " << pool.size() << std::endl;
+}
+#endif
@@ -0,0 +1,268 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/myexception.hpp>
+#include <logicalaccess/services/storage/storagecardservice.hpp>
+#include <pluginscards/iso15693/iso15693chip.hpp>
+#include <pluginscards/iso15693/iso15693commands.hpp>
+#include <pluginscards/iso15693/iso15693location.hpp>
+#include <pluginsreaderproviders/pcsc/commands/iso15693pcsccommands.hpp>
+
+using namespace logicalaccess;
+
+/**
+ * An ICODE SLIX like tag in memory, counting the RF exchanges.
+ */
+class MemoryISO15693Commands : public ISO15693Commands
+{
+  public:
+    MemoryISO15693Commands(int nbBlocks, int blockSize, size_t maxReadMultipleBlocks, size_t maxWriteMultipleBlocks)
+        : memory(nbBlocks * blockSize)
+        , nbBlocks(nbBlocks)
+        , blockSize(blockSize)
+        , maxReadBlocks(maxReadMultipleBlocks)
+        , maxWriteBlocks(maxWriteMultipleBlocks)
+        , exchanges(0)
+        , multipleBlocks(0)
+        , systemInformations(0)
+    {
+        for (size_t i = 0; i < memory.size(); ++i)
+            memory[i] = static_cast<unsigned char>(i);
+    }
+
+    void stayQuiet() override
+    {
+    }
+
+    std::vector<unsigned char> readBlock(size_t block, size_t /*le*/) override
+    {
+        ++exchanges;
+        check(block, 1);
+        return std::vector<unsigned char>(memory.begin() + block * blockSize, memory.begin() + (block + 1) * blockSize);
+    }
+
+    void writeBlock(size_t block, const std::vector<unsigned char> &data) override
+    {
+        ++exchanges;
+        check(block, 1);
+        EXPECT_EQ(static_cast<size_t>(blockSize), data.size());
+        std::copy(data.begin(), data.end(), memory.begin() + block * blockSize);
+    }
+
+    std::vector<unsigned char> readMultipleBlocks(size_t block, size_t count, size_t size) override
+    {
+        ++exchanges;
+        ++multipleBlocks;
+        EXPECT_EQ(static_cast<size_t>(blockSize), size);
+        EXPECT_LE(count, maxReadBlocks);
+        check(block, count);
+        return std::vector<unsigned char>(memory.begin() + block * blockSize, memory.begin() + (block + count) * blockSize);
+    }
+
+    void writeMultipleBlocks(size_t block, size_t count, const std::vector<unsigned char> &data) override
+    {
+        ++exchanges;
+        ++multipleBlocks;
+        EXPECT_LE(count, maxWriteBlocks);
+        EXPECT_EQ(count * blockSize, data.size());
+        check(block, count);
+        std::copy(data.begin(), data.end(), memory.begin() + block * blockSize);
+    }
+
+    size_t getMaxReadMultipleBlocks(size_t /*blockSize*/) const override
+    {
+        return maxReadBlocks;
+    }
+
+    size_t getMaxWriteMultipleBlocks(size_t /*blockSize*/) const override
+    {
+        return maxWriteBlocks;
+    }
+
+    void lockBlock(size_t) override
+    {
+    }
+    void writeAFI(size_t) override
+    {
+    }
+    void lockAFI() override
+    {
+    }
+    void writeDSFID(size_t) override
+    {
+    }
+    void lockDSFID() override
+    {
+    }
+
+    SystemInformation getSystemInformation() override
+    {
+        ++exchanges;
+        ++systemInformations;
+        SystemInformation sysinfo    = SystemInformation();
+        sysinfo.hasVICCMemorySize = true;
+        sysinfo.blockSize         = blockSize;
+        sysinfo.nbBlocks          = nbBlocks;
+        return sysinfo;
+    }
+
+    unsigned char getSecurityStatus(size_t) override
+    {
+        return 0;
+    }
+
+    std::vector<unsigned char> memory;
+    int nbBlocks;
+    int blockSize;
+    size_t maxReadBlocks;
+    size_t maxWriteBlocks;
+    int exchanges;
+    int multipleBlocks;
+    int systemInformations;
+
+  private:
+    void check(size_t block, size_t count)
+    {
+        if (block + count > static_cast<size_t>(nbBlocks))
+            throw CardException("Block out of range.");
+    }
+};
+
+static std::shared_ptr<MemoryISO15693Commands> insertTag(std::shared_ptr<ISO15693Chip> chip, int nbBlocks,
+                                                         int blockSize, size_t maxReadMultipleBlocks,
+                                                         size_t maxWriteMultipleBlocks = 1)
+{
+    auto commands = std::make_shared<MemoryISO15693Commands>(nbBlocks, blockSize, maxReadMultipleBlocks,
+                                                             maxWriteMultipleBlocks);
+    commands->setChip(chip);
+    chip->setCommands(commands);
+    chip->setChipIdentifier({0xE0, 0x04, 0x01, 0x00, 0x01, 0x02, 0x03, 0x04});
+    return commands;
+}
+
+static std::shared_ptr<ISO15693Location> blockLocation(int block)
+{
+    auto location   = std::make_shared<ISO15693Location>();
+    location->block = block;
+    return location;
+}
+
+static std::shared_ptr<StorageCardService> storage(std::shared_ptr<Chip> chip)
+{
+    return std::dynamic_pointer_cast<StorageCardService>(chip->getService(CST_STORAGE));
+}
+
+TEST(test_iso15693_multiple_blocks, read_whole_memory)
+{
+    // ICODE SLIX: 28 blocks of 4 bytes.
+    auto chip     = std::make_shared<ISO15693Chip>();
+    auto commands = insertTag(chip, 28, 4, 63);
+
+    auto data = storage(chip)->readData(blockLocation(0), std::shared_ptr<AccessInfo>(), 112, CB_DEFAULT);
+    ASSERT_EQ(commands->memory, data);
+    ASSERT_EQ(1, commands->multipleBlocks);
+    ASSERT_EQ(2, commands->exchanges);
+
+    // The system information is cached on the chip.
+    data = storage(chip)->readData(blockLocation(3), std::shared_ptr<AccessInfo>(), 10, CB_DEFAULT);
+    ASSERT_EQ(std::vector<unsigned char>(commands->memory.begin() + 12, commands->memory.begin() + 22), data);
+    ASSERT_EQ(1, commands->systemInformations);
+    ASSERT_EQ(3, commands->exchanges);
+
+    ASSERT_THROW(storage(chip)->readData(blockLocation(27), std::shared_ptr<AccessInfo>(), 8, CB_DEFAULT),
+                 std::invalid_argument);
+}
+
+TEST(test_iso15693_multiple_blocks, read_batches)
+{
+    auto chip     = std::make_shared<ISO15693Chip>();
+    auto commands = insertTag(chip, 64, 32, 7);
+
+    auto data = storage(chip)->readData(blockLocation(2), std::shared_ptr<AccessInfo>(), 1000, CB_DEFAULT);
+    ASSERT_EQ(std::vector<unsigned char>(commands->memory.begin() + 64, commands->memory.begin() + 1064), data);
+    // 32 blocks: 4 batches of 7, then 4 blocks.
+    ASSERT_EQ(5, commands->multipleBlocks);
+    ASSERT_EQ(6, commands->exchanges);
+}
+
+TEST(test_iso15693_multiple_blocks, single_block_reader)
+{
+    auto chip     = std::make_shared<ISO15693Chip>();
+    auto commands = insertTag(chip, 28, 4, 1);
+
+    auto data = storage(chip)->readData(blockLocation(0), std::shared_ptr<AccessInfo>(), 112, CB_DEFAULT);
+    ASSERT_EQ(commands->memory, data);
+    ASSERT_EQ(0, commands->multipleBlocks);
+    ASSERT_EQ(29, commands->exchanges);
+
+    // A length of 0 keeps reading a single block.
+    ASSERT_EQ(4u, storage(chip)->readData(blockLocation(5), std::shared_ptr<AccessInfo>(), 0, CB_DEFAULT).size());
+}
+
+TEST(test_iso15693_multiple_blocks, write)
+{
+    auto chip     = std::make_shared<ISO15693Chip>();
+    auto commands = insertTag(chip, 28, 4, 63, 63);
+    auto original = commands->memory;
+
+    // The end of the last block is read back and kept.
+    std::vector<unsigned char> data(30, 0xAB);
+    storage(chip)->writeData(blockLocation(4), std::shared_ptr<AccessInfo>(), std::shared_ptr<AccessInfo>(), data,
+                             CB_DEFAULT);
+    ASSERT_EQ(1, commands->multipleBlocks);
+    ASSERT_EQ(3, commands->exchanges);
+    ASSERT_EQ(data, std::vector<unsigned char>(commands->memory.begin() + 16, commands->memory.begin() + 46));
+    ASSERT_EQ(std::vector<unsigned char>(original.begin() + 46, original.end()),
+              std::vector<unsigned char>(commands->memory.begin() + 46, commands->memory.end()));
+
+    // A single block keeps Write Single Block.
+    storage(chip)->writeData(blockLocation(0), std::shared_ptr<AccessInfo>(), std::shared_ptr<AccessInfo>(),
+                             std::vector<unsigned char>(4, 0x01), CB_DEFAULT);
+    ASSERT_EQ(1, commands->multipleBlocks);
+    ASSERT_EQ(4, commands->exchanges);
+}
+
+TEST(test_iso15693_multiple_blocks, write_single_blocks)
+{
+    // ICODE SLIX has Read Multiple Blocks but no Write Multiple Blocks.
+    auto chip     = std::make_shared<ISO15693Chip>();
+    auto commands = insertTag(chip, 28, 4, 63);
+
+    std::vector<unsigned char> data(30, 0xAB);
+    storage(chip)->writeData(blockLocation(4), std::shared_ptr<AccessInfo>(), std::shared_ptr<AccessInfo>(), data,
+                             CB_DEFAULT);
+    ASSERT_EQ(0, commands->multipleBlocks);
+    // System information, last block read back, then 8 Write Single Block.
+    ASSERT_EQ(10, commands->exchanges);
+    ASSERT_EQ(data, std::vector<unsigned char>(commands->memory.begin() + 16, commands->memory.begin() + 46));
+
+    auto data2 = storage(chip)->readData(blockLocation(4), std::shared_ptr<AccessInfo>(), 30, CB_DEFAULT);
+    ASSERT_EQ(data, data2);
+    ASSERT_EQ(1, commands->multipleBlocks);
+}
+
+TEST(test_iso15693_multiple_blocks, pcsc_write_limit)
+{
+    // Write Multiple Blocks is only used once the tag is known to support it.
+    ISO15693PCSCCommands commands;
+    ASSERT_EQ(63u, commands.getMaxReadMultipleBlocks(4));
+    ASSERT_EQ(1u, commands.getMaxWriteMultipleBlocks(4));
+    commands.setWriteMultipleBlocksSupported(true);
+    ASSERT_EQ(63u, commands.getMaxWriteMultipleBlocks(4));
+}
+
+TEST(test_iso15693_multiple_blocks, system_information_uid_change)
+{
+    auto chip     = std::make_shared<ISO15693Chip>();
+    auto commands = insertTag(chip, 28, 4, 63);
+
+    chip->getSystemInformation();
+    chip->getSystemInformation();
+    ASSERT_EQ(1, commands->systemInformations);
+
+    chip->setChipIdentifier({0xE0, 0x04, 0x01, 0x00, 0x05, 0x06, 0x07, 0x08});
+    chip->getSystemInformation();
+    ASSERT_EQ(2, commands->systemInformations);
+
+    chip->clearSystemInformationCache();
+    chip->getSystemInformation();
+    ASSERT_EQ(3, commands->systemInformations);
+}
@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/bufferhelper.hpp>
+#include <logicalaccess/myexception.hpp>
+#include <logicalaccess/readerproviders/datatransport.hpp>
+#include <pluginsreaderproviders/iso7816/commands/iso7816iso7816commands.hpp>
+#include <pluginsreaderproviders/iso7816/readercardadapters/iso7816readercardadapter.hpp>
+
+using namespace logicalaccess;
+
+/**
+ * An ISO7816 card with a single transparent file, answering READ BINARY.
+ */
+class FileTransport : public DataTransport
+{
+  public:
+    explicit FileTransport(size_t size)
+        : file(size)
+    {
+        for (size_t i = 0; i < size; ++i)
+            file[i] = static_cast<unsigned char>(i * 3);
+    }
+
+    std::string getTransportType() const override
+    {
+        return "File";
+    }
+    bool connect() override
+    {
+        return true;
+    }
+    void disconnect() override
+    {
+    }
+    bool isConnected() override
+    {
+        return true;
+    }
+    std::string getName() const override
+    {
+        return "File";
+    }
+    void serialize(boost::property_tree::ptree &) override
+    {
+    }
+    void unSerialize(boost::property_tree::ptree &) override
+    {
+    }
+    std::string getDefaultXmlNodeName() const override
+    {
+        return "FileTransport";
+    }
+
+    std::vector<unsigned char> sendCommand(const std::vector<unsigned char> &command, long int) override
+    {
+        commands.push_back(command);
+        EXPECT_EQ(0xB0, command[1]);
+
+        size_t offset = (command[2] & 0x80) ? command[3] : ((command[2] << 8) | command[3]);
+        size_t le     = 0;
+        if (command.size() == 5)
+        {
+            le = command[4] ? command[4] : 256;
+        }
+        else
+        {
+            EXPECT_EQ(7u, command.size());
+            EXPECT_EQ(0x00, command[4]);
+            le = (command[5] << 8) | command[6];
+            le = le ? le : 65536;
+        }
+
+        std::vector<unsigned char> response;
+        if (offset < file.size())
+        {
+            response.assign(file.begin() + offset, file.begin() + std::min(file.size(), offset + le));
+        }
+        response.push_back(0x90);
+        response.push_back(0x00);
+        return response;
+    }
+
+    std::vector<unsigned char> file;
+    std::vector<std::vector<unsigned char>> commands;
+
+  protected:
+    void send(const std::vector<unsigned char> &) override
+    {
+    }
+    std::vector<unsigned char> receive(long int) override
+    {
+        return std::vector<unsigned char>();
+    }
+};
+
+static std::shared_ptr<ISO7816ISO7816Commands> insertCard(std::shared_ptr<FileTransport> transport)
+{
+    auto adapter  = std::make_shared<ISO7816ReaderCardAdapter>();
+    auto commands = std::make_shared<ISO7816ISO7816Commands>();
+    adapter->setDataTransport(transport);
+    commands->setReaderCardAdapter(adapter);
+    return commands;
+}
+
+TEST(test_iso7816_apdu, encoding)
+{
+    std::vector<unsigned char> data = {0x01, 0x02};
+
+    // Case 1, 2S, 3S and 4S.
+    ASSERT_EQ(BufferHelper::fromHexString("00A40000"), ISO7816ReaderCardAdapter::buildAPDUCommand(0x00, 0xA4, 0x00, 0x00, {}, 0));
+    ASSERT_EQ(BufferHelper::fromHexString("00B0000010"), ISO7816ReaderCardAdapter::buildAPDUCommand(0x00, 0xB0, 0x00, 0x00, {}, 16));
+    ASSERT_EQ(BufferHelper::fromHexString("00B0000000"), ISO7816ReaderCardAdapter::buildAPDUCommand(0x00, 0xB0, 0x00, 0x00, {}, 256));
+    ASSERT_EQ(BufferHelper::fromHexString("00D60000020102"), ISO7816ReaderCardAdapter::buildAPDUCommand(0x00, 0xD6, 0x00, 0x00, data, 0));
+    ASSERT_EQ(BufferHelper::fromHexString("0088000002010200"), ISO7816ReaderCardAdapter::buildAPDUCommand(0x00, 0x88, 0x00, 0x00, data, 256));
+
+    // Case 2E, 3E and 4E.
+    ASSERT_EQ(BufferHelper::fromHexString("00B00000000101"), ISO7816ReaderCardAdapter::buildAPDUCommand(0x00, 0xB0, 0x00, 0x00, {}, 257));
+    ASSERT_EQ(BufferHelper::fromHexString("00B00000000000"), ISO7816ReaderCardAdapter::buildAPDUCommand(0x00, 0xB0, 0x00, 0x00, {}, 65536));
+    std::vector<unsigned char> large(300, 0xAA);
+    std::vector<unsigned char> command = ISO7816ReaderCardAdapter::buildAPDUCommand(0x00, 0xD6, 0x00, 0x00, large, 0);
+    ASSERT_EQ(307u, command.size());
+    ASSERT_EQ(BufferHelper::fromHexString("00D6000000012C"), std::vector<unsigned char>(command.begin(), command.begin() + 7));
+    ASSERT_EQ(BufferHelper::fromHexString("00880000000002010203E8"), ISO7816ReaderCardAdapter::buildAPDUCommand(0x00, 0x88, 0x00, 0x00, data, 1000));
+
+    ASSERT_THROW(ISO7816ReaderCardAdapter::buildAPDUCommand(0x00, 0xB0, 0x00, 0x00, {}, 65537), std::invalid_argument);
+}
+
+TEST(test_iso7816_apdu, max_lengths)
+{
+    auto transport = std::make_shared<FileTransport>(1024);
+    auto adapter   = std::make_shared<ISO7816ReaderCardAdapter>();
+    adapter->setDataTransport(transport);
+    ASSERT_EQ(255u, adapter->getMaxCommandDataLength());
+    ASSERT_EQ(256u, adapter->getMaxResponseDataLength());
+
+    ASSERT_EQ(258u, adapter->sendExtendedAPDUCommand(0x00, 0xB0, 0x00, 0x00, {}, 256).size());
+    ASSERT_THROW(adapter->sendExtendedAPDUCommand(0x00, 0xB0, 0x00, 0x00, {}, 257), LibLogicalAccessException);
+    ASSERT_EQ(1u, transport->commands.size());
+
+    adapter->setMaxDataLengths(1000, 100000);
+    ASSERT_EQ(1000u, adapter->getMaxCommandDataLength());
+    ASSERT_EQ(65536u, adapter->getMaxResponseDataLength());
+    ASSERT_EQ(1026u, adapter->sendExtendedAPDUCommand(0x00, 0xB0, 0x00, 0x00, {}, 1024).size());
+}
+
+TEST(test_iso7816_apdu, atr)
+{
+    // T=1 card, compact-TLV historical bytes with extended Lc/Le in the card capabilities.
+    ASSERT_TRUE(ISO7816ReaderCardAdapter::isExtendedLengthSupported(
+        BufferHelper::fromHexString("3BFD1300008131FE158073C021C057597562694B657940")));
+    // Category 00: the last 3 historical bytes are the status.
+    ASSERT_TRUE(ISO7816ReaderCardAdapter::isExtendedLengthSupported(
+        BufferHelper::fromHexString("3B888001007300004000900000")));
+    ASSERT_FALSE(ISO7816ReaderCardAdapter::isExtendedLengthSupported(
+        BufferHelper::fromHexString("3B888001007300000000900000")));
+
+    // PC/SC contactless storage card, and malformed ATRs.
+    ASSERT_FALSE(ISO7816ReaderCardAdapter::isExtendedLengthSupported(
+        BufferHelper::fromHexString("3B8F8001804F0CA000000306030001000000006A")));
+    ASSERT_FALSE(ISO7816ReaderCardAdapter::isExtendedLengthSupported(BufferHelper::fromHexString("3BFD13")));
+    ASSERT_FALSE(ISO7816ReaderCardAdapter::isExtendedLengthSupported(std::vector<unsigned char>()));
+}
+
+TEST(test_iso7816_apdu, ef_atr)
+{
+    size_t maxNc = 0, maxNe = 0;
+    ASSERT_TRUE(ISO7816ReaderCardAdapter::parseExtendedLengthInfo(
+        BufferHelper::fromHexString("4703C021C07F66080202080002021000"), maxNc, maxNe));
+    ASSERT_EQ(0x800u, maxNc);
+    ASSERT_EQ(0x1000u, maxNe);
+
+    // Long form length, and 3-byte integers.
+    ASSERT_TRUE(ISO7816ReaderCardAdapter::parseExtendedLengthInfo(
+        BufferHelper::fromHexString("7F66810A0203010000020300FFFF"), maxNc, maxNe));
+    ASSERT_EQ(0x10000u, maxNc);
+    ASSERT_EQ(0xFFFFu, maxNe);
+
+    ASSERT_FALSE(ISO7816ReaderCardAdapter::parseExtendedLengthInfo(BufferHelper::fromHexString("4703C021C0"), maxNc, maxNe));
+    ASSERT_FALSE(ISO7816ReaderCardAdapter::parseExtendedLengthInfo(BufferHelper::fromHexString("7F66080202"), maxNc, maxNe));
+}
+
+TEST(test_iso7816_apdu, read_binary_chunks)
+{
+    auto transport = std::make_shared<FileTransport>(1000);
+    auto commands  = insertCard(transport);
+
+    // Short APDUs: 256 bytes at most per command.
+    ASSERT_EQ(transport->file, commands->readBinary(1000, 0));
+    ASSERT_EQ(4u, transport->commands.size());
+    ASSERT_EQ(BufferHelper::fromHexString("00B00300E8"), transport->commands[3]);
+
+    // Extended APDUs: the whole file at once.
+    transport->commands.clear();
+    commands->getISO7816ReaderCardAdapter()->setMaxDataLengths(65535, 65536);
+    ASSERT_EQ(transport->file, commands->readBinary(1000, 0));
+    ASSERT_EQ(1u, transport->commands.size());
+    ASSERT_EQ(BufferHelper::fromHexString("00B000000003E8"), transport->commands[0]);
+
+    // A length of 0 keeps the single Le = 00 command.
+    transport->commands.clear();
+    ASSERT_EQ(std::vector<unsigned char>(transport->file.begin(), transport->file.begin() + 256), commands->readBinary(0, 0));
+    ASSERT_EQ(BufferHelper::fromHexString("00B0000000"), transport->commands[0]);
+}
+
+TEST(test_iso7816_apdu, read_binary_end_of_file)
+{
+    auto transport = std::make_shared<FileTransport>(600);
+    auto commands  = insertCard(transport);
+
+    // The short identifier only selects the file on the first command, and
+    // the short response at the end of the file stops the read.
+    ASSERT_EQ(transport->file, commands->readBinary(2000, 0, 0x01));
+    ASSERT_EQ(3u, transport->commands.size());
+    ASSERT_EQ(BufferHelper::fromHexString("00B0810000"), transport->commands[0]);
+    ASSERT_EQ(BufferHelper::fromHexString("00B0010000"), transport->commands[1]);
+    ASSERT_EQ(BufferHelper::fromHexString("00B0020000"), transport->commands[2]);
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <pluginscards/desfire/desfirekey.hpp>
+#include <pluginscards/desfire/nxpav1keydiversification.hpp>
+#include <pluginscards/desfire/nxpav2keydiversification.hpp>
+#include <pluginscards/desfire/sagemkeydiversification.hpp>
+#include <pluginscards/desfire/omnitechkeydiversification.hpp>
+#include <chrono>
+
+using namespace logicalaccess;
+
+static std::shared_ptr<DESFireKey> createKey(DESFireKeyType keyType, unsigned char seed)
+{
+    std::shared_ptr<DESFireKey> key = std::make_shared<DESFireKey>();
+    key->setKeyType(keyType);
+    std::vector<unsigned char> data(key->getLength());
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<unsigned char>(seed + i * 13);
+    key->setData(data);
+    key->setKeyVersion(0xA5);
+    return key;
+}
+
+static std::vector<std::vector<unsigned char>> buildInputs(KeyDiversification &div, std::shared_ptr<Key> key, size_t count)
+{
+    std::vector<std::vector<unsigned char>> inputs(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::vector<unsigned char> uid = {0x04, static_cast<unsigned char>(i >> 16), static_cast<unsigned char>(i >> 8),
+                                          static_cast<unsigned char>(i), 0x5A, 0x80, 0x01};
+        div.initDiversification(uid, 0x123456, key, 0x02, inputs[i]);
+    }
+    return inputs;
+}
+
+static void checkBatch(KeyDiversification &div, std::shared_ptr<Key> key, size_t count)
+{
+    std::vector<std::vector<unsigned char>> inputs = buildInputs(div, key, count);
+    std::vector<std::vector<unsigned char>> keys = div.diversifyBatch(key, inputs);
+    ASSERT_EQ(inputs.size(), keys.size());
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        ASSERT_EQ(div.getDiversifiedKey(key, inputs[i]), keys[i]) << div.getType() << " input " << i;
+    }
+}
+
+TEST(test_key_diversification_batch, nxpav2_matches_scalar)
+{
+    DESFireKeyType types[] = {DF_KEY_AES, DF_KEY_DES, DF_KEY_3K3DES};
+    for (DESFireKeyType type : types)
+    {
+        NXPAV2KeyDiversification div;
+        checkBatch(div, createKey(type, 0x10), 300);
+
+        div.setForceK2Use(true);
+        checkBatch(div, createKey(type, 0x20), 300);
+
+        // Long and block aligned diversification inputs, the subkey choice and the output slicing differ.
+        div.setForceK2Use(false);
+        div.setDivInput(std::vector<unsigned char>(31, 0x42));
+        checkBatch(div, createKey(type, 0x30), 5);
+        div.setDivInput(std::vector<unsigned char>(15, 0x43));
+        checkBatch(div, createKey(type, 0x40), 5);
+    }
+
+    NXPAV2KeyDiversification div;
+    ASSERT_TRUE(div.diversifyBatch(createKey(DF_KEY_AES, 0x00), std::vector<std::vector<unsigned char>>()).empty());
+}
+
+TEST(test_key_diversification_batch, other_algorithms_match_scalar)
+{
+    NXPAV1KeyDiversification av1;
+    checkBatch(av1, createKey(DF_KEY_AES, 0x50), 300);
+    checkBatch(av1, createKey(DF_KEY_DES, 0x60), 300);
+    checkBatch(av1, createKey(DF_KEY_3K3DES, 0x70), 300);
+
+    SagemKeyDiversification sagem;
+    checkBatch(sagem, createKey(DF_KEY_DES, 0x80), 300);
+
+    OmnitechKeyDiversification omnitech;
+    checkBatch(omnitech, createKey(DF_KEY_DES, 0x90), 300);
+
+    // A DES key with equal halves is a single DES key.
+    std::shared_ptr<DESFireKey> single = createKey(DF_KEY_DES, 0xA0);
+    std::vector<unsigned char> data(single->getData(), single->getData() + 8);
+    data.insert(data.end(), data.begin(), data.end());
+    single->setData(data);
+    checkBatch(sagem, single, 100);
+}
+
+#ifdef LLA_BENCHMARK
+TEST(benchmark_key_diversification_batch, nxpav2)
+{
+    const size_t count = 20000;
+    std::shared_ptr<DESFireKey> key = createKey(DF_KEY_AES, 0x11);
+    NXPAV2KeyDiversification div;
+    std::vector<std::vector<unsigned char>> inputs = buildInputs(div, key, count);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::vector<unsigned char>> scalar;
+    for (size_t i = 0; i < count; ++i)
+        scalar.push_back(div.getDiversifiedKey(key, inputs[i]));
+    double scalarSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    std::vector<std::vector<unsigned char>> batch = div.diversifyBatch(key, inputs);
+    double batchSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << count << " NXP AV2 AES diversifications: " << scalarSeconds * 1000 << " ms scalar, "
+              << batchSeconds * 1000 << " ms batch" << std::endl;
+}
+#endif
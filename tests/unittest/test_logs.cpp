@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/logs.hpp>
+#include <logicalaccess/settings.hpp>
+#include <logicalaccess/bufferhelper.hpp>
+#include <chrono>
+
+using namespace logicalaccess;
+
+static int evaluation_count = 0;
+
+static std::string count_evaluation()
+{
+    ++evaluation_count;
+    return "evaluated";
+}
+
+class test_logs : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        old_ = Settings::getInstance()->IsLogEnabled;
+        Settings::getInstance()->IsLogEnabled = false;
+        Logs::updateLevelMask();
+    }
+
+    void TearDown() override
+    {
+        Settings::getInstance()->IsLogEnabled = old_;
+        Logs::updateLevelMask();
+    }
+
+  private:
+    bool old_;
+};
+
+TEST_F(test_logs, disabled_log_does_not_evaluate_arguments)
+{
+    evaluation_count = 0;
+    ASSERT_FALSE(Logs::isEnabled(INFOS));
+    ASSERT_FALSE(Logs::isEnabled(TRACE));
+
+    LOG(LogLevel::INFOS) << count_evaluation();
+    LOG(LogLevel::COMS) << count_evaluation() << count_evaluation();
+    TRACE(count_evaluation());
+
+    ASSERT_EQ(0, evaluation_count);
+}
+
+#ifdef LLA_BENCHMARK
+typedef test_logs benchmark_logs;
+
+TEST_F(benchmark_logs, disabled_log)
+{
+    const int iterations = 1000000;
+    std::vector<unsigned char> buffer(256, 0xAB);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        LOG(LogLevel::COMS) << "Command: " << BufferHelper::getHex(buffer);
+    }
+    auto disabled = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations / 100; ++i)
+    {
+        BufferHelper::getHex(buffer);
+    }
+    auto hex = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now() - start).count() * 100;
+
+    std::cout << "Disabled LOG(): " << (double)disabled / iterations << " ns/op, "
+              << "hex formatting alone: " << (double)hex / iterations << " ns/op"
+              << std::endl;
+}
+#endif
@@ -0,0 +1,414 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/myexception.hpp>
+#include <pluginscards/mifare/mifare1kchip.hpp>
+#include <pluginscards/mifare/mifare4kchip.hpp>
+#include <pluginscards/mifare/mifareaccessinfo.hpp>
+#include <pluginscards/mifare/mifarecommands.hpp>
+
+#include <chrono>
+#include <thread>
+
+using namespace logicalaccess;
+
+/**
+ * A Mifare Classic card in memory, behind a reader with key slots.
+ * Each exchange waits for the given latency, as a PC/SC APDU would.
+ */
+class MemoryMifareCard : public MifareCommands
+{
+  public:
+    MemoryMifareCard(int nbSectors, unsigned char nbKeySlots, unsigned char maxReadBlocks,
+                     std::chrono::microseconds latency)
+        : nbSectors(nbSectors)
+        , nbKeySlots(nbKeySlots)
+        , maxReadBlocks(maxReadBlocks)
+        , latency(latency)
+        , exchanges(0)
+        , reads(0)
+        , keyLoads(0)
+        , authentications(0)
+        , slots(nbKeySlots, std::vector<unsigned char>(MIFARE_KEY_SIZE, 0x00))
+        , authSector(-1)
+        , authKeyType(KT_KEY_A)
+    {
+        memory.resize((getSectorStartBlock(nbSectors - 1) + getNbBlocks(nbSectors - 1) + 1) * 16);
+        for (size_t i = 0; i < memory.size(); ++i)
+            memory[i] = static_cast<unsigned char>(i * 7);
+
+        MifareAccessInfo::SectorAccessBits sab;
+        sab.setTransportConfiguration();
+        MifareKey key("ff ff ff ff ff ff");
+        for (int sector = 0; sector < nbSectors; ++sector)
+            setSector(sector, key, key, sab);
+    }
+
+    void setSector(int sector, const MifareKey &keyA, const MifareKey &keyB,
+                   const MifareAccessInfo::SectorAccessBits &sab)
+    {
+        unsigned char *trailer = &memory[trailerBlock(sector) * 16];
+        std::copy(keyA.getData(), keyA.getData() + MIFARE_KEY_SIZE, trailer);
+        sab.toArray(trailer + 6, 3);
+        trailer[9] = 0x69;
+        std::copy(keyB.getData(), keyB.getData() + MIFARE_KEY_SIZE, trailer + 10);
+    }
+
+    static int trailerBlock(int sector)
+    {
+        return getSectorStartBlock(sector) + getNbBlocks(sector);
+    }
+
+    static int sectorOf(int block)
+    {
+        return (block < 128) ? block / 4 : 32 + (block - 128) / 16;
+    }
+
+    std::vector<unsigned char> readBinary(unsigned char blockno, size_t len) override
+    {
+        exchange();
+        ++reads;
+        EXPECT_EQ(0u, len % 16);
+        size_t count = len / 16;
+        EXPECT_LE(count, maxReadBlocks);
+
+        std::vector<unsigned char> ret;
+        for (size_t i = 0; i < count; ++i)
+        {
+            int block = blockno + static_cast<int>(i);
+            if (sectorOf(block) != authSector || !canRead(block))
+            {
+                authSector = -1;
+                throw CardException("Access denied.");
+            }
+
+            ret.insert(ret.end(), memory.begin() + block * 16, memory.begin() + (block + 1) * 16);
+            if (block == trailerBlock(authSector))
+            {
+                // Key A is never read back, key B only when the access bits allow it.
+                std::fill(ret.end() - 16, ret.end() - 10, 0x00);
+                if (!isKeyBReadable(authSector))
+                    std::fill(ret.end() - 6, ret.end(), 0x00);
+            }
+        }
+        return ret;
+    }
+
+    void updateBinary(unsigned char, const std::vector<unsigned char> &) override
+    {
+        throw CardException("Read only.");
+    }
+
+    bool loadKey(unsigned char keyno, MifareKeyType, std::shared_ptr<MifareKey> key, bool) override
+    {
+        exchange();
+        ++keyLoads;
+        if (keyno >= nbKeySlots)
+            throw CardException("Bad key slot.");
+        slots[keyno].assign(key->getData(), key->getData() + MIFARE_KEY_SIZE);
+        return true;
+    }
+
+    void loadKey(std::shared_ptr<Location>, MifareKeyType, std::shared_ptr<MifareKey> key) override
+    {
+        exchange();
+        ++keyLoads;
+        slots[0].assign(key->getData(), key->getData() + MIFARE_KEY_SIZE);
+    }
+
+    void authenticate(unsigned char blockno, unsigned char keyno, MifareKeyType keytype) override
+    {
+        exchange();
+        ++authentications;
+        checkKey(sectorOf(blockno), slots.at(keyno), keytype);
+    }
+
+    void authenticate(unsigned char blockno, std::shared_ptr<KeyStorage>, MifareKeyType keytype) override
+    {
+        exchange();
+        ++authentications;
+        checkKey(sectorOf(blockno), slots[0], keytype);
+    }
+
+    void increment(uint8_t, uint32_t) override
+    {
+    }
+
+    void decrement(uint8_t, uint32_t) override
+    {
+    }
+
+    unsigned char getNbKeySlots() const override
+    {
+        return nbKeySlots;
+    }
+
+    unsigned char getMaxReadBlocks() const override
+    {
+        return maxReadBlocks;
+    }
+
+    std::vector<unsigned char> memory;
+    int nbSectors;
+    unsigned char nbKeySlots;
+    unsigned char maxReadBlocks;
+    std::chrono::microseconds latency;
+    int exchanges;
+    int reads;
+    int keyLoads;
+    int authentications;
+
+  private:
+    void exchange()
+    {
+        ++exchanges;
+        if (latency.count() > 0)
+            std::this_thread::sleep_for(latency);
+    }
+
+    MifareAccessInfo::SectorAccessBits accessBits(int sector) const
+    {
+        MifareAccessInfo::SectorAccessBits sab;
+        EXPECT_TRUE(sab.fromArray(&memory[trailerBlock(sector) * 16 + 6], 3));
+        return sab;
+    }
+
+    bool isKeyBReadable(int sector) const
+    {
+        const MifareAccessInfo::SectorTrailerAccessBits &bits = accessBits(sector).d_sector_trailer_access_bits;
+        return !bits.c1 && !(bits.c2 && bits.c3);
+    }
+
+    bool canRead(int block) const
+    {
+        int sector = sectorOf(block);
+        if (block == trailerBlock(sector))
+            return true;
+
+        int i = block - getSectorStartBlock(sector);
+        const MifareAccessInfo::DataBlockAccessBits &bits =
+            accessBits(sector).d_data_blocks_access_bits[(sector >= 32) ? std::min(i / 5, 2) : i];
+        if (bits.c1 && bits.c2 && bits.c3)
+            return false;
+        if (bits.c3 && (bits.c1 != bits.c2))
+            return authKeyType == KT_KEY_B;
+        return true;
+    }
+
+    void checkKey(int sector, const std::vector<unsigned char> &key, MifareKeyType keytype)
+    {
+        authSector = -1;
+        const unsigned char *trailer = &memory[trailerBlock(sector) * 16 + ((keytype == KT_KEY_A) ? 0 : 10)];
+        if (!std::equal(key.begin(), key.end(), trailer))
+            throw CardException("Authentication failed.");
+        authSector  = sector;
+        authKeyType = keytype;
+    }
+
+    std::vector<std::vector<unsigned char>> slots;
+    int authSector;
+    MifareKeyType authKeyType;
+};
+
+template <typename T>
+static std::shared_ptr<MemoryMifareCard> insertCard(std::shared_ptr<T> chip, int nbSectors, unsigned char nbKeySlots,
+                                                    unsigned char maxReadBlocks,
+                                                    std::chrono::microseconds latency = std::chrono::microseconds(0))
+{
+    auto commands = std::make_shared<MemoryMifareCard>(nbSectors, nbKeySlots, maxReadBlocks, latency);
+    commands->setChip(chip);
+    chip->setCommands(commands);
+    return commands;
+}
+
+static std::vector<std::shared_ptr<MifareKey>> dictionary()
+{
+    return {std::make_shared<MifareKey>("ff ff ff ff ff ff"), std::make_shared<MifareKey>("a0 a1 a2 a3 a4 a5"),
+            std::make_shared<MifareKey>("d3 f7 d3 f7 d3 f7"), std::make_shared<MifareKey>("11 22 33 44 55 66")};
+}
+
+static std::vector<unsigned char> blocks(const std::vector<unsigned char> &memory, int block, int count)
+{
+    return std::vector<unsigned char>(memory.begin() + block * 16, memory.begin() + (block + count) * 16);
+}
+
+TEST(test_mifare_dump, default_keys_4k)
+{
+    auto chip     = std::make_shared<Mifare4KChip>();
+    auto commands = insertCard(chip, 40, 1, 1);
+
+    MifareCommands::CardDump dump = commands->dumpCard(dictionary());
+    ASSERT_EQ(commands->memory, dump.image);
+    ASSERT_EQ(std::vector<bool>(256, true), dump.blocksRead);
+    ASSERT_EQ(std::vector<int>(40, 0), dump.keyA);
+    ASSERT_EQ(std::vector<int>(40, -1), dump.keyB);
+
+    // A single key load and an authentication per sector.
+    ASSERT_EQ(1u, dump.keyLoads);
+    ASSERT_EQ(40u, dump.authentications);
+    ASSERT_EQ(1 + 40 + 256, commands->exchanges);
+}
+
+TEST(test_mifare_dump, multiple_blocks_read)
+{
+    auto chip     = std::make_shared<Mifare4KChip>();
+    auto commands = insertCard(chip, 40, 4, 15);
+
+    MifareCommands::CardDump dump = commands->dumpCard(dictionary());
+    ASSERT_EQ(commands->memory, dump.image);
+
+    // The trailer, then the data blocks of the sector at once.
+    ASSERT_EQ(80, commands->reads);
+    ASSERT_EQ(1 + 40 + 80, commands->exchanges);
+}
+
+TEST(test_mifare_dump, key_dictionary)
+{
+    auto chip     = std::make_shared<Mifare1KChip>();
+    auto commands = insertCard(chip, 16, 1, 1);
+    auto keys     = dictionary();
+
+    MifareAccessInfo::SectorAccessBits sab;
+    sab.setTransportConfiguration();
+    commands->setSector(0, *keys[1], *keys[0], sab);
+    for (int sector = 1; sector < 5; ++sector)
+        commands->setSector(sector, *keys[2], *keys[0], sab);
+    commands->setSector(5, *keys[3], *keys[0], sab);
+
+    MifareCommands::CardDump dump = commands->dumpCard(keys);
+    ASSERT_EQ(commands->memory, dump.image);
+    std::vector<int> keyA = {1, 2, 2, 2, 2, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    ASSERT_EQ(keyA, dump.keyA);
+
+    // The previous sector key first: 2 + 3 + 3 + 4 + 2 + 9 authentications.
+    ASSERT_EQ(23u, dump.authentications);
+    ASSERT_EQ(8u, dump.keyLoads);
+
+    // With more key slots, the keys already loaded are tried first and not loaded again.
+    commands = insertCard(chip, 16, 4, 1);
+    commands->setSector(0, *keys[1], *keys[0], sab);
+    for (int sector = 1; sector < 5; ++sector)
+        commands->setSector(sector, *keys[2], *keys[0], sab);
+    commands->setSector(5, *keys[3], *keys[0], sab);
+
+    dump = commands->dumpCard(keys);
+    ASSERT_EQ(keyA, dump.keyA);
+    ASSERT_EQ(23u, dump.authentications);
+    ASSERT_EQ(4u, dump.keyLoads);
+}
+
+TEST(test_mifare_dump, key_b)
+{
+    auto chip     = std::make_shared<Mifare1KChip>();
+    auto commands = insertCard(chip, 16, 2, 15);
+    auto keys     = dictionary();
+
+    // Sector 2: block 1 is read with key B only, block 2 is never readable, key B is not readable.
+    MifareAccessInfo::SectorAccessBits sab;
+    sab.setTransportConfiguration();
+    sab.d_data_blocks_access_bits[1].c1 = false;
+    sab.d_data_blocks_access_bits[1].c2 = true;
+    sab.d_data_blocks_access_bits[1].c3 = true;
+    sab.d_data_blocks_access_bits[2].c1 = true;
+    sab.d_data_blocks_access_bits[2].c2 = true;
+    sab.d_data_blocks_access_bits[2].c3 = true;
+    sab.d_sector_trailer_access_bits.c1 = false;
+    sab.d_sector_trailer_access_bits.c2 = true;
+    sab.d_sector_trailer_access_bits.c3 = true;
+    commands->setSector(2, *keys[0], *keys[3], sab);
+
+    // Sector 3: key A is unknown, all the blocks are read with key B.
+    MifareAccessInfo::SectorAccessBits transport;
+    transport.setTransportConfiguration();
+    commands->setSector(3, MifareKey("01 02 03 04 05 06"), *keys[2], transport);
+
+    // Sector 4: no key known.
+    commands->setSector(4, MifareKey("01 02 03 04 05 06"), MifareKey("01 02 03 04 05 06"), transport);
+
+    MifareCommands::CardDump dump = commands->dumpCard(keys);
+
+    ASSERT_EQ(0, dump.keyA[2]);
+    ASSERT_EQ(3, dump.keyB[2]);
+    ASSERT_TRUE(dump.blocksRead[8]);
+    ASSERT_TRUE(dump.blocksRead[9]);
+    ASSERT_FALSE(dump.blocksRead[10]);
+    ASSERT_EQ(blocks(commands->memory, 8, 2), blocks(dump.image, 8, 2));
+    ASSERT_EQ(std::vector<unsigned char>(16, 0x00), blocks(dump.image, 10, 1));
+    ASSERT_EQ(blocks(commands->memory, 11, 1), blocks(dump.image, 11, 1));
+
+    ASSERT_EQ(-1, dump.keyA[3]);
+    ASSERT_EQ(2, dump.keyB[3]);
+    ASSERT_EQ(blocks(commands->memory, 12, 3), blocks(dump.image, 12, 3));
+    // The unknown key A is left to 0x00 in the trailer.
+    ASSERT_EQ(std::vector<unsigned char>(6, 0x00), std::vector<unsigned char>(dump.image.begin() + 15 * 16,
+                                                                              dump.image.begin() + 15 * 16 + 6));
+
+    ASSERT_EQ(-1, dump.keyA[4]);
+    ASSERT_EQ(-1, dump.keyB[4]);
+    ASSERT_EQ(std::vector<bool>(4, false), std::vector<bool>(dump.blocksRead.begin() + 16, dump.blocksRead.begin() + 20));
+
+    // The other sectors only need key A.
+    ASSERT_EQ(-1, dump.keyB[0]);
+    ASSERT_EQ(blocks(commands->memory, 20, 44), blocks(dump.image, 20, 44));
+}
+
+/**
+ * The exchanges and time of the data read and of the dumps of a transport configured Mifare 4K.
+ */
+struct DumpRun
+{
+    explicit DumpRun(std::chrono::microseconds latency)
+    {
+        auto keys = dictionary();
+        MifareAccessInfo::SectorAccessBits sab;
+        sab.setTransportConfiguration();
+
+        auto chip     = std::make_shared<Mifare4KChip>();
+        auto commands = insertCard(chip, 40, 1, 1, latency);
+        auto start    = std::chrono::steady_clock::now();
+        dataSize      = commands->readSectors(0, 39, 0, keys[0], keys[0], sab).size();
+        sectors       = std::chrono::steady_clock::now() - start;
+        sectorsExchanges = commands->exchanges;
+
+        commands = insertCard(chip, 40, 1, 1, latency);
+        start    = std::chrono::steady_clock::now();
+        commands->dumpCard(keys);
+        dump          = std::chrono::steady_clock::now() - start;
+        dumpExchanges = commands->exchanges;
+
+        commands = insertCard(chip, 40, 4, 15, latency);
+        start    = std::chrono::steady_clock::now();
+        commands->dumpCard(keys);
+        fastDump          = std::chrono::steady_clock::now() - start;
+        fastDumpExchanges = commands->exchanges;
+    }
+
+    size_t dataSize;
+    std::chrono::steady_clock::duration sectors, dump, fastDump;
+    int sectorsExchanges, dumpExchanges, fastDumpExchanges;
+};
+
+TEST(test_mifare_dump, exchange_counts)
+{
+    DumpRun run(std::chrono::microseconds(0));
+    ASSERT_EQ(3u * 32 * 16 + 15 * 8 * 16, run.dataSize);
+
+    // The 40 key loads become 1, and the dump also reads the 40 sector trailers.
+    ASSERT_EQ(run.sectorsExchanges - 39 + 40, run.dumpExchanges);
+    ASSERT_LT(run.fastDumpExchanges * 2, run.dumpExchanges);
+}
+
+#ifdef LLA_BENCHMARK
+TEST(benchmark_mifare_dump, dump)
+{
+    // A PC/SC exchange with a contactless card commonly takes a few milliseconds.
+    const std::chrono::microseconds latency(2000);
+    DumpRun run(latency);
+
+    std::cout << "Mifare 4K, " << latency.count() << "us per exchange:" << std::endl
+              << "  readSectors (data only): " << run.sectorsExchanges << " exchanges, "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(run.sectors).count() << "ms" << std::endl
+              << "  dumpCard: " << run.dumpExchanges << " exchanges, "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(run.dump).count() << "ms" << std::endl
+              << "  dumpCard, 4 key slots and 15 blocks per read: " << run.fastDumpExchanges << " exchanges, "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(run.fastDump).count() << "ms" << std::endl;
+}
+#endif
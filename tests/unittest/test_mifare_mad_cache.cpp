@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/services/storage/storagecardservice.hpp>
+#include <pluginscards/mifare/mifare1kchip.hpp>
+#include <pluginscards/mifare/mifare4kchip.hpp>
+#include <pluginscards/mifare/mifareaccessinfo.hpp>
+#include <pluginscards/mifare/mifarecommands.hpp>
+#include <pluginscards/mifare/mifarelocation.hpp>
+
+using namespace logicalaccess;
+
+/**
+ * A Mifare Classic card in memory, counting the RF exchanges.
+ */
+class MemoryMifareCommands : public MifareCommands
+{
+  public:
+    explicit MemoryMifareCommands(size_t nbBlocks)
+        : blocks(nbBlocks, std::vector<unsigned char>(16, 0x00))
+        , reads(0)
+        , writes(0)
+        , authentications(0)
+    {
+    }
+
+    std::vector<unsigned char> readBinary(unsigned char blockno, size_t /*len*/) override
+    {
+        ++reads;
+        return blocks.at(blockno);
+    }
+
+    void updateBinary(unsigned char blockno, const std::vector<unsigned char> &buf) override
+    {
+        ++writes;
+        blocks.at(blockno) = buf;
+    }
+
+    bool loadKey(unsigned char, MifareKeyType, std::shared_ptr<MifareKey>, bool) override
+    {
+        return true;
+    }
+
+    void loadKey(std::shared_ptr<Location>, MifareKeyType, std::shared_ptr<MifareKey>) override
+    {
+    }
+
+    void authenticate(unsigned char, unsigned char, MifareKeyType) override
+    {
+        ++authentications;
+    }
+
+    void authenticate(unsigned char, std::shared_ptr<KeyStorage>, MifareKeyType) override
+    {
+        ++authentications;
+    }
+
+    void increment(uint8_t, uint32_t) override
+    {
+    }
+
+    void decrement(uint8_t, uint32_t) override
+    {
+    }
+
+    int exchanges() const
+    {
+        return reads + writes + authentications;
+    }
+
+    std::vector<std::vector<unsigned char>> blocks;
+    int reads;
+    int writes;
+    int authentications;
+};
+
+template <typename T>
+static std::shared_ptr<MemoryMifareCommands> insertCard(std::shared_ptr<T> chip, size_t nbBlocks)
+{
+    auto commands = std::make_shared<MemoryMifareCommands>(nbBlocks);
+    commands->setChip(chip);
+    chip->setCommands(commands);
+    chip->setChipIdentifier({0x01, 0x02, 0x03, 0x04});
+    return commands;
+}
+
+static std::shared_ptr<MifareLocation> aidLocation(unsigned short aid, int sector = 0)
+{
+    auto location    = std::make_shared<MifareLocation>();
+    location->sector = sector;
+    location->useMAD = true;
+    location->aid    = aid;
+    return location;
+}
+
+static std::shared_ptr<MifareAccessInfo> madAccessInfo()
+{
+    auto ai    = std::make_shared<MifareAccessInfo>();
+    ai->useMAD = true;
+    return ai;
+}
+
+static std::shared_ptr<StorageCardService> storage(std::shared_ptr<Chip> chip)
+{
+    return std::dynamic_pointer_cast<StorageCardService>(chip->getService(CST_STORAGE));
+}
+
+TEST(test_mifare_mad_cache, read_without_rf_once_cached)
+{
+    auto chip     = std::make_shared<Mifare1KChip>();
+    auto commands = insertCard(chip, 64);
+    auto service  = storage(chip);
+    auto ai       = madAccessInfo();
+
+    service->writeData(aidLocation(0x4810, 5), ai, std::shared_ptr<AccessInfo>(),
+                       std::vector<unsigned char>(16, 0xAB), CB_DEFAULT);
+
+    // setSectorToMAD updated the cache with the MAD it wrote.
+    std::vector<unsigned char> mad = chip->getCachedMAD(false);
+    ASSERT_EQ(32u, mad.size());
+    std::vector<unsigned char> written(commands->blocks[1]);
+    written.insert(written.end(), commands->blocks[2].begin(), commands->blocks[2].end());
+    ASSERT_EQ(written, mad);
+
+    ASSERT_EQ(5u, commands->getSectorFromMAD(0x4810, ai->madKeyA));
+
+    // Only the data sector is read: 1 authentication and 3 blocks.
+    int before = commands->exchanges();
+    auto data  = service->readData(aidLocation(0x4810), ai, 16, CB_DEFAULT);
+    ASSERT_EQ(std::vector<unsigned char>(16, 0xAB), data);
+    ASSERT_EQ(before + 4, commands->exchanges());
+}
+
+TEST(test_mifare_mad_cache, filled_on_first_use)
+{
+    auto chip     = std::make_shared<Mifare1KChip>();
+    auto commands = insertCard(chip, 64);
+    auto ai       = madAccessInfo();
+    commands->setSectorToMAD(0x4810, 3, ai->madKeyA, ai->madKeyB);
+
+    // Another chip object on the same card starts with no cache.
+    auto other = std::make_shared<Mifare1KChip>();
+    commands->setChip(other);
+    other->setCommands(commands);
+    other->setChipIdentifier(chip->getChipIdentifier());
+    ASSERT_TRUE(other->getCachedMAD(false).empty());
+
+    int before = commands->exchanges();
+    ASSERT_EQ(3u, commands->getSectorFromMAD(0x4810, ai->madKeyA));
+    ASSERT_EQ(before + 3, commands->exchanges());
+
+    before = commands->exchanges();
+    ASSERT_EQ(3u, commands->getSectorFromMAD(0x4810, ai->madKeyA));
+    ASSERT_EQ(static_cast<unsigned int>(-1), commands->getSectorFromMAD(0x4811, ai->madKeyA));
+    ASSERT_EQ(before, commands->exchanges());
+}
+
+TEST(test_mifare_mad_cache, invalidated_on_uid_change)
+{
+    auto chip     = std::make_shared<Mifare1KChip>();
+    auto commands = insertCard(chip, 64);
+    auto ai       = madAccessInfo();
+    commands->setSectorToMAD(0x4810, 3, ai->madKeyA, ai->madKeyB);
+    ASSERT_FALSE(chip->getCachedMAD(false).empty());
+
+    chip->setChipIdentifier({0x05, 0x06, 0x07, 0x08});
+    ASSERT_TRUE(chip->getCachedMAD(false).empty());
+
+    int before = commands->exchanges();
+    ASSERT_EQ(3u, commands->getSectorFromMAD(0x4810, ai->madKeyA));
+    ASSERT_EQ(before + 3, commands->exchanges());
+}
+
+TEST(test_mifare_mad_cache, invalidated_on_raw_mad_write)
+{
+    auto chip     = std::make_shared<Mifare1KChip>();
+    auto commands = insertCard(chip, 64);
+    auto ai       = madAccessInfo();
+    commands->setSectorToMAD(0x4810, 3, ai->madKeyA, ai->madKeyB);
+
+    // Erase the MAD through the sector API.
+    MifareAccessInfo::SectorAccessBits sab;
+    sab.setTransportConfiguration();
+    commands->writeSector(0, 1, std::vector<unsigned char>(32, 0x00), ai->madKeyA, ai->madKeyB, sab);
+    ASSERT_TRUE(chip->getCachedMAD(false).empty());
+
+    // The CRC of the erased MAD is wrong, and it is not cached.
+    ASSERT_THROW(commands->getSectorFromMAD(0x4810, ai->madKeyA), LibLogicalAccessException);
+    ASSERT_TRUE(chip->getCachedMAD(false).empty());
+}
+
+TEST(test_mifare_mad_cache, mad2)
+{
+    auto chip     = std::make_shared<Mifare4KChip>();
+    auto commands = insertCard(chip, 256);
+    auto ai       = madAccessInfo();
+    commands->setSectorToMAD(0x4810, 3, ai->madKeyA, ai->madKeyB);
+    commands->setSectorToMAD(0x4820, 20, ai->madKeyA, ai->madKeyB);
+    ASSERT_EQ(48u, chip->getCachedMAD(true).size());
+
+    int before = commands->exchanges();
+    ASSERT_EQ(3u, commands->getSectorFromMAD(0x4810, ai->madKeyA));
+    ASSERT_EQ(static_cast<unsigned int>(-1), commands->getSectorFromMAD(0x4830, ai->madKeyA));
+    ASSERT_EQ(before, commands->exchanges());
+}
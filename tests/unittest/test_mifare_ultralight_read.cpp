@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/myexception.hpp>
+#include <logicalaccess/services/nfctag/ndefmessage.hpp>
+#include <logicalaccess/services/storage/storagecardservice.hpp>
+#include <pluginscards/mifareultralight/mifareultralightchip.hpp>
+#include <pluginscards/mifareultralight/mifareultralightcommands.hpp>
+#include <pluginscards/mifareultralight/mifareultralightlocation.hpp>
+#include <pluginscards/mifareultralight/nfctag2cardservice.hpp>
+
+using namespace logicalaccess;
+
+/**
+ * A Mifare Ultralight / NTAG card in memory, counting the RF exchanges.
+ * READ returns 4 pages and wraps around, as the chip does.
+ */
+class MemoryUltralightCommands : public MifareUltralightCommands
+{
+  public:
+    MemoryUltralightCommands(int nbPages, int fastReadMaxPages)
+        : memory(nbPages * 4)
+        , maxPages(fastReadMaxPages)
+        , reads(0)
+        , fastReads(0)
+        , writes(0)
+    {
+        for (size_t i = 0; i < memory.size(); ++i)
+            memory[i] = static_cast<unsigned char>(i);
+    }
+
+    std::vector<unsigned char> readPage(int page) override
+    {
+        ++reads;
+        size_t nbPages = memory.size() / 4;
+        if (static_cast<size_t>(page) >= nbPages)
+            throw CardException("NAK");
+        std::vector<unsigned char> ret;
+        for (size_t i = 0; i < 4; ++i)
+        {
+            size_t offset = ((page + i) % nbPages) * 4;
+            ret.insert(ret.end(), memory.begin() + offset, memory.begin() + offset + 4);
+        }
+        return ret;
+    }
+
+    void writePage(int page, const std::vector<unsigned char> &buf) override
+    {
+        ++writes;
+        EXPECT_EQ(4u, buf.size());
+        std::copy(buf.begin(), buf.begin() + 4, memory.begin() + page * 4);
+    }
+
+    std::vector<unsigned char> fastRead(int start_page, int stop_page) override
+    {
+        ++fastReads;
+        EXPECT_LT(stop_page - start_page, maxPages);
+        if (static_cast<size_t>(stop_page) >= memory.size() / 4)
+            throw CardException("NAK");
+        return std::vector<unsigned char>(memory.begin() + start_page * 4, memory.begin() + (stop_page + 1) * 4);
+    }
+
+    int getFastReadMaxPages() const override
+    {
+        return maxPages;
+    }
+
+    int exchanges() const
+    {
+        return reads + fastReads + writes;
+    }
+
+    std::vector<unsigned char> memory;
+    int maxPages;
+    int reads;
+    int fastReads;
+    int writes;
+};
+
+static std::shared_ptr<MemoryUltralightCommands> insertCard(std::shared_ptr<MifareUltralightChip> chip, int nbPages,
+                                                            int fastReadMaxPages)
+{
+    auto commands = std::make_shared<MemoryUltralightCommands>(nbPages, fastReadMaxPages);
+    commands->setChip(chip);
+    chip->setCommands(commands);
+    return commands;
+}
+
+static std::vector<unsigned char> pages(const std::vector<unsigned char> &memory, int start_page, int stop_page)
+{
+    return std::vector<unsigned char>(memory.begin() + start_page * 4, memory.begin() + (stop_page + 1) * 4);
+}
+
+TEST(test_mifare_ultralight_read, native_read)
+{
+    auto chip     = std::make_shared<MifareUltralightChip>();
+    auto commands = insertCard(chip, 16, 0);
+
+    ASSERT_EQ(pages(commands->memory, 0, 15), commands->readPages(0, 15));
+    ASSERT_EQ(4, commands->reads);
+
+    // The pages returned past the stop page, and the wrap around, are dropped.
+    commands->reads = 0;
+    ASSERT_EQ(pages(commands->memory, 13, 15), commands->readPages(13, 15));
+    ASSERT_EQ(1, commands->reads);
+    ASSERT_EQ(pages(commands->memory, 5, 5), commands->readPages(5, 5));
+
+    ASSERT_THROW(commands->readPages(3, 2), std::invalid_argument);
+}
+
+TEST(test_mifare_ultralight_read, fast_read_ntag216)
+{
+    auto chip     = std::make_shared<MifareUltralightChip>();
+    auto commands = insertCard(chip, 231, 60);
+
+    // Not used until the chip is known to be a NTAG21x.
+    ASSERT_FALSE(chip->hasFastRead());
+    commands->readPages(0, 230);
+    ASSERT_EQ(58, commands->reads);
+    ASSERT_EQ(0, commands->fastReads);
+
+    ASSERT_EQ(222, chip->getNbBlocks(true));
+    ASSERT_TRUE(chip->hasFastRead());
+    commands->reads = 0;
+    ASSERT_EQ(commands->memory, commands->readPages(0, 230));
+    ASSERT_EQ(0, commands->reads);
+    ASSERT_EQ(4, commands->fastReads);
+
+    // A single page keeps the native READ.
+    ASSERT_EQ(pages(commands->memory, 7, 7), commands->readPages(7, 7));
+    ASSERT_EQ(1, commands->reads);
+}
+
+TEST(test_mifare_ultralight_read, fast_read_unsupported_by_reader)
+{
+    auto chip     = std::make_shared<MifareUltralightChip>();
+    auto commands = insertCard(chip, 231, 0);
+    chip->getNbBlocks(true);
+    commands->reads = 0;
+
+    ASSERT_EQ(commands->memory, commands->readPages(0, 230));
+    ASSERT_EQ(58, commands->reads);
+    ASSERT_EQ(0, commands->fastReads);
+}
+
+TEST(test_mifare_ultralight_read, write_pages)
+{
+    auto chip     = std::make_shared<MifareUltralightChip>();
+    auto commands = insertCard(chip, 16, 0);
+
+    std::vector<unsigned char> data(12, 0xAB);
+    commands->writePages(4, 6, data);
+    ASSERT_EQ(3, commands->writes);
+    ASSERT_EQ(data, pages(commands->memory, 4, 6));
+
+    ASSERT_THROW(commands->writePages(4, 7, data), std::invalid_argument);
+    ASSERT_EQ(3, commands->writes);
+}
+
+TEST(test_mifare_ultralight_read, storage_read_data)
+{
+    auto chip     = std::make_shared<MifareUltralightChip>();
+    auto commands = insertCard(chip, 231, 60);
+    chip->getNbBlocks(true);
+    auto storage = std::dynamic_pointer_cast<StorageCardService>(chip->getService(CST_STORAGE));
+
+    auto location  = std::make_shared<MifareUltralightLocation>();
+    location->page = 4;
+    location->byte = 2;
+
+    int before = commands->exchanges();
+    auto data  = storage->readData(location, std::shared_ptr<AccessInfo>(), 800, CB_AUTOSWITCHAREA);
+    ASSERT_EQ(std::vector<unsigned char>(commands->memory.begin() + 18, commands->memory.begin() + 818), data);
+    ASSERT_EQ(before + 4, commands->exchanges());
+
+    // Without CB_AUTOSWITCHAREA, a single READ.
+    data = storage->readData(location, std::shared_ptr<AccessInfo>(), 10, CB_DEFAULT);
+    ASSERT_EQ(std::vector<unsigned char>(commands->memory.begin() + 18, commands->memory.begin() + 28), data);
+    ASSERT_THROW(storage->readData(location, std::shared_ptr<AccessInfo>(), 20, CB_DEFAULT), std::invalid_argument);
+}
+
+TEST(test_mifare_ultralight_read, ndef_ntag216)
+{
+    auto chip     = std::make_shared<MifareUltralightChip>();
+    auto commands = insertCard(chip, 231, 60);
+    chip->getNbBlocks(true);
+    auto nfc = std::dynamic_pointer_cast<NFCTag2CardService>(chip->getService(CST_NFC_TAG));
+
+    auto message = std::make_shared<NdefMessage>();
+    message->addTextRecord(std::string(200, 'x'));
+    nfc->writeNDEF(message);
+
+    // The capability container READ also returns the first 3 data pages,
+    // then FAST_READ covers the 868 bytes of the data area.
+    int before = commands->exchanges();
+    auto read  = nfc->readNDEF();
+    ASSERT_TRUE(read);
+    ASSERT_EQ(1u, read->getRecordCount());
+    ASSERT_EQ(NdefMessage::NdefMessageToTLV(message), NdefMessage::NdefMessageToTLV(read));
+    ASSERT_EQ(before + 5, commands->exchanges());
+}
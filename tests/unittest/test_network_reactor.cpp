@@ -0,0 +1,306 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/readerproviders/tcpdatatransport.hpp>
+#include <logicalaccess/readerproviders/udpdatatransport.hpp>
+#include <logicalaccess/myexception.hpp>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+using namespace logicalaccess;
+
+/**
+ * A TCP server answering each packet with its bytes incremented, after a fixed latency.
+ */
+class DelayedTcpServer
+{
+  public:
+    explicit DelayedTcpServer(unsigned int latency)
+        : acceptor_(ios_, boost::asio::ip::tcp::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), 0))
+        , latency_(latency)
+    {
+        accept();
+        thread_ = std::thread([this]() { ios_.run(); });
+    }
+
+    ~DelayedTcpServer()
+    {
+        ios_.stop();
+        thread_.join();
+    }
+
+    int getPort() const
+    {
+        return acceptor_.local_endpoint().port();
+    }
+
+  private:
+    void accept()
+    {
+        std::shared_ptr<boost::asio::ip::tcp::socket> socket(new boost::asio::ip::tcp::socket(ios_));
+        acceptor_.async_accept(*socket, [this, socket](const boost::system::error_code &error) {
+            if (!error)
+                read(socket);
+            accept();
+        });
+    }
+
+    void read(std::shared_ptr<boost::asio::ip::tcp::socket> socket)
+    {
+        std::shared_ptr<std::vector<unsigned char>> buffer(new std::vector<unsigned char>(256));
+        socket->async_receive(boost::asio::buffer(*buffer), [this, socket, buffer](const boost::system::error_code &error, size_t length) {
+            if (error)
+                return;
+            buffer->resize(length);
+            for (auto &b : *buffer)
+                ++b;
+            std::shared_ptr<boost::asio::deadline_timer> timer(new boost::asio::deadline_timer(ios_));
+            timer->expires_from_now(boost::posix_time::milliseconds(latency_));
+            timer->async_wait([this, socket, buffer, timer](const boost::system::error_code &) {
+                boost::system::error_code ignored;
+                socket->send(boost::asio::buffer(*buffer), 0, ignored);
+                read(socket);
+            });
+        });
+    }
+
+    boost::asio::io_service ios_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    unsigned int latency_;
+    std::thread thread_;
+};
+
+/**
+ * A transport whose answer blocks until released, as a slow serial or PC/SC reader.
+ */
+class BlockingTransport : public DataTransport
+{
+  public:
+    explicit BlockingTransport(std::shared_future<void> release)
+        : release(release)
+    {
+    }
+
+    std::string getTransportType() const override
+    {
+        return "Blocking";
+    }
+    bool connect() override
+    {
+        return true;
+    }
+    void disconnect() override
+    {
+    }
+    bool isConnected() override
+    {
+        return true;
+    }
+    std::string getName() const override
+    {
+        return "Blocking";
+    }
+    void serialize(boost::property_tree::ptree &) override
+    {
+    }
+    void unSerialize(boost::property_tree::ptree &) override
+    {
+    }
+    std::string getDefaultXmlNodeName() const override
+    {
+        return "BlockingTransport";
+    }
+
+  protected:
+    void send(const std::vector<unsigned char> &) override
+    {
+    }
+    std::vector<unsigned char> receive(long int) override
+    {
+        release.wait();
+        return {0x90, 0x00};
+    }
+
+    std::shared_future<void> release;
+};
+
+TEST(test_network_reactor, blocking_and_async_commands)
+{
+    DelayedTcpServer server(0);
+    TcpDataTransport transport;
+    transport.setPort(server.getPort());
+
+    ASSERT_EQ(std::vector<unsigned char>({0x02, 0x03}), transport.sendCommand({0x01, 0x02}, 1000));
+
+    std::promise<std::vector<unsigned char>> result;
+    transport.asyncSendCommand({0x10}, 1000, [&result](const std::vector<unsigned char> &res, std::exception_ptr error) {
+        if (error)
+            result.set_exception(error);
+        else
+            result.set_value(res);
+    });
+    ASSERT_EQ(std::vector<unsigned char>({0x11}), result.get_future().get());
+    ASSERT_EQ(std::vector<unsigned char>({0x11}), transport.getLastResult());
+
+    // Nothing is sent, the receive times out.
+    ASSERT_THROW(transport.sendCommand({}, 50), LibLogicalAccessException);
+}
+
+TEST(test_network_reactor, connection_failure)
+{
+    TcpDataTransport transport;
+    transport.setPort(1);
+
+    std::promise<bool> failed;
+    transport.asyncSendCommand({0x01}, 500, [&failed](const std::vector<unsigned char> &, std::exception_ptr error) {
+        failed.set_value(bool(error));
+    });
+    ASSERT_TRUE(failed.get_future().get());
+    ASSERT_FALSE(transport.isConnected());
+}
+
+TEST(test_network_reactor, blocking_transports_keep_the_reactor_free)
+{
+    DelayedTcpServer server(0);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+
+    // More blocked readers than reactor threads. The transports are only kept by their pending command.
+    const unsigned int slowCount = NetworkReactor::getInstance().getThreadCount() + 2;
+    std::atomic<unsigned int> answered(0);
+    for (unsigned int i = 0; i < slowCount; ++i)
+    {
+        std::make_shared<BlockingTransport>(released)->asyncSendCommand({0x01}, 1000, [&answered](const std::vector<unsigned char> &res, std::exception_ptr error) {
+            if (!error && res.size() == 2)
+                ++answered;
+        });
+    }
+
+    TcpDataTransport transport;
+    transport.setPort(server.getPort());
+    std::promise<std::vector<unsigned char>> result;
+    transport.asyncSendCommand({0x20}, 1000, [&result](const std::vector<unsigned char> &res, std::exception_ptr error) {
+        if (error)
+            result.set_exception(error);
+        else
+            result.set_value(res);
+    });
+    std::future<std::vector<unsigned char>> tcp = result.get_future();
+    ASSERT_EQ(std::future_status::ready, tcp.wait_for(std::chrono::seconds(10)));
+    ASSERT_EQ(std::vector<unsigned char>({0x21}), tcp.get());
+    ASSERT_EQ(0u, answered);
+
+    release.set_value();
+    for (int i = 0; i < 1000 && answered < slowCount; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_EQ(slowCount, answered);
+}
+
+TEST(test_network_reactor, chained_blocking_commands)
+{
+    std::promise<void> release;
+    release.set_value();
+    std::shared_ptr<BlockingTransport> transport = std::make_shared<BlockingTransport>(release.get_future().share());
+
+    // The next command is sent from the callback, on the thread of the previous one.
+    std::promise<std::vector<unsigned char>> result;
+    transport->asyncSendCommand({0x01}, 1000, [&result, transport](const std::vector<unsigned char> &, std::exception_ptr) {
+        transport->asyncSendCommand({0x02}, 1000, [&result](const std::vector<unsigned char> &res, std::exception_ptr error) {
+            if (error)
+                result.set_exception(error);
+            else
+                result.set_value(res);
+        });
+    });
+    std::future<std::vector<unsigned char>> second = result.get_future();
+    ASSERT_EQ(std::future_status::ready, second.wait_for(std::chrono::seconds(10)));
+    ASSERT_EQ(std::vector<unsigned char>({0x90, 0x00}), second.get());
+    ASSERT_EQ(std::vector<unsigned char>({0x02}), transport->getLastCommand());
+}
+
+TEST(test_network_reactor, udp_commands)
+{
+    boost::asio::io_service ios;
+    boost::asio::ip::udp::socket server(ios, boost::asio::ip::udp::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), 0));
+    std::thread echo([&server]() {
+        unsigned char buffer[128];
+        boost::asio::ip::udp::endpoint sender;
+        size_t length = server.receive_from(boost::asio::buffer(buffer), sender);
+        server.send_to(boost::asio::buffer(buffer, length), sender);
+    });
+
+    UdpDataTransport transport;
+    transport.setPort(server.local_endpoint().port());
+
+    std::promise<std::vector<unsigned char>> result;
+    transport.asyncSendCommand({0x01, 0x02, 0x03}, 1000, [&result](const std::vector<unsigned char> &res, std::exception_ptr) {
+        result.set_value(res);
+    });
+    ASSERT_EQ(std::vector<unsigned char>({0x01, 0x02, 0x03}), result.get_future().get());
+    echo.join();
+
+    // No answer, the UDP receive returns nothing on timeout.
+    ASSERT_TRUE(transport.sendCommand({0x04}, 50).empty());
+}
+
+/**
+ * Connect readers to the server, each one chaining its commands from the completion callback.
+ * \return The number of failed or wrong answers.
+ */
+static unsigned int run_readers(const DelayedTcpServer &server, unsigned int readerCount, unsigned int commands)
+{
+    std::vector<std::shared_ptr<TcpDataTransport>> transports;
+    for (unsigned int i = 0; i < readerCount; ++i)
+    {
+        transports.push_back(std::make_shared<TcpDataTransport>());
+        transports.back()->setPort(server.getPort());
+        if (!transports.back()->connect(1000))
+            throw std::runtime_error("Cannot connect.");
+    }
+
+    std::atomic<unsigned int> completed(0), errors(0);
+    std::promise<void> done;
+    std::function<void(std::shared_ptr<TcpDataTransport>, unsigned int)> run =
+        [&](std::shared_ptr<TcpDataTransport> transport, unsigned int remaining) {
+            transport->asyncSendCommand({0x01}, 2000, [&, transport, remaining](const std::vector<unsigned char> &res, std::exception_ptr error) {
+                if (error || res != std::vector<unsigned char>({0x02}))
+                    ++errors;
+                if (remaining > 1)
+                    run(transport, remaining - 1);
+                else if (++completed == readerCount)
+                    done.set_value();
+            });
+        };
+
+    for (auto &transport : transports)
+        run(transport, commands);
+    if (done.get_future().wait_for(std::chrono::seconds(30)) != std::future_status::ready)
+        throw std::runtime_error("The readers commands did not complete.");
+    return errors;
+}
+
+TEST(test_network_reactor, many_readers)
+{
+    // Far more readers than reactor threads, all of them served.
+    const unsigned int readerCount = 50;
+    DelayedTcpServer server(1);
+    ASSERT_LT(NetworkReactor::getInstance().getThreadCount(), readerCount);
+    ASSERT_EQ(0u, run_readers(server, readerCount, 5));
+}
+
+#ifdef LLA_BENCHMARK
+TEST(benchmark_network_reactor, many_readers)
+{
+    const unsigned int readerCount = 200;
+    const unsigned int commands    = 5;
+    DelayedTcpServer server(20);
+
+    auto start = std::chrono::steady_clock::now();
+    unsigned int errors = run_readers(server, readerCount, commands);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Blocking transports would need 200 * 5 * 20 ms.
+    std::cout << readerCount << " readers on " << NetworkReactor::getInstance().getThreadCount() << " reactor threads: "
+              << static_cast<long>(readerCount * commands / seconds) << " commands/s, " << errors << " errors" << std::endl;
+}
+#endif
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/utils.hpp>
+#include <logicalaccess/myexception.hpp>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+using namespace logicalaccess;
+
+TEST(test_parallel_for, ranges_cover_the_batch)
+{
+    const size_t count = 1000;
+    std::vector<int> seen(count, 0);
+    std::mutex mutex;
+    std::vector<std::pair<size_t, size_t>> ranges;
+    parallelFor(count, 4, 100, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            ++seen[i];
+        std::lock_guard<std::mutex> lock(mutex);
+        ranges.push_back(std::make_pair(begin, end));
+    });
+
+    ASSERT_EQ(std::vector<int>(count, 1), seen);
+    ASSERT_EQ(4u, ranges.size());
+    for (const auto &range : ranges)
+        ASSERT_EQ(250u, range.second - range.first);
+}
+
+TEST(test_parallel_for, small_batches_run_inline)
+{
+    std::thread::id caller = std::this_thread::get_id();
+    unsigned int calls = 0;
+    // Two ranges of 100 items don't fit in 150.
+    parallelFor(150, 2, 100, [&](size_t begin, size_t end) {
+        ASSERT_EQ(caller, std::this_thread::get_id());
+        ASSERT_EQ(0u, begin);
+        ASSERT_EQ(150u, end);
+        ++calls;
+    });
+    ASSERT_EQ(1u, calls);
+
+    parallelFor(0, 4, 1, [&](size_t, size_t) { ++calls; });
+    ASSERT_EQ(1u, calls);
+}
+
+TEST(test_parallel_for, minimum_range)
+{
+    std::mutex mutex;
+    std::vector<size_t> sizes;
+    size_t covered = 0;
+    parallelFor(10, 8, 2, [&](size_t begin, size_t end) {
+        std::lock_guard<std::mutex> lock(mutex);
+        sizes.push_back(end - begin);
+        covered += end - begin;
+    });
+
+    ASSERT_EQ(10u, covered);
+    ASSERT_EQ(5u, sizes.size());
+    for (size_t size : sizes)
+        ASSERT_LE(2u, size);
+
+    sizes.clear();
+    covered = 0;
+    parallelFor(11, 3, 3, [&](size_t begin, size_t end) {
+        std::lock_guard<std::mutex> lock(mutex);
+        sizes.push_back(end - begin);
+        covered += end - begin;
+    });
+    ASSERT_EQ(11u, covered);
+    ASSERT_EQ(3u, sizes.size());
+    for (size_t size : sizes)
+        ASSERT_LE(3u, size);
+}
+
+TEST(test_parallel_for, errors_after_all_ranges)
+{
+    std::atomic<unsigned int> done(0);
+    ASSERT_THROW(parallelFor(8, 8, 1,
+                             [&](size_t begin, size_t) {
+                                 if (begin == 0)
+                                     throw LibLogicalAccessException("First range failed.");
+                                 ++done;
+                             }),
+                 LibLogicalAccessException);
+    ASSERT_EQ(7u, done);
+}
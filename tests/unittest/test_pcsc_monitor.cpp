@@ -0,0 +1,365 @@
+#include <gtest/gtest.h>
+#include "pluginsreaderproviders/pcsc/pcscmonitor.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <thread>
+
+using namespace logicalaccess;
+
+/**
+ * A monitor over a scripted PC/SC service, answering SCardGetStatusChange from the readers set by the test.
+ */
+class ScriptedPCSCMonitor : public PCSCMonitor
+{
+  public:
+    ScriptedPCSCMonitor()
+        : pnpEvents_(0)
+        , error_(SCARD_S_SUCCESS)
+        , cancelled_(false)
+        , hold_(false)
+        , held_(false)
+        , contexts_(0)
+        , cancels_(0)
+    {
+    }
+
+    ~ScriptedPCSCMonitor()
+    {
+        stop();
+    }
+
+    void addReader(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        readers_.push_back(Reader({name, SCARD_STATE_EMPTY, {}}));
+        ++pnpEvents_;
+        cond_.notify_all();
+    }
+
+    void removeReader(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        readers_.erase(std::remove_if(readers_.begin(), readers_.end(), [&name](const Reader &reader) { return reader.name == name; }),
+                       readers_.end());
+        ++pnpEvents_;
+        cond_.notify_all();
+    }
+
+    /**
+     * Insert a card, or swap it if one is present. The event counter is kept in the upper bits, as PC/SC lite does.
+     */
+    void insertCard(const std::string &name, const std::vector<uint8_t> &atr)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Reader &reader = find(name);
+        reader.state   = ((reader.state & 0xFFFF0000) + 0x10000) | SCARD_STATE_PRESENT;
+        reader.atr     = atr;
+        cond_.notify_all();
+    }
+
+    void removeCard(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Reader &reader = find(name);
+        reader.state   = ((reader.state & 0xFFFF0000) + 0x10000) | SCARD_STATE_EMPTY;
+        reader.atr.clear();
+        cond_.notify_all();
+    }
+
+    /**
+     * Fail the next SCardGetStatusChange call.
+     */
+    void failNext(LONG error)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_ = error;
+        cond_.notify_all();
+    }
+
+    /**
+     * Hold the next SCardGetStatusChange call before it starts, until releaseCall().
+     * A cancel sent meanwhile is lost, as with PC/SC.
+     */
+    void holdNextCall()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        hold_ = true;
+    }
+
+    void waitHeld()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this]() { return held_; });
+    }
+
+    void releaseCall()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        hold_ = false;
+        cond_.notify_all();
+    }
+
+    unsigned int getContextCount()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return contexts_;
+    }
+
+    unsigned int getCancelCount()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return cancels_;
+    }
+
+  protected:
+    struct Reader
+    {
+        std::string name;
+        DWORD state;
+        std::vector<uint8_t> atr;
+    };
+
+    Reader &find(const std::string &name)
+    {
+        for (auto &reader : readers_)
+        {
+            if (reader.name == name)
+                return reader;
+        }
+        throw std::invalid_argument("Unknown reader " + name);
+    }
+
+    LONG scardEstablishContext(SCARDCONTEXT *scc) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled_ = false;
+        *scc       = ++contexts_;
+        return SCARD_S_SUCCESS;
+    }
+
+    LONG scardReleaseContext(SCARDCONTEXT) override
+    {
+        return SCARD_S_SUCCESS;
+    }
+
+    LONG scardCancel(SCARDCONTEXT) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled_ = true;
+        ++cancels_;
+        cond_.notify_all();
+        return SCARD_S_SUCCESS;
+    }
+
+    LONG scardListReaders(SCARDCONTEXT, char *readers, DWORD *readersLength) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string list;
+        for (const auto &reader : readers_)
+            list += reader.name + '\0';
+        list += '\0';
+        if (readers != nullptr)
+        {
+            if (*readersLength < list.size())
+                return SCARD_E_INSUFFICIENT_BUFFER;
+            memcpy(readers, list.data(), list.size());
+        }
+        *readersLength = static_cast<DWORD>(list.size());
+        return SCARD_S_SUCCESS;
+    }
+
+    LONG scardGetStatusChange(SCARDCONTEXT, DWORD timeout, SCARD_READERSTATE *states, DWORD count) override
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (hold_ && timeout != 0)
+        {
+            held_ = true;
+            cond_.notify_all();
+            cond_.wait(lock, [this]() { return !hold_; });
+            held_      = false;
+            cancelled_ = false;
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+        while (true)
+        {
+            if (error_ != SCARD_S_SUCCESS)
+            {
+                LONG error = error_;
+                error_     = SCARD_S_SUCCESS;
+                return error;
+            }
+            if (cancelled_)
+                return SCARD_E_CANCELLED;
+
+            bool changed = false;
+            for (DWORD i = 0; i < count; ++i)
+                changed = update(states[i]) || changed;
+            if (changed)
+                return SCARD_S_SUCCESS;
+            if (timeout == 0)
+                return SCARD_E_TIMEOUT;
+
+            if (timeout == INFINITE)
+                cond_.wait(lock);
+            else if (cond_.wait_until(lock, deadline) == std::cv_status::timeout)
+                return SCARD_E_TIMEOUT;
+        }
+    }
+
+    /**
+     * Set the event state of a reader, the changed flag being set if it differs from its current state.
+     */
+    bool update(SCARD_READERSTATE &state)
+    {
+        DWORD eventState = SCARD_STATE_UNKNOWN | SCARD_STATE_IGNORE;
+        state.cbAtr      = 0;
+        if (strcmp(state.szReader, "\\\\?PnP?\\Notification") == 0)
+        {
+            eventState = pnpEvents_ << 16;
+        }
+        else
+        {
+            for (const auto &reader : readers_)
+            {
+                if (reader.name == state.szReader)
+                {
+                    eventState  = reader.state;
+                    state.cbAtr = static_cast<DWORD>(reader.atr.size());
+                    std::copy(reader.atr.begin(), reader.atr.end(), state.rgbAtr);
+                }
+            }
+        }
+
+        bool changed = (state.dwCurrentState & ~SCARD_STATE_CHANGED) != eventState;
+        state.dwEventState = changed ? (eventState | SCARD_STATE_CHANGED) : eventState;
+        return changed;
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::vector<Reader> readers_;
+    DWORD pnpEvents_;
+    LONG error_;
+    bool cancelled_;
+    bool hold_;
+    bool held_;
+    unsigned int contexts_;
+    unsigned int cancels_;
+};
+
+static PCSCMonitorEvent next(PCSCMonitorQueue &queue)
+{
+    PCSCMonitorEvent event;
+    if (!queue.pop(event, 10000))
+        throw std::runtime_error("No monitor event.");
+    return event;
+}
+
+static void expect(PCSCMonitorQueue &queue, PCSCMonitorEvent::EventType type, const std::string &readerName)
+{
+    PCSCMonitorEvent event = next(queue);
+    ASSERT_EQ(type, event.type);
+    ASSERT_EQ(readerName, event.readerName);
+}
+
+TEST(test_pcsc_monitor, readers_and_cards)
+{
+    std::shared_ptr<ScriptedPCSCMonitor> monitor(new ScriptedPCSCMonitor());
+    monitor->addReader("Reader 0");
+    PCSCMonitorQueue queue(monitor);
+    monitor->start();
+    ASSERT_TRUE(monitor->hasPnPNotification());
+    expect(queue, PCSCMonitorEvent::PME_READER_ADDED, "Reader 0");
+
+    monitor->insertCard("Reader 0", {0x3B, 0x8F, 0x80});
+    PCSCMonitorEvent event = next(queue);
+    ASSERT_EQ(PCSCMonitorEvent::PME_CARD_INSERTED, event.type);
+    ASSERT_EQ(std::vector<uint8_t>({0x3B, 0x8F, 0x80}), event.atr);
+    std::vector<PCSCMonitorReaderState> states = monitor->getReaderStates();
+    ASSERT_EQ(1u, states.size());
+    ASSERT_TRUE(states[0].cardPresent);
+    ASSERT_EQ(std::vector<uint8_t>({0x3B, 0x8F, 0x80}), states[0].atr);
+
+    monitor->removeCard("Reader 0");
+    expect(queue, PCSCMonitorEvent::PME_CARD_REMOVED, "Reader 0");
+    ASSERT_FALSE(monitor->getReaderStates()[0].cardPresent);
+
+    // Hotplug, notified through the PnP pseudo reader.
+    monitor->addReader("Reader 1");
+    expect(queue, PCSCMonitorEvent::PME_READER_ADDED, "Reader 1");
+    monitor->insertCard("Reader 1", {0x3B, 0x00});
+    expect(queue, PCSCMonitorEvent::PME_CARD_INSERTED, "Reader 1");
+    monitor->removeReader("Reader 1");
+    expect(queue, PCSCMonitorEvent::PME_CARD_REMOVED, "Reader 1");
+    expect(queue, PCSCMonitorEvent::PME_READER_REMOVED, "Reader 1");
+    ASSERT_EQ(1u, monitor->getReaderStates().size());
+
+    // The blocking call is cancelled on stop.
+    monitor->stop();
+    ASSERT_FALSE(monitor->isRunning());
+    ASSERT_EQ(1u, monitor->getCancelCount());
+    ASSERT_EQ(1u, monitor->getContextCount());
+    PCSCMonitorEvent none;
+    ASSERT_FALSE(queue.pop(none, 1));
+}
+
+TEST(test_pcsc_monitor, card_swap)
+{
+    std::shared_ptr<ScriptedPCSCMonitor> monitor(new ScriptedPCSCMonitor());
+    monitor->addReader("Reader 0");
+    monitor->insertCard("Reader 0", {0x01});
+    PCSCMonitorQueue queue(monitor);
+    monitor->start();
+    expect(queue, PCSCMonitorEvent::PME_READER_ADDED, "Reader 0");
+    expect(queue, PCSCMonitorEvent::PME_CARD_INSERTED, "Reader 0");
+
+    // A new card before the next status change: the present bit stays set.
+    monitor->insertCard("Reader 0", {0x02});
+    expect(queue, PCSCMonitorEvent::PME_CARD_REMOVED, "Reader 0");
+    PCSCMonitorEvent event = next(queue);
+    ASSERT_EQ(PCSCMonitorEvent::PME_CARD_INSERTED, event.type);
+    ASSERT_EQ(std::vector<uint8_t>({0x02}), event.atr);
+}
+
+TEST(test_pcsc_monitor, cancel_before_call)
+{
+    std::shared_ptr<ScriptedPCSCMonitor> monitor(new ScriptedPCSCMonitor());
+    monitor->addReader("Reader 0");
+    PCSCMonitorQueue queue(monitor);
+    monitor->start();
+    expect(queue, PCSCMonitorEvent::PME_READER_ADDED, "Reader 0");
+
+    // The monitor thread is about to wait when stop() cancels: nothing changes, but the wait is bounded.
+    monitor->holdNextCall();
+    monitor->waitHeld();
+    std::future<void> stopped = std::async(std::launch::async, [monitor]() { monitor->stop(); });
+    while (monitor->getCancelCount() == 0)
+        std::this_thread::yield();
+    monitor->releaseCall();
+    ASSERT_EQ(std::future_status::ready, stopped.wait_for(std::chrono::seconds(10)));
+    ASSERT_FALSE(monitor->isRunning());
+}
+
+TEST(test_pcsc_monitor, error_restarts_context)
+{
+    std::shared_ptr<ScriptedPCSCMonitor> monitor(new ScriptedPCSCMonitor());
+    monitor->addReader("Reader 0");
+    PCSCMonitorQueue queue(monitor);
+    monitor->start();
+    expect(queue, PCSCMonitorEvent::PME_READER_ADDED, "Reader 0");
+
+    monitor->failNext(SCARD_F_COMM_ERROR);
+    PCSCMonitorEvent event = next(queue);
+    ASSERT_EQ(PCSCMonitorEvent::PME_ERROR, event.type);
+    ASSERT_EQ(static_cast<unsigned int>(SCARD_F_COMM_ERROR), event.error);
+
+    // The readers are kept on the new context, only the card is reported.
+    monitor->insertCard("Reader 0", {0x3B});
+    expect(queue, PCSCMonitorEvent::PME_CARD_INSERTED, "Reader 0");
+    ASSERT_EQ(2u, monitor->getContextCount());
+}
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/dynlibrary/librarymanager.hpp>
+#include <logicalaccess/settings.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/xml_parser.hpp>
+#include <algorithm>
+#include <dlfcn.h>
+#include <fstream>
+
+using namespace logicalaccess;
+namespace fs = boost::filesystem;
+
+/**
+ * A plug-ins folder with its index file, used as the only plug-ins folder.
+ */
+class PluginFolder
+{
+  public:
+    PluginFolder()
+        : dir_(fs::temp_directory_path() / fs::unique_path("lla-plugins-%%%%-%%%%"))
+    {
+        fs::create_directories(dir_);
+        Settings *settings      = Settings::getInstance();
+        settings->PluginFolders = {dir_.string()};
+        settings->PluginIndexFile = getIndexFile();
+        settings->PluginWarmUp  = false;
+    }
+
+    ~PluginFolder()
+    {
+        boost::system::error_code ignored;
+        fs::remove_all(dir_, ignored);
+    }
+
+    /**
+     * Copy the test plug-in in the folder. Each copy is a distinct library for the loader.
+     */
+    std::string addPlugin(const std::string &name)
+    {
+        fs::path path = dir_ / name;
+        fs::copy_file(INDEX_TEST_PLUGIN, path);
+        return path.string();
+    }
+
+    /**
+     * Write the index of a plug-in, as a previous scan would have.
+     */
+    void writeIndex(const std::string &name)
+    {
+        fs::path path = dir_ / name;
+        std::ofstream index(getIndexFile().c_str());
+        index << "<pluginindex><version>1</version><library>"
+              << "<name>" << name << "</name>"
+              << "<path>" << path.string() << "</path>"
+              << "<size>" << fs::file_size(path) << "</size>"
+              << "<mtime>" << static_cast<long long>(fs::last_write_time(path)) << "</mtime>"
+              << "<loadable>true</loadable><chip>IndexTest</chip><symbol>getIndexTestChip</symbol>"
+              << "</library></pluginindex>";
+    }
+
+    std::string getIndexFile() const
+    {
+        return (dir_ / "plugins.index").string();
+    }
+
+    boost::property_tree::ptree readIndex() const
+    {
+        boost::property_tree::ptree pt;
+        boost::property_tree::read_xml(getIndexFile(), pt);
+        return pt;
+    }
+
+    std::vector<std::string> getIndexedLibraries() const
+    {
+        std::vector<std::string> libraries;
+        boost::property_tree::ptree pt = readIndex();
+        for (auto &v : pt.get_child("pluginindex"))
+        {
+            if (v.first == "library")
+                libraries.push_back(v.second.get<std::string>("name"));
+        }
+        return libraries;
+    }
+
+  private:
+    fs::path dir_;
+};
+
+static bool isLoaded(const std::string &path)
+{
+    void *handle = dlopen(path.c_str(), RTLD_LAZY | RTLD_NOLOAD);
+    if (handle != NULL)
+        dlclose(handle);
+    return handle != NULL;
+}
+
+TEST(test_plugin_index, build)
+{
+    PluginFolder folder;
+    std::string path = folder.addPlugin("libindexbuildcards.so");
+
+    // No index yet, every plug-in is loaded and indexed.
+    LibraryManager::getInstance()->scanPlugins();
+    ASSERT_TRUE(isLoaded(path));
+
+    boost::property_tree::ptree pt = folder.readIndex();
+    ASSERT_EQ(1, pt.get<int>("pluginindex.version"));
+    ASSERT_EQ(std::vector<std::string>({"libindexbuildcards.so"}), folder.getIndexedLibraries());
+    boost::property_tree::ptree library = pt.get_child("pluginindex.library");
+    ASSERT_EQ(path, library.get<std::string>("path"));
+    ASSERT_EQ(fs::file_size(path), library.get<uintmax_t>("size"));
+    ASSERT_EQ("IndexTest", library.get<std::string>("chip"));
+    ASSERT_EQ("getIndexTestChip", library.get<std::string>("symbol"));
+}
+
+TEST(test_plugin_index, hit)
+{
+    PluginFolder folder;
+    std::string path = folder.addPlugin("libindexhitcards.so");
+    folder.writeIndex("libindexhitcards.so");
+
+    // The index is up to date, the library is only loaded on first use.
+    LibraryManager::getInstance()->scanPlugins();
+    ASSERT_FALSE(isLoaded(path));
+    std::vector<std::string> cards = LibraryManager::getInstance()->getAvailableCards();
+    ASSERT_EQ(std::vector<std::string>({"IndexTest"}), cards);
+    ASSERT_FALSE(isLoaded(path));
+
+    getcard factory = LibraryManager::getInstance()->getCardFactory("IndexTest");
+    ASSERT_TRUE(factory != NULL);
+    ASSERT_TRUE(isLoaded(path));
+    void *handle = dlopen(path.c_str(), RTLD_LAZY | RTLD_NOLOAD);
+    ASSERT_EQ(dlsym(handle, "getIndexTestChip"), reinterpret_cast<void *>(factory));
+    dlclose(handle);
+
+    // An indexed symbol is served from the index, which is not written again.
+    fs::remove(folder.getIndexFile());
+    ASSERT_EQ(factory, LibraryManager::getInstance()->getCardFactory("IndexTest"));
+    ASSERT_FALSE(fs::exists(folder.getIndexFile()));
+}
+
+TEST(test_plugin_index, miss)
+{
+    PluginFolder folder;
+    folder.addPlugin("libindexmisscards.so");
+    folder.writeIndex("libindexmisscards.so");
+    LibraryManager::getInstance()->scanPlugins();
+
+    // The missing symbol is recorded in the index.
+    ASSERT_TRUE(LibraryManager::getInstance()->getCardFactory("Unknown") == NULL);
+    boost::property_tree::ptree pt = folder.readIndex();
+    ASSERT_EQ("getUnknownChip", pt.get<std::string>("pluginindex.missing"));
+    ASSERT_EQ("cards", pt.get<std::string>("pluginindex.missing.<xmlattr>.type"));
+
+    // Known as missing after a rescan, without rewriting the index.
+    LibraryManager::getInstance()->scanPlugins();
+    std::time_t written = fs::last_write_time(folder.getIndexFile()) - 100;
+    fs::last_write_time(folder.getIndexFile(), written);
+    ASSERT_TRUE(LibraryManager::getInstance()->getCardFactory("Unknown") == NULL);
+    ASSERT_EQ(written, fs::last_write_time(folder.getIndexFile()));
+}
+
+TEST(test_plugin_index, rescan)
+{
+    PluginFolder folder;
+    folder.addPlugin("libindexrescan1cards.so");
+    LibraryManager::getInstance()->scanPlugins();
+    ASSERT_EQ(std::vector<std::string>({"libindexrescan1cards.so"}), folder.getIndexedLibraries());
+
+    // Added and removed libraries invalidate the index.
+    std::string added = folder.addPlugin("libindexrescan2cards.so");
+    LibraryManager::getInstance()->scanPlugins();
+    ASSERT_TRUE(isLoaded(added));
+    ASSERT_EQ(std::vector<std::string>({"libindexrescan1cards.so", "libindexrescan2cards.so"}),
+              folder.getIndexedLibraries());
+
+    fs::remove(added);
+    LibraryManager::getInstance()->scanPlugins();
+    ASSERT_EQ(std::vector<std::string>({"libindexrescan1cards.so"}), folder.getIndexedLibraries());
+}
+
+TEST(test_plugin_index, warm_up)
+{
+    PluginFolder folder;
+    std::string path = folder.addPlugin("libindexwarmupcards.so");
+    folder.writeIndex("libindexwarmupcards.so");
+    LibraryManager::getInstance()->scanPlugins();
+    ASSERT_FALSE(isLoaded(path));
+
+    LibraryManager::getInstance()->warmUp(1);
+    LibraryManager::getInstance()->waitWarmUp();
+    ASSERT_TRUE(isLoaded(path));
+
+    // Stopping without running threads returns at once, the exit handler stops the others.
+    LibraryManager::getInstance()->stopWarmUp();
+    ASSERT_TRUE(LibraryManager::getInstance()->getCardFactory("IndexTest") != NULL);
+}
@@ -0,0 +1,364 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/readerproviders/readersessionengine.hpp>
+#include <logicalaccess/cards/chip.hpp>
+#include <logicalaccess/myexception.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace logicalaccess;
+
+/**
+ * A reader always having a new card in the field, each reader exchange taking a fixed time.
+ * Without a card, the polls wait for their whole timeout.
+ */
+class MockReaderUnit : public ReaderUnit
+{
+  public:
+    MockReaderUnit(const std::string &name, unsigned int latency)
+        : ReaderUnit("Mock")
+        , name_(name)
+        , latency_(latency)
+        , connected_(false)
+        , inUse_(0)
+        , overlap_(false)
+        , cardPresent_(true)
+    {
+    }
+
+    void setCardPresent(bool cardPresent)
+    {
+        cardPresent_ = cardPresent;
+    }
+
+    /**
+     * The threads the polls ran on.
+     */
+    std::set<std::thread::id> getPollThreads()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pollThreads_;
+    }
+
+    void exchange()
+    {
+        if (inUse_++ != 0)
+            overlap_ = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(latency_));
+        inUse_--;
+    }
+
+    bool hasOverlapped() const
+    {
+        return overlap_;
+    }
+
+    bool waitInsertion(unsigned int maxwait) override
+    {
+        return poll(maxwait);
+    }
+
+    bool waitRemoval(unsigned int maxwait) override
+    {
+        return poll(maxwait);
+    }
+
+    bool isConnected() override
+    {
+        return connected_;
+    }
+
+    void setCardType(std::string) override
+    {
+    }
+
+    std::shared_ptr<Chip> getSingleChip() override
+    {
+        return std::make_shared<Chip>("GenericTag");
+    }
+
+    std::vector<std::shared_ptr<Chip>> getChipList() override
+    {
+        return std::vector<std::shared_ptr<Chip>>(1, getSingleChip());
+    }
+
+    bool connect() override
+    {
+        connected_ = true;
+        return true;
+    }
+
+    void disconnect() override
+    {
+        connected_ = false;
+    }
+
+    bool connectToReader() override
+    {
+        return true;
+    }
+
+    void disconnectFromReader() override
+    {
+    }
+
+    std::string getName() const override
+    {
+        return name_;
+    }
+
+    std::string getReaderSerialNumber() override
+    {
+        return name_;
+    }
+
+  private:
+    bool poll(unsigned int maxwait)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pollThreads_.insert(std::this_thread::get_id());
+        }
+        if (!cardPresent_)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(maxwait));
+            return false;
+        }
+        exchange();
+        return true;
+    }
+
+    std::string name_;
+    unsigned int latency_;
+    bool connected_;
+    std::atomic<int> inUse_;
+    std::atomic<bool> overlap_;
+    std::atomic<bool> cardPresent_;
+    std::mutex mutex_;
+    std::set<std::thread::id> pollThreads_;
+};
+
+TEST(test_reader_session_engine, per_reader_ordering)
+{
+    ReaderSessionEngine engine(4);
+    std::vector<std::shared_ptr<MockReaderUnit>> readers;
+    for (int i = 0; i < 4; ++i)
+    {
+        readers.push_back(std::make_shared<MockReaderUnit>("Mock " + std::to_string(i), 0));
+        engine.addReaderUnit(readers.back());
+    }
+
+    // Jobs of a reader never overlap and keep their order, the vectors need no lock.
+    std::vector<std::vector<int>> sequences(readers.size());
+    std::vector<std::atomic<int>> running(readers.size());
+    std::atomic<bool> overlap(false);
+    engine.setWaitRemoval(false);
+    engine.start();
+    for (int job = 0; job < 200; ++job)
+    {
+        for (size_t r = 0; r < readers.size(); ++r)
+        {
+            engine.post(readers[r], [&, r, job](std::shared_ptr<ReaderUnit>) {
+                if (running[r]++ != 0)
+                    overlap = true;
+                sequences[r].push_back(job);
+                std::this_thread::yield();
+                running[r]--;
+            });
+        }
+    }
+    engine.stop();
+
+    ASSERT_FALSE(overlap);
+    for (size_t r = 0; r < readers.size(); ++r)
+    {
+        ASSERT_EQ(200u, sequences[r].size());
+        for (int job = 0; job < 200; ++job)
+            ASSERT_EQ(job, sequences[r][job]);
+    }
+
+    ASSERT_THROW(engine.post(std::make_shared<MockReaderUnit>("Unknown", 0), [](std::shared_ptr<ReaderUnit>) {}),
+                 std::invalid_argument);
+    // A job posted after stop() would never run.
+    ASSERT_THROW(engine.post(readers[0], [](std::shared_ptr<ReaderUnit>) {}), LibLogicalAccessException);
+}
+
+TEST(test_reader_session_engine, card_job_errors)
+{
+    ReaderSessionEngine engine(2);
+    auto reader = std::make_shared<MockReaderUnit>("Mock", 1);
+    engine.addReaderUnit(reader);
+
+    std::atomic<int> errors(0);
+    engine.setErrorHandler([&](std::shared_ptr<ReaderUnit>, const std::exception &) { ++errors; });
+    engine.setCardJob([](std::shared_ptr<ReaderUnit> readerUnit, std::shared_ptr<Chip> chip) {
+        ASSERT_TRUE(readerUnit->isConnected());
+        ASSERT_EQ("GenericTag", chip->getCardType());
+        throw LibLogicalAccessException("Authentication failed");
+    });
+    engine.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    engine.stop();
+
+    ASSERT_FALSE(reader->isConnected());
+    ASSERT_EQ(0u, engine.getTransactionCount());
+    ASSERT_GT(engine.getErrorCount(), 0u);
+    ASSERT_EQ(static_cast<int>(engine.getErrorCount()), errors);
+}
+
+TEST(test_reader_session_engine, polls_are_queued)
+{
+    ReaderSessionEngine engine(4);
+    auto reader = std::make_shared<MockReaderUnit>("Mock", 1);
+    engine.addReaderUnit(reader);
+    engine.start();
+
+    // The insertion and removal polls never run on the reader while a posted job does.
+    std::atomic<int> done(0);
+    for (int job = 0; job < 50; ++job)
+        engine.post(reader, [&](std::shared_ptr<ReaderUnit>) {
+            reader->exchange();
+            ++done;
+        });
+    for (int i = 0; i < 1000 && done < 50; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    engine.stop();
+
+    ASSERT_EQ(50, done);
+    ASSERT_GT(engine.getTransactionCount(), 0u);
+    ASSERT_FALSE(reader->hasOverlapped());
+}
+
+TEST(test_reader_session_engine, unknown_job_errors)
+{
+    ReaderSessionEngine engine(1);
+    auto reader = std::make_shared<MockReaderUnit>("Mock", 0);
+    engine.addReaderUnit(reader);
+
+    std::atomic<int> errors(0), done(0);
+    engine.setErrorHandler([&](std::shared_ptr<ReaderUnit>, const std::exception &) { ++errors; });
+    engine.setCardJob([](std::shared_ptr<ReaderUnit>, std::shared_ptr<Chip>) { throw 42; });
+    engine.setWaitRemoval(false);
+    engine.start();
+    engine.post(reader, [](std::shared_ptr<ReaderUnit>) { throw 42; });
+    engine.post(reader, [&](std::shared_ptr<ReaderUnit>) { ++done; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    engine.stop();
+
+    // The worker and the detection thread survive the non standard exceptions.
+    ASSERT_EQ(1, done);
+    ASSERT_EQ(0u, engine.getTransactionCount());
+    ASSERT_GT(engine.getErrorCount(), 1u);
+    ASSERT_EQ(static_cast<int>(engine.getErrorCount()), errors);
+}
+
+TEST(test_reader_session_engine, idle_readers_keep_workers_free)
+{
+    // More idle readers than workers, polling with a long timeout.
+    const int readerCount = 8;
+    ReaderSessionEngine engine(2);
+    engine.setPollInterval(20);
+    std::vector<std::shared_ptr<MockReaderUnit>> readers;
+    for (int i = 0; i < readerCount; ++i)
+    {
+        readers.push_back(std::make_shared<MockReaderUnit>("Mock " + std::to_string(i), 0));
+        readers.back()->setCardPresent(false);
+        engine.addReaderUnit(readers.back());
+    }
+    engine.start();
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::set<std::thread::id> jobThreads;
+    int done = 0;
+    for (int job = 0; job < 4 * readerCount; ++job)
+    {
+        engine.post(readers[job % readerCount], [&](std::shared_ptr<ReaderUnit>) {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobThreads.insert(std::this_thread::get_id());
+            ++done;
+            cond.notify_all();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait_for(lock, std::chrono::seconds(10), [&]() { return done == 4 * readerCount; });
+    }
+    engine.stop();
+
+    // The polls run on the detection threads, never on the workers running the jobs.
+    ASSERT_EQ(4 * readerCount, done);
+    ASSERT_GE(2u, jobThreads.size());
+    for (const auto &reader : readers)
+    {
+        for (const auto &id : reader->getPollThreads())
+            ASSERT_EQ(0u, jobThreads.count(id));
+    }
+    ASSERT_FALSE(readers[0]->hasOverlapped());
+}
+
+TEST(test_reader_session_engine, readers_run_in_parallel)
+{
+    const int readerCount = 4;
+    ReaderSessionEngine engine(readerCount);
+    for (int i = 0; i < readerCount; ++i)
+        engine.addReaderUnit(std::make_shared<MockReaderUnit>("Mock " + std::to_string(i), 0));
+
+    // The first card sessions only complete once every reader is in one.
+    std::mutex mutex;
+    std::condition_variable cond;
+    int entered = 0;
+    bool timedOut = false;
+    engine.setCardJob([&](std::shared_ptr<ReaderUnit>, std::shared_ptr<Chip>) {
+        std::unique_lock<std::mutex> lock(mutex);
+        ++entered;
+        cond.notify_all();
+        if (!cond.wait_for(lock, std::chrono::seconds(10), [&]() { return entered >= readerCount; }))
+            timedOut = true;
+    });
+    engine.start();
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait_for(lock, std::chrono::seconds(10), [&]() { return entered >= readerCount; });
+    }
+    engine.stop();
+
+    ASSERT_FALSE(timedOut);
+    ASSERT_GE(engine.getTransactionCount(), static_cast<uint64_t>(readerCount));
+    ASSERT_EQ(0u, engine.getErrorCount());
+}
+
+#ifdef LLA_BENCHMARK
+TEST(benchmark_reader_session_engine, throughput)
+{
+    const unsigned int latency = 5;
+    const unsigned int exchanges = 3;
+
+    for (unsigned int readerCount : {1u, 2u, 4u, 8u, 16u})
+    {
+        ReaderSessionEngine engine(8);
+        for (unsigned int i = 0; i < readerCount; ++i)
+        {
+            engine.addReaderUnit(std::make_shared<MockReaderUnit>("Mock " + std::to_string(i), latency));
+        }
+
+        // Read format, authenticate, write.
+        engine.setCardJob([](std::shared_ptr<ReaderUnit> readerUnit, std::shared_ptr<Chip>) {
+            for (unsigned int i = 0; i < exchanges; ++i)
+                std::static_pointer_cast<MockReaderUnit>(readerUnit)->exchange();
+        });
+
+        auto start = std::chrono::steady_clock::now();
+        engine.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(400));
+        engine.stop();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << readerCount << " readers: " << static_cast<long>(engine.getTransactionCount() / seconds)
+                  << " transactions/s, " << engine.getErrorCount() << " errors" << std::endl;
+    }
+}
+#endif
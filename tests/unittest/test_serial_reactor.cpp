@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <logicalaccess/readerproviders/serialport.hpp>
+#include <chrono>
+#include <future>
+#include <memory>
+
+#ifndef _WIN32
+
+#include <fcntl.h>
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+
+using namespace logicalaccess;
+
+/**
+ * Frames made of a length byte followed by the data.
+ */
+class LengthBufferParser : public CircularBufferParser
+{
+  public:
+    std::vector<unsigned char> getValidBuffer(boost::circular_buffer<unsigned char> &circular_buffer) override
+    {
+        std::vector<unsigned char> result;
+        if (circular_buffer.size() > 0 && circular_buffer.size() >= 1u + circular_buffer[0])
+        {
+            result.assign(circular_buffer.begin() + 1, circular_buffer.begin() + 1 + circular_buffer[0]);
+            circular_buffer.erase(circular_buffer.begin(), circular_buffer.begin() + 1 + circular_buffer[0]);
+        }
+        return result;
+    }
+};
+
+/**
+ * A pseudo-terminal, the slave side being used as the serial port.
+ */
+struct PseudoTerminal
+{
+    PseudoTerminal()
+    {
+        char name[128];
+        struct termios raw;
+        cfmakeraw(&raw);
+        EXPECT_EQ(0, openpty(&master, &slave, name, &raw, nullptr));
+        device = name;
+    }
+
+    ~PseudoTerminal()
+    {
+        ::close(slave);
+        ::close(master);
+    }
+
+    void write(const std::vector<unsigned char> &data)
+    {
+        ASSERT_EQ(static_cast<ssize_t>(data.size()), ::write(master, data.data(), data.size()));
+    }
+
+    int master;
+    int slave;
+    std::string device;
+};
+
+static std::vector<unsigned char> waitFrame(SerialPort &port, std::chrono::milliseconds timeout)
+{
+    std::vector<unsigned char> frame;
+    port.waitMoreData(std::chrono::steady_clock::now() + timeout, [&]() {
+        if (port.read(frame) == 0)
+            port.dataConsumed();
+    });
+    return frame;
+}
+
+TEST(test_serial_reactor, frames_from_many_ports)
+{
+    const size_t portCount  = 32;
+    const size_t frameCount = 100;
+
+    std::vector<std::unique_ptr<PseudoTerminal>> terminals;
+    std::vector<std::unique_ptr<SerialPort>> ports;
+    for (size_t i = 0; i < portCount; ++i)
+    {
+        terminals.emplace_back(new PseudoTerminal());
+        ports.emplace_back(new SerialPort(terminals.back()->device));
+        ports.back()->setCircularBufferParser(new LengthBufferParser());
+        ports.back()->open();
+    }
+
+    // A burst far above the initial ring buffer size, on every port at once.
+    std::vector<unsigned char> burst;
+    for (size_t frame = 0; frame < frameCount; ++frame)
+    {
+        burst.push_back(100);
+        for (unsigned char b = 0; b < 100; ++b)
+            burst.push_back(static_cast<unsigned char>(frame));
+    }
+    for (auto &terminal : terminals)
+        terminal->write(burst);
+
+    for (auto &port : ports)
+    {
+        for (size_t frame = 0; frame < frameCount; ++frame)
+        {
+            std::vector<unsigned char> data = waitFrame(*port, std::chrono::milliseconds(2000));
+            ASSERT_EQ(100u, data.size());
+            ASSERT_EQ(static_cast<unsigned char>(frame), data[0]);
+        }
+        port->close();
+    }
+}
+
+TEST(test_serial_reactor, high_water_mark)
+{
+    PseudoTerminal terminal;
+    SerialPort port(terminal.device);
+    port.setReadBufferHighWaterMark(16);
+    port.open();
+
+    // Without parser, the oldest data is discarded above the high-water mark.
+    std::vector<unsigned char> data(64);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<unsigned char>(i);
+    terminal.write(data);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    std::vector<unsigned char> read;
+    port.lockedExecute([&]() { port.read(read); });
+    ASSERT_EQ(std::vector<unsigned char>(data.end() - 16, data.end()), read);
+
+    // Writes go through the reactor.
+    port.write({0x01, 0x02, 0x03});
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    unsigned char written[3];
+    ASSERT_EQ(3, ::read(terminal.master, written, sizeof(written)));
+    ASSERT_EQ(0x03, written[2]);
+    port.close();
+    ASSERT_FALSE(port.isOpen());
+}
+
+TEST(test_serial_reactor, stop_with_open_ports)
+{
+    PseudoTerminal terminal;
+    SerialPort port(terminal.device);
+    port.setCircularBufferParser(new LengthBufferParser());
+    port.open();
+
+    // The pending read of the open port must not keep the reactor thread alive.
+    std::future<void> stopped = std::async(std::launch::async, []() { SerialPortReactor::getInstance().stop(); });
+    ASSERT_EQ(std::future_status::ready, stopped.wait_for(std::chrono::seconds(10)));
+    ASSERT_FALSE(port.isOpen());
+    port.close();
+
+    // Opening a port starts the reactor again.
+    port.open();
+    terminal.write({0x02, 0x10, 0x20});
+    ASSERT_EQ(std::vector<unsigned char>({0x10, 0x20}), waitFrame(port, std::chrono::milliseconds(2000)));
+    port.close();
+}
+
+#endif